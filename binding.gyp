@@ -8,21 +8,37 @@
       "sources": [
         "src/addon.cc",
         "src/common.cc",
+        "src/frame_pool.cc",
+        "src/thread_placement.cc",
+        "src/sws_pool.cc",
         "src/video_encoder.cc",
         "src/video_decoder.cc",
         "src/video_frame.cc",
+        "src/pixel_kernels.cc",
+        "src/yuv_kernels.cc",
         "src/audio_encoder.cc",
+        "src/audio_encoder_worker.cc",
         "src/audio_decoder.cc",
+        "src/audio_decoder_worker.cc",
         "src/audio_data.cc",
         "src/encoded_video_chunk.cc",
         "src/encoded_audio_chunk.cc",
         "src/video_filter.cc",
+        "src/video_scaler.cc",
         "src/demuxer.cc",
+        "src/demuxer_input.cc",
+        "src/mapped_file.cc",
+        "src/keyframe_index.cc",
+        "src/loudness_meter.cc",
         "src/muxer.cc",
+        "src/muxer_output.cc",
+        "src/pipeline.cc",
         "src/image_decoder.cc",
+        "src/image_encoder.cc",
         "src/test_video_generator.cc",
-        "src/async_encode_worker.cc",
-        "src/async_decode_worker.cc",
+        "src/transfer_registry.cc",
+        "src/shm_frame_ring.cc",
+        "src/shared_frame_ring.cc",
         "src/video_decoder_worker.cc",
         "src/video_encoder_worker.cc",
         "src/warnings.cc",
@@ -87,6 +103,7 @@
             "-lpthread",
             "-lm",
             "-ldl",
+            "-lrt",
             "-lz"
           ],
           "ldflags": [
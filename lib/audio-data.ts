@@ -7,7 +7,12 @@
 import { binding } from './binding';
 import type { NativeAudioData, NativeModule } from './native-types';
 import { detachArrayBuffers } from './transfer';
-import type { AudioDataCopyToOptions, AudioDataInit, AudioSampleFormat } from './types';
+import type {
+  AudioDataCopyToOptions,
+  AudioDataInit,
+  AudioSampleFormat,
+  TransferredAudioData,
+} from './types';
 
 // Load native addon with type assertion
 const native = binding as NativeModule;
@@ -129,6 +134,32 @@ export class AudioData {
     }
   }
 
+  /**
+   * @internal
+   * Move the samples into the native transfer registry and close this
+   * AudioData. See detachForTransfer().
+   */
+  _detach(): TransferredAudioData {
+    if (this._closed) {
+      throw new DOMException('AudioData is closed', 'InvalidStateError');
+    }
+    const { handle, init } = this._native.detach();
+    this._closed = true;
+    return { type: 'AudioData', handle, init };
+  }
+
+  /**
+   * @internal
+   * Claim an AudioData detached in this or another thread. See
+   * attachTransferred().
+   */
+  static _fromTransfer(transferred: TransferredAudioData): AudioData {
+    const data = Object.create(AudioData.prototype) as AudioData;
+    data._native = new native.AudioData(transferred.handle, transferred.init);
+    data._closed = false;
+    return data;
+  }
+
   get _nativeAudioData(): NativeAudioData {
     return this._native;
   }
@@ -11,7 +11,15 @@ import { ControlMessageQueue } from './control-message-queue';
 import type { EncodedAudioChunk } from './encoded-chunks';
 import * as is from './is';
 import type { AudioDecoderOutputCallback, NativeAudioDecoder, NativeModule } from './native-types';
-import type { AudioDecoderConfig, AudioDecoderInit, CodecState } from './types';
+import { ResourceManager } from './resource-manager';
+import { SubmissionQueue } from './submission-queue';
+import type {
+  AudioAnalysis,
+  AudioDecoderConfig,
+  AudioDecoderInit,
+  CodecState,
+  CodecStats,
+} from './types';
 
 // Load native addon with type assertion
 const native = binding as NativeModule;
@@ -21,7 +29,11 @@ export class AudioDecoder extends CodecBase {
   private _controlQueue: ControlMessageQueue;
   private _decodeQueueSize: number = 0;
   private _needsKeyFrame: boolean = true;
+  // analysis.output false: no outputs to count the queue down with
+  private _discardOutput: boolean = false;
   private _errorCallback: (error: DOMException) => void;
+  // decode() calls waiting for queue space (queuePolicy 'block')
+  private _blocked: SubmissionQueue;
 
   constructor(init: AudioDecoderInit) {
     super();
@@ -33,6 +45,9 @@ export class AudioDecoder extends CodecBase {
     this._controlQueue = new ControlMessageQueue();
     this._errorCallback = init.error;
     this._controlQueue.setErrorHandler(init.error);
+    this._blocked = new SubmissionQueue(() => {
+      this._decodeQueueSize = Math.max(0, this._decodeQueueSize - 1);
+    });
 
     const outputCallback: AudioDecoderOutputCallback = (nativeData) => {
       this._decodeQueueSize = Math.max(0, this._decodeQueueSize - 1);
@@ -45,11 +60,13 @@ export class AudioDecoder extends CodecBase {
 
       // Fire ondequeue after output
       this._triggerDequeue();
+      this._blocked.drain();
     };
 
     this._native = new native.AudioDecoder({
       output: outputCallback,
       error: init.error,
+      dequeue: () => this._blocked.drain(),
     });
   }
 
@@ -58,7 +75,7 @@ export class AudioDecoder extends CodecBase {
   }
 
   get decodeQueueSize(): number {
-    return this._decodeQueueSize;
+    return this._discardOutput ? this._native.decodeQueueSize : this._decodeQueueSize;
   }
 
   configure(config: AudioDecoderConfig): void {
@@ -84,9 +101,14 @@ export class AudioDecoder extends CodecBase {
     this._needsKeyFrame = true;
     // Configure synchronously to set state immediately per W3C spec
     this._native.configure(config);
+    this._discardOutput = config.analysis?.output === false;
   }
 
-  decode(chunk: EncodedAudioChunk): void {
+  /**
+   * Queue a chunk for decoding. Under `queuePolicy: 'block'` a full queue
+   * returns a Promise that resolves once the chunk is queued.
+   */
+  decode(chunk: EncodedAudioChunk): void | Promise<void> {
     // W3C spec: throw InvalidStateError if not configured
     if (this.state === 'unconfigured') {
       throw new DOMException('Decoder is unconfigured', 'InvalidStateError');
@@ -104,9 +126,60 @@ export class AudioDecoder extends CodecBase {
     }
     this._needsKeyFrame = false;
 
+    ResourceManager.getInstance().relieveMemoryPressure();
     this._decodeQueueSize++;
+    if (this._blocked.size === 0 && this._submit(chunk)) {
+      return;
+    }
+    // Chunks are immutable, so the parked call keeps this one.
+    return this._blocked.park(() => this._submit(chunk), () => {});
+  }
+
+  /**
+   * Queue `chunks` for decoding in one native call, as decode() would one
+   * by one. Under `queuePolicy: 'block'` the chunks that do not fit wait as
+   * with decode(), and the returned Promise resolves once all are queued.
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  decodeBatch(chunks: readonly EncodedAudioChunk[]): void | Promise<void> {
+    if (this.state === 'unconfigured') {
+      throw new DOMException('Decoder is unconfigured', 'InvalidStateError');
+    }
+    if (this.state === 'closed') {
+      throw new DOMException('Decoder is closed', 'InvalidStateError');
+    }
+    if (this._needsKeyFrame && chunks.length > 0 && chunks[0].type === 'key') {
+      this._needsKeyFrame = false;
+    }
+    let consumed = 0;
+    // A missing key chunk goes through decode(), which reports it.
+    if (this._blocked.size === 0 && !this._needsKeyFrame && chunks.length > 0) {
+      ResourceManager.getInstance().relieveMemoryPressure();
+      const [count, dropped] = this._native.decodeBatch(chunks.map((chunk) => chunk._nativeChunk));
+      consumed = count;
+      this._decodeQueueSize = Math.max(0, this._decodeQueueSize + count - dropped);
+    }
+    const parked: Promise<void>[] = [];
+    for (let i = consumed; i < chunks.length; i++) {
+      const result = this.decode(chunks[i]);
+      if (result) {
+        parked.push(result);
+      }
+    }
+    if (parked.length > 0) {
+      return Promise.all(parked).then(() => undefined);
+    }
+  }
+
+  // False when the 'block' queue policy found the native queue full.
+  private _submit(chunk: EncodedAudioChunk): boolean {
     // Call native decode directly - chunk must be valid at call time
-    this._native.decode(chunk._nativeChunk);
+    const dropped = this._native.decode(chunk._nativeChunk);
+    if (dropped < 0) {
+      return false;
+    }
+    this._decodeQueueSize = Math.max(0, this._decodeQueueSize - dropped);
+    return true;
   }
 
   async flush(): Promise<void> {
@@ -118,15 +191,45 @@ export class AudioDecoder extends CodecBase {
       return Promise.reject(new DOMException('Decoder is closed', 'InvalidStateError'));
     }
     await this._controlQueue.flush();
+    await this._blocked.whenIdle();
     return this._native.flush();
   }
 
+  /**
+   * Per-stage timings and copy volume for this decoder: queue wait, codec
+   * time per chunk, resampling and output delivery. Use it to
+   * find which stage saturates. Counts survive reset() and configure().
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  getStats(): CodecStats {
+    return this._native.getStats();
+  }
+
+  /**
+   * Zero the counters reported by getStats().
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  resetStats(): void {
+    this._native.resetStats();
+  }
+
+  /**
+   * Loudness and levels measured since configure() with `analysis`, or null
+   * without it. Complete once flush() resolves; still readable after
+   * close().
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  getAnalysis(): AudioAnalysis | null {
+    return this._native.getAnalysis();
+  }
+
   reset(): void {
     // W3C spec: reset() is a no-op when closed (does NOT throw)
     if (this.state === 'closed') {
       return;
     }
     this._controlQueue.clear();
+    this._blocked.rejectAll(new DOMException('Decoder was reset', 'AbortError'));
     this._decodeQueueSize = 0;
     this._needsKeyFrame = true;
     this._native.reset();
@@ -134,6 +237,7 @@ export class AudioDecoder extends CodecBase {
 
   close(): void {
     this._controlQueue.clear();
+    this._blocked.rejectAll(new DOMException('Decoder was closed', 'AbortError'));
     this._native.close();
   }
 
@@ -10,13 +10,16 @@ import { CodecBase } from './codec-base';
 import { ControlMessageQueue } from './control-message-queue';
 import { EncodedAudioChunk } from './encoded-chunks';
 import * as is from './is';
+import type { Muxer } from './muxer';
 import type {
   AudioEncoderOutputCallback,
   NativeAudioEncoder,
   NativeEncodedAudioChunk,
   NativeModule,
 } from './native-types';
-import type { AudioEncoderConfig, AudioEncoderInit, CodecState } from './types';
+import { ResourceManager } from './resource-manager';
+import { SubmissionQueue } from './submission-queue';
+import type { AudioEncoderConfig, AudioEncoderInit, CodecState, CodecStats } from './types';
 
 // Load native addon with type assertion
 const native = binding as NativeModule;
@@ -28,6 +31,8 @@ export class AudioEncoder extends CodecBase {
   private _controlQueue: ControlMessageQueue;
   private _encodeQueueSize: number = 0;
   private _maxQueueDepth: number = DEFAULT_MAX_QUEUE_DEPTH;
+  // encode() calls waiting for queue space (queuePolicy 'block')
+  private _blocked: SubmissionQueue;
 
   constructor(init: AudioEncoderInit) {
     super();
@@ -39,6 +44,9 @@ export class AudioEncoder extends CodecBase {
 
     this._controlQueue = new ControlMessageQueue();
     this._controlQueue.setErrorHandler(init.error);
+    this._blocked = new SubmissionQueue(() => {
+      this._encodeQueueSize = Math.max(0, this._encodeQueueSize - 1);
+    });
 
     const outputCallback: AudioEncoderOutputCallback = (chunk, metadata) => {
       this._encodeQueueSize = Math.max(0, this._encodeQueueSize - 1);
@@ -50,11 +58,18 @@ export class AudioEncoder extends CodecBase {
 
       // Fire ondequeue after output
       this._triggerDequeue();
+      this._blocked.drain();
     };
 
     this._native = new native.AudioEncoder({
       output: outputCallback,
       error: init.error,
+      sinkProgress: (packets) => {
+        this._encodeQueueSize = Math.max(0, this._encodeQueueSize - packets);
+        this._triggerDequeue();
+        this._blocked.drain();
+      },
+      dequeue: () => this._blocked.drain(),
     });
   }
 
@@ -121,7 +136,12 @@ export class AudioEncoder extends CodecBase {
     this._native.configure(config);
   }
 
-  encode(data: AudioData): void {
+  /**
+   * Queue audio for encoding. Under `queuePolicy: 'block'` a full queue
+   * returns a Promise that resolves once the data is queued; the AudioData
+   * may be closed straight away either way.
+   */
+  encode(data: AudioData): void | Promise<void> {
     // W3C spec: throw InvalidStateError if not configured
     if (this.state === 'unconfigured') {
       throw new DOMException('Encoder is unconfigured', 'InvalidStateError');
@@ -130,9 +150,56 @@ export class AudioEncoder extends CodecBase {
       throw new DOMException('Encoder is closed', 'InvalidStateError');
     }
 
+    ResourceManager.getInstance().relieveMemoryPressure();
     this._encodeQueueSize++;
+    if (this._blocked.size === 0 && this._submit(data)) {
+      return;
+    }
+    const held = data.clone();
+    return this._blocked.park(() => this._submit(held), () => held.close());
+  }
+
+  /**
+   * Queue `data` for encoding in one native call, as encode() would one by
+   * one. Under `queuePolicy: 'block'` the AudioData that do not fit wait as
+   * with encode(), and the returned Promise resolves once all are queued.
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  encodeBatch(data: readonly AudioData[]): void | Promise<void> {
+    if (this.state === 'unconfigured') {
+      throw new DOMException('Encoder is unconfigured', 'InvalidStateError');
+    }
+    if (this.state === 'closed') {
+      throw new DOMException('Encoder is closed', 'InvalidStateError');
+    }
+    let consumed = 0;
+    if (this._blocked.size === 0 && data.length > 0) {
+      ResourceManager.getInstance().relieveMemoryPressure();
+      const [count, dropped] = this._native.encodeBatch(data.map((item) => item._nativeAudioData));
+      consumed = count;
+      this._encodeQueueSize = Math.max(0, this._encodeQueueSize + count - dropped);
+    }
+    const parked: Promise<void>[] = [];
+    for (let i = consumed; i < data.length; i++) {
+      const result = this.encode(data[i]);
+      if (result) {
+        parked.push(result);
+      }
+    }
+    if (parked.length > 0) {
+      return Promise.all(parked).then(() => undefined);
+    }
+  }
+
+  // False when the 'block' queue policy found the native queue full.
+  private _submit(data: AudioData): boolean {
     // Call native encode directly - data must be valid at call time
-    this._native.encode(data._nativeAudioData);
+    const dropped = this._native.encode(data._nativeAudioData);
+    if (dropped < 0) {
+      return false;
+    }
+    this._encodeQueueSize = Math.max(0, this._encodeQueueSize - dropped);
+    return true;
   }
 
   async flush(): Promise<void> {
@@ -145,9 +212,38 @@ export class AudioEncoder extends CodecBase {
     }
 
     await this._controlQueue.flush();
+    await this._blocked.whenIdle();
     return this._native.flush();
   }
 
+  /**
+   * Send encoded packets straight to a Muxer track from the encoder thread.
+   * Output no longer reaches the output callback; encodeQueueSize and
+   * dequeue events still track progress. Add all muxer tracks first.
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  attachMuxer(muxer: Muxer, trackIndex: number): void {
+    this._native.attachMuxer(muxer._native, trackIndex);
+  }
+
+  /**
+   * Per-stage timings and copy volume for this encoder: queue wait, codec
+   * time per frame, resampling and output delivery. Use it to
+   * find which stage saturates. Counts survive reset() and configure().
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  getStats(): CodecStats {
+    return this._native.getStats();
+  }
+
+  /**
+   * Zero the counters reported by getStats().
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  resetStats(): void {
+    this._native.resetStats();
+  }
+
   reset(): void {
     // W3C spec: reset() is a no-op when closed (does NOT throw)
     if (this.state === 'closed') {
@@ -155,12 +251,14 @@ export class AudioEncoder extends CodecBase {
     }
 
     this._controlQueue.clear();
+    this._blocked.rejectAll(new DOMException('Encoder was reset', 'AbortError'));
     this._encodeQueueSize = 0;
     this._native.reset();
   }
 
   close(): void {
     this._controlQueue.clear();
+    this._blocked.rejectAll(new DOMException('Encoder was closed', 'AbortError'));
     this._native.close();
   }
 
@@ -2,46 +2,160 @@
 // SPDX-License-Identifier: MIT
 
 import { binding } from './binding';
-import { EncodedVideoChunk } from './encoded-chunks';
-import type { NativeDemuxer, NativeModule } from './native-types';
-import type { DemuxerInit, TrackInfo } from './types';
+import { EncodedAudioChunk, EncodedVideoChunk } from './encoded-chunks';
+import type {
+  NativeDemuxer,
+  NativeEncodedAudioChunk,
+  NativeEncodedVideoChunk,
+  NativeModule,
+} from './native-types';
+import type {
+  DemuxerAsyncOptions,
+  DemuxerInit,
+  DemuxerOpenOptions,
+  DemuxerPullSource,
+  DemuxerSeekOptions,
+  DemuxerSource,
+  TrackInfo,
+} from './types';
 
 const native = binding as NativeModule;
 
+/**
+ * Adapts a byte stream to the random-access pull interface. Received bytes
+ * are retained so FFmpeg can seek back (e.g. to an MP4 moov atom); reads
+ * past the buffered end wait for more data.
+ */
+class BufferedStreamSource implements DemuxerPullSource {
+  private readonly _chunks: Uint8Array[] = [];
+  private readonly _offsets: number[] = [];
+  private _length = 0;
+  private _ended = false;
+  private _error: unknown = null;
+  private _waiters: Array<() => void> = [];
+
+  constructor(stream: AsyncIterable<Uint8Array>) {
+    void this._pump(stream);
+  }
+
+  async read(offset: number, length: number): Promise<Uint8Array | null> {
+    while (offset >= this._length && !this._ended) {
+      await new Promise<void>(resolve => this._waiters.push(resolve));
+    }
+    if (this._error) {
+      throw this._error;
+    }
+    if (offset >= this._length) {
+      return null;
+    }
+
+    // Binary search for the chunk containing |offset|.
+    let lo = 0;
+    let hi = this._chunks.length - 1;
+    while (lo < hi) {
+      const mid = (lo + hi + 1) >> 1;
+      if (this._offsets[mid] <= offset) {
+        lo = mid;
+      } else {
+        hi = mid - 1;
+      }
+    }
+    const start = offset - this._offsets[lo];
+    return this._chunks[lo].subarray(start, start + length);
+  }
+
+  private async _pump(stream: AsyncIterable<Uint8Array>): Promise<void> {
+    try {
+      for await (const chunk of stream) {
+        if (chunk.byteLength === 0) continue;
+        this._chunks.push(chunk);
+        this._offsets.push(this._length);
+        this._length += chunk.byteLength;
+        this._wake();
+      }
+    } catch (e) {
+      this._error = e;
+    }
+    this._ended = true;
+    this._wake();
+  }
+
+  private _wake(): void {
+    const waiters = this._waiters;
+    this._waiters = [];
+    for (const resolve of waiters) resolve();
+  }
+}
+
+function isAsyncIterable(source: object): source is AsyncIterable<Uint8Array> {
+  return typeof (source as AsyncIterable<Uint8Array>)[Symbol.asyncIterator] === 'function';
+}
+
 export class Demuxer {
   private _native: NativeDemuxer;
+  private _reportQueueSize: (() => void) | null = null;
+  private _streaming = false;
+  private readonly _onError: ((error: Error) => void) | undefined;
 
   constructor(init: DemuxerInit) {
+    this._onError = init.onError;
     this._native = new native.Demuxer({
       onTrack: init.onTrack,
-      onChunk: (
-        chunk: {
-          type: string;
-          timestamp: number;
-          duration?: number;
-          data: Buffer;
-        },
-        trackIndex: number,
-      ) => {
+      onChunk: (chunk: NativeEncodedVideoChunk | NativeEncodedAudioChunk, trackIndex: number) => {
         if (init.onChunk) {
-          const wrappedChunk = new EncodedVideoChunk({
-            type: chunk.type as 'key' | 'delta',
-            timestamp: chunk.timestamp,
-            duration: chunk.duration,
-            data: chunk.data,
-          });
+          // Native chunks share the demuxed packet; wrapping copies nothing.
+          const wrappedChunk =
+            chunk instanceof native.EncodedAudioChunk
+              ? EncodedAudioChunk._fromNative(chunk)
+              : EncodedVideoChunk._fromNative(chunk as NativeEncodedVideoChunk);
           init.onChunk(wrappedChunk, trackIndex);
         }
+        this._reportQueueSize?.();
       },
       onError: init.onError,
     });
   }
 
-  async open(path: string): Promise<void> {
-    return this._native.open(path);
+  /**
+   * Open a source for demuxing.
+   *
+   * Besides a file path, the source may be an in-memory buffer, a pull
+   * source serving byte ranges, or a byte stream such as a Node Readable or
+   * web ReadableStream. Pull and stream sources are read asynchronously and
+   * must be demuxed with demux() or demuxAsync().
+   *
+   * `options` (a node-webcodecs extension) tune or skip stream probing;
+   * see DemuxerOpenOptions.
+   */
+  async open(source: DemuxerSource, options?: DemuxerOpenOptions): Promise<void> {
+    this._streaming = false;
+    if (typeof source === 'string') {
+      return this._native.open(source, options) as void;
+    }
+    if (source instanceof ArrayBuffer) {
+      return this._native.open(Buffer.from(source), options) as void;
+    }
+    if (ArrayBuffer.isView(source)) {
+      return this._native.open(
+        Buffer.from(source.buffer, source.byteOffset, source.byteLength),
+        options,
+      ) as void;
+    }
+    const pull = isAsyncIterable(source) ? new BufferedStreamSource(source) : source;
+    this._streaming = true;
+    await this._native.open(
+      {
+        size: pull.size,
+        read: (id, offset, length) => this._serveRead(pull, id, offset, length),
+      },
+      options,
+    );
   }
 
   async demux(): Promise<void> {
+    if (this._streaming) {
+      return this.demuxAsync();
+    }
     return this._native.demux();
   }
 
@@ -55,10 +169,115 @@ export class Demuxer {
     return this._native.demuxPackets(maxPackets ?? 0);
   }
 
+  /**
+   * Read all packets on a background thread. Packets are prefetched into a
+   * bounded buffer and delivered to onChunk in batches, so the event loop
+   * stays responsive while reading.
+   *
+   * When `options.decoder` is given, its decodeQueueSize is sampled after
+   * every chunk and on each 'dequeue' event; delivery and reading pause
+   * while it is at or above `decodeQueueHighWaterMark`.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * @returns Resolves at end of stream; rejects on read errors or close().
+   */
+  async demuxAsync(options: DemuxerAsyncOptions = {}): Promise<void> {
+    const decoder = options.decoder;
+    const report = decoder
+      ? () => this._native.setDownstreamQueueSize(decoder.decodeQueueSize)
+      : null;
+
+    const done = this._native.demuxAsync({
+      highWaterMark: options.highWaterMark,
+      downstreamHighWaterMark: options.decodeQueueHighWaterMark,
+    });
+    if (!decoder || !report) {
+      return done;
+    }
+
+    this._reportQueueSize = report;
+    decoder.addEventListener('dequeue', report);
+    try {
+      await done;
+    } finally {
+      decoder.removeEventListener('dequeue', report);
+      this._reportQueueSize = null;
+    }
+  }
+
+  /**
+   * Move the read position to a keyframe near `timestamp` (microseconds).
+   * Subsequent demux calls continue from there. In 'precise' mode, video
+   * chunks still start at the preceding keyframe; discard decoded frames
+   * before `timestamp`.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  async seek(timestamp: number, options: DemuxerSeekOptions = {}): Promise<void> {
+    await this._native.seek(timestamp, { mode: options.mode });
+  }
+
+  /**
+   * Build a keyframe index for the main track and use it for later seeks.
+   * Uses the container's own index when it has one, otherwise scans the
+   * input once. Call before demuxing (or seek afterwards), since a scan
+   * moves the read position.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * @returns The serialized index, for loadKeyframeIndex() on a later open.
+   */
+  async buildKeyframeIndex(): Promise<Uint8Array> {
+    return this._native.buildKeyframeIndex();
+  }
+
+  /**
+   * Use a serialized index from buildKeyframeIndex() for seeks.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * @throws DataError if the index was built for a different input.
+   */
+  loadKeyframeIndex(index: BufferSource): void {
+    const bytes =
+      index instanceof ArrayBuffer
+        ? new Uint8Array(index)
+        : new Uint8Array(index.buffer, index.byteOffset, index.byteLength);
+    this._native.loadKeyframeIndex(bytes);
+  }
+
+  /**
+   * Choose which tracks demux calls deliver, by TrackInfo.index. All of
+   * them are read in one pass; the container skips the payloads of every
+   * other track. By default one video and one audio track are delivered.
+   * Call after open() and while no demux is in progress.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * @throws RangeError if an index is not an audio or video track.
+   */
+  selectTracks(trackIndices: readonly number[]): void {
+    this._native.selectTracks([...trackIndices]);
+  }
+
   close(): void {
     this._native.close();
   }
 
+  private async _serveRead(
+    pull: DemuxerPullSource,
+    id: number,
+    offset: number,
+    length: number,
+  ): Promise<void> {
+    let data: Uint8Array | null;
+    try {
+      data = await pull.read(offset, length);
+    } catch (e) {
+      this._native.pushReadResult(id, null, true);
+      this._onError?.(e instanceof Error ? e : new Error(String(e)));
+      return;
+    }
+    this._native.pushReadResult(id, data);
+  }
+
   getVideoTrack(): TrackInfo | null {
     return this._native.getVideoTrack();
   }
@@ -11,7 +11,12 @@ import type {
   NativeModule,
 } from './native-types';
 import { detachArrayBuffers } from './transfer';
-import type { EncodedAudioChunkInit, EncodedVideoChunkInit } from './types';
+import type {
+  EncodedAudioChunkInit,
+  EncodedVideoChunkInit,
+  TransferredEncodedAudioChunk,
+  TransferredEncodedVideoChunk,
+} from './types';
 
 // Load native addon with type assertion
 const native = binding as NativeModule;
@@ -67,6 +72,7 @@ export class EncodedVideoChunk {
       type: init.type,
       timestamp: init.timestamp,
       duration: init.duration,
+      decodeTimestamp: init.decodeTimestamp,
       data: dataBuffer,
     });
 
@@ -84,7 +90,8 @@ export class EncodedVideoChunk {
   /**
    * @internal
    * Wrap an existing native EncodedVideoChunk without copying data.
-   * Used by the encoder's async output path to avoid double-copying.
+   * Used by the encoder's async output path and the Demuxer to avoid
+   * copying the payload.
    */
   static _fromNative(nativeChunk: NativeEncodedVideoChunk): EncodedVideoChunk {
     const chunk = Object.create(EncodedVideoChunk.prototype) as EncodedVideoChunk;
@@ -106,6 +113,11 @@ export class EncodedVideoChunk {
     return this._native.duration;
   }
 
+  /** @nonstandard Decode-order timestamp; see EncodedVideoChunkInit. */
+  get decodeTimestamp(): number {
+    return this._native.decodeTimestamp;
+  }
+
   get byteLength(): number {
     return this._native.byteLength;
   }
@@ -139,6 +151,27 @@ export class EncodedVideoChunk {
     videoChunkRegistry.unregister(this);
     this._native.close();
   }
+
+  /**
+   * @internal
+   * Move the payload into the native transfer registry and close this chunk.
+   * See detachForTransfer().
+   */
+  _detach(): TransferredEncodedVideoChunk {
+    const { handle, init } = this._native.detach();
+    videoChunkRegistry.unregister(this);
+    return { type: 'EncodedVideoChunk', handle, init };
+  }
+
+  /**
+   * @internal
+   * Claim a chunk detached in this or another thread. See attachTransferred().
+   */
+  static _fromTransfer(transferred: TransferredEncodedVideoChunk): EncodedVideoChunk {
+    return EncodedVideoChunk._fromNative(
+      new native.EncodedVideoChunk(transferred.init, transferred.handle),
+    );
+  }
 }
 
 export class EncodedAudioChunk {
@@ -176,6 +209,19 @@ export class EncodedAudioChunk {
     }
   }
 
+  /**
+   * @internal
+   * Wrap an existing native EncodedAudioChunk without copying data.
+   * Used by the Demuxer to hand out chunks that share the demuxed packet.
+   */
+  static _fromNative(nativeChunk: NativeEncodedAudioChunk): EncodedAudioChunk {
+    const chunk = Object.create(EncodedAudioChunk.prototype) as EncodedAudioChunk;
+    chunk._native = nativeChunk;
+    // Register with FinalizationRegistry for automatic cleanup
+    audioChunkRegistry.register(chunk, nativeChunk, chunk);
+    return chunk;
+  }
+
   get type(): 'key' | 'delta' {
     return this._native.type as 'key' | 'delta';
   }
@@ -216,6 +262,27 @@ export class EncodedAudioChunk {
     this._native.close();
   }
 
+  /**
+   * @internal
+   * Move the payload into the native transfer registry and close this chunk.
+   * See detachForTransfer().
+   */
+  _detach(): TransferredEncodedAudioChunk {
+    const { handle, init } = this._native.detach();
+    audioChunkRegistry.unregister(this);
+    return { type: 'EncodedAudioChunk', handle, init };
+  }
+
+  /**
+   * @internal
+   * Claim a chunk detached in this or another thread. See attachTransferred().
+   */
+  static _fromTransfer(transferred: TransferredEncodedAudioChunk): EncodedAudioChunk {
+    return EncodedAudioChunk._fromNative(
+      new native.EncodedAudioChunk(transferred.init, transferred.handle),
+    );
+  }
+
   get _nativeChunk(): NativeEncodedAudioChunk {
     return this._native;
   }
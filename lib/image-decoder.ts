@@ -9,12 +9,21 @@ import { ImageTrack } from './image-track';
 import { ImageTrackList } from './image-track-list';
 import type { NativeImageDecoder, NativeModule } from './native-types';
 import { detachArrayBuffers } from './transfer';
-import type { ImageDecodeOptions, ImageDecodeResult, ImageDecoderInit } from './types';
+import type {
+  ImageDecodeOptions,
+  ImageDecodeResult,
+  ImageDecoderInit,
+  ImageFileSource,
+} from './types';
 import { VideoFrame } from './video-frame';
 
 // Load native addon with type assertion
 const native = binding as NativeModule;
 
+function isFileSource(data: ImageDecoderInit['data']): data is ImageFileSource {
+  return typeof data === 'object' && data !== null && ('path' in data || 'fd' in data);
+}
+
 export class ImageDecoder {
   private _native: NativeImageDecoder | null = null;
   private _closed: boolean = false;
@@ -78,38 +87,74 @@ export class ImageDecoder {
       return;
     }
 
+    // Local file (node-webcodecs extension): mapped by the native decoder
+    if (isFileSource(init.data)) {
+      this._initializeNative(init.data, init);
+      return;
+    }
+
     // Convert data to Buffer if needed
-    let dataBuffer: Buffer;
+    let buffer: ArrayBufferLike;
+    let byteOffset = 0;
+    let byteLength: number;
     if (init.data instanceof ArrayBuffer) {
-      dataBuffer = Buffer.from(init.data);
+      buffer = init.data;
+      byteLength = init.data.byteLength;
     } else if (ArrayBuffer.isView(init.data)) {
-      dataBuffer = Buffer.from(init.data.buffer, init.data.byteOffset, init.data.byteLength);
+      buffer = init.data.buffer;
+      byteOffset = init.data.byteOffset;
+      byteLength = init.data.byteLength;
     } else {
       throw new TypeError('data must be ArrayBuffer or ArrayBufferView');
     }
 
-    // Handle transfer option - detach specified ArrayBuffers per W3C spec
-    if (init.transfer && init.transfer.length > 0) {
-      detachArrayBuffers(init.transfer);
+    // Handle transfer option - detach specified ArrayBuffers per W3C spec.
+    // Transferring data's own buffer moves its memory to the decoder, which
+    // then reads it in place instead of copying it.
+    let transfer = init.transfer ?? [];
+    let adoptData = false;
+    if (buffer instanceof ArrayBuffer && transfer.includes(buffer)) {
+      const original = buffer;
+      try {
+        buffer = structuredClone(original, { transfer: [original] });
+        transfer = transfer.filter((b) => b !== original);
+        adoptData = true;
+      } catch {
+        // Untransferable (e.g. Node's Buffer pool): copied and detached below
+      }
+    }
+    const dataBuffer = Buffer.from(buffer, byteOffset, byteLength);
+    if (transfer.length > 0) {
+      detachArrayBuffers(transfer);
     }
 
-    this._initializeNative(dataBuffer, init);
+    this._initializeNative(dataBuffer, init, adoptData);
   }
 
-  private _initializeNative(dataBuffer: Buffer, init: ImageDecoderInit | { type: string }): void {
+  private _initializeNative(
+    data: Buffer | ImageFileSource,
+    init: ImageDecoderInit | { type: string },
+    adoptData = false,
+  ): void {
     // Build native init object with all supported options
     const nativeInit: {
       type: string;
-      data: Buffer;
+      data: Buffer | ImageFileSource;
+      adoptData?: boolean;
       colorSpaceConversion?: string;
       premultiplyAlpha?: string;
       desiredWidth?: number;
       desiredHeight?: number;
       preferAnimation?: boolean;
+      resizeQuality?: string;
+      scalingThreads?: number;
     } = {
       type: init.type,
-      data: dataBuffer,
+      data,
     };
+    if (adoptData) {
+      nativeInit.adoptData = true;
+    }
 
     // Pass additional options if they are present in the full init object
     if ('colorSpaceConversion' in init && init.colorSpaceConversion) {
@@ -127,6 +172,12 @@ export class ImageDecoder {
     if ('preferAnimation' in init && init.preferAnimation !== undefined) {
       nativeInit.preferAnimation = init.preferAnimation;
     }
+    if (init.resizeQuality !== undefined) {
+      nativeInit.resizeQuality = init.resizeQuality;
+    }
+    if (init.scalingThreads !== undefined) {
+      nativeInit.scalingThreads = init.scalingThreads;
+    }
 
     this._native = new native.ImageDecoder(nativeInit);
     this._isStreaming = false;
@@ -156,8 +207,13 @@ export class ImageDecoder {
         offset += chunk.length;
       }
 
-      // Initialize native decoder with complete data and stored options
-      this._initializeNative(Buffer.from(fullData), this._initOptions || { type: this._type });
+      // Initialize native decoder with complete data and stored options;
+      // nothing else holds fullData, so the decoder reads it in place.
+      this._initializeNative(
+        Buffer.from(fullData.buffer),
+        this._initOptions || { type: this._type },
+        true,
+      );
     } catch (error) {
       // Cancel the reader to properly clean up and prevent additional rejections
       try {
@@ -0,0 +1,86 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+import { binding } from './binding';
+import type { NativeImageEncoder, NativeModule } from './native-types';
+import type { ImageEncodeResult, ImageEncoderConfig } from './types';
+import { VideoFrame } from './video-frame';
+
+const native = binding as NativeModule;
+
+// Native errors carry their DOMException name as a message prefix.
+function toDOMException(error: unknown): unknown {
+  const text = error instanceof Error ? error.message : '';
+  for (const name of ['NotSupportedError', 'AbortError']) {
+    if (text.startsWith(`${name}: `)) {
+      return new DOMException(text.slice(name.length + 2), name);
+    }
+  }
+  return error;
+}
+
+/**
+ * Encodes VideoFrames to JPEG, PNG, WebP or AVIF files.
+ *
+ * Frames go to the encoder in their own pixel format where it takes it, so
+ * an I420 frame from a VideoDecoder is not converted to RGBA first. Each
+ * encode() runs on the libuv thread pool; the frame may be closed as soon as
+ * it returns. Encodes on one ImageEncoder run one at a time, so use several
+ * to encode in parallel.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ *
+ * @example
+ * ```ts
+ * const encoder = new ImageEncoder({ type: 'image/jpeg', quality: 0.85, width: 320 });
+ * const { data } = await encoder.encode(frame);
+ * frame.close();
+ * fs.writeFileSync('thumbnail.jpg', data);
+ * ```
+ */
+export class ImageEncoder {
+  private _native: NativeImageEncoder;
+  private _closed = false;
+
+  constructor(config: ImageEncoderConfig) {
+    try {
+      this._native = new native.ImageEncoder(config);
+    } catch (error) {
+      throw toDOMException(error);
+    }
+  }
+
+  get type(): string {
+    return this._native.type;
+  }
+
+  async encode(frame: VideoFrame): Promise<ImageEncodeResult> {
+    if (this._closed) {
+      throw new DOMException('ImageEncoder is closed', 'InvalidStateError');
+    }
+    if (!(frame instanceof VideoFrame)) {
+      throw new TypeError('frame must be a VideoFrame');
+    }
+    if (frame.format === null) {
+      throw new DOMException('VideoFrame is closed', 'InvalidStateError');
+    }
+    try {
+      // The colour space as the frame reports it, including overrides the
+      // native frame does not hold.
+      return await this._native.encode(frame._nativeFrame, frame.colorSpace.toJSON());
+    } catch (error) {
+      throw toDOMException(error);
+    }
+  }
+
+  /** Pending encodes reject with an AbortError. */
+  close(): void {
+    if (!this._closed) {
+      this._closed = true;
+      this._native.close();
+    }
+  }
+
+  static async isTypeSupported(type: string): Promise<boolean> {
+    return native.ImageEncoder.isTypeSupported(type);
+  }
+}
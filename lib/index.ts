@@ -11,12 +11,15 @@
  * - VideoFrame constructor accepts ImageData (from canvas.getImageData()) - Node.js extension
  *   Usage: const frame = new VideoFrame(ctx.getImageData(0, 0, w, h), { timestamp: 0 })
  * - ImageDecoder decodes JPEG/PNG/WebP/GIF directly to VideoFrame
+ * - ImageEncoder encodes a VideoFrame to JPEG/PNG/WebP/AVIF - Node.js extension
  * - 10-bit alpha formats (I420AP10, I422AP10, I444AP10) supported
  * - SVC temporal layer tracking via scalabilityMode (L1T1, L1T2, L1T3)
  */
 
 import { binding, platformInfo } from './binding';
 import type { NativeModule } from './native-types';
+import { ResourceManager } from './resource-manager';
+import type { FramePoolStats, MemoryUsage, SwsPoolStats } from './types';
 
 // Load native addon with type assertion
 const native = binding as NativeModule;
@@ -31,11 +34,22 @@ export { AudioEncoder } from './audio-encoder';
 export { Demuxer } from './demuxer';
 export { EncodedAudioChunk, EncodedVideoChunk } from './encoded-chunks';
 export { ImageDecoder } from './image-decoder';
+export { ImageEncoder } from './image-encoder';
 export { Muxer } from './muxer';
+export { ParallelVideoEncoder } from './parallel-video-encoder';
+export { Pipeline } from './pipeline';
+export { SharedFrameRing } from './shared-frame-ring';
 export { VideoDecoder } from './video-decoder';
 export { VideoEncoder } from './video-encoder';
 export { VideoFilter } from './video-filter';
+export { VideoScaler } from './video-scaler';
 export { VideoColorSpace, VideoFrame } from './video-frame';
+export {
+  attachTransferred,
+  detachForTransfer,
+  pendingTransfers,
+  releaseTransferred,
+} from './worker-transfer';
 
 // Export WarningAccumulator from native binding
 export const WarningAccumulator = native.WarningAccumulator;
@@ -50,6 +64,73 @@ export const createEncoderConfigDescriptor = native.createEncoderConfigDescripto
 // Export instance counters for monitoring and leak detection
 export const getCounters = native.getCounters;
 
+/**
+ * Hit/miss statistics for the pool that backs decoded and encoder-input
+ * frame buffers, and a way to release its idle memory.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export const getFramePoolStats: () => FramePoolStats = native.getFramePoolStats;
+export const trimFramePool: () => void = native.trimFramePool;
+
+/**
+ * Hit/miss statistics for the cache of pixel-format conversion contexts
+ * shared by the codecs, VideoFrame.copyTo(), ImageDecoder and VideoScaler,
+ * and a way to free its idle contexts.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export const getSwsPoolStats: () => SwsPoolStats = native.getSwsPoolStats;
+export const trimSwsPool: () => void = native.trimSwsPool;
+
+/**
+ * Run codec workers on a shared, core-sized thread pool instead of one
+ * thread per codec instance. Affects codecs configured after the call.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ * @param size Pool threads; defaults to the CPU core count. 0 restores
+ *   dedicated threads for newly configured codecs.
+ * @returns The effective pool size (0 when disabled)
+ */
+export const configureWorkerPool: (size?: number) => number = native.configureWorkerPool;
+
+/**
+ * Record every codec's pipeline stages (queue wait, encode/decode,
+ * conversion, output delivery) until stopTracing(), which returns Chrome
+ * trace-event JSON for chrome://tracing or https://ui.perfetto.dev.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ * @param maxEvents Events kept before further ones are counted as dropped
+ *   (default 1048576)
+ */
+export const startTracing: (maxEvents?: number) => void = native.startTracing;
+export const stopTracing: () => string = native.stopTracing;
+
+/**
+ * Native memory held by frames, chunks, the frame pool and codec queues.
+ * The same bytes are reported to V8 as external memory, so the GC sees the
+ * real cost of unclosed objects.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export const getMemoryUsage: () => MemoryUsage = native.getMemoryUsage;
+
+/**
+ * Set a soft limit on native memory (see getMemoryUsage()). While usage is
+ * above it, encode()/decode() first trim the frame pool and reclaim inactive
+ * codecs, then throw QuotaExceededError if usage is still above it.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ * @param bytes Limit in bytes; 0 removes it
+ */
+export function setMemoryLimit(bytes: number): void {
+  native.setMemoryLimit(bytes);
+  ResourceManager.getInstance().setMemoryLimit(bytes, {
+    usage: () => native.getMemoryUsage().total,
+    trim: () => native.trimFramePool(),
+  });
+}
+
 export type { ErrorCodeType } from './errors';
 // Re-export error classes and codes
 export {
@@ -76,6 +157,8 @@ export type {
   // Fundamental types
   AllowSharedBufferSource,
   AlphaOption,
+  AudioAnalysis,
+  AudioAnalysisConfig,
   AudioDataConstructor,
   AudioDataCopyToOptions,
   // Audio data
@@ -97,11 +180,21 @@ export type {
   // Additional types (not in W3C spec)
   BlurRegion,
   BufferSource,
+  CodecStageStats,
   // Codec state
   CodecState,
+  CodecStats,
+  CodecThreadingConfig,
   ColorSpaceConversion,
+  DemuxerAsyncOptions,
+  DemuxerBackpressureTarget,
   DemuxerChunk,
   DemuxerInit,
+  DemuxerOpenOptions,
+  DemuxerPullSource,
+  DemuxerSeekMode,
+  DemuxerSeekOptions,
+  DemuxerSource,
   DOMHighResTimeStamp,
   // DOM rect types
   DOMRectInit,
@@ -119,6 +212,8 @@ export type {
   EncodedVideoChunkMetadata,
   EncodedVideoChunkOutputCallback,
   EncodedVideoChunkType,
+  EncoderPreset,
+  FramePoolStats,
   // Hardware/quality hints
   HardwareAcceleration,
   // Image decoder
@@ -127,19 +222,40 @@ export type {
   ImageDecodeResult,
   ImageDecoderConstructor,
   ImageDecoderInit,
+  ImageEncodeResult,
+  ImageEncoderConfig,
+  ImageFileSource,
   LatencyMode,
+  MemoryUsage,
   // Muxer types
   MuxerAudioTrackConfig,
+  MuxerFormat,
   MuxerInit,
   MuxerVideoTrackConfig,
   OpusEncoderConfig,
+  ParallelVideoEncoderConfig,
+  // Pipeline types
+  PipelineInit,
+  PipelineStats,
+  PipelineVideoConfig,
   // Plane layout
   PlaneLayout,
   PredefinedColorSpace,
+  QueuePolicy,
+  ResizeQuality,
+  SharedFrameRingInit,
+  SharedFrameRingWaitOptions,
   SvcOutputMetadata,
+  SwsPoolStats,
   // Test video generator
   TestVideoGeneratorConfig,
+  ThreadPriority,
   TrackInfo,
+  TransferredAudioData,
+  TransferredEncodedAudioChunk,
+  TransferredEncodedVideoChunk,
+  TransferredMedia,
+  TransferredVideoFrame,
   // Video color space
   VideoColorPrimaries,
   VideoColorSpaceConstructor,
@@ -147,6 +263,7 @@ export type {
   // Video decoder
   VideoDecoderConfig,
   VideoDecoderConstructor,
+  VideoDecoderDecodeOptions,
   VideoDecoderInit,
   VideoDecoderSupport,
   // Bitrate modes
@@ -161,8 +278,11 @@ export type {
   VideoEncoderEncodeOptionsForHevc,
   VideoEncoderEncodeOptionsForVp9,
   VideoEncoderInit,
+  VideoEncoderRegionOfInterest,
   VideoEncoderSupport,
   VideoFilterConfig,
+  VideoFilterGraphConfig,
+  VideoFilterGraphInput,
   VideoFrameBufferInit,
   VideoFrameConstructor,
   VideoFrameCopyToOptions,
@@ -174,6 +294,8 @@ export type {
   VideoMatrixCoefficients,
   // Video pixel format
   VideoPixelFormat,
+  VideoScalerConfig,
+  VideoScalerRendition,
   VideoTransferCharacteristics,
   // Error callback
   WebCodecsErrorCallback,
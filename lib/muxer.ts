@@ -2,19 +2,28 @@
 // SPDX-License-Identifier: MIT
 
 import { binding } from './binding';
-import type { EncodedAudioChunk, EncodedVideoChunk } from './encoded-chunks';
+import { EncodedAudioChunk, EncodedVideoChunk } from './encoded-chunks';
 import type { NativeModule, NativeMuxer } from './native-types';
 import type { MuxerAudioTrackConfig, MuxerInit, MuxerVideoTrackConfig } from './types';
 
 const native = binding as NativeModule;
 
 export class Muxer {
-  private _native: NativeMuxer;
+  /** @internal */
+  _native: NativeMuxer;
 
   constructor(init: MuxerInit) {
-    this._native = new native.Muxer({ filename: init.filename });
+    this._native = new native.Muxer({
+      filename: init.filename,
+      format: init.format,
+      onData: init.onData,
+    });
   }
 
+  /**
+   * Add all tracks before writing starts, either with the first chunk or
+   * when an encoder is attached (VideoEncoder/AudioEncoder.attachMuxer()).
+   */
   addVideoTrack(config: MuxerVideoTrackConfig): number {
     return this._native.addVideoTrack(config);
   }
@@ -23,14 +32,35 @@ export class Muxer {
     return this._native.addAudioTrack(config);
   }
 
+  /**
+   * Packets accepted by writeVideoChunk()/writeAudioChunk() that the
+   * background writer has not written yet. Writes wait for room once this
+   * reaches the internal limit.
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  get writeQueueSize(): number {
+    return this._native.writeQueueSize;
+  }
+
+  // Native chunks are passed through so the writer shares their payload.
   writeVideoChunk(chunk: EncodedVideoChunk): void {
-    this._native.writeVideoChunk(chunk);
+    this._native.writeVideoChunk(chunk instanceof EncodedVideoChunk ? chunk._native : chunk);
   }
 
   writeAudioChunk(chunk: EncodedAudioChunk): void {
-    this._native.writeAudioChunk(chunk);
+    this._native.writeAudioChunk(chunk instanceof EncodedAudioChunk ? chunk._nativeChunk : chunk);
+  }
+
+  /**
+   * Wait until every queued chunk has been written (and, with onData,
+   * delivered).
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  async flush(): Promise<void> {
+    return this._native.flush();
   }
 
+  /** Write any queued chunks and the trailer. Blocks until done. */
   finalize(): void {
     this._native.finalize();
   }
@@ -4,16 +4,32 @@
  */
 
 import type {
+  AudioAnalysis,
   AudioDecoderConfig,
   AudioEncoderConfig,
   AudioSampleFormat,
   BlurRegion,
   CodecState,
+  CodecStats,
+  DemuxerOpenOptions,
+  FramePoolStats,
+  ImageEncodeResult,
+  ImageEncoderConfig,
+  ImageFileSource,
+  MemoryUsage,
+  PipelineStats,
+  PipelineVideoConfig,
+  SharedFrameRingInit,
+  SwsPoolStats,
   TrackInfo,
   VideoColorSpaceInit,
   VideoDecoderConfig,
+  VideoDecoderDecodeOptions,
   VideoEncoderConfig,
+  VideoEncoderEncodeOptions,
   VideoFilterConfig,
+  VideoFilterGraphConfig,
+  VideoScalerConfig,
 } from './types';
 
 // Branded type for closed resources
@@ -50,6 +66,16 @@ export interface NativeVideoFrame {
     dest: Uint8Array | ArrayBuffer,
     options?: { format?: string },
   ): Promise<PlaneLayoutResult[]>;
+  detach(): NativeDetached;
+}
+
+/**
+ * Returned by detach() on native media objects: a TransferRegistry handle
+ * for the moved storage and the init dictionary to rebuild the object with.
+ */
+export interface NativeDetached {
+  handle: number;
+  init: Record<string, unknown>;
 }
 
 export interface PlaneLayoutResult {
@@ -67,10 +93,27 @@ export interface NativeVideoEncoder {
   readonly pendingChunks: number;
 
   configure(config: VideoEncoderConfig): void;
-  encode(frame: NativeVideoFrame, options?: { keyFrame?: boolean }): void;
+  /**
+   * Returns how many requests the queue policy dropped (this one included
+   * when it was dropped itself), or -1 when the 'block' policy found the
+   * queue full and nothing was queued.
+   */
+  encode(frame: NativeVideoFrame, options?: VideoEncoderEncodeOptions): number;
+  /**
+   * Queue the items in order under one queue lock. Returns [items
+   * consumed, requests dropped]; fewer than all are consumed only when the
+   * 'block' policy found the queue full.
+   */
+  encodeBatch(
+    frames: NativeVideoFrame[],
+    options?: readonly (VideoEncoderEncodeOptions | undefined)[],
+  ): [number, number];
   flush(): void;
   reset(): void;
   close(): void;
+  getStats(): CodecStats;
+  resetStats(): void;
+  attachMuxer(muxer: NativeMuxer, trackIndex: number): void;
 }
 
 /**
@@ -83,10 +126,27 @@ export interface NativeVideoDecoder {
   readonly pendingFrames: number;
 
   configure(config: VideoDecoderConfig): void;
-  decode(chunk: NativeEncodedVideoChunk): void;
+  /**
+   * Returns how many requests the queue policy dropped (this one included
+   * when it was dropped itself, or queued to output no frame because of
+   * skipOutput or skipFrames 'nonkey'), or -1 when the 'block' policy
+   * found the queue full and nothing was queued.
+   */
+  decode(chunk: NativeEncodedVideoChunk, options?: VideoDecoderDecodeOptions): number;
+  /**
+   * Queue the items in order under one queue lock. Returns [items
+   * consumed, requests dropped]; fewer than all are consumed only when the
+   * 'block' policy found the queue full.
+   */
+  decodeBatch(
+    chunks: NativeEncodedVideoChunk[],
+    options?: readonly (VideoDecoderDecodeOptions | undefined)[],
+  ): [number, number];
   flush(): Promise<void>;
   reset(): void;
   close(): void;
+  getStats(): CodecStats;
+  resetStats(): void;
 }
 
 /**
@@ -97,9 +157,11 @@ export interface NativeEncodedVideoChunk {
   readonly timestamp: number;
   readonly duration: number | null;
   readonly byteLength: number;
+  readonly decodeTimestamp: number;
 
   copyTo(dest: Uint8Array | ArrayBuffer): void;
   close(): void;
+  detach(): NativeDetached;
 }
 
 /**
@@ -117,6 +179,7 @@ export interface NativeAudioData {
   clone(): NativeAudioData;
   allocationSize(options?: { planeIndex?: number; format?: string }): number;
   copyTo(dest: Uint8Array | ArrayBuffer, options?: { planeIndex?: number; format?: string }): void;
+  detach(): NativeDetached;
 }
 
 /**
@@ -130,6 +193,7 @@ export interface NativeEncodedAudioChunk {
 
   copyTo(dest: Uint8Array | ArrayBuffer): void;
   close(): void;
+  detach(): NativeDetached;
 }
 
 /**
@@ -141,10 +205,24 @@ export interface NativeAudioEncoder {
   readonly codecSaturated: boolean;
 
   configure(config: AudioEncoderConfig): void;
-  encode(data: NativeAudioData): void;
+  /**
+   * Returns how many requests the queue policy dropped (this one included
+   * when it was dropped itself), or -1 when the 'block' policy found the
+   * queue full and nothing was queued.
+   */
+  encode(data: NativeAudioData): number;
+  /**
+   * Queue the items in order under one queue lock. Returns [items
+   * consumed, requests dropped]; fewer than all are consumed only when the
+   * 'block' policy found the queue full.
+   */
+  encodeBatch(data: NativeAudioData[]): [number, number];
   flush(): Promise<void>;
   reset(): void;
   close(): void;
+  getStats(): CodecStats;
+  resetStats(): void;
+  attachMuxer(muxer: NativeMuxer, trackIndex: number): void;
 }
 
 /**
@@ -155,10 +233,24 @@ export interface NativeAudioDecoder {
   readonly decodeQueueSize: number;
 
   configure(config: AudioDecoderConfig): void;
-  decode(chunk: NativeEncodedAudioChunk): void;
+  /**
+   * Returns how many requests the queue policy dropped (this one included
+   * when it was dropped itself), or -1 when the 'block' policy found the
+   * queue full and nothing was queued.
+   */
+  decode(chunk: NativeEncodedAudioChunk): number;
+  /**
+   * Queue the items in order under one queue lock. Returns [items
+   * consumed, requests dropped]; fewer than all are consumed only when the
+   * 'block' policy found the queue full.
+   */
+  decodeBatch(chunks: NativeEncodedAudioChunk[]): [number, number];
   flush(): Promise<void>;
   reset(): void;
   close(): void;
+  getStats(): CodecStats;
+  resetStats(): void;
+  getAnalysis(): AudioAnalysis | null;
 }
 
 /**
@@ -167,6 +259,36 @@ export interface NativeAudioDecoder {
 export interface NativeVideoFilter {
   configure(config: VideoFilterConfig): void;
   applyBlur(frame: NativeVideoFrame, regions: BlurRegion[], blurRadius: number): NativeVideoFrame;
+  configureGraph(config: VideoFilterGraphConfig): void;
+  /** One entry per input (null to feed nothing); resolves to frames per output. */
+  process(frames: Array<NativeVideoFrame | null>): Promise<NativeVideoFrame[][]>;
+  flush(): Promise<NativeVideoFrame[][]>;
+  close(): void;
+}
+
+/**
+ * Native VideoScaler object from C++ addon
+ */
+export interface NativeVideoScaler {
+  /** Resolves to one frame per rendition, in configuration order. */
+  scale(frame: NativeVideoFrame): Promise<NativeVideoFrame[]>;
+  close(): void;
+}
+
+/**
+ * Native SharedFrameRing object from C++ addon
+ */
+export interface NativeSharedFrameRing {
+  readonly name: string;
+  readonly slotCount: number;
+  readonly slotSize: number;
+  readonly closed: boolean;
+  tryWrite(frame: NativeVideoFrame, props: object): boolean;
+  /** Resolves to false on timeout; a negative timeout waits forever. */
+  write(frame: NativeVideoFrame, timeoutMs: number, props: object): Promise<boolean>;
+  tryRead(): NativeVideoFrame | null;
+  /** Resolves to null once closed and drained. */
+  read(timeoutMs: number): Promise<NativeVideoFrame | null>;
   close(): void;
 }
 
@@ -174,7 +296,26 @@ export interface NativeVideoFilter {
  * Native Demuxer object from C++ addon
  */
 export interface NativeDemuxer {
-  open(path: string): void;
+  /**
+   * Open a path or Buffer synchronously, or a callback source
+   * asynchronously. `read` is called for each request and answered with
+   * pushReadResult().
+   */
+  open(
+    source:
+      | string
+      | Buffer
+      | { read: (id: number, offset: number, length: number) => void; size?: number },
+    options?: DemuxerOpenOptions,
+  ): void | Promise<void>;
+  /** Answer read request `id`; null marks the end of input. */
+  pushReadResult(id: number, data: Uint8Array | null, failed?: boolean): void;
+  /** Synchronous for paths and Buffers; a Promise for callback sources. */
+  seek(timestampUs: number, options?: { mode?: string }): void | Promise<void>;
+  buildKeyframeIndex(): Promise<Buffer>;
+  loadKeyframeIndex(index: Uint8Array): void;
+  /** Deliver only these tracks; the rest are discarded by the container. */
+  selectTracks(trackIndices: number[]): void;
   demux(): void;
   /**
    * Read packets from the file in chunks.
@@ -182,6 +323,16 @@ export interface NativeDemuxer {
    * @returns The number of packets actually read.
    */
   demuxPackets(maxPackets: number): number;
+  /**
+   * Read all packets on a worker thread, delivering them in batches.
+   * Resolves at end of stream; rejects on read errors or close().
+   */
+  demuxAsync(options: { highWaterMark?: number; downstreamHighWaterMark?: number }): Promise<void>;
+  /**
+   * Report the downstream decoder's decodeQueueSize for demuxAsync()
+   * backpressure.
+   */
+  setDownstreamQueueSize(size: number): void;
   close(): void;
   getVideoTrack(): TrackInfo | null;
   getAudioTrack(): TrackInfo | null;
@@ -226,12 +377,41 @@ export interface NativeMuxer {
     copyTo?: (dest: Uint8Array | ArrayBuffer) => void;
   }): void;
 
+  /** Packets queued for the writer thread and not yet written. */
+  readonly writeQueueSize: number;
+  /** Resolves once every queued packet has been written. */
+  flush(): Promise<void>;
   finalize(): void;
   close(): void;
 }
 
 export interface NativeMuxerConstructor {
-  new (options: { filename: string }): NativeMuxer;
+  new (options: {
+    filename?: string;
+    format?: string;
+    onData?: (data: Buffer, offset: number) => void;
+  }): NativeMuxer;
+}
+
+/**
+ * Native Pipeline object from C++ addon
+ */
+export interface NativePipeline {
+  readonly state: 'idle' | 'running' | 'done';
+  run(): Promise<PipelineStats>;
+  cancel(): void;
+}
+
+export interface NativePipelineConstructor {
+  new (options: {
+    input: string | BufferSource;
+    muxer: NativeMuxer;
+    trackIndex: number;
+    video: PipelineVideoConfig;
+    maxQueuedPackets?: number;
+    maxQueuedFrames?: number;
+    onProgress?: (stats: PipelineStats) => void;
+  }): NativePipeline;
 }
 
 /**
@@ -248,6 +428,15 @@ export interface NativeImageDecoder {
   close(): void;
 }
 
+/**
+ * Native ImageEncoder object from C++ addon
+ */
+export interface NativeImageEncoder {
+  readonly type: string;
+  encode(frame: NativeVideoFrame, colorSpace: VideoColorSpaceInit): Promise<ImageEncodeResult>;
+  close(): void;
+}
+
 export interface NativeImageTrackList {
   readonly length: number;
   readonly selectedIndex: number;
@@ -311,12 +500,7 @@ export type AudioDecoderOutputCallback = (data: NativeAudioData) => void;
 export type ErrorCallback = (error: Error | DOMException) => void;
 export type DemuxerTrackCallback = (track: TrackInfo) => void;
 export type DemuxerChunkCallback = (
-  chunk: {
-    type: string;
-    timestamp: number;
-    duration?: number;
-    data: Buffer;
-  },
+  chunk: NativeEncodedVideoChunk | NativeEncodedAudioChunk,
   trackIndex: number,
 ) => void;
 
@@ -338,17 +522,30 @@ export interface NativeVideoFrameConstructor {
       flip?: boolean;
     },
   ): NativeVideoFrame;
+  /** Claim the pixels of a frame detached in any thread of this process. */
+  new (handle: number, init: Record<string, unknown>): NativeVideoFrame;
 }
 
 export interface NativeVideoEncoderConstructor {
-  new (callbacks: { output: VideoEncoderOutputCallback; error: ErrorCallback }): NativeVideoEncoder;
+  new (callbacks: {
+    output: VideoEncoderOutputCallback;
+    error: ErrorCallback;
+    sinkProgress?: (packets: number) => void;
+    /** Called when an encode() refused by queuePolicy 'block' may be retried. */
+    dequeue?: () => void;
+  }): NativeVideoEncoder;
   isConfigSupported(
     config: VideoEncoderConfig,
   ): Promise<{ supported: boolean; config: VideoEncoderConfig }>;
 }
 
 export interface NativeVideoDecoderConstructor {
-  new (callbacks: { output: VideoDecoderOutputCallback; error: ErrorCallback }): NativeVideoDecoder;
+  new (callbacks: {
+    output: VideoDecoderOutputCallback;
+    error: ErrorCallback;
+    /** Called when a decode() refused by queuePolicy 'block' may be retried. */
+    dequeue?: () => void;
+  }): NativeVideoDecoder;
   isConfigSupported(
     config: VideoDecoderConfig,
   ): Promise<{ supported: boolean; config: VideoDecoderConfig }>;
@@ -363,6 +560,7 @@ export interface NativeAudioDataConstructor {
     timestamp: number;
     data: Buffer;
   }): NativeAudioData;
+  new (handle: number, init: Record<string, unknown>): NativeAudioData;
 }
 
 export interface NativeEncodedVideoChunkConstructor {
@@ -370,8 +568,10 @@ export interface NativeEncodedVideoChunkConstructor {
     type: string;
     timestamp: number;
     duration?: number;
+    decodeTimestamp?: number;
     data: Buffer;
   }): NativeEncodedVideoChunk;
+  new (init: Record<string, unknown>, handle: number): NativeEncodedVideoChunk;
 }
 
 export interface NativeEncodedAudioChunkConstructor {
@@ -381,17 +581,29 @@ export interface NativeEncodedAudioChunkConstructor {
     duration?: number;
     data: Buffer;
   }): NativeEncodedAudioChunk;
+  new (init: Record<string, unknown>, handle: number): NativeEncodedAudioChunk;
 }
 
 export interface NativeAudioEncoderConstructor {
-  new (callbacks: { output: AudioEncoderOutputCallback; error: ErrorCallback }): NativeAudioEncoder;
+  new (callbacks: {
+    output: AudioEncoderOutputCallback;
+    error: ErrorCallback;
+    sinkProgress?: (packets: number) => void;
+    /** Called when an encode() refused by queuePolicy 'block' may be retried. */
+    dequeue?: () => void;
+  }): NativeAudioEncoder;
   isConfigSupported(
     config: AudioEncoderConfig,
   ): Promise<{ supported: boolean; config: AudioEncoderConfig }>;
 }
 
 export interface NativeAudioDecoderConstructor {
-  new (callbacks: { output: AudioDecoderOutputCallback; error: ErrorCallback }): NativeAudioDecoder;
+  new (callbacks: {
+    output: AudioDecoderOutputCallback;
+    error: ErrorCallback;
+    /** Called when a decode() refused by queuePolicy 'block' may be retried. */
+    dequeue?: () => void;
+  }): NativeAudioDecoder;
   isConfigSupported(
     config: AudioDecoderConfig,
   ): Promise<{ supported: boolean; config: AudioDecoderConfig }>;
@@ -401,6 +613,14 @@ export interface NativeVideoFilterConstructor {
   new (config: VideoFilterConfig): NativeVideoFilter;
 }
 
+export interface NativeVideoScalerConstructor {
+  new (config: VideoScalerConfig): NativeVideoScaler;
+}
+
+export interface NativeSharedFrameRingConstructor {
+  new (init: SharedFrameRingInit): NativeSharedFrameRing;
+}
+
 export interface NativeDemuxerConstructor {
   new (callbacks: {
     onTrack?: DemuxerTrackCallback;
@@ -410,10 +630,19 @@ export interface NativeDemuxerConstructor {
 }
 
 export interface NativeImageDecoderConstructor {
-  new (init: { type: string; data: Buffer }): NativeImageDecoder;
+  new (init: {
+    type: string;
+    data: Buffer | ImageFileSource;
+    adoptData?: boolean;
+  }): NativeImageDecoder;
   isTypeSupported(type: string): Promise<boolean>;
 }
 
+export interface NativeImageEncoderConstructor {
+  new (config: ImageEncoderConfig): NativeImageEncoder;
+  isTypeSupported(type: string): boolean;
+}
+
 /**
  * Native TestVideoGenerator for generating test video frames
  */
@@ -425,6 +654,8 @@ export interface NativeTestVideoGenerator {
     frameRate?: number;
     duration?: number;
     pattern?: string;
+    format?: string;
+    poolSize?: number;
   }): void;
   generate(callback: (frame: NativeVideoFrame) => void): Promise<void>;
   close(): void;
@@ -504,10 +735,14 @@ export interface NativeModule {
   AudioEncoder: NativeAudioEncoderConstructor;
   AudioDecoder: NativeAudioDecoderConstructor;
   VideoFilter: NativeVideoFilterConstructor;
+  VideoScaler: NativeVideoScalerConstructor;
   Demuxer: NativeDemuxerConstructor;
   Muxer: NativeMuxerConstructor;
+  Pipeline: NativePipelineConstructor;
   ImageDecoder: NativeImageDecoderConstructor;
+  ImageEncoder: NativeImageEncoderConstructor;
   TestVideoGenerator: NativeTestVideoGeneratorConstructor;
+  SharedFrameRing: NativeSharedFrameRingConstructor;
   WarningAccumulator: NativeWarningAccumulatorConstructor;
   ErrorBuilder: NativeErrorBuilderConstructor;
 
@@ -531,6 +766,27 @@ export interface NativeModule {
     frames: number;
   };
 
+  // Frame buffer pool
+  getFramePoolStats: () => FramePoolStats;
+  trimFramePool: () => void;
+  getSwsPoolStats: () => SwsPoolStats;
+  trimSwsPool: () => void;
+
+  // Shared codec worker pool
+  configureWorkerPool: (size?: number) => number;
+
+  // Chrome trace-event recording of codec pipeline stages
+  startTracing: (maxEvents?: number) => void;
+  stopTracing: () => string;
+
+  // Native memory accounting
+  getMemoryUsage: () => MemoryUsage;
+  setMemoryLimit: (bytes: number) => void;
+
+  // Cross-thread transfer registry
+  releaseTransferHandle: (handle: number) => boolean;
+  pendingTransfers: () => number;
+
   // Descriptor factories
   createEncoderConfigDescriptor: (config: object) => {
     codec: string;
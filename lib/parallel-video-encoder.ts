@@ -0,0 +1,329 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+import { availableParallelism } from 'node:os';
+import { EncodedVideoChunk } from './encoded-chunks';
+import type {
+  CodecState,
+  EncodedVideoChunkMetadata,
+  ParallelVideoEncoderConfig,
+  VideoDecoderConfig,
+  VideoEncoderEncodeOptions,
+  VideoEncoderInit,
+} from './types';
+import { VideoEncoder } from './video-encoder';
+import type { VideoFrame } from './video-frame';
+
+const DEFAULT_SEGMENT_LENGTH = 120;
+
+// A run of frames that starts with a forced key frame and goes to a single
+// encoder. Chunks wait here until every earlier segment has been emitted.
+interface Segment {
+  encoder: number;
+  firstTimestamp: number;
+  frames: number;
+  received: number;
+  closed: boolean;
+  done: boolean;
+  chunks: Array<[EncodedVideoChunk, EncodedVideoChunkMetadata | undefined]>;
+}
+
+/**
+ * Encodes one video stream with several VideoEncoder instances at once for
+ * offline jobs. Input is cut into segments of `segmentLength` frames, each
+ * starting with a key frame (closed GOP), and segments go round-robin to
+ * `concurrency` encoders, each on its own native worker. Output is stitched
+ * back into presentation-segment order, so the callback sees one stream:
+ * decodeTimestamp stays strictly increasing across segment boundaries and
+ * decoderConfig is reported only when it changes.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ *
+ * Segments are encoded independently, so rate control restarts at every
+ * segment; short segments cost bitrate. Chunks of later segments are held
+ * until their turn, so keep an eye on encodeQueueSize for backpressure.
+ *
+ * @example
+ * ```ts
+ * const encoder = new ParallelVideoEncoder({ output: (chunk) => mux(chunk), error: console.error });
+ * encoder.configure({ codec: 'avc1.640028', width: 1920, height: 1080, concurrency: 8 });
+ * for (const frame of frames) {
+ *   encoder.encode(frame);
+ *   frame.close();
+ * }
+ * await encoder.flush();
+ * ```
+ */
+export class ParallelVideoEncoder {
+  private readonly _init: VideoEncoderInit;
+  private _encoders: VideoEncoder[] = [];
+  // Per encoder: segments still producing output, oldest first
+  private _pending: Segment[][] = [];
+  // Every segment not yet fully emitted, in input order
+  private _segments: Segment[] = [];
+  private _current: Segment | null = null;
+  private _nextEncoder = 0;
+  private _segmentLength = DEFAULT_SEGMENT_LENGTH;
+  private _lastDecodeTimestamp = -Infinity;
+  private _lastDecoderConfig: VideoDecoderConfig | null = null;
+  private _state: CodecState = 'unconfigured';
+
+  constructor(init: VideoEncoderInit) {
+    this._init = init;
+  }
+
+  get state(): CodecState {
+    return this._state;
+  }
+
+  /** Frames queued across every encoder. */
+  get encodeQueueSize(): number {
+    return this._encoders.reduce((sum, encoder) => sum + encoder.encodeQueueSize, 0);
+  }
+
+  /** Number of encoder instances; fixed by the first configure(). */
+  get concurrency(): number {
+    return this._encoders.length;
+  }
+
+  /**
+   * Configure every encoder. The first call creates `concurrency` encoders;
+   * later calls reconfigure them and start a new segment.
+   */
+  configure(config: ParallelVideoEncoderConfig): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Encoder is closed', 'InvalidStateError');
+    }
+    const { segmentLength, concurrency, ...encoderConfig } = config;
+    if (segmentLength !== undefined && (!Number.isInteger(segmentLength) || segmentLength < 1)) {
+      throw new TypeError('segmentLength must be a positive integer');
+    }
+    if (concurrency !== undefined && (!Number.isInteger(concurrency) || concurrency < 1)) {
+      throw new TypeError('concurrency must be a positive integer');
+    }
+
+    if (this._encoders.length === 0) {
+      const count = concurrency ?? availableParallelism();
+      for (let i = 0; i < count; i++) {
+        this._encoders.push(
+          new VideoEncoder({
+            output: (chunk, metadata) => this._onOutput(i, chunk, metadata),
+            error: (e) => this._onError(e),
+          }),
+        );
+        this._pending.push([]);
+      }
+    }
+
+    // Split the cores between instances unless the caller chose threading.
+    if (encoderConfig.threading === undefined) {
+      const count = Math.max(1, Math.floor(availableParallelism() / this._encoders.length));
+      encoderConfig.threading = { count };
+    }
+    for (const encoder of this._encoders) {
+      encoder.configure(encoderConfig);
+    }
+    this._segmentLength = segmentLength ?? DEFAULT_SEGMENT_LENGTH;
+    this._closeSegment();
+    this._state = 'configured';
+  }
+
+  /**
+   * Queue a frame on the encoder that owns the current segment. The first
+   * frame of each segment is always encoded as a key frame.
+   */
+  encode(frame: VideoFrame, options?: VideoEncoderEncodeOptions): void | Promise<void> {
+    if (this._state !== 'configured') {
+      throw new DOMException(`Encoder is ${this._state}`, 'InvalidStateError');
+    }
+    let keyFrame = options?.keyFrame ?? false;
+    if (this._current === null || this._current.frames >= this._segmentLength) {
+      this._closeSegment();
+      const segment: Segment = {
+        encoder: this._nextEncoder,
+        firstTimestamp: frame.timestamp,
+        frames: 0,
+        received: 0,
+        closed: false,
+        done: false,
+        chunks: [],
+      };
+      this._nextEncoder = (this._nextEncoder + 1) % this._encoders.length;
+      this._segments.push(segment);
+      this._pending[segment.encoder].push(segment);
+      this._current = segment;
+      keyFrame = true;
+    }
+    this._current.frames++;
+    return this._encoders[this._current.encoder].encode(frame, { ...options, keyFrame });
+  }
+
+  /** Flush every encoder and emit all remaining chunks in order. */
+  async flush(): Promise<void> {
+    if (this._state !== 'configured') {
+      return Promise.reject(new DOMException(`Encoder is ${this._state}`, 'InvalidStateError'));
+    }
+    this._closeSegment();
+    await Promise.all(this._encoders.map((encoder) => encoder.flush()));
+    // Every frame is out, whatever the per-segment counts say.
+    for (const segment of this._segments) {
+      segment.done = true;
+    }
+    for (const pending of this._pending) {
+      pending.length = 0;
+    }
+    this._drain();
+  }
+
+  reset(): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Encoder is closed', 'InvalidStateError');
+    }
+    for (const encoder of this._encoders) {
+      encoder.reset();
+    }
+    this._discard();
+    this._state = 'unconfigured';
+  }
+
+  close(): void {
+    for (const encoder of this._encoders) {
+      encoder.close();
+    }
+    this._discard();
+    this._state = 'closed';
+  }
+
+  private _closeSegment(): void {
+    const segment = this._current;
+    if (segment === null) {
+      return;
+    }
+    segment.closed = true;
+    this._current = null;
+    this._settle(segment);
+  }
+
+  // A closed segment is done once all its frames are out; then the next one
+  // on the same encoder starts receiving.
+  private _settle(segment: Segment): void {
+    if (!segment.closed || segment.received < segment.frames) {
+      return;
+    }
+    segment.done = true;
+    const pending = this._pending[segment.encoder];
+    if (pending[0] === segment) {
+      pending.shift();
+    }
+    this._drain();
+  }
+
+  private _onOutput(index: number, chunk: EncodedVideoChunk, metadata?: EncodedVideoChunkMetadata): void {
+    const pending = this._pending[index];
+    // A dropped frame would stall count-based attribution; the key frame
+    // that opens the next segment moves it on regardless.
+    while (pending.length > 1 && chunk.type === 'key' && chunk.timestamp === pending[1].firstTimestamp) {
+      pending[0].done = true;
+      pending.shift();
+    }
+    const segment = pending[0];
+    if (segment === undefined) {
+      chunk.close();
+      return;
+    }
+    segment.chunks.push([chunk, metadata]);
+    segment.received++;
+    this._drain();
+    this._settle(segment);
+  }
+
+  // Emit buffered chunks of the oldest segment; move on once it is done.
+  private _drain(): void {
+    while (this._segments.length > 0) {
+      const head = this._segments[0];
+      for (const [chunk, metadata] of head.chunks) {
+        this._emit(chunk, metadata);
+      }
+      head.chunks.length = 0;
+      if (!head.done) {
+        return;
+      }
+      this._segments.shift();
+    }
+  }
+
+  private _emit(chunk: EncodedVideoChunk, metadata?: EncodedVideoChunkMetadata): void {
+    if (this._state === 'closed') {
+      chunk.close();
+      return;
+    }
+    // Each segment starts its own decode timeline, which can reach back
+    // before the previous segment's last chunk once B-frames are in play.
+    let out = chunk;
+    const decodeTimestamp = Math.max(chunk.decodeTimestamp, this._lastDecodeTimestamp + 1);
+    if (decodeTimestamp !== chunk.decodeTimestamp && decodeTimestamp <= chunk.timestamp) {
+      const data = new Uint8Array(chunk.byteLength);
+      chunk.copyTo(data);
+      out = new EncodedVideoChunk({
+        type: chunk.type,
+        timestamp: chunk.timestamp,
+        duration: chunk.duration ?? undefined,
+        decodeTimestamp,
+        data,
+      });
+      chunk.close();
+    }
+    this._lastDecodeTimestamp = out.decodeTimestamp;
+
+    let outMetadata = metadata;
+    if (metadata?.decoderConfig) {
+      if (this._lastDecoderConfig && sameDecoderConfig(this._lastDecoderConfig, metadata.decoderConfig)) {
+        const { decoderConfig: _, ...rest } = metadata;
+        outMetadata = rest;
+      } else {
+        this._lastDecoderConfig = metadata.decoderConfig;
+      }
+    }
+    this._init.output(out, outMetadata);
+  }
+
+  private _onError(e: Error | DOMException): void {
+    if (this._state === 'closed') {
+      return;
+    }
+    this.close();
+    this._init.error(e);
+  }
+
+  private _discard(): void {
+    for (const segment of this._segments) {
+      for (const [chunk] of segment.chunks) {
+        chunk.close();
+      }
+    }
+    this._segments = [];
+    this._pending = this._pending.map(() => []);
+    this._current = null;
+    this._nextEncoder = 0;
+    this._lastDecodeTimestamp = -Infinity;
+    this._lastDecoderConfig = null;
+  }
+}
+
+function sameDecoderConfig(a: VideoDecoderConfig, b: VideoDecoderConfig): boolean {
+  if (a.codec !== b.codec || a.codedWidth !== b.codedWidth || a.codedHeight !== b.codedHeight) {
+    return false;
+  }
+  const da = a.description ? toBytes(a.description) : null;
+  const db = b.description ? toBytes(b.description) : null;
+  if (da === null || db === null) {
+    return da === db;
+  }
+  return da.length === db.length && da.every((byte, i) => byte === db[i]);
+}
+
+function toBytes(source: BufferSource): Uint8Array {
+  if (ArrayBuffer.isView(source)) {
+    return new Uint8Array(source.buffer, source.byteOffset, source.byteLength);
+  }
+  return new Uint8Array(source);
+}
@@ -0,0 +1,63 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+import { binding } from './binding';
+import type { NativeModule, NativePipeline } from './native-types';
+import type { PipelineInit, PipelineStats } from './types';
+
+const native = binding as NativeModule;
+
+/**
+ * Transcodes the first video stream of an input into a Muxer track on
+ * native threads: demux, decode, scale and encode never hand a packet or
+ * frame to JavaScript. Stage queues are bounded, so a slow encoder pauses
+ * reading instead of buffering the whole input.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ *
+ * @example
+ * ```ts
+ * const muxer = new Muxer({ filename: 'out.mp4' });
+ * const trackIndex = muxer.addVideoTrack({ codec: 'avc1.42001f', width: 640, height: 360 });
+ * const pipeline = new Pipeline({
+ *   input: 'in.mp4',
+ *   muxer,
+ *   trackIndex,
+ *   video: { codec: 'avc1.42001f', width: 640, height: 360, bitrate: 1_000_000 },
+ * });
+ * const stats = await pipeline.run();
+ * muxer.finalize();
+ * ```
+ */
+export class Pipeline {
+  private readonly _native: NativePipeline;
+
+  constructor(init: PipelineInit) {
+    this._native = new native.Pipeline({
+      input: init.input,
+      muxer: init.muxer._native,
+      trackIndex: init.trackIndex,
+      video: init.video,
+      maxQueuedPackets: init.maxQueuedPackets,
+      maxQueuedFrames: init.maxQueuedFrames,
+      onProgress: init.onProgress,
+    });
+  }
+
+  get state(): 'idle' | 'running' | 'done' {
+    return this._native.state;
+  }
+
+  /**
+   * Run the transcode once. Resolves with the final stats after every
+   * packet has been handed to the muxer; rejects with an AbortError after
+   * cancel().
+   */
+  async run(): Promise<PipelineStats> {
+    return this._native.run();
+  }
+
+  /** Stop reading and abandon queued work; run() rejects. */
+  cancel(): void {
+    this._native.cancel();
+  }
+}
@@ -11,6 +11,11 @@
  * - MUST NOT reclaim codec that is both active AND foreground
  * - MUST NOT reclaim active background encoder
  * - To reclaim, run close algorithm with QuotaExceededError
+ *
+ * node-webcodecs extension: with a native memory soft limit set
+ * (setMemoryLimit()), codecs call relieveMemoryPressure() before queueing
+ * work, which frees idle pooled buffers and then reclaims inactive codecs
+ * while native memory is over the limit.
  */
 
 /**
@@ -32,6 +37,16 @@ type CodecType = 'encoder' | 'decoder';
  */
 type ErrorCallback = (error: DOMException) => void;
 
+/**
+ * Native memory hooks for the memory-pressure path.
+ */
+export interface MemoryProbe {
+  /** Bytes currently held natively */
+  usage(): number;
+  /** Release idle pooled memory */
+  trim(): void;
+}
+
 interface CodecEntry {
   codec: ManagedCodec;
   lastActivity: number;
@@ -44,6 +59,8 @@ export class ResourceManager {
   private static instance: ResourceManager | null = null;
   private readonly codecs: Map<symbol, CodecEntry> = new Map();
   private inactivityTimeout: number = 10000; // Spec 11: 10 seconds
+  private memoryLimit: number = 0;
+  private memoryProbe: MemoryProbe | null = null;
 
   private constructor() {
     // Monitoring happens on-demand via getReclaimableCodecs()
@@ -218,6 +235,35 @@ export class ResourceManager {
     return reclaimed;
   }
 
+  /**
+   * Set the native memory soft limit (0 disables it). Called by
+   * setMemoryLimit(), which also sets it natively.
+   */
+  setMemoryLimit(bytes: number, probe: MemoryProbe | null): void {
+    this.memoryLimit = bytes;
+    this.memoryProbe = bytes > 0 ? probe : null;
+  }
+
+  /**
+   * Memory-pressure reclamation: while native memory is over the soft limit,
+   * trim idle pools, then reclaim inactive codecs. Costs nothing without a
+   * limit. Codecs still over the limit afterwards refuse encode()/decode()
+   * with QuotaExceededError.
+   *
+   * @returns Number of codecs reclaimed
+   */
+  relieveMemoryPressure(): number {
+    const probe = this.memoryProbe;
+    if (!probe || probe.usage() <= this.memoryLimit) {
+      return 0;
+    }
+    probe.trim();
+    if (probe.usage() <= this.memoryLimit) {
+      return 0;
+    }
+    return this.reclaimInactive();
+  }
+
   /**
    * Set inactivity timeout (for testing).
    */
@@ -240,5 +286,7 @@ export class ResourceManager {
   _resetForTesting(): void {
     this.codecs.clear();
     this.inactivityTimeout = 10000;
+    this.memoryLimit = 0;
+    this.memoryProbe = null;
   }
 }
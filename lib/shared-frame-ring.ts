@@ -0,0 +1,176 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+import { binding } from './binding';
+import type { NativeModule, NativeSharedFrameRing, NativeVideoFrame } from './native-types';
+import type {
+  SharedFrameRingInit,
+  SharedFrameRingWaitOptions,
+  VideoColorSpaceInit,
+} from './types';
+import { VideoFrame } from './video-frame';
+
+const native = binding as NativeModule;
+
+function wrapNativeFrame(nativeFrame: NativeVideoFrame): VideoFrame {
+  // biome-ignore lint/suspicious/noExplicitAny: Object.create wrapper pattern requires any for property assignment
+  const wrapper = Object.create(VideoFrame.prototype) as any;
+  wrapper._native = nativeFrame;
+  wrapper._closed = false;
+  wrapper._metadata = {};
+  return wrapper as VideoFrame;
+}
+
+// Native errors carry their DOMException name as a message prefix.
+function toDOMException(error: unknown): unknown {
+  const text = error instanceof Error ? error.message : '';
+  for (const name of ['InvalidStateError', 'TimeoutError']) {
+    if (text.startsWith(`${name}: `)) {
+      return new DOMException(text.slice(name.length + 2), name);
+    }
+  }
+  return error;
+}
+
+/**
+ * Ring of VideoFrame slots in POSIX shared memory, for handing decoded
+ * frames from one process to another.
+ *
+ * The producer's write() copies a frame's pixels once, straight into a free
+ * slot; the consumer's read() returns a VideoFrame whose planes are that
+ * slot, so nothing is copied on its side. A slot goes back to the producer
+ * when the consumer closes the frame (or an encoder it was passed to is done
+ * with it), so hold as few frames as possible: the producer waits once every
+ * slot is in use. close() on either side ends the stream; the consumer still
+ * reads the frames written before it.
+ *
+ * One producer and one consumer per ring. Waiting write() and read() calls
+ * each hold a libuv thread pool thread; give them a timeout.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ *
+ * @example
+ * ```ts
+ * // Producer process
+ * const ring = new SharedFrameRing({
+ *   name: '/camera-0', create: true, slots: 4, slotSize: 1920 * 1080 * 1.5,
+ * });
+ * decoder = new VideoDecoder({
+ *   output: async (frame) => { await ring.write(frame); frame.close(); },
+ *   error: console.error,
+ * });
+ *
+ * // Consumer process
+ * const ring = new SharedFrameRing({ name: '/camera-0' });
+ * for (let frame; (frame = await ring.read()); ) {
+ *   encoder.encode(frame);
+ *   frame.close();
+ * }
+ * ```
+ */
+export class SharedFrameRing {
+  private _native: NativeSharedFrameRing;
+
+  constructor(init: SharedFrameRingInit) {
+    this._native = new native.SharedFrameRing(init);
+  }
+
+  /** The shm_open() name both processes use */
+  get name(): string {
+    return this._native.name;
+  }
+
+  get slotCount(): number {
+    return this._native.slotCount;
+  }
+
+  /** Bytes per slot; frames with a larger allocationSize() are rejected */
+  get slotSize(): number {
+    return this._native.slotSize;
+  }
+
+  /** True once either process has called close() */
+  get closed(): boolean {
+    return this._native.closed;
+  }
+
+  /** Write `frame` if a slot is free; returns false if the ring is full. */
+  tryWrite(frame: VideoFrame): boolean {
+    try {
+      return this._native.tryWrite(
+        SharedFrameRing._frameOf(frame),
+        SharedFrameRing._propsOf(frame),
+      );
+    } catch (error) {
+      throw toDOMException(error);
+    }
+  }
+
+  /**
+   * Write `frame`, waiting for the consumer to free a slot. Resolves to false
+   * if `timeout` ms pass first. The caller keeps ownership of `frame`.
+   */
+  async write(frame: VideoFrame, options?: SharedFrameRingWaitOptions): Promise<boolean> {
+    try {
+      return await this._native.write(
+        SharedFrameRing._frameOf(frame),
+        options?.timeout ?? -1,
+        SharedFrameRing._propsOf(frame),
+      );
+    } catch (error) {
+      throw toDOMException(error);
+    }
+  }
+
+  /** The next frame if one has been written, otherwise null. */
+  tryRead(): VideoFrame | null {
+    const nativeFrame = this._native.tryRead();
+    return nativeFrame ? wrapNativeFrame(nativeFrame) : null;
+  }
+
+  /**
+   * The next frame, waiting for the producer. Resolves to null once the ring
+   * is closed and drained; rejects with a TimeoutError if `timeout` ms pass
+   * first.
+   */
+  async read(options?: SharedFrameRingWaitOptions): Promise<VideoFrame | null> {
+    const ready = this.tryRead();
+    if (ready) {
+      return ready;
+    }
+    try {
+      const nativeFrame = await this._native.read(options?.timeout ?? -1);
+      return nativeFrame ? wrapNativeFrame(nativeFrame) : null;
+    } catch (error) {
+      throw toDOMException(error);
+    }
+  }
+
+  /** End the stream for both processes. Frames already read stay valid. */
+  close(): void {
+    this._native.close();
+  }
+
+  private static _frameOf(frame: VideoFrame): NativeVideoFrame {
+    if (!(frame instanceof VideoFrame)) {
+      throw new TypeError('frame must be a VideoFrame');
+    }
+    if (frame.format === null) {
+      throw new DOMException('VideoFrame is closed', 'InvalidStateError');
+    }
+    return frame._nativeFrame;
+  }
+
+  // Properties as the frame reports them, including overrides from
+  // VideoFrame-from-VideoFrame construction the native frame does not hold.
+  private static _propsOf(frame: VideoFrame): {
+    timestamp: number;
+    duration: number | null;
+    colorSpace: VideoColorSpaceInit;
+  } {
+    return {
+      timestamp: frame.timestamp,
+      duration: frame.duration,
+      colorSpace: frame.colorSpace.toJSON(),
+    };
+  }
+}
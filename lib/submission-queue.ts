@@ -0,0 +1,112 @@
+/**
+ * node-webcodecs - WebCodecs API implementation for Node.js
+ *
+ * Copyright 2024 The node-webcodecs Authors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * encode()/decode() calls parked by the 'block' queue policy.
+ *
+ * A submission hands one request to the native codec and returns false
+ * while its queue is still full. Parked submissions are retried in call
+ * order whenever the codec reports output, and on the native `dequeue`
+ * callback, which a refused submission arms for the next message the
+ * worker takes off the queue. While any are parked, later calls park
+ * behind them so requests reach the codec in call order.
+ */
+
+interface ParkedSubmission {
+  submit: () => boolean;
+  release: () => void;
+  resolve: () => void;
+  reject: (error: unknown) => void;
+}
+
+export class SubmissionQueue {
+  private _parked: ParkedSubmission[] = [];
+  private _idleWaiters: Array<() => void> = [];
+  private _onAbandon: () => void;
+
+  /**
+   * @param onAbandon Runs for each parked submission that never reaches the
+   *        codec, so the owner can fix up its queue size.
+   */
+  constructor(onAbandon: () => void) {
+    this._onAbandon = onAbandon;
+  }
+
+  get size(): number {
+    return this._parked.length;
+  }
+
+  /**
+   * Park |submit| until it is accepted. |release| runs once it has been
+   * (or never will be) submitted, to free whatever kept the input alive.
+   */
+  park(submit: () => boolean, release: () => void): Promise<void> {
+    return new Promise<void>((resolve, reject) => {
+      this._parked.push({ submit, release, resolve, reject });
+    });
+  }
+
+  /**
+   * Submit parked requests until the codec reports its queue full again.
+   */
+  drain(): void {
+    while (this._parked.length > 0) {
+      const next = this._parked[0];
+      let accepted: boolean;
+      try {
+        accepted = next.submit();
+      } catch (error) {
+        this._parked.shift();
+        next.release();
+        this._onAbandon();
+        next.reject(error);
+        continue;
+      }
+      if (!accepted) {
+        break;
+      }
+      this._parked.shift();
+      next.release();
+      next.resolve();
+    }
+    this._settleIfIdle();
+  }
+
+  /**
+   * Resolves once every parked request has been submitted or rejected.
+   */
+  whenIdle(): Promise<void> {
+    if (this._parked.length === 0) {
+      return Promise.resolve();
+    }
+    return new Promise<void>((resolve) => this._idleWaiters.push(resolve));
+  }
+
+  /**
+   * Reject every parked request (reset/close).
+   */
+  rejectAll(error: DOMException): void {
+    const parked = this._parked;
+    this._parked = [];
+    for (const submission of parked) {
+      submission.release();
+      submission.reject(error);
+    }
+    this._settleIfIdle();
+  }
+
+  private _settleIfIdle(): void {
+    if (this._parked.length > 0) {
+      return;
+    }
+    const waiters = this._idleWaiters;
+    this._idleWaiters = [];
+    for (const resolve of waiters) {
+      resolve();
+    }
+  }
+}
@@ -2,14 +2,33 @@
 // SPDX-License-Identifier: MIT
 
 import { binding } from './binding';
+import { EncodedVideoChunk } from './encoded-chunks';
 import type { NativeModule, NativeTestVideoGenerator, NativeVideoFrame } from './native-types';
-import type { CodecState, TestVideoGeneratorConfig } from './types';
+import type {
+  CodecState,
+  EncodedVideoChunkMetadata,
+  EncodedVideoChunkType,
+  TestVideoGeneratorConfig,
+  VideoDecoderConfig,
+} from './types';
+import { VideoEncoder } from './video-encoder';
 import { VideoFrame } from './video-frame';
 
 const native = binding as NativeModule;
 
+const DEFAULT_FRAME_RATE = 30;
+const DEFAULT_DURATION = 1;
+const DEFAULT_CHUNK_BITRATE = 1_000_000;
+
+interface EncodedGop {
+  chunks: { type: EncodedVideoChunkType; data: Uint8Array }[];
+  decoderConfig?: VideoDecoderConfig;
+}
+
 export class TestVideoGenerator {
   private _native: NativeTestVideoGenerator;
+  private _config: TestVideoGeneratorConfig | null = null;
+  private _gop: EncodedGop | null = null;
 
   constructor() {
     this._native = new native.TestVideoGenerator();
@@ -21,20 +40,132 @@ export class TestVideoGenerator {
 
   configure(config: TestVideoGeneratorConfig): void {
     this._native.configure(config);
+    this._config = { ...config };
+    this._gop = null;
   }
 
   async generate(callback: (frame: VideoFrame) => void): Promise<void> {
     return this._native.generate((nativeFrame: NativeVideoFrame) => {
-      // biome-ignore lint/suspicious/noExplicitAny: Object.create wrapper pattern requires any for property assignment
-      const wrapper = Object.create(VideoFrame.prototype) as any;
-      wrapper._native = nativeFrame;
-      wrapper._closed = false;
-      wrapper._metadata = {};
-      callback(wrapper as VideoFrame);
+      callback(this._wrap(nativeFrame));
     });
   }
 
+  /**
+   * Emit `duration * frameRate` pre-encoded chunks of the configured codec,
+   * for load-testing decoders and muxers without paying for an encoder.
+   *
+   * One closed GOP of `poolSize` frames (one second of frames if unset) is
+   * encoded once, then replayed with rewritten timestamps. The first chunk
+   * carries `metadata.decoderConfig`.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  async generateChunks(
+    callback: (chunk: EncodedVideoChunk, metadata?: EncodedVideoChunkMetadata) => void,
+  ): Promise<void> {
+    const config = this._config;
+    if (!config) {
+      throw new DOMException('TestVideoGenerator is not configured', 'InvalidStateError');
+    }
+    if (!config.codec) {
+      throw new TypeError('generateChunks() requires a codec in configure()');
+    }
+    if (!this._gop) {
+      this._gop = await this._encodeGop(config);
+    }
+    const gop = this._gop;
+    const frameRate = config.frameRate ?? DEFAULT_FRAME_RATE;
+    const total = Math.floor((config.duration ?? DEFAULT_DURATION) * frameRate);
+    const frameDuration = Math.round(1e6 / frameRate);
+    for (let i = 0; i < total; i++) {
+      const source = gop.chunks[i % gop.chunks.length];
+      const chunk = new EncodedVideoChunk({
+        type: source.type,
+        timestamp: Math.floor((i * 1e6) / frameRate),
+        duration: frameDuration,
+        data: source.data,
+      });
+      callback(chunk, i === 0 && gop.decoderConfig ? { decoderConfig: gop.decoderConfig } : undefined);
+    }
+  }
+
   close(): void {
     this._native.close();
+    this._config = null;
+    this._gop = null;
+  }
+
+  private async _encodeGop(config: TestVideoGeneratorConfig): Promise<EncodedGop> {
+    const frameRate = config.frameRate ?? DEFAULT_FRAME_RATE;
+    const gopSize = config.poolSize || Math.max(1, Math.round(frameRate));
+    const gop: EncodedGop = { chunks: [] };
+    const errors: Error[] = [];
+    const encoder = new VideoEncoder({
+      output: (chunk, metadata) => {
+        const data = new Uint8Array(chunk.byteLength);
+        chunk.copyTo(data);
+        gop.chunks.push({ type: chunk.type, data });
+        if (metadata?.decoderConfig) {
+          gop.decoderConfig = metadata.decoderConfig;
+        }
+      },
+      error: (e) => {
+        errors.push(e);
+      },
+    });
+    // Realtime mode disables B-frames, so decode order equals presentation
+    // order and timestamps can be rewritten per chunk.
+    encoder.configure({
+      codec: config.codec as string,
+      width: config.width,
+      height: config.height,
+      bitrate: config.bitrate ?? DEFAULT_CHUNK_BITRATE,
+      framerate: frameRate,
+      latencyMode: 'realtime',
+    });
+
+    const source = new native.TestVideoGenerator();
+    source.configure({
+      width: config.width,
+      height: config.height,
+      frameRate,
+      duration: Math.ceil(gopSize / frameRate),
+      pattern: config.pattern ?? 'testsrc',
+      format: 'I420',
+      poolSize: 0,
+    });
+    let index = 0;
+    try {
+      await source.generate((nativeFrame: NativeVideoFrame) => {
+        if (index >= gopSize) {
+          nativeFrame.close();
+          return;
+        }
+        const frame = this._wrap(nativeFrame);
+        encoder.encode(frame, { keyFrame: index === 0 });
+        frame.close();
+        index++;
+      });
+      await encoder.flush();
+    } finally {
+      source.close();
+      encoder.close();
+    }
+    if (errors.length > 0) {
+      throw errors[0];
+    }
+    if (gop.chunks.length === 0 || gop.chunks[0].type !== 'key') {
+      throw new DOMException('Failed to pre-encode test chunks', 'EncodingError');
+    }
+    return gop;
+  }
+
+  private _wrap(nativeFrame: NativeVideoFrame): VideoFrame {
+    // biome-ignore lint/suspicious/noExplicitAny: Object.create wrapper pattern requires any for property assignment
+    const wrapper = Object.create(VideoFrame.prototype) as any;
+    wrapper._native = nativeFrame;
+    wrapper._closed = false;
+    wrapper._metadata = {};
+    return wrapper as VideoFrame;
   }
 }
@@ -6,6 +6,8 @@
  * Types are organized to mirror the WebIDL specification structure.
  */
 
+import type { Muxer } from './muxer';
+
 // =============================================================================
 // FUNDAMENTAL TYPES
 // =============================================================================
@@ -72,6 +74,106 @@ export type CodecState = 'unconfigured' | 'configured' | 'closed';
  */
 export type HardwareAcceleration = 'no-preference' | 'prefer-hardware' | 'prefer-software';
 
+// =============================================================================
+// CODEC THREADING
+// =============================================================================
+
+/**
+ * FFmpeg threading for one encoder or decoder instance.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ * Applied before the codec is opened. 'frame' pipelines whole frames across
+ * threads (higher throughput, more latency), 'slice' splits each frame
+ * (lower latency, needs a sliced bitstream), 'auto' lets FFmpeg pick and
+ * 'none' forces single-threaded operation.
+ *
+ * `cpus`, `priority` and `numaNode` place the codec's worker thread, and on
+ * Linux the FFmpeg threads it starts, so one machine can be split between
+ * latency-sensitive and batch jobs. A placed codec always gets a dedicated
+ * worker thread, even when the shared worker pool is enabled. If the system
+ * refuses a setting (e.g. 'high' without CAP_SYS_NICE), the error callback
+ * reports it.
+ */
+export interface CodecThreadingConfig {
+  /** Thread count; 0 picks one per CPU core. Default: 0 */
+  count?: number;
+  /** Default: 'auto' */
+  mode?: 'auto' | 'frame' | 'slice' | 'none';
+  /**
+   * CPUs the codec threads may run on (Linux; ignored on macOS, which has
+   * no affinity API). Default: any, or the CPUs of `numaNode`
+   */
+  cpus?: number[];
+  /**
+   * Scheduling priority of the codec threads: a nice value on Linux
+   * (19, 10, 0, -10), a QoS class of the worker thread on macOS
+   * (background, utility, default, user-interactive). Default: 'normal'
+   */
+  priority?: ThreadPriority;
+  /**
+   * NUMA node to run on and allocate from (Linux; ignored elsewhere).
+   * Frames decoded and pooled by the codec then stay in the node's memory.
+   * Default: no preference
+   */
+  numaNode?: number;
+}
+
+/**
+ * Scheduling priority of a codec's threads.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export type ThreadPriority = 'background' | 'low' | 'normal' | 'high';
+
+// =============================================================================
+// SCALING QUALITY
+// =============================================================================
+
+/**
+ * Speed/quality of a pixel-format conversion or resize, named as in
+ * ImageBitmapOptions.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ * 'pixelated' is nearest-neighbour, 'low' fast bilinear (good for same-size
+ * colour conversion), 'medium' bilinear (the default) and 'high' Lanczos
+ * (best for downscaling). `scalingThreads` alongside it sets the slice
+ * threads of the conversion; 0 picks one per core, which pays off for 4K
+ * and larger frames.
+ */
+export type ResizeQuality = 'pixelated' | 'low' | 'medium' | 'high';
+
+// =============================================================================
+// QUEUE POLICY
+// =============================================================================
+
+/**
+ * What encode()/decode() does once `maxQueueSize` or `maxQueueBytes` is
+ * reached.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ * 'reject' throws a QuotaExceededError DOMException. 'block' accepts the
+ * call but returns a Promise that resolves once it has entered the queue;
+ * later calls wait behind it. 'drop-oldest-delta' is for real-time use:
+ * encoders drop the oldest queued frame that is not a forced keyframe,
+ * decoders drop the oldest queued delta chunk along with the chunks that
+ * depend on it. With nothing queued to drop, the incoming request is
+ * dropped instead; a forced keyframe or key chunk throws QuotaExceededError.
+ * Dropped requests produce no output.
+ */
+export type QueuePolicy = 'reject' | 'block' | 'drop-oldest-delta';
+
+/**
+ * Speed/quality trade-off of the software video encoders.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ * Applies within the profile `latencyMode` picks: 'quality' (the default)
+ * encodes with lookahead, B-frames and frame threading; 'realtime' turns
+ * those off. 'balanced' in realtime mode is x264 'fast' / VP9 speed 6;
+ * in quality mode x264 'medium' / VP9 good-quality speed 3. Hardware
+ * encoders ignore it.
+ */
+export type EncoderPreset = 'speed' | 'balanced' | 'quality';
+
 // =============================================================================
 // ALPHA OPTION
 // =============================================================================
@@ -390,6 +492,13 @@ export interface VideoFrameCopyToOptions {
   layout?: PlaneLayout[];
   format?: VideoPixelFormat;
   colorSpace?: PredefinedColorSpace;
+  /** @nonstandard - quality of a `format` conversion. Default: 'medium' */
+  resizeQuality?: ResizeQuality;
+  /**
+   * @nonstandard - slice threads of a `format` conversion; 0 picks one per
+   * core. Default: one per core for 1080p and larger, otherwise 1
+   */
+  scalingThreads?: number;
 }
 
 /**
@@ -416,6 +525,14 @@ export interface EncodedVideoChunkInit {
   duration?: number; // unsigned long long, microseconds
   data: AllowSharedBufferSource;
   transfer?: ArrayBuffer[];
+
+  /**
+   * Decode-order timestamp in microseconds, for streams with B-frames.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: timestamp
+   */
+  decodeTimestamp?: number;
 }
 
 /**
@@ -507,6 +624,12 @@ export interface VideoEncoderConfig {
   framerate?: number; // double
   hardwareAcceleration?: HardwareAcceleration;
   alpha?: AlphaOption;
+  /**
+   * 'L1T1' everywhere; 'L1T2' and 'L1T3' encode real temporal layers with
+   * VP8, VP9 and AV1 (SVT-AV1). A receiver may drop chunks whose
+   * svc.temporalLayerId is above the layer it wants. Spatial modes are not
+   * supported.
+   */
   scalabilityMode?: string;
   bitrateMode?: VideoEncoderBitrateMode;
   latencyMode?: LatencyMode;
@@ -514,6 +637,72 @@ export interface VideoEncoderConfig {
   // Codec-specific configurations per W3C WebCodecs Codec Registry
   avc?: AvcEncoderConfig;
   hevc?: HevcEncoderConfig;
+
+  /**
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 'balanced'
+   */
+  encoderPreset?: EncoderPreset;
+
+  /**
+   * FFmpeg threading for this codec instance.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: FFmpeg's own threading defaults; frame threads on every core
+   * when `latencyMode` is 'quality'
+   */
+  threading?: CodecThreadingConfig;
+
+  /**
+   * Quality of the input conversion.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 'medium'
+   */
+  resizeQuality?: ResizeQuality;
+
+  /**
+   * Slice threads of the input conversion; 0 picks one per core.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 1
+   */
+  scalingThreads?: number;
+
+  /**
+   * Most chunks delivered per event loop turn. Outputs that pile up while
+   * the main thread is busy are handed over together; the callback still
+   * runs once per chunk, in order, but without a microtask checkpoint
+   * in between.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 1
+   */
+  outputBatchSize?: number;
+
+  /**
+   * Most requests queued ahead of the codec before `queuePolicy` applies.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 64, counting requests still inside the codec
+   */
+  maxQueueSize?: number;
+
+  /**
+   * Most payload bytes (frame buffers or chunk data) queued ahead of the
+   * codec before `queuePolicy` applies. An empty queue always takes one
+   * request.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: unlimited
+   */
+  maxQueueBytes?: number;
+
+  /**
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 'reject'
+   */
+  queuePolicy?: QueuePolicy;
 }
 
 /**
@@ -522,6 +711,34 @@ export interface VideoEncoderConfig {
  */
 export interface VideoEncoderEncodeOptions {
   keyFrame?: boolean;
+
+  /**
+   * Quantizer offsets for rectangles of this frame, e.g. to spend more bits
+   * on faces or on-screen text. Coordinates are in the frame's coded pixels
+   * and are clipped to it; where regions overlap, the earlier entry wins.
+   * Honoured by libx264, libx265, libvpx, VAAPI and QSV; other encoders
+   * ignore it.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  regionsOfInterest?: VideoEncoderRegionOfInterest[];
+}
+
+/**
+ * A rectangle passed in {@link VideoEncoderEncodeOptions.regionsOfInterest}.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface VideoEncoderRegionOfInterest {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+  /**
+   * -1 to 1. Negative values lower the quantizer (better quality), positive
+   * values raise it; 0 leaves the region unchanged.
+   */
+  qpOffset: number;
 }
 
 /**
@@ -637,6 +854,12 @@ export interface VideoDecoderConfig {
   displayAspectHeight?: number; // unsigned long
   colorSpace?: VideoColorSpaceInit;
   hardwareAcceleration?: HardwareAcceleration;
+  /**
+   * Output each frame as soon as it is decoded: sets the codec's low-delay
+   * flag (no reorder buffer, so meant for streams without B-frames) and
+   * uses slice instead of frame threading unless `threading.mode` says
+   * otherwise. getStats().frameLatency shows the effect.
+   */
   optimizeForLatency?: boolean;
 
   /**
@@ -655,6 +878,120 @@ export interface VideoDecoderConfig {
    * Default: false
    */
   flip?: boolean;
+
+  /**
+   * Pixel format of decoded frames.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * 'RGBA' converts every frame to RGBA. 'native' emits frames in the
+   * decoder's own format (e.g. I420, NV12, I420P10) without conversion,
+   * falling back to RGBA for formats with no VideoPixelFormat equivalent.
+   * Default: 'RGBA'
+   */
+  outputFormat?: 'RGBA' | 'native';
+
+  /**
+   * FFmpeg threading for this codec instance.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: FFmpeg's own threading defaults
+   */
+  threading?: CodecThreadingConfig;
+
+  /**
+   * Quality of the RGBA output conversion.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 'medium'
+   */
+  resizeQuality?: ResizeQuality;
+
+  /**
+   * Slice threads of the RGBA output conversion; 0 picks one per core.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 1
+   */
+  scalingThreads?: number;
+
+  /**
+   * Most frames delivered per event loop turn. Outputs that pile up while
+   * the main thread is busy are handed over together; the callback still
+   * runs once per frame, in order, but without a microtask checkpoint
+   * in between.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 1
+   */
+  outputBatchSize?: number;
+
+  /**
+   * Most requests queued ahead of the codec before `queuePolicy` applies.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 64
+   */
+  maxQueueSize?: number;
+
+  /**
+   * Most payload bytes (frame buffers or chunk data) queued ahead of the
+   * codec before `queuePolicy` applies. An empty queue always takes one
+   * request.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: unlimited
+   */
+  maxQueueBytes?: number;
+
+  /**
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 'reject'
+   */
+  queuePolicy?: QueuePolicy;
+
+  /**
+   * Frames the decoder skips without decoding: 'nonref' drops frames no
+   * other frame references, 'nonkey' keeps only key frames (thumbnails).
+   * Skipped chunks produce no output.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 'none'
+   */
+  skipFrames?: 'none' | 'nonref' | 'nonkey';
+
+  /**
+   * Skip the deblocking loop filter (H.264, HEVC, VP8, VP9, AV1). Much
+   * faster, with visible blocking that accumulates until the next key
+   * frame; meant for previews.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: false
+   */
+  skipLoopFilter?: boolean;
+
+  /**
+   * Skip the inverse transform where the decoder supports it (MPEG-era
+   * decoders); a rough preview at best.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: false
+   */
+  skipIdct?: boolean;
+}
+
+/**
+ * Options for {@link VideoDecoder.decode}.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface VideoDecoderDecodeOptions {
+  /**
+   * Decode the chunk so later frames can reference it, but output no frame
+   * for it. Seeking to a frame decodes from the previous key chunk with
+   * this set on every chunk but the target.
+   * Default: false
+   */
+  skipOutput?: boolean;
 }
 
 /**
@@ -698,6 +1035,49 @@ export interface AudioEncoderConfig {
   // Codec-specific configurations per W3C WebCodecs Codec Registry
   opus?: OpusEncoderConfig;
   aac?: AacEncoderConfig;
+
+  /**
+   * FFmpeg threading for this codec instance.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: FFmpeg's own threading defaults
+   */
+  threading?: CodecThreadingConfig;
+
+  /**
+   * Most chunks delivered per event loop turn. Outputs that pile up while
+   * the main thread is busy are handed over together; the callback still
+   * runs once per chunk, in order, but without a microtask checkpoint
+   * in between.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 1
+   */
+  outputBatchSize?: number;
+
+  /**
+   * Most requests queued ahead of the codec before `queuePolicy` applies.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: unlimited
+   */
+  maxQueueSize?: number;
+
+  /**
+   * Most payload bytes (frame buffers or chunk data) queued ahead of the
+   * codec before `queuePolicy` applies. An empty queue always takes one
+   * request.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: unlimited
+   */
+  maxQueueBytes?: number;
+
+  /**
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 'reject'
+   */
+  queuePolicy?: QueuePolicy;
 }
 
 /**
@@ -774,6 +1154,100 @@ export interface AudioDecoderConfig {
   sampleRate: number; // unsigned long
   numberOfChannels: number; // unsigned long
   description?: AllowSharedBufferSource;
+
+  /**
+   * FFmpeg threading for this codec instance.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: FFmpeg's own threading defaults
+   */
+  threading?: CodecThreadingConfig;
+
+  /**
+   * Most frames delivered per event loop turn. Outputs that pile up while
+   * the main thread is busy are handed over together; the callback still
+   * runs once per frame, in order, but without a microtask checkpoint
+   * in between.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 1
+   */
+  outputBatchSize?: number;
+
+  /**
+   * Most requests queued ahead of the codec before `queuePolicy` applies.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: unlimited
+   */
+  maxQueueSize?: number;
+
+  /**
+   * Most payload bytes (frame buffers or chunk data) queued ahead of the
+   * codec before `queuePolicy` applies. An empty queue always takes one
+   * request.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: unlimited
+   */
+  maxQueueBytes?: number;
+
+  /**
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: 'reject'
+   */
+  queuePolicy?: QueuePolicy;
+
+  /**
+   * Measure loudness and levels of the decoded audio on the decoder thread;
+   * read them with getAnalysis().
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   * Default: no analysis
+   */
+  analysis?: AudioAnalysisConfig;
+}
+
+/**
+ * AudioDecoder analysis options.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface AudioAnalysisConfig {
+  /** Measure true peak (4x oversampled), the costliest part (default true). */
+  truePeak?: boolean;
+  /**
+   * Deliver AudioData to the output callback (default true). With false
+   * the samples never leave native code; flush() then getAnalysis().
+   */
+  output?: boolean;
+}
+
+/**
+ * Loudness (EBU R128 / ITU-R BS.1770-4) and levels of the audio decoded
+ * since configure(). Loudness is in LUFS, levels in dBFS; both are
+ * -Infinity until there is enough audio above the gates.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface AudioAnalysis {
+  /** Gated programme loudness */
+  integratedLoudness: number;
+  /** Loudness of the last 400 ms */
+  momentaryLoudness: number;
+  /** Loudness of the last 3 s */
+  shortTermLoudness: number;
+  maxMomentaryLoudness: number;
+  maxShortTermLoudness: number;
+  /** Loudness range (EBU Tech 3342), in LU */
+  loudnessRange: number;
+  /** dBTP; absent when `truePeak` is false */
+  truePeak?: number;
+  samplePeak: number;
+  /** RMS level over all channels */
+  rms: number;
+  /** Audio measured, in microseconds */
+  duration: number;
 }
 
 /**
@@ -821,6 +1295,15 @@ export type WebCodecsErrorCallback = (error: Error | DOMException) => void;
  */
 export type ImageBufferSource = AllowSharedBufferSource | ReadableStream<Uint8Array>;
 
+/**
+ * A local file for ImageDecoder to memory-map rather than read into a buffer:
+ * its path, or a descriptor open for reading (left open; it may be closed
+ * once the constructor returns). Decoding reads the file in place, so it must
+ * not be truncated while the decoder is open.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export type ImageFileSource = { path: string } | { fd: number };
+
 /**
  * WebIDL:
  * dictionary ImageDecoderInit {
@@ -836,13 +1319,19 @@ export type ImageBufferSource = AllowSharedBufferSource | ReadableStream<Uint8Ar
  */
 export interface ImageDecoderInit {
   type: string;
-  data: ImageBufferSource;
+  /** @nonstandard - may also be an ImageFileSource. */
+  data: ImageBufferSource | ImageFileSource;
   colorSpaceConversion?: ColorSpaceConversion;
   premultiplyAlpha?: PremultiplyAlpha;
   desiredWidth?: number;
   desiredHeight?: number;
   preferAnimation?: boolean;
+  /** When it holds data's ArrayBuffer, that memory is decoded in place, not copied. */
   transfer?: ArrayBuffer[];
+  /** @nonstandard - quality of the RGBA conversion and resize. Default: 'medium' */
+  resizeQuality?: ResizeQuality;
+  /** @nonstandard - slice threads of that conversion; 0 picks one per core. Default: 1 */
+  scalingThreads?: number;
 }
 
 /**
@@ -956,6 +1445,14 @@ export interface EncodedVideoChunk {
   readonly duration: number | null; // unsigned long long?, microseconds
   readonly byteLength: number; // unsigned long
 
+  /**
+   * Decode-order timestamp in microseconds. Encoders with B-frames and the
+   * Demuxer set it; Muxer writes it as the packet DTS.
+   *
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  readonly decodeTimestamp: number;
+
   copyTo(destination: AllowSharedBufferSource): void;
 }
 
@@ -1182,12 +1679,116 @@ export interface VideoFilterConfig {
   height: number;
 }
 
+/** One input of a VideoFilter graph */
+export interface VideoFilterGraphInput {
+  width: number;
+  height: number;
+  /** Pixel format of the frames fed to this input (default 'I420'). */
+  format?: VideoPixelFormat;
+  /** Nominal frame rate, for filters such as `fps` that need one. */
+  frameRate?: number;
+}
+
+/**
+ * Arbitrary libavfilter graph for VideoFilter.configureGraph().
+ *
+ * Inputs are labelled `[in0]`, `[in1]`, ... and outputs `[out0]`, `[out1]`,
+ * ...; a graph with a single input or output uses `[in]` / `[out]`, which may
+ * be left out (e.g. `'scale=640:-2'`).
+ */
+export interface VideoFilterGraphConfig {
+  /** libavfilter graph description, e.g. `'[in0][in1]overlay=10:10[out]'`. */
+  graph: string;
+  inputs: VideoFilterGraphInput[];
+  /** Number of outputs (default 1). */
+  outputs?: number;
+}
+
+/** One output of a VideoScaler */
+export interface VideoScalerRendition {
+  width: number;
+  height: number;
+  /** Pixel format to produce, normally the encoder's input format (default 'I420'). */
+  format?: VideoPixelFormat;
+}
+
+/** VideoScaler configuration */
+export interface VideoScalerConfig {
+  renditions: VideoScalerRendition[];
+  /**
+   * Scale each rendition from the next larger one rather than from the source
+   * frame (default true). Cheaper, at a small cost in sharpness.
+   */
+  cascade?: boolean;
+  /** swscale slice threads per rendition; 0 for one per core (default 1). */
+  threads?: number;
+}
+
+/**
+ * SharedFrameRing configuration. The creating process sets `create`,
+ * `slots` and `slotSize`; the other opens the ring by `name` alone.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface SharedFrameRingInit {
+  /** shm_open() name such as '/camera-0', the same in both processes */
+  name: string;
+  /** Create the ring; fails if the name is already in use (default false). */
+  create?: boolean;
+  /** Number of frame slots when creating (default 4). */
+  slots?: number;
+  /** Bytes per slot when creating: the largest frame's allocationSize(). */
+  slotSize?: number;
+}
+
+/**
+ * ImageEncoder configuration.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface ImageEncoderConfig {
+  /** 'image/jpeg', 'image/png', 'image/webp' or 'image/avif' */
+  type: string;
+  /**
+   * 0 (smallest) to 1 (best); ignored by PNG. Defaults as canvas toBlob():
+   * 0.92 for JPEG, 0.8 for WebP; 0.6 for AVIF.
+   */
+  quality?: number;
+  /** Lossless WebP or AVIF (default false). */
+  lossless?: boolean;
+  /** Output width; given alone, the height keeps the frame's aspect ratio. */
+  width?: number;
+  /** Output height; given alone, the width keeps the frame's aspect ratio. */
+  height?: number;
+  /** Quality of the resize, when there is one. Default: 'medium' */
+  resizeQuality?: ResizeQuality;
+  /** Slice threads of that resize; 0 picks one per core. Default: 1 */
+  scalingThreads?: number;
+}
+
+/** An encoded image */
+export interface ImageEncodeResult {
+  /** The complete image file */
+  data: Buffer;
+  type: string;
+  width: number;
+  height: number;
+}
+
+/** SharedFrameRing write()/read() options */
+export interface SharedFrameRingWaitOptions {
+  /** Milliseconds to wait for a slot or frame; no limit by default. */
+  timeout?: number;
+}
+
 /** Demuxer chunk */
 export interface DemuxerChunk {
   readonly type: EncodedVideoChunkType;
   readonly timestamp: number;
   readonly duration: number | null;
   readonly byteLength: number;
+  /** Container DTS in microseconds; video chunks only. */
+  readonly decodeTimestamp?: number;
   copyTo(destination: AllowSharedBufferSource): void;
 }
 
@@ -1210,16 +1811,123 @@ export interface DemuxerInit {
   onError?: (error: Error) => void;
 }
 
+/**
+ * Random-access byte source for Demuxer.open(), e.g. backed by HTTP range
+ * requests or object storage reads.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface DemuxerPullSource {
+  /** Up to `length` bytes starting at `offset`; null or empty at end of input. */
+  read(offset: number, length: number): Promise<Uint8Array | null> | Uint8Array | null;
+  /** Total size in bytes, if known. Needed by formats that seek from the end. */
+  size?: number;
+}
+
+/**
+ * Input accepted by Demuxer.open(): a file path, an in-memory buffer, a pull
+ * source, or a stream of bytes (Node Readable, web ReadableStream, ...).
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export type DemuxerSource = string | BufferSource | DemuxerPullSource | AsyncIterable<Uint8Array>;
+
+/**
+ * How Demuxer.open() probes the input. By default FFmpeg reads and decodes
+ * the start of every stream to fill in codec parameters, which costs
+ * several round trips on a remote pull source.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface DemuxerOpenOptions {
+  /** Bytes read to detect the format and probe streams (at least 32). */
+  probeSize?: number;
+  /** Microseconds of media analyzed to probe streams. */
+  analyzeDuration?: number;
+  /**
+   * Skip stream probing for MP4 and Matroska when the header already gives
+   * every track's codec, dimensions or sample rate and channels, and
+   * decoder configuration. Other inputs are probed as usual.
+   */
+  trustContainerHeader?: boolean;
+  /**
+   * Tracks reported by onTrack for an earlier open of the same input. When
+   * they match its streams by index, type and codec, they fill in what the
+   * header leaves out and probing is skipped entirely.
+   */
+  tracks?: readonly TrackInfo[];
+  /**
+   * For a file path: memory-map the file and demux it in place rather than
+   * through read() calls. Default: false
+   */
+  memoryMap?: boolean;
+}
+
+/**
+ * How Demuxer.seek() picks the keyframe to resume from.
+ * - 'keyframe': the keyframe nearest the target, before or after it.
+ * - 'precise': the last keyframe at or before the target, so decoding
+ *   reaches it; audio ending before the target is skipped.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export type DemuxerSeekMode = 'keyframe' | 'precise';
+
+/**
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface DemuxerSeekOptions {
+  mode?: DemuxerSeekMode;
+}
+
+/**
+ * Downstream consumer whose queue depth throttles Demuxer.demuxAsync().
+ * VideoDecoder and AudioDecoder satisfy this interface.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface DemuxerBackpressureTarget {
+  readonly decodeQueueSize: number;
+  addEventListener(type: 'dequeue', listener: () => void): void;
+  removeEventListener(type: 'dequeue', listener: () => void): void;
+}
+
+/**
+ * Options for Demuxer.demuxAsync().
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface DemuxerAsyncOptions {
+  /** Packets the reader thread prefetches before pausing. Default 64. */
+  highWaterMark?: number;
+  /** Decoder fed from onChunk; reading pauses while its queue is full. */
+  decoder?: DemuxerBackpressureTarget;
+  /** decoder.decodeQueueSize at which delivery pauses. Default 16. */
+  decodeQueueHighWaterMark?: number;
+}
+
 // =============================================================================
 // MUXER TYPES
 // =============================================================================
 
 /**
- * Configuration for Muxer initialization
+ * Container written by the Muxer.
+ * - 'mp4': regular MP4; the moov is written at finalize(), so it needs a file.
+ * - 'fmp4': fragmented MP4, one fragment per keyframe.
+ * - 'cmaf': fragmented MP4 following the CMAF constraints.
+ * - 'webm': WebM (VP8/VP9/AV1 video, Opus audio).
+ */
+export type MuxerFormat = 'mp4' | 'fmp4' | 'cmaf' | 'webm';
+
+/**
+ * Configuration for Muxer initialization. Exactly one of `filename` or
+ * `onData` must be given.
  */
 export interface MuxerInit {
-  filename: string;
-  format?: 'mp4'; // Currently only MP4 supported
+  filename?: string;
+  /** Defaults to 'mp4' for files and 'fmp4' for onData. */
+  format?: MuxerFormat;
+  /**
+   * Receive the output instead of writing a file: the init segment once
+   * the header is written, then each fragment as soon as it completes.
+   * `offset` is the position of `data` in the output.
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  onData?: (data: Uint8Array, offset: number) => void;
 }
 
 /**
@@ -1245,6 +1953,74 @@ export interface MuxerAudioTrackConfig {
   description?: ArrayBuffer | Uint8Array;
 }
 
+// =============================================================================
+// PIPELINE TYPES
+// =============================================================================
+
+/**
+ * Encoder settings for a Pipeline. Width, height and framerate default to
+ * the source stream's.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface PipelineVideoConfig {
+  codec: string;
+  width?: number;
+  height?: number;
+  bitrate?: number;
+  framerate?: number;
+  bitrateMode?: VideoEncoderBitrateMode;
+  latencyMode?: LatencyMode;
+  hardwareAcceleration?: HardwareAcceleration;
+}
+
+/**
+ * Counters reported by a Pipeline run.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface PipelineStats {
+  /** Packets read from the transcoded input stream */
+  packetsRead: number;
+  /** Frames produced by the decoder */
+  framesDecoded: number;
+  /** Encoded packets handed to the muxer */
+  packetsWritten: number;
+  /** Wall-clock time since run() */
+  elapsedMs: number;
+}
+
+/**
+ * Configuration for a Pipeline, which transcodes the first video stream of
+ * `input` into a Muxer track entirely on native threads.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface PipelineInit {
+  /** File path or the whole input in memory */
+  input: string | BufferSource;
+  /** Receives the encoded packets; finalize it after run() resolves. */
+  muxer: Muxer;
+  /** Video track added to `muxer` for the output */
+  trackIndex: number;
+  video: PipelineVideoConfig;
+  /** Demuxed packets queued for the decoder before reading pauses, 1-1024. Default 16. */
+  maxQueuedPackets?: number;
+  /** Decoded frames queued for the encoder before reading pauses, 1-1024. Default 4. */
+  maxQueuedFrames?: number;
+  /** Called with the latest stats as packets are written, at most one at a time. */
+  onProgress?: (stats: PipelineStats) => void;
+}
+
+/**
+ * Configuration for a ParallelVideoEncoder: a VideoEncoderConfig applied to
+ * every instance, plus how the input is split between them.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface ParallelVideoEncoderConfig extends VideoEncoderConfig {
+  /** Frames per closed-GOP segment. Default 120. */
+  segmentLength?: number;
+  /** Encoder instances; only the first configure() uses it. Default: one per core. */
+  concurrency?: number;
+}
+
 // =============================================================================
 // TEST VIDEO GENERATOR
 // =============================================================================
@@ -1259,4 +2035,184 @@ export interface TestVideoGeneratorConfig {
   frameRate?: number;
   duration?: number;
   pattern?: 'testsrc' | 'testsrc2' | 'color' | 'smptebars';
+  /**
+   * Pixel format of generated frames. 'I420' and 'NV12' exercise the
+   * encoders' YUV input path without a conversion.
+   * Default: 'RGBA'
+   */
+  format?: 'RGBA' | 'I420' | 'NV12';
+  /**
+   * Synthesise this many frames once and cycle through them instead of
+   * rendering every frame, so generation can outpace an encoder. 0 renders
+   * every frame. Also the GOP length of generateChunks().
+   * Default: 0
+   */
+  poolSize?: number;
+  /**
+   * Codec of generateChunks() output, e.g. 'avc1.42001f' or 'vp8'.
+   */
+  codec?: string;
+  /**
+   * Target bitrate of generateChunks() output, in bits per second.
+   * Default: 1000000
+   */
+  bitrate?: number;
+}
+
+// =============================================================================
+// FRAME POOL
+// =============================================================================
+
+/**
+ * Statistics for the shared frame buffer pool.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface FramePoolStats {
+  /** Frame allocations served by a recycled buffer */
+  hits: number;
+  /** Frame allocations that had to allocate a new buffer */
+  misses: number;
+  /** Bytes currently owned by the pool, in use or idle */
+  allocatedBytes: number;
+  /** Number of buffer size classes in use */
+  sizeClasses: number;
+}
+
+/**
+ * Statistics for the shared pixel-format conversion (libswscale) context cache.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface SwsPoolStats {
+  /** Conversions that reused a cached context */
+  hits: number;
+  /** Conversions that had to create a new context */
+  misses: number;
+  /** Contexts currently idle in the cache */
+  idleContexts: number;
+  /** hits / (hits + misses), or 0 before the first conversion */
+  hitRate: number;
+}
+
+/**
+ * Latency distribution of one codec pipeline stage. Percentiles are the
+ * upper bound of a power-of-two microsecond bucket, capped at maxUs.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface CodecStageStats {
+  /** Samples recorded */
+  count: number;
+  meanUs: number;
+  p50Us: number;
+  p90Us: number;
+  p99Us: number;
+  maxUs: number;
+}
+
+/**
+ * Per-instance pipeline statistics returned by a codec's getStats().
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface CodecStats {
+  /** From encode()/decode() until the codec thread picks the request up */
+  queueWait: CodecStageStats;
+  /** Codec thread time per encode/decode request, conversion included */
+  codec: CodecStageStats;
+  /** Pixel format conversion (video) or resampling (audio) */
+  convert: CodecStageStats;
+  /** From the codec thread producing an output until its callback runs */
+  delivery: CodecStageStats;
+  /**
+   * Video decoders: from decode() of a chunk until its frame leaves the
+   * codec thread, including any reorder or frame-threading delay.
+   */
+  frameLatency: CodecStageStats;
+  /** Payload bytes copied between buffers (packets, GPU downloads) */
+  bytesCopied: number;
+}
+
+/**
+ * Native memory held by the addon, from getMemoryUsage().
+ *
+ * Categories count references, so a buffer shared by two of them (a pooled
+ * buffer behind an open VideoFrame, a queued frame whose VideoFrame is still
+ * open) is in both and `total` is an upper bound.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface MemoryUsage {
+  /** VideoFrame pixel data */
+  videoFrames: number;
+  /** AudioData samples */
+  audioData: number;
+  /** EncodedVideoChunk and EncodedAudioChunk payloads */
+  encodedChunks: number;
+  /** Buffers owned by the frame pool, in use or idle */
+  framePool: number;
+  /** Frames and packets waiting in codec queues */
+  codecQueues: number;
+  /** Sum of the categories */
+  total: number;
+  /** Soft limit set with setMemoryLimit(); 0 when unset */
+  softLimit: number;
+}
+
+/**
+ * A VideoFrame moved out with detachForTransfer(). Plain data, so it can go
+ * through postMessage() to another worker_thread as is.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface TransferredVideoFrame {
+  readonly type: 'VideoFrame';
+  /** Registry handle of the native pixels */
+  readonly handle: number;
+  /** Properties the receiving side rebuilds the frame with */
+  readonly init: Record<string, unknown>;
+  readonly metadata: VideoFrameMetadata;
 }
+
+/**
+ * An AudioData moved out with detachForTransfer().
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface TransferredAudioData {
+  readonly type: 'AudioData';
+  readonly handle: number;
+  readonly init: Record<string, unknown>;
+}
+
+/**
+ * An EncodedVideoChunk moved out with detachForTransfer().
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface TransferredEncodedVideoChunk {
+  readonly type: 'EncodedVideoChunk';
+  readonly handle: number;
+  readonly init: Record<string, unknown>;
+}
+
+/**
+ * An EncodedAudioChunk moved out with detachForTransfer().
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export interface TransferredEncodedAudioChunk {
+  readonly type: 'EncodedAudioChunk';
+  readonly handle: number;
+  readonly init: Record<string, unknown>;
+}
+
+/**
+ * Any media object moved out with detachForTransfer(). The pixels, samples
+ * or payload stay in native memory, owned by no thread, until
+ * attachTransferred() claims them (once) or releaseTransferred() frees them.
+ *
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export type TransferredMedia =
+  | TransferredVideoFrame
+  | TransferredAudioData
+  | TransferredEncodedVideoChunk
+  | TransferredEncodedAudioChunk;
@@ -11,7 +11,14 @@ import type { EncodedVideoChunk } from './encoded-chunks';
 import * as is from './is';
 import type { NativeModule, NativeVideoDecoder, VideoDecoderOutputCallback } from './native-types';
 import { ResourceManager } from './resource-manager';
-import type { CodecState, VideoDecoderConfig, VideoDecoderInit } from './types';
+import { SubmissionQueue } from './submission-queue';
+import type {
+  CodecState,
+  CodecStats,
+  VideoDecoderConfig,
+  VideoDecoderDecodeOptions,
+  VideoDecoderInit,
+} from './types';
 import { VideoFrame } from './video-frame';
 
 // Load native addon with type assertion
@@ -24,9 +31,13 @@ export class VideoDecoder extends CodecBase {
   private _native: NativeVideoDecoder;
   private _controlQueue: ControlMessageQueue;
   private _decodeQueueSize: number = 0;
+  // Chunks counted into _decodeQueueSize so far; lets flush() settle it.
+  private _submitted: number = 0;
   private _needsKeyFrame: boolean = true;
   private _errorCallback: (error: DOMException) => void;
   private _resourceId: symbol;
+  // decode() calls waiting for queue space (queuePolicy 'block')
+  private _blocked: SubmissionQueue;
 
   // Backpressure support
   private _maxQueueDepth: number = DEFAULT_MAX_QUEUE_DEPTH;
@@ -42,6 +53,9 @@ export class VideoDecoder extends CodecBase {
     this._errorCallback = init.error;
     this._controlQueue.setErrorHandler(init.error);
     this._resourceId = ResourceManager.getInstance().register(this);
+    this._blocked = new SubmissionQueue(() => {
+      this._decodeQueueSize = Math.max(0, this._decodeQueueSize - 1);
+    });
 
     const outputCallback: VideoDecoderOutputCallback = (nativeFrame) => {
       this._decodeQueueSize = Math.max(0, this._decodeQueueSize - 1);
@@ -56,11 +70,13 @@ export class VideoDecoder extends CodecBase {
 
       // Fire ondequeue after output
       this._triggerDequeue();
+      this._blocked.drain();
     };
 
     this._native = new native.VideoDecoder({
       output: outputCallback,
       error: init.error,
+      dequeue: () => this._blocked.drain(),
     });
   }
 
@@ -162,12 +178,23 @@ export class VideoDecoder extends CodecBase {
       }
     }
 
+    // Validate outputFormat (node-webcodecs extension)
+    if ('outputFormat' in config && config.outputFormat !== undefined) {
+      if (config.outputFormat !== 'RGBA' && config.outputFormat !== 'native') {
+        throw new TypeError(`outputFormat must be 'RGBA' or 'native', got ${config.outputFormat}`);
+      }
+    }
+
     this._needsKeyFrame = true;
     // Configure synchronously to set state immediately per W3C spec
     this._native.configure(config);
   }
 
-  decode(chunk: EncodedVideoChunk): void {
+  /**
+   * Queue a chunk for decoding. Under `queuePolicy: 'block'` a full queue
+   * returns a Promise that resolves once the chunk is queued.
+   */
+  decode(chunk: EncodedVideoChunk, options?: VideoDecoderDecodeOptions): void | Promise<void> {
     // W3C spec: throw InvalidStateError if not configured
     if (this.state !== 'configured') {
       throw new DOMException(`Cannot decode in state "${this.state}"`, 'InvalidStateError');
@@ -183,9 +210,88 @@ export class VideoDecoder extends CodecBase {
     this._needsKeyFrame = false;
 
     ResourceManager.getInstance().recordActivity(this._resourceId);
+    ResourceManager.getInstance().relieveMemoryPressure();
     this._decodeQueueSize++;
+    this._submitted++;
+    if (this._blocked.size === 0 && this._submit(chunk, options)) {
+      return;
+    }
+    // Chunks are immutable, so the parked call keeps this one.
+    return this._blocked.park(() => this._submit(chunk, options), () => {});
+  }
+
+  /**
+   * Decode `chunks` up to the one presented at `timestamp` and output only
+   * that frame, then flush. `chunks` are in decode order and start at a key
+   * chunk, typically the key chunk before the seek target. The frames in
+   * between are decoded for reference but never converted or output.
+   * Resolves false when no chunk has that timestamp.
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  async decodeTo(chunks: Iterable<EncodedVideoChunk>, timestamp: number): Promise<boolean> {
+    let found = false;
+    for (const chunk of chunks) {
+      found = chunk.timestamp === timestamp;
+      await this.decode(chunk, { skipOutput: !found });
+      if (found) {
+        break;
+      }
+    }
+    await this.flush();
+    return found;
+  }
+
+  /**
+   * Queue `chunks` for decoding in one native call, as decode() would one
+   * by one; `options[i]` applies to `chunks[i]`. Under `queuePolicy:
+   * 'block'` the chunks that do not fit wait as with decode(), and the
+   * returned Promise resolves once all are queued.
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  decodeBatch(
+    chunks: readonly EncodedVideoChunk[],
+    options?: readonly (VideoDecoderDecodeOptions | undefined)[],
+  ): void | Promise<void> {
+    if (this.state !== 'configured') {
+      throw new DOMException(`Cannot decode in state "${this.state}"`, 'InvalidStateError');
+    }
+    if (this._needsKeyFrame && chunks.length > 0 && chunks[0].type === 'key') {
+      this._needsKeyFrame = false;
+    }
+    let consumed = 0;
+    // A missing key chunk goes through decode(), which reports it.
+    if (this._blocked.size === 0 && !this._needsKeyFrame && chunks.length > 0) {
+      ResourceManager.getInstance().recordActivity(this._resourceId);
+      ResourceManager.getInstance().relieveMemoryPressure();
+      const [count, dropped] = this._native.decodeBatch(
+        chunks.map((chunk) => chunk._native),
+        options,
+      );
+      consumed = count;
+      this._submitted += count;
+      this._decodeQueueSize = Math.max(0, this._decodeQueueSize + count - dropped);
+    }
+    const parked: Promise<void>[] = [];
+    for (let i = consumed; i < chunks.length; i++) {
+      const result = this.decode(chunks[i], options?.[i]);
+      if (result) {
+        parked.push(result);
+      }
+    }
+    if (parked.length > 0) {
+      return Promise.all(parked).then(() => undefined);
+    }
+  }
+
+  // False when the 'block' queue policy found the native queue full.
+  private _submit(chunk: EncodedVideoChunk, options?: VideoDecoderDecodeOptions): boolean {
     // Pass the native chunk directly (no data copy needed)
-    this._native.decode(chunk._native);
+    const dropped = this._native.decode(chunk._native, options);
+    if (dropped < 0) {
+      return false;
+    }
+    this._decodeQueueSize = Math.max(0, this._decodeQueueSize - dropped);
+    return true;
   }
 
   async flush(): Promise<void> {
@@ -197,6 +303,8 @@ export class VideoDecoder extends CodecBase {
       return Promise.reject(new DOMException('Decoder is closed', 'InvalidStateError'));
     }
     await this._controlQueue.flush();
+    await this._blocked.whenIdle();
+    const submitted = this._submitted;
 
     // Flush the native decoder - the promise resolves when the worker
     // completes processing all queued frames
@@ -208,6 +316,28 @@ export class VideoDecoder extends CodecBase {
     while (this._native.pendingFrames > 0) {
       await new Promise((resolve) => setTimeout(resolve, 1)); // 1ms poll
     }
+
+    // Everything queued before the flush is decoded by now, including
+    // chunks that output no frame (skipFrames 'nonref', undecodable data).
+    this._decodeQueueSize = Math.min(this._decodeQueueSize, this._submitted - submitted);
+  }
+
+  /**
+   * Per-stage timings and copy volume for this decoder: queue wait, codec
+   * time per chunk, pixel format conversion and output delivery. Use it to
+   * find which stage saturates. Counts survive reset() and configure().
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  getStats(): CodecStats {
+    return this._native.getStats();
+  }
+
+  /**
+   * Zero the counters reported by getStats().
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  resetStats(): void {
+    this._native.resetStats();
   }
 
   reset(): void {
@@ -217,6 +347,7 @@ export class VideoDecoder extends CodecBase {
     }
 
     this._controlQueue.clear();
+    this._blocked.rejectAll(new DOMException('Decoder was reset', 'AbortError'));
     this._decodeQueueSize = 0;
     this._needsKeyFrame = true;
     this._native.reset();
@@ -225,6 +356,7 @@ export class VideoDecoder extends CodecBase {
   close(): void {
     ResourceManager.getInstance().unregister(this._resourceId);
     this._controlQueue.clear();
+    this._blocked.rejectAll(new DOMException('Decoder was closed', 'AbortError'));
     this._native.close();
   }
 
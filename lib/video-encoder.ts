@@ -9,9 +9,17 @@ import { CodecBase } from './codec-base';
 import { ControlMessageQueue } from './control-message-queue';
 import { EncodedVideoChunk } from './encoded-chunks';
 import * as is from './is';
+import type { Muxer } from './muxer';
 import type { NativeModule, NativeVideoEncoder, VideoEncoderOutputCallback } from './native-types';
 import { ResourceManager } from './resource-manager';
-import type { CodecState, VideoEncoderConfig, VideoEncoderInit } from './types';
+import { SubmissionQueue } from './submission-queue';
+import type {
+  CodecState,
+  CodecStats,
+  VideoEncoderConfig,
+  VideoEncoderEncodeOptions,
+  VideoEncoderInit,
+} from './types';
 import type { VideoFrame } from './video-frame';
 
 // Load native addon with type assertion
@@ -25,6 +33,8 @@ export class VideoEncoder extends CodecBase {
   private _controlQueue: ControlMessageQueue;
   private _encodeQueueSize: number = 0;
   private _resourceId: symbol;
+  // encode() calls waiting for queue space (queuePolicy 'block')
+  private _blocked: SubmissionQueue;
 
   // Backpressure support
   private _maxQueueDepth: number = DEFAULT_MAX_QUEUE_DEPTH;
@@ -39,6 +49,9 @@ export class VideoEncoder extends CodecBase {
     this._controlQueue = new ControlMessageQueue();
     this._controlQueue.setErrorHandler(init.error);
     this._resourceId = ResourceManager.getInstance().register(this);
+    this._blocked = new SubmissionQueue(() => {
+      this._encodeQueueSize = Math.max(0, this._encodeQueueSize - 1);
+    });
 
     const outputCallback: VideoEncoderOutputCallback = (chunk, metadata) => {
       this._encodeQueueSize = Math.max(0, this._encodeQueueSize - 1);
@@ -66,12 +79,18 @@ export class VideoEncoder extends CodecBase {
 
       // Fire ondequeue after output
       this._triggerDequeue();
-
+      this._blocked.drain();
     };
 
     this._native = new native.VideoEncoder({
       output: outputCallback,
       error: init.error,
+      sinkProgress: (packets) => {
+        this._encodeQueueSize = Math.max(0, this._encodeQueueSize - packets);
+        this._triggerDequeue();
+        this._blocked.drain();
+      },
+      dequeue: () => this._blocked.drain(),
     });
   }
 
@@ -174,15 +193,72 @@ export class VideoEncoder extends CodecBase {
     this._native.configure(config);
   }
 
-  encode(frame: VideoFrame, options?: { keyFrame?: boolean }): void {
+  /**
+   * Queue a frame for encoding. Under `queuePolicy: 'block'` a full queue
+   * returns a Promise that resolves once the frame is queued; the frame may
+   * be closed straight away either way.
+   */
+  encode(frame: VideoFrame, options?: VideoEncoderEncodeOptions): void | Promise<void> {
     // W3C spec: throw if not configured
     if (this.state !== 'configured') {
       throw new DOMException(`Encoder is ${this.state}`, 'InvalidStateError');
     }
     ResourceManager.getInstance().recordActivity(this._resourceId);
+    ResourceManager.getInstance().relieveMemoryPressure();
     this._encodeQueueSize++;
     // Call native encode directly - frame must be valid at call time
-    this._native.encode(frame._nativeFrame, options || {});
+    if (this._blocked.size === 0 && this._submit(frame, options)) {
+      return;
+    }
+    const held = frame.clone();
+    return this._blocked.park(() => this._submit(held, options), () => held.close());
+  }
+
+  /**
+   * Queue `frames` for encoding in one native call, as encode() would one
+   * by one; `options[i]` applies to `frames[i]`. Under `queuePolicy:
+   * 'block'` the frames that do not fit wait as with encode(), and the
+   * returned Promise resolves once all are queued.
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  encodeBatch(
+    frames: readonly VideoFrame[],
+    options?: readonly (VideoEncoderEncodeOptions | undefined)[],
+  ): void | Promise<void> {
+    if (this.state !== 'configured') {
+      throw new DOMException(`Encoder is ${this.state}`, 'InvalidStateError');
+    }
+    let consumed = 0;
+    if (this._blocked.size === 0 && frames.length > 0) {
+      ResourceManager.getInstance().recordActivity(this._resourceId);
+      ResourceManager.getInstance().relieveMemoryPressure();
+      const [count, dropped] = this._native.encodeBatch(
+        frames.map((frame) => frame._nativeFrame),
+        options,
+      );
+      consumed = count;
+      this._encodeQueueSize = Math.max(0, this._encodeQueueSize + count - dropped);
+    }
+    const parked: Promise<void>[] = [];
+    for (let i = consumed; i < frames.length; i++) {
+      const result = this.encode(frames[i], options?.[i]);
+      if (result) {
+        parked.push(result);
+      }
+    }
+    if (parked.length > 0) {
+      return Promise.all(parked).then(() => undefined);
+    }
+  }
+
+  // False when the 'block' queue policy found the native queue full.
+  private _submit(frame: VideoFrame, options?: VideoEncoderEncodeOptions): boolean {
+    const dropped = this._native.encode(frame._nativeFrame, options);
+    if (dropped < 0) {
+      return false;
+    }
+    this._encodeQueueSize = Math.max(0, this._encodeQueueSize - dropped);
+    return true;
   }
 
   async flush(): Promise<void> {
@@ -194,6 +270,7 @@ export class VideoEncoder extends CodecBase {
       return Promise.reject(new DOMException('Encoder is closed', 'InvalidStateError'));
     }
     await this._controlQueue.flush();
+    await this._blocked.whenIdle();
 
     // Flush the native encoder - this returns a Promise that resolves when
     // the worker has finished processing all queued frames
@@ -207,12 +284,43 @@ export class VideoEncoder extends CodecBase {
     }
   }
 
+  /**
+   * Send encoded packets straight to a Muxer track from the encoder thread.
+   * Output no longer reaches the output callback; encodeQueueSize and
+   * dequeue events still track progress. Once flush() resolves, every
+   * packet is queued on the muxer. Add all muxer tracks first; the
+   * attachment lasts until close() and survives reset()/configure().
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  attachMuxer(muxer: Muxer, trackIndex: number): void {
+    this._native.attachMuxer(muxer._native, trackIndex);
+  }
+
+  /**
+   * Per-stage timings and copy volume for this encoder: queue wait, codec
+   * time per frame, pixel format conversion and output delivery. Use it to
+   * find which stage saturates. Counts survive reset() and configure().
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  getStats(): CodecStats {
+    return this._native.getStats();
+  }
+
+  /**
+   * Zero the counters reported by getStats().
+   * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+   */
+  resetStats(): void {
+    this._native.resetStats();
+  }
+
   reset(): void {
     // W3C spec: throw if closed
     if (this.state === 'closed') {
       throw new DOMException('Encoder is closed', 'InvalidStateError');
     }
     this._controlQueue.clear();
+    this._blocked.rejectAll(new DOMException('Encoder was reset', 'AbortError'));
     this._encodeQueueSize = 0;
     this._native.reset();
   }
@@ -220,6 +328,7 @@ export class VideoEncoder extends CodecBase {
   close(): void {
     ResourceManager.getInstance().unregister(this._resourceId);
     this._controlQueue.clear();
+    this._blocked.rejectAll(new DOMException('Encoder was closed', 'AbortError'));
     this._native.close();
   }
 
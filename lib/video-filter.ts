@@ -3,11 +3,29 @@
 
 import { binding } from './binding';
 import type { NativeModule, NativeVideoFilter, NativeVideoFrame } from './native-types';
-import type { BlurRegion, CodecState, VideoFilterConfig } from './types';
+import type {
+  BlurRegion,
+  CodecState,
+  VideoFilterConfig,
+  VideoFilterGraphConfig,
+} from './types';
 import { VideoFrame } from './video-frame';
 
 const native = binding as NativeModule;
 
+function wrapNativeFrame(nativeFrame: NativeVideoFrame): VideoFrame {
+  // biome-ignore lint/suspicious/noExplicitAny: Object.create wrapper pattern requires any for property assignment
+  const wrapper = Object.create(VideoFrame.prototype) as any;
+  wrapper._native = nativeFrame;
+  wrapper._closed = false;
+  wrapper._metadata = {};
+  return wrapper as VideoFrame;
+}
+
+async function wrapOutputs(outputs: Promise<NativeVideoFrame[][]>): Promise<VideoFrame[][]> {
+  return (await outputs).map((frames) => frames.map(wrapNativeFrame));
+}
+
 export class VideoFilter {
   private _native: NativeVideoFilter;
   private _state: CodecState = 'unconfigured';
@@ -34,12 +52,49 @@ export class VideoFilter {
       regions,
       strength,
     );
-    // biome-ignore lint/suspicious/noExplicitAny: Object.create wrapper pattern requires any for property assignment
-    const wrapper = Object.create(VideoFrame.prototype) as any;
-    wrapper._native = resultNativeFrame;
-    wrapper._closed = false;
-    wrapper._metadata = {};
-    return wrapper as VideoFrame;
+    return wrapNativeFrame(resultNativeFrame);
+  }
+
+  /**
+   * Configure an arbitrary libavfilter graph, e.g. scale, crop, overlay or
+   * fps. Use process() and flush() to run frames through it.
+   */
+  configureGraph(config: VideoFilterGraphConfig): void {
+    if (this._state === 'closed') {
+      throw new DOMException('VideoFilter is closed', 'InvalidStateError');
+    }
+    this._native.configureGraph(config);
+    this._state = 'configured';
+  }
+
+  /**
+   * Feed one frame per graph input (null to feed nothing to that input) and
+   * collect what the graph produces, indexed by output. Frames are filtered
+   * on the thread pool and neither input nor output pixels are copied; the
+   * caller still owns, and must close, `frames`.
+   */
+  process(frames: VideoFrame | Array<VideoFrame | null>): Promise<VideoFrame[][]> {
+    if (this._state === 'closed') {
+      return Promise.reject(new DOMException('VideoFilter is closed', 'InvalidStateError'));
+    }
+    const list = Array.isArray(frames) ? frames : [frames];
+    try {
+      // The native side takes its frame references before returning.
+      const natives = list.map((frame) =>
+        frame ? (frame._nativeFrame as NativeVideoFrame) : null,
+      );
+      return wrapOutputs(this._native.process(natives));
+    } catch (e) {
+      return Promise.reject(e);
+    }
+  }
+
+  /** Drain frames the graph is holding back, then reset it for new input. */
+  flush(): Promise<VideoFrame[][]> {
+    if (this._state === 'closed') {
+      return Promise.reject(new DOMException('VideoFilter is closed', 'InvalidStateError'));
+    }
+    return wrapOutputs(this._native.flush());
   }
 
   close(): void {
@@ -11,6 +11,7 @@ import { detachArrayBuffers } from './transfer';
 import type {
   DOMRectReadOnly,
   PlaneLayout,
+  TransferredVideoFrame,
   VideoColorPrimaries,
   VideoColorSpaceInit,
   VideoFrameBufferInit,
@@ -341,7 +342,8 @@ export class VideoFrame {
       }
     }
 
-    // Convert ArrayBuffer to Buffer for native layer
+    // Wrap the destination for the native layer. Buffer.from() over an
+    // ArrayBuffer creates a view, so native code writes straight into it.
     let destBuffer: Buffer;
     let destLength: number;
     if (destination instanceof ArrayBuffer) {
@@ -363,7 +365,7 @@ export class VideoFrame {
       const rectHeight = rect.height ?? this._native.codedHeight;
       // For buffer size validation with rect, calculate based on rect dimensions
       // The native allocationSize doesn't accept rect, so we calculate here
-      const format = this._native.format;
+      const format = options.format ?? this._native.format;
       if (format === 'RGBA' || format === 'RGBX' || format === 'BGRA' || format === 'BGRX') {
         // Packed RGB formats: 4 bytes per pixel
         requiredSize = rectWidth * rectHeight * 4;
@@ -380,17 +382,8 @@ export class VideoFrame {
       );
     }
 
-    // Call native copyTo
-    const layout = this._native.copyTo(destBuffer, options || {});
-
-    // Copy back to original if it was an ArrayBuffer
-    if (destination instanceof ArrayBuffer) {
-      new Uint8Array(destination).set(destBuffer);
-    } else if (destination instanceof Uint8Array) {
-      destination.set(destBuffer);
-    }
-
-    return layout;
+    // Native code converts and crops directly into the destination.
+    return this._native.copyTo(destBuffer, options || {});
   }
 
   allocationSize(options?: VideoFrameCopyToOptions): number {
@@ -573,6 +566,44 @@ export class VideoFrame {
     return wrapper;
   }
 
+  /**
+   * @internal
+   * Move this frame's pixels into the native transfer registry and close it.
+   * See detachForTransfer().
+   */
+  _detach(): TransferredVideoFrame {
+    if (this._closed) {
+      throw new DOMException('VideoFrame is closed', 'InvalidStateError');
+    }
+    // Overrides from VideoFrame-from-VideoFrame construction live here, not
+    // in the native frame, so the receiver gets them in its init.
+    const timestamp = this.timestamp;
+    const duration = this.duration;
+    const visibleRect = this._visibleRectOverride;
+    const { handle, init } = this._native.detach();
+    this._closed = true;
+    init.timestamp = timestamp;
+    if (duration !== null) {
+      init.duration = duration;
+    }
+    if (visibleRect) {
+      init.visibleRect = { ...visibleRect };
+    }
+    return { type: 'VideoFrame', handle, init, metadata: { ...this._metadata } };
+  }
+
+  /**
+   * @internal
+   * Claim a frame detached in this or another thread. See attachTransferred().
+   */
+  static _fromTransfer(transferred: TransferredVideoFrame): VideoFrame {
+    const frame = Object.create(VideoFrame.prototype) as VideoFrame;
+    frame._native = new native.VideoFrame(transferred.handle, transferred.init);
+    frame._closed = false;
+    frame._metadata = { ...transferred.metadata };
+    return frame;
+  }
+
   // Internal access for native binding
   get _nativeFrame(): NativeVideoFrame {
     return this._native;
@@ -0,0 +1,57 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+import { binding } from './binding';
+import type { NativeModule, NativeVideoFrame, NativeVideoScaler } from './native-types';
+import type { VideoScalerConfig } from './types';
+import { VideoFrame } from './video-frame';
+
+const native = binding as NativeModule;
+
+/**
+ * Scales one frame into several renditions for ABR ladder encoding.
+ *
+ * Each rendition is produced once, in the pixel format its encoder takes, so
+ * passing it to a VideoEncoder configured with the same size skips the
+ * encoder's own conversion.
+ *
+ * @example
+ * const scaler = new VideoScaler({
+ *   renditions: [
+ *     { width: 1280, height: 720 },
+ *     { width: 640, height: 360 },
+ *   ],
+ * });
+ * const [hd, sd] = await scaler.scale(frame);
+ * encoder720.encode(hd);
+ * encoder360.encode(sd);
+ */
+export class VideoScaler {
+  private _native: NativeVideoScaler;
+  private _closed = false;
+
+  constructor(config: VideoScalerConfig) {
+    this._native = new native.VideoScaler(config);
+  }
+
+  /** Resolves to one frame per rendition, in configuration order. */
+  async scale(frame: VideoFrame): Promise<VideoFrame[]> {
+    if (this._closed) {
+      throw new DOMException('VideoScaler is closed', 'InvalidStateError');
+    }
+    const frames = await this._native.scale(frame._nativeFrame as NativeVideoFrame);
+    return frames.map((nativeFrame) => {
+      // biome-ignore lint/suspicious/noExplicitAny: Object.create wrapper pattern requires any for property assignment
+      const wrapper = Object.create(VideoFrame.prototype) as any;
+      wrapper._native = nativeFrame;
+      wrapper._closed = false;
+      wrapper._metadata = {};
+      return wrapper as VideoFrame;
+    });
+  }
+
+  close(): void {
+    this._native.close();
+    this._closed = true;
+  }
+}
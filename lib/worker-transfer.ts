@@ -0,0 +1,120 @@
+/**
+ * node-webcodecs - WebCodecs API implementation for Node.js
+ *
+ * Zero-copy transfer of media objects between worker_threads.
+ *
+ * Native objects belong to the thread that created them, so postMessage()
+ * cannot carry a VideoFrame or chunk. Their storage (refcounted AVFrames,
+ * AVPackets and packed buffers) is ordinary process memory though:
+ * detachForTransfer() parks it in a process-wide native registry and
+ * returns a plain message holding its handle, and attachTransferred() in the
+ * receiving thread wraps the same memory in a new object. Nothing is copied.
+ */
+
+import { AudioData } from './audio-data';
+import { binding } from './binding';
+import { EncodedAudioChunk, EncodedVideoChunk } from './encoded-chunks';
+import type { NativeModule } from './native-types';
+import type {
+  TransferredAudioData,
+  TransferredEncodedAudioChunk,
+  TransferredEncodedVideoChunk,
+  TransferredMedia,
+  TransferredVideoFrame,
+} from './types';
+import { VideoFrame } from './video-frame';
+
+const native = binding as NativeModule;
+
+/**
+ * Move a media object out of this thread. The object is closed, as if
+ * close() had been called, and the returned message can be posted to any
+ * worker_thread (or kept in this one) and passed to attachTransferred().
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ *
+ * @example
+ * ```ts
+ * // Main thread
+ * worker.postMessage(detachForTransfer(frame));
+ * // Worker
+ * parentPort.on('message', (message) => encoder.encode(attachTransferred(message)));
+ * ```
+ */
+export function detachForTransfer(frame: VideoFrame): TransferredVideoFrame;
+export function detachForTransfer(data: AudioData): TransferredAudioData;
+export function detachForTransfer(chunk: EncodedVideoChunk): TransferredEncodedVideoChunk;
+export function detachForTransfer(chunk: EncodedAudioChunk): TransferredEncodedAudioChunk;
+export function detachForTransfer(
+  media: VideoFrame | AudioData | EncodedVideoChunk | EncodedAudioChunk,
+): TransferredMedia;
+export function detachForTransfer(
+  media: VideoFrame | AudioData | EncodedVideoChunk | EncodedAudioChunk,
+): TransferredMedia {
+  if (
+    media instanceof VideoFrame ||
+    media instanceof AudioData ||
+    media instanceof EncodedVideoChunk ||
+    media instanceof EncodedAudioChunk
+  ) {
+    return media._detach();
+  }
+  throw new TypeError(
+    'detachForTransfer() expects a VideoFrame, AudioData, EncodedVideoChunk or EncodedAudioChunk',
+  );
+}
+
+/**
+ * Rebuild a media object from a detachForTransfer() message, taking over its
+ * native memory. Each message can be attached once; a second attempt throws
+ * a DataCloneError.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export function attachTransferred(message: TransferredVideoFrame): VideoFrame;
+export function attachTransferred(message: TransferredAudioData): AudioData;
+export function attachTransferred(message: TransferredEncodedVideoChunk): EncodedVideoChunk;
+export function attachTransferred(message: TransferredEncodedAudioChunk): EncodedAudioChunk;
+export function attachTransferred(
+  message: TransferredMedia,
+): VideoFrame | AudioData | EncodedVideoChunk | EncodedAudioChunk;
+export function attachTransferred(
+  message: TransferredMedia,
+): VideoFrame | AudioData | EncodedVideoChunk | EncodedAudioChunk {
+  try {
+    switch (message?.type) {
+      case 'VideoFrame':
+        return VideoFrame._fromTransfer(message);
+      case 'AudioData':
+        return AudioData._fromTransfer(message);
+      case 'EncodedVideoChunk':
+        return EncodedVideoChunk._fromTransfer(message);
+      case 'EncodedAudioChunk':
+        return EncodedAudioChunk._fromTransfer(message);
+    }
+  } catch (error) {
+    const text = error instanceof Error ? error.message : String(error);
+    if (text.startsWith('DataCloneError:')) {
+      throw new DOMException(text.slice('DataCloneError: '.length), 'DataCloneError');
+    }
+    throw error;
+  }
+  throw new TypeError('attachTransferred() expects a message from detachForTransfer()');
+}
+
+/**
+ * Free the native memory of a detachForTransfer() message that will never
+ * be attached, e.g. because the worker it was meant for exited. Returns
+ * false if it was already attached or released.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export function releaseTransferred(message: TransferredMedia): boolean {
+  return native.releaseTransferHandle(message.handle);
+}
+
+/**
+ * Number of detached media objects, across all threads, that have not been
+ * attached or released yet. Useful to catch messages that were dropped.
+ * @nonstandard - node-webcodecs extension, not part of W3C WebCodecs spec.
+ */
+export function pendingTransfers(): number {
+  return native.pendingTransfers();
+}
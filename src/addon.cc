@@ -3,14 +3,36 @@
 
 #include <napi.h>
 
+#include <atomic>
+#include <cmath>
 #include <string>
 
 #include "src/common.h"
 #include "src/descriptors.h"
 #include "src/error_builder.h"
+#include "src/frame_pool.h"
+#include "src/shared/codec_reaper.h"
+#include "src/shared/codec_scheduler.h"
+#include "src/shared/trace_events.h"
+#include "src/sws_pool.h"
 #include "src/test_video_generator.h"
+#include "src/transfer_registry.h"
 #include "src/warnings.h"
 
+namespace {
+
+// Largest size argument accepted from JS; fits size_t on every target.
+constexpr double kMaxSizeArgument = 4294967295.0;
+
+// True when `value` is an integer in [min, max]. Checked before any cast to
+// an integer type, since NaN and out-of-range doubles make the cast UB.
+bool IsIntegerInRange(double value, double min, double max) {
+  return std::isfinite(value) && value >= min && value <= max &&
+         value == std::floor(value);
+}
+
+}  // namespace
+
 // Forward declarations.
 Napi::Object InitVideoEncoder(Napi::Env env, Napi::Object exports);
 Napi::Object InitVideoDecoder(Napi::Env env, Napi::Object exports);
@@ -21,9 +43,13 @@ Napi::Object InitEncodedAudioChunk(Napi::Env env, Napi::Object exports);
 Napi::Object InitAudioEncoder(Napi::Env env, Napi::Object exports);
 Napi::Object InitAudioDecoder(Napi::Env env, Napi::Object exports);
 Napi::Object InitVideoFilter(Napi::Env env, Napi::Object exports);
+Napi::Object InitVideoScaler(Napi::Env env, Napi::Object exports);
 Napi::Object InitDemuxer(Napi::Env env, Napi::Object exports);
 Napi::Object InitMuxer(Napi::Env env, Napi::Object exports);
+Napi::Object InitPipeline(Napi::Env env, Napi::Object exports);
 Napi::Object InitImageDecoder(Napi::Env env, Napi::Object exports);
+Napi::Object InitImageEncoder(Napi::Env env, Napi::Object exports);
+Napi::Object InitSharedFrameRing(Napi::Env env, Napi::Object exports);
 
 // FFmpeg logging helper functions
 Napi::Value GetFFmpegWarningsJS(const Napi::CallbackInfo& info) {
@@ -80,6 +106,127 @@ Napi::Value GetCountersJS(const Napi::CallbackInfo& info) {
   return counters;
 }
 
+// Frame buffer pool statistics (node-webcodecs extension).
+Napi::Value GetFramePoolStatsJS(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  webcodecs::FramePoolStats stats = webcodecs::FramePool::Instance().GetStats();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("hits", static_cast<double>(stats.hits));
+  result.Set("misses", static_cast<double>(stats.misses));
+  result.Set("allocatedBytes", static_cast<double>(stats.allocated_bytes));
+  result.Set("sizeClasses", static_cast<double>(stats.size_classes));
+  return result;
+}
+
+void TrimFramePoolJS(const Napi::CallbackInfo& info) {
+  webcodecs::FramePool::Instance().Trim();
+}
+
+// Scaler context cache statistics (node-webcodecs extension).
+Napi::Value GetSwsPoolStatsJS(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  webcodecs::SwsPoolStats stats = webcodecs::SwsPool::Instance().GetStats();
+  uint64_t leases = stats.hits + stats.misses;
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("hits", static_cast<double>(stats.hits));
+  result.Set("misses", static_cast<double>(stats.misses));
+  result.Set("idleContexts", static_cast<double>(stats.idle_contexts));
+  result.Set("hitRate", leases > 0 ? static_cast<double>(stats.hits) /
+                                         static_cast<double>(leases)
+                                   : 0.0);
+  return result;
+}
+
+void TrimSwsPoolJS(const Napi::CallbackInfo& info) {
+  webcodecs::SwsPool::Instance().Trim();
+}
+
+// Shared codec worker pool (node-webcodecs extension).
+// configureWorkerPool(size?) - size defaults to the core count; 0 returns
+// newly configured codecs to one dedicated thread each.
+Napi::Value ConfigureWorkerPoolJS(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  size_t size = webcodecs::CodecScheduler::DefaultSize();
+  if (info.Length() > 0 && !info[0].IsUndefined()) {
+    double value = info[0].IsNumber() ? info[0].As<Napi::Number>().DoubleValue()
+                                      : -1;
+    if (!IsIntegerInRange(value, 0, kMaxSizeArgument)) {
+      throw Napi::TypeError::New(env,
+                                 "worker pool size must be a non-negative "
+                                 "integer");
+    }
+    size = static_cast<size_t>(value);
+  }
+  size_t effective = webcodecs::CodecScheduler::Instance().Configure(size);
+  return Napi::Number::New(env, static_cast<double>(effective));
+}
+
+// Codec pipeline tracing (node-webcodecs extension).
+// startTracing(maxEvents?) discards any previous recording and starts a new
+// one; stopTracing() returns it as Chrome trace-event JSON.
+void StartTracingJS(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  size_t max_events = webcodecs::TraceRecorder::kDefaultMaxEvents;
+  if (info.Length() > 0 && !info[0].IsUndefined()) {
+    double value = info[0].IsNumber() ? info[0].As<Napi::Number>().DoubleValue()
+                                      : -1;
+    if (!IsIntegerInRange(value, 1, kMaxSizeArgument)) {
+      throw Napi::TypeError::New(env, "maxEvents must be a positive integer");
+    }
+    max_events = static_cast<size_t>(value);
+  }
+  webcodecs::TraceRecorder::Instance().Start(max_events);
+}
+
+Napi::Value StopTracingJS(const Napi::CallbackInfo& info) {
+  return Napi::String::New(info.Env(),
+                           webcodecs::TraceRecorder::Instance().Stop());
+}
+
+// Native memory accounting (node-webcodecs extension).
+// getMemoryUsage() reports bytes by category; setMemoryLimit(bytes) sets the
+// soft limit above which codecs refuse encode()/decode() (0 disables it).
+Napi::Value GetMemoryUsageJS(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  webcodecs::SettleExternalMemory(env);
+  return webcodecs::MemoryUsageToObject(env);
+}
+
+void SetMemoryLimitJS(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  double value = info.Length() > 0 && info[0].IsNumber()
+                     ? info[0].As<Napi::Number>().DoubleValue()
+                     : -1;
+  if (!IsIntegerInRange(value, 0, 9007199254740991.0)) {
+    throw Napi::TypeError::New(env,
+                               "memory limit must be a non-negative integer");
+  }
+  webcodecs::MemoryAccountant::Instance().SetSoftLimit(
+      static_cast<int64_t>(value));
+}
+
+// Cross-environment transfer (node-webcodecs extension).
+// releaseTransferHandle(handle) frees a payload parked by detach() whose
+// message was never delivered; pendingTransfers() counts unclaimed ones.
+Napi::Value ReleaseTransferHandleJS(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    throw Napi::TypeError::New(env, "transfer handle must be a number");
+  }
+  uint64_t handle =
+      static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value());
+  return Napi::Boolean::New(
+      env, webcodecs::TransferRegistry::Instance().Release(handle));
+}
+
+Napi::Value PendingTransfersJS(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(
+      info.Env(),
+      static_cast<double>(webcodecs::TransferRegistry::Instance().size()));
+}
+
 // Test helper for AttrAsEnum template
 Napi::Value TestAttrAsEnum(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
@@ -93,6 +240,51 @@ Napi::Value TestAttrAsEnum(const Napi::CallbackInfo& info) {
   return Napi::String::New(env, webcodecs::ColorPrimariesToString(primaries));
 }
 
+// Lazily registered classes (node-webcodecs startup). Codec and container
+// classes are only defined the first time the JS layer reads them from the
+// exports object, so a process that never touches, say, Pipeline never pays
+// for it. VideoFrame, AudioData and the chunk classes stay eager: every
+// codec creates them from native code through their constructor references.
+struct LazyClass {
+  const char* name;
+  Napi::Object (*init)(Napi::Env env, Napi::Object exports);
+};
+
+constexpr LazyClass kLazyClasses[] = {
+    {"VideoEncoder", InitVideoEncoder},
+    {"VideoDecoder", InitVideoDecoder},
+    {"AudioEncoder", InitAudioEncoder},
+    {"AudioDecoder", InitAudioDecoder},
+    {"VideoFilter", InitVideoFilter},
+    {"VideoScaler", InitVideoScaler},
+    {"Demuxer", InitDemuxer},
+    {"Muxer", InitMuxer},
+    {"Pipeline", InitPipeline},
+    {"ImageDecoder", InitImageDecoder},
+    {"ImageEncoder", InitImageEncoder},
+    {"TestVideoGenerator", InitTestVideoGenerator},
+    {"SharedFrameRing", InitSharedFrameRing},
+};
+
+// Getter installed for each kLazyClasses entry. Defines the class, then
+// replaces itself on the exports object with the plain constructor.
+static Napi::Value LazyClassGetter(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  const auto* lazy = static_cast<const LazyClass*>(info.Data());
+  webcodecs::InitFFmpeg();
+  webcodecs::InitFFmpegLogging();
+
+  Napi::Object scratch = Napi::Object::New(env);
+  lazy->init(env, scratch);
+  Napi::Value cls = scratch.Get(lazy->name);
+  Napi::Object exports = info.This().As<Napi::Object>();
+  exports.DefineProperty(Napi::PropertyDescriptor::Value(
+      lazy->name, cls,
+      static_cast<napi_property_attributes>(napi_writable | napi_enumerable |
+                                            napi_configurable)));
+  return cls;
+}
+
 // Cleanup hook called when the Node.js environment is being torn down.
 // This prevents the static destruction order fiasco where FFmpeg's log
 // callback might access destroyed static objects during process exit.
@@ -100,28 +292,42 @@ static void CleanupCallback(void* arg) {
   webcodecs::ShutdownFFmpegLogging();
 }
 
+// The worker pool and reaper are process-wide, so only the last
+// environment (main thread or worker_threads) to unload joins their
+// threads. Retired workers may wait on pool slices, so the reaper goes
+// first.
+static std::atomic<int> active_envs{0};
+
+static void WorkerPoolCleanupCallback(void* arg) {
+  if (active_envs.fetch_sub(1) == 1) {
+    webcodecs::CodecReaper::Instance().Shutdown();
+    webcodecs::CodecScheduler::Instance().Shutdown();
+  }
+}
+
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
-  // Thread-safe FFmpeg initialization
-  webcodecs::InitFFmpeg();
-  webcodecs::InitFFmpegLogging();
+  // FFmpeg itself is initialized on first use: by the lazy class getters,
+  // VideoFrame and AudioData.
 
   // Register cleanup hook to disable FFmpeg logging before static destructors.
   // This fixes crashes on macOS x64 where FFmpeg logs during process exit.
   napi_add_env_cleanup_hook(env, CleanupCallback, nullptr);
+  active_envs.fetch_add(1);
+  napi_add_env_cleanup_hook(env, WorkerPoolCleanupCallback, nullptr);
+
+  webcodecs::InitInternedKeys(env);
 
-  InitVideoEncoder(env, exports);
-  InitVideoDecoder(env, exports);
   InitVideoFrame(env, exports);
   InitEncodedVideoChunk(env, exports);
   InitAudioData(env, exports);
   InitEncodedAudioChunk(env, exports);
-  InitAudioEncoder(env, exports);
-  InitAudioDecoder(env, exports);
-  InitVideoFilter(env, exports);
-  InitDemuxer(env, exports);
-  InitMuxer(env, exports);
-  InitImageDecoder(env, exports);
-  InitTestVideoGenerator(env, exports);
+  for (const LazyClass& lazy : kLazyClasses) {
+    exports.DefineProperty(Napi::PropertyDescriptor::Accessor(
+        lazy.name, LazyClassGetter,
+        static_cast<napi_property_attributes>(napi_enumerable |
+                                              napi_configurable),
+        const_cast<LazyClass*>(&lazy)));
+  }
   webcodecs::ErrorBuilder::Init(env, exports);
   webcodecs::WarningAccumulator::Init(env, exports);
   webcodecs::InitDescriptors(env, exports);
@@ -139,6 +345,31 @@ Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
   exports.Set("getCounterFrames", Napi::Function::New(env, GetCounterFramesJS));
   exports.Set("getCounters", Napi::Function::New(env, GetCountersJS));
 
+  // Export frame pool stats
+  exports.Set("getFramePoolStats",
+              Napi::Function::New(env, GetFramePoolStatsJS));
+  exports.Set("trimFramePool", Napi::Function::New(env, TrimFramePoolJS));
+  exports.Set("getSwsPoolStats", Napi::Function::New(env, GetSwsPoolStatsJS));
+  exports.Set("trimSwsPool", Napi::Function::New(env, TrimSwsPoolJS));
+
+  // Export worker pool control
+  exports.Set("configureWorkerPool",
+              Napi::Function::New(env, ConfigureWorkerPoolJS));
+
+  // Export codec pipeline tracing
+  exports.Set("startTracing", Napi::Function::New(env, StartTracingJS));
+  exports.Set("stopTracing", Napi::Function::New(env, StopTracingJS));
+
+  // Native memory accounting
+  exports.Set("getMemoryUsage", Napi::Function::New(env, GetMemoryUsageJS));
+  exports.Set("setMemoryLimit", Napi::Function::New(env, SetMemoryLimitJS));
+
+  // Cross-environment transfer
+  exports.Set("releaseTransferHandle",
+              Napi::Function::New(env, ReleaseTransferHandleJS));
+  exports.Set("pendingTransfers",
+              Napi::Function::New(env, PendingTransfersJS));
+
   // Export test helpers
   exports.Set("testAttrAsEnum", Napi::Function::New(env, TestAttrAsEnum));
 
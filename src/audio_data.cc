@@ -5,14 +5,15 @@
 
 #include <cstring>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/common.h"
 #include "src/ffmpeg_raii.h"
+#include "src/transfer_registry.h"
 
 extern "C" {
 #include <libavutil/channel_layout.h>
-#include <libavutil/opt.h>
 #include <libswresample/swresample.h>
 }
 
@@ -32,6 +33,30 @@ AVSampleFormat ParseAudioFormat(const std::string& format) {
   return AV_SAMPLE_FMT_NONE;
 }
 
+// Map FFmpeg AVSampleFormat to WebCodecs format string ("" if none).
+std::string SampleFormatToString(AVSampleFormat format) {
+  switch (format) {
+    case AV_SAMPLE_FMT_U8:
+      return "u8";
+    case AV_SAMPLE_FMT_S16:
+      return "s16";
+    case AV_SAMPLE_FMT_S32:
+      return "s32";
+    case AV_SAMPLE_FMT_FLT:
+      return "f32";
+    case AV_SAMPLE_FMT_U8P:
+      return "u8-planar";
+    case AV_SAMPLE_FMT_S16P:
+      return "s16-planar";
+    case AV_SAMPLE_FMT_S32P:
+      return "s32-planar";
+    case AV_SAMPLE_FMT_FLTP:
+      return "f32-planar";
+    default:
+      return "";
+  }
+}
+
 // Get bytes per sample for a format string.
 size_t GetFormatBytesPerSample(const std::string& format) {
   if (format == "u8" || format == "u8-planar") return 1;
@@ -43,9 +68,52 @@ size_t GetFormatBytesPerSample(const std::string& format) {
 bool IsPlanarFormat(const std::string& format) {
   return format.find("-planar") != std::string::npos;
 }
+
+// copyTo() sample format converters, reused across calls. Without
+// resampling a context holds no samples between conversions. copyTo() runs
+// on the JS thread, so each thread keeps its own few.
+constexpr size_t kMaxSampleConverters = 8;
+
+struct SampleConverter {
+  AVSampleFormat in_format;
+  AVSampleFormat out_format;
+  int channels;
+  ffmpeg::SwrContextPtr swr;
+};
+
+SwrContext* GetSampleConverter(AVSampleFormat in_format,
+                               AVSampleFormat out_format, int channels) {
+  static thread_local std::vector<SampleConverter> converters;
+  for (const SampleConverter& converter : converters) {
+    if (converter.in_format == in_format &&
+        converter.out_format == out_format &&
+        converter.channels == channels) {
+      return converter.swr.get();
+    }
+  }
+
+  // Same rate in and out, so no resampler is created; the value is unused.
+  constexpr int kSampleRate = 48000;
+  AVChannelLayout layout;
+  av_channel_layout_default(&layout, channels);
+  SwrContext* swr = nullptr;
+  int ret = swr_alloc_set_opts2(&swr, &layout, out_format, kSampleRate,
+                                &layout, in_format, kSampleRate, 0, nullptr);
+  av_channel_layout_uninit(&layout);
+  ffmpeg::SwrContextPtr context(swr);
+  if (ret < 0 || swr_init(context.get()) < 0) {
+    return nullptr;
+  }
+
+  if (converters.size() >= kMaxSampleConverters) {
+    converters.erase(converters.begin());  // Oldest first
+  }
+  converters.push_back({in_format, out_format, channels, std::move(context)});
+  return converters.back().swr.get();
+}
 }  // namespace
 
-Napi::FunctionReference AudioData::constructor_;
+thread_local Napi::FunctionReference AudioData::constructor_;
 
 Napi::Object InitAudioData(Napi::Env env, Napi::Object exports) {
   return AudioData::Init(env, exports);
@@ -67,6 +135,7 @@ Napi::Object AudioData::Init(Napi::Env env, Napi::Object exports) {
           InstanceMethod("copyTo", &AudioData::CopyTo),
           InstanceMethod("clone", &AudioData::Clone),
           InstanceMethod("close", &AudioData::Close),
+          InstanceMethod("detach", &AudioData::Detach),
       });
 
   constructor_ = Napi::Persistent(func);
@@ -92,6 +161,20 @@ Napi::Object AudioData::CreateInstance(Napi::Env env, const std::string& format,
   return constructor_.New({init});
 }
 
+Napi::Object AudioData::CreateInstance(Napi::Env env,
+                                       ffmpeg::AVFramePtr frame) {
+  if (!frame ||
+      SampleFormatToString(static_cast<AVSampleFormat>(frame->format))
+          .empty()) {
+    throw Napi::Error::New(env, "Unsupported AVFrame sample format");
+  }
+  // The constructor moves the frame out of |frame| synchronously; if it throws
+  // first, |frame| still owns the reference and frees it on return.
+  Napi::External<ffmpeg::AVFramePtr> external =
+      Napi::External<ffmpeg::AVFramePtr>::New(env, &frame);
+  return constructor_.New({external});
+}
+
 AudioData::AudioData(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<AudioData>(info),
       sample_rate_(0),
@@ -100,15 +183,55 @@ AudioData::AudioData(const Napi::CallbackInfo& info)
       timestamp_(0),
       closed_(false) {
   webcodecs::counterAudioData++;
+  // Sample conversions may log; route FFmpeg output through our callback.
+  webcodecs::InitFFmpeg();
+  webcodecs::InitFFmpegLogging();
   Napi::Env env = info.Env();
 
-  if (info.Length() < 1 || !info[0].IsObject()) {
+  if (info.Length() >= 1 && info[0].IsExternal()) {
+    // Zero-copy construction via CreateInstance(AVFramePtr): adopt the
+    // refcounted frame. Samples are only materialised by copyTo().
+    auto* owned = info[0].As<Napi::External<ffmpeg::AVFramePtr>>().Data();
+    if (!owned || !*owned) {
+      Napi::TypeError::New(env, "AudioData requires a valid AVFrame")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    frame_ = std::move(*owned);
+    AdoptFrame(env);
+    return;
+  }
+
+  // Transfer from another environment via detach(): new AudioData(handle,
+  // init) adopts the parked frame or packed buffer without copying it.
+  bool transferred = false;
+  if (info.Length() >= 2 && info[0].IsNumber()) {
+    webcodecs::TransferPayload payload;
+    uint64_t handle =
+        static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value());
+    if (!webcodecs::TransferRegistry::Instance().Take(handle, &payload)) {
+      Napi::Error::New(
+          env, "DataCloneError: AudioData transfer handle is not valid")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    if (payload.frame) {
+      frame_ = std::move(payload.frame);
+      AdoptFrame(env);
+      return;
+    }
+    data_ = std::move(payload.data);
+    transferred = true;
+  }
+
+  Napi::Value init_val = info[transferred ? 1 : 0];
+  if (info.Length() < 1 || !init_val.IsObject()) {
     Napi::TypeError::New(env, "AudioData requires init object")
         .ThrowAsJavaScriptException();
     return;
   }
 
-  Napi::Object init = info[0].As<Napi::Object>();
+  Napi::Object init = init_val.As<Napi::Object>();
 
   // Required: format.
   if (!webcodecs::HasAttr(init, "format") || !init.Get("format").IsString()) {
@@ -163,32 +286,34 @@ AudioData::AudioData(const Napi::CallbackInfo& info)
   }
   timestamp_ = webcodecs::AttrAsInt64(init, "timestamp");
 
-  // Required: data.
-  if (!init.Has("data")) {
-    Napi::TypeError::New(env, "init.data is required")
-        .ThrowAsJavaScriptException();
-    return;
-  }
+  // Required: data, unless the samples were transferred in.
+  if (!transferred) {
+    if (!init.Has("data")) {
+      Napi::TypeError::New(env, "init.data is required")
+          .ThrowAsJavaScriptException();
+      return;
+    }
 
-  Napi::Value data_val = init.Get("data");
-  if (data_val.IsBuffer()) {
-    Napi::Buffer<uint8_t> buf = data_val.As<Napi::Buffer<uint8_t>>();
-    data_.assign(buf.Data(), buf.Data() + buf.Length());
-  } else if (data_val.IsArrayBuffer()) {
-    Napi::ArrayBuffer ab = data_val.As<Napi::ArrayBuffer>();
-    data_.assign(static_cast<uint8_t*>(ab.Data()),
-                 static_cast<uint8_t*>(ab.Data()) + ab.ByteLength());
-  } else if (data_val.IsTypedArray()) {
-    Napi::TypedArray ta = data_val.As<Napi::TypedArray>();
-    Napi::ArrayBuffer ab = ta.ArrayBuffer();
-    size_t offset = ta.ByteOffset();
-    size_t length = ta.ByteLength();
-    data_.assign(static_cast<uint8_t*>(ab.Data()) + offset,
-                 static_cast<uint8_t*>(ab.Data()) + offset + length);
-  } else {
-    Napi::TypeError::New(env, "init.data must be BufferSource")
-        .ThrowAsJavaScriptException();
-    return;
+    Napi::Value data_val = init.Get("data");
+    if (data_val.IsBuffer()) {
+      Napi::Buffer<uint8_t> buf = data_val.As<Napi::Buffer<uint8_t>>();
+      data_.assign(buf.Data(), buf.Data() + buf.Length());
+    } else if (data_val.IsArrayBuffer()) {
+      Napi::ArrayBuffer ab = data_val.As<Napi::ArrayBuffer>();
+      data_.assign(static_cast<uint8_t*>(ab.Data()),
+                   static_cast<uint8_t*>(ab.Data()) + ab.ByteLength());
+    } else if (data_val.IsTypedArray()) {
+      Napi::TypedArray ta = data_val.As<Napi::TypedArray>();
+      Napi::ArrayBuffer ab = ta.ArrayBuffer();
+      size_t offset = ta.ByteOffset();
+      size_t length = ta.ByteLength();
+      data_.assign(static_cast<uint8_t*>(ab.Data()) + offset,
+                   static_cast<uint8_t*>(ab.Data()) + offset + length);
+    } else {
+      Napi::TypeError::New(env, "init.data must be BufferSource")
+          .ThrowAsJavaScriptException();
+      return;
+    }
   }
 
   // Validate data size.
@@ -201,8 +326,23 @@ AudioData::AudioData(const Napi::CallbackInfo& info)
   }
 
   // Inform V8 of external memory allocation for GC pressure calculation.
-  Napi::MemoryManagement::AdjustExternalMemory(
-      env, static_cast<int64_t>(data_.size()));
+  external_memory_.Set(env, static_cast<int64_t>(data_.size()));
+}
+
+void AudioData::AdoptFrame(Napi::Env env) {
+  format_ = SampleFormatToString(static_cast<AVSampleFormat>(frame_->format));
+  sample_rate_ = static_cast<uint32_t>(frame_->sample_rate);
+  number_of_frames_ = static_cast<uint32_t>(frame_->nb_samples);
+  number_of_channels_ = static_cast<uint32_t>(frame_->ch_layout.nb_channels);
+  timestamp_ = frame_->pts != AV_NOPTS_VALUE ? frame_->pts : 0;
+  int64_t bytes = 0;
+  for (int i = 0; i < AV_NUM_DATA_POINTERS && frame_->buf[i]; ++i) {
+    bytes += static_cast<int64_t>(frame_->buf[i]->size);
+  }
+  for (int i = 0; i < frame_->nb_extended_buf; ++i) {
+    bytes += static_cast<int64_t>(frame_->extended_buf[i]->size);
+  }
+  external_memory_.Set(env, bytes);
 }
 
 AudioData::~AudioData() {
@@ -214,11 +354,11 @@ AudioData::~AudioData() {
   // race conditions with V8's ArrayBufferSweeper during Heap::TearDown().
   // See: https://github.com/nodejs/node-addon-api/issues/1153
   //
-  // The WebCodecs spec mandates that close() must be called for proper
-  // resource management. External memory tracking is handled exclusively
-  // in Close() to avoid shutdown crashes.
+  // If close() wasn't called, external_memory_'s destructor releases the
+  // accounted bytes now and the V8 side on the next adjustment.
   data_.clear();
   data_.shrink_to_fit();
+  frame_.reset();
 }
 
 size_t AudioData::GetBytesPerSample() const {
@@ -235,10 +375,54 @@ size_t AudioData::GetBytesPerSample() const {
   return 4;  // Default.
 }
 
+AVSampleFormat AudioData::GetSampleFormat() const {
+  return ParseAudioFormat(format_);
+}
+
 bool AudioData::IsPlanar() const {
   return format_.find("-planar") != std::string::npos;
 }
 
+const uint8_t* AudioData::PlaneData(uint32_t plane) const {
+  if (frame_) {
+    return frame_->extended_data[plane];
+  }
+  return data_.data() + plane * number_of_frames_ * GetBytesPerSample();
+}
+
+bool AudioData::RefAVFrame(AVFrame* dst) const {
+  if (frame_) {
+    return av_frame_ref(dst, frame_.get()) >= 0;
+  }
+
+  AVSampleFormat format = GetSampleFormat();
+  int channels = static_cast<int>(number_of_channels_);
+  int nb_samples = static_cast<int>(number_of_frames_);
+  int data_size =
+      av_samples_get_buffer_size(nullptr, channels, nb_samples, format, 1);
+  if (format == AV_SAMPLE_FMT_NONE || nb_samples <= 0 || channels <= 0 ||
+      data_size < 0 || data_.size() < static_cast<size_t>(data_size)) {
+    return false;
+  }
+
+  dst->format = format;
+  dst->nb_samples = nb_samples;
+  dst->sample_rate = static_cast<int>(sample_rate_);
+  dst->pts = timestamp_;
+  av_channel_layout_uninit(&dst->ch_layout);
+  av_channel_layout_default(&dst->ch_layout, channels);
+  if (av_frame_get_buffer(dst, 0) < 0) {
+    return false;
+  }
+  // data_ planes are packed back to back without padding.
+  std::vector<uint8_t*> planes(av_sample_fmt_is_planar(format) ? channels : 1);
+  av_samples_fill_arrays(planes.data(), nullptr, data_.data(), channels,
+                         nb_samples, format, 1);
+  av_samples_copy(dst->extended_data, planes.data(), 0, 0, nb_samples,
+                  channels, format);
+  return true;
+}
+
 Napi::Value AudioData::GetFormat(const Napi::CallbackInfo& info) {
   if (closed_) {
     return info.Env().Null();
@@ -296,19 +480,6 @@ Napi::Value AudioData::AllocationSize(const Napi::CallbackInfo& info) {
   }
   uint32_t plane_index = webcodecs::AttrAsUint32(options, "planeIndex");
 
-  // Validate planeIndex.
-  bool is_planar = IsPlanar();
-  if (!is_planar && plane_index != 0) {
-    Napi::RangeError::New(env, "planeIndex must be 0 for interleaved formats")
-        .ThrowAsJavaScriptException();
-    return env.Undefined();
-  }
-  if (is_planar && plane_index >= number_of_channels_) {
-    Napi::RangeError::New(env, "planeIndex out of range")
-        .ThrowAsJavaScriptException();
-    return env.Undefined();
-  }
-
   // Optional: frameOffset (default 0).
   uint32_t frame_offset = 0;
   if (webcodecs::HasAttr(options, "frameOffset") &&
@@ -347,9 +518,21 @@ Napi::Value AudioData::AllocationSize(const Napi::CallbackInfo& info) {
     }
   }
 
+  // Validate planeIndex against the destination format (per W3C spec).
+  bool target_planar = IsPlanarFormat(target_format);
+  if (!target_planar && plane_index != 0) {
+    Napi::RangeError::New(env, "planeIndex must be 0 for interleaved formats")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (target_planar && plane_index >= number_of_channels_) {
+    Napi::RangeError::New(env, "planeIndex out of range")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
   // Calculate allocation size.
   size_t bytes_per_sample = GetFormatBytesPerSample(target_format);
-  bool target_planar = IsPlanarFormat(target_format);
 
   size_t size;
   if (target_planar) {
@@ -419,19 +602,6 @@ void AudioData::CopyTo(const Napi::CallbackInfo& info) {
   }
   uint32_t plane_index = webcodecs::AttrAsUint32(options, "planeIndex");
 
-  // Validate planeIndex.
-  bool is_planar = IsPlanar();
-  if (!is_planar && plane_index != 0) {
-    Napi::RangeError::New(env, "planeIndex must be 0 for interleaved formats")
-        .ThrowAsJavaScriptException();
-    return;
-  }
-  if (is_planar && plane_index >= number_of_channels_) {
-    Napi::RangeError::New(env, "planeIndex out of range")
-        .ThrowAsJavaScriptException();
-    return;
-  }
-
   // Optional: frameOffset (default 0).
   uint32_t frame_offset = 0;
   if (webcodecs::HasAttr(options, "frameOffset") &&
@@ -470,10 +640,23 @@ void AudioData::CopyTo(const Napi::CallbackInfo& info) {
     }
   }
 
+  // Validate planeIndex against the destination format (per W3C spec).
+  bool is_planar = IsPlanar();
+  bool target_planar = IsPlanarFormat(target_format);
+  if (!target_planar && plane_index != 0) {
+    Napi::RangeError::New(env, "planeIndex must be 0 for interleaved formats")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  if (target_planar && plane_index >= number_of_channels_) {
+    Napi::RangeError::New(env, "planeIndex out of range")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
   // Calculate required size.
   size_t bytes_per_sample = GetBytesPerSample();
   size_t target_bytes_per_sample = GetFormatBytesPerSample(target_format);
-  bool target_planar = IsPlanarFormat(target_format);
 
   size_t required_size;
   if (target_planar) {
@@ -490,29 +673,21 @@ void AudioData::CopyTo(const Napi::CallbackInfo& info) {
 
   // Same format: direct copy.
   if (target_format == format_) {
-    size_t src_offset;
+    const uint8_t* src;
     size_t copy_size;
 
     if (is_planar) {
-      // Planar: each plane is numberOfFrames * bytesPerSample.
-      size_t plane_size = number_of_frames_ * bytes_per_sample;
-      src_offset = plane_index * plane_size + frame_offset * bytes_per_sample;
+      // Planar: one plane per channel.
+      src = PlaneData(plane_index) + frame_offset * bytes_per_sample;
       copy_size = frame_count * bytes_per_sample;
     } else {
       // Interleaved: samples are channel-interleaved.
-      src_offset = frame_offset * number_of_channels_ * bytes_per_sample;
+      src = PlaneData(0) +
+            frame_offset * number_of_channels_ * bytes_per_sample;
       copy_size = frame_count * number_of_channels_ * bytes_per_sample;
     }
 
-    std::memcpy(dest_data, data_.data() + src_offset, copy_size);
-    return;
-  }
-
-  // Format conversion using libswresample.
-  // Validate channel count for planar format arrays (max 8 channels supported).
-  if (number_of_channels_ > 8) {
-    Napi::RangeError::New(env, "Format conversion supports maximum 8 channels")
-        .ThrowAsJavaScriptException();
+    std::memcpy(dest_data, src, copy_size);
     return;
   }
 
@@ -525,116 +700,131 @@ void AudioData::CopyTo(const Napi::CallbackInfo& info) {
     return;
   }
 
-  // Create resampler context (RAII managed).
-  ffmpeg::SwrContextPtr swr(swr_alloc());
+  // Converting sample type never mixes channels, so a planar destination
+  // (one channel) only needs its own channel converted.
+  AVSampleFormat src_type = av_get_packed_sample_fmt(src_fmt);
+  AVSampleFormat dst_type = av_get_packed_sample_fmt(dst_fmt);
+  int channels = target_planar ? 1 : static_cast<int>(number_of_channels_);
+
+  std::vector<const uint8_t*> src_data;
+  std::vector<uint8_t> gathered;
+  if (target_planar && is_planar) {
+    src_data.push_back(PlaneData(plane_index) +
+                       frame_offset * bytes_per_sample);
+  } else if (target_planar) {
+    // Gather the channel out of the interleaved samples. When only the
+    // layout changes, that is the whole copy.
+    uint8_t* out = dest_data;
+    if (src_type != dst_type) {
+      gathered.resize(frame_count * bytes_per_sample);
+      out = gathered.data();
+    }
+    size_t stride = number_of_channels_ * bytes_per_sample;
+    const uint8_t* in =
+        PlaneData(0) + frame_offset * stride + plane_index * bytes_per_sample;
+    for (uint32_t i = 0; i < frame_count; i++) {
+      std::memcpy(out + i * bytes_per_sample, in + i * stride,
+                  bytes_per_sample);
+    }
+    if (src_type == dst_type) {
+      return;
+    }
+    src_data.push_back(gathered.data());
+  } else if (is_planar) {
+    for (uint32_t c = 0; c < number_of_channels_; c++) {
+      src_data.push_back(PlaneData(c) + frame_offset * bytes_per_sample);
+    }
+  } else {
+    src_data.push_back(PlaneData(0) +
+                       frame_offset * number_of_channels_ * bytes_per_sample);
+  }
+
+  // A single channel is the same in packed and planar layouts.
+  SwrContext* swr = target_planar
+                        ? GetSampleConverter(src_type, dst_type, channels)
+                        : GetSampleConverter(src_fmt, dst_fmt, channels);
   if (!swr) {
-    Napi::Error::New(env, "Failed to allocate SwrContext")
+    Napi::Error::New(env, "Failed to initialize SwrContext")
         .ThrowAsJavaScriptException();
     return;
   }
 
-  // Configure channel layout (same number of channels, just reordering for
-  // planar/interleaved).
-  AVChannelLayout ch_layout;
-  av_channel_layout_default(&ch_layout, number_of_channels_);
-
-  // Set input parameters.
-  av_opt_set_chlayout(swr.get(), "in_chlayout", &ch_layout, 0);
-  av_opt_set_int(swr.get(), "in_sample_rate", sample_rate_, 0);
-  av_opt_set_sample_fmt(swr.get(), "in_sample_fmt", src_fmt, 0);
-
-  // Set output parameters.
-  av_opt_set_chlayout(swr.get(), "out_chlayout", &ch_layout, 0);
-  av_opt_set_int(swr.get(), "out_sample_rate", sample_rate_, 0);
-  av_opt_set_sample_fmt(swr.get(), "out_sample_fmt", dst_fmt, 0);
-
-  int ret = swr_init(swr.get());
+  uint8_t* dst_data[1] = {dest_data};
+  int ret = swr_convert(swr, dst_data, frame_count, src_data.data(),
+                        frame_count);
   if (ret < 0) {
-    av_channel_layout_uninit(&ch_layout);
-    Napi::Error::New(env, "Failed to initialize SwrContext")
-        .ThrowAsJavaScriptException();
+    Napi::Error::New(env, "swr_convert failed").ThrowAsJavaScriptException();
     return;
   }
+}
 
-  // Prepare source data pointers.
-  const uint8_t* src_data[8] = {nullptr};
+Napi::Value AudioData::Clone(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-  if (is_planar) {
-    // Source is planar: set up pointers to each channel plane.
-    size_t plane_size = number_of_frames_ * bytes_per_sample;
-    for (uint32_t c = 0; c < number_of_channels_; c++) {
-      src_data[c] =
-          data_.data() + c * plane_size + frame_offset * bytes_per_sample;
-    }
-  } else {
-    // Source is interleaved: single data pointer.
-    src_data[0] =
-        data_.data() + frame_offset * number_of_channels_ * bytes_per_sample;
+  if (closed_) {
+    Napi::Error::New(env, "InvalidStateError: Cannot clone closed AudioData")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
   }
 
-  // Prepare destination data pointers.
-  uint8_t* dst_data[8] = {nullptr};
-
-  if (target_planar) {
-    // For planar output, we only copy the requested plane.
-    // Need temporary buffer for all planes, then extract one.
-    size_t total_out_size =
-        frame_count * number_of_channels_ * target_bytes_per_sample;
-    std::vector<uint8_t> temp_buffer(total_out_size);
-
-    for (uint32_t c = 0; c < number_of_channels_; c++) {
-      dst_data[c] =
-          temp_buffer.data() + c * frame_count * target_bytes_per_sample;
-    }
-
-    ret = swr_convert(swr.get(), dst_data, frame_count, src_data, frame_count);
-    if (ret < 0) {
-      av_channel_layout_uninit(&ch_layout);
-      Napi::Error::New(env, "swr_convert failed").ThrowAsJavaScriptException();
-      return;
-    }
-
-    // Copy requested plane to destination.
-    std::memcpy(dest_data, dst_data[plane_index],
-                frame_count * target_bytes_per_sample);
-  } else {
-    // Interleaved output: write directly to destination.
-    dst_data[0] = dest_data;
-
-    ret = swr_convert(swr.get(), dst_data, frame_count, src_data, frame_count);
-    if (ret < 0) {
-      av_channel_layout_uninit(&ch_layout);
-      Napi::Error::New(env, "swr_convert failed").ThrowAsJavaScriptException();
-      return;
+  // AVFrame-backed data shares its planes with the clone (av_frame_ref).
+  if (frame_) {
+    ffmpeg::AVFramePtr ref(av_frame_clone(frame_.get()));
+    if (!ref) {
+      Napi::Error::New(env, "Failed to reference AudioData samples")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
     }
+    ref->pts = timestamp_;
+    return CreateInstance(env, std::move(ref));
   }
 
-  // RAII handles swr cleanup
-  av_channel_layout_uninit(&ch_layout);
+  return CreateInstance(env, format_, sample_rate_, number_of_frames_,
+                        number_of_channels_, timestamp_, data_.data(),
+                        data_.size());
 }
 
-Napi::Value AudioData::Clone(const Napi::CallbackInfo& info) {
+Napi::Value AudioData::Detach(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   if (closed_) {
-    Napi::Error::New(env, "InvalidStateError: Cannot clone closed AudioData")
+    Napi::Error::New(env,
+                     "InvalidStateError: Cannot transfer closed AudioData")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
-  return CreateInstance(env, format_, sample_rate_, number_of_frames_,
-                        number_of_channels_, timestamp_, data_.data(),
-                        data_.size());
+  Napi::Object init = Napi::Object::New(env);
+  init.Set("format", format_);
+  init.Set("sampleRate", sample_rate_);
+  init.Set("numberOfFrames", number_of_frames_);
+  init.Set("numberOfChannels", number_of_channels_);
+  init.Set("timestamp",
+           Napi::Number::New(env, static_cast<double>(timestamp_)));
+
+  // Ownership of the samples moves to the registry; this AudioData ends up
+  // closed exactly as if close() had been called.
+  webcodecs::TransferPayload payload;
+  payload.frame = std::move(frame_);
+  payload.data = std::move(data_);
+  uint64_t handle =
+      webcodecs::TransferRegistry::Instance().Put(std::move(payload));
+  external_memory_.Release(env);
+  data_.clear();
+  closed_ = true;
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("handle", Napi::Number::New(env, static_cast<double>(handle)));
+  result.Set("init", init);
+  return result;
 }
 
 void AudioData::Close(const Napi::CallbackInfo& info) {
   if (!closed_) {
-    if (!data_.empty()) {
-      Napi::MemoryManagement::AdjustExternalMemory(
-          info.Env(), -static_cast<int64_t>(data_.size()));
-    }
+    external_memory_.Release(info.Env());
     data_.clear();
     data_.shrink_to_fit();
+    frame_.reset();
     closed_ = true;
   }
 }
@@ -4,12 +4,20 @@
 #ifndef SRC_AUDIO_DATA_H_
 #define SRC_AUDIO_DATA_H_
 
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+}
+
 #include <napi.h>
 
 #include <cstdint>
 #include <string>
 #include <vector>
 
+#include "src/common.h"
+#include "src/ffmpeg_raii.h"
+
 class AudioData : public Napi::ObjectWrap<AudioData> {
  public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -19,6 +27,10 @@ class AudioData : public Napi::ObjectWrap<AudioData> {
                                      uint32_t number_of_channels,
                                      int64_t timestamp, const uint8_t* data,
                                      size_t data_size);
+  // Zero-copy overload: the AudioData adopts |frame|'s refcounted planes
+  // (AVBufferRef) instead of copying them. |frame->format| must be one of the
+  // WebCodecs sample formats; |frame->pts| is the timestamp in microseconds.
+  static Napi::Object CreateInstance(Napi::Env env, ffmpeg::AVFramePtr frame);
   explicit AudioData(const Napi::CallbackInfo& info);
   ~AudioData();
 
@@ -39,24 +51,49 @@ class AudioData : public Napi::ObjectWrap<AudioData> {
   void CopyTo(const Napi::CallbackInfo& info);
   Napi::Value Clone(const Napi::CallbackInfo& info);
   void Close(const Napi::CallbackInfo& info);
+  // Move the samples into the TransferRegistry and close this AudioData.
+  // Returns {handle, init}; `new AudioData(handle, init)` in any environment
+  // of this process takes them back out.
+  Napi::Value Detach(const Napi::CallbackInfo& info);
 
   // Internal access for encoder.
-  const std::vector<uint8_t>& GetData() const { return data_; }
+  // Point |dst| at this AudioData's samples: a new reference to the backing
+  // AVFrame, or a copy of the packed buffer. Returns false on failure.
+  bool RefAVFrame(AVFrame* dst) const;
   bool IsClosed() const { return closed_; }
+  AVSampleFormat GetSampleFormat() const;
+  uint32_t GetSampleRateValue() const { return sample_rate_; }
+  uint32_t GetNumberOfFramesValue() const { return number_of_frames_; }
+  uint32_t GetNumberOfChannelsValue() const { return number_of_channels_; }
+  int64_t GetTimestampValue() const { return timestamp_; }
 
  private:
-  static Napi::FunctionReference constructor_;
+  // One per thread: each environment (main thread or worker_thread) defines
+  // its own class.
+  static thread_local Napi::FunctionReference constructor_;
+
+  // Fill in the properties and memory accounting from frame_.
+  void AdoptFrame(Napi::Env env);
 
   // Helper to get bytes per sample for format.
   size_t GetBytesPerSample() const;
   bool IsPlanar() const;
+  // First sample of |plane| (always 0 for interleaved formats).
+  const uint8_t* PlaneData(uint32_t plane) const;
 
   std::string format_;
   uint32_t sample_rate_;
   uint32_t number_of_frames_;
   uint32_t number_of_channels_;
   int64_t timestamp_;
+  // Sample storage: either planes packed back to back (data_) or a
+  // refcounted AVFrame (frame_) from a decoder, whose planes may be padded.
   std::vector<uint8_t> data_;
+  ffmpeg::AVFramePtr frame_;
+  // Sample bytes reported to V8 and the MemoryAccountant, released in
+  // Close().
+  webcodecs::ExternalMemory external_memory_{
+      webcodecs::MemoryCategory::kAudioData};
   bool closed_;
 };
 
@@ -3,21 +3,51 @@
 
 #include "src/audio_decoder.h"
 
+#include <cmath>
+#include <cstdio>
 #include <cstring>
+#include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
-extern "C" {
-#include <libavutil/opt.h>
-}
-
 #include "src/audio_data.h"
 #include "src/common.h"
 #include "src/encoded_audio_chunk.h"
 
 namespace {
 
-constexpr int kBytesPerSampleF32 = 4;
+// Parse the `analysis` option (node-webcodecs extension) into |out|.
+bool ParseAnalysisConfig(Napi::Object config,
+                         webcodecs::AudioDecoderConfig* out,
+                         std::string* error) {
+  if (!webcodecs::HasAttr(config, "analysis")) {
+    return true;
+  }
+  Napi::Value value = config.Get("analysis");
+  if (!value.IsObject()) {
+    *error = "analysis must be an object";
+    return false;
+  }
+  Napi::Object analysis = value.As<Napi::Object>();
+  for (const char* key : {"truePeak", "output"}) {
+    if (webcodecs::HasAttr(analysis, key) &&
+        !analysis.Get(key).IsBoolean()) {
+      *error = std::string("analysis.") + key + " must be a boolean";
+      return false;
+    }
+  }
+  out->analyze = true;
+  out->analyze_true_peak = webcodecs::AttrAsBool(analysis, "truePeak", true);
+  out->output_audio = webcodecs::AttrAsBool(analysis, "output", true);
+  return true;
+}
+
+// Level in dB relative to full scale; -Infinity for silence.
+double LevelDb(double amplitude) {
+  return amplitude > 0 ? 20.0 * std::log10(amplitude)
+                       : -std::numeric_limits<double>::infinity();
+}
 
 }  // namespace
 
@@ -31,12 +61,16 @@ Napi::Object AudioDecoder::Init(Napi::Env env, Napi::Object exports) {
       {
           InstanceMethod("configure", &AudioDecoder::Configure),
           InstanceMethod("decode", &AudioDecoder::Decode),
+          InstanceMethod("decodeBatch", &AudioDecoder::DecodeBatch),
           InstanceMethod("flush", &AudioDecoder::Flush),
           InstanceMethod("reset", &AudioDecoder::Reset),
           InstanceMethod("close", &AudioDecoder::Close),
           InstanceAccessor("state", &AudioDecoder::GetState, nullptr),
           InstanceAccessor("decodeQueueSize", &AudioDecoder::GetDecodeQueueSize,
                            nullptr),
+          InstanceMethod("getStats", &AudioDecoder::GetStats),
+          InstanceMethod("resetStats", &AudioDecoder::ResetStats),
+          InstanceMethod("getAnalysis", &AudioDecoder::GetAnalysis),
           StaticMethod("isConfigSupported", &AudioDecoder::IsConfigSupported),
       });
 
@@ -46,7 +80,6 @@ Napi::Object AudioDecoder::Init(Napi::Env env, Napi::Object exports) {
 
 AudioDecoder::AudioDecoder(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<AudioDecoder>(info),
-      codec_(nullptr),
       state_("unconfigured"),
       sample_rate_(0),
       number_of_channels_(0) {
@@ -75,11 +108,17 @@ AudioDecoder::AudioDecoder(const Napi::CallbackInfo& info)
 
   output_callback_ = Napi::Persistent(init.Get("output").As<Napi::Function>());
   error_callback_ = Napi::Persistent(init.Get("error").As<Napi::Function>());
+  // Runs when a decode() turned away by the 'block' policy may be retried.
+  if (webcodecs::HasAttr(init, "dequeue") &&
+      init.Get("dequeue").IsFunction()) {
+    dequeue_callback_ =
+        Napi::Persistent(init.Get("dequeue").As<Napi::Function>());
+  }
 }
 
 AudioDecoder::~AudioDecoder() {
-  // CRITICAL: Call Cleanup() first to ensure codec context is properly
-  // flushed before any further cleanup.
+  // CRITICAL: Call Cleanup() first so the worker (which owns the codec
+  // context) is joined before any further cleanup.
   Cleanup();
 
   // Now safe to disable FFmpeg logging.
@@ -89,22 +128,119 @@ AudioDecoder::~AudioDecoder() {
 }
 
 void AudioDecoder::Cleanup() {
-  // DARWIN-X64 FIX: Flush codec internal buffers BEFORE destroying resources.
-  // Audio decoders may have internal queued frames. Flushing ensures they're
-  // drained before context destruction, preventing use-after-free.
-  // CRITICAL: Only flush if codec was successfully opened. avcodec_flush_buffers
-  // crashes on an unopened codec context (the internal codec pointer is NULL).
-  // NOTE: Order matters - flush must happen before resetting frame_/packet_/swr_
-  // to match VideoDecoder pattern and ensure codec internal state is consistent.
-  if (codec_context_ && avcodec_is_open(codec_context_.get())) {
-    avcodec_flush_buffers(codec_context_.get());
-  }
-
-  frame_.reset();
-  packet_.reset();
-  swr_context_.reset();
-  codec_context_.reset();
-  codec_ = nullptr;
+  // No output reaches JS from here on; the codec is freed off-loop.
+  RetireWorker();
+
+  // Release TSFNs
+  frame_tsfn_.Release();
+  flush_tsfn_.Release();
+  error_tsfn_.Release();
+  dequeue_notifier_.Release();
+
+  // Clear pending promises
+  pending_flushes_.clear();
+}
+
+void AudioDecoder::RetireWorker() {
+  if (output_gate_) {
+    output_gate_->Close();
+    output_gate_.reset();
+  }
+  // The worker exits after the message in progress, on the reaper thread.
+  if (control_queue_) {
+    control_queue_->Shutdown();
+  }
+  webcodecs::CodecReaper::Instance().Retire(std::move(worker_),
+                                            std::move(control_queue_));
+}
+
+void AudioDecoder::SetupWorkerCallbacks(Napi::Env env) {
+  auto* self = this;
+  webcodecs::OutputGate& gate = *output_gate_;
+
+  worker_->SetOutputFrameCallback(gate.Guard([self](ffmpeg::AVFramePtr frame) {
+    auto* data = new FrameCallbackData{std::move(frame)};
+    if (!self->frame_tsfn_.Call(data)) {
+      delete data;
+    }
+  }));
+
+  worker_->SetOutputErrorCallback(
+      gate.Guard([self](int error_code, const std::string& message) {
+        auto* data = new ErrorCallbackData{error_code, message};
+        if (!self->error_tsfn_.Call(data)) {
+          delete data;
+        }
+      }));
+
+  worker_->SetFlushCompleteCallback(gate.Guard(
+      [self](uint32_t promise_id, bool success, const std::string& error) {
+        auto* data = new FlushCallbackData{promise_id, success, error, self};
+        if (!self->flush_tsfn_.Call(data)) {
+          delete data;
+        }
+      }));
+
+  worker_->SetDequeueCallback(gate.Guard(
+      [self](uint32_t) { self->dequeue_notifier_.Notify(); }));
+}
+
+void AudioDecoder::OnFrameCallback(Napi::Env env, Napi::Function fn,
+                                   std::nullptr_t*, FrameCallbackData* data) {
+  if (env == nullptr || data == nullptr) {
+    delete data;
+    return;
+  }
+
+  // The AudioData adopts the decoder's refcounted planes.
+  ffmpeg::AVFramePtr frame = std::move(data->frame);
+  delete data;
+  Napi::Object audio_data = AudioData::CreateInstance(env, std::move(frame));
+
+  try {
+    fn.Call({audio_data});
+  } catch (const std::exception& e) {
+    fprintf(stderr, "AudioDecoder output callback error: %s\n", e.what());
+  }
+}
+
+void AudioDecoder::OnFlushCallback(Napi::Env env, Napi::Function /* fn */,
+                                   std::nullptr_t*, FlushCallbackData* data) {
+  if (env == nullptr || data == nullptr) {
+    delete data;
+    return;
+  }
+
+  if (data->decoder) {
+    auto it = data->decoder->pending_flushes_.find(data->promise_id);
+    if (it != data->decoder->pending_flushes_.end()) {
+      if (data->success) {
+        it->second.Resolve(env.Undefined());
+      } else {
+        it->second.Reject(
+            Napi::Error::New(env, data->error_message).Value());
+      }
+      data->decoder->pending_flushes_.erase(it);
+    }
+  }
+
+  delete data;
+}
+
+void AudioDecoder::OnErrorCallback(Napi::Env env, Napi::Function fn,
+                                   std::nullptr_t*, ErrorCallbackData* data) {
+  if (env == nullptr || data == nullptr) {
+    delete data;
+    return;
+  }
+
+  try {
+    fn.Call({Napi::Error::New(env, data->message).Value()});
+  } catch (const std::exception& e) {
+    fprintf(stderr, "AudioDecoder error callback error: %s\n", e.what());
+  }
+
+  delete data;
 }
 
 Napi::Value AudioDecoder::Configure(const Napi::CallbackInfo& info) {
@@ -146,32 +282,54 @@ Napi::Value AudioDecoder::Configure(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  // Find decoder.
-  const AVCodec* decoder = avcodec_find_decoder(codec_id);
-  if (!decoder) {
+  // Check the decoder exists up front so NotSupportedError stays synchronous.
+  if (!webcodecs::FindDecoder(codec_id)) {
     Napi::Error::New(env, "NotSupportedError: Decoder not found for codec")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
-  // Clean up any previous context.
-  Cleanup();
+  // Parse threading (node-webcodecs extension).
+  webcodecs::CodecThreadingConfig threading;
+  std::string threading_error;
+  if (!webcodecs::ParseThreadingConfig(config, &threading, &threading_error)) {
+    Napi::TypeError::New(env, threading_error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
 
-  // Store the found decoder.
-  codec_ = decoder;
-  codec_context_ = ffmpeg::make_codec_context(codec_);
-  if (!codec_context_) {
-    Napi::Error::New(env, "Could not allocate codec context")
-        .ThrowAsJavaScriptException();
+  // Parse output batching (node-webcodecs extension).
+  int output_batch_size = 1;
+  std::string batch_error;
+  if (!webcodecs::ParseOutputBatchSize(config, &output_batch_size,
+                                       &batch_error)) {
+    Napi::TypeError::New(env, batch_error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // Parse queue limits (node-webcodecs extension).
+  webcodecs::QueueLimits queue_limits;
+  std::string limits_error;
+  if (!webcodecs::ParseQueueLimits(config, &queue_limits, &limits_error)) {
+    Napi::TypeError::New(env, limits_error).ThrowAsJavaScriptException();
     return env.Undefined();
   }
+  queue_limits_ = queue_limits;
+
+  webcodecs::AudioDecoderConfig decoder_config;
+  std::string analysis_error;
+  if (!ParseAnalysisConfig(config, &decoder_config, &analysis_error)) {
+    Napi::TypeError::New(env, analysis_error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // Tear down any previous worker.
+  Cleanup();
 
   // Parse sample rate.
   sample_rate_ = webcodecs::AttrAsUint32(config, "sampleRate");
   if (sample_rate_ == 0) {
     sample_rate_ = 48000;
   }
-  codec_context_->sample_rate = sample_rate_;
 
   // Parse number of channels.
   number_of_channels_ = webcodecs::AttrAsUint32(config, "numberOfChannels");
@@ -179,65 +337,66 @@ Napi::Value AudioDecoder::Configure(const Napi::CallbackInfo& info) {
     number_of_channels_ = 2;
   }
 
-  // Set channel layout based on number of channels.
-  av_channel_layout_default(&codec_context_->ch_layout, number_of_channels_);
+  decoder_config.codec_id = codec_id;
+  decoder_config.sample_rate = static_cast<int>(sample_rate_);
+  decoder_config.number_of_channels = static_cast<int>(number_of_channels_);
+  decoder_config.threading = threading;
 
   // Handle optional description (extradata / codec specific data).
-  if (config.Has("description")) {
-    Napi::Value desc_val = config.Get("description");
-    if (desc_val.IsTypedArray()) {
-      Napi::TypedArray ta = desc_val.As<Napi::TypedArray>();
-      Napi::ArrayBuffer ab = ta.ArrayBuffer();
-      size_t offset = ta.ByteOffset();
-      size_t length = ta.ByteLength();
-
-      codec_context_->extradata = static_cast<uint8_t*>(
-          av_malloc(length + AV_INPUT_BUFFER_PADDING_SIZE));
-      if (codec_context_->extradata) {
-        std::memcpy(codec_context_->extradata,
-                    static_cast<uint8_t*>(ab.Data()) + offset, length);
-        std::memset(codec_context_->extradata + length, 0,
-                    AV_INPUT_BUFFER_PADDING_SIZE);
-        codec_context_->extradata_size = static_cast<int>(length);
-      }
-    } else if (desc_val.IsArrayBuffer()) {
-      Napi::ArrayBuffer ab = desc_val.As<Napi::ArrayBuffer>();
-      size_t length = ab.ByteLength();
-
-      codec_context_->extradata = static_cast<uint8_t*>(
-          av_malloc(length + AV_INPUT_BUFFER_PADDING_SIZE));
-      if (codec_context_->extradata) {
-        std::memcpy(codec_context_->extradata, ab.Data(), length);
-        std::memset(codec_context_->extradata + length, 0,
-                    AV_INPUT_BUFFER_PADDING_SIZE);
-        codec_context_->extradata_size = static_cast<int>(length);
-      }
-    }
+  auto [desc_data, desc_size] = webcodecs::AttrAsBuffer(config, "description");
+  if (desc_data != nullptr && desc_size > 0) {
+    decoder_config.extradata.assign(desc_data, desc_data + desc_size);
+  }
+
+  // Create control queue and worker
+  control_queue_ = std::make_unique<webcodecs::AudioControlQueue>();
+  worker_ =
+      std::make_unique<webcodecs::AudioDecoderWorker>(control_queue_.get());
+  output_gate_ = webcodecs::OutputGate::Create();
+
+  // Create TSFNs for callbacks
+  auto frame_tsfn = FrameTSFN::TSFN::New(env, output_callback_.Value(),
+                                         "AudioDecoderFrame", 0, 1);
+  frame_tsfn_.Init(std::move(frame_tsfn), output_batch_size, stats_.get());
+
+  // Flush completion resolves a stored deferred; the function is unused.
+  auto flush_fn = Napi::Function::New(env, [](const Napi::CallbackInfo&) {});
+  auto flush_tsfn =
+      FlushTSFN::TSFN::New(env, flush_fn, "AudioDecoderFlush", 0, 1);
+  flush_tsfn_.Init(std::move(flush_tsfn));
+
+  auto error_tsfn = ErrorTSFN::TSFN::New(env, error_callback_.Value(),
+                                         "AudioDecoderError", 0, 1);
+  error_tsfn_.Init(std::move(error_tsfn));
+  dequeue_notifier_.Init(env, dequeue_callback_, "AudioDecoderDequeue");
+
+  SetupWorkerCallbacks(env);
+  worker_->SetConfig(decoder_config);
+  // Each configuration measures afresh.
+  analysis_.reset();
+  if (decoder_config.analyze) {
+    analysis_ = std::make_shared<webcodecs::AudioAnalysis>();
+    worker_->SetAnalysis(analysis_);
   }
 
-  // Open codec.
-  int ret = avcodec_open2(codec_context_.get(), codec_, nullptr);
-  if (ret < 0) {
-    char errbuf[256];
-    av_strerror(ret, errbuf, sizeof(errbuf));
-    Cleanup();
-    Napi::Error::New(env, std::string("Could not open decoder: ") + errbuf)
+  worker_->SetStats(stats_);
+  worker_->SetPlacement(threading.placement);
+  if (!worker_->Start()) {
+    Napi::Error::New(env, "Failed to start decoder worker")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
-  // Allocate frame and packet.
-  frame_ = ffmpeg::make_frame();
-  packet_ = ffmpeg::make_packet();
-
-  if (!frame_ || !packet_) {
-    Cleanup();
-    Napi::Error::New(env, "Could not allocate frame/packet")
+  webcodecs::AudioControlQueue::ConfigureMessage configure_msg;
+  configure_msg.configure_fn = []() { return true; };
+  if (!worker_->Enqueue(std::move(configure_msg))) {
+    Napi::Error::New(env, "Failed to enqueue configure message")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
   state_ = "configured";
+  drop_until_key_ = false;
 
   return env.Undefined();
 }
@@ -247,7 +406,53 @@ Napi::Value AudioDecoder::GetState(const Napi::CallbackInfo& info) {
 }
 
 Napi::Value AudioDecoder::GetDecodeQueueSize(const Napi::CallbackInfo& info) {
-  return Napi::Number::New(info.Env(), decode_queue_size_);
+  // Decode requests not yet picked up by the worker.
+  size_t size = control_queue_ ? control_queue_->size() : 0;
+  return Napi::Number::New(info.Env(), static_cast<double>(size));
+}
+
+Napi::Value AudioDecoder::GetStats(const Napi::CallbackInfo& info) {
+  return webcodecs::CodecStatsToObject(info.Env(), *stats_);
+}
+
+void AudioDecoder::ResetStats(const Napi::CallbackInfo& info) {
+  stats_->Reset();
+}
+
+Napi::Value AudioDecoder::GetAnalysis(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!analysis_) {
+    return env.Null();
+  }
+
+  webcodecs::LoudnessMeter::Summary summary;
+  int sample_rate;
+  bool true_peak;
+  {
+    std::lock_guard<std::mutex> lock(analysis_->mutex);
+    summary = analysis_->meter.GetSummary();
+    sample_rate = analysis_->meter.sample_rate();
+    true_peak = analysis_->meter.true_peak_enabled();
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("integratedLoudness", summary.integrated);
+  result.Set("momentaryLoudness", summary.momentary);
+  result.Set("shortTermLoudness", summary.short_term);
+  result.Set("maxMomentaryLoudness", summary.max_momentary);
+  result.Set("maxShortTermLoudness", summary.max_short_term);
+  result.Set("loudnessRange", summary.loudness_range);
+  if (true_peak) {
+    result.Set("truePeak", LevelDb(summary.true_peak));
+  }
+  result.Set("samplePeak", LevelDb(summary.sample_peak));
+  result.Set("rms", LevelDb(summary.rms));
+  // Microseconds, as AudioData.duration
+  result.Set("duration",
+             sample_rate > 0
+                 ? static_cast<double>(summary.frames) * 1e6 / sample_rate
+                 : 0.0);
+  return result;
 }
 
 void AudioDecoder::Close(const Napi::CallbackInfo& info) {
@@ -263,19 +468,20 @@ Napi::Value AudioDecoder::Reset(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  // Flush any pending frames (discard them).
-  if (codec_context_) {
-    avcodec_send_packet(codec_context_.get(), nullptr);
-    while (avcodec_receive_frame(codec_context_.get(), frame_.get()) == 0) {
-      av_frame_unref(frame_.get());
-    }
+  // Reject pending flushes before Cleanup() drops them.
+  for (auto& [id, deferred] : pending_flushes_) {
+    deferred.Reject(Napi::Error::New(env, "Decoder reset").Value());
   }
+  pending_flushes_.clear();
 
+  // Discards queued decodes and any frames still inside the codec.
   Cleanup();
+
   state_ = "unconfigured";
+  drop_until_key_ = false;
+  analysis_.reset();
   sample_rate_ = 0;
   number_of_channels_ = 0;
-  decode_queue_size_ = 0;
 
   return env.Undefined();
 }
@@ -283,7 +489,7 @@ Napi::Value AudioDecoder::Reset(const Napi::CallbackInfo& info) {
 Napi::Value AudioDecoder::Decode(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  if (state_ != "configured") {
+  if (state_ != "configured" || !control_queue_) {
     Napi::Error::New(env, "InvalidStateError: Decoder not configured")
         .ThrowAsJavaScriptException();
     return env.Undefined();
@@ -295,177 +501,215 @@ Napi::Value AudioDecoder::Decode(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  // Unwrap EncodedAudioChunk.
-  EncodedAudioChunk* chunk =
-      Napi::ObjectWrap<EncodedAudioChunk>::Unwrap(info[0].As<Napi::Object>());
-
-  const std::vector<uint8_t>& data = chunk->GetData();
-
-  // Setup packet.
-  av_packet_unref(packet_.get());
-  packet_->data = const_cast<uint8_t*>(data.data());
-  packet_->size = static_cast<int>(data.size());
-
-  // Send packet to decoder.
-  int ret = avcodec_send_packet(codec_context_.get(), packet_.get());
-  if (ret < 0 && ret != AVERROR(EAGAIN)) {
-    char errbuf[256];
-    av_strerror(ret, errbuf, sizeof(errbuf));
-    error_callback_.Call(
-        {Napi::Error::New(env, std::string("Decode error: ") + errbuf)
-             .Value()});
+  int dropped = 0;
+  if (!DecodeChunk(env, info[0].As<Napi::Object>(), nullptr, &dropped)) {
     return env.Undefined();
   }
-
-  // Increment queue size after successful packet submission
-  decode_queue_size_++;
-
-  // Emit any available decoded audio data.
-  EmitAudioData(env);
-
-  return env.Undefined();
+  return Napi::Number::New(env, dropped);
 }
 
-Napi::Value AudioDecoder::Flush(const Napi::CallbackInfo& info) {
+Napi::Value AudioDecoder::DecodeBatch(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  if (state_ != "configured") {
-    // Return resolved promise if not configured.
-    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-    deferred.Resolve(env.Undefined());
-    return deferred.Promise();
+  if (state_ != "configured" || !control_queue_) {
+    Napi::Error::New(env, "InvalidStateError: Decoder not configured")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
   }
 
-  // Send NULL packet to flush decoder.
-  int ret = avcodec_send_packet(codec_context_.get(), nullptr);
-  if (ret < 0 && ret != AVERROR_EOF) {
-    char errbuf[256];
-    av_strerror(ret, errbuf, sizeof(errbuf));
-    error_callback_.Call(
-        {Napi::Error::New(env, std::string("Flush error: ") + errbuf).Value()});
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env,
+                         "decodeBatch requires an array of EncodedAudioChunks")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Array chunks = info[0].As<Napi::Array>();
+
+  // Chunks are staged and enqueued under one lock. Returns [chunks
+  // consumed, requests dropped]; a 'block' policy stop leaves the rest to
+  // the JS layer.
+  Staged staged;
+  uint32_t consumed = 0;
+  int dropped = 0;
+  for (; consumed < chunks.Length(); ++consumed) {
+    Napi::Value chunk = chunks.Get(consumed);
+    int result = 0;
+    if (!chunk.IsObject()) {
+      Napi::Error::New(env, "decode requires EncodedAudioChunk")
+          .ThrowAsJavaScriptException();
+    } else if (DecodeChunk(env, chunk.As<Napi::Object>(), &staged, &result)) {
+      if (result < 0) {
+        break;
+      }
+      dropped += result;
+      continue;
+    }
+    // Chunks before the failing one stay queued, as with decode() calls;
+    // the pending exception already reports the failure.
+    (void)control_queue_->EnqueueAll(staged.Take());
+    return env.Undefined();
+  }
+  if (!EnqueueStaged(env, &staged)) {
+    return env.Undefined();
   }
 
-  // Emit remaining decoded audio data.
-  EmitAudioData(env);
-
-  // Reset queue after flush
-  decode_queue_size_ = 0;
+  Napi::Array result = Napi::Array::New(env, 2);
+  result.Set(0u, Napi::Number::New(env, consumed));
+  result.Set(1u, Napi::Number::New(env, dropped));
+  return result;
+}
 
-  // Return resolved promise.
-  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-  deferred.Resolve(env.Undefined());
-  return deferred.Promise();
+bool AudioDecoder::EnqueueStaged(Napi::Env env, Staged* staged) {
+  if (!control_queue_->EnqueueAll(staged->Take())) {
+    Napi::Error::New(env, "Failed to enqueue decode message")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
 }
 
-void AudioDecoder::EmitAudioData(Napi::Env env) {
-  while (true) {
-    int ret = avcodec_receive_frame(codec_context_.get(), frame_.get());
-    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-      break;
-    }
-    if (ret < 0) {
-      char errbuf[256];
-      av_strerror(ret, errbuf, sizeof(errbuf));
-      error_callback_.Call(
-          {Napi::Error::New(env, std::string("Decode receive error: ") + errbuf)
-               .Value()});
-      break;
-    }
+bool AudioDecoder::DecodeChunk(Napi::Env env, Napi::Object chunk_obj,
+                               Staged* staged, int* dropped_out) {
+  // Unwrap EncodedAudioChunk.
+  EncodedAudioChunk* chunk =
+      Napi::ObjectWrap<EncodedAudioChunk>::Unwrap(chunk_obj);
 
-    // Get frame parameters.
-    int nb_samples = frame_->nb_samples;
-    int nb_channels = frame_->ch_layout.nb_channels;
-
-    // Initialize resampler if needed (convert to f32 interleaved).
-    if (!swr_context_) {
-      swr_context_.reset(swr_alloc());
-      if (!swr_context_) {
-        error_callback_.Call(
-            {Napi::Error::New(env, "Could not allocate resampler").Value()});
-        av_frame_unref(frame_.get());
-        break;
-      }
+  // Share the chunk's refcounted payload with the worker; no data is copied.
+  auto packet = chunk->RefPacket();
+  if (!packet) {
+    Napi::Error::New(env, "InvalidStateError: EncodedAudioChunk is closed")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+  bool is_key_frame = (chunk->GetTypeValue() == "key");
+  packet->pts = chunk->GetTimestampValue();
+  packet->dts = packet->pts;
+  packet->duration = 0;
+  packet->flags = is_key_frame ? AV_PKT_FLAG_KEY : 0;
+
+  // Refuse new work while native memory is over the soft limit set with
+  // setMemoryLimit() (node-webcodecs extension).
+  if (webcodecs::MemoryAccountant::Instance().OverSoftLimit()) {
+    Napi::Error::New(env,
+                     "QuotaExceededError: Native memory is over the soft "
+                     "limit. Close frames and chunks you no longer need "
+                     "before decoding more.")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
 
-      // Configure resampler: decoder's format -> f32 interleaved.
-      av_opt_set_chlayout(swr_context_.get(), "in_chlayout", &frame_->ch_layout,
-                          0);
-      av_opt_set_int(swr_context_.get(), "in_sample_rate", frame_->sample_rate,
-                     0);
-      av_opt_set_sample_fmt(swr_context_.get(), "in_sample_fmt",
-                            static_cast<AVSampleFormat>(frame_->format), 0);
-
-      AVChannelLayout out_layout;
-      av_channel_layout_default(&out_layout, nb_channels);
-      av_opt_set_chlayout(swr_context_.get(), "out_chlayout", &out_layout, 0);
-      av_opt_set_int(swr_context_.get(), "out_sample_rate", frame_->sample_rate,
-                     0);
-      av_opt_set_sample_fmt(swr_context_.get(), "out_sample_fmt",
-                            AV_SAMPLE_FMT_FLT, 0);
-
-      ret = swr_init(swr_context_.get());
-      if (ret < 0) {
-        char errbuf[256];
-        av_strerror(ret, errbuf, sizeof(errbuf));
-        error_callback_.Call(
-            {Napi::Error::New(
-                 env, std::string("Could not init resampler: ") + errbuf)
-                 .Value()});
-        swr_context_.reset();
-        av_frame_unref(frame_.get());
-        break;
+  // A batch stops staging once its chunks would break the queue limits:
+  // they are enqueued and the limits then apply to this chunk as usual.
+  size_t packet_bytes = static_cast<size_t>(packet->size);
+  if (staged && !staged->empty() && QueueFull(packet_bytes, staged) &&
+      !EnqueueStaged(env, staged)) {
+    return false;
+  }
+
+  // Apply the queue limits. Reports how many decode requests were dropped
+  // (including this one), or -1 when the 'block' policy wants the JS layer
+  // to retry once the queue drains.
+  int dropped = 0;
+  while (QueueFull(packet_bytes)) {
+    if (queue_limits_.policy == webcodecs::QueuePolicy::kBlock) {
+      // Look again after asking for a wake-up; the worker may have made
+      // room before it could see the request.
+      dequeue_notifier_.Request();
+      if (QueueFull(packet_bytes)) {
+        *dropped_out = -1;
+        return true;
       }
+      break;
     }
-
-    // Allocate output buffer for f32 interleaved.
-    size_t output_size = nb_samples * nb_channels * kBytesPerSampleF32;
-    std::vector<uint8_t> output_data(output_size);
-
-    uint8_t* output_ptr = output_data.data();
-
-    // Convert audio.
-    int converted =
-        swr_convert(swr_context_.get(), &output_ptr, nb_samples,
-                    const_cast<const uint8_t**>(frame_->data), nb_samples);
-
-    if (converted < 0) {
-      char errbuf[256];
-      av_strerror(converted, errbuf, sizeof(errbuf));
-      error_callback_.Call(
-          {Napi::Error::New(env,
-                            std::string("Audio conversion error: ") + errbuf)
-               .Value()});
-      av_frame_unref(frame_.get());
-      continue;
+    if (queue_limits_.policy == webcodecs::QueuePolicy::kReject) {
+      Napi::Error::New(env,
+                       "QuotaExceededError: Decode queue is full. You must "
+                       "handle backpressure by waiting for decodeQueueSize "
+                       "to decrease.")
+          .ThrowAsJavaScriptException();
+      return false;
     }
-
-    // Calculate timestamp in microseconds.
-    int64_t timestamp = 0;
-    if (frame_->pts != AV_NOPTS_VALUE) {
-      // Convert from time_base to microseconds.
-      AVRational time_base = codec_context_->time_base;
-      if (time_base.num == 0) {
-        time_base = AVRational{1, frame_->sample_rate};
+    bool run_open = false;
+    size_t count = control_queue_->DropOldestDeltaRun(&run_open).size();
+    if (count == 0) {
+      // Only key chunks, in-flight packets or control messages fill the
+      // limit. Drop this chunk instead, or refuse a key chunk.
+      if (is_key_frame) {
+        Napi::Error::New(env,
+                         "QuotaExceededError: Decode queue is full and holds "
+                         "no delta chunks to drop. Wait for decodeQueueSize "
+                         "to decrease.")
+            .ThrowAsJavaScriptException();
+        return false;
       }
-      timestamp = av_rescale_q(frame_->pts, time_base, AVRational{1, 1000000});
+      drop_until_key_ = true;  // Later deltas depend on this one
+      *dropped_out = dropped + 1;
+      return true;
     }
+    dropped += static_cast<int>(count);
+    drop_until_key_ = drop_until_key_ || run_open;
+  }
+  if (drop_until_key_ && !is_key_frame) {
+    // The packet it depends on was dropped.
+    *dropped_out = dropped + 1;
+    return true;
+  }
+  if (is_key_frame) {
+    drop_until_key_ = false;
+  }
+
+  *dropped_out = dropped;
+  webcodecs::AudioControlQueue::DecodeMessage decode_msg;
+  decode_msg.packet = std::move(packet);
+  if (staged) {
+    staged->Add(std::move(decode_msg));
+    return true;
+  }
+  if (!control_queue_->Enqueue(std::move(decode_msg))) {
+    Napi::Error::New(env, "Failed to enqueue decode message")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
+}
 
-    // Create AudioData instance.
-    Napi::Object audio_data = AudioData::CreateInstance(
-        env, "f32", static_cast<uint32_t>(frame_->sample_rate),
-        static_cast<uint32_t>(converted), static_cast<uint32_t>(nb_channels),
-        timestamp, output_data.data(),
-        converted * nb_channels * kBytesPerSampleF32);
+bool AudioDecoder::QueueFull(size_t incoming_bytes,
+                             const Staged* staged) const {
+  size_t queued = control_queue_->size() + (staged ? staged->size() : 0);
+  if (queue_limits_.max_size > 0 && queued >= queue_limits_.max_size) {
+    return true;
+  }
+  // An empty queue always takes one request, however large.
+  size_t queued_bytes = control_queue_->bytes() + (staged ? staged->bytes : 0);
+  return queue_limits_.max_bytes > 0 && queued_bytes > 0 &&
+         queued_bytes + incoming_bytes > queue_limits_.max_bytes;
+}
 
-    // Call output callback.
-    output_callback_.Call({audio_data});
+Napi::Value AudioDecoder::Flush(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-    // Decrement queue size after audio data is emitted
-    if (decode_queue_size_ > 0) {
-      decode_queue_size_--;
-    }
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
 
-    av_frame_unref(frame_.get());
+  if (state_ != "configured" || !control_queue_) {
+    // Return resolved promise if not configured.
+    deferred.Resolve(env.Undefined());
+    return deferred.Promise();
+  }
+
+  uint32_t promise_id = next_promise_id_++;
+
+  webcodecs::AudioControlQueue::FlushMessage flush_msg;
+  flush_msg.promise_id = promise_id;
+  if (!control_queue_->Enqueue(std::move(flush_msg))) {
+    deferred.Reject(
+        Napi::Error::New(env, "Failed to enqueue flush message").Value());
+    return deferred.Promise();
   }
+
+  // Resolved by OnFlushCallback once the worker has drained the decoder
+  Napi::Promise promise = deferred.Promise();
+  pending_flushes_.emplace(promise_id, std::move(deferred));
+  return promise;
 }
 
 Napi::Value AudioDecoder::IsConfigSupported(const Napi::CallbackInfo& info) {
@@ -491,27 +735,27 @@ Napi::Value AudioDecoder::IsConfigSupported(const Napi::CallbackInfo& info) {
     normalized_config.Set("codec", codec);
 
     if (codec == "opus") {
-      const AVCodec* c = avcodec_find_decoder(AV_CODEC_ID_OPUS);
+      const AVCodec* c = webcodecs::FindDecoder(AV_CODEC_ID_OPUS);
       if (!c) {
         supported = false;
       }
     } else if (codec.find("mp4a.40") == 0) {
-      const AVCodec* c = avcodec_find_decoder(AV_CODEC_ID_AAC);
+      const AVCodec* c = webcodecs::FindDecoder(AV_CODEC_ID_AAC);
       if (!c) {
         supported = false;
       }
     } else if (codec == "mp3") {
-      const AVCodec* c = avcodec_find_decoder(AV_CODEC_ID_MP3);
+      const AVCodec* c = webcodecs::FindDecoder(AV_CODEC_ID_MP3);
       if (!c) {
         supported = false;
       }
     } else if (codec == "flac") {
-      const AVCodec* c = avcodec_find_decoder(AV_CODEC_ID_FLAC);
+      const AVCodec* c = webcodecs::FindDecoder(AV_CODEC_ID_FLAC);
       if (!c) {
         supported = false;
       }
     } else if (codec == "vorbis") {
-      const AVCodec* c = avcodec_find_decoder(AV_CODEC_ID_VORBIS);
+      const AVCodec* c = webcodecs::FindDecoder(AV_CODEC_ID_VORBIS);
       if (!c) {
         supported = false;
       }
@@ -531,6 +775,43 @@ Napi::Value AudioDecoder::IsConfigSupported(const Napi::CallbackInfo& info) {
     normalized_config.Set("description", config.Get("description"));
   }
 
+  // Copy threading (node-webcodecs extension).
+  webcodecs::CodecThreadingConfig threading;
+  std::string threading_error;
+  if (!webcodecs::ParseThreadingConfig(config, &threading, &threading_error)) {
+    supported = false;
+  } else if (threading.specified) {
+    normalized_config.Set("threading",
+                          webcodecs::ThreadingConfigToObject(env, threading));
+  }
+
+  // Copy output batching (node-webcodecs extension).
+  int output_batch_size = 1;
+  std::string batch_error;
+  if (!webcodecs::ParseOutputBatchSize(config, &output_batch_size,
+                                       &batch_error)) {
+    supported = false;
+  } else if (webcodecs::HasAttr(config, "outputBatchSize")) {
+    normalized_config.Set("outputBatchSize", output_batch_size);
+  }
+
+  // Copy queue limits (node-webcodecs extension).
+  if (!webcodecs::CopyQueueLimits(config, normalized_config)) {
+    supported = false;
+  }
+
+  // Copy analysis (node-webcodecs extension).
+  webcodecs::AudioDecoderConfig analysis_config;
+  std::string analysis_error;
+  if (!ParseAnalysisConfig(config, &analysis_config, &analysis_error)) {
+    supported = false;
+  } else if (analysis_config.analyze) {
+    Napi::Object analysis = Napi::Object::New(env);
+    analysis.Set("truePeak", analysis_config.analyze_true_peak);
+    analysis.Set("output", analysis_config.output_audio);
+    normalized_config.Set("analysis", analysis);
+  }
+
   result.Set("supported", supported);
   result.Set("config", normalized_config);
 
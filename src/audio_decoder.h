@@ -11,10 +11,21 @@ extern "C" {
 
 #include <napi.h>
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
 
+#include "src/audio_decoder_worker.h"
+#include "src/common.h"
 #include "src/ffmpeg_raii.h"
+#include "src/shared/control_message_queue.h"
+#include "src/shared/batched_tsfn.h"
+#include "src/shared/codec_reaper.h"
+#include "src/shared/codec_stats.h"
+#include "src/shared/dequeue_notifier.h"
+#include "src/shared/safe_tsfn.h"
 
 class AudioDecoder : public Napi::ObjectWrap<AudioDecoder> {
  public:
@@ -30,38 +41,112 @@ class AudioDecoder : public Napi::ObjectWrap<AudioDecoder> {
   // WebCodecs API methods.
   Napi::Value Configure(const Napi::CallbackInfo& info);
   Napi::Value Decode(const Napi::CallbackInfo& info);
+  Napi::Value DecodeBatch(const Napi::CallbackInfo& info);
   Napi::Value Flush(const Napi::CallbackInfo& info);
   Napi::Value Reset(const Napi::CallbackInfo& info);
   void Close(const Napi::CallbackInfo& info);
   Napi::Value GetState(const Napi::CallbackInfo& info);
   Napi::Value GetDecodeQueueSize(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+  void ResetStats(const Napi::CallbackInfo& info);
+  Napi::Value GetAnalysis(const Napi::CallbackInfo& info);
 
   // Static methods.
   static Napi::Value IsConfigSupported(const Napi::CallbackInfo& info);
 
   // Internal helpers.
   void Cleanup();
-  void EmitAudioData(Napi::Env env);
+  // Cut off the worker's output and hand it to the CodecReaper, which
+  // waits out its current message and frees the codec off the event loop.
+  void RetireWorker();
+  void SetupWorkerCallbacks(Napi::Env env);
+  using Staged = webcodecs::StagedMessages<webcodecs::AudioControlQueue>;
+  // Queue |chunk|, or add it to |staged| when given, and set |dropped| to
+  // how many decode requests were dropped (including this one), or -1 when
+  // the 'block' policy found the queue full. Returns false with a pending
+  // JS exception on failure.
+  bool DecodeChunk(Napi::Env env, Napi::Object chunk, Staged* staged,
+                   int* dropped);
+  bool EnqueueStaged(Napi::Env env, Staged* staged);
+  // True when one more decode request of |incoming_bytes|, after the
+  // |staged| ones, breaks the queue limits.
+  bool QueueFull(size_t incoming_bytes,
+                 const Staged* staged = nullptr) const;
 
-  // FFmpeg state.
-  const AVCodec*
-      codec_;  // Not owned - references FFmpeg's static codec descriptor
-  ffmpeg::AVCodecContextPtr codec_context_;
-  ffmpeg::SwrContextPtr swr_context_;
-  ffmpeg::AVFramePtr frame_;
-  ffmpeg::AVPacketPtr packet_;
+  // TSFN callback data types
+  struct FrameCallbackData {
+    ffmpeg::AVFramePtr frame;  // pts in microseconds
+  };
+
+  struct FlushCallbackData {
+    uint32_t promise_id;
+    bool success;
+    std::string error_message;
+    AudioDecoder* decoder;
+  };
+
+  struct ErrorCallbackData {
+    int error_code;
+    std::string message;
+  };
+
+  // TSFN callback handlers
+  static void OnFrameCallback(Napi::Env env, Napi::Function fn,
+                              std::nullptr_t*, FrameCallbackData* data);
+  static void OnFlushCallback(Napi::Env env, Napi::Function fn,
+                              std::nullptr_t*, FlushCallbackData* data);
+  static void OnErrorCallback(Napi::Env env, Napi::Function fn,
+                              std::nullptr_t*, ErrorCallbackData* data);
 
   // Callbacks.
   Napi::FunctionReference output_callback_;
   Napi::FunctionReference error_callback_;
+  Napi::FunctionReference dequeue_callback_;  // Optional
 
   // State.
   std::string state_;
   uint32_t sample_rate_;
   uint32_t number_of_channels_;
 
-  // Queue tracking for W3C WebCodecs spec compliance
-  int decode_queue_size_ = 0;
+  // maxQueueSize/maxQueueBytes/queuePolicy; unbounded by default.
+  webcodecs::QueueLimits queue_limits_;
+  // Per-instance pipeline stats; shared with the worker and output TSFN and
+  // kept across reconfigure.
+  std::shared_ptr<webcodecs::CodecStats> stats_ =
+      std::make_shared<webcodecs::CodecStats>("AudioDecoder");
+  // Set after 'drop-oldest-delta' dropped packets later deltas depend on;
+  // incoming delta chunks are dropped until the next key chunk.
+  bool drop_until_key_ = false;
+  // Loudness measurements when configured with `analysis`; kept after
+  // close() so they can be read once decoding is done.
+  std::shared_ptr<webcodecs::AudioAnalysis> analysis_;
+
+  // Worker-owned codec model
+  std::unique_ptr<webcodecs::AudioControlQueue> control_queue_;
+  std::unique_ptr<webcodecs::AudioDecoderWorker> worker_;
+  // Guards worker_'s callbacks; closed when the worker is retired.
+  std::shared_ptr<webcodecs::OutputGate> output_gate_;
+
+  // ThreadSafeFunctions for async callbacks
+  using FrameTSFN =
+      webcodecs::BatchedThreadSafeFunction<std::nullptr_t, FrameCallbackData,
+                                           OnFrameCallback>;
+  using FlushTSFN =
+      webcodecs::SafeThreadSafeFunction<std::nullptr_t, FlushCallbackData,
+                                        OnFlushCallback>;
+  using ErrorTSFN =
+      webcodecs::SafeThreadSafeFunction<std::nullptr_t, ErrorCallbackData,
+                                        OnErrorCallback>;
+
+  FrameTSFN frame_tsfn_;
+  FlushTSFN flush_tsfn_;
+  ErrorTSFN error_tsfn_;
+  // Retries of decode() calls parked by the 'block' policy.
+  webcodecs::DequeueNotifier dequeue_notifier_;
+
+  // Promise management for flush
+  uint32_t next_promise_id_ = 0;
+  std::unordered_map<uint32_t, Napi::Promise::Deferred> pending_flushes_;
 };
 
 #endif  // SRC_AUDIO_DECODER_H_
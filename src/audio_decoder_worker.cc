@@ -0,0 +1,343 @@
+// Copyright 2025 node-webcodecs contributors. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// AudioDecoderWorker implementation.
+
+#include "src/audio_decoder_worker.h"
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+#include "src/common.h"
+
+namespace webcodecs {
+
+AudioDecoderWorker::AudioDecoderWorker(AudioWorkerQueue* queue)
+    : CodecWorker<AudioWorkerQueue>(queue) {}
+
+AudioDecoderWorker::~AudioDecoderWorker() {
+  // Ensure the worker thread exits before our resources are destroyed
+  Stop();
+}
+
+void AudioDecoderWorker::SetConfig(const AudioDecoderConfig& config) {
+  config_ = config;
+}
+
+void AudioDecoderWorker::SetAnalysis(
+    std::shared_ptr<AudioAnalysis> analysis) {
+  analysis_ = std::move(analysis);
+}
+
+bool AudioDecoderWorker::OnConfigure(const ConfigureMessage& msg) {
+  if (msg.configure_fn && !msg.configure_fn()) {
+    return false;
+  }
+
+  codec_ = FindDecoder(config_.codec_id);
+  if (!codec_) {
+    OutputError(AVERROR_DECODER_NOT_FOUND, "Decoder not found for codec");
+    return false;
+  }
+
+  codec_context_ = ffmpeg::make_codec_context(codec_);
+  if (!codec_context_) {
+    OutputError(AVERROR(ENOMEM), "Could not allocate codec context");
+    return false;
+  }
+
+  codec_context_->sample_rate = config_.sample_rate;
+  // Chunk timestamps are microseconds; frames come back in the same base.
+  codec_context_->pkt_timebase = AVRational{1, 1000000};
+  av_channel_layout_default(&codec_context_->ch_layout,
+                            config_.number_of_channels);
+
+  // Codec specific data (description)
+  if (!config_.extradata.empty()) {
+    size_t size = config_.extradata.size();
+    codec_context_->extradata = static_cast<uint8_t*>(
+        av_malloc(size + AV_INPUT_BUFFER_PADDING_SIZE));
+    if (codec_context_->extradata) {
+      std::memcpy(codec_context_->extradata, config_.extradata.data(), size);
+      std::memset(codec_context_->extradata + size, 0,
+                  AV_INPUT_BUFFER_PADDING_SIZE);
+      codec_context_->extradata_size = static_cast<int>(size);
+    }
+  }
+
+  ApplyThreadingConfig(codec_context_.get(), config_.threading);
+
+  int ret = avcodec_open2(codec_context_.get(), codec_, nullptr);
+  if (ret < 0) {
+    OutputError(ret, "Could not open decoder: " + FFmpegErrorString(ret));
+    codec_context_.reset();
+    return false;
+  }
+
+  frame_ = ffmpeg::make_frame();
+  if (!frame_) {
+    OutputError(AVERROR(ENOMEM), "Could not allocate frame");
+    codec_context_.reset();
+    return false;
+  }
+
+  codec_configured_.store(true, std::memory_order_release);
+  return true;
+}
+
+void AudioDecoderWorker::OnDecode(const DecodeMessage& msg) {
+  if (!codec_context_ || !codec_configured_.load(std::memory_order_acquire)) {
+    OutputError(AVERROR_INVALIDDATA, "Decoder not configured");
+    return;
+  }
+
+  AVPacket* pkt = msg.packet.get();
+  if (!pkt) {
+    OutputError(AVERROR_INVALIDDATA, "Invalid packet");
+    return;
+  }
+
+  int ret = avcodec_send_packet(codec_context_.get(), pkt);
+  if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+    OutputError(ret, "Decode error: " + FFmpegErrorString(ret));
+    return;
+  }
+
+  ret = DrainFrames();
+  if (ret < 0) {
+    OutputError(ret, "Decode receive error: " + FFmpegErrorString(ret));
+  }
+
+  SignalDequeue(static_cast<uint32_t>(queue()->size()));
+}
+
+void AudioDecoderWorker::OnFlush(const FlushMessage& msg) {
+  if (!codec_context_ || !codec_configured_.load(std::memory_order_acquire)) {
+    FlushComplete(msg.promise_id, true);
+    return;
+  }
+
+  int ret = avcodec_send_packet(codec_context_.get(), nullptr);
+  if (ret < 0 && ret != AVERROR_EOF) {
+    FlushComplete(msg.promise_id, false,
+                  "Flush error: " + FFmpegErrorString(ret));
+    return;
+  }
+
+  ret = DrainFrames();
+  if (ret < 0) {
+    FlushComplete(msg.promise_id, false,
+                  "Flush receive error: " + FFmpegErrorString(ret));
+    return;
+  }
+
+  // Leave drain mode so the decoder accepts further packets.
+  avcodec_flush_buffers(codec_context_.get());
+
+  FlushComplete(msg.promise_id, true);
+}
+
+void AudioDecoderWorker::OnReset() {
+  queue()->DiscardPending();
+
+  if (codec_context_ && codec_configured_.load(std::memory_order_acquire) &&
+      avcodec_is_open(codec_context_.get())) {
+    avcodec_flush_buffers(codec_context_.get());
+  }
+
+  // Drop resampler history; recreated on the next frame.
+  swr_context_.reset();
+  swr_in_format_ = AV_SAMPLE_FMT_NONE;
+}
+
+void AudioDecoderWorker::OnClose() {
+  codec_configured_.store(false, std::memory_order_release);
+
+  // Flush before destroying: decoders may hold queued frames.
+  if (codec_context_ && avcodec_is_open(codec_context_.get())) {
+    avcodec_flush_buffers(codec_context_.get());
+  }
+
+  frame_.reset();
+  swr_context_.reset();
+  codec_context_.reset();
+  codec_ = nullptr;
+}
+
+int AudioDecoderWorker::DrainFrames() {
+  while (true) {
+    int ret = avcodec_receive_frame(codec_context_.get(), frame_.get());
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+      return 0;
+    }
+    if (ret < 0) {
+      return ret;
+    }
+    EmitFrame();
+    av_frame_unref(frame_.get());
+  }
+}
+
+bool AudioDecoderWorker::EnsureSwrContext() {
+  AVSampleFormat in_format = static_cast<AVSampleFormat>(frame_->format);
+  int channels = frame_->ch_layout.nb_channels;
+  if (swr_context_ && swr_in_format_ == in_format &&
+      swr_in_rate_ == frame_->sample_rate && swr_in_channels_ == channels) {
+    return true;
+  }
+
+  // Decoder's format -> f32 in the same arrangement, rate and channel count.
+  AVSampleFormat out_format = av_sample_fmt_is_planar(in_format)
+                                  ? AV_SAMPLE_FMT_FLTP
+                                  : AV_SAMPLE_FMT_FLT;
+  AVChannelLayout out_layout;
+  av_channel_layout_default(&out_layout, channels);
+
+  SwrContext* swr = nullptr;
+  int ret = swr_alloc_set_opts2(&swr, &out_layout, out_format,
+                                frame_->sample_rate, &frame_->ch_layout,
+                                in_format, frame_->sample_rate, 0, nullptr);
+  av_channel_layout_uninit(&out_layout);
+  swr_context_.reset(swr);
+  if (ret >= 0) {
+    ret = swr_init(swr_context_.get());
+  }
+  if (ret < 0) {
+    OutputError(ret, "Could not init resampler: " + FFmpegErrorString(ret));
+    swr_context_.reset();
+    return false;
+  }
+
+  swr_in_format_ = in_format;
+  swr_in_rate_ = frame_->sample_rate;
+  swr_in_channels_ = channels;
+  return true;
+}
+
+void AudioDecoderWorker::EmitFrame() {
+  ffmpeg::AVFramePtr out;
+  switch (frame_->format) {
+    case AV_SAMPLE_FMT_U8:
+    case AV_SAMPLE_FMT_S16:
+    case AV_SAMPLE_FMT_S32:
+    case AV_SAMPLE_FMT_FLT:
+    case AV_SAMPLE_FMT_U8P:
+    case AV_SAMPLE_FMT_S16P:
+    case AV_SAMPLE_FMT_S32P:
+    case AV_SAMPLE_FMT_FLTP:
+      // A WebCodecs sample format: share the decoder's planes.
+      out.reset(av_frame_clone(frame_.get()));
+      if (!out) {
+        OutputError(AVERROR(ENOMEM), "Could not reference output frame");
+        return;
+      }
+      break;
+    default: {
+      if (!EnsureSwrContext()) {
+        return;
+      }
+      out = ffmpeg::make_frame();
+      if (!out) {
+        OutputError(AVERROR(ENOMEM), "Could not allocate output frame");
+        return;
+      }
+      out->format = av_sample_fmt_is_planar(
+                        static_cast<AVSampleFormat>(frame_->format))
+                        ? AV_SAMPLE_FMT_FLTP
+                        : AV_SAMPLE_FMT_FLT;
+      out->sample_rate = frame_->sample_rate;
+      out->nb_samples = frame_->nb_samples;
+      av_channel_layout_default(&out->ch_layout,
+                                frame_->ch_layout.nb_channels);
+      int ret = av_frame_get_buffer(out.get(), 0);
+      if (ret < 0) {
+        OutputError(ret, "Could not allocate output frame");
+        return;
+      }
+
+      int converted;
+      {
+        StageTimer timer(stats(), CodecStats::Stage::kConvert);
+        converted = swr_convert(
+            swr_context_.get(), out->extended_data, out->nb_samples,
+            const_cast<const uint8_t**>(frame_->extended_data),
+            frame_->nb_samples);
+      }
+      if (converted < 0) {
+        OutputError(converted,
+                    "Audio conversion error: " + FFmpegErrorString(converted));
+        return;
+      }
+      out->nb_samples = converted;
+      break;
+    }
+  }
+
+  if (analysis_) {
+    Analyze(out.get());
+    if (!config_.output_audio) {
+      return;
+    }
+  }
+
+  // Timestamp in microseconds (pkt_timebase).
+  out->pts = frame_->pts != AV_NOPTS_VALUE ? frame_->pts : 0;
+
+  OutputFrame(std::move(out));
+}
+
+void AudioDecoderWorker::Analyze(const AVFrame* frame) {
+  LoudnessMeter::SampleFormat format;
+  switch (av_get_packed_sample_fmt(
+      static_cast<AVSampleFormat>(frame->format))) {
+    case AV_SAMPLE_FMT_U8:
+      format = LoudnessMeter::SampleFormat::kU8;
+      break;
+    case AV_SAMPLE_FMT_S16:
+      format = LoudnessMeter::SampleFormat::kS16;
+      break;
+    case AV_SAMPLE_FMT_S32:
+      format = LoudnessMeter::SampleFormat::kS32;
+      break;
+    default:  // EmitFrame() leaves nothing else but f32
+      format = LoudnessMeter::SampleFormat::kF32;
+      break;
+  }
+
+  std::lock_guard<std::mutex> lock(analysis_->mutex);
+  LoudnessMeter& meter = analysis_->meter;
+  int channels = frame->ch_layout.nb_channels;
+  if (meter.sample_rate() != frame->sample_rate ||
+      meter.channels() != channels) {
+    // BS.1770 channel weights: LFE is left out, surrounds count 1.41x.
+    std::vector<double> weights(channels, 1.0);
+    for (int i = 0; i < channels; ++i) {
+      switch (av_channel_layout_channel_from_index(&frame_->ch_layout, i)) {
+        case AV_CHAN_LOW_FREQUENCY:
+        case AV_CHAN_LOW_FREQUENCY_2:
+          weights[i] = 0.0;
+          break;
+        case AV_CHAN_SIDE_LEFT:
+        case AV_CHAN_SIDE_RIGHT:
+        case AV_CHAN_BACK_LEFT:
+        case AV_CHAN_BACK_RIGHT:
+          weights[i] = 1.41;
+          break;
+        default:
+          break;
+      }
+    }
+    meter.Configure(frame->sample_rate, weights, config_.analyze_true_peak);
+  }
+  meter.AddSamples(frame->extended_data, format,
+                   av_sample_fmt_is_planar(
+                       static_cast<AVSampleFormat>(frame->format)),
+                   frame->nb_samples);
+}
+
+}  // namespace webcodecs
@@ -0,0 +1,137 @@
+// Copyright 2025 node-webcodecs contributors. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// AudioDecoderWorker - Worker-owned codec model for non-blocking audio
+// decoding.
+
+#ifndef SRC_AUDIO_DECODER_WORKER_H_
+#define SRC_AUDIO_DECODER_WORKER_H_
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+}
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "src/common.h"
+#include "src/ffmpeg_raii.h"
+#include "src/loudness_meter.h"
+#include "src/shared/codec_worker.h"
+#include "src/shared/control_message_queue.h"
+
+namespace webcodecs {
+
+/**
+ * Configuration for AudioDecoder.
+ * Passed to worker thread via SetConfig() before the ConfigureMessage.
+ */
+struct AudioDecoderConfig {
+  AVCodecID codec_id = AV_CODEC_ID_NONE;
+  int sample_rate = 48000;
+  int number_of_channels = 2;
+  std::vector<uint8_t> extradata;
+  CodecThreadingConfig threading;
+  // Measure loudness and levels of the decoded audio (analysis option).
+  bool analyze = false;
+  bool analyze_true_peak = true;
+  // Deliver AudioData; false when only the analysis is wanted.
+  bool output_audio = true;
+};
+
+/**
+ * Loudness measurements of one configured decoder. The worker feeds the
+ * meter as it decodes and the JS thread reads summaries, under |mutex|.
+ */
+struct AudioAnalysis {
+  std::mutex mutex;
+  LoudnessMeter meter;
+};
+
+/**
+ * Worker thread for AudioDecoder.
+ *
+ * Owns the AVCodecContext and SwrContext exclusively. Decoded frames keep
+ * the codec's own sample format (planar if the codec is planar) and are
+ * emitted through OutputFrame() as new references, with pts already rescaled
+ * to microseconds, so the JS thread wraps them in an AudioData without
+ * copying. Only formats WebCodecs cannot express (double, s64) are converted
+ * to f32.
+ */
+class AudioDecoderWorker : public CodecWorker<AudioWorkerQueue> {
+ public:
+  explicit AudioDecoderWorker(AudioWorkerQueue* queue);
+  ~AudioDecoderWorker() override;
+
+  // Non-copyable, non-movable
+  AudioDecoderWorker(const AudioDecoderWorker&) = delete;
+  AudioDecoderWorker& operator=(const AudioDecoderWorker&) = delete;
+  AudioDecoderWorker(AudioDecoderWorker&&) = delete;
+  AudioDecoderWorker& operator=(AudioDecoderWorker&&) = delete;
+
+  /**
+   * Set decoder configuration.
+   * Must be called before Start(), used by OnConfigure().
+   */
+  void SetConfig(const AudioDecoderConfig& config);
+
+  /**
+   * Meter to feed when config.analyze is set. Must be called before Start().
+   */
+  void SetAnalysis(std::shared_ptr<AudioAnalysis> analysis);
+
+ protected:
+  // CodecWorker virtual overrides
+  bool OnConfigure(const ConfigureMessage& msg) override;
+  void OnDecode(const DecodeMessage& msg) override;
+  void OnFlush(const FlushMessage& msg) override;
+  void OnReset() override;
+  void OnClose() override;
+
+ private:
+  /**
+   * Receive every ready frame and emit it.
+   *
+   * @return 0, or the negative AVERROR that stopped the loop
+   */
+  int DrainFrames();
+
+  /**
+   * Pass frame_ (converted to f32 if needed) to OutputFrame().
+   */
+  void EmitFrame();
+
+  /**
+   * Create or recreate swr_context_ for frame_'s layout, rate and format.
+   */
+  bool EnsureSwrContext();
+
+  /**
+   * Measure |frame|, with frame_'s channel layout, into analysis_.
+   */
+  void Analyze(const AVFrame* frame);
+
+  AudioDecoderConfig config_;
+  std::shared_ptr<AudioAnalysis> analysis_;
+
+  // FFmpeg resources (owned by worker thread)
+  const AVCodec* codec_ = nullptr;
+  ffmpeg::AVCodecContextPtr codec_context_;
+  ffmpeg::SwrContextPtr swr_context_;
+  ffmpeg::AVFramePtr frame_;
+
+  // Input parameters swr_context_ was built for
+  AVSampleFormat swr_in_format_ = AV_SAMPLE_FMT_NONE;
+  int swr_in_rate_ = 0;
+  int swr_in_channels_ = 0;
+
+  std::atomic<bool> codec_configured_{false};
+};
+
+}  // namespace webcodecs
+
+#endif  // SRC_AUDIO_DECODER_WORKER_H_
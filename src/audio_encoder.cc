@@ -3,13 +3,17 @@
 
 #include "src/audio_encoder.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/audio_data.h"
 #include "src/common.h"
 #include "src/encoded_audio_chunk.h"
+#include "src/muxer.h"
 
 Napi::Object InitAudioEncoder(Napi::Env env, Napi::Object exports) {
   return AudioEncoder::Init(env, exports);
@@ -21,6 +25,7 @@ Napi::Object AudioEncoder::Init(Napi::Env env, Napi::Object exports) {
       {
           InstanceMethod("configure", &AudioEncoder::Configure),
           InstanceMethod("encode", &AudioEncoder::Encode),
+          InstanceMethod("encodeBatch", &AudioEncoder::EncodeBatch),
           InstanceMethod("flush", &AudioEncoder::Flush),
           InstanceMethod("reset", &AudioEncoder::Reset),
           InstanceMethod("close", &AudioEncoder::Close),
@@ -29,6 +34,9 @@ Napi::Object AudioEncoder::Init(Napi::Env env, Napi::Object exports) {
                            nullptr),
           InstanceAccessor("codecSaturated", &AudioEncoder::GetCodecSaturated,
                            nullptr),
+          InstanceMethod("attachMuxer", &AudioEncoder::AttachMuxer),
+          InstanceMethod("getStats", &AudioEncoder::GetStats),
+          InstanceMethod("resetStats", &AudioEncoder::ResetStats),
           StaticMethod("isConfigSupported", &AudioEncoder::IsConfigSupported),
       });
 
@@ -38,11 +46,9 @@ Napi::Object AudioEncoder::Init(Napi::Env env, Napi::Object exports) {
 
 AudioEncoder::AudioEncoder(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<AudioEncoder>(info),
-      codec_(nullptr),
       state_("unconfigured"),
       sample_rate_(0),
       number_of_channels_(0),
-      timestamp_(0),
       frame_count_(0) {
   // Track active encoder instance
   webcodecs::counterAudioEncoders++;
@@ -63,11 +69,22 @@ AudioEncoder::AudioEncoder(const Napi::CallbackInfo& info)
 
   output_callback_ = Napi::Persistent(init.Get("output").As<Napi::Function>());
   error_callback_ = Napi::Persistent(init.Get("error").As<Napi::Function>());
+  if (webcodecs::HasAttr(init, "sinkProgress") &&
+      init.Get("sinkProgress").IsFunction()) {
+    sink_progress_callback_ =
+        Napi::Persistent(init.Get("sinkProgress").As<Napi::Function>());
+  }
+  // Runs when an encode() turned away by the 'block' policy may be retried.
+  if (webcodecs::HasAttr(init, "dequeue") &&
+      init.Get("dequeue").IsFunction()) {
+    dequeue_callback_ =
+        Napi::Persistent(init.Get("dequeue").As<Napi::Function>());
+  }
 }
 
 AudioEncoder::~AudioEncoder() {
-  // CRITICAL: Call Cleanup() first to ensure codec context is properly
-  // flushed before any further cleanup.
+  // CRITICAL: Call Cleanup() first so the worker thread is joined before
+  // any further cleanup.
   Cleanup();
 
   // Now safe to disable FFmpeg logging.
@@ -76,21 +93,123 @@ AudioEncoder::~AudioEncoder() {
   webcodecs::counterAudioEncoders--;
 }
 
+void AudioEncoder::RetireWorker() {
+  // No output reaches JS from here on, as if the worker had been joined.
+  if (output_gate_) {
+    output_gate_->Close();
+    output_gate_.reset();
+  }
+  if (worker_) {
+    // Cancels a write blocked on the muxer's full queue and waits for the
+    // one in progress, so the muxer may be released after this.
+    worker_->SetPacketSink(nullptr, -1);
+  }
+  // The worker exits after the frame in progress, on the reaper thread.
+  if (control_queue_) {
+    control_queue_->Shutdown();
+  }
+  webcodecs::CodecReaper::Instance().Retire(std::move(worker_),
+                                            std::move(control_queue_));
+
+  // Release TSFNs
+  output_tsfn_.Release();
+  error_tsfn_.Release();
+  flush_tsfn_.Release();
+  dequeue_notifier_.Release();
+}
+
 void AudioEncoder::Cleanup() {
-  // Flush codec internal buffers BEFORE destroying resources.
-  // Audio codecs (opus, aac, mp3) may have internal queued samples. Flushing
-  // ensures they're drained before context destruction.
-  // CRITICAL: Only flush if codec was successfully opened. avcodec_flush_buffers
-  // crashes on an unopened codec context (the internal codec pointer is NULL).
-  if (codec_context_ && avcodec_is_open(codec_context_.get())) {
-    avcodec_flush_buffers(codec_context_.get());
-  }
-
-  frame_.reset();
-  packet_.reset();
-  swr_context_.reset();
-  codec_context_.reset();
-  codec_ = nullptr;
+  // Mark as not alive immediately to prevent callbacks from accessing members
+  alive_.store(false, std::memory_order_release);
+
+  RetireWorker();
+
+  // No worker can reach the muxer any more.
+  sink_ = nullptr;
+  sink_ref_.Reset();
+
+  // Orphan pending flush promises; there may be no valid env to reject in.
+  std::lock_guard<std::mutex> lock(flush_promise_mutex_);
+  pending_flush_promises_.clear();
+}
+
+// TSFN callback for output packets
+void AudioEncoder::OnOutputTSFN(Napi::Env env, Napi::Function fn,
+                                AudioEncoder* ctx,
+                                webcodecs::EncodedAudioPacketData* data) {
+  data->pending->fetch_sub(1);
+  if (env == nullptr) {
+    delete data;
+    return;
+  }
+
+  if (data->sink_progress) {
+    // Packets went to a muxer natively; only report how many.
+    int count = data->sink_progress->exchange(0);
+    delete data;
+    ctx->encode_queue_size_ = std::max(0, ctx->encode_queue_size_ - count);
+    ctx->codec_saturated_.store(ctx->encode_queue_size_ >=
+                                static_cast<int>(kMaxQueueSize));
+    if (!ctx->sink_progress_callback_.IsEmpty()) {
+      ctx->sink_progress_callback_.Call({Napi::Number::New(env, count)});
+    }
+    return;
+  }
+
+  ctx->stats_->AddBytesCopied(data->data.size());
+  Napi::Object chunk = EncodedAudioChunk::CreateInstance(
+      env,
+      "key",  // Audio chunks are typically all key frames.
+      data->timestamp, data->duration, data->data.data(), data->data.size());
+  delete data;
+
+  // Decrement queue size as chunks are emitted
+  if (ctx->encode_queue_size_ > 0) {
+    ctx->encode_queue_size_--;
+    bool saturated =
+        ctx->encode_queue_size_ >= static_cast<int>(kMaxQueueSize);
+    ctx->codec_saturated_.store(saturated);
+  }
+
+  fn.Call({chunk});
+}
+
+// TSFN callback for errors
+void AudioEncoder::OnErrorTSFN(Napi::Env env, Napi::Function fn,
+                               AudioEncoder* /* ctx */,
+                               webcodecs::ErrorOutputData* data) {
+  if (env == nullptr) {
+    delete data;
+    return;
+  }
+
+  fn.Call({Napi::Error::New(env, data->message).Value()});
+  delete data;
+}
+
+// TSFN callback for flush completion
+void AudioEncoder::OnFlushTSFN(Napi::Env env, Napi::Function /* fn */,
+                               AudioEncoder* ctx,
+                               webcodecs::FlushCompleteData* data) {
+  if (env == nullptr) {
+    delete data;
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(ctx->flush_promise_mutex_);
+    auto it = ctx->pending_flush_promises_.find(data->promise_id);
+    if (it != ctx->pending_flush_promises_.end()) {
+      if (data->success) {
+        it->second.Resolve(env.Undefined());
+      } else {
+        it->second.Reject(Napi::Error::New(env, data->error_message).Value());
+      }
+      ctx->pending_flush_promises_.erase(it);
+    }
+  }
+
+  delete data;
 }
 
 Napi::Value AudioEncoder::Configure(const Napi::CallbackInfo& info) {
@@ -123,189 +242,183 @@ Napi::Value AudioEncoder::Configure(const Napi::CallbackInfo& info) {
     codec_id = AV_CODEC_ID_VORBIS;
   }
 
-  // Find encoder.
-  const AVCodec* encoder = avcodec_find_encoder(codec_id);
-  if (!encoder) {
+  // Check the encoder exists up front so NotSupportedError stays synchronous.
+  if (!webcodecs::FindEncoder(codec_id)) {
     throw Napi::Error::New(env,
                            "NotSupportedError: Encoder not found for codec");
   }
 
-  // Clean up any previous context.
-  Cleanup();
+  // Tear down any previous worker.
+  RetireWorker();
 
-  // Store the found encoder.
-  codec_ = encoder;
-  codec_context_ = ffmpeg::make_codec_context(codec_);
-  if (!codec_context_) {
-    throw Napi::Error::New(env, "Could not allocate codec context");
-  }
+  webcodecs::AudioEncoderConfig encoder_config;
+  encoder_config.codec_id = codec_id;
 
-  // Parse sample rate.
   sample_rate_ = static_cast<uint32_t>(
       webcodecs::AttrAsInt32(config, "sampleRate", 48000));
-  codec_context_->sample_rate = sample_rate_;
-
-  // Parse number of channels.
   number_of_channels_ = static_cast<uint32_t>(
       webcodecs::AttrAsInt32(config, "numberOfChannels", 2));
-
-  // Set channel layout based on number of channels.
-  if (number_of_channels_ == 1) {
-    av_channel_layout_default(&codec_context_->ch_layout, 1);
-  } else {
-    av_channel_layout_default(&codec_context_->ch_layout, 2);
-  }
-
-  // Parse bitrate.
-  codec_context_->bit_rate = webcodecs::AttrAsInt64(config, "bitrate", 128000);
-
-  // Set sample format based on codec.
-  // Different codecs require different sample formats:
-  // - Opus: non-planar float (flt)
-  // - AAC/Vorbis: planar float (fltp)
-  // - MP3: planar signed 16-bit (s16p) or planar float (fltp)
-  // - FLAC: signed 16-bit (s16) or signed 32-bit (s32)
-  if (codec_id == AV_CODEC_ID_OPUS) {
-    codec_context_->sample_fmt = AV_SAMPLE_FMT_FLT;
-  } else if (codec_id == AV_CODEC_ID_FLAC) {
-    codec_context_->sample_fmt = AV_SAMPLE_FMT_S16;
-  } else if (codec_id == AV_CODEC_ID_MP3) {
-    codec_context_->sample_fmt = AV_SAMPLE_FMT_S16P;
-  } else {
-    // AAC and Vorbis use planar float
-    codec_context_->sample_fmt = AV_SAMPLE_FMT_FLTP;
-  }
-
-  // Time base.
-  codec_context_->time_base = AVRational{1, static_cast<int>(sample_rate_)};
+  encoder_config.sample_rate = static_cast<int>(sample_rate_);
+  encoder_config.number_of_channels = static_cast<int>(number_of_channels_);
+  encoder_config.bitrate = webcodecs::AttrAsInt64(config, "bitrate", 128000);
 
   // Parse Opus-specific options per W3C WebCodecs spec.
   if (codec_id == AV_CODEC_ID_OPUS && webcodecs::HasAttr(config, "opus")) {
     Napi::Object opus_config = config.Get("opus").As<Napi::Object>();
 
-    // Parse 'application': 'audio' | 'lowdelay' | 'voip'
-    // Maps to libopus "application" option.
+    // 'application': 'audio' | 'lowdelay' | 'voip'
     if (webcodecs::HasAttr(opus_config, "application")) {
       std::string app = webcodecs::AttrAsStr(opus_config, "application");
-      if (app == "voip") {
-        av_opt_set(codec_context_->priv_data, "application", "voip", 0);
-      } else if (app == "lowdelay") {
-        av_opt_set(codec_context_->priv_data, "application", "lowdelay", 0);
+      if (app == "voip" || app == "lowdelay") {
+        encoder_config.opus_application = app;
       } else {
         // Default to "audio" for music/general audio.
-        av_opt_set(codec_context_->priv_data, "application", "audio", 0);
+        encoder_config.opus_application = "audio";
       }
     }
 
-    // Parse 'complexity': 0-10.
-    // Maps to libopus "compression_level" option.
+    // 'complexity': 0-10, maps to libopus "compression_level".
     if (webcodecs::HasAttr(opus_config, "complexity")) {
       int complexity = webcodecs::AttrAsInt32(opus_config, "complexity");
-      // Clamp to valid range 0-10.
       if (complexity < 0) complexity = 0;
       if (complexity > 10) complexity = 10;
-      av_opt_set_int(codec_context_->priv_data, "compression_level", complexity,
-                     0);
+      encoder_config.opus_complexity = complexity;
     }
 
-    // Parse 'frameDuration': microseconds.
-    // Maps to libopus "frame_duration" option (in milliseconds).
+    // 'frameDuration': microseconds.
     if (webcodecs::HasAttr(opus_config, "frameDuration")) {
-      int64_t frame_duration_us =
+      encoder_config.opus_frame_duration_us =
           webcodecs::AttrAsInt64(opus_config, "frameDuration");
-      // Convert microseconds to milliseconds.
-      double frame_duration_ms = frame_duration_us / 1000.0;
-      av_opt_set_double(codec_context_->priv_data, "frame_duration",
-                        frame_duration_ms, 0);
     }
 
-    // Parse 'signal': 'auto' | 'music' | 'voice'.
-    // Maps to libopus "mapping_family" indirectly; not directly supported
-    // by FFmpeg's libopus wrapper. We skip this as it's not available.
+    // 'signal' has no equivalent in FFmpeg's libopus wrapper; skipped.
 
-    // Parse 'usedtx': boolean.
-    // Maps to libopus "dtx" option (discontinuous transmission).
+    // 'usedtx': discontinuous transmission.
     if (webcodecs::HasAttr(opus_config, "usedtx")) {
-      bool use_dtx = webcodecs::AttrAsBool(opus_config, "usedtx", false);
-      av_opt_set_int(codec_context_->priv_data, "dtx", use_dtx ? 1 : 0, 0);
+      encoder_config.opus_usedtx =
+          webcodecs::AttrAsBool(opus_config, "usedtx", false) ? 1 : 0;
     }
 
-    // Parse 'useinbandfec': boolean.
-    // Maps to libopus "fec" option (forward error correction).
+    // 'useinbandfec': forward error correction.
     if (webcodecs::HasAttr(opus_config, "useinbandfec")) {
-      bool use_fec = webcodecs::AttrAsBool(opus_config, "useinbandfec", false);
-      av_opt_set_int(codec_context_->priv_data, "fec", use_fec ? 1 : 0, 0);
+      encoder_config.opus_useinbandfec =
+          webcodecs::AttrAsBool(opus_config, "useinbandfec", false) ? 1 : 0;
     }
 
-    // Parse 'packetlossperc': 0-100.
-    // Maps to libopus "packet_loss" option.
+    // 'packetlossperc': 0-100.
     if (webcodecs::HasAttr(opus_config, "packetlossperc")) {
       int packet_loss = webcodecs::AttrAsInt32(opus_config, "packetlossperc");
-      // Clamp to valid range 0-100.
       if (packet_loss < 0) packet_loss = 0;
       if (packet_loss > 100) packet_loss = 100;
-      av_opt_set_int(codec_context_->priv_data, "packet_loss", packet_loss, 0);
+      encoder_config.opus_packet_loss = packet_loss;
     }
   }
 
-  // Open codec.
-  int ret = avcodec_open2(codec_context_.get(), codec_, nullptr);
-  if (ret < 0) {
-    char errbuf[256];
-    av_strerror(ret, errbuf, sizeof(errbuf));
-    Cleanup();
-    throw Napi::Error::New(env, std::string("Could not open codec: ") + errbuf);
-  }
-
-  // Allocate frame and packet.
-  frame_ = ffmpeg::make_frame();
-  packet_ = ffmpeg::make_packet();
-
-  if (!frame_ || !packet_) {
-    Cleanup();
-    throw Napi::Error::New(env, "Could not allocate frame/packet");
-  }
-
-  // Set up frame parameters.
-  frame_->nb_samples = codec_context_->frame_size;
-  frame_->format = codec_context_->sample_fmt;
-  av_channel_layout_copy(&frame_->ch_layout, &codec_context_->ch_layout);
+  // Parse threading (node-webcodecs extension).
+  std::string threading_error;
+  if (!webcodecs::ParseThreadingConfig(config, &encoder_config.threading,
+                                       &threading_error)) {
+    throw Napi::TypeError::New(env, threading_error);
+  }
+
+  // Parse output batching (node-webcodecs extension).
+  int output_batch_size = 1;
+  std::string batch_error;
+  if (!webcodecs::ParseOutputBatchSize(config, &output_batch_size,
+                                       &batch_error)) {
+    throw Napi::TypeError::New(env, batch_error);
+  }
+
+  // Parse queue limits (node-webcodecs extension).
+  webcodecs::QueueLimits queue_limits;
+  std::string limits_error;
+  if (!webcodecs::ParseQueueLimits(config, &queue_limits, &limits_error)) {
+    throw Napi::TypeError::New(env, limits_error);
+  }
+  queue_limits_ = queue_limits;
+
+  // Create control queue and worker
+  alive_.store(true, std::memory_order_release);
+  control_queue_ = std::make_unique<webcodecs::AudioControlQueue>();
+  worker_ =
+      std::make_unique<webcodecs::AudioEncoderWorker>(control_queue_.get());
+  output_gate_ = webcodecs::OutputGate::Create();
+  webcodecs::OutputGate& gate = *output_gate_;
+
+  // Create ThreadSafeFunctions
+  auto output_tsfn = OutputTSFN::TSFN::New(
+      env, output_callback_.Value(), "AudioEncoderOutput", 0, 1, this);
+  output_tsfn_.Init(std::move(output_tsfn), output_batch_size, stats_.get());
+
+  auto error_tsfn = Napi::TypedThreadSafeFunction<
+      AudioEncoder, webcodecs::ErrorOutputData, OnErrorTSFN>::
+      New(env, error_callback_.Value(), "AudioEncoderError", 0, 1, this);
+  error_tsfn_.Init(error_tsfn);
+
+  // Create a dummy function for flush TSFN (we don't call it directly)
+  auto flush_fn = Napi::Function::New(env, [](const Napi::CallbackInfo&) {});
+  auto flush_tsfn = Napi::TypedThreadSafeFunction<
+      AudioEncoder, webcodecs::FlushCompleteData, OnFlushTSFN>::
+      New(env, flush_fn, "AudioEncoderFlush", 0, 1, this);
+  flush_tsfn_.Init(flush_tsfn);
+  dequeue_notifier_.Init(env, dequeue_callback_, "AudioEncoderDequeue");
+
+  // Worker callbacks are protected by output_gate_, closed before the
+  // worker is retired, by alive_, and by SafeThreadSafeFunction::Call()
+  // failing once the TSFN is released.
+  worker_->SetPacketOutputCallback(gate.Guard(
+      [this](std::unique_ptr<webcodecs::EncodedAudioPacketData> data) {
+        if (!alive_.load(std::memory_order_acquire)) {
+          data->pending->fetch_sub(1);
+          return;
+        }
+        webcodecs::EncodedAudioPacketData* raw_data = data.release();
+        if (!output_tsfn_.Call(raw_data)) {
+          raw_data->pending->fetch_sub(1);
+          delete raw_data;
+        }
+      }));
 
-  ret = av_frame_get_buffer(frame_.get(), 0);
-  if (ret < 0) {
-    Cleanup();
-    throw Napi::Error::New(env, "Could not allocate frame buffer");
+  if (sink_) {
+    worker_->SetPacketSink(sink_, sink_stream_index_);
   }
 
-  // Create resampler context for format conversion.
-  swr_context_.reset(swr_alloc());
-  if (!swr_context_) {
-    Cleanup();
-    throw Napi::Error::New(env, "Could not allocate resampler context");
-  }
+  worker_->SetOutputErrorCallback(
+      gate.Guard([this](int error_code, const std::string& message) {
+        if (!alive_.load(std::memory_order_acquire)) {
+          return;
+        }
+        auto* error_data =
+            new webcodecs::ErrorOutputData{error_code, message};
+        if (!error_tsfn_.Call(error_data)) {
+          delete error_data;
+        }
+      }));
 
-  // Configure resampler: f32 interleaved -> encoder's format.
-  AVChannelLayout in_layout;
-  av_channel_layout_default(&in_layout, number_of_channels_);
+  worker_->SetFlushCompleteCallback(gate.Guard(
+      [this](uint32_t promise_id, bool success, const std::string& error) {
+        if (!alive_.load(std::memory_order_acquire)) {
+          return;
+        }
+        auto* flush_data =
+            new webcodecs::FlushCompleteData{promise_id, success, error};
+        if (!flush_tsfn_.Call(flush_data)) {
+          delete flush_data;
+        }
+      }));
 
-  av_opt_set_chlayout(swr_context_.get(), "in_chlayout", &in_layout, 0);
-  av_opt_set_int(swr_context_.get(), "in_sample_rate", sample_rate_, 0);
-  av_opt_set_sample_fmt(swr_context_.get(), "in_sample_fmt", AV_SAMPLE_FMT_FLT,
-                        0);
+  worker_->SetDequeueCallback(
+      gate.Guard([this](uint32_t) { dequeue_notifier_.Notify(); }));
 
-  av_opt_set_chlayout(swr_context_.get(), "out_chlayout",
-                      &codec_context_->ch_layout, 0);
-  av_opt_set_int(swr_context_.get(), "out_sample_rate", sample_rate_, 0);
-  av_opt_set_sample_fmt(swr_context_.get(), "out_sample_fmt",
-                        codec_context_->sample_fmt, 0);
+  // Configure and start the worker
+  if (!worker_->Configure(encoder_config)) {
+    throw Napi::Error::New(env, "Failed to queue encoder configuration");
+  }
 
-  ret = swr_init(swr_context_.get());
-  if (ret < 0) {
-    char errbuf[256];
-    av_strerror(ret, errbuf, sizeof(errbuf));
-    Cleanup();
-    throw Napi::Error::New(env,
-                           std::string("Could not init resampler: ") + errbuf);
+  worker_->SetStats(stats_);
+  worker_->SetPlacement(encoder_config.threading.placement);
+  if (!worker_->Start()) {
+    throw Napi::Error::New(env, "Failed to start encoder worker");
   }
 
   state_ = "configured";
@@ -326,11 +439,55 @@ Napi::Value AudioEncoder::GetCodecSaturated(const Napi::CallbackInfo& info) {
   return Napi::Boolean::New(info.Env(), codec_saturated_.load());
 }
 
+Napi::Value AudioEncoder::GetStats(const Napi::CallbackInfo& info) {
+  return webcodecs::CodecStatsToObject(info.Env(), *stats_);
+}
+
+void AudioEncoder::ResetStats(const Napi::CallbackInfo& info) {
+  stats_->Reset();
+}
+
 void AudioEncoder::Close(const Napi::CallbackInfo& info) {
   Cleanup();
   state_ = "closed";
 }
 
+Napi::Value AudioEncoder::AttachMuxer(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (state_ == "closed") {
+    throw Napi::Error::New(env, "InvalidStateError: Encoder is closed");
+  }
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsNumber() ||
+      Muxer::constructor.IsEmpty() ||
+      !info[0].As<Napi::Object>().InstanceOf(Muxer::constructor.Value())) {
+    throw Napi::TypeError::New(env,
+                               "attachMuxer requires a Muxer and a trackIndex");
+  }
+  if (sink_) {
+    throw Napi::Error::New(env,
+                           "InvalidStateError: Encoder already has a muxer");
+  }
+
+  Napi::Object muxer_obj = info[0].As<Napi::Object>();
+  Muxer* muxer = Napi::ObjectWrap<Muxer>::Unwrap(muxer_obj);
+  int stream_index = info[1].As<Napi::Number>().Int32Value();
+  if (!muxer->HasTrack(stream_index, AVMEDIA_TYPE_AUDIO)) {
+    throw Napi::TypeError::New(env, "trackIndex is not an audio track");
+  }
+  if (!muxer->AttachEncoder(env)) {
+    throw Napi::Error::New(env, "InvalidStateError: Muxer is finalized");
+  }
+
+  sink_ref_ = Napi::Persistent(muxer_obj);
+  sink_ = muxer;
+  sink_stream_index_ = stream_index;
+  if (worker_) {
+    worker_->SetPacketSink(sink_, sink_stream_index_);
+  }
+  return env.Undefined();
+}
+
 Napi::Value AudioEncoder::Reset(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -339,7 +496,21 @@ Napi::Value AudioEncoder::Reset(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  Cleanup();
+  if (control_queue_) {
+    control_queue_->ClearFrames();
+  }
+  RetireWorker();
+
+  // Reject any pending flush promises
+  {
+    std::lock_guard<std::mutex> lock(flush_promise_mutex_);
+    for (auto& [id, deferred] : pending_flush_promises_) {
+      deferred.Reject(
+          Napi::Error::New(env, "Encoder reset during flush").Value());
+    }
+    pending_flush_promises_.clear();
+  }
+
   state_ = "unconfigured";
   frame_count_ = 0;
   encode_queue_size_ = 0;
@@ -351,7 +522,7 @@ Napi::Value AudioEncoder::Reset(const Napi::CallbackInfo& info) {
 Napi::Value AudioEncoder::Encode(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  if (state_ != "configured") {
+  if (state_ != "configured" || !control_queue_) {
     throw Napi::Error::New(env, "InvalidStateError: Encoder not configured");
   }
 
@@ -359,15 +530,67 @@ Napi::Value AudioEncoder::Encode(const Napi::CallbackInfo& info) {
     throw Napi::Error::New(env, "encode requires AudioData");
   }
 
-  // Get AudioData from wrapper or native object.
-  Napi::Object audio_data_obj = info[0].As<Napi::Object>();
+  return Napi::Number::New(
+      env, EncodeData(env, info[0].As<Napi::Object>(), nullptr));
+}
+
+Napi::Value AudioEncoder::EncodeBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (state_ != "configured" || !control_queue_) {
+    throw Napi::Error::New(env, "InvalidStateError: Encoder not configured");
+  }
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    throw Napi::TypeError::New(env,
+                               "encodeBatch requires an array of AudioData");
+  }
+  Napi::Array datas = info[0].As<Napi::Array>();
 
-  // Get properties from AudioData.
-  uint32_t number_of_frames = static_cast<uint32_t>(
-      webcodecs::AttrAsInt32(audio_data_obj, "numberOfFrames", 0));
+  // AudioData are staged and enqueued under one lock. Returns [AudioData
+  // consumed, requests dropped]; a 'block' policy stop leaves the rest to
+  // the JS layer.
+  Staged staged;
+  uint32_t consumed = 0;
+  int dropped = 0;
+  try {
+    for (; consumed < datas.Length(); ++consumed) {
+      Napi::Value data = datas.Get(consumed);
+      if (!data.IsObject()) {
+        throw Napi::Error::New(env, "encode requires AudioData");
+      }
+      int result = EncodeData(env, data.As<Napi::Object>(), &staged);
+      if (result < 0) {
+        break;
+      }
+      dropped += result;
+    }
+  } catch (const Napi::Error&) {
+    // AudioData before the failing one stay queued, as with encode() calls.
+    size_t count = staged.size();
+    if (!control_queue_->EnqueueAll(staged.Take())) {
+      encode_queue_size_ -= static_cast<int>(count);
+    }
+    throw;
+  }
+  EnqueueStaged(env, &staged);
 
-  int64_t timestamp = webcodecs::AttrAsInt64(audio_data_obj, "timestamp", 0);
+  Napi::Array result = Napi::Array::New(env, 2);
+  result.Set(0u, Napi::Number::New(env, consumed));
+  result.Set(1u, Napi::Number::New(env, dropped));
+  return result;
+}
 
+void AudioEncoder::EnqueueStaged(Napi::Env env, Staged* staged) {
+  size_t count = staged->size();
+  if (!control_queue_->EnqueueAll(staged->Take())) {
+    encode_queue_size_ -= static_cast<int>(count);
+    throw Napi::Error::New(env, "Failed to enqueue encode request");
+  }
+}
+
+int AudioEncoder::EncodeData(Napi::Env env, Napi::Object audio_data_obj,
+                             Staged* staged) {
   // Get sample data - try to unwrap as native AudioData first.
   AudioData* native_audio_data = nullptr;
   try {
@@ -376,90 +599,97 @@ Napi::Value AudioEncoder::Encode(const Napi::CallbackInfo& info) {
     // Not a native AudioData, might be wrapped.
   }
 
-  const uint8_t* sample_data = nullptr;
-  size_t sample_data_size = 0;
-
-  if (native_audio_data && !native_audio_data->IsClosed()) {
-    const std::vector<uint8_t>& data = native_audio_data->GetData();
-    sample_data = data.data();
-    sample_data_size = data.size();
-  } else {
-    // Try to get data from a _native property (wrapped object).
-    if (audio_data_obj.Has("_native") &&
-        audio_data_obj.Get("_native").IsObject()) {
-      Napi::Object native_obj =
-          audio_data_obj.Get("_native").As<Napi::Object>();
+  if (native_audio_data && native_audio_data->IsClosed()) {
+    native_audio_data = nullptr;
+  }
+  if (!native_audio_data) {
+    // Try the _native property of a wrapped object.
+    Napi::Value native_value =
+        webcodecs::Attr(audio_data_obj, webcodecs::Key::kNative);
+    if (native_value.IsObject()) {
+      Napi::Object native_obj = native_value.As<Napi::Object>();
       try {
         native_audio_data = Napi::ObjectWrap<AudioData>::Unwrap(native_obj);
-        if (native_audio_data && !native_audio_data->IsClosed()) {
-          const std::vector<uint8_t>& data = native_audio_data->GetData();
-          sample_data = data.data();
-          sample_data_size = data.size();
-        }
       } catch (...) {
       }
+      if (native_audio_data && native_audio_data->IsClosed()) {
+        native_audio_data = nullptr;
+      }
     }
   }
-
-  if (!sample_data || sample_data_size == 0) {
+  if (!native_audio_data) {
     throw Napi::Error::New(env, "Could not get audio data");
   }
+  int64_t timestamp = native_audio_data->GetTimestampValue();
 
-  // Calculate bytes per sample for interleaved f32 input.
-  size_t bytes_per_sample = sizeof(float) * number_of_channels_;
-  int frame_size = codec_context_->frame_size;
-
-  // Process input samples in frame-sized chunks.
-  uint32_t samples_remaining = number_of_frames;
-  const uint8_t* input_ptr = sample_data;
-  int64_t current_pts = timestamp;
+  // Reference the samples, in the AudioData's own format, rate and channel
+  // count. Decoder output shares its refcounted planes without a copy, so the
+  // AudioData may be closed as soon as encode() returns. The worker converts
+  // to the codec's format, rate and layout, or sends matching frames as-is.
+  ffmpeg::AVFramePtr frame = ffmpeg::make_frame();
+  if (!frame) {
+    throw Napi::Error::New(env, "Could not allocate frame");
+  }
+  if (!native_audio_data->RefAVFrame(frame.get())) {
+    throw Napi::Error::New(env, "Could not get audio data");
+  }
+  frame->pts = timestamp;
 
-  while (samples_remaining > 0) {
-    // Make frame writable.
-    int ret = av_frame_make_writable(frame_.get());
-    if (ret < 0) {
-      throw Napi::Error::New(env, "Could not make frame writable");
-    }
+  webcodecs::AudioControlQueue::EncodeMessage encode_msg;
+  encode_msg.frame = std::move(frame);
+  webcodecs::AudioControlQueue::Message msg = std::move(encode_msg);
 
-    // Determine how many samples to convert in this iteration.
-    int samples_to_convert = samples_remaining;
-    if (samples_to_convert > frame_size) {
-      samples_to_convert = frame_size;
+  // Refuse new work while native memory is over the soft limit set with
+  // setMemoryLimit() (node-webcodecs extension).
+  if (webcodecs::MemoryAccountant::Instance().OverSoftLimit()) {
+    throw Napi::Error::New(
+        env,
+        "QuotaExceededError: Native memory is over the soft limit. Close "
+        "frames and chunks you no longer need before encoding more.");
+  }
+
+  // A batch stops staging once its AudioData would break the queue limits:
+  // they are enqueued and the limits then apply to this one as usual.
+  size_t msg_bytes = webcodecs::AudioControlQueue::PayloadBytes(msg);
+  if (staged && !staged->empty() && QueueFull(msg_bytes, staged)) {
+    EnqueueStaged(env, staged);
+  }
+
+  // Apply the queue limits. Returns how many encode requests were dropped
+  // (including this one), or -1 when the 'block' policy wants the JS layer
+  // to retry once the queue drains.
+  int dropped = 0;
+  while (QueueFull(msg_bytes)) {
+    if (queue_limits_.policy == webcodecs::QueuePolicy::kBlock) {
+      // Look again after asking for a wake-up; the worker may have made
+      // room before it could see the request.
+      dequeue_notifier_.Request();
+      if (QueueFull(msg_bytes)) {
+        return -1;
+      }
+      break;
     }
-
-    // Convert samples using resampler.
-    const uint8_t* in_data[] = {input_ptr};
-    ret = swr_convert(swr_context_.get(), frame_->data, frame_size, in_data,
-                      samples_to_convert);
-
-    if (ret < 0) {
-      char errbuf[256];
-      av_strerror(ret, errbuf, sizeof(errbuf));
-      throw Napi::Error::New(env, std::string("Resample error: ") + errbuf);
+    if (queue_limits_.policy == webcodecs::QueuePolicy::kReject) {
+      throw Napi::Error::New(
+          env,
+          "QuotaExceededError: Encode queue is full. You must handle "
+          "backpressure by waiting for encodeQueueSize to decrease.");
     }
-
-    // Update frame pts based on samples processed.
-    frame_->pts = current_pts;
-
-    // Send frame to encoder.
-    ret = avcodec_send_frame(codec_context_.get(), frame_.get());
-    if (ret < 0 && ret != AVERROR(EAGAIN)) {
-      char errbuf[256];
-      av_strerror(ret, errbuf, sizeof(errbuf));
-      error_callback_.Call(
-          {Napi::Error::New(env, std::string("Encode error: ") + errbuf)
-               .Value()});
-      return env.Undefined();
+    bool orphaned_key = false;
+    if (!control_queue_->DropOldestFrame(&orphaned_key)) {
+      // Only in-flight data or control messages fill the limit; drop this
+      // data instead.
+      encode_queue_size_ = std::max(0, encode_queue_size_ - dropped);
+      return dropped + 1;
     }
+    dropped++;
+  }
+  encode_queue_size_ = std::max(0, encode_queue_size_ - dropped);
 
-    // Emit any ready chunks.
-    EmitChunks(env);
-
-    // Move to next chunk.
-    input_ptr += samples_to_convert * bytes_per_sample;
-    samples_remaining -= samples_to_convert;
-    current_pts += static_cast<int64_t>(samples_to_convert) * 1000000 /
-                   sample_rate_;  // pts in microseconds
+  if (staged) {
+    staged->Add(std::move(msg));
+  } else if (!control_queue_->Enqueue(std::move(msg))) {
+    throw Napi::Error::New(env, "Failed to enqueue encode request");
   }
 
   // Increment queue size after successful frame submission
@@ -469,93 +699,59 @@ Napi::Value AudioEncoder::Encode(const Napi::CallbackInfo& info) {
 
   frame_count_++;
 
-  return env.Undefined();
+  return dropped;
+}
+
+bool AudioEncoder::QueueFull(size_t incoming_bytes,
+                             const Staged* staged) const {
+  size_t queued = control_queue_->size() + (staged ? staged->size() : 0);
+  if (queue_limits_.max_size > 0 && queued >= queue_limits_.max_size) {
+    return true;
+  }
+  // An empty queue always takes one request, however large.
+  size_t queued_bytes = control_queue_->bytes() + (staged ? staged->bytes : 0);
+  return queue_limits_.max_bytes > 0 && queued_bytes > 0 &&
+         queued_bytes + incoming_bytes > queue_limits_.max_bytes;
 }
 
 Napi::Value AudioEncoder::Flush(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  if (state_ == "configured") {
-    // First, flush the resampler to get any buffered samples
-    if (swr_context_) {
-      int frame_size = codec_context_->frame_size;
-
-      // Get buffered samples from resampler
-      int ret = av_frame_make_writable(frame_.get());
-      if (ret >= 0) {
-        // Flush resampler by passing NULL input
-        int out_samples = swr_convert(swr_context_.get(), frame_->data,
-                                      frame_size, nullptr, 0);
-
-        // If we got samples, send them to encoder
-        if (out_samples > 0) {
-          frame_->nb_samples = out_samples;
-          frame_->pts = timestamp_;
-
-          ret = avcodec_send_frame(codec_context_.get(), frame_.get());
-          if (ret >= 0 || ret == AVERROR(EAGAIN)) {
-            EmitChunks(env);
-          }
-        }
-      }
-    }
-
-    // Send NULL frame to flush encoder
-    avcodec_send_frame(codec_context_.get(), nullptr);
-
-    // Get remaining packets
-    EmitChunks(env);
+  if (state_ != "configured" || !control_queue_ || !worker_) {
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    deferred.Resolve(env.Undefined());
+    return deferred.Promise();
   }
 
-  // Reset queue after flush
-  encode_queue_size_ = 0;
-  codec_saturated_.store(false);
-
   Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-  deferred.Resolve(env.Undefined());
-  return deferred.Promise();
-}
-
-void AudioEncoder::EmitChunks(Napi::Env env) {
-  while (true) {
-    int ret = avcodec_receive_packet(codec_context_.get(), packet_.get());
-    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-      break;
-    }
-    if (ret < 0) {
-      char errbuf[256];
-      av_strerror(ret, errbuf, sizeof(errbuf));
-      error_callback_.Call(
-          {Napi::Error::New(env, std::string("Receive packet error: ") + errbuf)
-               .Value()});
-      break;
-    }
+  Napi::Promise promise = deferred.Promise();
+  uint32_t promise_id = next_promise_id_++;
 
-    // Calculate duration in microseconds.
-    int64_t duration = 0;
-    if (codec_context_->frame_size > 0) {
-      duration = static_cast<int64_t>(codec_context_->frame_size) * 1000000 /
-                 sample_rate_;
-    }
-
-    // Create EncodedAudioChunk.
-    Napi::Object chunk = EncodedAudioChunk::CreateInstance(
-        env,
-        "key",  // Audio chunks are typically all key frames.
-        packet_->pts, duration, packet_->data, packet_->size);
+  {
+    std::lock_guard<std::mutex> lock(flush_promise_mutex_);
+    pending_flush_promises_.emplace(promise_id, std::move(deferred));
+  }
 
-    // Call output callback.
-    output_callback_.Call({chunk});
+  // Enqueue flush message - resolved by the worker once drained
+  webcodecs::AudioControlQueue::FlushMessage msg;
+  msg.promise_id = promise_id;
 
-    // Decrement queue size after chunk is emitted
-    if (encode_queue_size_ > 0) {
-      encode_queue_size_--;
-      bool saturated = encode_queue_size_ >= static_cast<int>(kMaxQueueSize);
-      codec_saturated_.store(saturated);
+  if (!control_queue_->Enqueue(std::move(msg))) {
+    std::lock_guard<std::mutex> lock(flush_promise_mutex_);
+    auto it = pending_flush_promises_.find(promise_id);
+    if (it != pending_flush_promises_.end()) {
+      it->second.Reject(
+          Napi::Error::New(env, "Failed to enqueue flush").Value());
+      pending_flush_promises_.erase(it);
     }
-
-    av_packet_unref(packet_.get());
+    return promise;
   }
+
+  // Reset queue after flush
+  encode_queue_size_ = 0;
+  codec_saturated_.store(false);
+
+  return promise;
 }
 
 Napi::Value AudioEncoder::IsConfigSupported(const Napi::CallbackInfo& info) {
@@ -581,27 +777,27 @@ Napi::Value AudioEncoder::IsConfigSupported(const Napi::CallbackInfo& info) {
     normalized_config.Set("codec", codec);
 
     if (codec == "opus") {
-      const AVCodec* c = avcodec_find_encoder(AV_CODEC_ID_OPUS);
+      const AVCodec* c = webcodecs::FindEncoder(AV_CODEC_ID_OPUS);
       if (!c) {
         supported = false;
       }
     } else if (codec.find("mp4a.40") == 0) {
-      const AVCodec* c = avcodec_find_encoder(AV_CODEC_ID_AAC);
+      const AVCodec* c = webcodecs::FindEncoder(AV_CODEC_ID_AAC);
       if (!c) {
         supported = false;
       }
     } else if (codec == "flac") {
-      const AVCodec* c = avcodec_find_encoder(AV_CODEC_ID_FLAC);
+      const AVCodec* c = webcodecs::FindEncoder(AV_CODEC_ID_FLAC);
       if (!c) {
         supported = false;
       }
     } else if (codec == "mp3") {
-      const AVCodec* c = avcodec_find_encoder(AV_CODEC_ID_MP3);
+      const AVCodec* c = webcodecs::FindEncoder(AV_CODEC_ID_MP3);
       if (!c) {
         supported = false;
       }
     } else if (codec == "vorbis") {
-      const AVCodec* c = avcodec_find_encoder(AV_CODEC_ID_VORBIS);
+      const AVCodec* c = webcodecs::FindEncoder(AV_CODEC_ID_VORBIS);
       if (!c) {
         supported = false;
       }
@@ -679,6 +875,31 @@ Napi::Value AudioEncoder::IsConfigSupported(const Napi::CallbackInfo& info) {
     normalized_config.Set("aac", normalized_aac);
   }
 
+  // Copy threading (node-webcodecs extension).
+  webcodecs::CodecThreadingConfig threading;
+  std::string threading_error;
+  if (!webcodecs::ParseThreadingConfig(config, &threading, &threading_error)) {
+    supported = false;
+  } else if (threading.specified) {
+    normalized_config.Set("threading",
+                          webcodecs::ThreadingConfigToObject(env, threading));
+  }
+
+  // Copy output batching (node-webcodecs extension).
+  int output_batch_size = 1;
+  std::string batch_error;
+  if (!webcodecs::ParseOutputBatchSize(config, &output_batch_size,
+                                       &batch_error)) {
+    supported = false;
+  } else if (webcodecs::HasAttr(config, "outputBatchSize")) {
+    normalized_config.Set("outputBatchSize", output_batch_size);
+  }
+
+  // Copy queue limits (node-webcodecs extension).
+  if (!webcodecs::CopyQueueLimits(config, normalized_config)) {
+    supported = false;
+  }
+
   result.Set("supported", supported);
   result.Set("config", normalized_config);
 
@@ -14,9 +14,22 @@ extern "C" {
 
 #include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
+#include "src/audio_encoder_worker.h"
+#include "src/common.h"
 #include "src/ffmpeg_raii.h"
+#include "src/shared/control_message_queue.h"
+#include "src/shared/batched_tsfn.h"
+#include "src/shared/codec_reaper.h"
+#include "src/shared/codec_stats.h"
+#include "src/shared/dequeue_notifier.h"
+#include "src/shared/safe_tsfn.h"
+
+class Muxer;
 
 class AudioEncoder : public Napi::ObjectWrap<AudioEncoder> {
  public:
@@ -32,43 +45,102 @@ class AudioEncoder : public Napi::ObjectWrap<AudioEncoder> {
   // WebCodecs API methods.
   Napi::Value Configure(const Napi::CallbackInfo& info);
   Napi::Value Encode(const Napi::CallbackInfo& info);
+  Napi::Value EncodeBatch(const Napi::CallbackInfo& info);
   Napi::Value Flush(const Napi::CallbackInfo& info);
   Napi::Value Reset(const Napi::CallbackInfo& info);
   void Close(const Napi::CallbackInfo& info);
   Napi::Value GetState(const Napi::CallbackInfo& info);
   Napi::Value GetEncodeQueueSize(const Napi::CallbackInfo& info);
   Napi::Value GetCodecSaturated(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+  void ResetStats(const Napi::CallbackInfo& info);
+  Napi::Value AttachMuxer(const Napi::CallbackInfo& info);
 
   // Static methods.
   static Napi::Value IsConfigSupported(const Napi::CallbackInfo& info);
 
   // Internal helpers.
   void Cleanup();
-  void EmitChunks(Napi::Env env);
+  // Cut off the worker's output and muxer sink, hand it to the
+  // CodecReaper, which waits out its current frame and frees the codec off
+  // the event loop, and release the TSFNs.
+  void RetireWorker();
+  using Staged = webcodecs::StagedMessages<webcodecs::AudioControlQueue>;
+  // Queue |data|, or add it to |staged| when given. Returns how many encode
+  // requests were dropped (including this one), or -1 when the 'block'
+  // policy found the queue full.
+  int EncodeData(Napi::Env env, Napi::Object data, Staged* staged);
+  void EnqueueStaged(Napi::Env env, Staged* staged);
+  // True when one more encode request of |incoming_bytes|, after the
+  // |staged| ones, breaks the queue limits.
+  bool QueueFull(size_t incoming_bytes,
+                 const Staged* staged = nullptr) const;
 
-  // FFmpeg state.
-  const AVCodec*
-      codec_;  // Not owned - references FFmpeg's static codec descriptor
-  ffmpeg::AVCodecContextPtr codec_context_;
-  ffmpeg::SwrContextPtr swr_context_;
-  ffmpeg::AVFramePtr frame_;
-  ffmpeg::AVPacketPtr packet_;
+  // TSFN callback helpers
+  static void OnOutputTSFN(Napi::Env env, Napi::Function fn, AudioEncoder* ctx,
+                           webcodecs::EncodedAudioPacketData* data);
+  static void OnErrorTSFN(Napi::Env env, Napi::Function fn, AudioEncoder* ctx,
+                          webcodecs::ErrorOutputData* data);
+  static void OnFlushTSFN(Napi::Env env, Napi::Function fn, AudioEncoder* ctx,
+                          webcodecs::FlushCompleteData* data);
 
   // Callbacks.
   Napi::FunctionReference output_callback_;
   Napi::FunctionReference error_callback_;
+  // Receives the packet count of sink progress events (attachMuxer).
+  Napi::FunctionReference sink_progress_callback_;
+  Napi::FunctionReference dequeue_callback_;  // Optional
+
+  // Muxer receiving packets natively; sink_ref_ keeps it alive until the
+  // worker is gone.
+  Napi::ObjectReference sink_ref_;
+  Muxer* sink_ = nullptr;
+  int sink_stream_index_ = -1;
 
   // State.
   std::string state_;
   uint32_t sample_rate_;
   uint32_t number_of_channels_;
-  int64_t timestamp_;
   int frame_count_;
 
   // Queue tracking for W3C WebCodecs spec compliance
   int encode_queue_size_ = 0;
   std::atomic<bool> codec_saturated_{false};
   static constexpr size_t kMaxQueueSize = 16;
+  // maxQueueSize/maxQueueBytes/queuePolicy; unbounded by default.
+  webcodecs::QueueLimits queue_limits_;
+  // Per-instance pipeline stats; shared with the worker and output TSFN and
+  // kept across reconfigure.
+  std::shared_ptr<webcodecs::CodecStats> stats_ =
+      std::make_shared<webcodecs::CodecStats>("AudioEncoder");
+
+  // Lifecycle safety flag - prevents use-after-free in callbacks
+  std::atomic<bool> alive_{true};
+
+  // Worker-based encoding
+  std::unique_ptr<webcodecs::AudioControlQueue> control_queue_;
+  std::unique_ptr<webcodecs::AudioEncoderWorker> worker_;
+  // Guards worker_'s callbacks; closed when the worker is retired.
+  std::shared_ptr<webcodecs::OutputGate> output_gate_;
+
+  // ThreadSafeFunctions for async callbacks
+  using OutputTSFN = webcodecs::BatchedThreadSafeFunction<
+      AudioEncoder, webcodecs::EncodedAudioPacketData, OnOutputTSFN>;
+  using ErrorTSFN = webcodecs::SafeThreadSafeFunction<
+      AudioEncoder, webcodecs::ErrorOutputData, OnErrorTSFN>;
+  using FlushTSFN = webcodecs::SafeThreadSafeFunction<
+      AudioEncoder, webcodecs::FlushCompleteData, OnFlushTSFN>;
+
+  OutputTSFN output_tsfn_;
+  ErrorTSFN error_tsfn_;
+  FlushTSFN flush_tsfn_;
+  // Retries of encode() calls parked by the 'block' policy.
+  webcodecs::DequeueNotifier dequeue_notifier_;
+
+  // Promise tracking for flush
+  uint32_t next_promise_id_ = 0;
+  std::unordered_map<uint32_t, Napi::Promise::Deferred> pending_flush_promises_;
+  std::mutex flush_promise_mutex_;
 };
 
 #endif  // SRC_AUDIO_ENCODER_H_
@@ -0,0 +1,534 @@
+// Copyright 2025 node-webcodecs contributors. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// AudioEncoderWorker implementation.
+
+#include "src/audio_encoder_worker.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "src/common.h"
+
+namespace webcodecs {
+
+AudioEncoderWorker::AudioEncoderWorker(AudioWorkerQueue* queue)
+    : CodecWorker<AudioWorkerQueue>(queue) {}
+
+AudioEncoderWorker::~AudioEncoderWorker() {
+  // Stop the thread before our FFmpeg members are destroyed.
+  Stop();
+}
+
+bool AudioEncoderWorker::Configure(const AudioEncoderConfig& config) {
+  config_ = config;
+
+  ConfigureMessage msg;
+  msg.configure_fn = [this]() -> bool { return InitializeCodec(); };
+
+  return Enqueue(std::move(msg));
+}
+
+bool AudioEncoderWorker::OnConfigure(const ConfigureMessage& msg) {
+  return msg.configure_fn();
+}
+
+bool AudioEncoderWorker::InitializeCodec() {
+  frame_.reset();
+  packet_.reset();
+  swr_context_.reset();
+  fifo_.reset();
+  convert_frame_.reset();
+  codec_context_.reset();
+
+  codec_ = FindEncoder(config_.codec_id);
+  if (!codec_) {
+    OutputError(AVERROR_ENCODER_NOT_FOUND, "Encoder not found for codec");
+    return false;
+  }
+
+  codec_context_ = ffmpeg::make_codec_context(codec_);
+  if (!codec_context_) {
+    OutputError(AVERROR(ENOMEM), "Could not allocate codec context");
+    return false;
+  }
+
+  codec_context_->sample_rate = config_.sample_rate;
+  av_channel_layout_default(&codec_context_->ch_layout,
+                            config_.number_of_channels == 1 ? 1 : 2);
+  codec_context_->bit_rate = config_.bitrate;
+
+  // Set sample format based on codec.
+  // Different codecs require different sample formats:
+  // - Opus: non-planar float (flt)
+  // - AAC/Vorbis: planar float (fltp)
+  // - MP3: planar signed 16-bit (s16p) or planar float (fltp)
+  // - FLAC: signed 16-bit (s16) or signed 32-bit (s32)
+  if (config_.codec_id == AV_CODEC_ID_OPUS) {
+    codec_context_->sample_fmt = AV_SAMPLE_FMT_FLT;
+  } else if (config_.codec_id == AV_CODEC_ID_FLAC) {
+    codec_context_->sample_fmt = AV_SAMPLE_FMT_S16;
+  } else if (config_.codec_id == AV_CODEC_ID_MP3) {
+    codec_context_->sample_fmt = AV_SAMPLE_FMT_S16P;
+  } else {
+    // AAC and Vorbis use planar float
+    codec_context_->sample_fmt = AV_SAMPLE_FMT_FLTP;
+  }
+
+  codec_context_->time_base = AVRational{1, config_.sample_rate};
+
+  // Opus options per W3C WebCodecs spec (mapped to libopus options).
+  if (config_.codec_id == AV_CODEC_ID_OPUS) {
+    void* priv = codec_context_->priv_data;
+    if (!config_.opus_application.empty()) {
+      av_opt_set(priv, "application", config_.opus_application.c_str(), 0);
+    }
+    if (config_.opus_complexity >= 0) {
+      av_opt_set_int(priv, "compression_level", config_.opus_complexity, 0);
+    }
+    if (config_.opus_frame_duration_us >= 0) {
+      // libopus takes milliseconds.
+      av_opt_set_double(priv, "frame_duration",
+                        config_.opus_frame_duration_us / 1000.0, 0);
+    }
+    if (config_.opus_usedtx >= 0) {
+      av_opt_set_int(priv, "dtx", config_.opus_usedtx, 0);
+    }
+    if (config_.opus_useinbandfec >= 0) {
+      av_opt_set_int(priv, "fec", config_.opus_useinbandfec, 0);
+    }
+    if (config_.opus_packet_loss >= 0) {
+      av_opt_set_int(priv, "packet_loss", config_.opus_packet_loss, 0);
+    }
+  }
+
+  ApplyThreadingConfig(codec_context_.get(), config_.threading);
+
+  int ret = avcodec_open2(codec_context_.get(), codec_, nullptr);
+  if (ret < 0) {
+    OutputError(ret, "Could not open codec: " + FFmpegErrorString(ret));
+    codec_context_.reset();
+    return false;
+  }
+
+  frame_ = ffmpeg::make_frame();
+  packet_ = ffmpeg::make_packet();
+  if (!frame_ || !packet_) {
+    OutputError(AVERROR(ENOMEM), "Could not allocate frame/packet");
+    codec_context_.reset();
+    return false;
+  }
+
+  frame_->nb_samples = codec_context_->frame_size;
+  frame_->format = codec_context_->sample_fmt;
+  av_channel_layout_copy(&frame_->ch_layout, &codec_context_->ch_layout);
+
+  ret = av_frame_get_buffer(frame_.get(), 0);
+  if (ret < 0) {
+    OutputError(ret, "Could not allocate frame buffer");
+    codec_context_.reset();
+    return false;
+  }
+
+  fifo_.reset(av_audio_fifo_alloc(codec_context_->sample_fmt,
+                                  codec_context_->ch_layout.nb_channels,
+                                  codec_context_->frame_size));
+  if (!fifo_) {
+    OutputError(AVERROR(ENOMEM), "Could not allocate audio FIFO");
+    codec_context_.reset();
+    return false;
+  }
+
+  // The resampler is built for the first input (see PrepareInput).
+  in_format_ = AV_SAMPLE_FMT_NONE;
+  pts_origin_ = AV_NOPTS_VALUE;
+  samples_sent_ = 0;
+  return true;
+}
+
+bool AudioEncoderWorker::MatchesEncoder(const AVFrame* src) const {
+  return src->format == codec_context_->sample_fmt &&
+         src->sample_rate == codec_context_->sample_rate &&
+         av_channel_layout_compare(&src->ch_layout,
+                                   &codec_context_->ch_layout) == 0;
+}
+
+bool AudioEncoderWorker::CanSendDirectly(const AVFrame* src) const {
+  if (swr_context_ || av_audio_fifo_size(fifo_.get()) > 0 ||
+      !MatchesEncoder(src)) {
+    return false;
+  }
+  return src->nb_samples == codec_context_->frame_size ||
+         (codec_->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE);
+}
+
+bool AudioEncoderWorker::PrepareInput(const AVFrame* src) {
+  AVSampleFormat in_format = static_cast<AVSampleFormat>(src->format);
+  int channels = src->ch_layout.nb_channels;
+  if (in_format_ == in_format && in_rate_ == src->sample_rate &&
+      in_channels_ == channels) {
+    return true;  // Same input as before
+  }
+
+  // Samples still inside the old resampler come before this input.
+  if (swr_context_) {
+    if (!QueueSamples(nullptr, 0)) {
+      return false;
+    }
+    swr_context_.reset();
+  }
+
+  in_format_ = in_format;
+  in_rate_ = src->sample_rate;
+  in_channels_ = channels;
+  if (MatchesEncoder(src)) {
+    return true;  // Written to fifo_ as-is
+  }
+
+  SwrContext* swr = nullptr;
+  int ret = swr_alloc_set_opts2(&swr, &codec_context_->ch_layout,
+                                codec_context_->sample_fmt,
+                                codec_context_->sample_rate, &src->ch_layout,
+                                in_format, src->sample_rate, 0, nullptr);
+  swr_context_.reset(swr);
+  if (ret >= 0) {
+    ret = swr_init(swr_context_.get());
+  }
+  if (ret < 0) {
+    swr_context_.reset();
+    in_format_ = AV_SAMPLE_FMT_NONE;
+    OutputError(ret, "Could not init resampler: " + FFmpegErrorString(ret));
+    return false;
+  }
+  return true;
+}
+
+bool AudioEncoderWorker::QueueSamples(const uint8_t** in, int in_samples) {
+  int ret;
+  if (!swr_context_) {
+    void** planes = reinterpret_cast<void**>(const_cast<uint8_t**>(in));
+    ret = av_audio_fifo_write(fifo_.get(), planes, in_samples);
+    if (ret < in_samples) {
+      OutputError(ret < 0 ? ret : AVERROR(ENOMEM),
+                  "Could not queue audio samples");
+      return false;
+    }
+    return true;
+  }
+
+  // Upper bound on what this call (or a drain) can produce.
+  int out_samples = swr_get_out_samples(swr_context_.get(), in_samples);
+  if (out_samples <= 0) {
+    return true;
+  }
+  if (!convert_frame_ || convert_frame_->nb_samples < out_samples) {
+    convert_frame_ = ffmpeg::make_frame();
+    if (!convert_frame_) {
+      OutputError(AVERROR(ENOMEM), "Could not allocate resample buffer");
+      return false;
+    }
+    convert_frame_->format = codec_context_->sample_fmt;
+    convert_frame_->nb_samples = out_samples;
+    av_channel_layout_copy(&convert_frame_->ch_layout,
+                           &codec_context_->ch_layout);
+    ret = av_frame_get_buffer(convert_frame_.get(), 0);
+    if (ret < 0) {
+      convert_frame_.reset();
+      OutputError(ret, "Could not allocate resample buffer");
+      return false;
+    }
+  }
+
+  {
+    StageTimer timer(stats(), CodecStats::Stage::kConvert);
+    ret = swr_convert(swr_context_.get(), convert_frame_->extended_data,
+                      out_samples, in, in_samples);
+  }
+  if (ret < 0) {
+    OutputError(ret, "Resample error: " + FFmpegErrorString(ret));
+    return false;
+  }
+  int converted = ret;
+  ret = av_audio_fifo_write(
+      fifo_.get(), reinterpret_cast<void**>(convert_frame_->extended_data),
+      converted);
+  if (ret < converted) {
+    OutputError(ret < 0 ? ret : AVERROR(ENOMEM),
+                "Could not queue audio samples");
+    return false;
+  }
+  return true;
+}
+
+bool AudioEncoderWorker::SendQueuedFrames(bool final) {
+  const int frame_size = codec_context_->frame_size;
+  while (true) {
+    int queued = av_audio_fifo_size(fifo_.get());
+    if (queued == 0 || (queued < frame_size && !final)) {
+      return true;
+    }
+    int samples = queued < frame_size ? queued : frame_size;
+
+    frame_->nb_samples = frame_size;
+    int ret = av_frame_make_writable(frame_.get());
+    if (ret < 0) {
+      OutputError(ret, "Could not make frame writable");
+      return false;
+    }
+    ret = av_audio_fifo_read(fifo_.get(),
+                             reinterpret_cast<void**>(frame_->extended_data),
+                             samples);
+    if (ret < samples) {
+      OutputError(ret < 0 ? ret : AVERROR_BUG, "Could not read audio FIFO");
+      return false;
+    }
+
+    frame_->nb_samples = samples;
+    frame_->pts = pts_origin_ + av_rescale(samples_sent_, 1000000,
+                                           codec_context_->sample_rate);
+    samples_sent_ += samples;
+    if (!SendFrame(frame_.get())) {
+      return false;
+    }
+  }
+}
+
+void AudioEncoderWorker::SetPacketSink(PacketSink* sink, int stream_index) {
+  std::unique_lock<std::mutex> lock(sink_mutex_);
+  PacketSink* old_sink = sink_;
+  sink_ = sink;
+  sink_stream_index_ = stream_index;
+  sink_extradata_sent_ = false;
+  sink_failed_ = false;
+  if (sink_writes_ == 0) {
+    return;
+  }
+
+  // Cancel a write blocked on the old sink's full queue and wait it out,
+  // so the caller may release the old sink once this returns.
+  sink_cancel_.store(true);
+  lock.unlock();
+  old_sink->WakeWriters();
+  lock.lock();
+  sink_idle_cv_.wait(lock, [this] { return sink_writes_ == 0; });
+  sink_cancel_.store(false);
+}
+
+void AudioEncoderWorker::EndSinkWrite() {
+  {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    --sink_writes_;
+  }
+  sink_idle_cv_.notify_all();
+}
+
+bool AudioEncoderWorker::EmitToSink(int64_t duration) {
+  PacketSink* sink;
+  int stream_index;
+  bool send_extradata;
+  {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    if (!sink_) {
+      return false;
+    }
+    if (sink_failed_) {
+      return true;  // Dropped; the error was reported.
+    }
+    sink = sink_;
+    stream_index = sink_stream_index_;
+    send_extradata = !sink_extradata_sent_;
+    sink_extradata_sent_ = true;
+    ++sink_writes_;
+  }
+  WriteToSink(sink, stream_index, send_extradata, duration);
+  EndSinkWrite();
+  return true;
+}
+
+void AudioEncoderWorker::WriteToSink(PacketSink* sink, int stream_index,
+                                     bool send_extradata, int64_t duration) {
+  if (send_extradata && codec_context_->extradata &&
+      codec_context_->extradata_size > 0) {
+    sink->SetStreamExtradata(stream_index, codec_context_->extradata,
+                             codec_context_->extradata_size);
+  }
+
+  // Shares the encoder's refcounted payload; nothing is copied.
+  ffmpeg::AVPacketPtr packet = ffmpeg::ref_packet(packet_.get());
+  if (!packet) {
+    OutputError(AVERROR(ENOMEM), "Failed to allocate packet");
+    return;
+  }
+  packet->stream_index = stream_index;
+  packet->dts = packet->pts;  // Audio is never reordered
+  packet->duration = duration;
+  packet->pos = -1;
+  packet->flags = AV_PKT_FLAG_KEY;
+  if (!sink->WritePacket(std::move(packet), sink_cancel_)) {
+    if (sink_cancel_.load()) {
+      return;  // Detached mid-write; the packet is dropped.
+    }
+    {
+      std::lock_guard<std::mutex> lock(sink_mutex_);
+      sink_failed_ = true;
+    }
+    OutputError(AVERROR(EPIPE),
+                "InvalidStateError: Muxer stopped accepting packets");
+    return;
+  }
+
+  // One progress event in flight at a time; it reports every packet sunk
+  // until JS picks it up.
+  if (sink_unreported_->fetch_add(1) == 0 && packet_output_callback_) {
+    pending_chunks_->fetch_add(1);
+    auto progress = std::make_unique<EncodedAudioPacketData>();
+    progress->pending = pending_chunks_;
+    progress->sink_progress = sink_unreported_;
+    packet_output_callback_(std::move(progress));
+  }
+}
+
+bool AudioEncoderWorker::SendFrame(AVFrame* frame) {
+  int ret = avcodec_send_frame(codec_context_.get(), frame);
+  if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+    OutputError(ret, "Encode error: " + FFmpegErrorString(ret));
+    return false;
+  }
+
+  // Duration in microseconds of one encoder frame.
+  int64_t duration = 0;
+  if (codec_context_->frame_size > 0) {
+    duration = static_cast<int64_t>(codec_context_->frame_size) * 1000000 /
+               config_.sample_rate;
+  }
+
+  while (true) {
+    ret = avcodec_receive_packet(codec_context_.get(), packet_.get());
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+      break;
+    }
+    if (ret < 0) {
+      OutputError(ret, "Receive packet error: " + FFmpegErrorString(ret));
+      return false;
+    }
+
+    if (EmitToSink(duration)) {
+      av_packet_unref(packet_.get());
+      continue;
+    }
+
+    pending_chunks_->fetch_add(1);
+    auto packet_data = std::make_unique<EncodedAudioPacketData>();
+    packet_data->data.assign(packet_->data, packet_->data + packet_->size);
+    if (stats()) {
+      stats()->AddBytesCopied(static_cast<size_t>(packet_->size));
+    }
+    packet_data->timestamp = packet_->pts;
+    packet_data->duration = duration;
+    packet_data->pending = pending_chunks_;
+
+    if (packet_output_callback_) {
+      packet_output_callback_(std::move(packet_data));
+    } else {
+      pending_chunks_->fetch_sub(1);
+    }
+
+    av_packet_unref(packet_.get());
+  }
+  return true;
+}
+
+void AudioEncoderWorker::OnEncode(const EncodeMessage& msg) {
+  if (!codec_context_ || !frame_ || !packet_) {
+    OutputError(AVERROR_INVALIDDATA, "Encoder not initialized");
+    return;
+  }
+
+  const AVFrame* src = msg.frame.get();
+  if (!src || !src->data[0] || src->nb_samples <= 0) {
+    OutputError(AVERROR_INVALIDDATA, "Invalid audio data");
+    return;
+  }
+
+  // With nothing queued or inside a resampler, the next sample is this
+  // input's first: re-anchor so gaps in the input timeline carry through.
+  if (pts_origin_ == AV_NOPTS_VALUE ||
+      (!swr_context_ && av_audio_fifo_size(fifo_.get()) == 0)) {
+    pts_origin_ = src->pts;
+    samples_sent_ = 0;
+  }
+
+  // Matching frames go to the encoder as-is; it takes its own reference.
+  if (CanSendDirectly(src)) {
+    AVFrame* frame = msg.frame.get();
+    frame->pts = pts_origin_ + av_rescale(samples_sent_, 1000000,
+                                          codec_context_->sample_rate);
+    samples_sent_ += frame->nb_samples;
+    if (SendFrame(frame)) {
+      SignalDequeue(static_cast<uint32_t>(queue()->size()));
+    }
+    return;
+  }
+
+  // Every plane of any input format goes to the FIFO, resampled if needed.
+  if (!PrepareInput(src) ||
+      !QueueSamples(const_cast<const uint8_t**>(src->extended_data),
+                    src->nb_samples) ||
+      !SendQueuedFrames(false)) {
+    return;
+  }
+
+  SignalDequeue(static_cast<uint32_t>(queue()->size()));
+}
+
+void AudioEncoderWorker::OnFlush(const FlushMessage& msg) {
+  if (!codec_context_ || !frame_ || !packet_) {
+    FlushComplete(msg.promise_id, true);
+    return;
+  }
+
+  // Drain samples still buffered in the resampler, then send what is
+  // queued, ending with a short frame.
+  if (swr_context_) {
+    QueueSamples(nullptr, 0);
+  }
+  SendQueuedFrames(true);
+
+  // Drain the encoder.
+  SendFrame(nullptr);
+
+  // FFmpeg enters EOF mode after a NULL frame; reopen for further encodes.
+  bool reinit_success = InitializeCodec();
+  if (reinit_success) {
+    FlushComplete(msg.promise_id, true);
+  } else {
+    FlushComplete(msg.promise_id, false,
+                  "Failed to reinitialize codec after flush");
+  }
+}
+
+void AudioEncoderWorker::OnReset() {
+  // Flush codec internal buffers before destroying the context. Only valid
+  // on an opened codec (the internal codec pointer is NULL otherwise).
+  if (codec_context_ && avcodec_is_open(codec_context_.get())) {
+    avcodec_flush_buffers(codec_context_.get());
+  }
+
+  frame_.reset();
+  packet_.reset();
+  swr_context_.reset();
+  fifo_.reset();
+  convert_frame_.reset();
+  codec_context_.reset();
+  codec_ = nullptr;
+  in_format_ = AV_SAMPLE_FMT_NONE;
+  pts_origin_ = AV_NOPTS_VALUE;
+  samples_sent_ = 0;
+}
+
+void AudioEncoderWorker::OnClose() {
+  OnReset();
+}
+
+}  // namespace webcodecs
@@ -0,0 +1,239 @@
+// Copyright 2025 node-webcodecs contributors. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// AudioEncoderWorker - Dedicated worker thread for audio encoding.
+//
+// Uses the CodecWorker template for message-based codec processing.
+// Owns the AVCodecContext and SwrContext exclusively on the worker thread.
+
+#ifndef SRC_AUDIO_ENCODER_WORKER_H_
+#define SRC_AUDIO_ENCODER_WORKER_H_
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/opt.h>
+#include <libswresample/swresample.h>
+}
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/common.h"
+#include "src/ffmpeg_raii.h"
+#include "src/shared/codec_worker.h"
+#include "src/shared/control_message_queue.h"
+#include "src/shared/packet_sink.h"
+
+namespace webcodecs {
+
+/**
+ * Encoder configuration for worker initialization.
+ * Opus options use -1 (or empty) for "not specified".
+ */
+struct AudioEncoderConfig {
+  AVCodecID codec_id = AV_CODEC_ID_AAC;
+  int sample_rate = 48000;
+  int number_of_channels = 2;
+  int64_t bitrate = 128000;
+  std::string opus_application;
+  int opus_complexity = -1;
+  int64_t opus_frame_duration_us = -1;
+  int opus_usedtx = -1;
+  int opus_useinbandfec = -1;
+  int opus_packet_loss = -1;
+  CodecThreadingConfig threading;
+};
+
+/**
+ * Output packet data for TSFN delivery to JS thread.
+ */
+struct EncodedAudioPacketData {
+  std::vector<uint8_t> data;
+  int64_t timestamp;
+  int64_t duration;
+  std::shared_ptr<std::atomic<int>> pending;
+  // Set for progress events of a PacketSink-attached worker; no payload.
+  // Holds the count of packets sunk since the last event.
+  std::shared_ptr<std::atomic<int>> sink_progress;
+};
+
+/**
+ * AudioEncoderWorker - Worker thread for audio encoding operations.
+ *
+ * Extends CodecWorker<AudioWorkerQueue>. Encode messages carry AVFrames in
+ * the input's own sample format, rate and channel count (pts in
+ * microseconds); the worker resamples and remixes them to the encoder's
+ * format, rate and layout, batches them into exact codec frames through an
+ * AVAudioFifo, and emits packets in FIFO order. Frames that already match
+ * the encoder (e.g. straight from an AudioDecoder) are sent without
+ * conversion.
+ */
+class AudioEncoderWorker : public CodecWorker<AudioWorkerQueue> {
+ public:
+  using PacketOutputCallback =
+      std::function<void(std::unique_ptr<EncodedAudioPacketData>)>;
+
+  explicit AudioEncoderWorker(AudioWorkerQueue* queue);
+  ~AudioEncoderWorker() override;
+
+  // Disallow copy and assign
+  AudioEncoderWorker(const AudioEncoderWorker&) = delete;
+  AudioEncoderWorker& operator=(const AudioEncoderWorker&) = delete;
+
+  /**
+   * Configure the encoder.
+   * Called from JS thread; actual codec initialization happens on worker.
+   *
+   * @param config Encoder configuration
+   * @return true if configuration was queued successfully
+   */
+  bool Configure(const AudioEncoderConfig& config);
+
+  /**
+   * Set callback for packet output.
+   */
+  void SetPacketOutputCallback(PacketOutputCallback cb) {
+    packet_output_callback_ = std::move(cb);
+  }
+
+  /**
+   * Send packets to |sink| as stream |stream_index| instead of the packet
+   * output callback, which then only receives coalesced progress events
+   * (EncodedAudioPacketData::sink_progress). May be called while running;
+   * a write to the previous sink is cancelled and waited for, so that sink
+   * may be released once this returns.
+   */
+  void SetPacketSink(PacketSink* sink, int stream_index);
+
+  /**
+   * Get pending chunks counter for JS-side polling.
+   */
+  std::shared_ptr<std::atomic<int>> GetPendingChunksPtr() const {
+    return pending_chunks_;
+  }
+
+  /**
+   * Get current pending chunks count.
+   */
+  int GetPendingChunks() const { return pending_chunks_->load(); }
+
+ protected:
+  // CodecWorker overrides
+  bool OnConfigure(const ConfigureMessage& msg) override;
+  void OnEncode(const EncodeMessage& msg) override;
+  void OnFlush(const FlushMessage& msg) override;
+  void OnReset() override;
+  void OnClose() override;
+
+ private:
+  /**
+   * Open the codec with the current configuration.
+   * Called on worker thread.
+   */
+  bool InitializeCodec();
+
+  /**
+   * Track |src|'s format, rate and channel count. When they change, the
+   * previous resampler is drained into fifo_ and replaced: by a new one, or
+   * by none if |src| already matches the encoder.
+   */
+  bool PrepareInput(const AVFrame* src);
+
+  /**
+   * True if |src| matches the encoder's format, rate and layout.
+   */
+  bool MatchesEncoder(const AVFrame* src) const;
+
+  /**
+   * True if |src| is exactly one codec frame in the encoder's format, rate
+   * and layout, with nothing queued ahead of it.
+   */
+  bool CanSendDirectly(const AVFrame* src) const;
+
+  /**
+   * Append |in_samples| samples from |in| to fifo_, through swr_context_ if
+   * set. With swr_context_, nullptr |in| drains the resampler.
+   */
+  bool QueueSamples(const uint8_t** in, int in_samples);
+
+  /**
+   * Send every full codec frame in fifo_; with |final|, the short remainder
+   * too. Frame pts are derived from pts_origin_ and samples_sent_.
+   */
+  bool SendQueuedFrames(bool final);
+
+  /**
+   * Send |frame| (or nullptr to drain) and emit every ready packet.
+   *
+   * @return false if the encoder reported an error
+   */
+  bool SendFrame(AVFrame* frame);
+
+  /**
+   * Hand packet_ to the attached sink, if any, and schedule a progress
+   * event.
+   *
+   * @return false if no sink is attached
+   */
+  bool EmitToSink(int64_t duration);
+  void WriteToSink(PacketSink* sink, int stream_index, bool send_extradata,
+                   int64_t duration);
+  // Ends a sink_writes_ call and wakes SetPacketSink().
+  void EndSinkWrite();
+
+  // Configuration
+  AudioEncoderConfig config_;
+
+  // FFmpeg resources (owned by this worker)
+  const AVCodec* codec_ = nullptr;
+  ffmpeg::AVCodecContextPtr codec_context_;
+  ffmpeg::SwrContextPtr swr_context_;
+  ffmpeg::AVFramePtr frame_;
+  ffmpeg::AVPacketPtr packet_;
+
+  // Samples in the encoder's format waiting to fill a codec frame
+  ffmpeg::AVAudioFifoPtr fifo_;
+  // Resampler output staging; nb_samples is its capacity
+  ffmpeg::AVFramePtr convert_frame_;
+
+  // Parameters of the last input (swr_context_ is built for them)
+  AVSampleFormat in_format_ = AV_SAMPLE_FMT_NONE;
+  int in_rate_ = 0;
+  int in_channels_ = 0;
+
+  // Timestamp (microseconds) of the first sample since the queue was last
+  // empty, and encoder-rate samples sent since; frame pts derive from both
+  int64_t pts_origin_ = AV_NOPTS_VALUE;
+  int64_t samples_sent_ = 0;
+
+  // Pending chunks counter (shared_ptr for safe access in TSFN callbacks)
+  std::shared_ptr<std::atomic<int>> pending_chunks_ =
+      std::make_shared<std::atomic<int>>(0);
+
+  // Native packet destination; fields guarded by sink_mutex_.
+  std::mutex sink_mutex_;
+  PacketSink* sink_ = nullptr;
+  int sink_stream_index_ = -1;
+  bool sink_extradata_sent_ = false;
+  bool sink_failed_ = false;
+  int sink_writes_ = 0;  // Calls into sink_ in progress
+  std::condition_variable sink_idle_cv_;  // Signalled as sink_writes_ drops
+  std::atomic<bool> sink_cancel_{false};  // Set while SetPacketSink() waits
+  // Packets sunk but not yet reported; an event is scheduled on 0 -> 1.
+  std::shared_ptr<std::atomic<int>> sink_unreported_ =
+      std::make_shared<std::atomic<int>>(0);
+
+  // Callbacks
+  PacketOutputCallback packet_output_callback_;
+};
+
+}  // namespace webcodecs
+
+#endif  // SRC_AUDIO_ENCODER_WORKER_H_
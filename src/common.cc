@@ -3,9 +3,15 @@
 
 #include "src/common.h"
 
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
-#include <queue>
+#include <limits>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -13,6 +19,7 @@
 
 // Include shared utilities to verify they compile
 #include "src/shared/control_message_queue.h"
+#include "src/shared/log_collector.h"
 #include "src/shared/safe_tsfn.h"
 
 // Explicit template instantiation to verify ControlMessageQueue compiles
@@ -198,6 +205,63 @@ std::tuple<const uint8_t*, size_t> AttrAsBuffer(Napi::Object obj,
   return {nullptr, 0};
 }
 
+//==============================================================================
+// Interned Property Keys
+//==============================================================================
+
+namespace {
+
+// Indexed by Key.
+constexpr const char* kKeyNames[] = {
+    "keyFrame",
+    "avc",
+    "hevc",
+    "vp9",
+    "av1",
+    "quantizer",
+    "regionsOfInterest",
+    "skipOutput",
+    "_native",
+};
+static_assert(sizeof(kKeyNames) / sizeof(kKeyNames[0]) ==
+                  static_cast<size_t>(Key::kCount),
+              "every Key needs a name");
+
+// Node-API 8 cannot reference strings directly, so this environment's key
+// strings live in an array.
+struct InternedKeys {
+  Napi::ObjectReference names;
+};
+
+}  // namespace
+
+void InitInternedKeys(Napi::Env env) {
+  Napi::Array names = Napi::Array::New(env, static_cast<size_t>(Key::kCount));
+  for (uint32_t i = 0; i < static_cast<uint32_t>(Key::kCount); ++i) {
+    names.Set(i, Napi::String::New(env, kKeyNames[i]));
+  }
+  auto* keys = new InternedKeys();
+  keys->names = Napi::Persistent(names.As<Napi::Object>());
+  env.SetInstanceData(keys);
+}
+
+Napi::Value Attr(Napi::Object obj, Key key) {
+  auto* keys = obj.Env().GetInstanceData<InternedKeys>();
+  return obj.Get(keys->names.Value().Get(static_cast<uint32_t>(key)));
+}
+
+bool AttrAsBool(Napi::Object obj, Key key, bool default_val) {
+  Napi::Value val = Attr(obj, key);
+  if (!val.IsBoolean()) return default_val;
+  return val.As<Napi::Boolean>().Value();
+}
+
+int32_t AttrAsInt32(Napi::Object obj, Key key, int32_t default_val) {
+  Napi::Value val = Attr(obj, key);
+  if (!val.IsNumber()) return default_val;
+  return val.As<Napi::Number>().Int32Value();
+}
+
 //==============================================================================
 // Template Enum Mappings
 //==============================================================================
@@ -356,6 +420,386 @@ std::string FFmpegErrorString(int errnum) {
   return std::string(errbuf);
 }
 
+//==============================================================================
+// Codec Threading (node-webcodecs extension)
+//==============================================================================
+
+namespace {
+constexpr int kMaxThreadCount = 256;
+
+const char* PriorityName(ThreadPriority priority) {
+  switch (priority) {
+    case ThreadPriority::kBackground:
+      return "background";
+    case ThreadPriority::kLow:
+      return "low";
+    case ThreadPriority::kHigh:
+      return "high";
+    case ThreadPriority::kNormal:
+      break;
+  }
+  return "normal";
+}
+}  // namespace
+
+bool ParseThreadingConfig(Napi::Object config, CodecThreadingConfig* out,
+                          std::string* error) {
+  *out = CodecThreadingConfig();
+  if (!config.Has("threading") || config.Get("threading").IsUndefined()) {
+    return true;
+  }
+  if (!config.Get("threading").IsObject()) {
+    *error = "threading must be an object";
+    return false;
+  }
+  Napi::Object threading = config.Get("threading").As<Napi::Object>();
+  out->specified = true;
+
+  if (HasAttr(threading, "count")) {
+    Napi::Value count = threading.Get("count");
+    double value = count.IsNumber() ? count.As<Napi::Number>().DoubleValue()
+                                    : -1;
+    if (value < 0 || value > kMaxThreadCount ||
+        value != static_cast<int>(value)) {
+      *error = "threading.count must be an integer between 0 and " +
+               std::to_string(kMaxThreadCount);
+      return false;
+    }
+    out->count = static_cast<int>(value);
+  }
+
+  out->mode = AttrAsStr(threading, "mode", "auto");
+  if (out->mode != "auto" && out->mode != "frame" && out->mode != "slice" &&
+      out->mode != "none") {
+    *error = "threading.mode must be 'auto', 'frame', 'slice' or 'none'";
+    return false;
+  }
+
+  ThreadPlacement& placement = out->placement;
+  if (HasAttr(threading, "cpus")) {
+    Napi::Value cpus = threading.Get("cpus");
+    if (!cpus.IsArray()) {
+      *error = "threading.cpus must be an array of CPU indices";
+      return false;
+    }
+    Napi::Array list = cpus.As<Napi::Array>();
+    for (uint32_t i = 0; i < list.Length(); ++i) {
+      Napi::Value cpu = list.Get(i);
+      double value = cpu.IsNumber() ? cpu.As<Napi::Number>().DoubleValue()
+                                    : -1;
+      if (value < 0 || value > std::numeric_limits<int>::max() ||
+          value != static_cast<int>(value)) {
+        *error = "threading.cpus must be an array of CPU indices";
+        return false;
+      }
+      placement.cpus.push_back(static_cast<int>(value));
+    }
+  }
+
+  std::string priority = AttrAsStr(threading, "priority", "normal");
+  if (priority == "background") {
+    placement.priority = ThreadPriority::kBackground;
+  } else if (priority == "low") {
+    placement.priority = ThreadPriority::kLow;
+  } else if (priority == "high") {
+    placement.priority = ThreadPriority::kHigh;
+  } else if (priority != "normal") {
+    *error =
+        "threading.priority must be 'background', 'low', 'normal' or 'high'";
+    return false;
+  }
+
+  if (HasAttr(threading, "numaNode")) {
+    Napi::Value node = threading.Get("numaNode");
+    double value = node.IsNumber() ? node.As<Napi::Number>().DoubleValue()
+                                   : -1;
+    if (value < 0 || value >= kMaxNumaNodes ||
+        value != static_cast<int>(value)) {
+      *error = "threading.numaNode must be an integer between 0 and " +
+               std::to_string(kMaxNumaNodes - 1);
+      return false;
+    }
+    placement.numa_node = static_cast<int>(value);
+  }
+  return ValidateThreadPlacement(placement, error);
+}
+
+Napi::Object ThreadingConfigToObject(Napi::Env env,
+                                     const CodecThreadingConfig& threading) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("count", threading.count);
+  obj.Set("mode", threading.mode);
+  const ThreadPlacement& placement = threading.placement;
+  if (!placement.cpus.empty()) {
+    Napi::Array cpus = Napi::Array::New(env, placement.cpus.size());
+    for (size_t i = 0; i < placement.cpus.size(); ++i) {
+      cpus.Set(static_cast<uint32_t>(i), placement.cpus[i]);
+    }
+    obj.Set("cpus", cpus);
+  }
+  if (placement.priority != ThreadPriority::kNormal) {
+    obj.Set("priority", PriorityName(placement.priority));
+  }
+  if (placement.numa_node >= 0) {
+    obj.Set("numaNode", placement.numa_node);
+  }
+  return obj;
+}
+
+void ApplyThreadingConfig(AVCodecContext* ctx,
+                          const CodecThreadingConfig& threading) {
+  if (!threading.specified) {
+    return;
+  }
+  if (threading.mode == "none") {
+    ctx->thread_count = 1;
+    ctx->thread_type = 0;
+    return;
+  }
+  ctx->thread_count = threading.count;
+  if (threading.mode == "frame") {
+    ctx->thread_type = FF_THREAD_FRAME;
+  } else if (threading.mode == "slice") {
+    ctx->thread_type = FF_THREAD_SLICE;
+  } else {
+    ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+  }
+}
+
+//==============================================================================
+// Scaling Quality (node-webcodecs extension)
+//==============================================================================
+
+int ScalingConfig::SwsFlags() const {
+  // "pixelated" keeps hard pixel edges; "low" trades accuracy for speed, which
+  // suits same-size colour conversion; "high" is for visible downscales.
+  if (resize_quality == "pixelated") return SWS_POINT;
+  if (resize_quality == "low") return SWS_FAST_BILINEAR;
+  if (resize_quality == "high") return SWS_LANCZOS | SWS_ACCURATE_RND;
+  return SWS_BILINEAR;
+}
+
+bool ParseScalingConfig(Napi::Object config, ScalingConfig* out,
+                        std::string* error) {
+  *out = ScalingConfig();
+  out->resize_quality = AttrAsStr(config, "resizeQuality", "medium");
+  if (out->resize_quality != "pixelated" && out->resize_quality != "low" &&
+      out->resize_quality != "medium" && out->resize_quality != "high") {
+    *error = "resizeQuality must be 'pixelated', 'low', 'medium' or 'high'";
+    return false;
+  }
+
+  if (HasAttr(config, "scalingThreads")) {
+    Napi::Value threads = config.Get("scalingThreads");
+    double value = threads.IsNumber()
+                       ? threads.As<Napi::Number>().DoubleValue()
+                       : -1;
+    if (value < 0 || value > kMaxThreadCount ||
+        value != static_cast<int>(value)) {
+      *error = "scalingThreads must be an integer between 0 and " +
+               std::to_string(kMaxThreadCount);
+      return false;
+    }
+    out->threads = static_cast<int>(value);
+  }
+  return true;
+}
+
+//==============================================================================
+// Output Batching
+//==============================================================================
+
+bool ParseOutputBatchSize(Napi::Object config, int* out, std::string* error) {
+  *out = 1;
+  if (!HasAttr(config, "outputBatchSize")) {
+    return true;
+  }
+  Napi::Value batch = config.Get("outputBatchSize");
+  double value = batch.IsNumber() ? batch.As<Napi::Number>().DoubleValue() : 0;
+  if (value < 1 || value > kMaxOutputBatchSize ||
+      value != static_cast<int>(value)) {
+    *error = "outputBatchSize must be an integer between 1 and " +
+             std::to_string(kMaxOutputBatchSize);
+    return false;
+  }
+  *out = static_cast<int>(value);
+  return true;
+}
+
+//==============================================================================
+// Queue Limits (node-webcodecs extension)
+//==============================================================================
+
+bool ParseQueueLimits(Napi::Object config, QueueLimits* out,
+                      std::string* error) {
+  *out = QueueLimits();
+  if (HasAttr(config, "maxQueueSize")) {
+    Napi::Value size = config.Get("maxQueueSize");
+    double value = size.IsNumber() ? size.As<Napi::Number>().DoubleValue() : 0;
+    if (value < 1 || value > INT32_MAX || value != static_cast<int>(value)) {
+      *error = "maxQueueSize must be a positive integer";
+      return false;
+    }
+    out->max_size = static_cast<size_t>(value);
+  }
+  if (HasAttr(config, "maxQueueBytes")) {
+    Napi::Value bytes = config.Get("maxQueueBytes");
+    double value =
+        bytes.IsNumber() ? bytes.As<Napi::Number>().DoubleValue() : 0;
+    // Up to Number.MAX_SAFE_INTEGER
+    if (value < 1 || value > 9007199254740991.0 || value != std::floor(value)) {
+      *error = "maxQueueBytes must be a positive integer";
+      return false;
+    }
+    out->max_bytes = static_cast<size_t>(value);
+  }
+  if (HasAttr(config, "queuePolicy")) {
+    std::string policy = AttrAsStr(config, "queuePolicy");
+    if (policy == "reject") {
+      out->policy = QueuePolicy::kReject;
+    } else if (policy == "block") {
+      out->policy = QueuePolicy::kBlock;
+    } else if (policy == "drop-oldest-delta") {
+      out->policy = QueuePolicy::kDropOldestDelta;
+    } else {
+      *error =
+          "queuePolicy must be 'reject', 'block' or 'drop-oldest-delta'";
+      return false;
+    }
+  }
+  return true;
+}
+
+const char* QueuePolicyToString(QueuePolicy policy) {
+  switch (policy) {
+    case QueuePolicy::kBlock:
+      return "block";
+    case QueuePolicy::kDropOldestDelta:
+      return "drop-oldest-delta";
+    case QueuePolicy::kReject:
+    default:
+      return "reject";
+  }
+}
+
+bool CopyQueueLimits(Napi::Object config, Napi::Object normalized) {
+  QueueLimits limits;
+  std::string error;
+  if (!ParseQueueLimits(config, &limits, &error)) {
+    return false;
+  }
+  if (limits.max_size > 0) {
+    normalized.Set("maxQueueSize", static_cast<double>(limits.max_size));
+  }
+  if (limits.max_bytes > 0) {
+    normalized.Set("maxQueueBytes", static_cast<double>(limits.max_bytes));
+  }
+  if (HasAttr(config, "queuePolicy")) {
+    normalized.Set("queuePolicy", QueuePolicyToString(limits.policy));
+  }
+  return true;
+}
+
+//==============================================================================
+// Codec Statistics (node-webcodecs extension)
+//==============================================================================
+
+namespace {
+
+Napi::Object HistogramToObject(Napi::Env env,
+                               const LatencyHistogram::Snapshot& snapshot) {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("count", static_cast<double>(snapshot.count));
+  result.Set("meanUs", snapshot.MeanUs());
+  result.Set("p50Us", snapshot.PercentileUs(0.50));
+  result.Set("p90Us", snapshot.PercentileUs(0.90));
+  result.Set("p99Us", snapshot.PercentileUs(0.99));
+  result.Set("maxUs", static_cast<double>(snapshot.max_ns) / 1000.0);
+  return result;
+}
+
+}  // namespace
+
+Napi::Object CodecStatsToObject(Napi::Env env, const CodecStats& stats) {
+  using Stage = CodecStats::Stage;
+  Napi::Object result = Napi::Object::New(env);
+  for (Stage stage : {Stage::kQueueWait, Stage::kCodec, Stage::kConvert,
+                      Stage::kDelivery, Stage::kFrameLatency}) {
+    result.Set(CodecStats::StageName(stage),
+               HistogramToObject(env, stats.Histogram(stage).Read()));
+  }
+  result.Set("bytesCopied", static_cast<double>(stats.bytes_copied()));
+  return result;
+}
+
+//==============================================================================
+// Native Memory Accounting (node-webcodecs extension)
+//==============================================================================
+
+ExternalMemory::~ExternalMemory() {
+  if (bytes_ != 0) {
+    MemoryAccountant::Instance().Add(category_, -bytes_);
+    MemoryAccountant::DeferV8Release(bytes_);
+  }
+}
+
+void ExternalMemory::Set(Napi::Env env, int64_t bytes) {
+  int64_t delta = bytes - bytes_;
+  bytes_ = bytes;
+  if (delta != 0) {
+    MemoryAccountant::Instance().Add(category_, delta);
+  }
+  // One V8 call covers this change and any finalizer debt.
+  delta -= MemoryAccountant::TakeDeferredV8Release();
+  if (delta != 0) {
+    Napi::MemoryManagement::AdjustExternalMemory(env, delta);
+  }
+}
+
+void SettleExternalMemory(Napi::Env env) {
+  int64_t pending = MemoryAccountant::TakeDeferredV8Release();
+  if (pending != 0) {
+    Napi::MemoryManagement::AdjustExternalMemory(env, -pending);
+  }
+}
+
+Napi::Object MemoryUsageToObject(Napi::Env env) {
+  const MemoryAccountant& accountant = MemoryAccountant::Instance();
+  Napi::Object result = Napi::Object::New(env);
+  for (MemoryCategory category :
+       {MemoryCategory::kVideoFrames, MemoryCategory::kAudioData,
+        MemoryCategory::kEncodedChunks, MemoryCategory::kFramePool,
+        MemoryCategory::kCodecQueues}) {
+    result.Set(MemoryAccountant::CategoryName(category),
+               static_cast<double>(accountant.Bytes(category)));
+  }
+  result.Set("total", static_cast<double>(accountant.Total()));
+  result.Set("softLimit", static_cast<double>(accountant.soft_limit()));
+  return result;
+}
+
+//==============================================================================
+// Codec Lookup
+//==============================================================================
+
+const AVCodec* FindEncoder(AVCodecID codec_id) {
+  return CodecCapabilities::Instance().FindCodec(
+      "encoder-id:" + std::to_string(static_cast<int>(codec_id)),
+      [codec_id]() { return avcodec_find_encoder(codec_id); });
+}
+
+const AVCodec* FindDecoder(AVCodecID codec_id) {
+  return CodecCapabilities::Instance().FindCodec(
+      "decoder-id:" + std::to_string(static_cast<int>(codec_id)),
+      [codec_id]() { return avcodec_find_decoder(codec_id); });
+}
+
+const AVCodec* FindEncoderByName(const char* name) {
+  return CodecCapabilities::Instance().FindCodec(
+      std::string("encoder:") + name,
+      [name]() { return avcodec_find_encoder_by_name(name); });
+}
+
 //==============================================================================
 // Pixel Format Utilities
 //==============================================================================
@@ -435,19 +879,10 @@ void InitFFmpeg() {
 // FFmpeg Logging
 //==============================================================================
 
-// STATIC DESTRUCTION ORDER FIX: Use heap-allocated "immortal" objects to prevent
-// crashes during process exit. When vitest worker processes exit, static
-// destructors may run in unpredictable order, causing FFmpeg's log callback
-// to access destroyed mutex/queue. By never destroying these, we trade a tiny
-// memory leak at exit for crash-free shutdown.
-static std::queue<std::string>& GetWarningsQueue() {
-  static auto* queue = new std::queue<std::string>();
-  return *queue;
-}
-static std::mutex& GetWarningsMutex() {
-  static auto* mutex = new std::mutex();
-  return *mutex;
-}
+// Log lines are collected per thread without locks (shared/log_collector.h).
+// The collector is intentionally leaked, so a log line during process exit
+// never reaches a destroyed object; this flag also stops capture once
+// shutdown starts.
 static std::atomic<bool> ffmpegLoggingActive{false};
 
 void InitFFmpegLogging() {
@@ -460,20 +895,16 @@ void InitFFmpegLogging() {
       if (!ffmpegLoggingActive.load(std::memory_order_acquire)) {
         return;
       }
-      if (level <= AV_LOG_WARNING) {
-        char buf[1024];
-        vsnprintf(buf, sizeof(buf), fmt, vl);
-
+      // Filter by level before formatting anything.
+      if (level > AV_LOG_WARNING) {
+        return;
+      }
+      LogCollector::Instance().Add([&](char* buf, size_t size) {
+        vsnprintf(buf, size, fmt, vl);
         // Remove trailing newline
         size_t len = strlen(buf);
         if (len > 0 && buf[len - 1] == '\n') buf[len - 1] = '\0';
-
-        // Skip empty messages
-        if (strlen(buf) == 0) return;
-
-        std::lock_guard<std::mutex> lock(GetWarningsMutex());
-        GetWarningsQueue().push(buf);
-      }
+      });
     });
     av_log_set_level(AV_LOG_WARNING);
   });
@@ -493,22 +924,9 @@ void ShutdownFFmpegLogging() {
 }
 
 std::vector<std::string> GetFFmpegWarnings() {
-  std::lock_guard<std::mutex> lock(GetWarningsMutex());
-  std::vector<std::string> result;
-  auto& queue = GetWarningsQueue();
-  while (!queue.empty()) {
-    result.push_back(queue.front());
-    queue.pop();
-  }
-  return result;
+  return LogCollector::Instance().Drain();
 }
 
-void ClearFFmpegWarnings() {
-  std::lock_guard<std::mutex> lock(GetWarningsMutex());
-  auto& queue = GetWarningsQueue();
-  while (!queue.empty()) {
-    queue.pop();
-  }
-}
+void ClearFFmpegWarnings() { LogCollector::Instance().Clear(); }
 
 }  // namespace webcodecs
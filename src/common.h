@@ -21,6 +21,11 @@ extern "C" {
 #include <unordered_map>
 #include <vector>
 
+#include "src/shared/codec_capabilities.h"
+#include "src/shared/codec_stats.h"
+#include "src/shared/memory_accountant.h"
+#include "src/thread_placement.h"
+
 // Verify FFmpeg version compatibility
 #if LIBAVCODEC_VERSION_MAJOR < 59
 #error "FFmpeg 5.0+ (libavcodec 59+) is required"
@@ -51,6 +56,33 @@ bool AttrAsBool(Napi::Object obj, const std::string& attr, bool default_val);
 std::tuple<const uint8_t*, size_t> AttrAsBuffer(Napi::Object obj,
                                                 const std::string& attr);
 
+//==============================================================================
+// Interned Property Keys
+//==============================================================================
+
+// Property names read on every encode() and decode(). Each environment
+// creates the key strings once, so a lookup neither builds the name from
+// UTF-8 nor re-interns it, and reads the property with a single Get().
+enum class Key {
+  kKeyFrame,
+  kAvc,
+  kHevc,
+  kVp9,
+  kAv1,
+  kQuantizer,
+  kRegionsOfInterest,
+  kSkipOutput,
+  kNative,  // "_native"
+  kCount,
+};
+
+// Create this environment's keys. Called once from module init.
+void InitInternedKeys(Napi::Env env);
+// Property |key| of |obj|; undefined when absent.
+Napi::Value Attr(Napi::Object obj, Key key);
+bool AttrAsBool(Napi::Object obj, Key key, bool default_val);
+int32_t AttrAsInt32(Napi::Object obj, Key key, int32_t default_val);
+
 //==============================================================================
 // Template Enum Helpers
 //==============================================================================
@@ -102,6 +134,145 @@ Napi::Error FFmpegError(Napi::Env env, const std::string& operation,
                         int errnum);
 std::string FFmpegErrorString(int errnum);
 
+//==============================================================================
+// Codec Threading (node-webcodecs extension)
+//==============================================================================
+
+// FFmpeg threading for one codec instance, parsed from the non-standard
+// `threading: {count, mode, cpus, priority, numaNode}` config member.
+// count and mode are applied before avcodec_open2; the placement by the
+// worker thread when it starts.
+struct CodecThreadingConfig {
+  bool specified = false;    // Leave FFmpeg's defaults alone when false
+  int count = 0;             // 0 = one thread per core (FFmpeg auto)
+  std::string mode = "auto";  // "auto" | "frame" | "slice" | "none"
+  ThreadPlacement placement;
+};
+
+// Parse config.threading into |out|. Returns false and sets |error| when
+// the member is present but malformed.
+bool ParseThreadingConfig(Napi::Object config, CodecThreadingConfig* out,
+                          std::string* error);
+Napi::Object ThreadingConfigToObject(Napi::Env env,
+                                     const CodecThreadingConfig& threading);
+void ApplyThreadingConfig(AVCodecContext* ctx,
+                          const CodecThreadingConfig& threading);
+
+//==============================================================================
+// Scaling Quality (node-webcodecs extension)
+//==============================================================================
+
+// libswscale speed/quality for one caller's conversions, parsed from the
+// non-standard `resizeQuality` and `scalingThreads` members.
+struct ScalingConfig {
+  // "pixelated" | "low" | "medium" | "high", as in ImageBitmapOptions.
+  std::string resize_quality = "medium";
+  int threads = -1;  // Slice threads; 0 = one per core, -1 = caller default
+
+  // SwsKey::flags for resize_quality.
+  int SwsFlags() const;
+  int ThreadsOr(int fallback) const {
+    return threads >= 0 ? threads : fallback;
+  }
+};
+
+// Parse config.resizeQuality and config.scalingThreads into |out|. Returns
+// false and sets |error| when either is present but malformed.
+bool ParseScalingConfig(Napi::Object config, ScalingConfig* out,
+                        std::string* error);
+
+//==============================================================================
+// Output Batching (node-webcodecs extension)
+//==============================================================================
+
+constexpr int kMaxOutputBatchSize = 1024;
+
+// Parse config.outputBatchSize, the most outputs delivered to JS per event
+// loop wakeup (default 1). Returns false and sets |error| when present but
+// malformed.
+bool ParseOutputBatchSize(Napi::Object config, int* out, std::string* error);
+
+//==============================================================================
+// Queue Limits (node-webcodecs extension)
+//==============================================================================
+
+// What encode()/decode() does when a codec's queue is at its limit.
+enum class QueuePolicy {
+  kReject,           // Throw QuotaExceededError
+  kBlock,            // Report "full"; the JS layer parks the call
+  kDropOldestDelta,  // Drop the oldest queued delta work to make room
+};
+
+struct QueueLimits {
+  size_t max_size = 0;   // Queued messages; 0 uses the codec's default
+  size_t max_bytes = 0;  // Queued payload bytes; 0 is unlimited
+  QueuePolicy policy = QueuePolicy::kReject;
+};
+
+// Parse config.maxQueueSize, config.maxQueueBytes and config.queuePolicy.
+// Returns false and sets |error| when one is present but malformed.
+bool ParseQueueLimits(Napi::Object config, QueueLimits* out,
+                      std::string* error);
+const char* QueuePolicyToString(QueuePolicy policy);
+// Echo the queue limit members of |config| into |normalized| for
+// isConfigSupported(). Returns false when one is malformed.
+bool CopyQueueLimits(Napi::Object config, Napi::Object normalized);
+
+//==============================================================================
+// Codec Statistics (node-webcodecs extension)
+//==============================================================================
+
+// getStats() result: {queueWait, codec, convert, delivery, bytesCopied}, each
+// stage as {count, meanUs, p50Us, p90Us, p99Us, maxUs}.
+Napi::Object CodecStatsToObject(Napi::Env env, const CodecStats& stats);
+
+//==============================================================================
+// Native Memory Accounting (node-webcodecs extension)
+//==============================================================================
+
+// Native bytes owned by one JS-visible object (VideoFrame, AudioData,
+// encoded chunks), reported to the MemoryAccountant under |category| and to
+// V8 as external memory so the GC sees the real cost of the wrapper.
+//
+// Set()/Release() must run on the JS thread. The destructor does not call
+// N-API (unsafe during Node 24 teardown, see node-addon-api issue 1153):
+// it releases the accountant bytes at once and leaves the V8 side to the
+// next Set()/Release() on the same thread.
+class ExternalMemory {
+ public:
+  explicit ExternalMemory(MemoryCategory category) : category_(category) {}
+  ~ExternalMemory();
+
+  ExternalMemory(const ExternalMemory&) = delete;
+  ExternalMemory& operator=(const ExternalMemory&) = delete;
+
+  void Set(Napi::Env env, int64_t bytes);
+  void Release(Napi::Env env) { Set(env, 0); }
+
+  int64_t bytes() const { return bytes_; }
+
+ private:
+  MemoryCategory category_;
+  int64_t bytes_ = 0;
+};
+
+// Settle V8 external memory still reported for objects finalized without
+// close() on this thread.
+void SettleExternalMemory(Napi::Env env);
+
+// getMemoryUsage() result: bytes per category plus total and softLimit.
+Napi::Object MemoryUsageToObject(Napi::Env env);
+
+//==============================================================================
+// Codec Lookup
+//==============================================================================
+
+// avcodec_find_encoder/avcodec_find_decoder/avcodec_find_encoder_by_name,
+// memoised process-wide in CodecCapabilities. Safe from any thread.
+const AVCodec* FindEncoder(AVCodecID codec_id);
+const AVCodec* FindDecoder(AVCodecID codec_id);
+const AVCodec* FindEncoderByName(const char* name);
+
 //==============================================================================
 // Pixel Format Utilities
 //==============================================================================
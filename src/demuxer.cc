@@ -3,12 +3,228 @@
 
 #include "src/demuxer.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <limits>
 #include <string>
+#include <tuple>
+#include <utility>
 
 #include "src/common.h"
+#include "src/demuxer_input.h"
+#include "src/encoded_audio_chunk.h"
+#include "src/encoded_video_chunk.h"
+#include "src/mapped_file.h"
 
-Napi::FunctionReference Demuxer::constructor;
+namespace {
+
+// Packets prefetched by demuxAsync() before the reader pauses.
+constexpr size_t kDefaultRingCapacity = 64;
+
+// Downstream decodeQueueSize at which delivery and reading pause; matches
+// the decoders' default maxQueueDepth.
+constexpr int kDefaultDownstreamHighWaterMark = 16;
+
+// Parses an optional positive integer option, throwing TypeError otherwise.
+int PositiveIntOption(Napi::Env env, Napi::Object options,
+                      const std::string& name, int default_val) {
+  if (!webcodecs::HasAttr(options, name)) {
+    return default_val;
+  }
+  Napi::Value value = options.Get(name);
+  double number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : 0;
+  if (!std::isfinite(number) || number < 1 || number > 65536 ||
+      std::floor(number) != number) {
+    throw Napi::TypeError::New(env, name + " must be a positive integer");
+  }
+  return static_cast<int>(number);
+}
+
+// Parses open()'s optional options object.
+DemuxerOpenOptions ParseOpenOptions(Napi::Env env, Napi::Value value) {
+  DemuxerOpenOptions options;
+  if (value.IsUndefined() || value.IsNull()) {
+    return options;
+  }
+  if (!value.IsObject()) {
+    throw webcodecs::InvalidParameterError(env, "options", "object", value);
+  }
+  Napi::Object obj = value.As<Napi::Object>();
+
+  if (webcodecs::HasAttr(obj, "probeSize")) {
+    Napi::Value size = obj.Get("probeSize");
+    double number = size.IsNumber() ? size.As<Napi::Number>().DoubleValue() : 0;
+    // FFmpeg rejects anything under 32 bytes.
+    if (!std::isfinite(number) || number < 32) {
+      throw Napi::RangeError::New(env, "probeSize must be at least 32 bytes");
+    }
+    options.probe_size = static_cast<int64_t>(number);
+  }
+  if (webcodecs::HasAttr(obj, "analyzeDuration")) {
+    Napi::Value duration = obj.Get("analyzeDuration");
+    double number =
+        duration.IsNumber() ? duration.As<Napi::Number>().DoubleValue() : -1;
+    if (!std::isfinite(number) || number < 0) {
+      throw Napi::RangeError::New(env,
+                                  "analyzeDuration must be non-negative");
+    }
+    options.analyze_duration = static_cast<int64_t>(number);
+  }
+  options.trust_container_header =
+      webcodecs::AttrAsBool(obj, "trustContainerHeader", false);
+  options.memory_map = webcodecs::AttrAsBool(obj, "memoryMap", false);
+
+  if (webcodecs::HasAttr(obj, "tracks")) {
+    Napi::Value tracks_val = obj.Get("tracks");
+    if (!tracks_val.IsArray()) {
+      throw webcodecs::InvalidParameterError(env, "tracks", "array of tracks",
+                                             tracks_val);
+    }
+    Napi::Array tracks = tracks_val.As<Napi::Array>();
+    for (uint32_t i = 0; i < tracks.Length(); ++i) {
+      Napi::Value track_val = tracks.Get(i);
+      if (!track_val.IsObject()) {
+        throw webcodecs::InvalidParameterError(env, "tracks", "TrackInfo",
+                                               track_val);
+      }
+      Napi::Object track_obj = track_val.As<Napi::Object>();
+      TrackInfo track;
+      track.index = webcodecs::AttrAsInt32(track_obj, "index", -1);
+      track.type = webcodecs::AttrAsStr(track_obj, "type", "");
+      track.codec = webcodecs::AttrAsStr(track_obj, "codec", "");
+      track.width = webcodecs::AttrAsInt32(track_obj, "width", 0);
+      track.height = webcodecs::AttrAsInt32(track_obj, "height", 0);
+      track.sample_rate = webcodecs::AttrAsInt32(track_obj, "sampleRate", 0);
+      track.channels = webcodecs::AttrAsInt32(track_obj, "channels", 0);
+      if (webcodecs::HasAttr(track_obj, "extradata")) {
+        auto [data, size] = webcodecs::AttrAsBuffer(track_obj, "extradata");
+        if (data && size > 0) {
+          track.extradata.assign(data, data + size);
+        }
+      }
+      options.tracks.push_back(std::move(track));
+    }
+  }
+  return options;
+}
+
+const char* CodecName(AVCodecID codec_id) {
+  const AVCodecDescriptor* desc = avcodec_descriptor_get(codec_id);
+  return desc ? desc->name : "unknown";
+}
+
+// Codecs whose decoders need the container's out-of-band configuration.
+bool NeedsExtradata(AVCodecID codec_id) {
+  switch (codec_id) {
+    case AV_CODEC_ID_H264:
+    case AV_CODEC_ID_HEVC:
+    case AV_CODEC_ID_AAC:
+    case AV_CODEC_ID_VORBIS:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Whether an MP4 or Matroska header alone describes every audio and video
+// stream well enough to decode, so avformat_find_stream_info() can be
+// skipped. Other containers leave too much to probing.
+bool HeaderIsComplete(const AVFormatContext* ctx) {
+  const char* name = ctx->iformat ? ctx->iformat->name : "";
+  if (std::strncmp(name, "mov,", 4) != 0 &&
+      std::strncmp(name, "matroska", 8) != 0) {
+    return false;
+  }
+  for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+    const AVCodecParameters* par = ctx->streams[i]->codecpar;
+    if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+      if (par->width <= 0 || par->height <= 0) {
+        return false;
+      }
+    } else if (par->codec_type == AVMEDIA_TYPE_AUDIO) {
+      if (par->sample_rate <= 0 || par->ch_layout.nb_channels <= 0) {
+        return false;
+      }
+    } else {
+      continue;
+    }
+    if (par->codec_id == AV_CODEC_ID_NONE ||
+        (NeedsExtradata(par->codec_id) && par->extradata_size <= 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fills in codec parameters |ctx|'s header left out from |tracks|, saved
+// from an earlier open. Returns false, before changing anything, unless
+// there is exactly one track for each audio and video stream and its type
+// and codec match.
+bool ApplyCachedTracks(AVFormatContext* ctx,
+                       const std::vector<TrackInfo>& tracks) {
+  if (tracks.empty()) {
+    return false;
+  }
+  std::vector<bool> seen(ctx->nb_streams, false);
+  for (const TrackInfo& track : tracks) {
+    if (track.index < 0 || track.index >= static_cast<int>(ctx->nb_streams) ||
+        seen[track.index]) {
+      return false;
+    }
+    seen[track.index] = true;
+    const AVCodecParameters* par = ctx->streams[track.index]->codecpar;
+    const char* type = par->codec_type == AVMEDIA_TYPE_VIDEO   ? "video"
+                       : par->codec_type == AVMEDIA_TYPE_AUDIO ? "audio"
+                                                               : "";
+    if (track.type != type || track.codec != CodecName(par->codec_id)) {
+      return false;
+    }
+  }
+  for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+    AVMediaType type = ctx->streams[i]->codecpar->codec_type;
+    if (!seen[i] &&
+        (type == AVMEDIA_TYPE_VIDEO || type == AVMEDIA_TYPE_AUDIO)) {
+      return false;
+    }
+  }
+
+  for (const TrackInfo& track : tracks) {
+    AVCodecParameters* par = ctx->streams[track.index]->codecpar;
+    if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+      if (par->width <= 0 || par->height <= 0) {
+        par->width = track.width;
+        par->height = track.height;
+      }
+    } else {
+      if (par->sample_rate <= 0) {
+        par->sample_rate = track.sample_rate;
+      }
+      if (par->ch_layout.nb_channels <= 0 && track.channels > 0) {
+        av_channel_layout_uninit(&par->ch_layout);
+        av_channel_layout_default(&par->ch_layout, track.channels);
+      }
+    }
+    if (par->extradata_size <= 0 && !track.extradata.empty()) {
+      size_t size = track.extradata.size();
+      auto* extradata = static_cast<uint8_t*>(
+          av_mallocz(size + AV_INPUT_BUFFER_PADDING_SIZE));
+      if (!extradata) {
+        continue;  // The decoder may still find it in-band.
+      }
+      std::memcpy(extradata, track.extradata.data(), size);
+      av_freep(&par->extradata);
+      par->extradata = extradata;
+      par->extradata_size = static_cast<int>(size);
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// Per-thread constructor reference; see the class declaration.
+thread_local Napi::FunctionReference Demuxer::constructor;
 
 Napi::Object InitDemuxer(Napi::Env env, Napi::Object exports) {
   return Demuxer::Init(env, exports);
@@ -21,6 +237,17 @@ Napi::Object Demuxer::Init(Napi::Env env, Napi::Object exports) {
                       InstanceMethod("open", &Demuxer::Open),
                       InstanceMethod("demux", &Demuxer::DemuxPackets),
                       InstanceMethod("demuxPackets", &Demuxer::DemuxPackets),
+                      InstanceMethod("demuxAsync", &Demuxer::DemuxAsync),
+                      InstanceMethod("setDownstreamQueueSize",
+                                     &Demuxer::SetDownstreamQueueSize),
+                      InstanceMethod("pushReadResult",
+                                     &Demuxer::PushReadResult),
+                      InstanceMethod("seek", &Demuxer::Seek),
+                      InstanceMethod("buildKeyframeIndex",
+                                     &Demuxer::BuildKeyframeIndex),
+                      InstanceMethod("loadKeyframeIndex",
+                                     &Demuxer::LoadKeyframeIndex),
+                      InstanceMethod("selectTracks", &Demuxer::SelectTracks),
                       InstanceMethod("close", &Demuxer::Close),
                       InstanceMethod("getVideoTrack", &Demuxer::GetVideoTrack),
                       InstanceMethod("getAudioTrack", &Demuxer::GetAudioTrack),
@@ -62,10 +289,25 @@ Demuxer::Demuxer(const Napi::CallbackInfo& info)
 Demuxer::~Demuxer() { Cleanup(); }
 
 void Demuxer::Cleanup() {
+  StopReader();
+  {
+    // Opened by a callback open() that close() abandoned.
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    if (opened_context_) {
+      avformat_close_input(&opened_context_);
+    }
+  }
+  // The format context reads through input_, so it goes first.
   format_context_.reset();
+  input_.reset();
+  read_tsfn_.Release();
+  keyframe_index_ = webcodecs::KeyframeIndex();
+  scanned_index_ = webcodecs::KeyframeIndex();
+  seek_target_us_ = AV_NOPTS_VALUE;
   tracks_.clear();
   video_stream_index_ = -1;
   audio_stream_index_ = -1;
+  selected_streams_.clear();
 
   // Clear callback references
   on_track_callback_.Reset();
@@ -76,27 +318,312 @@ void Demuxer::Cleanup() {
 Napi::Value Demuxer::Open(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  if (info.Length() < 1 || !info[0].IsString()) {
-    throw webcodecs::InvalidParameterError(env, "path", "string", info[0]);
+  if (info.Length() < 1) {
+    throw webcodecs::InvalidParameterError(
+        env, "source", "string, BufferSource or object", env.Undefined());
+  }
+  if (async_active_ || task_active_) {
+    throw Napi::Error::New(env, "InvalidStateError: Demuxer is busy");
   }
+  DemuxerOpenOptions options =
+      ParseOpenOptions(env, info.Length() > 1 ? info[1] : env.Undefined());
 
-  std::string path = info[0].As<Napi::String>().Utf8Value();
+  // Reopening replaces the previous input.
+  format_context_.reset();
+  input_.reset();
+  read_tsfn_.Release();
+  keyframe_index_ = webcodecs::KeyframeIndex();
+  seek_target_us_ = AV_NOPTS_VALUE;
+  tracks_.clear();
 
-  // Open input file.
-  AVFormatContext* raw_ctx = nullptr;
-  int ret = avformat_open_input(&raw_ctx, path.c_str(), nullptr, nullptr);
+  Napi::Value source = info[0];
+  std::string path;
+  if (source.IsString()) {
+    path = source.As<Napi::String>().Utf8Value();
+    if (options.memory_map) {
+      std::string error;
+      auto file = webcodecs::MappedFile::Open(path, 0, &error);
+      if (!file) {
+        throw Napi::Error::New(env, "Failed to map " + path + ": " + error);
+      }
+      input_ = webcodecs::DemuxerInput::FromMapping(std::move(file));
+      if (!input_) {
+        throw webcodecs::FFmpegError(env, "allocate input", AVERROR(ENOMEM));
+      }
+    }
+  } else if (source.IsBuffer() || source.IsArrayBuffer() ||
+             source.IsTypedArray()) {
+    Napi::Object holder = Napi::Object::New(env);
+    holder.Set("data", source);
+    auto [data, size] = webcodecs::AttrAsBuffer(holder, "data");
+    input_ = webcodecs::DemuxerInput::FromMemory(data, size);
+    if (!input_) {
+      throw webcodecs::FFmpegError(env, "allocate input", AVERROR(ENOMEM));
+    }
+  } else if (source.IsObject() &&
+             source.As<Napi::Object>().Get("read").IsFunction()) {
+    return OpenFromCallback(env, source.As<Napi::Object>(),
+                            std::move(options));
+  } else {
+    throw webcodecs::InvalidParameterError(
+        env, "source", "string, BufferSource or object", source);
+  }
+
+  AVFormatContext* raw_ctx = AllocFormatContext();
+  if (!raw_ctx) {
+    input_.reset();
+    throw webcodecs::FFmpegError(env, "allocate format context",
+                                 AVERROR(ENOMEM));
+  }
+  const char* failed_op = nullptr;
+  // A mapped path still passes its name, which format probing scores.
+  int ret = OpenFormatContext(&raw_ctx, path.empty() ? nullptr : path.c_str(),
+                              options, &failed_op);
   if (ret < 0) {
-    throw webcodecs::FFmpegError(env, "open file", ret);
+    Cleanup();
+    throw webcodecs::FFmpegError(env, failed_op, ret);
   }
   format_context_.reset(raw_ctx);
 
-  // Find stream info.
-  ret = avformat_find_stream_info(format_context_.get(), nullptr);
+  EnumerateTracks(env);
+  return env.Undefined();
+}
+
+AVFormatContext* Demuxer::AllocFormatContext() {
+  AVFormatContext* ctx = avformat_alloc_context();
+  if (!ctx) {
+    return nullptr;
+  }
+  // The interrupt callback lets close() abort a read blocked on the
+  // demuxAsync() reader thread.
+  ctx->interrupt_callback.callback = &Demuxer::InterruptCallback;
+  ctx->interrupt_callback.opaque = this;
+  if (input_) {
+    ctx->pb = input_->avio();
+    ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+  }
+  return ctx;
+}
+
+int Demuxer::OpenFormatContext(AVFormatContext** ctx, const char* url,
+                               const DemuxerOpenOptions& options,
+                               const char** failed_op) {
+  AVDictionary* format_options = nullptr;
+  if (options.probe_size > 0) {
+    av_dict_set_int(&format_options, "probesize", options.probe_size, 0);
+  }
+  if (options.analyze_duration >= 0) {
+    av_dict_set_int(&format_options, "analyzeduration",
+                    options.analyze_duration, 0);
+  }
+  int ret = avformat_open_input(ctx, url, nullptr, &format_options);
+  av_dict_free(&format_options);
+  if (ret < 0) {
+    // avformat_open_input() frees the context on failure.
+    *failed_op = url ? "open file" : "open input";
+    return ret;
+  }
+
+  // avformat_find_stream_info() decodes the first frames of every stream,
+  // which costs reads and time that a known or self-describing input does
+  // not need.
+  if (ApplyCachedTracks(*ctx, options.tracks) ||
+      (options.trust_container_header && HeaderIsComplete(*ctx))) {
+    return 0;
+  }
+  ret = avformat_find_stream_info(*ctx, nullptr);
   if (ret < 0) {
-    Cleanup();
-    throw webcodecs::FFmpegError(env, "find stream info", ret);
+    avformat_close_input(ctx);
+    *failed_op = "find stream info";
+    return ret;
+  }
+  return 0;
+}
+
+Napi::Value Demuxer::OpenFromCallback(Napi::Env env, Napi::Object source,
+                                      DemuxerOpenOptions options) {
+  int64_t size = -1;
+  if (webcodecs::HasAttr(source, "size")) {
+    Napi::Value size_val = source.Get("size");
+    if (!size_val.IsNumber() || size_val.As<Napi::Number>().Int64Value() < 0) {
+      throw webcodecs::InvalidParameterError(env, "source.size",
+                                             "non-negative number", size_val);
+    }
+    size = size_val.As<Napi::Number>().Int64Value();
+  }
+
+  // Reads run on the open/reader thread and are forwarded to source.read()
+  // on the JS thread; pushReadResult() answers them.
+  read_tsfn_.Init(ReadTSFN::TSFN::New(env, source.Get("read").As<Napi::Function>(),
+                                      "DemuxerRead", 0, 1, this));
+  auto* self = this;
+  input_ = webcodecs::DemuxerInput::FromCallback(
+      [self](uint64_t id, int64_t offset, int length) {
+        auto* request = new ReadRequest{id, offset, length};
+        if (!self->read_tsfn_.Call(request)) {
+          delete request;
+          return false;
+        }
+        return true;
+      },
+      size);
+  AVFormatContext* raw_ctx = input_ ? AllocFormatContext() : nullptr;
+  if (!raw_ctx) {
+    input_.reset();
+    read_tsfn_.Release();
+    throw webcodecs::FFmpegError(env, "allocate input", AVERROR(ENOMEM));
+  }
+
+  // Probing reads block on JS, so it cannot happen on this thread.
+  return RunOnReader(
+      env,
+      [this, raw_ctx, options = std::move(options)]() mutable {
+        const char* failed_op = nullptr;
+        int ret = OpenFormatContext(&raw_ctx, nullptr, options, &failed_op);
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        opened_context_ = ret < 0 ? nullptr : raw_ctx;
+        open_failed_op_ = failed_op;
+        return ret;
+      },
+      [this](Napi::Env env, int ret, Napi::Promise::Deferred& deferred) {
+        AVFormatContext* ctx;
+        const char* failed_op;
+        {
+          std::lock_guard<std::mutex> lock(reader_mutex_);
+          ctx = opened_context_;
+          opened_context_ = nullptr;
+          failed_op = open_failed_op_;
+        }
+        if (ret < 0 || !ctx) {
+          input_.reset();
+          read_tsfn_.Release();
+          deferred.Reject(webcodecs::FFmpegError(
+                              env, failed_op ? failed_op : "open input", ret)
+                              .Value());
+          return;
+        }
+        format_context_.reset(ctx);
+        EnumerateTracks(env);
+        deferred.Resolve(env.Undefined());
+      });
+}
+
+Napi::Value Demuxer::RunOnReader(Napi::Env env, std::function<int()> task,
+                                 TaskFinish finish) {
+  // The completion callback ignores its JS function. Holding a reference
+  // keeps this object alive until the TSFN finalizer runs.
+  auto done_fn = Napi::Function::New(env, [](const Napi::CallbackInfo&) {});
+  task_tsfn_.Init(TaskTSFN::TSFN::New(env, done_fn, "DemuxerTask", 0, 1, this,
+                                      &Demuxer::UnrefOnFinalize));
+  Ref();
+
+  {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    reader_stop_ = false;
+    task_result_ = 0;
+  }
+  task_finish_ = std::move(finish);
+  task_deferred_ = std::make_unique<Napi::Promise::Deferred>(
+      Napi::Promise::Deferred::New(env));
+  Napi::Promise promise = task_deferred_->Promise();
+  task_active_ = true;
+
+  reader_thread_ = std::thread([this, task = std::move(task)]() {
+    int ret = task();
+    {
+      std::lock_guard<std::mutex> lock(reader_mutex_);
+      task_result_ = ret;
+    }
+    // task_tsfn_ is only released by FinishTask(), so this always lands.
+    (void)task_tsfn_.Call(nullptr);
+  });
+  return promise;
+}
+
+void Demuxer::OnTaskComplete(Napi::Env env, Napi::Function, Demuxer* context,
+                             std::nullptr_t*) {
+  if (env == nullptr || context == nullptr) {
+    return;
+  }
+  context->FinishTask(env);
+}
+
+void Demuxer::FinishTask(Napi::Env env) {
+  if (reader_thread_.joinable()) {
+    reader_thread_.join();
   }
+  task_tsfn_.Release();
+  task_active_ = false;
 
+  int ret;
+  {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    ret = task_result_;
+  }
+  TaskFinish finish = std::move(task_finish_);
+  task_finish_ = nullptr;
+  std::unique_ptr<Napi::Promise::Deferred> deferred =
+      std::move(task_deferred_);
+  if (!deferred) {
+    return;  // close() already rejected the task and released its state.
+  }
+  try {
+    finish(env, ret, *deferred);
+  } catch (const Napi::Error& e) {
+    deferred->Reject(e.Value());
+  }
+}
+
+void Demuxer::OnReadRequest(Napi::Env env, Napi::Function fn,
+                            Demuxer* context, ReadRequest* request) {
+  if (env == nullptr || context == nullptr) {
+    delete request;
+    return;
+  }
+  uint64_t id = request->id;
+  try {
+    fn.Call({Napi::Number::New(env, static_cast<double>(id)),
+             Napi::Number::New(env, static_cast<double>(request->offset)),
+             Napi::Number::New(env, request->length)});
+  } catch (const Napi::Error&) {
+    if (context->input_) {
+      context->input_->Respond(id, nullptr, 0, AVERROR(EIO));
+    }
+  }
+  delete request;
+}
+
+Napi::Value Demuxer::PushReadResult(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    throw webcodecs::InvalidParameterError(env, "id", "number", info[0]);
+  }
+  if (!input_ || !input_->blocking()) {
+    return env.Undefined();  // Closed; the read was already abandoned.
+  }
+  auto id = static_cast<uint64_t>(info[0].As<Napi::Number>().DoubleValue());
+
+  // null or an empty buffer marks the end of the input.
+  Napi::Value data_val = info.Length() > 1 ? info[1] : env.Undefined();
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  if (data_val.IsBuffer() || data_val.IsArrayBuffer() ||
+      data_val.IsTypedArray()) {
+    Napi::Object holder = Napi::Object::New(env);
+    holder.Set("data", data_val);
+    std::tie(data, size) = webcodecs::AttrAsBuffer(holder, "data");
+  } else if (!data_val.IsNull() && !data_val.IsUndefined()) {
+    throw webcodecs::InvalidParameterError(env, "data", "BufferSource",
+                                           data_val);
+  }
+  bool failed = info.Length() > 2 && info[2].ToBoolean().Value();
+
+  input_->Respond(id, data, size, failed ? AVERROR(EIO) : 0);
+  return env.Undefined();
+}
+
+void Demuxer::EnumerateTracks(Napi::Env env) {
   // Enumerate tracks.
   for (unsigned int i = 0; i < format_context_->nb_streams; i++) {
     AVStream* stream = format_context_.get()->streams[i];
@@ -113,7 +640,6 @@ Napi::Value Demuxer::Open(const Napi::CallbackInfo& info) {
       track.type = "video";
       track.width = codecpar->width;
       track.height = codecpar->height;
-      video_stream_index_ = i;
 
       const AVCodecDescriptor* desc =
           avcodec_descriptor_get(codecpar->codec_id);
@@ -127,7 +653,6 @@ Napi::Value Demuxer::Open(const Napi::CallbackInfo& info) {
       track.type = "audio";
       track.sample_rate = codecpar->sample_rate;
       track.channels = codecpar->ch_layout.nb_channels;
-      audio_stream_index_ = i;
 
       const AVCodecDescriptor* desc =
           avcodec_descriptor_get(codecpar->codec_id);
@@ -145,6 +670,78 @@ Napi::Value Demuxer::Open(const Napi::CallbackInfo& info) {
     EmitTrack(env, track);
   }
 
+  // By default one video and one audio stream are delivered, as picked by
+  // FFmpeg (the container's default or the best quality one).
+  AVFormatContext* ctx = format_context_.get();
+  video_stream_index_ =
+      std::max(av_find_best_stream(ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0),
+               -1);
+  audio_stream_index_ =
+      std::max(av_find_best_stream(ctx, AVMEDIA_TYPE_AUDIO, -1,
+                                   video_stream_index_, nullptr, 0),
+               -1);
+  std::vector<int> defaults;
+  for (int index : {video_stream_index_, audio_stream_index_}) {
+    if (index >= 0) {
+      defaults.push_back(index);
+    }
+  }
+  SelectStreams(defaults);
+}
+
+void Demuxer::SelectStreams(const std::vector<int>& indices) {
+  AVFormatContext* ctx = format_context_.get();
+  selected_streams_.assign(ctx->nb_streams, false);
+  for (int index : indices) {
+    selected_streams_[index] = true;
+  }
+  for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+    ctx->streams[i]->discard =
+        selected_streams_[i] ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+  }
+}
+
+bool Demuxer::IsSelected(int stream_index) const {
+  return stream_index >= 0 &&
+         stream_index < static_cast<int>(selected_streams_.size()) &&
+         selected_streams_[stream_index];
+}
+
+Napi::Value Demuxer::SelectTracks(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!format_context_) {
+    throw Napi::Error::New(env, "InvalidStateError: Demuxer not opened");
+  }
+  if (async_active_ || task_active_) {
+    throw Napi::Error::New(env, "InvalidStateError: Demuxer is busy");
+  }
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    throw webcodecs::InvalidParameterError(
+        env, "tracks", "array of track indices",
+        info.Length() > 0 ? info[0] : env.Undefined());
+  }
+
+  Napi::Array tracks = info[0].As<Napi::Array>();
+  std::vector<int> indices;
+  for (uint32_t i = 0; i < tracks.Length(); ++i) {
+    Napi::Value value = tracks.Get(i);
+    if (!value.IsNumber()) {
+      throw webcodecs::InvalidParameterError(env, "tracks", "track index",
+                                             value);
+    }
+    int index = value.As<Napi::Number>().Int32Value();
+    bool known = std::any_of(
+        tracks_.begin(), tracks_.end(),
+        [index](const TrackInfo& track) { return track.index == index; });
+    if (!known) {
+      throw Napi::RangeError::New(
+          env, "Track " + std::to_string(index) +
+                   " is not an audio or video track");
+    }
+    indices.push_back(index);
+  }
+  SelectStreams(indices);
   return env.Undefined();
 }
 
@@ -181,62 +778,549 @@ Napi::Value Demuxer::DemuxPackets(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  int max_packets = 0;  // 0 = unlimited (backwards compatible)
-  if (info.Length() > 0 && info[0].IsNumber()) {
-    max_packets = info[0].As<Napi::Number>().Int32Value();
+  if (async_active_ || task_active_) {
+    Napi::Error::New(env, "InvalidStateError: demuxAsync() is in progress")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
   }
 
-  ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
-  if (!packet) {
-    Napi::Error::New(env, "Failed to allocate packet")
+  // Callback inputs wait for JS to supply bytes; reading them here would
+  // deadlock the event loop.
+  if (input_ && input_->blocking()) {
+    Napi::Error::New(env,
+                     "InvalidStateError: Streaming sources must be read "
+                     "with demuxAsync()")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
+  int max_packets = 0;  // 0 = unlimited (backwards compatible)
+  if (info.Length() > 0 && info[0].IsNumber()) {
+    max_packets = info[0].As<Napi::Number>().Int32Value();
+  }
+
   int packets_read = 0;
-  while ((max_packets == 0 || packets_read < max_packets) &&
-         av_read_frame(format_context_.get(), packet.get()) >= 0) {
-    if (packet->stream_index == video_stream_index_ ||
-        packet->stream_index == audio_stream_index_) {
-      EmitChunk(env, packet.get(), packet->stream_index);
+  while (max_packets == 0 || packets_read < max_packets) {
+    // Each chunk keeps its packet, so read into a fresh one every time.
+    ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
+    if (!packet) {
+      Napi::Error::New(env, "Failed to allocate packet")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (av_read_frame(format_context_.get(), packet.get()) < 0) {
+      break;
+    }
+    if (ShouldEmit(packet.get())) {
+      EmitChunk(env, std::move(packet));
       packets_read++;
     }
-    av_packet_unref(packet.get());
   }
 
   return Napi::Number::New(env, packets_read);
 }
 
-void Demuxer::EmitChunk(Napi::Env env, AVPacket* packet, int track_index) {
+void Demuxer::EmitChunk(Napi::Env env, ffmpeg::AVPacketPtr packet) {
   if (on_chunk_callback_.IsEmpty()) return;
 
-  // Create EncodedVideoChunk-compatible object.
-  Napi::Object chunk = Napi::Object::New(env);
-
+  int track_index = packet->stream_index;
   bool is_key = (packet->flags & AV_PKT_FLAG_KEY) != 0;
-  chunk.Set("type", Napi::String::New(env, is_key ? "key" : "delta"));
+  std::string type = is_key ? "key" : "delta";
 
   AVStream* stream = format_context_.get()->streams[track_index];
   int64_t timestamp_us =
       av_rescale_q(packet->pts, stream->time_base, {1, 1000000});
-  chunk.Set("timestamp",
-            Napi::Number::New(env, static_cast<double>(timestamp_us)));
-
   int64_t duration_us =
       av_rescale_q(packet->duration, stream->time_base, {1, 1000000});
-  chunk.Set("duration",
-            Napi::Number::New(env, static_cast<double>(duration_us)));
+  // Keep container DTS so reordered video can be remuxed as is.
+  int64_t decode_timestamp_us =
+      packet->dts == AV_NOPTS_VALUE
+          ? EncodedVideoChunk::kNoDecodeTimestamp
+          : av_rescale_q(packet->dts, stream->time_base, {1, 1000000});
 
-  Napi::Buffer<uint8_t> data =
-      Napi::Buffer<uint8_t>::Copy(env, packet->data, packet->size);
-  chunk.Set("data", data);
+  // The chunk adopts the demuxed packet, so its payload reaches the decoder
+  // without being copied.
+  Napi::Object chunk =
+      stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO
+          ? EncodedAudioChunk::CreateInstance(env, type, timestamp_us,
+                                              duration_us, std::move(packet))
+          : EncodedVideoChunk::CreateInstance(env, type, timestamp_us,
+                                              duration_us, std::move(packet),
+                                              decode_timestamp_us);
 
   on_chunk_callback_.Call({chunk, Napi::Number::New(env, track_index)});
 }
 
+bool Demuxer::ShouldEmit(const AVPacket* packet) const {
+  if (!IsSelected(packet->stream_index)) {
+    return false;
+  }
+  // Video before a precise target is still needed to decode up to it;
+  // audio frames that end before it are not.
+  AVStream* stream = format_context_.get()->streams[packet->stream_index];
+  if (stream->codecpar->codec_type != AVMEDIA_TYPE_AUDIO ||
+      seek_target_us_ == AV_NOPTS_VALUE || packet->pts == AV_NOPTS_VALUE) {
+    return true;
+  }
+  int64_t end_us = av_rescale_q(packet->pts + packet->duration,
+                                stream->time_base, {1, 1000000});
+  return end_us > seek_target_us_;
+}
+
+Napi::Value Demuxer::Seek(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!format_context_) {
+    throw Napi::Error::New(env, "InvalidStateError: Demuxer not opened");
+  }
+  if (async_active_ || task_active_) {
+    throw Napi::Error::New(env, "InvalidStateError: Demuxer is busy");
+  }
+  if (info.Length() < 1 || !info[0].IsNumber() ||
+      !std::isfinite(info[0].As<Napi::Number>().DoubleValue())) {
+    throw webcodecs::InvalidParameterError(env, "timestamp", "finite number",
+                                           info.Length() > 0
+                                               ? info[0]
+                                               : env.Undefined());
+  }
+  auto timestamp_us = static_cast<int64_t>(
+      std::llround(info[0].As<Napi::Number>().DoubleValue()));
+
+  bool precise = false;
+  if (info.Length() > 1 && info[1].IsObject()) {
+    std::string mode =
+        webcodecs::AttrAsStr(info[1].As<Napi::Object>(), "mode", "keyframe");
+    if (mode != "keyframe" && mode != "precise") {
+      throw Napi::TypeError::New(env,
+                                 "mode must be 'keyframe' or 'precise'");
+    }
+    precise = mode == "precise";
+  }
+
+  if (!input_ || !input_->blocking()) {
+    int ret = SeekTo(timestamp_us, precise);
+    if (ret < 0) {
+      throw webcodecs::FFmpegError(env, "seek", ret);
+    }
+    return env.Undefined();
+  }
+  return RunOnReader(
+      env, [this, timestamp_us, precise]() {
+        return SeekTo(timestamp_us, precise);
+      },
+      [](Napi::Env env, int ret, Napi::Promise::Deferred& deferred) {
+        if (ret < 0) {
+          deferred.Reject(webcodecs::FFmpegError(env, "seek", ret).Value());
+        } else {
+          deferred.Resolve(env.Undefined());
+        }
+      });
+}
+
+int Demuxer::SeekTo(int64_t timestamp_us, bool precise) {
+  AVFormatContext* ctx = format_context_.get();
+  const webcodecs::KeyframeEntry* entry = nullptr;
+  if (!keyframe_index_.empty()) {
+    int64_t ts = av_rescale_q(timestamp_us, {1, 1000000},
+                              keyframe_index_.time_base());
+    entry = precise ? keyframe_index_.FindAtOrBefore(ts)
+                    : keyframe_index_.FindNearest(ts);
+  }
+
+  int ret;
+  if (entry) {
+    // Jump straight to the indexed keyframe. A byte seek skips the
+    // container's own timestamp search entirely where it is supported.
+    int stream_index = keyframe_index_.stream_index();
+    if (entry->position >= 0 && !(ctx->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+      ret = av_seek_frame(ctx, stream_index, entry->position,
+                          AVSEEK_FLAG_BYTE);
+    } else {
+      ret = avformat_seek_file(ctx, stream_index,
+                               std::numeric_limits<int64_t>::min(),
+                               entry->timestamp, entry->timestamp, 0);
+    }
+  } else {
+    // stream_index -1 takes AV_TIME_BASE (microsecond) timestamps.
+    int64_t max_ts =
+        precise ? timestamp_us : std::numeric_limits<int64_t>::max();
+    ret = avformat_seek_file(ctx, -1, std::numeric_limits<int64_t>::min(),
+                             timestamp_us, max_ts, 0);
+  }
+  if (ret < 0) {
+    return ret;
+  }
+  seek_target_us_ = precise ? timestamp_us : AV_NOPTS_VALUE;
+  return 0;
+}
+
+int Demuxer::IndexStreamIndex() const {
+  // Unselected streams are discarded, so a scan would see none of their
+  // packets. Prefer the default video stream, then any selected video
+  // stream, then the first selected stream.
+  if (IsSelected(video_stream_index_)) {
+    return video_stream_index_;
+  }
+  int fallback = -1;
+  for (const TrackInfo& track : tracks_) {
+    if (!IsSelected(track.index)) {
+      continue;
+    }
+    if (track.type == "video") {
+      return track.index;
+    }
+    if (fallback < 0) {
+      fallback = track.index;
+    }
+  }
+  return fallback;
+}
+
+int Demuxer::ScanKeyframes(webcodecs::KeyframeIndex* index) {
+  AVFormatContext* ctx = format_context_.get();
+  int stream_index = IndexStreamIndex();
+  if (stream_index < 0) {
+    return AVERROR_STREAM_NOT_FOUND;
+  }
+  AVStream* stream = ctx->streams[stream_index];
+  *index = webcodecs::KeyframeIndex(stream_index, stream->time_base);
+
+  // MP4, Matroska with cues etc. already carry an index; use it as is.
+  int count = avformat_index_get_entries_count(stream);
+  for (int i = 0; i < count; ++i) {
+    const AVIndexEntry* entry = avformat_index_get_entry(stream, i);
+    if (entry && (entry->flags & AVINDEX_KEYFRAME)) {
+      index->Add(entry->timestamp, entry->pos);
+    }
+  }
+  if (!index->empty()) {
+    index->Finalize();
+    return 0;
+  }
+
+  // Otherwise read packet headers through the whole input once, then
+  // rewind.
+  int64_t start = ctx->start_time != AV_NOPTS_VALUE ? ctx->start_time : 0;
+  int64_t min_ts = std::numeric_limits<int64_t>::min();
+  avformat_seek_file(ctx, -1, min_ts, start, start, 0);
+
+  ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
+  if (!packet) {
+    return AVERROR(ENOMEM);
+  }
+  int ret;
+  while ((ret = av_read_frame(ctx, packet.get())) >= 0) {
+    if (packet->stream_index == stream_index &&
+        (packet->flags & AV_PKT_FLAG_KEY)) {
+      int64_t ts =
+          packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+      if (ts != AV_NOPTS_VALUE) {
+        index->Add(ts, packet->pos);
+      }
+    }
+    av_packet_unref(packet.get());
+  }
+  if (ret != AVERROR_EOF) {
+    return ret;
+  }
+  index->Finalize();
+  avformat_seek_file(ctx, -1, min_ts, start, start, 0);
+  seek_target_us_ = AV_NOPTS_VALUE;
+  return 0;
+}
+
+Napi::Value Demuxer::BuildKeyframeIndex(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!format_context_) {
+    throw Napi::Error::New(env, "InvalidStateError: Demuxer not opened");
+  }
+  if (async_active_ || task_active_) {
+    throw Napi::Error::New(env, "InvalidStateError: Demuxer is busy");
+  }
+
+  // Scanning may read the whole input, so it always runs off the JS thread.
+  return RunOnReader(
+      env, [this]() { return ScanKeyframes(&scanned_index_); },
+      [this](Napi::Env env, int ret, Napi::Promise::Deferred& deferred) {
+        if (ret < 0) {
+          deferred.Reject(
+              webcodecs::FFmpegError(env, "build keyframe index", ret)
+                  .Value());
+          return;
+        }
+        keyframe_index_ = std::move(scanned_index_);
+        scanned_index_ = webcodecs::KeyframeIndex();
+        std::vector<uint8_t> bytes = keyframe_index_.Serialize();
+        deferred.Resolve(
+            Napi::Buffer<uint8_t>::Copy(env, bytes.data(), bytes.size()));
+      });
+}
+
+Napi::Value Demuxer::LoadKeyframeIndex(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!format_context_) {
+    throw Napi::Error::New(env, "InvalidStateError: Demuxer not opened");
+  }
+  if (info.Length() < 1 ||
+      !(info[0].IsBuffer() || info[0].IsArrayBuffer() ||
+        info[0].IsTypedArray())) {
+    throw webcodecs::InvalidParameterError(
+        env, "index", "BufferSource",
+        info.Length() > 0 ? info[0] : env.Undefined());
+  }
+  Napi::Object holder = Napi::Object::New(env);
+  holder.Set("data", info[0]);
+  auto [data, size] = webcodecs::AttrAsBuffer(holder, "data");
+
+  webcodecs::KeyframeIndex index;
+  bool valid = webcodecs::KeyframeIndex::Deserialize(data, size, &index);
+  // An index only applies to the stream and time base it was built for.
+  if (valid) {
+    auto stream_index = static_cast<unsigned int>(index.stream_index());
+    valid = stream_index < format_context_->nb_streams &&
+            av_cmp_q(index.time_base(),
+                     format_context_.get()->streams[stream_index]->time_base) ==
+                0;
+  }
+  if (!valid) {
+    throw Napi::Error::New(env,
+                           "DataError: Keyframe index does not match input");
+  }
+  keyframe_index_ = std::move(index);
+  return env.Undefined();
+}
+
+Napi::Value Demuxer::DemuxAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!format_context_) {
+    throw Napi::Error::New(env, "InvalidStateError: Demuxer not opened");
+  }
+  if (async_active_ || task_active_) {
+    throw Napi::Error::New(env,
+                           "InvalidStateError: demuxAsync() is in progress");
+  }
+
+  size_t capacity = kDefaultRingCapacity;
+  int high_water_mark = kDefaultDownstreamHighWaterMark;
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
+    capacity = static_cast<size_t>(PositiveIntOption(
+        env, options, "highWaterMark", static_cast<int>(capacity)));
+    high_water_mark = PositiveIntOption(env, options, "downstreamHighWaterMark",
+                                        high_water_mark);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    ring_.clear();
+    ring_capacity_ = capacity;
+    downstream_queue_size_ = 0;
+    downstream_high_water_mark_ = high_water_mark;
+    reader_stop_ = false;
+    reader_done_ = false;
+    reader_error_ = 0;
+    drain_scheduled_ = false;
+  }
+  abort_read_.store(false);
+
+  // The drain callback ignores its JS function; chunks go to onChunk.
+  // Holding a reference keeps this object alive until the TSFN finalizer
+  // runs, so queued drains never see a collected Demuxer.
+  auto drain_fn = Napi::Function::New(env, [](const Napi::CallbackInfo&) {});
+  drain_tsfn_.Init(DrainTSFN::TSFN::New(env, drain_fn, "DemuxerDrain", 0, 1,
+                                        this, &Demuxer::UnrefOnFinalize));
+  Ref();
+
+  async_deferred_ = std::make_unique<Napi::Promise::Deferred>(
+      Napi::Promise::Deferred::New(env));
+  Napi::Promise promise = async_deferred_->Promise();
+  async_active_ = true;
+  reader_thread_ = std::thread(&Demuxer::ReaderLoop, this);
+  return promise;
+}
+
+Napi::Value Demuxer::SetDownstreamQueueSize(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    throw webcodecs::InvalidParameterError(env, "size", "number", info[0]);
+  }
+  int size = info[0].As<Napi::Number>().Int32Value();
+
+  bool resume;
+  {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    downstream_queue_size_ = size > 0 ? size : 0;
+    resume = downstream_queue_size_ < downstream_high_water_mark_;
+    if (resume && async_active_ && !ring_.empty()) {
+      ScheduleDrainLocked();
+    }
+  }
+  if (resume) {
+    reader_cv_.notify_one();
+  }
+  return env.Undefined();
+}
+
+void Demuxer::ReaderLoop() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(reader_mutex_);
+      reader_cv_.wait(lock, [this] {
+        return reader_stop_ ||
+               (ring_.size() < ring_capacity_ &&
+                downstream_queue_size_ < downstream_high_water_mark_);
+      });
+      if (reader_stop_) {
+        return;
+      }
+    }
+
+    ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
+    int ret = packet ? av_read_frame(format_context_.get(), packet.get())
+                     : AVERROR(ENOMEM);
+
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    if (ret < 0) {
+      reader_done_ = true;
+      reader_error_ = ret == AVERROR_EOF ? 0 : ret;
+      ScheduleDrainLocked();
+      return;
+    }
+    if (ShouldEmit(packet.get())) {
+      ring_.push_back(std::move(packet));
+      ScheduleDrainLocked();
+    }
+  }
+}
+
+void Demuxer::ScheduleDrainLocked() {
+  // One drain queued at a time; it empties whatever the ring holds by then.
+  if (!drain_scheduled_) {
+    drain_scheduled_ = drain_tsfn_.Call(nullptr);
+  }
+}
+
+void Demuxer::OnDrainCallback(Napi::Env env, Napi::Function,
+                              Demuxer* context, std::nullptr_t*) {
+  if (env == nullptr || context == nullptr) {
+    return;
+  }
+  context->DrainRing(env);
+}
+
+void Demuxer::UnrefOnFinalize(Napi::Env, Demuxer* context) {
+  context->Unref();
+}
+
+void Demuxer::DrainRing(Napi::Env env) {
+  if (!async_active_) {
+    return;  // Closed with a drain still queued.
+  }
+  Napi::HandleScope scope(env);
+
+  int error = 0;
+  while (true) {
+    ffmpeg::AVPacketPtr packet;
+    {
+      std::lock_guard<std::mutex> lock(reader_mutex_);
+      bool downstream_full =
+          downstream_queue_size_ >= downstream_high_water_mark_;
+      if (ring_.empty() || downstream_full) {
+        drain_scheduled_ = false;
+        // Paused packets are delivered once SetDownstreamQueueSize() reports
+        // room again.
+        if (!reader_done_ || !ring_.empty()) {
+          return;
+        }
+        error = reader_error_;
+        break;
+      }
+      packet = std::move(ring_.front());
+      ring_.pop_front();
+    }
+    reader_cv_.notify_one();
+
+    try {
+      EmitChunk(env, std::move(packet));
+    } catch (const Napi::Error& e) {
+      FinishAsync(env, 0, e.Value());
+      return;
+    }
+  }
+
+  FinishAsync(env, error, env.Undefined());
+}
+
+void Demuxer::FinishAsync(Napi::Env env, int error,
+                          const Napi::Value& exception) {
+  StopReader();
+
+  std::unique_ptr<Napi::Promise::Deferred> deferred =
+      std::move(async_deferred_);
+  if (!deferred) {
+    return;
+  }
+  if (!exception.IsUndefined()) {
+    deferred->Reject(exception);
+  } else if (error < 0) {
+    deferred->Reject(webcodecs::FFmpegError(env, "read frame", error).Value());
+  } else {
+    deferred->Resolve(env.Undefined());
+  }
+}
+
+void Demuxer::StopReader() {
+  {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    reader_stop_ = true;
+  }
+  abort_read_.store(true);
+  if (input_) {
+    input_->SetInterrupted(true);
+  }
+  reader_cv_.notify_all();
+  if (reader_thread_.joinable()) {
+    reader_thread_.join();
+  }
+  abort_read_.store(false);
+  if (input_) {
+    input_->SetInterrupted(false);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    ring_.clear();
+    drain_scheduled_ = false;
+  }
+  drain_tsfn_.Release();
+  async_active_ = false;
+}
+
+int Demuxer::InterruptCallback(void* opaque) {
+  return static_cast<Demuxer*>(opaque)->abort_read_.load() ? 1 : 0;
+}
+
 Napi::Value Demuxer::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  StopReader();
+  if (async_deferred_) {
+    async_deferred_->Reject(
+        Napi::Error::New(env, "AbortError: Demuxer closed").Value());
+    async_deferred_.reset();
+  }
+  if (task_deferred_) {
+    // FinishTask() still runs to release task_tsfn_ and our reference.
+    task_deferred_->Reject(
+        Napi::Error::New(env, "AbortError: Demuxer closed").Value());
+    task_deferred_.reset();
+  }
   Cleanup();
-  return info.Env().Undefined();
+  return env.Undefined();
 }
 
 Napi::Value Demuxer::GetVideoTrack(const Napi::CallbackInfo& info) {
@@ -11,11 +11,21 @@ extern "C" {
 
 #include <napi.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "src/demuxer_input.h"
 #include "src/ffmpeg_raii.h"
+#include "src/keyframe_index.h"
+#include "src/shared/safe_tsfn.h"
 
 struct TrackInfo {
   int index;
@@ -28,10 +38,27 @@ struct TrackInfo {
   std::vector<uint8_t> extradata;
 };
 
+// How open() probes the input.
+struct DemuxerOpenOptions {
+  int64_t probe_size = 0;         // Bytes; 0 keeps FFmpeg's default
+  int64_t analyze_duration = -1;  // Microseconds; -1 keeps FFmpeg's default
+  // Skip stream probing for MP4 and Matroska when their header already
+  // describes every track.
+  bool trust_container_header = false;
+  // Tracks from an earlier open of the same input. When they match its
+  // streams, they fill in the codec parameters and probing is skipped.
+  std::vector<TrackInfo> tracks;
+  // Read a path source through a MappedFile instead of FFmpeg's file
+  // protocol.
+  bool memory_map = false;
+};
+
 class Demuxer : public Napi::ObjectWrap<Demuxer> {
  public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
-  static Napi::FunctionReference constructor;
+  // One per thread: each environment (main thread or worker_thread)
+  // defines its own class.
+  static thread_local Napi::FunctionReference constructor;
 
   explicit Demuxer(const Napi::CallbackInfo& info);
   ~Demuxer();
@@ -43,22 +70,131 @@ class Demuxer : public Napi::ObjectWrap<Demuxer> {
  private:
   Napi::Value Open(const Napi::CallbackInfo& info);
   Napi::Value DemuxPackets(const Napi::CallbackInfo& info);
+  Napi::Value DemuxAsync(const Napi::CallbackInfo& info);
+  Napi::Value SetDownstreamQueueSize(const Napi::CallbackInfo& info);
+  Napi::Value PushReadResult(const Napi::CallbackInfo& info);
+  Napi::Value Seek(const Napi::CallbackInfo& info);
+  Napi::Value BuildKeyframeIndex(const Napi::CallbackInfo& info);
+  Napi::Value LoadKeyframeIndex(const Napi::CallbackInfo& info);
+  Napi::Value SelectTracks(const Napi::CallbackInfo& info);
   Napi::Value Close(const Napi::CallbackInfo& info);
   Napi::Value GetVideoTrack(const Napi::CallbackInfo& info);
   Napi::Value GetAudioTrack(const Napi::CallbackInfo& info);
 
   void Cleanup();
+  void EnumerateTracks(Napi::Env env);
   void EmitTrack(Napi::Env env, const TrackInfo& track);
-  void EmitChunk(Napi::Env env, AVPacket* packet, int track_index);
+  void EmitChunk(Napi::Env env, ffmpeg::AVPacketPtr packet);
+  // Whether |packet| is delivered; drops unselected streams and, after a
+  // precise seek, audio that ends before the target.
+  bool ShouldEmit(const AVPacket* packet) const;
+  // Deliver only |indices|. Every other stream is set to AVDISCARD_ALL so
+  // the container skips its payloads instead of reading them.
+  void SelectStreams(const std::vector<int>& indices);
+  bool IsSelected(int stream_index) const;
+
+  // Work that reads a callback input (probing, seeking, indexing) blocks
+  // on JS, so it runs on reader_thread_ and completes on the JS thread in
+  // FinishTask(), where |finish| settles the returned promise.
+  using TaskFinish = std::function<void(Napi::Env env, int result,
+                                        Napi::Promise::Deferred& deferred)>;
+  Napi::Value RunOnReader(Napi::Env env, std::function<int()> task,
+                          TaskFinish finish);
+  void FinishTask(Napi::Env env);
+  static void OnTaskComplete(Napi::Env env, Napi::Function fn,
+                             Demuxer* context, std::nullptr_t* data);
+
+  // Opening.
+  struct ReadRequest {
+    uint64_t id;
+    int64_t offset;
+    int length;
+  };
+  AVFormatContext* AllocFormatContext();
+  static int OpenFormatContext(AVFormatContext** ctx, const char* url,
+                               const DemuxerOpenOptions& options,
+                               const char** failed_op);
+  Napi::Value OpenFromCallback(Napi::Env env, Napi::Object source,
+                               DemuxerOpenOptions options);
+  static void OnReadRequest(Napi::Env env, Napi::Function fn,
+                            Demuxer* context, ReadRequest* request);
+
+  // Seeking. Both return 0 or an AVERROR and may run on reader_thread_.
+  int SeekTo(int64_t timestamp_us, bool precise);
+  int ScanKeyframes(webcodecs::KeyframeIndex* index);
+  int IndexStreamIndex() const;
+
+  // Async demux: a reader thread prefetches packets into ring_ and the JS
+  // thread drains it in batches via drain_tsfn_.
+  void ReaderLoop();
+  void ScheduleDrainLocked();
+  void DrainRing(Napi::Env env);
+  void FinishAsync(Napi::Env env, int error, const Napi::Value& exception);
+  void StopReader();
+  static int InterruptCallback(void* opaque);
+  static void OnDrainCallback(Napi::Env env, Napi::Function fn,
+                              Demuxer* context, std::nullptr_t* data);
+  // Finalizer for TSFNs that hold a reference on this object.
+  static void UnrefOnFinalize(Napi::Env env, Demuxer* context);
 
+  using DrainTSFN =
+      webcodecs::SafeThreadSafeFunction<Demuxer, std::nullptr_t,
+                                        &Demuxer::OnDrainCallback>;
+  using TaskTSFN =
+      webcodecs::SafeThreadSafeFunction<Demuxer, std::nullptr_t,
+                                        &Demuxer::OnTaskComplete>;
+  using ReadTSFN =
+      webcodecs::SafeThreadSafeFunction<Demuxer, ReadRequest,
+                                        &Demuxer::OnReadRequest>;
+
+  // Custom I/O for Buffer and callback sources; null for paths. Must
+  // outlive format_context_.
+  std::unique_ptr<webcodecs::DemuxerInput> input_;
+  ReadTSFN read_tsfn_;
   ffmpeg::AVFormatContextPtr format_context_;
   std::vector<TrackInfo> tracks_;
+  // Default video/audio streams, selected after open().
   int video_stream_index_;
   int audio_stream_index_;
+  std::vector<bool> selected_streams_;  // Indexed by stream
 
   Napi::FunctionReference on_track_callback_;
   Napi::FunctionReference on_chunk_callback_;
   Napi::FunctionReference on_error_callback_;
+
+  // Async demux state. ring_ and the fields below it are guarded by
+  // reader_mutex_; format_context_ belongs to the reader while it runs.
+  std::thread reader_thread_;
+  std::mutex reader_mutex_;
+  std::condition_variable reader_cv_;
+  std::deque<ffmpeg::AVPacketPtr> ring_;
+  size_t ring_capacity_ = 0;
+  int downstream_queue_size_ = 0;
+  int downstream_high_water_mark_ = 0;
+  bool reader_stop_ = false;
+  bool reader_done_ = false;
+  int reader_error_ = 0;
+  bool drain_scheduled_ = false;
+  std::atomic<bool> abort_read_{false};
+
+  // Results handed from a reader task to its finish callback.
+  int task_result_ = 0;
+  AVFormatContext* opened_context_ = nullptr;
+  const char* open_failed_op_ = nullptr;
+  webcodecs::KeyframeIndex scanned_index_;
+
+  // Seek state. keyframe_index_ is built or loaded by the caller; while
+  // set, seeks resolve through it instead of the container's own index.
+  webcodecs::KeyframeIndex keyframe_index_;
+  int64_t seek_target_us_ = AV_NOPTS_VALUE;  // Precise seek target
+
+  bool task_active_ = false;   // JS thread only
+  bool async_active_ = false;  // JS thread only
+  TaskTSFN task_tsfn_;
+  TaskFinish task_finish_;
+  std::unique_ptr<Napi::Promise::Deferred> task_deferred_;
+  DrainTSFN drain_tsfn_;
+  std::unique_ptr<Napi::Promise::Deferred> async_deferred_;
 };
 
 Napi::Object InitDemuxer(Napi::Env env, Napi::Object exports);
@@ -0,0 +1,189 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// DemuxerInput implementation.
+
+#include "src/demuxer_input.h"
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace webcodecs {
+
+std::unique_ptr<DemuxerInput> DemuxerInput::FromMemory(const uint8_t* data,
+                                                       size_t size) {
+  std::unique_ptr<DemuxerInput> input(new DemuxerInput());
+  input->data_.assign(data, data + size);
+  input->memory_ = input->data_.data();
+  input->size_ = static_cast<int64_t>(size);
+  if (!input->Init()) {
+    return nullptr;
+  }
+  return input;
+}
+
+std::unique_ptr<DemuxerInput> DemuxerInput::FromMapping(
+    std::unique_ptr<MappedFile> file) {
+  std::unique_ptr<DemuxerInput> input(new DemuxerInput());
+  input->memory_ = file->data();
+  input->size_ = static_cast<int64_t>(file->size());
+  input->file_ = std::move(file);
+  if (!input->Init()) {
+    return nullptr;
+  }
+  return input;
+}
+
+std::unique_ptr<DemuxerInput> DemuxerInput::FromCallback(RequestFn request,
+                                                         int64_t size) {
+  std::unique_ptr<DemuxerInput> input(new DemuxerInput());
+  input->request_ = std::move(request);
+  input->size_ = size;
+  if (!input->Init()) {
+    return nullptr;
+  }
+  return input;
+}
+
+DemuxerInput::~DemuxerInput() {
+  if (avio_) {
+    // avio_context_free() does not free the (possibly reallocated) buffer.
+    av_freep(&avio_->buffer);
+    avio_context_free(&avio_);
+  }
+}
+
+bool DemuxerInput::Init() {
+  auto* buffer = static_cast<uint8_t*>(av_malloc(kBufferSize));
+  if (!buffer) {
+    return false;
+  }
+  avio_ = avio_alloc_context(buffer, kBufferSize, 0, this,
+                             &DemuxerInput::Read, nullptr,
+                             &DemuxerInput::Seek);
+  if (!avio_) {
+    av_free(buffer);
+    return false;
+  }
+  return true;
+}
+
+int DemuxerInput::Read(void* opaque, uint8_t* buf, int buf_size) {
+  auto* input = static_cast<DemuxerInput*>(opaque);
+  return input->blocking() ? input->ReadCallback(buf, buf_size)
+                           : input->ReadMemory(buf, buf_size);
+}
+
+int DemuxerInput::ReadMemory(uint8_t* buf, int buf_size) {
+  int64_t remaining = size_ - position_;
+  if (remaining <= 0) {
+    return AVERROR_EOF;
+  }
+  int to_read = static_cast<int>(std::min<int64_t>(remaining, buf_size));
+  std::memcpy(buf, memory_ + position_, to_read);
+  position_ += to_read;
+  return to_read;
+}
+
+int DemuxerInput::ReadCallback(uint8_t* buf, int buf_size) {
+  if (size_ >= 0 && position_ >= size_) {
+    return AVERROR_EOF;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (interrupted_) {
+    return AVERROR_EXIT;
+  }
+  response_ready_ = false;
+  response_.clear();
+  response_error_ = 0;
+  request_id_ = next_request_id_++;
+  if (!request_(request_id_, position_, buf_size)) {
+    request_id_ = 0;
+    return AVERROR_EXIT;
+  }
+  cv_.wait(lock, [this] { return response_ready_ || interrupted_; });
+  request_id_ = 0;
+  if (!response_ready_) {
+    return AVERROR_EXIT;
+  }
+  response_ready_ = false;
+
+  if (response_error_ < 0) {
+    return response_error_;
+  }
+  if (response_.empty()) {
+    return AVERROR_EOF;
+  }
+  int to_read = static_cast<int>(
+      std::min<size_t>(response_.size(), static_cast<size_t>(buf_size)));
+  std::memcpy(buf, response_.data(), to_read);
+  position_ += to_read;
+  return to_read;
+}
+
+int64_t DemuxerInput::Seek(void* opaque, int64_t offset, int whence) {
+  auto* input = static_cast<DemuxerInput*>(opaque);
+  int64_t new_pos = 0;
+
+  switch (whence & ~AVSEEK_FORCE) {
+    case SEEK_SET:
+      new_pos = offset;
+      break;
+    case SEEK_CUR:
+      new_pos = input->position_ + offset;
+      break;
+    case SEEK_END:
+      if (input->size_ < 0) {
+        return AVERROR(ENOSYS);
+      }
+      new_pos = input->size_ + offset;
+      break;
+    case AVSEEK_SIZE:
+      return input->size_ >= 0 ? input->size_ : AVERROR(ENOSYS);
+    default:
+      return AVERROR(EINVAL);
+  }
+
+  if (new_pos < 0 || (input->size_ >= 0 && new_pos > input->size_)) {
+    return AVERROR(EINVAL);
+  }
+  // Callback inputs fetch lazily, so a seek is just a new request offset.
+  input->position_ = new_pos;
+  return new_pos;
+}
+
+void DemuxerInput::Respond(uint64_t id, const uint8_t* data, size_t size,
+                           int error) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id == 0 || id != request_id_) {
+      return;
+    }
+    if (data && size > 0) {
+      response_.assign(data, data + size);
+    } else {
+      response_.clear();
+    }
+    response_error_ = error;
+    response_ready_ = true;
+  }
+  cv_.notify_all();
+}
+
+void DemuxerInput::SetInterrupted(bool interrupted) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    interrupted_ = interrupted;
+  }
+  cv_.notify_all();
+}
+
+}  // namespace webcodecs
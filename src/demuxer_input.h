@@ -0,0 +1,114 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// DemuxerInput - custom AVIOContext for Demuxer sources that are not
+// filesystem paths.
+//
+// Two kinds of input:
+// - Memory: a copy of a BufferSource, or a MappedFile read in place, read
+//   and seeked like ImageDecoder's in-memory input.
+// - Callback: bytes are pulled from JavaScript. Each AVIO read issues a
+//   request for |length| bytes at |offset| and blocks until Respond() is
+//   called, so FFmpeg must drive a callback input from a non-JS thread.
+//   Seeking only moves the read offset, which lets the JS side serve
+//   HTTP range requests or a buffered stream.
+//
+// Thread Safety:
+// - Read/Seek run on whichever thread is inside FFmpeg (one at a time).
+// - Respond() and SetInterrupted() may be called from any thread.
+
+#ifndef SRC_DEMUXER_INPUT_H_
+#define SRC_DEMUXER_INPUT_H_
+
+extern "C" {
+#include <libavformat/avio.h>
+}
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "src/mapped_file.h"
+
+namespace webcodecs {
+
+class DemuxerInput {
+ public:
+  // Asks the owner to fetch |length| bytes at |offset| and answer through
+  // Respond() with the same |id|. Returns false if the request could not be
+  // sent.
+  using RequestFn =
+      std::function<bool(uint64_t id, int64_t offset, int length)>;
+
+  // AVIO buffer size; also the largest single read requested from a
+  // callback input.
+  static constexpr int kBufferSize = 64 * 1024;
+
+  // Returns nullptr on allocation failure.
+  static std::unique_ptr<DemuxerInput> FromMemory(const uint8_t* data,
+                                                  size_t size);
+  static std::unique_ptr<DemuxerInput> FromMapping(
+      std::unique_ptr<MappedFile> file);
+  // |size| is the total input size, or -1 if unknown (seeking relative to
+  // the end then fails).
+  static std::unique_ptr<DemuxerInput> FromCallback(RequestFn request,
+                                                    int64_t size);
+
+  ~DemuxerInput();
+
+  // Disallow copy and assign.
+  DemuxerInput(const DemuxerInput&) = delete;
+  DemuxerInput& operator=(const DemuxerInput&) = delete;
+
+  // Attach as |format_context->pb| together with AVFMT_FLAG_CUSTOM_IO. The
+  // format context must be closed before this input is destroyed.
+  AVIOContext* avio() const { return avio_; }
+
+  // True for callback inputs, whose reads wait on the JS thread.
+  bool blocking() const { return static_cast<bool>(request_); }
+
+  // Answer request |id|. |size| == 0 with |error| == 0 means end of input; a
+  // negative |error| is returned to FFmpeg as is. Bytes beyond the requested
+  // length are dropped, as are answers to requests that were interrupted.
+  void Respond(uint64_t id, const uint8_t* data, size_t size, int error);
+
+  // While set, reads fail with AVERROR_EXIT instead of waiting, so a
+  // pending request cannot hang close().
+  void SetInterrupted(bool interrupted);
+
+ private:
+  DemuxerInput() = default;
+
+  bool Init();
+  int ReadMemory(uint8_t* buf, int buf_size);
+  int ReadCallback(uint8_t* buf, int buf_size);
+
+  static int Read(void* opaque, uint8_t* buf, int buf_size);
+  static int64_t Seek(void* opaque, int64_t offset, int whence);
+
+  AVIOContext* avio_ = nullptr;
+  const uint8_t* memory_ = nullptr;  // Memory input, in data_ or file_
+  std::vector<uint8_t> data_;
+  std::unique_ptr<MappedFile> file_;
+  RequestFn request_;          // Callback input
+  int64_t size_ = -1;
+  int64_t position_ = 0;
+
+  // Callback request state, guarded by mutex_.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t request_id_ = 0;  // Outstanding request, 0 if none
+  uint64_t next_request_id_ = 1;
+  bool response_ready_ = false;
+  std::vector<uint8_t> response_;
+  int response_error_ = 0;
+  bool interrupted_ = false;
+};
+
+}  // namespace webcodecs
+
+#endif  // SRC_DEMUXER_INPUT_H_
@@ -5,10 +5,12 @@
 
 #include <cstring>
 #include <string>
+#include <utility>
 
 #include "src/common.h"
+#include "src/transfer_registry.h"
 
-Napi::FunctionReference EncodedAudioChunk::constructor_;
+thread_local Napi::FunctionReference EncodedAudioChunk::constructor_;
 
 Napi::Object InitEncodedAudioChunk(Napi::Env env, Napi::Object exports) {
   return EncodedAudioChunk::Init(env, exports);
@@ -27,6 +29,7 @@ Napi::Object EncodedAudioChunk::Init(Napi::Env env, Napi::Object exports) {
                            nullptr),
           InstanceMethod("copyTo", &EncodedAudioChunk::CopyTo),
           InstanceMethod("close", &EncodedAudioChunk::Close),
+          InstanceMethod("detach", &EncodedAudioChunk::Detach),
       });
 
   constructor_ = Napi::Persistent(func);
@@ -39,12 +42,26 @@ Napi::Object EncodedAudioChunk::Init(Napi::Env env, Napi::Object exports) {
 Napi::Object EncodedAudioChunk::CreateInstance(
     Napi::Env env, const std::string& type, int64_t timestamp, int64_t duration,
     const uint8_t* data, size_t size) {
+  // Copy once, straight into the packet the chunk will own.
+  return CreateInstance(env, type, timestamp, duration,
+                        ffmpeg::make_packet_copy(data, size));
+}
+
+Napi::Object EncodedAudioChunk::CreateInstance(Napi::Env env,
+                                               const std::string& type,
+                                               int64_t timestamp,
+                                               int64_t duration,
+                                               ffmpeg::AVPacketPtr packet) {
   Napi::Object init = Napi::Object::New(env);
   init.Set("type", type);
   init.Set("timestamp", Napi::Number::New(env, static_cast<double>(timestamp)));
   init.Set("duration", Napi::Number::New(env, static_cast<double>(duration)));
-  init.Set("data", Napi::Buffer<uint8_t>::Copy(env, data, size));
-  return constructor_.New({init});
+
+  // The constructor moves the packet out of |packet| synchronously; if it
+  // throws first, |packet| still owns the reference and frees it on return.
+  Napi::External<ffmpeg::AVPacketPtr> external =
+      Napi::External<ffmpeg::AVPacketPtr>::New(env, &packet);
+  return constructor_.New({init, external});
 }
 
 EncodedAudioChunk::EncodedAudioChunk(const Napi::CallbackInfo& info)
@@ -86,6 +103,36 @@ EncodedAudioChunk::EncodedAudioChunk(const Napi::CallbackInfo& info)
     duration_ = webcodecs::AttrAsInt64(init, "duration");
   }
 
+  // Zero-copy construction via CreateInstance(AVPacketPtr).
+  if (info.Length() > 1 && info[1].IsExternal()) {
+    auto* owned = info[1].As<Napi::External<ffmpeg::AVPacketPtr>>().Data();
+    if (!owned || !*owned) {
+      Napi::Error::New(env, "EncodedAudioChunk requires a valid packet")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    packet_ = std::move(*owned);
+    external_memory_.Set(env, static_cast<int64_t>(GetDataSize()));
+    return;
+  }
+
+  // Transfer from another environment via detach().
+  if (info.Length() > 1 && info[1].IsNumber()) {
+    webcodecs::TransferPayload payload;
+    uint64_t handle =
+        static_cast<uint64_t>(info[1].As<Napi::Number>().Int64Value());
+    if (!webcodecs::TransferRegistry::Instance().Take(handle, &payload) ||
+        !payload.packet) {
+      Napi::Error::New(
+          env, "DataCloneError: EncodedAudioChunk transfer handle is not valid")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    packet_ = std::move(payload.packet);
+    external_memory_.Set(env, static_cast<int64_t>(GetDataSize()));
+    return;
+  }
+
   // Required: data.
   if (!init.Has("data")) {
     Napi::TypeError::New(env, "init.data is required")
@@ -94,25 +141,36 @@ EncodedAudioChunk::EncodedAudioChunk(const Napi::CallbackInfo& info)
   }
 
   Napi::Value data_val = init.Get("data");
+  const uint8_t* data = nullptr;
+  size_t size = 0;
   if (data_val.IsBuffer()) {
     Napi::Buffer<uint8_t> buf = data_val.As<Napi::Buffer<uint8_t>>();
-    data_.assign(buf.Data(), buf.Data() + buf.Length());
+    data = buf.Data();
+    size = buf.Length();
   } else if (data_val.IsArrayBuffer()) {
     Napi::ArrayBuffer ab = data_val.As<Napi::ArrayBuffer>();
-    data_.assign(static_cast<uint8_t*>(ab.Data()),
-                 static_cast<uint8_t*>(ab.Data()) + ab.ByteLength());
+    data = static_cast<uint8_t*>(ab.Data());
+    size = ab.ByteLength();
   } else if (data_val.IsTypedArray()) {
     Napi::TypedArray ta = data_val.As<Napi::TypedArray>();
     Napi::ArrayBuffer ab = ta.ArrayBuffer();
-    size_t offset = ta.ByteOffset();
-    size_t length = ta.ByteLength();
-    data_.assign(static_cast<uint8_t*>(ab.Data()) + offset,
-                 static_cast<uint8_t*>(ab.Data()) + offset + length);
+    data = static_cast<uint8_t*>(ab.Data()) + ta.ByteOffset();
+    size = ta.ByteLength();
   } else {
     Napi::TypeError::New(env, "init.data must be BufferSource")
         .ThrowAsJavaScriptException();
     return;
   }
+
+  // Stored as a padded AVPacket so decoders can take a reference instead of
+  // copying again.
+  packet_ = ffmpeg::make_packet_copy(data, size);
+  if (!packet_) {
+    Napi::Error::New(env, "Failed to allocate chunk data")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  external_memory_.Set(env, static_cast<int64_t>(size));
 }
 
 Napi::Value EncodedAudioChunk::GetType(const Napi::CallbackInfo& info) {
@@ -131,7 +189,7 @@ Napi::Value EncodedAudioChunk::GetDuration(const Napi::CallbackInfo& info) {
 }
 
 Napi::Value EncodedAudioChunk::GetByteLength(const Napi::CallbackInfo& info) {
-  return Napi::Number::New(info.Env(), static_cast<double>(data_.size()));
+  return Napi::Number::New(info.Env(), static_cast<double>(GetDataSize()));
 }
 
 void EncodedAudioChunk::CopyTo(const Napi::CallbackInfo& info) {
@@ -166,20 +224,57 @@ void EncodedAudioChunk::CopyTo(const Napi::CallbackInfo& info) {
     return;
   }
 
-  if (dest_size < data_.size()) {
+  size_t size = GetDataSize();
+  if (dest_size < size) {
     Napi::TypeError::New(env, "destination buffer too small")
         .ThrowAsJavaScriptException();
     return;
   }
 
-  std::memcpy(dest_data, data_.data(), data_.size());
+  if (size > 0) {
+    std::memcpy(dest_data, GetData(), size);
+  }
+}
+
+Napi::Value EncodedAudioChunk::Detach(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(
+        env, "InvalidStateError: Cannot transfer a closed EncodedAudioChunk")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Object init = Napi::Object::New(env);
+  init.Set("type", type_);
+  init.Set("timestamp",
+           Napi::Number::New(env, static_cast<double>(timestamp_)));
+  if (duration_ != 0) {
+    init.Set("duration",
+             Napi::Number::New(env, static_cast<double>(duration_)));
+  }
+
+  // The payload moves to the registry; this chunk ends up closed.
+  webcodecs::TransferPayload payload;
+  payload.packet = std::move(packet_);
+  uint64_t handle =
+      webcodecs::TransferRegistry::Instance().Put(std::move(payload));
+  external_memory_.Release(env);
+  closed_ = true;
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("handle", Napi::Number::New(env, static_cast<double>(handle)));
+  result.Set("init", init);
+  return result;
 }
 
 void EncodedAudioChunk::Close(const Napi::CallbackInfo& info) {
   if (!closed_) {
-    // clear() + shrink_to_fit() actually releases memory.
-    data_.clear();
-    data_.shrink_to_fit();
+    // Drops our reference; the payload is freed once queued decodes that
+    // share it are done.
+    packet_.reset();
+    external_memory_.Release(info.Env());
     closed_ = true;
   }
 }
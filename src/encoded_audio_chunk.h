@@ -8,7 +8,9 @@
 
 #include <cstdint>
 #include <string>
-#include <vector>
+
+#include "src/common.h"
+#include "src/ffmpeg_raii.h"
 
 class EncodedAudioChunk : public Napi::ObjectWrap<EncodedAudioChunk> {
  public:
@@ -16,8 +18,17 @@ class EncodedAudioChunk : public Napi::ObjectWrap<EncodedAudioChunk> {
   static Napi::Object CreateInstance(Napi::Env env, const std::string& type,
                                      int64_t timestamp, int64_t duration,
                                      const uint8_t* data, size_t size);
+  // Zero-copy: the chunk adopts |packet| and shares its refcounted payload.
+  static Napi::Object CreateInstance(Napi::Env env, const std::string& type,
+                                     int64_t timestamp, int64_t duration,
+                                     ffmpeg::AVPacketPtr packet);
   explicit EncodedAudioChunk(const Napi::CallbackInfo& info);
 
+  // True if |obj| wraps an EncodedAudioChunk.
+  static bool IsInstance(const Napi::Object& obj) {
+    return !constructor_.IsEmpty() && obj.InstanceOf(constructor_.Value());
+  }
+
   // Prevent copy and assignment.
   EncodedAudioChunk(const EncodedAudioChunk&) = delete;
   EncodedAudioChunk& operator=(const EncodedAudioChunk&) = delete;
@@ -31,17 +42,37 @@ class EncodedAudioChunk : public Napi::ObjectWrap<EncodedAudioChunk> {
   // Methods.
   void CopyTo(const Napi::CallbackInfo& info);
   void Close(const Napi::CallbackInfo& info);
+  // Move the payload into the TransferRegistry and close this chunk.
+  // Returns {handle, init}; `new EncodedAudioChunk(init, handle)` in any
+  // environment of this process takes it back out.
+  Napi::Value Detach(const Napi::CallbackInfo& info);
 
   // Internal access.
-  const std::vector<uint8_t>& GetData() const { return data_; }
+  const uint8_t* GetData() const {
+    return packet_ ? packet_->data : nullptr;
+  }
+  size_t GetDataSize() const {
+    return packet_ ? static_cast<size_t>(packet_->size) : 0;
+  }
+  int64_t GetTimestampValue() const { return timestamp_; }
+  const std::string& GetTypeValue() const { return type_; }
+  // New reference to the payload for a DecodeMessage; nullptr if closed.
+  ffmpeg::AVPacketPtr RefPacket() const {
+    return packet_ ? ffmpeg::ref_packet(packet_.get()) : nullptr;
+  }
 
  private:
-  static Napi::FunctionReference constructor_;
+  // One per thread: each environment (main thread or worker_thread) defines
+  // its own class.
+  static thread_local Napi::FunctionReference constructor_;
 
   std::string type_;
   int64_t timestamp_;
   int64_t duration_;
-  std::vector<uint8_t> data_;
+  ffmpeg::AVPacketPtr packet_;  // Refcounted payload; null once closed
+  // Payload bytes reported to V8 and the MemoryAccountant.
+  webcodecs::ExternalMemory external_memory_{
+      webcodecs::MemoryCategory::kEncodedChunks};
   bool closed_ = false;
 };
 
@@ -5,10 +5,12 @@
 
 #include <cstring>
 #include <string>
+#include <utility>
 
 #include "src/common.h"
+#include "src/transfer_registry.h"
 
-Napi::FunctionReference EncodedVideoChunk::constructor;
+thread_local Napi::FunctionReference EncodedVideoChunk::constructor;
 
 Napi::Object InitEncodedVideoChunk(Napi::Env env, Napi::Object exports) {
   return EncodedVideoChunk::Init(env, exports);
@@ -25,8 +27,11 @@ Napi::Object EncodedVideoChunk::Init(Napi::Env env, Napi::Object exports) {
                            nullptr),
           InstanceAccessor("byteLength", &EncodedVideoChunk::GetByteLength,
                            nullptr),
+          InstanceAccessor("decodeTimestamp",
+                           &EncodedVideoChunk::GetDecodeTimestamp, nullptr),
           InstanceMethod("copyTo", &EncodedVideoChunk::CopyTo),
           InstanceMethod("close", &EncodedVideoChunk::Close),
+          InstanceMethod("detach", &EncodedVideoChunk::Detach),
       });
 
   constructor = Napi::Persistent(func);
@@ -38,13 +43,28 @@ Napi::Object EncodedVideoChunk::Init(Napi::Env env, Napi::Object exports) {
 
 Napi::Object EncodedVideoChunk::CreateInstance(
     Napi::Env env, const std::string& type, int64_t timestamp, int64_t duration,
-    const uint8_t* data, size_t size) {
+    const uint8_t* data, size_t size, int64_t decode_timestamp) {
+  // Copy once, straight into the packet the chunk will own.
+  return CreateInstance(env, type, timestamp, duration,
+                        ffmpeg::make_packet_copy(data, size), decode_timestamp);
+}
+
+Napi::Object EncodedVideoChunk::CreateInstance(
+    Napi::Env env, const std::string& type, int64_t timestamp,
+    int64_t duration, ffmpeg::AVPacketPtr packet, int64_t decode_timestamp) {
   Napi::Object init = Napi::Object::New(env);
   init.Set("type", type);
   init.Set("timestamp", Napi::Number::New(env, timestamp));
   init.Set("duration", Napi::Number::New(env, duration));
-  init.Set("data", Napi::Buffer<uint8_t>::Copy(env, data, size));
-  return constructor.New({init});
+  if (decode_timestamp != kNoDecodeTimestamp) {
+    init.Set("decodeTimestamp", Napi::Number::New(env, decode_timestamp));
+  }
+
+  // The constructor moves the packet out of |packet| synchronously; if it
+  // throws first, |packet| still owns the reference and frees it on return.
+  Napi::External<ffmpeg::AVPacketPtr> external =
+      Napi::External<ffmpeg::AVPacketPtr>::New(env, &packet);
+  return constructor.New({init, external});
 }
 
 EncodedVideoChunk::EncodedVideoChunk(const Napi::CallbackInfo& info)
@@ -82,29 +102,74 @@ EncodedVideoChunk::EncodedVideoChunk(const Napi::CallbackInfo& info)
     has_duration_ = true;
   }
 
+  // Optional (node-webcodecs extension): decodeTimestamp.
+  decode_timestamp_ = timestamp_;
+  if (webcodecs::HasAttr(init, "decodeTimestamp")) {
+    if (!init.Get("decodeTimestamp").IsNumber()) {
+      throw Napi::TypeError::New(env, "init.decodeTimestamp must be a number");
+    }
+    decode_timestamp_ = webcodecs::AttrAsInt64(init, "decodeTimestamp");
+  }
+
+  // Zero-copy construction via CreateInstance(AVPacketPtr).
+  if (info.Length() > 1 && info[1].IsExternal()) {
+    auto* owned = info[1].As<Napi::External<ffmpeg::AVPacketPtr>>().Data();
+    if (!owned || !*owned) {
+      throw Napi::Error::New(env, "EncodedVideoChunk requires a valid packet");
+    }
+    packet_ = std::move(*owned);
+    external_memory_.Set(env, static_cast<int64_t>(GetDataSize()));
+    return;
+  }
+
+  // Transfer from another environment via detach().
+  if (info.Length() > 1 && info[1].IsNumber()) {
+    webcodecs::TransferPayload payload;
+    uint64_t handle =
+        static_cast<uint64_t>(info[1].As<Napi::Number>().Int64Value());
+    if (!webcodecs::TransferRegistry::Instance().Take(handle, &payload) ||
+        !payload.packet) {
+      throw Napi::Error::New(env,
+                             "DataCloneError: EncodedVideoChunk transfer "
+                             "handle is not valid");
+    }
+    packet_ = std::move(payload.packet);
+    external_memory_.Set(env, static_cast<int64_t>(GetDataSize()));
+    return;
+  }
+
   // Required: data.
   if (!init.Has("data")) {
     throw Napi::TypeError::New(env, "init.data is required");
   }
 
   Napi::Value data_val = init.Get("data");
+  const uint8_t* data = nullptr;
+  size_t size = 0;
   if (data_val.IsBuffer()) {
     Napi::Buffer<uint8_t> buf = data_val.As<Napi::Buffer<uint8_t>>();
-    data_.assign(buf.Data(), buf.Data() + buf.Length());
+    data = buf.Data();
+    size = buf.Length();
   } else if (data_val.IsArrayBuffer()) {
     Napi::ArrayBuffer ab = data_val.As<Napi::ArrayBuffer>();
-    data_.assign(static_cast<uint8_t*>(ab.Data()),
-                 static_cast<uint8_t*>(ab.Data()) + ab.ByteLength());
+    data = static_cast<uint8_t*>(ab.Data());
+    size = ab.ByteLength();
   } else if (data_val.IsTypedArray()) {
     Napi::TypedArray ta = data_val.As<Napi::TypedArray>();
     Napi::ArrayBuffer ab = ta.ArrayBuffer();
-    size_t offset = ta.ByteOffset();
-    size_t length = ta.ByteLength();
-    data_.assign(static_cast<uint8_t*>(ab.Data()) + offset,
-                 static_cast<uint8_t*>(ab.Data()) + offset + length);
+    data = static_cast<uint8_t*>(ab.Data()) + ta.ByteOffset();
+    size = ta.ByteLength();
   } else {
     throw Napi::TypeError::New(env, "init.data must be BufferSource");
   }
+
+  // Stored as a padded AVPacket so decoders can take a reference instead of
+  // copying again.
+  packet_ = ffmpeg::make_packet_copy(data, size);
+  if (!packet_) {
+    throw Napi::Error::New(env, "Failed to allocate chunk data");
+  }
+  external_memory_.Set(env, static_cast<int64_t>(size));
 }
 
 Napi::Value EncodedVideoChunk::GetType(const Napi::CallbackInfo& info) {
@@ -122,8 +187,13 @@ Napi::Value EncodedVideoChunk::GetDuration(const Napi::CallbackInfo& info) {
   return Napi::Number::New(info.Env(), duration_);
 }
 
+Napi::Value EncodedVideoChunk::GetDecodeTimestamp(
+    const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), decode_timestamp_);
+}
+
 Napi::Value EncodedVideoChunk::GetByteLength(const Napi::CallbackInfo& info) {
-  return Napi::Number::New(info.Env(), static_cast<double>(data_.size()));
+  return Napi::Number::New(info.Env(), static_cast<double>(GetDataSize()));
 }
 
 void EncodedVideoChunk::CopyTo(const Napi::CallbackInfo& info) {
@@ -154,18 +224,52 @@ void EncodedVideoChunk::CopyTo(const Napi::CallbackInfo& info) {
     throw Napi::TypeError::New(env, "destination must be BufferSource");
   }
 
-  if (dest_size < data_.size()) {
+  size_t size = GetDataSize();
+  if (dest_size < size) {
     throw Napi::TypeError::New(env, "destination buffer too small");
   }
 
-  std::memcpy(dest_data, data_.data(), data_.size());
+  if (size > 0) {
+    std::memcpy(dest_data, GetData(), size);
+  }
+}
+
+Napi::Value EncodedVideoChunk::Detach(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    throw Napi::Error::New(
+        env, "InvalidStateError: Cannot transfer a closed EncodedVideoChunk");
+  }
+
+  Napi::Object init = Napi::Object::New(env);
+  init.Set("type", type_);
+  init.Set("timestamp", Napi::Number::New(env, timestamp_));
+  if (has_duration_) {
+    init.Set("duration", Napi::Number::New(env, duration_));
+  }
+  init.Set("decodeTimestamp", Napi::Number::New(env, decode_timestamp_));
+
+  // The payload moves to the registry; this chunk ends up closed.
+  webcodecs::TransferPayload payload;
+  payload.packet = std::move(packet_);
+  uint64_t handle =
+      webcodecs::TransferRegistry::Instance().Put(std::move(payload));
+  external_memory_.Release(env);
+  closed_ = true;
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("handle", Napi::Number::New(env, static_cast<double>(handle)));
+  result.Set("init", init);
+  return result;
 }
 
 void EncodedVideoChunk::Close(const Napi::CallbackInfo& info) {
   if (!closed_) {
-    // clear() + shrink_to_fit() actually releases memory.
-    data_.clear();
-    data_.shrink_to_fit();
+    // Drops our reference; the payload is freed once queued decodes that
+    // share it are done.
+    packet_.reset();
+    external_memory_.Release(info.Env());
     closed_ = true;
   }
 }
@@ -10,14 +10,27 @@
 
 #include <cstdint>
 #include <string>
-#include <vector>
+
+#include "src/common.h"
+#include "src/ffmpeg_raii.h"
 
 class EncodedVideoChunk : public Napi::ObjectWrap<EncodedVideoChunk> {
  public:
+  // Passed as |decode_timestamp| when decode order equals presentation
+  // order; the chunk then reports its timestamp as decodeTimestamp.
+  static constexpr int64_t kNoDecodeTimestamp = INT64_MIN;
+
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
-  static Napi::Object CreateInstance(Napi::Env env, const std::string& type,
-                                     int64_t timestamp, int64_t duration,
-                                     const uint8_t* data, size_t size);
+  static Napi::Object CreateInstance(
+      Napi::Env env, const std::string& type, int64_t timestamp,
+      int64_t duration, const uint8_t* data, size_t size,
+      int64_t decode_timestamp = kNoDecodeTimestamp);
+  // Zero-copy: the chunk adopts |packet| (typically a demuxed or encoded
+  // packet) and shares its refcounted payload.
+  static Napi::Object CreateInstance(
+      Napi::Env env, const std::string& type, int64_t timestamp,
+      int64_t duration, ffmpeg::AVPacketPtr packet,
+      int64_t decode_timestamp = kNoDecodeTimestamp);
   explicit EncodedVideoChunk(const Napi::CallbackInfo& info);
 
   // Disallow copy and assign.
@@ -25,10 +38,21 @@ class EncodedVideoChunk : public Napi::ObjectWrap<EncodedVideoChunk> {
   EncodedVideoChunk& operator=(const EncodedVideoChunk&) = delete;
 
   // Internal accessors for VideoDecoder.
-  const uint8_t* GetData() const { return data_.data(); }
-  size_t GetDataSize() const { return data_.size(); }
+  const uint8_t* GetData() const {
+    return packet_ ? packet_->data : nullptr;
+  }
+  size_t GetDataSize() const {
+    return packet_ ? static_cast<size_t>(packet_->size) : 0;
+  }
+  // New reference to the payload for a DecodeMessage; nullptr if closed.
+  ffmpeg::AVPacketPtr RefPacket() const {
+    return packet_ ? ffmpeg::ref_packet(packet_.get()) : nullptr;
+  }
   int64_t GetTimestampValue() const { return timestamp_; }
   int64_t GetDurationValue() const { return has_duration_ ? duration_ : 0; }
+  // Decode-order timestamp; differs from the timestamp for reordered
+  // (B-frame) streams.
+  int64_t GetDecodeTimestampValue() const { return decode_timestamp_; }
   const std::string& GetTypeValue() const { return type_; }
 
  private:
@@ -36,18 +60,29 @@ class EncodedVideoChunk : public Napi::ObjectWrap<EncodedVideoChunk> {
   Napi::Value GetType(const Napi::CallbackInfo& info);
   Napi::Value GetTimestamp(const Napi::CallbackInfo& info);
   Napi::Value GetDuration(const Napi::CallbackInfo& info);
+  Napi::Value GetDecodeTimestamp(const Napi::CallbackInfo& info);
   Napi::Value GetByteLength(const Napi::CallbackInfo& info);
 
   // Methods.
   void CopyTo(const Napi::CallbackInfo& info);
   void Close(const Napi::CallbackInfo& info);
+  // Move the payload into the TransferRegistry and close this chunk.
+  // Returns {handle, init}; `new EncodedVideoChunk(init, handle)` in any
+  // environment of this process takes it back out.
+  Napi::Value Detach(const Napi::CallbackInfo& info);
 
-  static Napi::FunctionReference constructor;
+  // One per thread: each environment (main thread or worker_thread) defines
+  // its own class.
+  static thread_local Napi::FunctionReference constructor;
   std::string type_;
   int64_t timestamp_;
   bool has_duration_;
   int64_t duration_;
-  std::vector<uint8_t> data_;
+  int64_t decode_timestamp_;
+  ffmpeg::AVPacketPtr packet_;  // Refcounted payload; null once closed
+  // Payload bytes reported to V8 and the MemoryAccountant.
+  webcodecs::ExternalMemory external_memory_{
+      webcodecs::MemoryCategory::kEncodedChunks};
   bool closed_;
 };
 
@@ -22,11 +22,16 @@ extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavfilter/avfilter.h>
 #include <libavformat/avformat.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/buffer.h>
 #include <libavutil/frame.h>
 #include <libswresample/swresample.h>
 #include <libswscale/swscale.h>
 }
 
+#include <climits>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 
 namespace ffmpeg {
@@ -89,7 +94,8 @@ struct AVFormatContextDeleter {
 struct AVFormatContextOutputDeleter {
   void operator()(AVFormatContext* ctx) const noexcept {
     if (ctx) {
-      if (ctx->pb) {
+      // Custom AVIO contexts belong to whoever attached them.
+      if (ctx->pb && !(ctx->flags & AVFMT_FLAG_CUSTOM_IO)) {
         avio_closep(&ctx->pb);
       }
       avformat_free_context(ctx);
@@ -115,6 +121,24 @@ struct AVFilterInOutDeleter {
   }
 };
 
+// AVBufferRef deleter (hw device / hw frames contexts)
+struct AVBufferRefDeleter {
+  void operator()(AVBufferRef* ref) const noexcept {
+    if (ref) {
+      av_buffer_unref(&ref);
+    }
+  }
+};
+
+// AVAudioFifo deleter
+struct AVAudioFifoDeleter {
+  void operator()(AVAudioFifo* fifo) const noexcept {
+    if (fifo) {
+      av_audio_fifo_free(fifo);
+    }
+  }
+};
+
 // Type aliases for convenient usage
 using AVFramePtr = std::unique_ptr<AVFrame, AVFrameDeleter>;
 using AVPacketPtr = std::unique_ptr<AVPacket, AVPacketDeleter>;
@@ -128,12 +152,40 @@ using AVFormatContextOutputPtr =
     std::unique_ptr<AVFormatContext, AVFormatContextOutputDeleter>;
 using AVFilterGraphPtr = std::unique_ptr<AVFilterGraph, AVFilterGraphDeleter>;
 using AVFilterInOutPtr = std::unique_ptr<AVFilterInOut, AVFilterInOutDeleter>;
+using AVBufferRefPtr = std::unique_ptr<AVBufferRef, AVBufferRefDeleter>;
+using AVAudioFifoPtr = std::unique_ptr<AVAudioFifo, AVAudioFifoDeleter>;
 
 // Factory functions for cleaner allocation
 inline AVFramePtr make_frame() { return AVFramePtr(av_frame_alloc()); }
 
 inline AVPacketPtr make_packet() { return AVPacketPtr(av_packet_alloc()); }
 
+// Packet owning a padded copy of |size| bytes at |data|.
+// Returns nullptr on allocation failure.
+inline AVPacketPtr make_packet_copy(const uint8_t* data, size_t size) {
+  if (size > static_cast<size_t>(INT_MAX - AV_INPUT_BUFFER_PADDING_SIZE)) {
+    return nullptr;
+  }
+  AVPacketPtr packet = make_packet();
+  if (!packet || av_new_packet(packet.get(), static_cast<int>(size)) < 0) {
+    return nullptr;
+  }
+  if (size > 0) {
+    std::memcpy(packet->data, data, size);
+  }
+  return packet;
+}
+
+// New reference to |src|'s payload and properties; the data itself is not
+// copied when |src| is refcounted. Returns nullptr on failure.
+inline AVPacketPtr ref_packet(const AVPacket* src) {
+  AVPacketPtr packet = make_packet();
+  if (!packet || av_packet_ref(packet.get(), src) < 0) {
+    return nullptr;
+  }
+  return packet;
+}
+
 inline AVCodecContextPtr make_codec_context(const AVCodec* codec) {
   return AVCodecContextPtr(avcodec_alloc_context3(codec));
 }
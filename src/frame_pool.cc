@@ -0,0 +1,161 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// FramePool implementation.
+
+#include "src/frame_pool.h"
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/mem.h>
+}
+
+#include "src/shared/memory_accountant.h"
+#include "src/thread_placement.h"
+
+namespace webcodecs {
+
+namespace {
+
+// Smallest pooled buffer; tiny frames share one class.
+constexpr size_t kMinClassSize = 64 * 1024;
+
+// Decoders and scalers may touch a few rows past the visible height, so
+// planes are laid out for a height rounded up like av_frame_get_buffer().
+constexpr int kHeightAlignment = 32;
+
+struct SizeClassInfo {
+  FramePool* owner;
+  size_t size;
+};
+
+}  // namespace
+
+FramePool& FramePool::Instance() {
+  // Leaked intentionally: frames released during process exit may still
+  // return buffers after static destructors have run.
+  static FramePool* instance = new FramePool();
+  return *instance;
+}
+
+size_t FramePool::SizeClass(size_t size) {
+  if (size <= kMinClassSize) {
+    return kMinClassSize;
+  }
+  size_t power = kMinClassSize;
+  while (power * 2 < size) {
+    power *= 2;
+  }
+  size_t step = power / 8;
+  return (size + step - 1) / step * step;
+}
+
+AVBufferRef* FramePool::AllocBuffer(void* opaque, size_t size) {
+  auto* info = static_cast<SizeClassInfo*>(opaque);
+  uint8_t* data = static_cast<uint8_t*>(av_malloc(size));
+  if (!data) {
+    return nullptr;
+  }
+  AVBufferRef* buf = av_buffer_create(data, size, &FramePool::FreeBuffer,
+                                      info, 0);
+  if (!buf) {
+    av_free(data);
+    return nullptr;
+  }
+  info->owner->misses_.fetch_add(1, std::memory_order_relaxed);
+  info->owner->allocated_bytes_.fetch_add(size, std::memory_order_relaxed);
+  MemoryAccountant::Instance().Add(MemoryCategory::kFramePool,
+                                   static_cast<int64_t>(size));
+  return buf;
+}
+
+void FramePool::FreeBuffer(void* opaque, uint8_t* data) {
+  auto* info = static_cast<SizeClassInfo*>(opaque);
+  info->owner->allocated_bytes_.fetch_sub(info->size,
+                                          std::memory_order_relaxed);
+  MemoryAccountant::Instance().Add(MemoryCategory::kFramePool,
+                                   -static_cast<int64_t>(info->size));
+  av_free(data);
+}
+
+void FramePool::FreePool(void* opaque) {
+  delete static_cast<SizeClassInfo*>(opaque);
+}
+
+int FramePool::GetBuffer(AVFrame* frame) {
+  if (!frame || frame->width <= 0 || frame->height <= 0 ||
+      frame->format < 0 || frame->buf[0]) {
+    return AVERROR(EINVAL);
+  }
+  auto format = static_cast<AVPixelFormat>(frame->format);
+  int padded_height = (frame->height + kHeightAlignment - 1) /
+                      kHeightAlignment * kHeightAlignment;
+
+  int size = av_image_get_buffer_size(format, frame->width, padded_height,
+                                      kAlignment);
+  if (size < 0) {
+    return size;
+  }
+  size_t class_size = SizeClass(static_cast<size_t>(size) + kAlignment);
+  std::pair<int, size_t> key(CurrentNumaNode(), class_size);
+
+  AVBufferRef* buf = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AVBufferPool*& pool = pools_[key];
+    if (!pool) {
+      auto* info = new SizeClassInfo{this, class_size};
+      pool = av_buffer_pool_init2(class_size, info, &FramePool::AllocBuffer,
+                                  &FramePool::FreePool);
+      if (!pool) {
+        delete info;
+        pools_.erase(key);
+        return AVERROR(ENOMEM);
+      }
+    }
+    // av_buffer_pool_get() has its own lock; holding ours as well keeps
+    // Trim() from uninitializing the pool underneath us.
+    buf = av_buffer_pool_get(pool);
+  }
+  if (!buf) {
+    return AVERROR(ENOMEM);
+  }
+  requests_.fetch_add(1, std::memory_order_relaxed);
+
+  int ret = av_image_fill_arrays(frame->data, frame->linesize, buf->data,
+                                 format, frame->width, padded_height,
+                                 kAlignment);
+  if (ret < 0) {
+    av_buffer_unref(&buf);
+    return ret;
+  }
+  frame->buf[0] = buf;
+  frame->extended_data = frame->data;
+  return 0;
+}
+
+FramePoolStats FramePool::GetStats() const {
+  FramePoolStats stats;
+  uint64_t requests = requests_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.hits = requests > stats.misses ? requests - stats.misses : 0;
+  stats.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.size_classes = pools_.size();
+  }
+  return stats;
+}
+
+void FramePool::Trim() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& entry : pools_) {
+    // Frees idle buffers now; the pool itself goes away once the buffers
+    // still in use are returned.
+    av_buffer_pool_uninit(&entry.second);
+  }
+  pools_.clear();
+}
+
+}  // namespace webcodecs
@@ -0,0 +1,84 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// FramePool - process-wide pool of video frame buffers.
+//
+// Backs AVFrame planes with AVBufferPool buffers grouped into size classes,
+// so frames of similar size (typically a stream's fixed resolution) reuse
+// memory instead of going through malloc for every output. Buffers go back
+// to the pool when the last AVBufferRef is dropped, e.g. in
+// VideoFrame::close() or its GC finalizer.
+//
+// Threads placed on a NUMA node (threading.numaNode) get pools of their
+// own: their buffers are allocated under the node's memory policy, and
+// recycling them through other threads would hand remote memory back.
+
+#ifndef SRC_FRAME_POOL_H_
+#define SRC_FRAME_POOL_H_
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+}
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace webcodecs {
+
+struct FramePoolStats {
+  uint64_t hits = 0;             // Requests served by a recycled buffer
+  uint64_t misses = 0;           // Requests that allocated a new buffer
+  uint64_t allocated_bytes = 0;  // Bytes owned by the pool (in use or idle)
+  uint64_t size_classes = 0;     // Active AVBufferPools
+};
+
+class FramePool {
+ public:
+  // Plane stride alignment; matches the widest SIMD loads used by
+  // libswscale and the encoders (AVX-512).
+  static constexpr int kAlignment = 64;
+
+  static FramePool& Instance();
+
+  // Disallow copy and assign.
+  FramePool(const FramePool&) = delete;
+  FramePool& operator=(const FramePool&) = delete;
+
+  // Drop-in for av_frame_get_buffer(): allocates planes for a video |frame|
+  // whose width, height and format are already set. Returns 0 or an AVERROR.
+  int GetBuffer(AVFrame* frame);
+
+  FramePoolStats GetStats() const;
+
+  // Release idle buffers. Buffers still referenced by frames are freed when
+  // those frames drop them.
+  void Trim();
+
+ private:
+  FramePool() = default;
+
+  // Buffer size served for a request of |size| bytes. Classes are spaced at
+  // 1/8 of the enclosing power of two, bounding waste to ~12.5%.
+  static size_t SizeClass(size_t size);
+
+  static AVBufferRef* AllocBuffer(void* opaque, size_t size);
+  static void FreeBuffer(void* opaque, uint8_t* data);
+  static void FreePool(void* opaque);
+
+  mutable std::mutex mutex_;
+  // Keyed by (NUMA node or -1, size class).
+  std::map<std::pair<int, size_t>, AVBufferPool*> pools_;
+
+  std::atomic<uint64_t> requests_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> allocated_bytes_{0};
+};
+
+}  // namespace webcodecs
+
+#endif  // SRC_FRAME_POOL_H_
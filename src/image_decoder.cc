@@ -14,22 +14,53 @@
 #include <vector>
 
 #include "src/common.h"
+#include "src/pixel_kernels.h"
 #include "src/video_frame.h"
 
 // Buffer size for AVIOContext (4KB is typical for image data)
 static const int kAVIOBufferSize = 4096;
 
-// Premultiply alpha in-place for RGBA data.
-// Applies premultiplication: R' = R * A / 255, G' = G * A / 255, B' = B * A / 255
-// Uses (value * alpha + 127) / 255 for correct rounding.
-static void PremultiplyAlpha(uint8_t* rgba_data, int width, int height) {
-  for (int i = 0; i < width * height; i++) {
-    uint8_t* pixel = rgba_data + i * 4;
-    uint8_t alpha = pixel[3];
-    pixel[0] = static_cast<uint8_t>((pixel[0] * alpha + 127) / 255);
-    pixel[1] = static_cast<uint8_t>((pixel[1] * alpha + 127) / 255);
-    pixel[2] = static_cast<uint8_t>((pixel[2] * alpha + 127) / 255);
+// Read the frame size and SOFn marker from a JPEG header without decoding.
+static bool ProbeJpegSize(const uint8_t* data, size_t size, int* width,
+                          int* height, uint8_t* sof_marker) {
+  if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+    return false;
+  }
+  size_t i = 2;
+  while (i + 4 <= size) {
+    if (data[i] != 0xFF) {
+      return false;
+    }
+    uint8_t marker = data[i + 1];
+    if (marker == 0xFF) {
+      i++;  // Fill byte
+      continue;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+      i += 2;  // Standalone marker
+      continue;
+    }
+    if (marker == 0xD9 || marker == 0xDA) {
+      return false;  // EOI or scan data before any frame header
+    }
+    size_t length = (data[i + 2] << 8) | data[i + 3];
+    if (length < 2) {
+      return false;
+    }
+    bool is_sof = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 &&
+                  marker != 0xC8 && marker != 0xCC;
+    if (is_sof) {
+      if (i + 9 > size) {
+        return false;
+      }
+      *height = (data[i + 5] << 8) | data[i + 6];
+      *width = (data[i + 7] << 8) | data[i + 8];
+      *sof_marker = marker;
+      return *width > 0 && *height > 0;
+    }
+    i += 2 + length;
   }
+  return false;
 }
 
 // Custom read callback for AVIOContext to read from memory buffer
@@ -78,8 +109,8 @@ static int64_t SeekPacket(void* opaque, int64_t offset, int whence) {
   return new_pos;
 }
 
-// Static member definition
-Napi::FunctionReference ImageDecoder::constructor_;
+// Per-thread constructor reference; see the class declaration.
+thread_local Napi::FunctionReference ImageDecoder::constructor_;
 
 Napi::Object ImageDecoder::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func = DefineClass(
@@ -103,6 +134,8 @@ Napi::Object ImageDecoder::Init(Napi::Env env, Napi::Object exports) {
 
 ImageDecoder::ImageDecoder(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<ImageDecoder>(info),
+      data_(nullptr),
+      data_size_(0),
       codec_(nullptr),
       codec_context_(),
       sws_context_(),
@@ -114,6 +147,10 @@ ImageDecoder::ImageDecoder(const Napi::CallbackInfo& info)
       video_stream_index_(-1),
       decoded_width_(0),
       decoded_height_(0),
+      desired_width_(0),
+      desired_height_(0),
+      next_packet_index_(0),
+      next_output_index_(0),
       animated_(false),
       frame_count_(1),
       repetition_count_(0),
@@ -148,6 +185,22 @@ ImageDecoder::ImageDecoder(const Napi::CallbackInfo& info)
     return;
   }
 
+  // Get resizeQuality/scalingThreads for the RGBA conversion
+  std::string scaling_error;
+  if (!webcodecs::ParseScalingConfig(init, &scaling_, &scaling_error)) {
+    Napi::TypeError::New(env, scaling_error).ThrowAsJavaScriptException();
+    return;
+  }
+
+  // Get desiredWidth/desiredHeight; only honoured together (the JS layer
+  // rejects one without the other).
+  int desired_width = webcodecs::AttrAsInt32(init, "desiredWidth", 0);
+  int desired_height = webcodecs::AttrAsInt32(init, "desiredHeight", 0);
+  if (desired_width > 0 && desired_height > 0) {
+    desired_width_ = desired_width;
+    desired_height_ = desired_height;
+  }
+
   // Get data
   if (!init.Has("data")) {
     Napi::TypeError::New(env, "data is required").ThrowAsJavaScriptException();
@@ -155,22 +208,67 @@ ImageDecoder::ImageDecoder(const Napi::CallbackInfo& info)
   }
 
   Napi::Value data_value = init.Get("data");
+  const uint8_t* bytes = nullptr;
+  size_t length = 0;
   if (data_value.IsBuffer()) {
     Napi::Buffer<uint8_t> buf = data_value.As<Napi::Buffer<uint8_t>>();
-    data_.assign(buf.Data(), buf.Data() + buf.Length());
+    bytes = buf.Data();
+    length = buf.Length();
   } else if (data_value.IsTypedArray()) {
     Napi::TypedArray typed_array = data_value.As<Napi::TypedArray>();
     Napi::ArrayBuffer array_buffer = typed_array.ArrayBuffer();
-    size_t offset = typed_array.ByteOffset();
-    size_t length = typed_array.ByteLength();
-    uint8_t* data_ptr = static_cast<uint8_t*>(array_buffer.Data()) + offset;
-    data_.assign(data_ptr, data_ptr + length);
+    bytes = static_cast<uint8_t*>(array_buffer.Data()) +
+            typed_array.ByteOffset();
+    length = typed_array.ByteLength();
+  } else if (data_value.IsObject()) {
+    // A local file, mapped rather than read: {path} or {fd}.
+    Napi::Object source = data_value.As<Napi::Object>();
+    std::string name;
+    std::string error;
+    if (webcodecs::HasAttr(source, "path") &&
+        source.Get("path").IsString()) {
+      name = webcodecs::AttrAsStr(source, "path");
+      mapped_file_ = webcodecs::MappedFile::Open(
+          name, AV_INPUT_BUFFER_PADDING_SIZE, &error);
+    } else if (webcodecs::HasAttr(source, "fd") &&
+               source.Get("fd").IsNumber()) {
+      int fd = webcodecs::AttrAsInt32(source, "fd", -1);
+      name = "fd " + std::to_string(fd);
+      mapped_file_ = webcodecs::MappedFile::FromDescriptor(
+          fd, AV_INPUT_BUFFER_PADDING_SIZE, &error);
+    } else {
+      Napi::TypeError::New(env, "data file source needs a path or fd")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    if (!mapped_file_) {
+      Napi::Error::New(env, "Failed to map " + name + ": " + error)
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    data_ = mapped_file_->data();
+    data_size_ = mapped_file_->size();
   } else {
     Napi::TypeError::New(env, "data must be Buffer or TypedArray")
         .ThrowAsJavaScriptException();
     return;
   }
 
+  if (bytes) {
+    if (webcodecs::AttrAsBool(init, "adoptData", false)) {
+      // The JS layer handed over a buffer nothing else can reach (a
+      // transferred ArrayBuffer or the concatenated stream): keep it alive
+      // and read it in place.
+      data_ref_ = Napi::Persistent(data_value);
+      data_ = bytes;
+    } else {
+      owned_data_.resize(length + AV_INPUT_BUFFER_PADDING_SIZE, 0);
+      std::memcpy(owned_data_.data(), bytes, length);
+      data_ = owned_data_.data();
+    }
+    data_size_ = length;
+  }
+
   // Map MIME type to FFmpeg codec
   AVCodecID codec_id = MimeTypeToCodecId(type_);
   if (codec_id == AV_CODEC_ID_NONE) {
@@ -195,6 +293,10 @@ ImageDecoder::ImageDecoder(const Napi::CallbackInfo& info)
     return;
   }
 
+  // Let the decoder do most of a downscale itself (e.g. JPEG DCT scaling),
+  // leaving only the remainder for the RGBA conversion pass.
+  codec_context_->lowres = ChooseLowres();
+
   // Open codec
   if (avcodec_open2(codec_context_.get(), codec_, nullptr) < 0) {
     Cleanup();
@@ -212,22 +314,15 @@ ImageDecoder::ImageDecoder(const Napi::CallbackInfo& info)
     return;
   }
 
-  // For animated formats, parse container to get frame count and loop info
+  // For animated formats, index the container to get frame count and loop
+  // info. If that fails the data is decoded as a static image. Pixels are
+  // only decoded by decode(), off the JS thread.
   if (IsAnimatedFormat(type_)) {
-    if (ParseAnimatedImageMetadata()) {
-      complete_ = true;
-    } else {
-      // Fall back to static image decoding if animated parsing fails
-      if (DecodeImage()) {
-        complete_ = true;
-      }
-    }
-  } else {
-    // Pre-decode static image to get metadata
-    if (DecodeImage()) {
-      complete_ = true;
-    }
+    ParseAnimatedImageMetadata();
   }
+
+  // All encoded data is supplied up front.
+  complete_ = true;
 }
 
 ImageDecoder::~ImageDecoder() { Cleanup(); }
@@ -253,7 +348,15 @@ void ImageDecoder::Cleanup() {
     avio_context_free(&avio_context_);
     avio_context_ = nullptr;
   }
-  decoded_frames_.clear();
+  decoded_image_.image.reset();
+  frame_cache_.clear();
+  data_ = nullptr;
+  data_size_ = 0;
+  owned_data_ = std::vector<uint8_t>();
+  mapped_file_.reset();
+  data_ref_.Reset();
+  animation_codec_context_.reset();
+  animation_frames_.clear();
 }
 
 AVCodecID ImageDecoder::MimeTypeToCodecId(const std::string& mime_type) {
@@ -277,53 +380,89 @@ bool ImageDecoder::IsAnimatedFormat(const std::string& mime_type) {
   return mime_type == "image/gif" || mime_type == "image/webp";
 }
 
+int ImageDecoder::ChooseLowres() const {
+  if (desired_width_ <= 0 || !codec_ || codec_->max_lowres <= 0 ||
+      codec_->id != AV_CODEC_ID_MJPEG) {
+    return 0;
+  }
+
+  // Only baseline and extended sequential DCT JPEGs support lowres.
+  int width = 0;
+  int height = 0;
+  uint8_t sof_marker = 0;
+  if (!ProbeJpegSize(data_, data_size_, &width, &height, &sof_marker) ||
+      (sof_marker != 0xC0 && sof_marker != 0xC1)) {
+    return 0;
+  }
+
+  // Largest power-of-two reduction that still covers the desired size.
+  int lowres = 0;
+  while (lowres < codec_->max_lowres &&
+         AV_CEIL_RSHIFT(width, lowres + 1) >= desired_width_ &&
+         AV_CEIL_RSHIFT(height, lowres + 1) >= desired_height_) {
+    lowres++;
+  }
+  return lowres;
+}
+
 bool ImageDecoder::ConvertFrameToRGBA(AVFrame* src_frame,
-                                      std::vector<uint8_t>* output) {
+                                      ffmpeg::AVFramePtr* output) {
   if (!src_frame || !output) {
     return false;
   }
 
-  // Create swscale context for conversion to RGBA (RAII managed)
-  ffmpeg::SwsContextPtr local_sws(
-      sws_getContext(src_frame->width, src_frame->height,
-                     static_cast<AVPixelFormat>(src_frame->format),
-                     src_frame->width, src_frame->height, AV_PIX_FMT_RGBA,
-                     SWS_BILINEAR, nullptr, nullptr, nullptr));
-
-  if (!local_sws) {
+  // Scale to desiredWidth x desiredHeight, if given, in the same pass.
+  int dst_width = desired_width_ > 0 ? desired_width_ : src_frame->width;
+  int dst_height = desired_height_ > 0 ? desired_height_ : src_frame->height;
+
+  // Contexts come from the shared pool, so decoding many images of the same
+  // size and format pays for coefficient setup once.
+  webcodecs::SwsKey key = webcodecs::SwsKey::Scale(
+      src_frame->width, src_frame->height,
+      static_cast<AVPixelFormat>(src_frame->format), dst_width, dst_height,
+      AV_PIX_FMT_RGBA);
+  key.flags = scaling_.SwsFlags();
+  key.threads = scaling_.ThreadsOr(1);
+  if (!webcodecs::SwsPool::Instance().Ensure(&sws_context_, key)) {
     return false;
   }
 
-  // Allocate output buffer
-  int output_size = av_image_get_buffer_size(AV_PIX_FMT_RGBA, src_frame->width,
-                                             src_frame->height, 1);
-  output->resize(output_size);
-
-  // Set up output planes
-  uint8_t* dest_data[4] = {output->data(), nullptr, nullptr, nullptr};
-  int dest_linesize[4] = {src_frame->width * 4, 0, 0, 0};
+  // Allocate the output frame; VideoFrame adopts it without copying.
+  ffmpeg::AVFramePtr rgba = ffmpeg::make_frame();
+  if (!rgba) {
+    return false;
+  }
+  rgba->format = AV_PIX_FMT_RGBA;
+  rgba->width = dst_width;
+  rgba->height = dst_height;
+  if (av_frame_get_buffer(rgba.get(), 0) < 0) {
+    return false;
+  }
 
   // Convert
-  sws_scale(local_sws.get(), src_frame->data, src_frame->linesize, 0,
-            src_frame->height, dest_data, dest_linesize);
+  if (webcodecs::ScaleFrame(sws_context_, rgba.get(), src_frame) < 0) {
+    return false;
+  }
 
   // Apply alpha premultiplication if requested
   if (premultiply_alpha_ == "premultiply") {
-    PremultiplyAlpha(output->data(), src_frame->width, src_frame->height);
+    webcodecs::PremultiplyAlpha(rgba->data[0], rgba->width, rgba->height,
+                                rgba->linesize[0]);
   }
 
+  *output = std::move(rgba);
   return true;
 }
 
 bool ImageDecoder::ParseAnimatedImageMetadata() {
-  if (data_.empty()) {
+  if (data_size_ == 0) {
     return false;
   }
 
   // Allocate memory buffer context for custom I/O
   mem_ctx_ = new MemoryBufferContext();
-  mem_ctx_->data = data_.data();
-  mem_ctx_->size = data_.size();
+  mem_ctx_->data = data_;
+  mem_ctx_->size = data_size_;
   mem_ctx_->position = 0;
 
   // Allocate AVIO buffer
@@ -415,73 +554,9 @@ bool ImageDecoder::ParseAnimatedImageMetadata() {
   AVCodecParameters* codecpar = video_stream->codecpar;
 
   // Get dimensions
-  decoded_width_ = codecpar->width;
-  decoded_height_ = codecpar->height;
-
-  // Find decoder for the stream
-  const AVCodec* stream_codec = avcodec_find_decoder(codecpar->codec_id);
-  if (!stream_codec) {
-    avformat_close_input(&format_context_);
-    av_freep(&avio_context_->buffer);
-    avio_context_free(&avio_context_);
-    avio_context_ = nullptr;
-    delete mem_ctx_;
-    mem_ctx_ = nullptr;
-    return false;
-  }
-
-  // Allocate new codec context for the stream (RAII managed)
-  ffmpeg::AVCodecContextPtr stream_codec_ctx =
-      ffmpeg::make_codec_context(stream_codec);
-  if (!stream_codec_ctx) {
-    avformat_close_input(&format_context_);
-    av_freep(&avio_context_->buffer);
-    avio_context_free(&avio_context_);
-    avio_context_ = nullptr;
-    delete mem_ctx_;
-    mem_ctx_ = nullptr;
-    return false;
-  }
-
-  // Copy codec parameters
-  ret = avcodec_parameters_to_context(stream_codec_ctx.get(), codecpar);
-  if (ret < 0) {
-    avformat_close_input(&format_context_);
-    av_freep(&avio_context_->buffer);
-    avio_context_free(&avio_context_);
-    avio_context_ = nullptr;
-    delete mem_ctx_;
-    mem_ctx_ = nullptr;
-    return false;
-  }
-
-  // Open codec
-  ret = avcodec_open2(stream_codec_ctx.get(), stream_codec, nullptr);
-  if (ret < 0) {
-    avformat_close_input(&format_context_);
-    av_freep(&avio_context_->buffer);
-    avio_context_free(&avio_context_);
-    avio_context_ = nullptr;
-    delete mem_ctx_;
-    mem_ctx_ = nullptr;
-    return false;
-  }
-
-  // Count frames and decode them (RAII managed)
-  ffmpeg::AVPacketPtr pkt = ffmpeg::make_packet();
-  ffmpeg::AVFramePtr frm = ffmpeg::make_frame();
-  if (!pkt || !frm) {
-    avformat_close_input(&format_context_);
-    av_freep(&avio_context_->buffer);
-    avio_context_free(&avio_context_);
-    avio_context_ = nullptr;
-    delete mem_ctx_;
-    mem_ctx_ = nullptr;
-    return false;
-  }
+  SetDecodedSize(codecpar->width, codecpar->height);
 
   frame_count_ = 0;
-  int64_t accumulated_pts = 0;
 
   // Extract loop count for GIF from raw data (NETSCAPE2.0 extension)
   if (type_ == "image/gif") {
@@ -492,12 +567,12 @@ bool ImageDecoder::ParseAnimatedImageMetadata() {
     // Look for: 0x21 0xFF 0x0B "NETSCAPE2.0" 0x03 0x01 <loop_low> <loop_high>
     const uint8_t netscape_sig[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S',
                                     'C',  'A',  'P',  'E', '2', '.', '0'};
-    for (size_t i = 0; i + 18 < data_.size(); i++) {
-      if (memcmp(data_.data() + i, netscape_sig, sizeof(netscape_sig)) == 0) {
+    for (size_t i = 0; i + 18 < data_size_; i++) {
+      if (memcmp(data_ + i, netscape_sig, sizeof(netscape_sig)) == 0) {
         // Found NETSCAPE extension, read loop count
         // Format: sig(14) + sub-block-size(1=0x03) + id(1=0x01) + loop(2)
         size_t loop_offset = i + sizeof(netscape_sig) + 2;  // Skip 0x03 0x01
-        if (loop_offset + 2 <= data_.size()) {
+        if (loop_offset + 2 <= data_size_) {
           int loop_count = data_[loop_offset] | (data_[loop_offset + 1] << 8);
           if (loop_count == 0) {
             repetition_count_ = std::numeric_limits<double>::infinity();
@@ -524,72 +599,40 @@ bool ImageDecoder::ParseAnimatedImageMetadata() {
     }
   }
 
-  // Read all frames
-  while (av_read_frame(format_context_, pkt.get()) >= 0) {
-    if (pkt->stream_index == video_stream_index_) {
-      ret = avcodec_send_packet(stream_codec_ctx.get(), pkt.get());
-      if (ret >= 0) {
-        while (avcodec_receive_frame(stream_codec_ctx.get(), frm.get()) >= 0) {
-          DecodedFrame decoded_frame;
-          if (ConvertFrameToRGBA(frm.get(), &decoded_frame.data)) {
-            decoded_frame.width = frm->width;
-            decoded_frame.height = frm->height;
-
-            // Calculate timestamp and duration
-            AVRational time_base = video_stream->time_base;
-            if (frm->pts != AV_NOPTS_VALUE) {
-              decoded_frame.timestamp =
-                  av_rescale_q(frm->pts, time_base, {1, 1000000});
-            } else {
-              decoded_frame.timestamp = accumulated_pts;
-            }
-
-            // Duration from packet or frame
-            int64_t duration = pkt->duration;
-            if (duration <= 0 && frm->duration > 0) {
-              duration = frm->duration;
-            }
-            if (duration > 0) {
-              decoded_frame.duration =
-                  av_rescale_q(duration, time_base, {1, 1000000});
-            } else {
-              // Default to 100ms for GIF frames without explicit duration
-              decoded_frame.duration = 100000;
-            }
-            accumulated_pts += decoded_frame.duration;
-
-            decoded_frames_.push_back(std::move(decoded_frame));
-            frame_count_++;
-          }
-          av_frame_unref(frm.get());
-        }
-      }
+  // Index every frame without decoding it. Packets hold only compressed
+  // data, so keeping them costs about as much as data_ itself; frames are
+  // decoded on demand in GetAnimationFrame().
+  AVRational time_base = video_stream->time_base;
+  int64_t accumulated_pts = 0;
+  for (;;) {
+    ffmpeg::AVPacketPtr pkt = ffmpeg::make_packet();
+    if (!pkt || av_read_frame(format_context_, pkt.get()) < 0) {
+      break;
     }
-    av_packet_unref(pkt.get());
-  }
-
-  // Flush decoder
-  avcodec_send_packet(stream_codec_ctx.get(), nullptr);
-  while (avcodec_receive_frame(stream_codec_ctx.get(), frm.get()) >= 0) {
-    DecodedFrame decoded_frame;
-    if (ConvertFrameToRGBA(frm.get(), &decoded_frame.data)) {
-      decoded_frame.width = frm->width;
-      decoded_frame.height = frm->height;
-      AVRational time_base = video_stream->time_base;
-      if (frm->pts != AV_NOPTS_VALUE) {
-        decoded_frame.timestamp =
-            av_rescale_q(frm->pts, time_base, {1, 1000000});
-      } else {
-        decoded_frame.timestamp = accumulated_pts;
-      }
-      decoded_frame.duration = 100000;  // Default duration
-      decoded_frames_.push_back(std::move(decoded_frame));
-      frame_count_++;
+    if (pkt->stream_index != video_stream_index_) {
+      continue;
+    }
+
+    AnimationFrame frame;
+    if (pkt->pts != AV_NOPTS_VALUE) {
+      frame.timestamp = av_rescale_q(pkt->pts, time_base, {1, 1000000});
+    } else {
+      frame.timestamp = accumulated_pts;
+    }
+    if (pkt->duration > 0) {
+      frame.duration = av_rescale_q(pkt->duration, time_base, {1, 1000000});
+    } else {
+      // Default to 100ms for GIF frames without explicit duration
+      frame.duration = 100000;
     }
-    av_frame_unref(frm.get());
+    accumulated_pts = frame.timestamp + frame.duration;
+    // The first frame always starts from a clean canvas.
+    frame.key = animation_frames_.empty() || (pkt->flags & AV_PKT_FLAG_KEY);
+    frame.packet = std::move(pkt);
+    animation_frames_.push_back(std::move(frame));
   }
 
-  // RAII handles cleanup of pkt, frm, and stream_codec_ctx
+  frame_count_ = static_cast<int>(animation_frames_.size());
 
   // Determine if animated based on frame count
   animated_ = frame_count_ > 1;
@@ -602,44 +645,137 @@ bool ImageDecoder::ParseAnimatedImageMetadata() {
     return false;
   }
 
-  // Set first frame as decoded data for compatibility
-  if (!decoded_frames_.empty()) {
-    decoded_data_ = decoded_frames_[0].data;
-    decoded_width_ = decoded_frames_[0].width;
-    decoded_height_ = decoded_frames_[0].height;
+  // The container usually knows the canvas size; otherwise take it from the
+  // first frame, which is the only one decoded up front.
+  if (desired_width_ > 0) {
+    SetDecodedSize(desired_width_, desired_height_);
+  } else if (decoded_width_ <= 0 || decoded_height_ <= 0) {
+    const DecodedFrame* first = GetAnimationFrame(0);
+    if (!first) {
+      animation_frames_.clear();
+      frame_count_ = 1;
+      animated_ = false;
+      return false;
+    }
+    SetDecodedSize(first->image->width, first->image->height);
   }
 
   // mem_ctx_ stays alive for use by avio_context_, will be cleaned up by Cleanup()
   return true;
 }
 
-bool ImageDecoder::DecodeFrame(int frame_index) {
-  // Validate frame index
-  if (frame_index < 0 || frame_index >= frame_count_) {
+bool ImageDecoder::OpenAnimationDecoder() {
+  AVCodecParameters* codecpar =
+      format_context_->streams[video_stream_index_]->codecpar;
+  const AVCodec* stream_codec = avcodec_find_decoder(codecpar->codec_id);
+  if (!stream_codec) {
+    return false;
+  }
+
+  ffmpeg::AVCodecContextPtr stream_codec_ctx =
+      ffmpeg::make_codec_context(stream_codec);
+  if (!stream_codec_ctx ||
+      avcodec_parameters_to_context(stream_codec_ctx.get(), codecpar) < 0 ||
+      avcodec_open2(stream_codec_ctx.get(), stream_codec, nullptr) < 0) {
     return false;
   }
 
-  // For animated images, return cached frame
-  if (animated_ && static_cast<size_t>(frame_index) < decoded_frames_.size()) {
-    return true;
+  animation_codec_context_ = std::move(stream_codec_ctx);
+  next_packet_index_ = 0;
+  next_output_index_ = 0;
+  return true;
+}
+
+const DecodedFrame* ImageDecoder::GetAnimationFrame(int frame_index) {
+  if (frame_index < 0 ||
+      frame_index >= static_cast<int>(animation_frames_.size())) {
+    return nullptr;
   }
 
-  // For static images, just use the single decoded frame
-  if (!animated_ && frame_index == 0 && !decoded_data_.empty()) {
-    return true;
+  // Recently decoded frames are served from the cache, most recent first.
+  for (auto it = frame_cache_.begin(); it != frame_cache_.end(); ++it) {
+    if (it->first == frame_index) {
+      frame_cache_.splice(frame_cache_.begin(), frame_cache_, it);
+      return &frame_cache_.front().second;
+    }
   }
 
-  return false;
+  // Frames are composited onto the previous canvas, so decoding can only move
+  // forward. Going backwards restarts a fresh decoder at the nearest frame
+  // that does not depend on earlier ones.
+  if (!animation_codec_context_ || frame_index < next_output_index_) {
+    int start = frame_index;
+    while (start > 0 && !animation_frames_[start].key) {
+      --start;
+    }
+    if (!OpenAnimationDecoder()) {
+      return nullptr;
+    }
+    next_packet_index_ = start;
+    next_output_index_ = start;
+  }
+
+  ffmpeg::AVFramePtr frm = ffmpeg::make_frame();
+  if (!frm) {
+    return nullptr;
+  }
+
+  const int packet_count = static_cast<int>(animation_frames_.size());
+  bool found = false;
+  while (!found && next_output_index_ <= frame_index) {
+    int ret;
+    if (next_packet_index_ < packet_count) {
+      ret = avcodec_send_packet(
+          animation_codec_context_.get(),
+          animation_frames_[next_packet_index_].packet.get());
+    } else if (next_packet_index_ == packet_count) {
+      // Drain frames the decoder is still holding.
+      ret = avcodec_send_packet(animation_codec_context_.get(), nullptr);
+    } else {
+      break;
+    }
+    next_packet_index_++;
+    if (ret < 0) {
+      // Corrupt packet: the decoder state can no longer be trusted.
+      animation_codec_context_.reset();
+      return nullptr;
+    }
+
+    while (avcodec_receive_frame(animation_codec_context_.get(), frm.get()) >=
+           0) {
+      int output_index = next_output_index_++;
+      // Only the requested frame is converted; the ones before it just
+      // advance the decoder's canvas.
+      if (output_index == frame_index) {
+        DecodedFrame decoded_frame;
+        if (ConvertFrameToRGBA(frm.get(), &decoded_frame.image)) {
+          decoded_frame.timestamp = animation_frames_[output_index].timestamp;
+          decoded_frame.duration = animation_frames_[output_index].duration;
+          frame_cache_.emplace_front(output_index, std::move(decoded_frame));
+          if (frame_cache_.size() > kFrameCacheCapacity) {
+            frame_cache_.pop_back();
+          }
+          found = true;
+        }
+      }
+      av_frame_unref(frm.get());
+    }
+  }
+
+  if (!found) {
+    return nullptr;
+  }
+  return &frame_cache_.front().second;
 }
 
 bool ImageDecoder::DecodeImage() {
-  if (!codec_context_ || !frame_ || !packet_ || data_.empty()) {
+  if (!codec_context_ || !frame_ || !packet_ || data_size_ == 0) {
     return false;
   }
 
   // Set packet data - use .get() to access raw pointer from RAII wrapper
-  packet_->data = data_.data();
-  packet_->size = static_cast<int>(data_.size());
+  packet_->data = const_cast<uint8_t*>(data_);
+  packet_->size = static_cast<int>(data_size_);
 
   // Send packet to decoder - use .get() for FFmpeg C API
   int ret = avcodec_send_packet(codec_context_.get(), packet_.get());
@@ -653,40 +789,114 @@ bool ImageDecoder::DecodeImage() {
     return false;
   }
 
-  decoded_width_ = frame_->width;
-  decoded_height_ = frame_->height;
+  bool converted = ConvertFrameToRGBA(frame_.get(), &decoded_image_.image);
+  av_frame_unref(frame_.get());
+  if (!converted) {
+    return false;
+  }
+
+  SetDecodedSize(decoded_image_.image->width, decoded_image_.image->height);
+  return true;
+}
 
-  // Convert to RGBA (RAII managed)
-  sws_context_.reset(sws_getContext(frame_->width, frame_->height,
-                                    static_cast<AVPixelFormat>(frame_->format),
-                                    frame_->width, frame_->height,
-                                    AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr,
-                                    nullptr, nullptr));
+void ImageDecoder::SetDecodedSize(int width, int height) {
+  std::lock_guard<std::mutex> lock(size_mutex_);
+  decoded_width_ = width;
+  decoded_height_ = height;
+}
 
-  if (!sws_context_) {
+bool ImageDecoder::DecodeToFrame(int frame_index, DecodedFrame* out,
+                                 std::string* error) {
+  const DecodedFrame* decoded = nullptr;
+  if (!animation_frames_.empty()) {
+    decoded = GetAnimationFrame(frame_index);
+  } else if (decoded_image_.image || DecodeImage()) {
+    decoded = &decoded_image_;
+  }
+  if (!decoded) {
+    *error = "EncodingError: Failed to decode frame " +
+             std::to_string(frame_index);
     return false;
   }
 
-  // Allocate output buffer
-  int output_size = av_image_get_buffer_size(AV_PIX_FMT_RGBA, frame_->width,
-                                             frame_->height, 1);
-  decoded_data_.resize(output_size);
+  out->image.reset(av_frame_clone(decoded->image.get()));
+  if (!out->image) {
+    *error = "Failed to allocate frame";
+    return false;
+  }
+  out->timestamp = decoded->timestamp;
+  out->duration = decoded->duration;
+  return true;
+}
 
-  // Set up output planes
-  uint8_t* dest_data[4] = {decoded_data_.data(), nullptr, nullptr, nullptr};
-  int dest_linesize[4] = {frame_->width * 4, 0, 0, 0};
+// Runs one decode() on the libuv thread pool and settles its promise.
+class ImageDecoder::DecodeWorker : public Napi::AsyncWorker {
+ public:
+  DecodeWorker(Napi::Env env, ImageDecoder* decoder, int frame_index)
+      : Napi::AsyncWorker(env, "ImageDecoder.decode"),
+        decoder_(decoder),
+        decoder_ref_(Napi::Persistent(decoder->Value())),
+        frame_index_(frame_index),
+        deferred_(Napi::Promise::Deferred::New(env)) {}
+
+  Napi::Promise Promise() const { return deferred_.Promise(); }
+
+  void Execute() override {
+    std::lock_guard<std::mutex> lock(decoder_->decode_mutex_);
+    if (decoder_->closed_) {
+      SetError("AbortError: ImageDecoder was closed");
+      return;
+    }
+    std::string error;
+    if (!decoder_->DecodeToFrame(frame_index_, &frame_, &error)) {
+      SetError(error);
+    }
+  }
 
-  // Convert
-  sws_scale(sws_context_.get(), frame_->data, frame_->linesize, 0,
-            frame_->height, dest_data, dest_linesize);
+  void OnOK() override {
+    Napi::Env env = Env();
+    if (Settle()) {
+      deferred_.Reject(
+          Napi::Error::New(env, "AbortError: ImageDecoder was closed").Value());
+      return;
+    }
+    Napi::Object result = Napi::Object::New(env);
+    try {
+      int width = frame_.image->width;
+      int height = frame_.image->height;
+      result.Set("image",
+                 VideoFrame::CreateInstance(env, std::move(frame_.image),
+                                            frame_.timestamp, 0, false, width,
+                                            height));
+    } catch (const Napi::Error& e) {
+      deferred_.Reject(e.Value());
+      return;
+    }
+    result.Set("complete", Napi::Boolean::New(env, decoder_->complete_));
+    deferred_.Resolve(result);
+  }
 
-  // Apply alpha premultiplication if requested
-  if (premultiply_alpha_ == "premultiply") {
-    PremultiplyAlpha(decoded_data_.data(), frame_->width, frame_->height);
+  void OnError(const Napi::Error& e) override {
+    Settle();
+    deferred_.Reject(e.Value());
   }
 
-  return true;
-}
+ private:
+  // JS thread, once Execute() is done. Frees the decoder when this was the
+  // last decode pending after close(); returns whether it is closed.
+  bool Settle() {
+    if (--decoder_->pending_decodes_ == 0 && decoder_->closed_) {
+      decoder_->Cleanup();
+    }
+    return decoder_->closed_;
+  }
+
+  ImageDecoder* decoder_;
+  Napi::ObjectReference decoder_ref_;  // Keeps decoder_ alive
+  int frame_index_;
+  DecodedFrame frame_;
+  Napi::Promise::Deferred deferred_;
+};
 
 Napi::Value ImageDecoder::Decode(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
@@ -697,11 +907,6 @@ Napi::Value ImageDecoder::Decode(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  if (!complete_) {
-    Napi::Error::New(env, "Image decoding failed").ThrowAsJavaScriptException();
-    return env.Undefined();
-  }
-
   // Parse options for frameIndex
   int frame_index = 0;
   if (info.Length() > 0 && info[0].IsObject()) {
@@ -720,81 +925,22 @@ Napi::Value ImageDecoder::Decode(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  // Create a deferred promise
-  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-
-  // Get the appropriate frame data
-  const std::vector<uint8_t>* frame_data = nullptr;
-  int frame_width = decoded_width_;
-  int frame_height = decoded_height_;
-  int64_t timestamp = 0;
-
-  if (animated_ && static_cast<size_t>(frame_index) < decoded_frames_.size()) {
-    const DecodedFrame& decoded_frame = decoded_frames_[frame_index];
-    frame_data = &decoded_frame.data;
-    frame_width = decoded_frame.width;
-    frame_height = decoded_frame.height;
-    timestamp = decoded_frame.timestamp;
-  } else {
-    frame_data = &decoded_data_;
-  }
-
-  if (!frame_data || frame_data->empty()) {
-    Napi::Error::New(env, "Frame data not available")
-        .ThrowAsJavaScriptException();
-    return env.Undefined();
-  }
-
-  // Create VideoFrame from frame data
-  Napi::Buffer<uint8_t> buffer =
-      Napi::Buffer<uint8_t>::Copy(env, frame_data->data(), frame_data->size());
-
-  Napi::Object init = Napi::Object::New(env);
-  init.Set("codedWidth", Napi::Number::New(env, frame_width));
-  init.Set("codedHeight", Napi::Number::New(env, frame_height));
-  init.Set("timestamp", Napi::Number::New(env, static_cast<double>(timestamp)));
-  init.Set("format", Napi::String::New(env, "RGBA"));
-
-  // Get VideoFrame constructor from global
-  Napi::Function video_frame_ctor =
-      env.Global().Get("__nodeWebCodecsVideoFrame__").As<Napi::Function>();
-
-  if (video_frame_ctor.IsUndefined() || !video_frame_ctor.IsFunction()) {
-    // Try to get from module exports directly
-    // For now, create result without VideoFrame wrapper
-    Napi::Object result = Napi::Object::New(env);
-    Napi::Object image = Napi::Object::New(env);
-    image.Set("codedWidth", Napi::Number::New(env, frame_width));
-    image.Set("codedHeight", Napi::Number::New(env, frame_height));
-    image.Set("timestamp",
-              Napi::Number::New(env, static_cast<double>(timestamp)));
-    image.Set("format", Napi::String::New(env, "RGBA"));
-    image.Set("data", buffer);
-    auto closeFn = [](const Napi::CallbackInfo&) {};
-    image.Set("close", Napi::Function::New(env, closeFn));
-    result.Set("image", image);
-    result.Set("complete", Napi::Boolean::New(env, complete_));
-
-    deferred.Resolve(result);
-    return deferred.Promise();
-  }
-
-  // Create VideoFrame instance
-  Napi::Object frame = video_frame_ctor.New({buffer, init}).As<Napi::Object>();
-
-  // Create result object
-  Napi::Object result = Napi::Object::New(env);
-  result.Set("image", frame);
-  result.Set("complete", Napi::Boolean::New(env, complete_));
-
-  deferred.Resolve(result);
-  return deferred.Promise();
+  // The worker deletes itself after settling the promise.
+  auto* worker = new DecodeWorker(env, this, frame_index);
+  Napi::Promise promise = worker->Promise();
+  ++pending_decodes_;
+  worker->Queue();
+  return promise;
 }
 
 void ImageDecoder::Close(const Napi::CallbackInfo& info) {
   if (!closed_) {
-    Cleanup();
+    // Queued decodes then reject. A decode in progress is not waited for;
+    // the last one pending frees the decoder.
     closed_ = true;
+    if (pending_decodes_ == 0) {
+      Cleanup();
+    }
   }
 }
 
@@ -825,9 +971,17 @@ Napi::Value ImageDecoder::GetTracks(const Napi::CallbackInfo& info) {
                       Napi::Number::New(env, repetition_count_));
   }
 
-  if (complete_) {
-    selectedTrack.Set("width", Napi::Number::New(env, decoded_width_));
-    selectedTrack.Set("height", Napi::Number::New(env, decoded_height_));
+  // Static images know their size once decoded.
+  int width;
+  int height;
+  {
+    std::lock_guard<std::mutex> lock(size_mutex_);
+    width = decoded_width_;
+    height = decoded_height_;
+  }
+  if (width > 0) {
+    selectedTrack.Set("width", Napi::Number::New(env, width));
+    selectedTrack.Set("height", Napi::Number::New(env, height));
   }
 
   // Create ImageTrackList object per W3C spec
@@ -3,6 +3,13 @@
 //
 // ImageDecoder implementation wrapping FFmpeg image decoders.
 // Supports both static images and animated formats (GIF, WebP).
+//
+// Construction only parses container metadata. decode() runs the FFmpeg
+// decode and RGBA conversion on the libuv thread pool, so several images
+// decode in parallel while the event loop stays free. Decodes of one
+// ImageDecoder are serialized by decode_mutex_, which the JS thread never
+// takes: close() only marks the decoder closed, and the last decode still
+// pending frees it.
 
 #ifndef SRC_IMAGE_DECODER_H_
 #define SRC_IMAGE_DECODER_H_
@@ -16,20 +23,36 @@ extern "C" {
 
 #include <napi.h>
 
+#include <atomic>
 #include <cmath>
+#include <cstddef>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "src/common.h"
 #include "src/ffmpeg_raii.h"
+#include "src/mapped_file.h"
+#include "src/sws_pool.h"
 
-// Represents a single decoded frame from an animated image
+// A decoded RGBA image. The frame's buffers are shared (refcounted) with
+// every VideoFrame handed out for it.
 struct DecodedFrame {
-  std::vector<uint8_t> data;
-  int width;
-  int height;
+  ffmpeg::AVFramePtr image;
+  int64_t timestamp = 0;  // in microseconds
+  int64_t duration = 0;   // in microseconds
+};
+
+// One encoded frame of an animated image, indexed up front and decoded on
+// demand.
+struct AnimationFrame {
+  ffmpeg::AVPacketPtr packet;
   int64_t timestamp;  // in microseconds
   int64_t duration;   // in microseconds
+  bool key;           // Decoding can restart here
 };
 
 class ImageDecoder : public Napi::ObjectWrap<ImageDecoder> {
@@ -39,14 +62,17 @@ class ImageDecoder : public Napi::ObjectWrap<ImageDecoder> {
   explicit ImageDecoder(const Napi::CallbackInfo& info);
   ~ImageDecoder();
 
-  // Static constructor reference for NAPI class registration
-  static Napi::FunctionReference constructor_;
+  // Constructor reference for NAPI class registration. One per thread: each
+  // environment (main thread or worker_thread) defines its own class.
+  static thread_local Napi::FunctionReference constructor_;
 
   // Disallow copy and assign.
   ImageDecoder(const ImageDecoder&) = delete;
   ImageDecoder& operator=(const ImageDecoder&) = delete;
 
  private:
+  class DecodeWorker;
+
   // WebCodecs API methods.
   Napi::Value Decode(const Napi::CallbackInfo& info);
   void Close(const Napi::CallbackInfo& info);
@@ -56,21 +82,35 @@ class ImageDecoder : public Napi::ObjectWrap<ImageDecoder> {
 
   // Internal helpers.
   void Cleanup();
+  // Decode |frame_index| into |out| (a new reference) on a pool thread;
+  // false with |error| set on failure. Caller holds decode_mutex_.
+  bool DecodeToFrame(int frame_index, DecodedFrame* out, std::string* error);
   bool DecodeImage();
-  bool DecodeFrame(int frame_index);
+  void SetDecodedSize(int width, int height);
   bool ParseAnimatedImageMetadata();
-  bool ConvertFrameToRGBA(AVFrame* frame, std::vector<uint8_t>* output);
+  bool OpenAnimationDecoder();
+  // Decode |frame_index| of an animated image; nullptr on failure. The
+  // pointer is valid until the next call.
+  const DecodedFrame* GetAnimationFrame(int frame_index);
+  bool ConvertFrameToRGBA(AVFrame* frame, ffmpeg::AVFramePtr* output);
   static AVCodecID MimeTypeToCodecId(const std::string& mime_type);
   static bool IsAnimatedFormat(const std::string& mime_type);
-
-  // Image data.
-  std::vector<uint8_t> data_;
+  // Codec lowres level for desiredWidth/desiredHeight; 0 for none.
+  int ChooseLowres() const;
+
+  // Image data, held in one of owned_data_ (a copy, zero-padded),
+  // mapped_file_ or data_ref_ (a transferred buffer, read in place).
+  const uint8_t* data_;
+  size_t data_size_;
+  std::vector<uint8_t> owned_data_;
+  std::unique_ptr<webcodecs::MappedFile> mapped_file_;
+  Napi::Reference<Napi::Value> data_ref_;
   std::string type_;
 
   // FFmpeg state for static image decoding.
   const AVCodec* codec_;
   ffmpeg::AVCodecContextPtr codec_context_;
-  ffmpeg::SwsContextPtr sws_context_;
+  webcodecs::SwsPool::Lease sws_context_;
   ffmpeg::AVFramePtr frame_;
   ffmpeg::AVPacketPtr packet_;
 
@@ -80,22 +120,43 @@ class ImageDecoder : public Napi::ObjectWrap<ImageDecoder> {
   struct MemoryBufferContext* mem_ctx_;  // Owned, freed in Cleanup()
   int video_stream_index_;           // Stream index for video track
 
-  // Decoded frame data (static images).
-  std::vector<uint8_t> decoded_data_;
+  // Decoded static image, filled by the first decode. The dimensions are
+  // also read from the JS thread, so decodes set them under size_mutex_.
+  DecodedFrame decoded_image_;
   int decoded_width_;
   int decoded_height_;
-
-  // Animated image metadata and frame cache.
-  std::vector<DecodedFrame> decoded_frames_;
+  mutable std::mutex size_mutex_;
+
+  // Output size from desiredWidth/desiredHeight; 0 for the native size.
+  int desired_width_;
+  int desired_height_;
+
+  // Animated image state. Frames are decoded on demand in order;
+  // next_packet_index_ is the next packet the decoder consumes and
+  // next_output_index_ the index of the next frame it produces.
+  static constexpr size_t kFrameCacheCapacity = 4;
+  std::vector<AnimationFrame> animation_frames_;
+  ffmpeg::AVCodecContextPtr animation_codec_context_;
+  int next_packet_index_;
+  int next_output_index_;
+  std::list<std::pair<int, DecodedFrame>> frame_cache_;  // Most recent first
   bool animated_;
   int frame_count_;
   double repetition_count_;  // Infinity for infinite loop
 
   bool complete_;
-  bool closed_;
+  std::atomic<bool> closed_;
+
+  // Held by DecodeWorker::Execute(). Cleanup() runs only once no decode is
+  // pending, so a decoder is never torn down under a running one.
+  std::mutex decode_mutex_;
+  int pending_decodes_ = 0;  // DecodeWorkers not yet settled; JS thread
 
   // Premultiply alpha option: "none", "premultiply", or "default"
   std::string premultiply_alpha_;
+
+  // resizeQuality/scalingThreads options (node-webcodecs extension)
+  webcodecs::ScalingConfig scaling_;
 };
 
 #endif  // SRC_IMAGE_DECODER_H_
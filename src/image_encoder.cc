@@ -0,0 +1,533 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#include "src/image_encoder.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/frame_pool.h"
+#include "src/video_frame.h"
+
+namespace {
+
+// AV1 encoders tried for AVIF, best still-image quality first.
+const char* const kAvifEncoders[] = {"libaom-av1", "libsvtav1", "librav1e"};
+
+// The canvas toBlob() defaults, where the format has one.
+double DefaultQuality(const std::string& type) {
+  if (type == "image/jpeg") return 0.92;
+  if (type == "image/webp") return 0.8;
+  return 0.6;
+}
+
+// Pixel formats |codec| accepts, terminated by AV_PIX_FMT_NONE; nullptr
+// when it takes any.
+const AVPixelFormat* SupportedPixelFormats(const AVCodec* codec) {
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61, 13, 100)
+  const void* formats = nullptr;
+  if (avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_PIX_FORMAT,
+                                   0, &formats, nullptr) < 0) {
+    return nullptr;
+  }
+  return static_cast<const AVPixelFormat*>(formats);
+#else
+  return codec->pix_fmts;
+#endif
+}
+
+bool Contains(const AVPixelFormat* formats, AVPixelFormat format) {
+  for (; *formats != AV_PIX_FMT_NONE; ++formats) {
+    if (*formats == format) return true;
+  }
+  return false;
+}
+
+bool IsYuv(AVPixelFormat format) {
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+  return desc && !(desc->flags & AV_PIX_FMT_FLAG_RGB) &&
+         desc->nb_components >= 3;
+}
+
+bool IsFullRangeYuv(AVPixelFormat format) {
+  return format == AV_PIX_FMT_YUVJ420P || format == AV_PIX_FMT_YUVJ422P ||
+         format == AV_PIX_FMT_YUVJ444P;
+}
+
+// libswscale coefficient table for a frame's matrix.
+int SwsColorspace(AVColorSpace colorspace) {
+  switch (colorspace) {
+    case AVCOL_SPC_BT709:
+      return SWS_CS_ITU709;
+    case AVCOL_SPC_BT2020_NCL:
+      return SWS_CS_BT2020;
+    case AVCOL_SPC_SMPTE240M:
+      return SWS_CS_SMPTE240M;
+    default:
+      return SWS_CS_DEFAULT;
+  }
+}
+
+// Full-range twin of a planar 8-bit YUV format, as JPEG expects.
+AVPixelFormat FullRangeYuv(AVPixelFormat format) {
+  switch (format) {
+    case AV_PIX_FMT_YUV420P:
+      return AV_PIX_FMT_YUVJ420P;
+    case AV_PIX_FMT_YUV422P:
+      return AV_PIX_FMT_YUVJ422P;
+    case AV_PIX_FMT_YUV444P:
+      return AV_PIX_FMT_YUVJ444P;
+    default:
+      return AV_PIX_FMT_NONE;
+  }
+}
+
+// Set an encoder private option if this encoder has it; wrappers differ.
+void SetOptionIfPresent(AVCodecContext* context, const char* name,
+                        int64_t value) {
+  av_opt_set_int(context, name, value, AV_OPT_SEARCH_CHILDREN);
+}
+
+}  // namespace
+
+Napi::Object ImageEncoder::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "ImageEncoder",
+      {
+          InstanceMethod("encode", &ImageEncoder::Encode),
+          InstanceMethod("close", &ImageEncoder::Close),
+          InstanceAccessor("type", &ImageEncoder::GetType, nullptr),
+          StaticMethod("isTypeSupported", &ImageEncoder::IsTypeSupported),
+      });
+
+  exports.Set("ImageEncoder", func);
+  return exports;
+}
+
+const AVCodec* ImageEncoder::FindImageEncoder(const std::string& type) {
+  if (type == "image/jpeg") return webcodecs::FindEncoder(AV_CODEC_ID_MJPEG);
+  if (type == "image/png") return webcodecs::FindEncoder(AV_CODEC_ID_PNG);
+  if (type == "image/webp") return webcodecs::FindEncoderByName("libwebp");
+  if (type == "image/avif") {
+    if (!av_guess_format("avif", nullptr, nullptr)) {
+      return nullptr;
+    }
+    for (const char* name : kAvifEncoders) {
+      if (const AVCodec* codec = webcodecs::FindEncoderByName(name)) {
+        return codec;
+      }
+    }
+  }
+  return nullptr;
+}
+
+ImageEncoder::ImageEncoder(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<ImageEncoder>(info),
+      codec_(nullptr),
+      quality_(0),
+      lossless_(false),
+      width_(0),
+      height_(0),
+      closed_(false) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Config object required")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Object config = info[0].As<Napi::Object>();
+  type_ = webcodecs::AttrAsStr(config, "type", "");
+  codec_ = FindImageEncoder(type_);
+  if (!codec_) {
+    Napi::Error::New(env, "NotSupportedError: No encoder for type '" + type_ +
+                              "'")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  quality_ = DefaultQuality(type_);
+  if (webcodecs::HasAttr(config, "quality")) {
+    quality_ = config.Get("quality").ToNumber().DoubleValue();
+    if (!(quality_ >= 0 && quality_ <= 1)) {
+      Napi::RangeError::New(env, "quality must be between 0 and 1")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+  }
+  lossless_ = webcodecs::AttrAsBool(config, "lossless", false);
+  width_ = webcodecs::AttrAsInt32(config, "width", 0);
+  height_ = webcodecs::AttrAsInt32(config, "height", 0);
+  if (width_ < 0 || height_ < 0) {
+    Napi::RangeError::New(env, "width and height must be positive")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  std::string scaling_error;
+  if (!webcodecs::ParseScalingConfig(config, &scaling_, &scaling_error)) {
+    Napi::TypeError::New(env, scaling_error).ThrowAsJavaScriptException();
+    return;
+  }
+}
+
+AVPixelFormat ImageEncoder::ChooseFormat(const AVFrame* source) const {
+  auto format = static_cast<AVPixelFormat>(source->format);
+  const AVPixelFormat* formats = SupportedPixelFormats(codec_);
+  if (!formats) {
+    return format;
+  }
+
+  AVPixelFormat chosen = format;
+  if (!Contains(formats, format)) {
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    bool has_alpha = desc && (desc->flags & AV_PIX_FMT_FLAG_ALPHA);
+    chosen = avcodec_find_best_pix_fmt_of_list(formats, format, has_alpha,
+                                               nullptr);
+  }
+  if (codec_->id == AV_CODEC_ID_MJPEG && !IsFullRangeYuv(chosen) &&
+      source->color_range != AVCOL_RANGE_JPEG) {
+    // mjpeg takes plain YUV only at full range. Expand the range in the same
+    // layout instead of going through RGB.
+    AVPixelFormat full = FullRangeYuv(chosen);
+    if (full != AV_PIX_FMT_NONE && Contains(formats, full)) {
+      chosen = full;
+    }
+  }
+  return chosen;
+}
+
+bool ImageEncoder::EncodeFrame(const AVFrame* input,
+                               std::vector<uint8_t>* out, int* out_width,
+                               int* out_height, std::string* error) {
+  int width = width_;
+  int height = height_;
+  if (width == 0 && height == 0) {
+    width = input->width;
+    height = input->height;
+  } else if (height == 0) {
+    height = std::max(1, static_cast<int>(std::lround(
+                             static_cast<double>(input->height) * width /
+                             input->width)));
+  } else if (width == 0) {
+    width = std::max(1, static_cast<int>(std::lround(
+                            static_cast<double>(input->width) * height /
+                            input->height)));
+  }
+
+  // Only resizes and formats the encoder lacks go through libswscale.
+  AVPixelFormat format = ChooseFormat(input);
+  ffmpeg::AVFramePtr frame;
+  if (width != input->width || height != input->height ||
+      format != input->format) {
+    webcodecs::SwsKey key = webcodecs::SwsKey::Scale(
+        input->width, input->height,
+        static_cast<AVPixelFormat>(input->format), width, height, format);
+    key.flags = scaling_.SwsFlags();
+    key.threads = scaling_.ThreadsOr(1);
+    key.colorspace = SwsColorspace(input->colorspace);
+    key.src_full_range = input->color_range == AVCOL_RANGE_JPEG;
+    if (!webcodecs::SwsPool::Instance().Ensure(&sws_, key)) {
+      *error = "Could not create sws context";
+      return false;
+    }
+    frame = ffmpeg::make_frame();
+    if (!frame) {
+      *error = "Failed to allocate frame";
+      return false;
+    }
+    frame->width = width;
+    frame->height = height;
+    frame->format = format;
+    if (webcodecs::FramePool::Instance().GetBuffer(frame.get()) < 0) {
+      *error = "Failed to allocate frame buffer";
+      return false;
+    }
+    int ret = webcodecs::ScaleFrame(sws_, frame.get(), input);
+    if (ret < 0) {
+      *error = "Failed to convert frame: " + webcodecs::FFmpegErrorString(ret);
+      return false;
+    }
+    // libswscale writes yuvj formats at full range, other YUV limited, and
+    // keeps the source matrix between YUV formats.
+    bool yuv_source = IsYuv(static_cast<AVPixelFormat>(input->format));
+    if (IsFullRangeYuv(format)) {
+      frame->color_range = AVCOL_RANGE_JPEG;
+    } else if (IsYuv(format)) {
+      frame->color_range = AVCOL_RANGE_MPEG;
+    }
+    frame->colorspace = IsYuv(format) && yuv_source ? input->colorspace
+                                                    : AVCOL_SPC_UNSPECIFIED;
+    frame->color_primaries = input->color_primaries;
+    frame->color_trc = input->color_trc;
+  } else {
+    frame.reset(av_frame_clone(input));
+    if (!frame) {
+      *error = "Failed to reference frame";
+      return false;
+    }
+  }
+
+  ffmpeg::AVCodecContextPtr context = ffmpeg::make_codec_context(codec_);
+  if (!context) {
+    *error = "Failed to allocate encoder context";
+    return false;
+  }
+  context->width = width;
+  context->height = height;
+  context->pix_fmt = format;
+  context->time_base = AVRational{1, 1};
+  context->framerate = AVRational{1, 1};
+  context->color_range = frame->color_range;
+  context->color_primaries = frame->color_primaries;
+  context->color_trc = frame->color_trc;
+  context->colorspace = frame->colorspace;
+  context->thread_count = 0;  // One per core; there is only the one frame
+
+  switch (codec_->id) {
+    case AV_CODEC_ID_MJPEG: {
+      // Fixed quantiser 2 (best) to 31 (smallest). mpegvideo takes it from
+      // the frame.
+      int qscale = static_cast<int>(std::lround(2 + (1 - quality_) * 29));
+      context->flags |= AV_CODEC_FLAG_QSCALE;
+      context->global_quality = FF_QP2LAMBDA * qscale;
+      frame->quality = context->global_quality;
+      // ChooseFormat() only hands mjpeg full-range YUV.
+      context->color_range = AVCOL_RANGE_JPEG;
+      break;
+    }
+    case AV_CODEC_ID_PNG:
+      break;  // Lossless; quality does not apply.
+    case AV_CODEC_ID_WEBP:
+      av_opt_set_double(context.get(), "quality", quality_ * 100,
+                        AV_OPT_SEARCH_CHILDREN);
+      SetOptionIfPresent(context.get(), "lossless", lossless_ ? 1 : 0);
+      break;
+    default:  // AV1 for AVIF
+      SetOptionIfPresent(context.get(), "crf",
+                         lossless_ ? 0 : std::lround((1 - quality_) * 63));
+      SetOptionIfPresent(context.get(), "lossless", lossless_ ? 1 : 0);
+      SetOptionIfPresent(context.get(), "still-picture", 1);
+      av_opt_set(context.get(), "usage", "allintra", AV_OPT_SEARCH_CHILDREN);
+      context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;  // av1C for the muxer
+      break;
+  }
+
+  int ret = avcodec_open2(context.get(), codec_, nullptr);
+  if (ret < 0) {
+    *error = "Could not open encoder: " + webcodecs::FFmpegErrorString(ret);
+    return false;
+  }
+
+  frame->pts = 0;
+  frame->pict_type = AV_PICTURE_TYPE_I;
+  ret = avcodec_send_frame(context.get(), frame.get());
+  if (ret >= 0) {
+    ret = avcodec_send_frame(context.get(), nullptr);
+  }
+  *out_width = width;
+  *out_height = height;
+  ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
+  if (ret >= 0) {
+    ret = packet ? avcodec_receive_packet(context.get(), packet.get())
+                 : AVERROR(ENOMEM);
+  }
+  if (ret < 0) {
+    *error = "Encode error: " + webcodecs::FFmpegErrorString(ret);
+    return false;
+  }
+
+  if (type_ == "image/avif") {
+    return MuxAvif(context.get(), packet.get(), out, error);
+  }
+  // mjpeg, png and libwebp packets are complete image files.
+  out->assign(packet->data, packet->data + packet->size);
+  return true;
+}
+
+bool ImageEncoder::MuxAvif(const AVCodecContext* context, AVPacket* packet,
+                           std::vector<uint8_t>* out, std::string* error) {
+  AVFormatContext* raw = nullptr;
+  int ret = avformat_alloc_output_context2(&raw, nullptr, "avif", nullptr);
+  ffmpeg::AVFormatContextOutputPtr muxer(raw);
+  if (ret < 0 || !muxer) {
+    *error =
+        "Could not create AVIF muxer: " + webcodecs::FFmpegErrorString(ret);
+    return false;
+  }
+  AVStream* stream = avformat_new_stream(muxer.get(), nullptr);
+  if (!stream ||
+      avcodec_parameters_from_context(stream->codecpar, context) < 0) {
+    *error = "Could not create AVIF stream";
+    return false;
+  }
+  stream->time_base = context->time_base;
+
+  // movenc seeks back to patch box sizes, which a dynamic buffer allows.
+  ret = avio_open_dyn_buf(&muxer->pb);
+  if (ret < 0) {
+    *error = "Failed to allocate output: " + webcodecs::FFmpegErrorString(ret);
+    return false;
+  }
+  muxer->flags |= AVFMT_FLAG_CUSTOM_IO;  // Closed below, not by the deleter
+
+  ret = avformat_write_header(muxer.get(), nullptr);
+  if (ret >= 0) {
+    packet->stream_index = stream->index;
+    av_packet_rescale_ts(packet, context->time_base, stream->time_base);
+    ret = av_write_frame(muxer.get(), packet);
+  }
+  if (ret >= 0) {
+    ret = av_write_trailer(muxer.get());
+  }
+  uint8_t* data = nullptr;
+  int size = avio_close_dyn_buf(muxer->pb, &data);
+  muxer->pb = nullptr;
+  if (ret >= 0) {
+    out->assign(data, data + size);
+  } else {
+    *error = "Could not write AVIF: " + webcodecs::FFmpegErrorString(ret);
+  }
+  av_free(data);
+  return ret >= 0;
+}
+
+class ImageEncoder::EncodeWorker : public Napi::AsyncWorker {
+ public:
+  EncodeWorker(Napi::Env env, ImageEncoder* encoder, ffmpeg::AVFramePtr input)
+      : Napi::AsyncWorker(env, "ImageEncoder.encode"),
+        encoder_(encoder),
+        encoder_ref_(Napi::Persistent(encoder->Value())),
+        input_(std::move(input)),
+        deferred_(Napi::Promise::Deferred::New(env)) {}
+
+  Napi::Promise Promise() const { return deferred_.Promise(); }
+
+  void Execute() override {
+    std::lock_guard<std::mutex> lock(encoder_->mutex_);
+    if (encoder_->closed_) {
+      SetError("AbortError: ImageEncoder was closed");
+      return;
+    }
+    std::string error;
+    if (!encoder_->EncodeFrame(input_.get(), &output_, &width_, &height_,
+                               &error)) {
+      SetError(error);
+    }
+    input_.reset();
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+    // Hand the bytes over without a copy; the Buffer frees them.
+    auto* owned = new std::vector<uint8_t>(std::move(output_));
+    Napi::Buffer<uint8_t> data = Napi::Buffer<uint8_t>::New(
+        env, owned->data(), owned->size(),
+        [](Napi::Env, uint8_t*, std::vector<uint8_t>* hint) { delete hint; },
+        owned);
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("data", data);
+    result.Set("type", encoder_->type_);
+    result.Set("width", width_);
+    result.Set("height", height_);
+    deferred_.Resolve(result);
+  }
+
+  void OnError(const Napi::Error& e) override { deferred_.Reject(e.Value()); }
+
+ private:
+  ImageEncoder* encoder_;
+  Napi::ObjectReference encoder_ref_;  // Keeps encoder_ alive
+  ffmpeg::AVFramePtr input_;
+  std::vector<uint8_t> output_;
+  int width_ = 0;
+  int height_ = 0;
+  Napi::Promise::Deferred deferred_;
+};
+
+Napi::Value ImageEncoder::Encode(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "ImageEncoder is closed")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "frame must be a VideoFrame object")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  VideoFrame* video_frame =
+      Napi::ObjectWrap<VideoFrame>::Unwrap(info[0].As<Napi::Object>());
+  if (PixelFormatToAV(video_frame->GetFormat()) == AV_PIX_FMT_NONE) {
+    Napi::TypeError::New(env, "Unsupported VideoFrame format")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // Take the reference on the main thread; the worker never touches JS.
+  ffmpeg::AVFramePtr input = ffmpeg::make_frame();
+  if (!input || !video_frame->RefAVFrame(input.get())) {
+    Napi::Error::New(env, "Failed to reference VideoFrame data")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // The frame's colour space as JS reports it; packed frames carry none.
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object cs = info[1].As<Napi::Object>();
+    input->color_primaries = webcodecs::AttrAsEnum(
+        cs, "primaries", input->color_primaries, webcodecs::kColorPrimariesMap);
+    input->color_trc = webcodecs::AttrAsEnum(cs, "transfer", input->color_trc,
+                                             webcodecs::kTransferMap);
+    input->colorspace = webcodecs::AttrAsEnum(cs, "matrix", input->colorspace,
+                                              webcodecs::kMatrixMap);
+    if (cs.Get("fullRange").IsBoolean()) {
+      input->color_range = cs.Get("fullRange").As<Napi::Boolean>().Value()
+                               ? AVCOL_RANGE_JPEG
+                               : AVCOL_RANGE_MPEG;
+    }
+  }
+
+  // The worker deletes itself after settling the promise.
+  auto* worker = new EncodeWorker(env, this, std::move(input));
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
+}
+
+void ImageEncoder::Close(const Napi::CallbackInfo& info) {
+  // An encode in progress finishes; queued ones reject.
+  closed_ = true;
+}
+
+Napi::Value ImageEncoder::GetType(const Napi::CallbackInfo& info) {
+  return Napi::String::New(info.Env(), type_);
+}
+
+Napi::Value ImageEncoder::IsTypeSupported(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsString()) {
+    return Napi::Boolean::New(env, false);
+  }
+  return Napi::Boolean::New(
+      env, FindImageEncoder(info[0].As<Napi::String>().Utf8Value()) != nullptr);
+}
+
+Napi::Object InitImageEncoder(Napi::Env env, Napi::Object exports) {
+  return ImageEncoder::Init(env, exports);
+}
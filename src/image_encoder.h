@@ -0,0 +1,78 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// ImageEncoder - encode a VideoFrame to a JPEG, PNG, WebP or AVIF image.
+//
+// The frame reaches the encoder in its own pixel format whenever the encoder
+// takes it (I420 straight into libwebp or an AV1 encoder, full-range I420
+// into mjpeg); libswscale only runs to resize, or for formats the encoder
+// lacks, and then converts to the closest format it does take rather than
+// to RGBA. encode() runs on the libuv thread pool, so several images encode
+// in parallel while the event loop stays free. Encodes of one ImageEncoder
+// are serialized by mutex_.
+
+#ifndef SRC_IMAGE_ENCODER_H_
+#define SRC_IMAGE_ENCODER_H_
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+#include <napi.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "src/common.h"
+#include "src/ffmpeg_raii.h"
+#include "src/sws_pool.h"
+
+class ImageEncoder : public Napi::ObjectWrap<ImageEncoder> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  static Napi::Value IsTypeSupported(const Napi::CallbackInfo& info);
+  explicit ImageEncoder(const Napi::CallbackInfo& info);
+  ~ImageEncoder() = default;
+
+  // Disallow copy and assign.
+  ImageEncoder(const ImageEncoder&) = delete;
+  ImageEncoder& operator=(const ImageEncoder&) = delete;
+
+ private:
+  // Runs one encode() call.
+  class EncodeWorker;
+
+  Napi::Value Encode(const Napi::CallbackInfo& info);
+  void Close(const Napi::CallbackInfo& info);
+  Napi::Value GetType(const Napi::CallbackInfo& info);
+
+  // Encoder for a MIME type, or nullptr if none is built in.
+  static const AVCodec* FindImageEncoder(const std::string& type);
+  // Pixel format to hand |codec_| for a |source| frame.
+  AVPixelFormat ChooseFormat(const AVFrame* source) const;
+  // Encode |input| into a complete image file in |out|, setting the size it
+  // was encoded at; caller holds mutex_.
+  bool EncodeFrame(const AVFrame* input, std::vector<uint8_t>* out,
+                   int* out_width, int* out_height, std::string* error);
+  // Wrap the AV1 bitstream in |packet| into an AVIF file.
+  bool MuxAvif(const AVCodecContext* context, AVPacket* packet,
+               std::vector<uint8_t>* out, std::string* error);
+
+  std::string type_;
+  const AVCodec* codec_;
+  double quality_;  // 0 (smallest) to 1 (best)
+  bool lossless_;
+  // Output size; 0 keeps the source size or, with the other set, the aspect
+  // ratio.
+  int width_;
+  int height_;
+  webcodecs::ScalingConfig scaling_;
+  webcodecs::SwsPool::Lease sws_;  // Leased for the last conversion
+  std::mutex mutex_;
+  std::atomic<bool> closed_;
+};
+
+#endif  // SRC_IMAGE_ENCODER_H_
@@ -0,0 +1,137 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// KeyframeIndex implementation.
+
+#include "src/keyframe_index.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace webcodecs {
+
+namespace {
+
+// Layout (little-endian):
+//   char[4] magic, u32 version, i32 stream_index, i32 tb_num, i32 tb_den,
+//   u32 count, then count x { i64 timestamp, i64 position }.
+constexpr uint8_t kMagic[4] = {'N', 'W', 'K', 'I'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = 24;
+constexpr size_t kEntrySize = 16;
+
+void PutU32(std::vector<uint8_t>* out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out->push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void PutU64(std::vector<uint8_t>* out, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    out->push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+uint32_t GetU32(const uint8_t* p) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    value |= static_cast<uint32_t>(p[i]) << (8 * i);
+  }
+  return value;
+}
+
+uint64_t GetU64(const uint8_t* p) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) {
+    value |= static_cast<uint64_t>(p[i]) << (8 * i);
+  }
+  return value;
+}
+
+bool ByTimestamp(const KeyframeEntry& a, const KeyframeEntry& b) {
+  return a.timestamp < b.timestamp;
+}
+
+}  // namespace
+
+void KeyframeIndex::Add(int64_t timestamp, int64_t position) {
+  entries_.push_back({timestamp, position});
+}
+
+void KeyframeIndex::Finalize() {
+  std::stable_sort(entries_.begin(), entries_.end(), ByTimestamp);
+  entries_.erase(std::unique(entries_.begin(), entries_.end(),
+                             [](const KeyframeEntry& a,
+                                const KeyframeEntry& b) {
+                               return a.timestamp == b.timestamp;
+                             }),
+                 entries_.end());
+}
+
+const KeyframeEntry* KeyframeIndex::FindAtOrBefore(int64_t timestamp) const {
+  if (entries_.empty()) {
+    return nullptr;
+  }
+  auto it = std::upper_bound(entries_.begin(), entries_.end(),
+                             KeyframeEntry{timestamp, 0}, ByTimestamp);
+  return it == entries_.begin() ? &entries_.front() : &*(it - 1);
+}
+
+const KeyframeEntry* KeyframeIndex::FindNearest(int64_t timestamp) const {
+  const KeyframeEntry* before = FindAtOrBefore(timestamp);
+  if (!before || before == &entries_.back() || before->timestamp > timestamp) {
+    return before;
+  }
+  const KeyframeEntry* after = before + 1;
+  return timestamp - before->timestamp <= after->timestamp - timestamp
+             ? before
+             : after;
+}
+
+std::vector<uint8_t> KeyframeIndex::Serialize() const {
+  std::vector<uint8_t> out(kMagic, kMagic + sizeof(kMagic));
+  out.reserve(kHeaderSize + entries_.size() * kEntrySize);
+  PutU32(&out, kVersion);
+  PutU32(&out, static_cast<uint32_t>(stream_index_));
+  PutU32(&out, static_cast<uint32_t>(time_base_.num));
+  PutU32(&out, static_cast<uint32_t>(time_base_.den));
+  PutU32(&out, static_cast<uint32_t>(entries_.size()));
+  for (const KeyframeEntry& entry : entries_) {
+    PutU64(&out, static_cast<uint64_t>(entry.timestamp));
+    PutU64(&out, static_cast<uint64_t>(entry.position));
+  }
+  return out;
+}
+
+bool KeyframeIndex::Deserialize(const uint8_t* data, size_t size,
+                                KeyframeIndex* out) {
+  if (!data || size < kHeaderSize ||
+      !std::equal(kMagic, kMagic + sizeof(kMagic), data) ||
+      GetU32(data + 4) != kVersion) {
+    return false;
+  }
+  auto stream_index = static_cast<int32_t>(GetU32(data + 8));
+  AVRational time_base = {static_cast<int32_t>(GetU32(data + 12)),
+                          static_cast<int32_t>(GetU32(data + 16))};
+  uint32_t count = GetU32(data + 20);
+  if (stream_index < 0 || time_base.num <= 0 || time_base.den <= 0 ||
+      (size - kHeaderSize) / kEntrySize < count) {
+    return false;
+  }
+
+  KeyframeIndex index(stream_index, time_base);
+  index.entries_.reserve(count);
+  const uint8_t* p = data + kHeaderSize;
+  for (uint32_t i = 0; i < count; ++i, p += kEntrySize) {
+    index.entries_.push_back({static_cast<int64_t>(GetU64(p)),
+                              static_cast<int64_t>(GetU64(p + 8))});
+  }
+  if (!std::is_sorted(index.entries_.begin(), index.entries_.end(),
+                      ByTimestamp)) {
+    return false;
+  }
+  *out = std::move(index);
+  return true;
+}
+
+}  // namespace webcodecs
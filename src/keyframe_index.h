@@ -0,0 +1,64 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// KeyframeIndex - sorted keyframe table for Demuxer random access.
+//
+// Maps keyframe timestamps of one stream to their byte offsets so repeated
+// seeks are a binary search plus one positioned read, with nothing demuxed
+// in between. The index serializes to a small versioned blob that callers
+// can persist next to the media and load on a later open.
+
+#ifndef SRC_KEYFRAME_INDEX_H_
+#define SRC_KEYFRAME_INDEX_H_
+
+extern "C" {
+#include <libavutil/rational.h>
+}
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace webcodecs {
+
+struct KeyframeEntry {
+  int64_t timestamp;  // In the stream's time base
+  int64_t position;   // Byte offset of the packet, or -1 if unknown
+};
+
+class KeyframeIndex {
+ public:
+  KeyframeIndex() = default;
+  KeyframeIndex(int stream_index, AVRational time_base)
+      : stream_index_(stream_index), time_base_(time_base) {}
+
+  // Entries may arrive in any order; duplicates keep the first position.
+  void Add(int64_t timestamp, int64_t position);
+  // Sort and deduplicate; call once after the last Add().
+  void Finalize();
+
+  bool empty() const { return entries_.empty(); }
+  size_t size() const { return entries_.size(); }
+  int stream_index() const { return stream_index_; }
+  AVRational time_base() const { return time_base_; }
+
+  // Latest keyframe at or before |timestamp|, else the first keyframe.
+  // Returns nullptr if the index is empty.
+  const KeyframeEntry* FindAtOrBefore(int64_t timestamp) const;
+  // Keyframe closest to |timestamp| in either direction.
+  const KeyframeEntry* FindNearest(int64_t timestamp) const;
+
+  std::vector<uint8_t> Serialize() const;
+  // Returns false if |data| is not a serialized index of a supported version.
+  static bool Deserialize(const uint8_t* data, size_t size,
+                          KeyframeIndex* out);
+
+ private:
+  int stream_index_ = -1;
+  AVRational time_base_ = {0, 1};
+  std::vector<KeyframeEntry> entries_;
+};
+
+}  // namespace webcodecs
+
+#endif  // SRC_KEYFRAME_INDEX_H_
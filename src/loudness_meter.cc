@@ -0,0 +1,362 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// LoudnessMeter implementation.
+
+#include "src/loudness_meter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace webcodecs {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kNegativeInfinity = -std::numeric_limits<double>::infinity();
+
+// ITU-R BS.1770-4 Annex 2: 4x oversampling interpolator, one row per phase.
+constexpr double kTruePeakPhases[4][12] = {
+    {0.0017089843750, 0.0109863281250, -0.0196533203125, 0.0332031250000,
+     -0.0594482421875, 0.1373291015625, 0.9721679687500, -0.1022949218750,
+     0.0476074218750, -0.0266113281250, 0.0148925781250, -0.0083007812500},
+    {-0.0291748046875, 0.0292968750000, -0.0517578125000, 0.0891113281250,
+     -0.1665039062500, 0.4650878906250, 0.7797851562500, -0.2003173828125,
+     0.1015625000000, -0.0582275390625, 0.0330810546875, -0.0189208984375},
+    {-0.0189208984375, 0.0330810546875, -0.0582275390625, 0.1015625000000,
+     -0.2003173828125, 0.7797851562500, 0.4650878906250, -0.1665039062500,
+     0.0891113281250, -0.0517578125000, 0.0292968750000, -0.0291748046875},
+    {-0.0083007812500, 0.0148925781250, -0.0266113281250, 0.0476074218750,
+     -0.1022949218750, 0.9721679687500, 0.1373291015625, -0.0594482421875,
+     0.0332031250000, -0.0196533203125, 0.0109863281250, 0.0017089843750},
+};
+
+// K-weighting at any rate: the BS.1770 48 kHz filters re-derived through
+// the bilinear transform from their analogue prototypes (as libebur128).
+void DesignKWeighting(int sample_rate, double* shelf, double* highpass) {
+  double f0 = 1681.974450955533;
+  double gain = 3.999843853973347;
+  double q = 0.7071752369554196;
+  double k = std::tan(kPi * f0 / sample_rate);
+  double vh = std::pow(10.0, gain / 20.0);
+  double vb = std::pow(vh, 0.4996667741545416);
+  double a0 = 1.0 + k / q + k * k;
+  shelf[0] = (vh + vb * k / q + k * k) / a0;
+  shelf[1] = 2.0 * (k * k - vh) / a0;
+  shelf[2] = (vh - vb * k / q + k * k) / a0;
+  shelf[3] = 2.0 * (k * k - 1.0) / a0;
+  shelf[4] = (1.0 - k / q + k * k) / a0;
+
+  f0 = 38.13547087602444;
+  q = 0.5003270373238773;
+  k = std::tan(kPi * f0 / sample_rate);
+  a0 = 1.0 + k / q + k * k;
+  highpass[0] = 1.0;
+  highpass[1] = -2.0;
+  highpass[2] = 1.0;
+  highpass[3] = 2.0 * (k * k - 1.0) / a0;
+  highpass[4] = (1.0 - k / q + k * k) / a0;
+}
+
+}  // namespace
+
+LoudnessMeter::LoudnessMeter() { Reset(); }
+
+void LoudnessMeter::Reset() {
+  sample_rate_ = 0;
+  channels_.clear();
+  sub_block_size_ = 0;
+  sub_block_frames_ = 0;
+  sub_blocks_.fill(0);
+  sub_block_count_ = 0;
+  sub_block_next_ = 0;
+  for (Histogram* histogram : {&momentary_histogram_, &short_term_histogram_}) {
+    histogram->counts.assign(kBins, 0);
+    histogram->energies.assign(kBins, 0);
+  }
+  momentary_ = short_term_ = 0;
+  max_momentary_ = max_short_term_ = 0;
+  have_momentary_ = have_short_term_ = false;
+  true_peak_ = sample_peak_ = sum_squares_ = 0;
+  samples_ = frames_ = 0;
+}
+
+void LoudnessMeter::Configure(int sample_rate,
+                              const std::vector<double>& weights,
+                              bool true_peak) {
+  double shelf[5];
+  double highpass[5];
+  DesignKWeighting(sample_rate, shelf, highpass);
+  shelf_ = {shelf[0], shelf[1], shelf[2], shelf[3], shelf[4]};
+  highpass_ = {highpass[0], highpass[1], highpass[2], highpass[3],
+               highpass[4]};
+
+  sample_rate_ = sample_rate;
+  true_peak_enabled_ = true_peak;
+  channels_.assign(weights.size(), Channel());
+  for (size_t i = 0; i < weights.size(); ++i) {
+    channels_[i].weight = weights[i];
+  }
+  // The windows restart with the new stream; the histograms carry on.
+  sub_block_size_ = std::max(1, static_cast<int>(std::lround(
+                                    sample_rate / 10.0)));
+  sub_block_frames_ = 0;
+  sub_blocks_.fill(0);
+  sub_block_count_ = 0;
+  sub_block_next_ = 0;
+}
+
+double LoudnessMeter::ToLoudness(double energy) {
+  return energy > 0 ? -0.691 + 10.0 * std::log10(energy) : kNegativeInfinity;
+}
+
+void LoudnessMeter::AddToHistogram(Histogram* histogram, double energy) {
+  double loudness = ToLoudness(energy);
+  if (!(loudness > kMinLoudness)) {
+    return;  // Below the absolute gate
+  }
+  int bin = std::min(kBins - 1, static_cast<int>((loudness - kMinLoudness) /
+                                                 kBinWidth));
+  histogram->counts[bin]++;
+  histogram->energies[bin] += energy;
+}
+
+void LoudnessMeter::Load(const uint8_t* const* data, SampleFormat format,
+                         bool planar, int channel, int offset, int frames) {
+  int stride = planar ? 1 : static_cast<int>(channels_.size());
+  int first = planar ? offset : offset * stride + channel;
+  const uint8_t* plane = data[planar ? channel : 0];
+  double* out = scratch_.data();
+  switch (format) {
+    case SampleFormat::kU8: {
+      const uint8_t* in = plane + first;
+      for (int i = 0; i < frames; ++i) {
+        out[i] = (in[i * stride] - 128) * (1.0 / 128);
+      }
+      break;
+    }
+    case SampleFormat::kS16: {
+      const int16_t* in = reinterpret_cast<const int16_t*>(plane) + first;
+      for (int i = 0; i < frames; ++i) {
+        out[i] = in[i * stride] * (1.0 / 32768);
+      }
+      break;
+    }
+    case SampleFormat::kS32: {
+      const int32_t* in = reinterpret_cast<const int32_t*>(plane) + first;
+      for (int i = 0; i < frames; ++i) {
+        out[i] = in[i * stride] * (1.0 / 2147483648.0);
+      }
+      break;
+    }
+    case SampleFormat::kF32: {
+      const float* in = reinterpret_cast<const float*>(plane) + first;
+      for (int i = 0; i < frames; ++i) {
+        out[i] = in[i * stride];
+      }
+      break;
+    }
+  }
+}
+
+void LoudnessMeter::ProcessChannel(Channel* channel, int frames) {
+  const double* in = scratch_.data();
+
+  // Levels of the unweighted signal.
+  double peak = sample_peak_;
+  double squares = 0;
+  for (int i = 0; i < frames; ++i) {
+    peak = std::max(peak, std::fabs(in[i]));
+    squares += in[i] * in[i];
+  }
+  sample_peak_ = peak;
+  sum_squares_ += squares;
+
+  // K-weighting: the two biquads in direct form II.
+  double s1 = channel->z[0][0], s2 = channel->z[0][1];
+  double t1 = channel->z[1][0], t2 = channel->z[1][1];
+  double energy = 0;
+  for (int i = 0; i < frames; ++i) {
+    double w = in[i] - shelf_.a1 * s1 - shelf_.a2 * s2;
+    double y = shelf_.b0 * w + shelf_.b1 * s1 + shelf_.b2 * s2;
+    s2 = s1;
+    s1 = w;
+    double v = y - highpass_.a1 * t1 - highpass_.a2 * t2;
+    double z = highpass_.b0 * v + highpass_.b1 * t1 + highpass_.b2 * t2;
+    t2 = t1;
+    t1 = v;
+    energy += z * z;
+  }
+  channel->z[0][0] = s1;
+  channel->z[0][1] = s2;
+  channel->z[1][0] = t1;
+  channel->z[1][1] = t2;
+  channel->energy += energy;
+
+  if (!true_peak_enabled_) {
+    true_peak_ = std::max(true_peak_, peak);
+    return;
+  }
+  // Peaks between samples, from the interpolated 4x signal.
+  std::array<double, kTruePeakTaps>& history = channel->history;
+  double true_peak = true_peak_;
+  for (int i = 0; i < frames; ++i) {
+    std::memmove(&history[1], &history[0],
+                 (kTruePeakTaps - 1) * sizeof(double));
+    history[0] = in[i];
+    for (const auto& phase : kTruePeakPhases) {
+      double sum = 0;
+      for (int k = 0; k < kTruePeakTaps; ++k) {
+        sum += phase[k] * history[k];
+      }
+      true_peak = std::max(true_peak, std::fabs(sum));
+    }
+  }
+  // The interpolator only smooths; never report less than the samples.
+  true_peak_ = std::max(true_peak, peak);
+}
+
+void LoudnessMeter::AddSamples(const uint8_t* const* data,
+                               SampleFormat format, bool planar, int frames) {
+  if (!configured() || channels_.empty() || frames <= 0) {
+    return;
+  }
+  int offset = 0;
+  while (offset < frames) {
+    int segment = std::min(frames - offset,
+                           sub_block_size_ - sub_block_frames_);
+    if (scratch_.size() < static_cast<size_t>(segment)) {
+      scratch_.resize(sub_block_size_);
+    }
+    for (size_t c = 0; c < channels_.size(); ++c) {
+      Load(data, format, planar, static_cast<int>(c), offset, segment);
+      ProcessChannel(&channels_[c], segment);
+    }
+    offset += segment;
+    sub_block_frames_ += segment;
+    if (sub_block_frames_ == sub_block_size_) {
+      EndSubBlock();
+    }
+  }
+  frames_ += frames;
+  samples_ += static_cast<int64_t>(frames) * channels_.size();
+}
+
+double LoudnessMeter::WindowEnergy(int blocks) const {
+  double sum = 0;
+  for (int i = 1; i <= blocks; ++i) {
+    sum += sub_blocks_[(sub_block_next_ - i + kShortTermBlocks) %
+                       kShortTermBlocks];
+  }
+  return sum / blocks;
+}
+
+void LoudnessMeter::EndSubBlock() {
+  double energy = 0;
+  for (Channel& channel : channels_) {
+    energy += channel.weight * channel.energy / sub_block_size_;
+    channel.energy = 0;
+  }
+  sub_block_frames_ = 0;
+  sub_blocks_[sub_block_next_] = energy;
+  sub_block_next_ = (sub_block_next_ + 1) % kShortTermBlocks;
+  sub_block_count_++;
+
+  // 400 ms blocks overlapping by 75%, and 3 s windows every 100 ms.
+  if (sub_block_count_ >= kMomentaryBlocks) {
+    momentary_ = WindowEnergy(kMomentaryBlocks);
+    max_momentary_ = std::max(max_momentary_, momentary_);
+    have_momentary_ = true;
+    AddToHistogram(&momentary_histogram_, momentary_);
+  }
+  if (sub_block_count_ >= kShortTermBlocks) {
+    short_term_ = WindowEnergy(kShortTermBlocks);
+    max_short_term_ = std::max(max_short_term_, short_term_);
+    have_short_term_ = true;
+    AddToHistogram(&short_term_histogram_, short_term_);
+  }
+}
+
+LoudnessMeter::Summary LoudnessMeter::GetSummary() const {
+  Summary summary;
+  summary.momentary = have_momentary_ ? ToLoudness(momentary_)
+                                      : kNegativeInfinity;
+  summary.max_momentary = have_momentary_ ? ToLoudness(max_momentary_)
+                                          : kNegativeInfinity;
+  summary.short_term = have_short_term_ ? ToLoudness(short_term_)
+                                        : kNegativeInfinity;
+  summary.max_short_term = have_short_term_ ? ToLoudness(max_short_term_)
+                                            : kNegativeInfinity;
+
+  // Integrated: mean of the blocks above a gate 10 LU under the mean of
+  // those above the absolute gate.
+  const Histogram& blocks = momentary_histogram_;
+  uint64_t count = 0;
+  double energy = 0;
+  for (int i = 0; i < kBins; ++i) {
+    count += blocks.counts[i];
+    energy += blocks.energies[i];
+  }
+  summary.integrated = kNegativeInfinity;
+  if (count > 0) {
+    double gate = ToLoudness(energy / count) - 10.0;
+    int first = std::max(
+        0, static_cast<int>(std::ceil((gate - kMinLoudness) / kBinWidth)));
+    count = 0;
+    energy = 0;
+    for (int i = first; i < kBins; ++i) {
+      count += blocks.counts[i];
+      energy += blocks.energies[i];
+    }
+    if (count > 0) {
+      summary.integrated = ToLoudness(energy / count);
+    }
+  }
+
+  // Loudness range: the 10th to 95th percentile of short-term loudness
+  // above a gate 20 LU under its mean.
+  const Histogram& windows = short_term_histogram_;
+  count = 0;
+  energy = 0;
+  for (int i = 0; i < kBins; ++i) {
+    count += windows.counts[i];
+    energy += windows.energies[i];
+  }
+  summary.loudness_range = 0;
+  if (count > 0) {
+    double gate = ToLoudness(energy / count) - 20.0;
+    int first = std::max(
+        0, static_cast<int>(std::ceil((gate - kMinLoudness) / kBinWidth)));
+    uint64_t gated = 0;
+    for (int i = first; i < kBins; ++i) {
+      gated += windows.counts[i];
+    }
+    if (gated > 0) {
+      // Nearest-rank percentiles over bin centres.
+      auto percentile = [&](double p) {
+        uint64_t rank = static_cast<uint64_t>(
+            std::ceil(p * static_cast<double>(gated)));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (int i = first; i < kBins; ++i) {
+          seen += windows.counts[i];
+          if (seen >= rank) {
+            return kMinLoudness + (i + 0.5) * kBinWidth;
+          }
+        }
+        return kMinLoudness + (kBins - 0.5) * kBinWidth;
+      };
+      summary.loudness_range = percentile(0.95) - percentile(0.10);
+    }
+  }
+
+  summary.true_peak = true_peak_;
+  summary.sample_peak = sample_peak_;
+  summary.rms = samples_ > 0 ? std::sqrt(sum_squares_ / samples_) : 0;
+  summary.frames = frames_;
+  return summary;
+}
+
+}  // namespace webcodecs
@@ -0,0 +1,141 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// LoudnessMeter - EBU R128 loudness, true peak and level metering.
+//
+// Measures decoded audio as it goes past, so a QC pass needs only the
+// summary rather than every sample in JS:
+// - Momentary (400 ms), short-term (3 s) and gated integrated loudness per
+//   ITU-R BS.1770-4, with K-weighting designed for the stream's own rate.
+// - Loudness range per EBU Tech 3342.
+// - True peak from 4x oversampling with the BS.1770-4 Annex 2 interpolator,
+//   sample peak and RMS level.
+// Gating keeps loudness histograms at 0.01 LU resolution rather than every
+// block, so memory stays fixed however long the stream runs. Not
+// thread-safe; callers serialize access.
+
+#ifndef SRC_LOUDNESS_METER_H_
+#define SRC_LOUDNESS_METER_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace webcodecs {
+
+class LoudnessMeter {
+ public:
+  // Layout of the samples passed to AddSamples().
+  enum class SampleFormat { kU8, kS16, kS32, kF32 };
+
+  // Loudness in LUFS and levels as linear amplitude (1.0 = full scale).
+  // Loudness is -infinity until a block (400 ms) is complete, and the
+  // integrated value stays so while everything is below the -70 LUFS gate.
+  struct Summary {
+    double integrated;
+    double momentary;  // Last 400 ms
+    double short_term;  // Last 3 s
+    double max_momentary;
+    double max_short_term;
+    double loudness_range;  // LU
+    double true_peak;  // Sample peak when true peak is off
+    double sample_peak;
+    double rms;
+    int64_t frames;  // Sample frames measured
+  };
+
+  LoudnessMeter();
+
+  // Start filtering a stream of |weights|.size() channels at |sample_rate|.
+  // |weights| are the BS.1770 channel weights (0 for LFE, 1.41 for
+  // surrounds). Measurements so far are kept, so a format change mid-stream
+  // carries on; Reset() clears them.
+  void Configure(int sample_rate, const std::vector<double>& weights,
+                 bool true_peak);
+
+  bool configured() const { return sample_rate_ > 0; }
+  int sample_rate() const { return sample_rate_; }
+  int channels() const { return static_cast<int>(channels_.size()); }
+  bool true_peak_enabled() const { return true_peak_enabled_; }
+
+  // Measure |frames| sample frames: one plane per channel when |planar|,
+  // else channels interleaved in data[0].
+  void AddSamples(const uint8_t* const* data, SampleFormat format, bool planar,
+                  int frames);
+
+  Summary GetSummary() const;
+
+  // Drop every measurement and the configuration.
+  void Reset();
+
+ private:
+  // Loudness histogram: 0.01 LU bins from the -70 LUFS absolute gate up.
+  static constexpr int kBins = 10000;
+  static constexpr double kMinLoudness = -70.0;
+  static constexpr double kBinWidth = 0.01;
+  // Sub-blocks (100 ms) per momentary and short-term window.
+  static constexpr int kMomentaryBlocks = 4;
+  static constexpr int kShortTermBlocks = 30;
+  static constexpr int kTruePeakTaps = 12;
+
+  struct Biquad {
+    double b0, b1, b2, a1, a2;
+  };
+
+  struct Channel {
+    double weight = 1.0;
+    // Direct form II state of the two K-weighting stages.
+    double z[2][2] = {{0, 0}, {0, 0}};
+    double energy = 0;  // Filtered sum of squares in this sub-block
+    // Last input samples, newest first, for the true-peak interpolator.
+    std::array<double, kTruePeakTaps> history{};
+  };
+
+  struct Histogram {
+    std::vector<uint32_t> counts;
+    std::vector<double> energies;  // Sum of block energies per bin
+  };
+
+  static double ToLoudness(double energy);
+  static void AddToHistogram(Histogram* histogram, double energy);
+  // Convert channel |channel| of |frames| frames starting at |offset|.
+  void Load(const uint8_t* const* data, SampleFormat format, bool planar,
+            int channel, int offset, int frames);
+  void ProcessChannel(Channel* channel, int frames);
+  // Close the 100 ms sub-block and update the windows ending with it.
+  void EndSubBlock();
+  double WindowEnergy(int blocks) const;
+
+  int sample_rate_ = 0;
+  bool true_peak_enabled_ = true;
+  Biquad shelf_{};     // Stage 1: high shelf, head effects
+  Biquad highpass_{};  // Stage 2: RLB high-pass
+  std::vector<Channel> channels_;
+  std::vector<double> scratch_;  // One channel of the current segment
+
+  int sub_block_size_ = 0;  // Frames per 100 ms
+  int sub_block_frames_ = 0;  // Frames in the current sub-block
+  // Weighted energies of the last kShortTermBlocks sub-blocks.
+  std::array<double, kShortTermBlocks> sub_blocks_{};
+  int sub_block_count_ = 0;  // Total completed, for window warm-up
+  int sub_block_next_ = 0;   // Ring index
+
+  Histogram momentary_histogram_;
+  Histogram short_term_histogram_;
+  double momentary_ = 0;
+  double short_term_ = 0;
+  double max_momentary_ = 0;
+  double max_short_term_ = 0;
+  bool have_momentary_ = false;
+  bool have_short_term_ = false;
+
+  double true_peak_ = 0;
+  double sample_peak_ = 0;
+  double sum_squares_ = 0;  // Unweighted, all channels
+  int64_t samples_ = 0;
+  int64_t frames_ = 0;
+};
+
+}  // namespace webcodecs
+
+#endif  // SRC_LOUDNESS_METER_H_
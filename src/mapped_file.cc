@@ -0,0 +1,85 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// MappedFile implementation (POSIX).
+
+#include "src/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+namespace webcodecs {
+
+namespace {
+
+std::string ErrnoMessage(const char* what) {
+  return std::string(what) + ": " + std::strerror(errno);
+}
+
+}  // namespace
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path,
+                                             size_t padding,
+                                             std::string* error) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    *error = ErrnoMessage("open");
+    return nullptr;
+  }
+  std::unique_ptr<MappedFile> file = FromDescriptor(fd, padding, error);
+  close(fd);
+  return file;
+}
+
+std::unique_ptr<MappedFile> MappedFile::FromDescriptor(int fd, size_t padding,
+                                                       std::string* error) {
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    *error = ErrnoMessage("fstat");
+    return nullptr;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    *error = "not a regular file";
+    return nullptr;
+  }
+  if (st.st_size <= 0) {
+    *error = "file is empty";
+    return nullptr;
+  }
+  auto size = static_cast<uint64_t>(st.st_size);
+  if (size > std::numeric_limits<size_t>::max() - padding) {
+    *error = "file is too large to map";
+    return nullptr;
+  }
+
+  // Reserve the file and its padding as anonymous zero pages, then map the
+  // file over the start. The kernel zero-fills the tail of the last file
+  // page, and any whole page after it stays anonymous, so the padding never
+  // lands beyond the end of the file, where reading it would fault.
+  size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t mapping_size = (size + padding + page - 1) / page * page;
+  void* base = mmap(nullptr, mapping_size, PROT_READ,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    *error = ErrnoMessage("mmap");
+    return nullptr;
+  }
+  if (mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) ==
+      MAP_FAILED) {
+    *error = ErrnoMessage("mmap");
+    munmap(base, mapping_size);
+    return nullptr;
+  }
+  return std::unique_ptr<MappedFile>(
+      new MappedFile(base, static_cast<size_t>(size), mapping_size));
+}
+
+MappedFile::~MappedFile() { munmap(base_, mapping_size_); }
+
+}  // namespace webcodecs
@@ -0,0 +1,58 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// MappedFile - read-only memory mapping of a whole local file, so
+// ImageDecoder and Demuxer can read it in place instead of copying it onto
+// the heap first.
+//
+// The mapping is followed by |padding| zero bytes (FFmpeg wants
+// AV_INPUT_BUFFER_PADDING_SIZE past the end of packet data), even when the
+// file size is a multiple of the page size. Pages are loaded on first
+// access; truncating the file while it is mapped makes reads past the new
+// end fault (SIGBUS), as with any mmap reader.
+//
+// Thread Safety: immutable once created; data() may be read from any
+// thread.
+
+#ifndef SRC_MAPPED_FILE_H_
+#define SRC_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace webcodecs {
+
+class MappedFile {
+ public:
+  // Map the regular file at |path|. Returns nullptr and sets |error| on
+  // failure, including for empty files (mmap cannot map zero bytes).
+  static std::unique_ptr<MappedFile> Open(const std::string& path,
+                                          size_t padding, std::string* error);
+  // Map the regular file open as |fd|, from offset 0. |fd| stays owned by
+  // the caller and may be closed as soon as this returns.
+  static std::unique_ptr<MappedFile> FromDescriptor(int fd, size_t padding,
+                                                    std::string* error);
+
+  ~MappedFile();
+
+  // Disallow copy and assign.
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* data() const { return static_cast<const uint8_t*>(base_); }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(void* base, size_t size, size_t mapping_size)
+      : base_(base), size_(size), mapping_size_(mapping_size) {}
+
+  void* base_;
+  size_t size_;          // File bytes
+  size_t mapping_size_;  // File bytes and padding, rounded to pages
+};
+
+}  // namespace webcodecs
+
+#endif  // SRC_MAPPED_FILE_H_
@@ -3,12 +3,56 @@
 
 #include "src/muxer.h"
 
+#include <algorithm>
 #include <cstring>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "src/common.h"
+#include "src/encoded_audio_chunk.h"
+#include "src/encoded_video_chunk.h"
+
+namespace {
+
+struct OutputFormat {
+  const char* name;      // Value of MuxerInit.format
+  const char* muxer;     // FFmpeg muxer
+  const char* movflags;  // nullptr if not an MP4 variant
+  bool streamable;       // Can be written to a non-seekable sink
+};
+
+// Fragmented layouts put an empty moov up front and one moof+mdat per
+// keyframe, so every fragment is playable as soon as it is written.
+constexpr OutputFormat kOutputFormats[] = {
+    {"mp4", "mp4", nullptr, false},
+    {"fmp4", "mp4", "frag_keyframe+empty_moov+default_base_moof", true},
+    {"cmaf", "mp4", "frag_keyframe+empty_moov+default_base_moof+cmaf", true},
+    {"webm", "webm", nullptr, true},
+};
+
+const OutputFormat* FindOutputFormat(const std::string& name) {
+  for (const OutputFormat& format : kOutputFormats) {
+    if (name == format.name) {
+      return &format;
+    }
+  }
+  return nullptr;
+}
+
+void CopyExtradata(AVCodecParameters* par, const uint8_t* data, size_t size) {
+  par->extradata =
+      static_cast<uint8_t*>(av_mallocz(size + AV_INPUT_BUFFER_PADDING_SIZE));
+  if (par->extradata) {
+    memcpy(par->extradata, data, size);
+    par->extradata_size = static_cast<int>(size);
+  }
+}
+
+}  // namespace
 
-Napi::FunctionReference Muxer::constructor;
+// Per-thread constructor reference; see the class declaration.
+thread_local Napi::FunctionReference Muxer::constructor;
 
 Napi::Object InitMuxer(Napi::Env env, Napi::Object exports) {
   return Muxer::Init(env, exports);
@@ -22,8 +66,11 @@ Napi::Object Muxer::Init(Napi::Env env, Napi::Object exports) {
           InstanceMethod("addAudioTrack", &Muxer::AddAudioTrack),
           InstanceMethod("writeVideoChunk", &Muxer::WriteVideoChunk),
           InstanceMethod("writeAudioChunk", &Muxer::WriteAudioChunk),
+          InstanceMethod("flush", &Muxer::Flush),
           InstanceMethod("finalize", &Muxer::FinalizeOutput),
           InstanceMethod("close", &Muxer::Close),
+          InstanceAccessor("writeQueueSize", &Muxer::GetWriteQueueSize,
+                           nullptr),
       });
 
   constructor = Napi::Persistent(func);
@@ -49,18 +96,50 @@ Muxer::Muxer(const Napi::CallbackInfo& info)
 
   Napi::Object options = info[0].As<Napi::Object>();
 
-  if (!options.Has("filename")) {
-    Napi::TypeError::New(env, "filename is required")
+  bool has_filename = webcodecs::HasAttr(options, "filename");
+  bool has_sink = webcodecs::HasAttr(options, "onData");
+  if (!has_filename && !has_sink) {
+    Napi::TypeError::New(env, "filename or onData is required")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  if (has_filename && has_sink) {
+    Napi::TypeError::New(env, "filename and onData are mutually exclusive")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  if (has_sink && !options.Get("onData").IsFunction()) {
+    Napi::TypeError::New(env, "onData must be a function")
         .ThrowAsJavaScriptException();
     return;
   }
 
-  filename_ = options.Get("filename").As<Napi::String>().Utf8Value();
+  std::string format_name =
+      webcodecs::AttrAsStr(options, "format", has_sink ? "fmp4" : "mp4");
+  const OutputFormat* format = FindOutputFormat(format_name);
+  if (!format) {
+    Napi::TypeError::New(env, "Unsupported format: " + format_name)
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  if (has_sink && !format->streamable) {
+    Napi::TypeError::New(env, "format '" + format_name +
+                                  "' needs a seekable file; use 'fmp4' "
+                                  "with onData")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  movflags_ = format->movflags ? format->movflags : "";
 
-  // Allocate output format context for MP4.
+  if (has_filename) {
+    filename_ = options.Get("filename").As<Napi::String>().Utf8Value();
+  }
+
+  // Allocate output format context.
   AVFormatContext* raw_ctx = nullptr;
-  int ret = avformat_alloc_output_context2(&raw_ctx, nullptr, "mp4",
-                                           filename_.c_str());
+  int ret = avformat_alloc_output_context2(
+      &raw_ctx, nullptr, format->muxer,
+      has_filename ? filename_.c_str() : nullptr);
   if (ret < 0 || !raw_ctx) {
     Napi::Error::New(env, "Failed to allocate output format context")
         .ThrowAsJavaScriptException();
@@ -68,6 +147,21 @@ Muxer::Muxer(const Napi::CallbackInfo& info)
   }
   format_context_.reset(raw_ctx);
 
+  if (has_sink) {
+    output_ = webcodecs::MuxerOutput::Create();
+    if (!output_) {
+      format_context_.reset();
+      Napi::Error::New(env, "Failed to allocate output")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    format_context_->pb = output_->avio();
+    format_context_->flags |= AVFMT_FLAG_CUSTOM_IO;
+    on_data_callback_ =
+        Napi::Persistent(options.Get("onData").As<Napi::Function>());
+    return;
+  }
+
   // Open output file.
   ret = avio_open(&format_context_->pb, filename_.c_str(), AVIO_FLAG_WRITE);
   if (ret < 0) {
@@ -83,11 +177,92 @@ Muxer::Muxer(const Napi::CallbackInfo& info)
 Muxer::~Muxer() { Cleanup(); }
 
 void Muxer::Cleanup() {
-  if (format_context_ && !finalized_ && header_written_) {
+  StopWriter();
+  if (format_context_ && !finalized_ && header_written_ && !header_deferred_) {
     // Try to write trailer if header was written but not finalized.
     av_write_trailer(format_context_.get());
   }
   format_context_.reset();
+  output_.reset();
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  write_queue_.clear();
+  ready_output_.clear();
+  pending_extradata_.clear();
+}
+
+int Muxer::WriteHeader() {
+  AVDictionary* opts = nullptr;
+  if (!movflags_.empty()) {
+    av_dict_set(&opts, "movflags", movflags_.c_str(), 0);
+  }
+  // Never flush per packet; the writer flushes once per batch, so small
+  // writes coalesce in the AVIO buffer.
+  format_context_->flush_packets = 0;
+  int ret = avformat_write_header(format_context_.get(), &opts);
+  av_dict_free(&opts);
+  return ret;
+}
+
+void Muxer::ApplyPendingExtradata() {
+  std::vector<std::pair<int, std::vector<uint8_t>>> pending;
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    pending.swap(pending_extradata_);
+  }
+  for (const auto& [stream_index, extradata] : pending) {
+    AVCodecParameters* par = format_context_->streams[stream_index]->codecpar;
+    if (par->extradata_size == 0 && !extradata.empty()) {
+      CopyExtradata(par, extradata.data(), extradata.size());
+    }
+  }
+}
+
+bool Muxer::HasTrack(int stream_index, AVMediaType type) const {
+  return format_context_ && stream_index >= 0 &&
+         stream_index < static_cast<int>(format_context_->nb_streams) &&
+         format_context_->streams[stream_index]->codecpar->codec_type == type;
+}
+
+bool Muxer::AttachEncoder(Napi::Env env) {
+  if (finalized_ || !format_context_) {
+    return false;
+  }
+  if (!header_written_) {
+    header_written_ = true;
+    header_deferred_ = true;
+    StartWriter(env);
+  }
+  return true;
+}
+
+bool Muxer::WritePacket(ffmpeg::AVPacketPtr packet,
+                        const std::atomic<bool>& cancel) {
+  {
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    space_cv_.wait(lock, [this, &cancel] {
+      return writer_stop_ || writer_error_ < 0 || cancel.load() ||
+             write_queue_.size() < kMaxQueuedPackets;
+    });
+    if (writer_stop_ || writer_error_ < 0 || cancel.load()) {
+      return false;
+    }
+    write_queue_.push_back(std::move(packet));
+  }
+  writer_cv_.notify_one();
+  return true;
+}
+
+void Muxer::WakeWriters() {
+  // Taking the lock orders this after a writer's predicate check.
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  space_cv_.notify_all();
+}
+
+void Muxer::SetStreamExtradata(int stream_index, const uint8_t* data,
+                               size_t size) {
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  pending_extradata_.emplace_back(stream_index,
+                                  std::vector<uint8_t>(data, data + size));
 }
 
 AVCodecID Muxer::CodecIdFromString(const std::string& codec) {
@@ -97,6 +272,8 @@ AVCodecID Muxer::CodecIdFromString(const std::string& codec) {
   } else if (codec.find("hvc1") == 0 || codec.find("hev1") == 0 ||
              codec.find("hevc") == 0) {
     return AV_CODEC_ID_HEVC;
+  } else if (codec.find("vp8") == 0) {
+    return AV_CODEC_ID_VP8;
   } else if (codec.find("vp09") == 0 || codec.find("vp9") == 0) {
     return AV_CODEC_ID_VP9;
   } else if (codec.find("av01") == 0 || codec.find("av1") == 0) {
@@ -158,12 +335,7 @@ Napi::Value Muxer::AddVideoTrack(const Napi::CallbackInfo& info) {
   if (config.Has("description")) {
     auto [data, size] = webcodecs::AttrAsBuffer(config, "description");
     if (data && size > 0) {
-      stream->codecpar->extradata =
-          static_cast<uint8_t*>(av_malloc(size + AV_INPUT_BUFFER_PADDING_SIZE));
-      if (stream->codecpar->extradata) {
-        memcpy(stream->codecpar->extradata, data, size);
-        stream->codecpar->extradata_size = static_cast<int>(size);
-      }
+      CopyExtradata(stream->codecpar, data, size);
     }
   }
 
@@ -217,12 +389,7 @@ Napi::Value Muxer::AddAudioTrack(const Napi::CallbackInfo& info) {
   if (config.Has("description")) {
     auto [data, size] = webcodecs::AttrAsBuffer(config, "description");
     if (data && size > 0) {
-      stream->codecpar->extradata =
-          static_cast<uint8_t*>(av_malloc(size + AV_INPUT_BUFFER_PADDING_SIZE));
-      if (stream->codecpar->extradata) {
-        memcpy(stream->codecpar->extradata, data, size);
-        stream->codecpar->extradata_size = static_cast<int>(size);
-      }
+      CopyExtradata(stream->codecpar, data, size);
     }
   }
 
@@ -237,16 +404,37 @@ Napi::Value Muxer::WriteVideoChunk(const Napi::CallbackInfo& info) {
     Napi::Error::New(env, "No video track added").ThrowAsJavaScriptException();
     return env.Undefined();
   }
+  return WriteChunk(info, video_stream_index_);
+}
+
+Napi::Value Muxer::WriteAudioChunk(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (audio_stream_index_ < 0) {
+    Napi::Error::New(env, "No audio track added").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return WriteChunk(info, audio_stream_index_);
+}
+
+Napi::Value Muxer::WriteChunk(const Napi::CallbackInfo& info,
+                              int stream_index) {
+  Napi::Env env = info.Env();
 
   if (info.Length() < 1 || !info[0].IsObject()) {
     Napi::TypeError::New(env, "Chunk object required")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
+  if (finalized_ || !format_context_) {
+    Napi::Error::New(env, "InvalidStateError: Muxer is finalized")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
 
   // Write header on first chunk.
   if (!header_written_) {
-    int ret = avformat_write_header(format_context_.get(), nullptr);
+    int ret = WriteHeader();
     if (ret < 0) {
       char err[AV_ERROR_MAX_STRING_SIZE];
       av_strerror(ret, err, sizeof(err));
@@ -255,174 +443,320 @@ Napi::Value Muxer::WriteVideoChunk(const Napi::CallbackInfo& info) {
       return env.Undefined();
     }
     header_written_ = true;
+    CollectOutput();
+    EmitOutput(env);
+    StartWriter(env);
   }
 
   Napi::Object chunk = info[0].As<Napi::Object>();
-
-  ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
+  int64_t decode_timestamp = EncodedVideoChunk::kNoDecodeTimestamp;
+  ffmpeg::AVPacketPtr packet =
+      PacketFromChunk(env, chunk, &decode_timestamp);
   if (!packet) {
-    Napi::Error::New(env, "Failed to allocate packet")
-        .ThrowAsJavaScriptException();
-    return env.Undefined();
+    return env.Undefined();  // Exception already pending.
   }
 
-  // Get chunk data.
-  auto [data, size] = webcodecs::AttrAsBuffer(chunk, "data");
-  if (!data || size == 0) {
-    // Try to call copyTo method if data is not a direct buffer.
-    if (chunk.Has("byteLength") && chunk.Has("copyTo")) {
-      int byte_length = chunk.Get("byteLength").As<Napi::Number>().Int32Value();
-      Napi::Buffer<uint8_t> buf = Napi::Buffer<uint8_t>::New(env, byte_length);
-      chunk.Get("copyTo").As<Napi::Function>().Call(chunk, {buf});
-      data = buf.Data();
-      size = byte_length;
-
-      // Copy to packet.
-      int ret = av_new_packet(packet.get(), static_cast<int>(size));
-      if (ret < 0) {
-        Napi::Error::New(env, "Failed to allocate packet data")
-            .ThrowAsJavaScriptException();
-        return env.Undefined();
-      }
-      memcpy(packet->data, data, size);
-    } else {
-      Napi::Error::New(env, "Chunk must have data buffer or copyTo method")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
-    }
-  } else {
-    int ret = av_new_packet(packet.get(), static_cast<int>(size));
-    if (ret < 0) {
-      Napi::Error::New(env, "Failed to allocate packet data")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
-    }
-    memcpy(packet->data, data, size);
-  }
-
-  // Set packet metadata.
+  // Timestamps stay in microseconds; the writer rescales them to the
+  // stream time base chosen by the muxer.
   int64_t timestamp = webcodecs::AttrAsInt64(chunk, "timestamp");
   int64_t duration = webcodecs::AttrAsInt64(chunk, "duration", 0);
   std::string type = webcodecs::AttrAsStr(chunk, "type", "delta");
 
-  packet->stream_index = video_stream_index_;
+  packet->stream_index = stream_index;
   packet->pts = timestamp;
-  packet->dts = timestamp;
+  // Reordered (B-frame) video carries its own DTS; everything else decodes
+  // in presentation order.
+  packet->dts = decode_timestamp == EncodedVideoChunk::kNoDecodeTimestamp
+                    ? timestamp
+                    : std::min(decode_timestamp, timestamp);
   packet->duration = duration;
-
-  if (type == "key") {
-    packet->flags |= AV_PKT_FLAG_KEY;
+  packet->pos = -1;
+  packet->flags = type == "key" ? AV_PKT_FLAG_KEY : 0;
+
+  int error;
+  {
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    // Bounded queue: a producer that outruns the output waits here.
+    space_cv_.wait(lock, [this] {
+      return writer_error_ < 0 || write_queue_.size() < kMaxQueuedPackets;
+    });
+    error = writer_error_;
+    if (error >= 0) {
+      write_queue_.push_back(std::move(packet));
+    }
   }
-
-  // Rescale timestamps from microseconds to stream time base.
-  AVStream* stream = format_context_->streams[video_stream_index_];
-  av_packet_rescale_ts(packet.get(), {1, 1000000}, stream->time_base);
-
-  int ret = av_interleaved_write_frame(format_context_.get(), packet.get());
-  if (ret < 0) {
+  if (error < 0) {
     char err[AV_ERROR_MAX_STRING_SIZE];
-    av_strerror(ret, err, sizeof(err));
+    av_strerror(error, err, sizeof(err));
     Napi::Error::New(env, std::string("Failed to write packet: ") + err)
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
-
+  writer_cv_.notify_one();
+  UpdateProgressRef(env);
   return env.Undefined();
 }
 
-Napi::Value Muxer::WriteAudioChunk(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-
-  if (audio_stream_index_ < 0) {
-    Napi::Error::New(env, "No audio track added").ThrowAsJavaScriptException();
-    return env.Undefined();
-  }
-
-  // Write header on first chunk if not already written.
-  if (!header_written_) {
-    int ret = avformat_write_header(format_context_.get(), nullptr);
-    if (ret < 0) {
-      char err[AV_ERROR_MAX_STRING_SIZE];
-      av_strerror(ret, err, sizeof(err));
-      Napi::Error::New(env, std::string("Failed to write header: ") + err)
+ffmpeg::AVPacketPtr Muxer::PacketFromChunk(Napi::Env env, Napi::Object chunk,
+                                           int64_t* decode_timestamp) {
+  // Native chunks (e.g. straight from an encoder or Demuxer) share their
+  // refcounted payload with the packet.
+  ffmpeg::AVPacketPtr packet;
+  bool is_native = false;
+  if (!EncodedVideoChunk::constructor.IsEmpty() &&
+      chunk.InstanceOf(EncodedVideoChunk::constructor.Value())) {
+    is_native = true;
+    auto* video_chunk = Napi::ObjectWrap<EncodedVideoChunk>::Unwrap(chunk);
+    *decode_timestamp = video_chunk->GetDecodeTimestampValue();
+    packet = video_chunk->RefPacket();
+  } else if (EncodedAudioChunk::IsInstance(chunk)) {
+    is_native = true;
+    packet = Napi::ObjectWrap<EncodedAudioChunk>::Unwrap(chunk)->RefPacket();
+  }
+  if (is_native) {
+    if (!packet) {
+      Napi::Error::New(env, "InvalidStateError: Chunk is closed")
           .ThrowAsJavaScriptException();
-      return env.Undefined();
     }
-    header_written_ = true;
+    return packet;
   }
 
-  if (info.Length() < 1 || !info[0].IsObject()) {
-    Napi::TypeError::New(env, "Chunk object required")
+  if (webcodecs::HasAttr(chunk, "decodeTimestamp")) {
+    *decode_timestamp = webcodecs::AttrAsInt64(chunk, "decodeTimestamp");
+  }
+  auto [data, size] = webcodecs::AttrAsBuffer(chunk, "data");
+  if (data && size > 0) {
+    packet = ffmpeg::make_packet_copy(data, size);
+  } else if (chunk.Has("byteLength") && chunk.Has("copyTo")) {
+    // Let copyTo() write straight into the packet payload.
+    int byte_length = chunk.Get("byteLength").As<Napi::Number>().Int32Value();
+    packet = ffmpeg::make_packet();
+    if (packet && byte_length > 0 &&
+        av_new_packet(packet.get(), byte_length) == 0) {
+      Napi::Buffer<uint8_t> view =
+          Napi::Buffer<uint8_t>::New(env, packet->data, packet->size);
+      chunk.Get("copyTo").As<Napi::Function>().Call(chunk, {view});
+    } else {
+      packet.reset();
+    }
+  } else {
+    Napi::Error::New(env, "Chunk must have data buffer or copyTo method")
         .ThrowAsJavaScriptException();
-    return env.Undefined();
+    return nullptr;
   }
-
-  Napi::Object chunk = info[0].As<Napi::Object>();
-
-  ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
   if (!packet) {
-    Napi::Error::New(env, "Failed to allocate packet")
+    Napi::Error::New(env, "Failed to allocate packet data")
         .ThrowAsJavaScriptException();
-    return env.Undefined();
   }
+  return packet;
+}
 
-  auto [data, size] = webcodecs::AttrAsBuffer(chunk, "data");
-  if (!data || size == 0) {
-    if (chunk.Has("byteLength") && chunk.Has("copyTo")) {
-      int byte_length = chunk.Get("byteLength").As<Napi::Number>().Int32Value();
-      Napi::Buffer<uint8_t> buf = Napi::Buffer<uint8_t>::New(env, byte_length);
-      chunk.Get("copyTo").As<Napi::Function>().Call(chunk, {buf});
-      data = buf.Data();
-      size = byte_length;
-
-      int ret = av_new_packet(packet.get(), static_cast<int>(size));
-      if (ret < 0) {
-        Napi::Error::New(env, "Failed to allocate packet data")
-            .ThrowAsJavaScriptException();
-        return env.Undefined();
+void Muxer::StartWriter(Napi::Env env) {
+  // The progress callback ignores its JS function.
+  auto progress_fn =
+      Napi::Function::New(env, [](const Napi::CallbackInfo&) {});
+  progress_link_ = new ProgressLink{this};
+  progress_tsfn_ = ProgressTSFN::New(env, progress_fn, "MuxerProgress", 0, 1,
+                                     progress_link_,
+                                     &Muxer::OnProgressFinalize);
+  progress_tsfn_.Unref(env);  // See UpdateProgressRef()
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    writer_stop_ = false;
+    writer_error_ = 0;
+  }
+  writer_thread_ = std::thread(&Muxer::WriterLoop, this);
+}
+
+void Muxer::StopWriter() {
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    writer_stop_ = true;
+  }
+  writer_cv_.notify_all();
+  space_cv_.notify_all();  // Encoder sinks waiting for room give up
+  if (writer_thread_.joinable()) {
+    writer_thread_.join();
+  }
+  if (progress_link_ != nullptr) {
+    // Abort drops a pending progress call, which may run after this object
+    // is gone; whoever stops the writer settles what it was for.
+    progress_link_->muxer = nullptr;
+    progress_link_ = nullptr;
+    progress_tsfn_.Abort();
+  }
+}
+
+void Muxer::UpdateProgressRef(Napi::Env env) {
+  if (progress_link_ == nullptr) {
+    return;
+  }
+  bool idle;
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    idle = write_queue_.empty() && in_flight_ == 0;
+  }
+  if (idle && flush_deferreds_.empty()) {
+    progress_tsfn_.Unref(env);
+  } else {
+    progress_tsfn_.Ref(env);
+  }
+}
+
+void Muxer::WriterLoop() {
+  std::deque<ffmpeg::AVPacketPtr> batch;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(writer_mutex_);
+      writer_cv_.wait(lock,
+                      [this] { return writer_stop_ || !write_queue_.empty(); });
+      if (write_queue_.empty()) {
+        return;  // Stopped and drained.
       }
-      memcpy(packet->data, data, size);
-    } else {
-      Napi::Error::New(env, "Chunk must have data buffer or copyTo method")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
+      // Take everything queued so far and write it in one go.
+      batch.swap(write_queue_);
+      in_flight_ = batch.size();
     }
-  } else {
-    int ret = av_new_packet(packet.get(), static_cast<int>(size));
-    if (ret < 0) {
-      Napi::Error::New(env, "Failed to allocate packet data")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
+    space_cv_.notify_all();
+
+    int error = 0;
+    if (header_deferred_) {
+      ApplyPendingExtradata();
+      error = WriteHeader();
+      header_deferred_ = false;
+    }
+    for (ffmpeg::AVPacketPtr& packet : batch) {
+      if (error < 0) {
+        break;
+      }
+      AVStream* stream = format_context_->streams[packet->stream_index];
+      av_packet_rescale_ts(packet.get(), {1, 1000000}, stream->time_base);
+      error = av_interleaved_write_frame(format_context_.get(), packet.get());
+    }
+    batch.clear();
+    CollectOutput();
+
+    {
+      std::lock_guard<std::mutex> lock(writer_mutex_);
+      in_flight_ = 0;
+      if (error < 0) {
+        writer_error_ = error;
+        write_queue_.clear();
+      }
+      if (!progress_scheduled_ && progress_link_ != nullptr) {
+        progress_scheduled_ = progress_tsfn_.NonBlockingCall() == napi_ok;
+      }
     }
-    memcpy(packet->data, data, size);
+    space_cv_.notify_all();
   }
+}
 
-  int64_t timestamp = webcodecs::AttrAsInt64(chunk, "timestamp");
-  int64_t duration = webcodecs::AttrAsInt64(chunk, "duration", 0);
-  std::string type = webcodecs::AttrAsStr(chunk, "type", "delta");
+void Muxer::CollectOutput() {
+  if (!output_) {
+    return;
+  }
+  ReadyOutput ready;
+  if (!output_->TakePending(&ready.data, &ready.offset)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  ready_output_.push_back(std::move(ready));
+}
 
-  packet->stream_index = audio_stream_index_;
-  packet->pts = timestamp;
-  packet->dts = timestamp;
-  packet->duration = duration;
+void Muxer::OnWriterProgress(Napi::Env env, Napi::Function,
+                             ProgressLink* link, std::nullptr_t*) {
+  if (env == nullptr || link == nullptr || link->muxer == nullptr) {
+    return;
+  }
+  Muxer* context = link->muxer;
+  {
+    std::lock_guard<std::mutex> lock(context->writer_mutex_);
+    context->progress_scheduled_ = false;
+  }
+  Napi::HandleScope scope(env);
+  context->EmitOutput(env);
+  context->SettleFlushes(env);
+  context->UpdateProgressRef(env);
+}
 
-  if (type == "key") {
-    packet->flags |= AV_PKT_FLAG_KEY;
+void Muxer::OnProgressFinalize(Napi::Env, ProgressLink* link) {
+  if (link->muxer != nullptr) {
+    // Environment teardown: the writer must not use the TSFN any more.
+    std::lock_guard<std::mutex> lock(link->muxer->writer_mutex_);
+    link->muxer->progress_link_ = nullptr;
   }
+  delete link;
+}
 
-  AVStream* stream = format_context_->streams[audio_stream_index_];
-  av_packet_rescale_ts(packet.get(), {1, 1000000}, stream->time_base);
+void Muxer::SettleFlushes(Napi::Env env) {
+  if (flush_deferreds_.empty()) {
+    return;
+  }
+  int error;
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    if (writer_error_ >= 0 && (!write_queue_.empty() || in_flight_ > 0)) {
+      return;  // Still writing; the next progress callback settles them.
+    }
+    error = writer_error_;
+  }
+  std::vector<std::unique_ptr<Napi::Promise::Deferred>> deferreds;
+  deferreds.swap(flush_deferreds_);
+  for (auto& deferred : deferreds) {
+    if (error < 0) {
+      deferred->Reject(
+          webcodecs::FFmpegError(env, "write packet", error).Value());
+    } else {
+      deferred->Resolve(env.Undefined());
+    }
+  }
+}
 
-  int ret = av_interleaved_write_frame(format_context_.get(), packet.get());
-  if (ret < 0) {
-    char err[AV_ERROR_MAX_STRING_SIZE];
-    av_strerror(ret, err, sizeof(err));
-    Napi::Error::New(env, std::string("Failed to write packet: ") + err)
-        .ThrowAsJavaScriptException();
-    return env.Undefined();
+Napi::Value Muxer::Flush(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  auto deferred = std::make_unique<Napi::Promise::Deferred>(
+      Napi::Promise::Deferred::New(env));
+  Napi::Promise promise = deferred->Promise();
+  flush_deferreds_.push_back(std::move(deferred));
+  if (!writer_thread_.joinable()) {
+    EmitOutput(env);
   }
+  SettleFlushes(env);
+  UpdateProgressRef(env);
+  return promise;
+}
 
-  return env.Undefined();
+Napi::Value Muxer::GetWriteQueueSize(const Napi::CallbackInfo& info) {
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  return Napi::Number::New(info.Env(),
+                           static_cast<double>(write_queue_.size() +
+                                               in_flight_));
+}
+
+void Muxer::EmitOutput(Napi::Env env) {
+  if (on_data_callback_.IsEmpty()) {
+    return;
+  }
+  while (true) {
+    ReadyOutput ready;
+    {
+      std::lock_guard<std::mutex> lock(writer_mutex_);
+      if (ready_output_.empty()) {
+        return;
+      }
+      ready = std::move(ready_output_.front());
+      ready_output_.pop_front();
+    }
+    // Hand the bytes over without a copy; the Buffer frees them.
+    auto* owned = new std::vector<uint8_t>(std::move(ready.data));
+    Napi::Buffer<uint8_t> data = Napi::Buffer<uint8_t>::New(
+        env, owned->data(), owned->size(),
+        [](Napi::Env, uint8_t*, std::vector<uint8_t>* hint) { delete hint; },
+        owned);
+    on_data_callback_.Call(
+        {data, Napi::Number::New(env, static_cast<double>(ready.offset))});
+  }
 }
 
 Napi::Value Muxer::FinalizeOutput(const Napi::CallbackInfo& info) {
@@ -434,7 +768,7 @@ Napi::Value Muxer::FinalizeOutput(const Napi::CallbackInfo& info) {
 
   if (!header_written_) {
     // Write header if no chunks were written.
-    int ret = avformat_write_header(format_context_.get(), nullptr);
+    int ret = WriteHeader();
     if (ret < 0) {
       char err[AV_ERROR_MAX_STRING_SIZE];
       av_strerror(ret, err, sizeof(err));
@@ -445,7 +779,26 @@ Napi::Value Muxer::FinalizeOutput(const Napi::CallbackInfo& info) {
     header_written_ = true;
   }
 
-  int ret = av_write_trailer(format_context_.get());
+  // Let the writer drain the queue, then take the context back.
+  StopWriter();
+  int ret;
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    ret = writer_error_;
+  }
+  if (ret >= 0 && header_deferred_) {
+    // Encoder sink attached but nothing was ever written.
+    ApplyPendingExtradata();
+    ret = WriteHeader();
+    header_deferred_ = false;
+  }
+  if (ret >= 0) {
+    ret = av_write_trailer(format_context_.get());
+  }
+  finalized_ = true;
+  CollectOutput();
+  EmitOutput(env);
+  SettleFlushes(env);
   if (ret < 0) {
     char err[AV_ERROR_MAX_STRING_SIZE];
     av_strerror(ret, err, sizeof(err));
@@ -453,12 +806,17 @@ Napi::Value Muxer::FinalizeOutput(const Napi::CallbackInfo& info) {
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
-
-  finalized_ = true;
   return env.Undefined();
 }
 
 Napi::Value Muxer::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
   Cleanup();
-  return info.Env().Undefined();
+  for (auto& deferred : flush_deferreds_) {
+    deferred->Reject(
+        Napi::Error::New(env, "AbortError: Muxer closed").Value());
+  }
+  flush_deferreds_.clear();
+  return env.Undefined();
 }
@@ -11,16 +11,27 @@ extern "C" {
 
 #include <napi.h>
 
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "src/ffmpeg_raii.h"
+#include "src/muxer_output.h"
+#include "src/shared/packet_sink.h"
 
-class Muxer : public Napi::ObjectWrap<Muxer> {
+class Muxer : public Napi::ObjectWrap<Muxer>, public webcodecs::PacketSink {
  public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
-  static Napi::FunctionReference constructor;
+  // One per thread: each environment (main thread or worker_thread)
+  // defines its own class.
+  static thread_local Napi::FunctionReference constructor;
 
   explicit Muxer(const Napi::CallbackInfo& info);
   ~Muxer();
@@ -29,23 +40,114 @@ class Muxer : public Napi::ObjectWrap<Muxer> {
   Muxer(const Muxer&) = delete;
   Muxer& operator=(const Muxer&) = delete;
 
+  // Native encoder sinks (VideoEncoder/AudioEncoder.attachMuxer). JS thread.
+  bool HasTrack(int stream_index, AVMediaType type) const;
+  // Start the writer so encoders can queue packets from their worker
+  // threads. The header is deferred to the writer so extradata sent by the
+  // encoder still makes it in. Returns false once finalized or closed.
+  bool AttachEncoder(Napi::Env env);
+
+  // webcodecs::PacketSink; called from encoder worker threads.
+  bool WritePacket(ffmpeg::AVPacketPtr packet,
+                   const std::atomic<bool>& cancel) override;
+  void WakeWriters() override;
+  void SetStreamExtradata(int stream_index, const uint8_t* data,
+                          size_t size) override;
+
  private:
   Napi::Value AddVideoTrack(const Napi::CallbackInfo& info);
   Napi::Value AddAudioTrack(const Napi::CallbackInfo& info);
   Napi::Value WriteVideoChunk(const Napi::CallbackInfo& info);
   Napi::Value WriteAudioChunk(const Napi::CallbackInfo& info);
+  Napi::Value Flush(const Napi::CallbackInfo& info);
   Napi::Value FinalizeOutput(const Napi::CallbackInfo& info);
   Napi::Value Close(const Napi::CallbackInfo& info);
+  Napi::Value GetWriteQueueSize(const Napi::CallbackInfo& info);
 
   void Cleanup();
   AVCodecID CodecIdFromString(const std::string& codec);
+  int WriteHeader();
+  // Copy extradata received through SetStreamExtradata() into streams that
+  // have none; called by the context owner before the header.
+  void ApplyPendingExtradata();
+  Napi::Value WriteChunk(const Napi::CallbackInfo& info, int stream_index);
+  // Returns nullptr with a JS exception pending on failure. Sets
+  // |decode_timestamp| if the chunk carries one.
+  ffmpeg::AVPacketPtr PacketFromChunk(Napi::Env env, Napi::Object chunk,
+                                      int64_t* decode_timestamp);
+
+  // Writer thread. After the header is written, writer_thread_ owns
+  // format_context_ until finalize() or close() stop it; JS only enqueues
+  // packets and is told about progress through progress_tsfn_.
+  void StartWriter(Napi::Env env);
+  void StopWriter();
+  void WriterLoop();
+  // Move bytes from output_ to ready_output_; called by the context owner.
+  void CollectOutput();
+  // Deliver ready_output_ to onData, in order.
+  void EmitOutput(Napi::Env env);
+  void SettleFlushes(Napi::Env env);
+  // Keep the event loop alive only while JS waits on the writer: packets
+  // written from JS or a pending flush(). An idle or abandoned Muxer does
+  // not hold the process open.
+  void UpdateProgressRef(Napi::Env env);
+
+  // Context of progress_tsfn_, deleted by its finalizer. Either side may go
+  // first: the Muxer clears |muxer| when it stops the writer, the finalizer
+  // clears progress_link_ when the environment tears the TSFN down.
+  struct ProgressLink {
+    Muxer* muxer;
+  };
+  static void OnWriterProgress(Napi::Env env, Napi::Function fn,
+                               ProgressLink* link, std::nullptr_t* data);
+  static void OnProgressFinalize(Napi::Env env, ProgressLink* link);
+
+  using ProgressTSFN =
+      Napi::TypedThreadSafeFunction<ProgressLink, std::nullptr_t,
+                                    &Muxer::OnWriterProgress>;
 
+  struct ReadyOutput {
+    std::vector<uint8_t> data;
+    int64_t offset = 0;
+  };
+
+  // Packets queued beyond this make writeVideoChunk()/writeAudioChunk()
+  // wait for the writer.
+  static constexpr size_t kMaxQueuedPackets = 256;
+
+  // In-memory sink for onData output; null when writing a file. Must
+  // outlive format_context_.
+  std::unique_ptr<webcodecs::MuxerOutput> output_;
+  Napi::FunctionReference on_data_callback_;
   ffmpeg::AVFormatContextOutputPtr format_context_;
   std::string filename_;
-  bool header_written_;
+  std::string movflags_;
+  bool header_written_;  // Writing has started; no more tracks
+  // An encoder sink started the writer before the header was written; the
+  // context owner writes it before the first packet.
+  bool header_deferred_ = false;
   bool finalized_;
   int video_stream_index_;
   int audio_stream_index_;
+
+  // Writer state; write_queue_ and the fields after it are guarded by
+  // writer_mutex_.
+  std::thread writer_thread_;
+  std::mutex writer_mutex_;
+  std::condition_variable writer_cv_;  // Wakes the writer
+  std::condition_variable space_cv_;   // Wakes a producer waiting for room
+  std::deque<ffmpeg::AVPacketPtr> write_queue_;
+  size_t in_flight_ = 0;  // Packets taken by the writer, not yet written
+  bool writer_stop_ = false;
+  int writer_error_ = 0;
+  bool progress_scheduled_ = false;
+  std::deque<ReadyOutput> ready_output_;
+  std::vector<std::pair<int, std::vector<uint8_t>>> pending_extradata_;
+  ProgressTSFN progress_tsfn_;
+  ProgressLink* progress_link_ = nullptr;  // Null without a live TSFN
+
+  // JS thread only below.
+  std::vector<std::unique_ptr<Napi::Promise::Deferred>> flush_deferreds_;
 };
 
 Napi::Object InitMuxer(Napi::Env env, Napi::Object exports);
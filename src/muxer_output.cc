@@ -0,0 +1,62 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// MuxerOutput implementation.
+
+#include "src/muxer_output.h"
+
+extern "C" {
+#include <libavutil/mem.h>
+}
+
+#include <utility>
+
+namespace webcodecs {
+
+std::unique_ptr<MuxerOutput> MuxerOutput::Create() {
+  std::unique_ptr<MuxerOutput> output(new MuxerOutput());
+  auto* buffer = static_cast<uint8_t*>(av_malloc(kBufferSize));
+  if (!buffer) {
+    return nullptr;
+  }
+  // No seek callback: muxers see a non-seekable output and stream.
+  output->avio_ = avio_alloc_context(buffer, kBufferSize, 1, output.get(),
+                                     nullptr, &MuxerOutput::Write, nullptr);
+  if (!output->avio_) {
+    av_free(buffer);
+    return nullptr;
+  }
+  return output;
+}
+
+MuxerOutput::~MuxerOutput() {
+  if (avio_) {
+    // avio_context_free() does not free the (possibly reallocated) buffer.
+    av_freep(&avio_->buffer);
+    avio_context_free(&avio_);
+  }
+}
+
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+int MuxerOutput::Write(void* opaque, const uint8_t* buf, int buf_size) {
+#else
+int MuxerOutput::Write(void* opaque, uint8_t* buf, int buf_size) {
+#endif
+  auto* output = static_cast<MuxerOutput*>(opaque);
+  output->pending_.insert(output->pending_.end(), buf, buf + buf_size);
+  return buf_size;
+}
+
+bool MuxerOutput::TakePending(std::vector<uint8_t>* out, int64_t* offset) {
+  avio_flush(avio_);
+  if (pending_.empty()) {
+    return false;
+  }
+  *offset = taken_;
+  taken_ += static_cast<int64_t>(pending_.size());
+  *out = std::move(pending_);
+  pending_.clear();
+  return true;
+}
+
+}  // namespace webcodecs
@@ -0,0 +1,66 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// MuxerOutput - custom AVIOContext that collects muxed bytes in memory so
+// Muxer can hand them to JavaScript instead of writing a file.
+//
+// The output is not seekable, so only streamable layouts (fragmented MP4,
+// CMAF, WebM) can be written through it. After each muxer call the owner
+// takes whatever was produced; with fragmented formats that is the init
+// segment after the header and one fragment whenever a fragment closes.
+
+#ifndef SRC_MUXER_OUTPUT_H_
+#define SRC_MUXER_OUTPUT_H_
+
+extern "C" {
+#include <libavformat/avio.h>
+#include <libavformat/version.h>
+}
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace webcodecs {
+
+class MuxerOutput {
+ public:
+  // Large enough that a typical fragment leaves the AVIO layer in a few
+  // buffer flushes.
+  static constexpr int kBufferSize = 256 * 1024;
+
+  // Returns nullptr on allocation failure.
+  static std::unique_ptr<MuxerOutput> Create();
+
+  ~MuxerOutput();
+
+  // Disallow copy and assign.
+  MuxerOutput(const MuxerOutput&) = delete;
+  MuxerOutput& operator=(const MuxerOutput&) = delete;
+
+  // Attach as |format_context->pb| together with AVFMT_FLAG_CUSTOM_IO. The
+  // format context must be freed before this output is destroyed.
+  AVIOContext* avio() const { return avio_; }
+
+  // Flush buffered bytes and move everything written since the last call
+  // into |out|. |offset| receives the position of the first byte in the
+  // output. Returns false if nothing was written.
+  bool TakePending(std::vector<uint8_t>* out, int64_t* offset);
+
+ private:
+  MuxerOutput() = default;
+
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+  static int Write(void* opaque, const uint8_t* buf, int buf_size);
+#else
+  static int Write(void* opaque, uint8_t* buf, int buf_size);
+#endif
+
+  AVIOContext* avio_ = nullptr;
+  std::vector<uint8_t> pending_;
+  int64_t taken_ = 0;  // Bytes handed out so far
+};
+
+}  // namespace webcodecs
+
+#endif  // SRC_MUXER_OUTPUT_H_
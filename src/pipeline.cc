@@ -0,0 +1,564 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#include "src/pipeline.h"
+
+extern "C" {
+#include <libavutil/time.h>
+}
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+
+#include "src/common.h"
+#include "src/muxer.h"
+
+namespace {
+
+// Encoded output goes into a container, so H.264/HEVC use length-prefixed
+// packets with the parameter sets in extradata.
+std::string BitstreamFormatFor(const std::string& codec) {
+  if (codec.rfind("avc1", 0) == 0 || codec.rfind("avc3", 0) == 0) {
+    return "avc";
+  }
+  if (codec.rfind("hvc1", 0) == 0 || codec.rfind("hev1", 0) == 0) {
+    return "hevc";
+  }
+  return "annexb";
+}
+
+// Stage queues are fixed-size rings, so the limits are bounded.
+constexpr int kMaxQueueLimit = 1024;
+// Ring room beyond the limits: control messages, and frames the decoder
+// emits from packets already queued or while draining its delay.
+constexpr size_t kQueueSlack = 64;
+
+size_t ParseQueueLimit(Napi::Env env, Napi::Object options, const char* attr,
+                       size_t default_value) {
+  if (!webcodecs::HasAttr(options, attr)) {
+    return default_value;
+  }
+  Napi::Value value = options.Get(attr);
+  if (!value.IsNumber() || value.As<Napi::Number>().Int32Value() < 1 ||
+      value.As<Napi::Number>().Int32Value() > kMaxQueueLimit) {
+    throw webcodecs::InvalidParameterError(env, attr, "integer in [1, 1024]",
+                                           value);
+  }
+  return static_cast<size_t>(value.As<Napi::Number>().Int32Value());
+}
+
+}  // namespace
+
+// Per-thread constructor reference; see the class declaration.
+thread_local Napi::FunctionReference Pipeline::constructor;
+
+Napi::Object InitPipeline(Napi::Env env, Napi::Object exports) {
+  return Pipeline::Init(env, exports);
+}
+
+Napi::Object Pipeline::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "Pipeline",
+      {
+          InstanceMethod("run", &Pipeline::Run),
+          InstanceMethod("cancel", &Pipeline::Cancel),
+          InstanceAccessor("state", &Pipeline::GetState, nullptr),
+      });
+
+  constructor = Napi::Persistent(func);
+  constructor.SuppressDestruct();
+
+  exports.Set("Pipeline", func);
+  return exports;
+}
+
+Pipeline::Pipeline(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<Pipeline>(info), state_("idle") {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    throw Napi::TypeError::New(env, "Pipeline requires an options object");
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+
+  Napi::Value source = options.Get("input");
+  if (source.IsString()) {
+    path_ = source.As<Napi::String>().Utf8Value();
+  } else if (source.IsBuffer() || source.IsArrayBuffer() ||
+             source.IsTypedArray()) {
+    auto [data, size] = webcodecs::AttrAsBuffer(options, "input");
+    input_ = webcodecs::DemuxerInput::FromMemory(data, size);
+    if (!input_) {
+      throw webcodecs::FFmpegError(env, "allocate input", AVERROR(ENOMEM));
+    }
+  } else {
+    throw webcodecs::InvalidParameterError(env, "input",
+                                           "string or BufferSource", source);
+  }
+
+  Napi::Value muxer_val = options.Get("muxer");
+  if (!muxer_val.IsObject() || Muxer::constructor.IsEmpty() ||
+      !muxer_val.As<Napi::Object>().InstanceOf(Muxer::constructor.Value()) ||
+      !options.Get("trackIndex").IsNumber()) {
+    throw Napi::TypeError::New(env,
+                               "Pipeline requires a muxer and a trackIndex");
+  }
+  Muxer* muxer = Napi::ObjectWrap<Muxer>::Unwrap(muxer_val.As<Napi::Object>());
+  track_index_ = options.Get("trackIndex").As<Napi::Number>().Int32Value();
+  if (!muxer->HasTrack(track_index_, AVMEDIA_TYPE_VIDEO)) {
+    throw Napi::TypeError::New(env, "trackIndex is not a video track");
+  }
+  muxer_ref_ = Napi::Persistent(muxer_val.As<Napi::Object>());
+  muxer_ = muxer;
+
+  if (!options.Get("video").IsObject()) {
+    throw Napi::TypeError::New(env, "Pipeline requires a video config");
+  }
+  Napi::Object video = options.Get("video").As<Napi::Object>();
+  if (!video.Get("codec").IsString()) {
+    throw Napi::TypeError::New(env, "video.codec must be a string");
+  }
+  // Width, height and framerate default to the source's once it is open.
+  encoder_config_.codec_string = webcodecs::AttrAsStr(video, "codec");
+  encoder_config_.bitstream_format =
+      BitstreamFormatFor(encoder_config_.codec_string);
+  encoder_config_.width = webcodecs::AttrAsInt32(video, "width", 0);
+  encoder_config_.height = webcodecs::AttrAsInt32(video, "height", 0);
+  encoder_config_.bitrate =
+      webcodecs::AttrAsInt32(video, "bitrate", encoder_config_.bitrate);
+  encoder_config_.framerate = webcodecs::AttrAsInt32(video, "framerate", 0);
+  encoder_config_.use_qscale =
+      webcodecs::AttrAsStr(video, "bitrateMode", "variable") == "quantizer";
+  if (webcodecs::AttrAsStr(video, "latencyMode", "quality") == "realtime") {
+    encoder_config_.max_b_frames = 0;
+  }
+  encoder_config_.hw_accel =
+      webcodecs::AttrAsStr(video, "hardwareAcceleration", "no-preference");
+  std::string threading_error;
+  if (!webcodecs::ParseThreadingConfig(video, &encoder_config_.threading,
+                                       &threading_error)) {
+    throw Napi::TypeError::New(env, threading_error);
+  }
+
+  max_queued_packets_ = ParseQueueLimit(env, options, "maxQueuedPackets",
+                                        kDefaultMaxQueuedPackets);
+  max_queued_frames_ = ParseQueueLimit(env, options, "maxQueuedFrames",
+                                       kDefaultMaxQueuedFrames);
+
+  if (webcodecs::HasAttr(options, "onProgress")) {
+    if (!options.Get("onProgress").IsFunction()) {
+      throw Napi::TypeError::New(env, "onProgress must be a function");
+    }
+    on_progress_callback_ =
+        Napi::Persistent(options.Get("onProgress").As<Napi::Function>());
+  }
+}
+
+Pipeline::~Pipeline() { Cleanup(); }
+
+void Pipeline::Cleanup() {
+  cancelled_.store(true);
+  WakeDriver();
+  if (driver_thread_.joinable()) {
+    driver_thread_.join();
+  }
+  // Workers before queues; the encoder may still reference the muxer.
+  decoder_.reset();
+  encoder_.reset();
+  decode_queue_.reset();
+  encode_queue_.reset();
+  format_context_.reset();
+  input_.reset();
+  progress_tsfn_.Release();
+  done_tsfn_.Release();
+  muxer_ = nullptr;
+  muxer_ref_.Reset();
+}
+
+Napi::Value Pipeline::Run(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (state_ != "idle") {
+    throw Napi::Error::New(env, "InvalidStateError: Pipeline has already run");
+  }
+  if (!muxer_->AttachEncoder(env)) {
+    throw Napi::Error::New(env, "InvalidStateError: Muxer is finalized");
+  }
+
+  // The done callback ignores its JS function. Holding a reference keeps
+  // this object alive until the TSFN finalizer runs.
+  auto done_fn = Napi::Function::New(env, [](const Napi::CallbackInfo&) {});
+  done_tsfn_.Init(DoneTSFN::TSFN::New(env, done_fn, "PipelineDone", 0, 1,
+                                      this, &Pipeline::UnrefOnFinalize));
+  Ref();
+  if (!on_progress_callback_.IsEmpty()) {
+    progress_tsfn_.Init(ProgressTSFN::TSFN::New(
+        env, on_progress_callback_.Value(), "PipelineProgress", 0, 1, this));
+  }
+
+  run_deferred_ = std::make_unique<Napi::Promise::Deferred>(
+      Napi::Promise::Deferred::New(env));
+  Napi::Promise promise = run_deferred_->Promise();
+  state_ = "running";
+  started_at_us_ = av_gettime_relative();
+  driver_thread_ = std::thread(&Pipeline::DriverLoop, this);
+  return promise;
+}
+
+Napi::Value Pipeline::Cancel(const Napi::CallbackInfo& info) {
+  if (state_ == "running") {
+    cancelled_.store(true);
+    WakeDriver();
+  }
+  return info.Env().Undefined();
+}
+
+Napi::Value Pipeline::GetState(const Napi::CallbackInfo& info) {
+  return Napi::String::New(info.Env(), state_);
+}
+
+void Pipeline::DriverLoop() {
+  const char* failed_op = nullptr;
+  int ret = OpenInput(&failed_op);
+  if (ret < 0) {
+    OnStageError(std::string(failed_op) + ": " +
+                 webcodecs::FFmpegErrorString(ret));
+  } else if (StartWorkers()) {
+    FeedPackets();
+    // The decoder drains into the encoder, so the encoder drains second.
+    if (!Stopped() && DrainStage(false)) {
+      DrainStage(true);
+    }
+  }
+
+  // Stop() waits for the message in progress; frames the decoder emits
+  // meanwhile are dropped by the closed encoder queue.
+  if (decoder_) {
+    decoder_->Stop();
+  }
+  if (encoder_) {
+    encoder_->Stop();
+  }
+  elapsed_us_.store(av_gettime_relative() - started_at_us_);
+  (void)done_tsfn_.Call(nullptr);
+}
+
+int Pipeline::OpenInput(const char** failed_op) {
+  AVFormatContext* ctx = avformat_alloc_context();
+  if (!ctx) {
+    *failed_op = "allocate format context";
+    return AVERROR(ENOMEM);
+  }
+  // Lets cancel() abort a blocking read.
+  ctx->interrupt_callback.callback = &Pipeline::InterruptCallback;
+  ctx->interrupt_callback.opaque = this;
+  if (input_) {
+    ctx->pb = input_->avio();
+    ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+  }
+  int ret = avformat_open_input(&ctx, input_ ? nullptr : path_.c_str(),
+                                nullptr, nullptr);
+  if (ret < 0) {
+    // avformat_open_input() frees the context on failure.
+    *failed_op = input_ ? "open input" : "open file";
+    return ret;
+  }
+  format_context_.reset(ctx);
+
+  ret = avformat_find_stream_info(ctx, nullptr);
+  if (ret < 0) {
+    *failed_op = "find stream info";
+    return ret;
+  }
+  ret = av_find_best_stream(ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+  if (ret < 0) {
+    *failed_op = "find video stream";
+    return ret;
+  }
+  stream_index_ = ret;
+  stream_time_base_ = ctx->streams[stream_index_]->time_base;
+  // Only the transcoded stream is read.
+  for (unsigned int i = 0; i < ctx->nb_streams; ++i) {
+    if (static_cast<int>(i) != stream_index_) {
+      ctx->streams[i]->discard = AVDISCARD_ALL;
+    }
+  }
+  return 0;
+}
+
+bool Pipeline::StartWorkers() {
+  AVStream* stream = format_context_->streams[stream_index_];
+  const AVCodecParameters* par = stream->codecpar;
+
+  webcodecs::VideoDecoderConfig decoder_config;
+  decoder_config.codec_id = par->codec_id;
+  decoder_config.coded_width = par->width;
+  decoder_config.coded_height = par->height;
+  if (par->extradata && par->extradata_size > 0) {
+    decoder_config.extradata.assign(par->extradata,
+                                    par->extradata + par->extradata_size);
+  }
+  // Frames go to the encoder in the decoder's own format; the encoder
+  // converts and scales only if its format or size differs.
+  decoder_config.native_output = true;
+
+  if (encoder_config_.width <= 0 || encoder_config_.height <= 0) {
+    encoder_config_.width = par->width;
+    encoder_config_.height = par->height;
+  }
+  encoder_config_.display_width = encoder_config_.width;
+  encoder_config_.display_height = encoder_config_.height;
+  if (encoder_config_.framerate <= 0) {
+    AVRational rate = stream->avg_frame_rate;
+    encoder_config_.framerate =
+        rate.num > 0 && rate.den > 0
+            ? std::max(1, static_cast<int>(std::lround(av_q2d(rate))))
+            : 30;
+  }
+
+  decode_queue_ = std::make_unique<webcodecs::VideoSpscControlQueue>(
+      max_queued_packets_ + kQueueSlack);
+  encode_queue_ = std::make_unique<webcodecs::VideoSpscControlQueue>(
+      max_queued_frames_ + max_queued_packets_ + kQueueSlack);
+  decoder_ =
+      std::make_unique<webcodecs::VideoDecoderWorker>(decode_queue_.get());
+  encoder_ =
+      std::make_unique<webcodecs::VideoEncoderWorker>(encode_queue_.get());
+
+  decoder_->SetConfig(decoder_config);
+  decoder_->SetOutputFrameCallback(
+      [this](ffmpeg::AVFramePtr frame) { OnFrame(std::move(frame)); });
+  decoder_->SetOutputErrorCallback(
+      [this](int, const std::string& message) { OnStageError(message); });
+  decoder_->SetFlushCompleteCallback(
+      [this](uint32_t, bool success, const std::string& error) {
+        OnStageFlushed(false, success, error);
+      });
+  decoder_->SetDequeueCallback([this](uint32_t) { WakeDriver(); });
+
+  encoder_->SetPacketSink(muxer_, track_index_);
+  encoder_->SetPacketOutputCallback(
+      [this](std::unique_ptr<webcodecs::EncodedPacketData> data) {
+        OnPacketsWritten(std::move(data));
+      });
+  encoder_->SetOutputErrorCallback(
+      [this](int, const std::string& message) { OnStageError(message); });
+  encoder_->SetFlushCompleteCallback(
+      [this](uint32_t, bool success, const std::string& error) {
+        OnStageFlushed(true, success, error);
+      });
+  encoder_->SetDequeueEventCallback([this](uint32_t) { WakeDriver(); });
+
+  // One transcode job: both stages share the encoder's placement.
+  decoder_->SetPlacement(encoder_config_.threading.placement);
+  encoder_->SetPlacement(encoder_config_.threading.placement);
+
+  webcodecs::VideoControlQueue::ConfigureMessage configure_msg;
+  configure_msg.configure_fn = []() { return true; };
+  if (!decoder_->Start() || !encoder_->Start() ||
+      !decoder_->Enqueue(std::move(configure_msg)) ||
+      !encoder_->Configure(encoder_config_)) {
+    OnStageError("Failed to start pipeline workers");
+    return false;
+  }
+  return true;
+}
+
+void Pipeline::FeedPackets() {
+  AVFormatContext* ctx = format_context_.get();
+  ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
+  while (packet && !Stopped()) {
+    int ret = av_read_frame(ctx, packet.get());
+    if (ret == AVERROR_EOF) {
+      return;
+    }
+    if (ret < 0) {
+      if (!cancelled_.load()) {
+        OnStageError("read packet: " + webcodecs::FFmpegErrorString(ret));
+      }
+      return;
+    }
+    if (packet->stream_index != stream_index_) {
+      av_packet_unref(packet.get());
+      continue;
+    }
+    av_packet_rescale_ts(packet.get(), stream_time_base_, {1, 1000000});
+    packets_read_.fetch_add(1);
+
+    // Per-stage backpressure: stop reading while either queue is full.
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] {
+        return Stopped() || (decode_queue_->size() < max_queued_packets_ &&
+                             encode_queue_->size() < max_queued_frames_);
+      });
+    }
+    if (Stopped()) {
+      return;
+    }
+
+    webcodecs::VideoControlQueue::DecodeMessage msg;
+    msg.packet = std::move(packet);
+    if (!decoder_->Enqueue(std::move(msg))) {
+      return;
+    }
+    packet = ffmpeg::make_packet();
+  }
+  if (!packet) {
+    OnStageError("Failed to allocate packet");
+  }
+}
+
+bool Pipeline::DrainStage(bool encoder) {
+  webcodecs::VideoControlQueue::FlushMessage msg;
+  msg.promise_id = 0;
+  bool queued = encoder ? encoder_->Enqueue(std::move(msg))
+                        : decoder_->Enqueue(std::move(msg));
+  if (!queued) {
+    OnStageError("Failed to enqueue flush");
+    return false;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  const bool& flushed = encoder ? encoder_flushed_ : decoder_flushed_;
+  cv_.wait(lock, [this, &flushed] { return Stopped() || flushed; });
+  return !Stopped();
+}
+
+void Pipeline::OnFrame(ffmpeg::AVFramePtr frame) {
+  frames_decoded_.fetch_add(1);
+  if (Stopped()) {
+    return;
+  }
+  // The decoder stores VideoFrame display size in sample_aspect_ratio; the
+  // encoder takes its own from the config.
+  frame->sample_aspect_ratio = {0, 1};
+  webcodecs::VideoControlQueue::EncodeMessage msg;
+  msg.frame = std::move(frame);
+  msg.key_frame = first_frame_.exchange(false);
+  // Fails once the encoder is stopping, when the frame is dropped, or if
+  // the ring is full despite its slack.
+  if (!encoder_->Enqueue(std::move(msg)) && !encode_queue_->IsClosed()) {
+    OnStageError("Encoder queue overflow");
+  }
+}
+
+void Pipeline::OnPacketsWritten(
+    std::unique_ptr<webcodecs::EncodedPacketData> data) {
+  data->pending->fetch_sub(1);
+  if (!data->sink_progress) {
+    return;
+  }
+  packets_written_.fetch_add(data->sink_progress->exchange(0));
+  // At most one progress update in flight; it reads the latest stats.
+  if (!progress_scheduled_.exchange(true) && !progress_tsfn_.Call(nullptr)) {
+    progress_scheduled_.store(false);
+  }
+}
+
+void Pipeline::OnStageError(const std::string& message) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error_.empty()) {
+      error_ = message.empty() ? "Pipeline failed" : message;
+    }
+    failed_.store(true);
+  }
+  cv_.notify_all();
+}
+
+void Pipeline::OnStageFlushed(bool encoder, bool success,
+                              const std::string& error) {
+  if (!success) {
+    OnStageError(error);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    (encoder ? encoder_flushed_ : decoder_flushed_) = true;
+  }
+  cv_.notify_all();
+}
+
+void Pipeline::WakeDriver() {
+  // Taking the lock orders the wakeup after the driver's predicate check.
+  { std::lock_guard<std::mutex> lock(mutex_); }
+  cv_.notify_all();
+}
+
+bool Pipeline::Stopped() const {
+  return cancelled_.load() || failed_.load();
+}
+
+Napi::Object Pipeline::StatsObject(Napi::Env env) const {
+  int64_t elapsed_us = state_ == "running"
+                           ? av_gettime_relative() - started_at_us_
+                           : elapsed_us_.load();
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("packetsRead", static_cast<double>(packets_read_.load()));
+  stats.Set("framesDecoded", static_cast<double>(frames_decoded_.load()));
+  stats.Set("packetsWritten", static_cast<double>(packets_written_.load()));
+  stats.Set("elapsedMs", static_cast<double>(elapsed_us) / 1000.0);
+  return stats;
+}
+
+int Pipeline::InterruptCallback(void* opaque) {
+  return static_cast<Pipeline*>(opaque)->cancelled_.load() ? 1 : 0;
+}
+
+void Pipeline::OnDone(Napi::Env env, Napi::Function, Pipeline* context,
+                      std::nullptr_t*) {
+  if (env == nullptr || context == nullptr) {
+    return;
+  }
+  Napi::HandleScope scope(env);
+
+  // The driver has posted this as its last step.
+  if (context->driver_thread_.joinable()) {
+    context->driver_thread_.join();
+  }
+  context->decoder_.reset();
+  context->encoder_.reset();
+  context->decode_queue_.reset();
+  context->encode_queue_.reset();
+  context->format_context_.reset();
+  context->muxer_ = nullptr;
+  context->muxer_ref_.Reset();
+  context->progress_tsfn_.Release();
+  context->state_ = "done";
+
+  std::unique_ptr<Napi::Promise::Deferred> deferred =
+      std::move(context->run_deferred_);
+  if (context->cancelled_.load()) {
+    deferred->Reject(
+        Napi::Error::New(env, "AbortError: Pipeline cancelled").Value());
+  } else if (context->failed_.load()) {
+    std::string error;
+    {
+      std::lock_guard<std::mutex> lock(context->mutex_);
+      error = context->error_;
+    }
+    deferred->Reject(Napi::Error::New(env, error).Value());
+  } else {
+    deferred->Resolve(context->StatsObject(env));
+  }
+  context->done_tsfn_.Release();
+}
+
+void Pipeline::OnProgress(Napi::Env env, Napi::Function fn, Pipeline* context,
+                          std::nullptr_t*) {
+  if (env == nullptr || context == nullptr) {
+    return;
+  }
+  context->progress_scheduled_.store(false);
+  if (context->state_ != "running") {
+    return;
+  }
+  Napi::HandleScope scope(env);
+  fn.Call({context->StatsObject(env)});
+}
+
+void Pipeline::UnrefOnFinalize(Napi::Env, Pipeline* context) {
+  context->Unref();
+}
@@ -0,0 +1,150 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Pipeline - native transcode of one video stream: demux -> decode ->
+// scale -> encode -> Muxer, without a packet or frame ever reaching JS.
+//
+// A driver thread reads the input and feeds a VideoDecoderWorker; decoded
+// frames go straight to a VideoEncoderWorker, which writes into a Muxer
+// track through its PacketSink. Each stage queue is bounded: the driver
+// stops reading while either the decoder's packet queue or the encoder's
+// frame queue is full. JS sees only the final stats and, optionally,
+// coalesced progress updates.
+
+#ifndef SRC_PIPELINE_H_
+#define SRC_PIPELINE_H_
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+#include <napi.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "src/demuxer_input.h"
+#include "src/ffmpeg_raii.h"
+#include "src/shared/control_message_queue.h"
+#include "src/shared/safe_tsfn.h"
+#include "src/shared/spsc_control_queue.h"
+#include "src/video_decoder_worker.h"
+#include "src/video_encoder_worker.h"
+
+class Muxer;
+
+class Pipeline : public Napi::ObjectWrap<Pipeline> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  // One per thread: each environment (main thread or worker_thread)
+  // defines its own class.
+  static thread_local Napi::FunctionReference constructor;
+
+  explicit Pipeline(const Napi::CallbackInfo& info);
+  ~Pipeline();
+
+  // Disallow copy and assign.
+  Pipeline(const Pipeline&) = delete;
+  Pipeline& operator=(const Pipeline&) = delete;
+
+ private:
+  Napi::Value Run(const Napi::CallbackInfo& info);
+  Napi::Value Cancel(const Napi::CallbackInfo& info);
+  Napi::Value GetState(const Napi::CallbackInfo& info);
+
+  // Driver thread: open, configure both workers, feed packets, drain.
+  void DriverLoop();
+  int OpenInput(const char** failed_op);
+  bool StartWorkers();
+  void FeedPackets();
+  // Enqueue a flush on |stage| and wait for it; false if the run stopped.
+  bool DrainStage(bool encoder);
+
+  // Worker callbacks.
+  void OnFrame(ffmpeg::AVFramePtr frame);
+  void OnPacketsWritten(std::unique_ptr<webcodecs::EncodedPacketData> data);
+  void OnStageError(const std::string& message);
+  void OnStageFlushed(bool encoder, bool success, const std::string& error);
+  void WakeDriver();
+
+  bool Stopped() const;
+  Napi::Object StatsObject(Napi::Env env) const;
+  void Cleanup();
+
+  static int InterruptCallback(void* opaque);
+  static void OnDone(Napi::Env env, Napi::Function fn, Pipeline* context,
+                     std::nullptr_t* data);
+  static void OnProgress(Napi::Env env, Napi::Function fn, Pipeline* context,
+                         std::nullptr_t* data);
+  static void UnrefOnFinalize(Napi::Env env, Pipeline* context);
+
+  using DoneTSFN = webcodecs::SafeThreadSafeFunction<Pipeline, std::nullptr_t,
+                                                     &Pipeline::OnDone>;
+  using ProgressTSFN =
+      webcodecs::SafeThreadSafeFunction<Pipeline, std::nullptr_t,
+                                        &Pipeline::OnProgress>;
+
+  // Default stage bounds. Frames are far larger than packets, so fewer of
+  // them are allowed in flight.
+  static constexpr int kDefaultMaxQueuedPackets = 16;
+  static constexpr int kDefaultMaxQueuedFrames = 4;
+
+  // Input. Memory inputs own a copy of their bytes.
+  std::string path_;
+  std::unique_ptr<webcodecs::DemuxerInput> input_;
+  ffmpeg::AVFormatContextPtr format_context_;
+  int stream_index_ = -1;
+  AVRational stream_time_base_ = {1, 1000000};
+
+  // Output; muxer_ref_ keeps the Muxer alive while muxer_ is in use.
+  Napi::ObjectReference muxer_ref_;
+  Muxer* muxer_ = nullptr;
+  int track_index_ = -1;
+
+  // Stages. The queues outlive their workers.
+  webcodecs::VideoEncoderConfig encoder_config_;
+  size_t max_queued_packets_ = kDefaultMaxQueuedPackets;
+  size_t max_queued_frames_ = kDefaultMaxQueuedFrames;
+  // Each has a single producer: the driver feeds the decoder, and the
+  // decoder's output, then the driver's drain, feed the encoder.
+  std::unique_ptr<webcodecs::VideoSpscControlQueue> decode_queue_;
+  std::unique_ptr<webcodecs::VideoSpscControlQueue> encode_queue_;
+  std::unique_ptr<webcodecs::VideoDecoderWorker> decoder_;
+  std::unique_ptr<webcodecs::VideoEncoderWorker> encoder_;
+
+  // Run state. The fields after mutex_ are guarded by it.
+  std::string state_;  // "idle", "running" or "done"; JS thread only
+  std::thread driver_thread_;
+  std::atomic<bool> cancelled_{false};
+  std::atomic<bool> failed_{false};  // error_ is set
+  std::mutex mutex_;
+  std::condition_variable cv_;  // Wakes the driver
+  bool decoder_flushed_ = false;
+  bool encoder_flushed_ = false;
+  std::string error_;  // First failure, empty if none
+
+  // Stats, written by the stages and read from JS.
+  std::atomic<int64_t> packets_read_{0};
+  std::atomic<int64_t> frames_decoded_{0};
+  std::atomic<int64_t> packets_written_{0};
+  std::atomic<bool> first_frame_{true};
+  int64_t started_at_us_ = 0;
+  std::atomic<int64_t> elapsed_us_{0};
+
+  DoneTSFN done_tsfn_;
+  ProgressTSFN progress_tsfn_;
+  std::atomic<bool> progress_scheduled_{false};
+  Napi::FunctionReference on_progress_callback_;
+  std::unique_ptr<Napi::Promise::Deferred> run_deferred_;
+};
+
+Napi::Object InitPipeline(Napi::Env env, Napi::Object exports);
+
+#endif  // SRC_PIPELINE_H_
@@ -0,0 +1,301 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Pixel kernel implementations and runtime dispatch.
+//
+// x86 kernels are compiled with per-function target attributes, so the
+// addon itself still builds for baseline x86-64 and only calls them after
+// checking the CPU. NEON is part of the AArch64 baseline.
+//
+// Division by 255 uses the exact identity
+//   (x + 127) / 255 == (t + (t >> 8)) >> 8, t = x + 128, for x <= 255 * 255.
+// Unpremultiply divides in single precision: the quotient is never within
+// rounding error of the next integer, so truncating it matches the integer
+// formula.
+
+#include "src/pixel_kernels.h"
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WEBCODECS_PIXEL_KERNELS_X86 1
+#define WEBCODECS_TARGET(x) __attribute__((target(x)))
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define WEBCODECS_PIXEL_KERNELS_NEON 1
+#endif
+
+namespace webcodecs {
+
+namespace {
+
+using RowKernel = void (*)(uint8_t* row, int width);
+
+struct RowKernels {
+  RowKernel premultiply;
+  RowKernel unpremultiply;
+  RowKernel set_opaque;
+};
+
+// --- Scalar ----------------------------------------------------------------
+
+void PremultiplyRowScalar(uint8_t* p, int width) {
+  for (int x = 0; x < width; ++x, p += 4) {
+    unsigned a = p[3];
+    p[0] = static_cast<uint8_t>((p[0] * a + 127) / 255);
+    p[1] = static_cast<uint8_t>((p[1] * a + 127) / 255);
+    p[2] = static_cast<uint8_t>((p[2] * a + 127) / 255);
+  }
+}
+
+void UnpremultiplyRowScalar(uint8_t* p, int width) {
+  for (int x = 0; x < width; ++x, p += 4) {
+    unsigned a = p[3];
+    if (a == 255) {
+      continue;
+    }
+    for (int c = 0; c < 3; ++c) {
+      unsigned v = a == 0 ? 0 : (p[c] * 255u + a / 2) / a;
+      p[c] = static_cast<uint8_t>(v > 255 ? 255 : v);
+    }
+  }
+}
+
+void SetOpaqueRowScalar(uint8_t* p, int width) {
+  for (int x = 0; x < width; ++x, p += 4) {
+    p[3] = 255;
+  }
+}
+
+#if defined(WEBCODECS_PIXEL_KERNELS_X86)
+
+// --- SSE4.1 ----------------------------------------------------------------
+
+// Per-lane multipliers for four 16-bit RGBA pixels: alpha for the colour
+// lanes, 255 (identity after the divide) for the alpha lanes.
+WEBCODECS_TARGET("sse4.1")
+inline __m128i AlphaFactorsSSE41(__m128i v) {
+  __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xFF), 0xFF);
+  return _mm_blend_epi16(a, _mm_set1_epi16(255), 0x88);
+}
+
+WEBCODECS_TARGET("sse4.1")
+inline __m128i MulDiv255SSE41(__m128i v, __m128i f) {
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(v, f), _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+WEBCODECS_TARGET("sse4.1")
+void PremultiplyRowSSE41(uint8_t* p, int width) {
+  const __m128i zero = _mm_setzero_si128();
+  int x = 0;
+  for (; x + 4 <= width; x += 4, p += 16) {
+    __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i lo = _mm_unpacklo_epi8(px, zero);
+    __m128i hi = _mm_unpackhi_epi8(px, zero);
+    lo = MulDiv255SSE41(lo, AlphaFactorsSSE41(lo));
+    hi = MulDiv255SSE41(hi, AlphaFactorsSSE41(hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(lo, hi));
+  }
+  PremultiplyRowScalar(p, width - x);
+}
+
+// One pixel (already widened to four floats) of UnpremultiplyRowSSE41.
+WEBCODECS_TARGET("sse4.1")
+inline __m128i UnpremultiplyPixelSSE41(__m128i v) {
+  __m128 c = _mm_cvtepi32_ps(v);
+  __m128 a = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3));
+  __m128 half = _mm_cvtepi32_ps(_mm_srli_epi32(_mm_shuffle_epi32(v, 0xFF), 1));
+  __m128 q = _mm_div_ps(_mm_add_ps(_mm_mul_ps(c, _mm_set1_ps(255.0f)), half),
+                        a);
+  q = _mm_min_ps(q, _mm_set1_ps(255.0f));
+  // a == 0 gives inf/NaN above; those pixels become 0.
+  q = _mm_andnot_ps(_mm_cmpeq_ps(a, _mm_setzero_ps()), q);
+  q = _mm_blend_ps(q, a, 0x8);
+  return _mm_cvttps_epi32(q);
+}
+
+WEBCODECS_TARGET("sse4.1")
+void UnpremultiplyRowSSE41(uint8_t* p, int width) {
+  int x = 0;
+  for (; x + 4 <= width; x += 4, p += 16) {
+    __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i p0 = UnpremultiplyPixelSSE41(_mm_cvtepu8_epi32(px));
+    __m128i p1 =
+        UnpremultiplyPixelSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(px, 4)));
+    __m128i p2 =
+        UnpremultiplyPixelSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(px, 8)));
+    __m128i p3 =
+        UnpremultiplyPixelSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(px, 12)));
+    __m128i out = _mm_packus_epi16(_mm_packus_epi32(p0, p1),
+                                   _mm_packus_epi32(p2, p3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), out);
+  }
+  UnpremultiplyRowScalar(p, width - x);
+}
+
+WEBCODECS_TARGET("sse4.1")
+void SetOpaqueRowSSE41(uint8_t* p, int width) {
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+  int x = 0;
+  for (; x + 4 <= width; x += 4, p += 16) {
+    __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_or_si128(px, alpha));
+  }
+  SetOpaqueRowScalar(p, width - x);
+}
+
+// --- AVX2 ------------------------------------------------------------------
+
+WEBCODECS_TARGET("avx2")
+inline __m256i AlphaFactorsAVX2(__m256i v) {
+  __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, 0xFF), 0xFF);
+  return _mm256_blend_epi16(a, _mm256_set1_epi16(255), 0x88);
+}
+
+WEBCODECS_TARGET("avx2")
+inline __m256i MulDiv255AVX2(__m256i v, __m256i f) {
+  __m256i t =
+      _mm256_add_epi16(_mm256_mullo_epi16(v, f), _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+WEBCODECS_TARGET("avx2")
+void PremultiplyRowAVX2(uint8_t* p, int width) {
+  const __m256i zero = _mm256_setzero_si256();
+  int x = 0;
+  // Unpack and pack both work within 128-bit lanes, so pixel order is kept.
+  for (; x + 8 <= width; x += 8, p += 32) {
+    __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i lo = _mm256_unpacklo_epi8(px, zero);
+    __m256i hi = _mm256_unpackhi_epi8(px, zero);
+    lo = MulDiv255AVX2(lo, AlphaFactorsAVX2(lo));
+    hi = MulDiv255AVX2(hi, AlphaFactorsAVX2(hi));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p),
+                        _mm256_packus_epi16(lo, hi));
+  }
+  PremultiplyRowSSE41(p, width - x);
+}
+
+WEBCODECS_TARGET("avx2")
+void SetOpaqueRowAVX2(uint8_t* p, int width) {
+  const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+  int x = 0;
+  for (; x + 8 <= width; x += 8, p += 32) {
+    __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p),
+                        _mm256_or_si256(px, alpha));
+  }
+  SetOpaqueRowSSE41(p, width - x);
+}
+
+#endif  // WEBCODECS_PIXEL_KERNELS_X86
+
+#if defined(WEBCODECS_PIXEL_KERNELS_NEON)
+
+// --- NEON ------------------------------------------------------------------
+
+inline uint8x8_t MulDiv255NEON(uint8x8_t c, uint8x8_t a) {
+  uint16x8_t x = vmull_u8(c, a);
+  return vrshrn_n_u16(vrsraq_n_u16(x, x, 8), 8);
+}
+
+void PremultiplyRowNEON(uint8_t* p, int width) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16, p += 64) {
+    uint8x16x4_t px = vld4q_u8(p);
+    for (int c = 0; c < 3; ++c) {
+      px.val[c] = vcombine_u8(
+          MulDiv255NEON(vget_low_u8(px.val[c]), vget_low_u8(px.val[3])),
+          MulDiv255NEON(vget_high_u8(px.val[c]), vget_high_u8(px.val[3])));
+    }
+    vst4q_u8(p, px);
+  }
+  PremultiplyRowScalar(p, width - x);
+}
+
+// Four lanes of one colour channel of UnpremultiplyRowNEON.
+inline uint32x4_t UnpremultiplyLanesNEON(uint16x4_t c, uint16x4_t a) {
+  float32x4_t af = vcvtq_f32_u32(vmovl_u16(a));
+  float32x4_t half = vcvtq_f32_u32(vmovl_u16(vshr_n_u16(a, 1)));
+  float32x4_t num = vmlaq_n_f32(half, vcvtq_f32_u32(vmovl_u16(c)), 255.0f);
+  float32x4_t q = vminq_f32(vdivq_f32(num, af), vdupq_n_f32(255.0f));
+  uint32x4_t nonzero = vmvnq_u32(vceqq_f32(af, vdupq_n_f32(0.0f)));
+  return vandq_u32(vcvtq_u32_f32(q), nonzero);
+}
+
+void UnpremultiplyRowNEON(uint8_t* p, int width) {
+  int x = 0;
+  for (; x + 8 <= width; x += 8, p += 32) {
+    uint8x8x4_t px = vld4_u8(p);
+    uint16x8_t a = vmovl_u8(px.val[3]);
+    for (int c = 0; c < 3; ++c) {
+      uint16x8_t v = vmovl_u8(px.val[c]);
+      uint32x4_t lo = UnpremultiplyLanesNEON(vget_low_u16(v), vget_low_u16(a));
+      uint32x4_t hi =
+          UnpremultiplyLanesNEON(vget_high_u16(v), vget_high_u16(a));
+      px.val[c] = vqmovn_u16(vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+    }
+    vst4_u8(p, px);
+  }
+  UnpremultiplyRowScalar(p, width - x);
+}
+
+void SetOpaqueRowNEON(uint8_t* p, int width) {
+  const uint32x4_t alpha = vdupq_n_u32(0xFF000000u);
+  int x = 0;
+  for (; x + 4 <= width; x += 4, p += 16) {
+    uint32x4_t px = vreinterpretq_u32_u8(vld1q_u8(p));
+    vst1q_u8(p, vreinterpretq_u8_u32(vorrq_u32(px, alpha)));
+  }
+  SetOpaqueRowScalar(p, width - x);
+}
+
+#endif  // WEBCODECS_PIXEL_KERNELS_NEON
+
+RowKernels SelectKernels() {
+#if defined(WEBCODECS_PIXEL_KERNELS_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {PremultiplyRowAVX2, UnpremultiplyRowSSE41, SetOpaqueRowAVX2};
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return {PremultiplyRowSSE41, UnpremultiplyRowSSE41, SetOpaqueRowSSE41};
+  }
+#elif defined(WEBCODECS_PIXEL_KERNELS_NEON)
+  return {PremultiplyRowNEON, UnpremultiplyRowNEON, SetOpaqueRowNEON};
+#endif
+  return {PremultiplyRowScalar, UnpremultiplyRowScalar, SetOpaqueRowScalar};
+}
+
+const RowKernels& Kernels() {
+  static const RowKernels kernels = SelectKernels();
+  return kernels;
+}
+
+void ForEachRow(RowKernel kernel, uint8_t* data, int width, int height,
+                int linesize) {
+  if (!data || width <= 0) {
+    return;
+  }
+  for (int y = 0; y < height; ++y) {
+    kernel(data + static_cast<ptrdiff_t>(y) * linesize, width);
+  }
+}
+
+}  // namespace
+
+void PremultiplyAlpha(uint8_t* data, int width, int height, int linesize) {
+  ForEachRow(Kernels().premultiply, data, width, height, linesize);
+}
+
+void UnpremultiplyAlpha(uint8_t* data, int width, int height, int linesize) {
+  ForEachRow(Kernels().unpremultiply, data, width, height, linesize);
+}
+
+void SetOpaqueAlpha(uint8_t* data, int width, int height, int linesize) {
+  ForEachRow(Kernels().set_opaque, data, width, height, linesize);
+}
+
+}  // namespace webcodecs
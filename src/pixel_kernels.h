@@ -0,0 +1,30 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Pixel kernels - vectorised loops over packed 8-bit RGBA-family rows.
+//
+// Each kernel has a scalar version plus SSE4.1/AVX2 (x86) and NEON (ARM)
+// versions, picked once per process from the CPU's features. All versions
+// produce bit-identical output. Rows are |linesize| bytes apart and alpha is
+// the last byte of each pixel (RGBA, BGRA, RGBX, BGRX).
+
+#ifndef SRC_PIXEL_KERNELS_H_
+#define SRC_PIXEL_KERNELS_H_
+
+#include <cstdint>
+
+namespace webcodecs {
+
+// Scale the colour channels by alpha: c' = (c * a + 127) / 255.
+void PremultiplyAlpha(uint8_t* data, int width, int height, int linesize);
+
+// Inverse of PremultiplyAlpha: c' = min(255, (c * 255 + a / 2) / a), and
+// 0 where a is 0.
+void UnpremultiplyAlpha(uint8_t* data, int width, int height, int linesize);
+
+// Set every alpha byte to 255.
+void SetOpaqueAlpha(uint8_t* data, int width, int height, int linesize);
+
+}  // namespace webcodecs
+
+#endif  // SRC_PIXEL_KERNELS_H_
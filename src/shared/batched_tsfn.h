@@ -0,0 +1,163 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * batched_tsfn.h - Coalescing Thread-Safe Function
+ *
+ * Drop-in replacement for SafeThreadSafeFunction for high-rate outputs
+ * (decoded frames, encoded chunks). Items queued while an earlier delivery
+ * is still waiting for the JS thread ride along with it, so one libuv
+ * wakeup and one native->JS transition deliver up to |max_batch| items.
+ * CallJs still runs once per item, in order, so per-item handlers are
+ * unchanged.
+ *
+ * With max_batch == 1 every Call() schedules its own delivery, exactly like
+ * SafeThreadSafeFunction. Larger batches trade the microtask checkpoint
+ * between outputs for fewer wakeups.
+ *
+ * Given a CodecStats, the time from Call() to the item's CallJs is recorded
+ * as its delivery stage.
+ *
+ * Usage:
+ *   BatchedThreadSafeFunction<Context, DataType, OnItem> tsfn;
+ *   tsfn.Init(BatchedThreadSafeFunction<...>::TSFN::New(env, fn, ...), 16);
+ *
+ *   // From worker thread:
+ *   if (!tsfn.Call(data)) {
+ *     delete data;  // Released; clean up data yourself
+ *   }
+ */
+
+#include <napi.h>
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "src/shared/codec_stats.h"
+#include "src/shared/safe_tsfn.h"
+
+namespace webcodecs {
+
+/**
+ * @tparam Context The context type passed to the TSFN callback
+ * @tparam DataType The per-item data type
+ * @tparam CallJs Per-item callback; called with env == nullptr during
+ *         teardown, exactly as a plain TSFN would
+ */
+template <typename Context, typename DataType,
+          void (*CallJs)(Napi::Env, Napi::Function, Context*, DataType*)>
+class BatchedThreadSafeFunction {
+ public:
+  static void Deliver(Napi::Env env, Napi::Function fn, Context* ctx,
+                      BatchedThreadSafeFunction* self);
+  using Inner = SafeThreadSafeFunction<Context, BatchedThreadSafeFunction,
+                                       &BatchedThreadSafeFunction::Deliver>;
+  using TSFN = typename Inner::TSFN;
+
+  BatchedThreadSafeFunction() = default;
+
+  // Non-copyable, non-movable (deliveries point at this object)
+  BatchedThreadSafeFunction(const BatchedThreadSafeFunction&) = delete;
+  BatchedThreadSafeFunction& operator=(const BatchedThreadSafeFunction&) =
+      delete;
+
+  /**
+   * Initialize with a TSFN and the most items to deliver per wakeup.
+   * |stats|, if set, must outlive every delivery.
+   */
+  void Init(TSFN tsfn, size_t max_batch = 1, CodecStats* stats = nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_batch_ = max_batch > 0 ? max_batch : 1;
+    stats_ = stats;
+    tsfn_.Init(std::move(tsfn));
+  }
+
+  /**
+   * Queue |data| for delivery. Same contract as SafeThreadSafeFunction:
+   * on false the caller still owns |data|.
+   */
+  [[nodiscard]] bool Call(DataType* data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!tsfn_.IsActive()) {
+      return false;
+    }
+    items_.push_back({data, stats_ ? CodecStats::Clock::now()
+                                   : CodecStats::Clock::time_point{}});
+    if (items_.size() <= scheduled_ * max_batch_) {
+      return true;  // A pending delivery will pick it up
+    }
+    if (!tsfn_.Call(this)) {
+      items_.pop_back();
+      return false;
+    }
+    ++scheduled_;
+    return true;
+  }
+
+  void Release() { tsfn_.Release(); }
+  [[nodiscard]] bool IsReleased() const { return tsfn_.IsReleased(); }
+  [[nodiscard]] bool IsActive() const { return tsfn_.IsActive(); }
+  void Unref(Napi::Env env) { tsfn_.Unref(env); }
+
+ private:
+  struct Item {
+    DataType* data;
+    CodecStats::Clock::time_point queued_at;
+  };
+
+  // Up to max_batch_ queued items for one delivery.
+  std::vector<Item> Take() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (scheduled_ > 0) {
+      --scheduled_;
+    }
+    size_t count = items_.size() < max_batch_ ? items_.size() : max_batch_;
+    std::vector<Item> batch(items_.begin(), items_.begin() + count);
+    items_.erase(items_.begin(), items_.begin() + count);
+    return batch;
+  }
+
+  Inner tsfn_;
+  std::mutex mutex_;
+  // Invariant: items_.size() <= scheduled_ * max_batch_
+  std::deque<Item> items_;
+  CodecStats* stats_ = nullptr;
+  size_t scheduled_ = 0;  // Deliveries queued on tsfn_ and not yet run
+  size_t max_batch_ = 1;
+};
+
+template <typename Context, typename DataType,
+          void (*CallJs)(Napi::Env, Napi::Function, Context*, DataType*)>
+void BatchedThreadSafeFunction<Context, DataType, CallJs>::Deliver(
+    Napi::Env env, Napi::Function fn, Context* ctx,
+    BatchedThreadSafeFunction* self) {
+  std::vector<Item> batch = self->Take();
+
+  // Every item is handed to CallJs (which owns it) even if an earlier
+  // callback throws; the first error is rethrown once all are delivered.
+  std::exception_ptr first_error;
+  for (const Item& item : batch) {
+    if (self->stats_ && env != nullptr) {
+      self->stats_->Record(CodecStats::Stage::kDelivery, item.queued_at,
+                           CodecStats::Clock::now());
+    }
+    try {
+      CallJs(env, fn, ctx, item.data);
+    } catch (...) {
+      if (!first_error) {
+        first_error = std::current_exception();
+      }
+    }
+  }
+  if (first_error) {
+    std::rethrow_exception(first_error);
+  }
+}
+
+}  // namespace webcodecs
@@ -0,0 +1,113 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * codec_capabilities.h - Process-Wide Codec Capability Cache
+ *
+ * Codec lookups (avcodec_find_encoder, avcodec_find_encoder_by_name, ...)
+ * walk FFmpeg's whole codec list, and every configure() and
+ * isConfigSupported() used to repeat them. Each lookup is memoised here the
+ * first time it is needed, including lookups that find nothing: the set of
+ * linked codecs never changes within a process.
+ *
+ * Hardware backends are different: an encoder or device type can be built
+ * in and still fail to open (no GPU, driver missing, session limit reached),
+ * which costs tens to hundreds of milliseconds per attempt. Failures are
+ * remembered for kHardwareRetryInterval so later configures go straight to
+ * the next candidate, then retried in case the cause was transient.
+ *
+ * Thread Safety:
+ * - Every method may be called from any thread; codec workers probe and
+ *   record failures off the JS thread.
+ */
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+struct AVCodec;
+
+namespace webcodecs {
+
+class CodecCapabilities {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // How long a failed hardware backend is skipped before it is tried again.
+  static constexpr std::chrono::seconds kHardwareRetryInterval{60};
+
+  /**
+   * Get the process-wide cache. Intentionally leaked (like the other
+   * process-wide singletons) so workers never race static destructors.
+   */
+  static CodecCapabilities& Instance() {
+    static auto* capabilities = new CodecCapabilities();
+    return *capabilities;
+  }
+
+  CodecCapabilities(const CodecCapabilities&) = delete;
+  CodecCapabilities& operator=(const CodecCapabilities&) = delete;
+
+  /**
+   * Result of |probe| for |key|, running it only on the first call.
+   * Null results are cached too.
+   */
+  template <typename Probe>
+  const AVCodec* FindCodec(const std::string& key, Probe&& probe) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = codecs_.find(key);
+    if (it != codecs_.end()) {
+      return it->second;
+    }
+    const AVCodec* codec = std::forward<Probe>(probe)();
+    codecs_.emplace(key, codec);
+    return codec;
+  }
+
+  /**
+   * Record that the hardware backend |name| failed to open.
+   */
+  void MarkHardwareFailed(const std::string& name,
+                          Clock::time_point now = Clock::now()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    hardware_failures_[name] = now;
+  }
+
+  /**
+   * True while |name| failed within the last kHardwareRetryInterval.
+   */
+  [[nodiscard]] bool HardwareRecentlyFailed(
+      const std::string& name, Clock::time_point now = Clock::now()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = hardware_failures_.find(name);
+    if (it == hardware_failures_.end()) {
+      return false;
+    }
+    if (now - it->second >= kHardwareRetryInterval) {
+      hardware_failures_.erase(it);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Forget everything. For tests.
+   */
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    codecs_.clear();
+    hardware_failures_.clear();
+  }
+
+ private:
+  CodecCapabilities() = default;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, const AVCodec*> codecs_;
+  std::unordered_map<std::string, Clock::time_point> hardware_failures_;
+};
+
+}  // namespace webcodecs
@@ -0,0 +1,204 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * codec_reaper.h - Off-loop Teardown of Codec Workers
+ *
+ * Stopping a CodecWorker waits for the message it is processing, which for
+ * a slow frame (AV1, 4K HEVC) can take hundreds of milliseconds, and then
+ * frees the codec. close() and reset() must not spend that time on the
+ * event loop, so codecs retire their worker instead:
+ *
+ * 1. OutputGate::Close() on the JS thread. It waits only for an output
+ *    callback already running, after which no output reaches the codec
+ *    object, exactly as if the worker had been joined.
+ * 2. The worker and its queue are handed to CodecReaper, whose thread
+ *    stops and destroys them.
+ *
+ * Thread Safety:
+ * - OutputGate::Guard() wrappers run on worker threads; Close() on any.
+ * - CodecReaper may be used from any thread.
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace webcodecs {
+
+/**
+ * Lets a codec cut off its worker's callbacks without joining the worker.
+ * Callbacks wrapped with Guard() run under the gate's lock until Close(),
+ * and are dropped afterwards.
+ */
+class OutputGate : public std::enable_shared_from_this<OutputGate> {
+ public:
+  static std::shared_ptr<OutputGate> Create() {
+    return std::shared_ptr<OutputGate>(new OutputGate());
+  }
+
+  /**
+   * Wrap |fn| so it only runs while the gate is open. The wrapper keeps
+   * the gate alive, so it may outlive the codec that created it.
+   */
+  template <typename Fn>
+  auto Guard(Fn fn) {
+    return [gate = shared_from_this(), fn = std::move(fn)](auto&&... args) {
+      std::lock_guard<std::mutex> lock(gate->mutex_);
+      if (!gate->closed_) {
+        fn(std::forward<decltype(args)>(args)...);
+      }
+    };
+  }
+
+  /**
+   * Drop all later callbacks. Returns once a callback in progress, if any,
+   * has finished.
+   */
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+
+  [[nodiscard]] bool closed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+  }
+
+ private:
+  OutputGate() = default;
+
+  mutable std::mutex mutex_;
+  bool closed_ = false;
+};
+
+/**
+ * Process-wide thread that runs teardown work in posting order.
+ */
+class CodecReaper {
+ public:
+  /**
+   * Singleton accessor. Intentionally leaked, like CodecScheduler;
+   * Shutdown() joins the thread from the environment cleanup hook.
+   */
+  static CodecReaper& Instance() {
+    static CodecReaper* instance = new CodecReaper();
+    return *instance;
+  }
+
+  // Non-copyable, non-movable
+  CodecReaper(const CodecReaper&) = delete;
+  CodecReaper& operator=(const CodecReaper&) = delete;
+
+  /**
+   * Run |task| on the reaper thread, started on first use. After
+   * Shutdown(), |task| runs on the caller's thread instead.
+   */
+  void Post(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!stopping_) {
+        if (!thread_.joinable()) {
+          thread_ = std::thread(&CodecReaper::ThreadLoop, this);
+        }
+        tasks_.push_back(std::move(task));
+        ++pending_;
+        cv_.notify_all();
+        return;
+      }
+    }
+    task();
+  }
+
+  /**
+   * Retire |worker| and then |queue|, the message queue it reads.
+   */
+  template <typename Worker, typename Queue>
+  void Retire(std::unique_ptr<Worker> worker, std::unique_ptr<Queue> queue) {
+    if (!worker && !queue) {
+      return;
+    }
+    // std::function needs a copyable callable.
+    std::shared_ptr<Worker> shared_worker(std::move(worker));
+    std::shared_ptr<Queue> shared_queue(std::move(queue));
+    Post([shared_worker, shared_queue]() mutable {
+      if (shared_worker) {
+        shared_worker->Stop();
+      }
+      shared_worker.reset();
+      shared_queue.reset();
+    });
+  }
+
+  /**
+   * Wait until every task posted so far has run.
+   */
+  void Drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return pending_ == 0; });
+  }
+
+  /**
+   * Run the remaining tasks and join the thread. Called from the
+   * environment cleanup hook before CodecScheduler::Shutdown(), since
+   * stopping a pooled worker waits for its pool slice.
+   */
+  void Shutdown() {
+    std::thread thread;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      stopping_ = true;
+      thread.swap(thread_);
+    }
+    cv_.notify_all();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  /**
+   * Tasks posted and not yet finished.
+   */
+  [[nodiscard]] size_t pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_;
+  }
+
+ private:
+  CodecReaper() = default;
+
+  void ThreadLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this] { return !tasks_.empty() || stopping_; });
+      if (tasks_.empty()) {
+        return;  // Stopping and drained
+      }
+      std::function<void()> task = std::move(tasks_.front());
+      tasks_.pop_front();
+      lock.unlock();
+      task();
+      task = nullptr;  // Release captures before reporting completion
+      lock.lock();
+      --pending_;
+      cv_.notify_all();
+    }
+  }
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  size_t pending_ = 0;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace webcodecs
@@ -0,0 +1,236 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * codec_scheduler.h - Shared Worker Pool for Codec Instances
+ *
+ * By default every CodecWorker owns a dedicated std::thread. With hundreds
+ * of concurrent low-bitrate streams that means hundreds of mostly idle OS
+ * threads and a lot of context switching. When the pool is enabled, codec
+ * workers instead become cooperative tasks run by a fixed set of threads
+ * (sized to the core count by default) with per-thread deques and work
+ * stealing.
+ *
+ * Ordering:
+ * - A task is scheduled at most once at a time (CodecWorker enforces this
+ *   with its own scheduled flag), so a codec's messages are still processed
+ *   one at a time in FIFO order, just not always on the same OS thread.
+ * - Each run processes a bounded slice of messages and then yields, so a
+ *   busy codec cannot starve the others sharing its thread.
+ *
+ * Thread Safety:
+ * - Configure/Schedule/Shutdown may be called from any thread.
+ * - Task::Run is only ever called from pool threads.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace webcodecs {
+
+/**
+ * Process-wide pool of codec worker threads.
+ */
+class CodecScheduler {
+ public:
+  /**
+   * Unit of work run by the pool. Implemented by CodecWorker.
+   */
+  class Task {
+   public:
+    virtual ~Task() = default;
+
+    // Process a slice of pending work on a pool thread.
+    virtual void Run() = 0;
+
+    // The pool shut down with this task still queued; it will not run.
+    virtual void Cancel() = 0;
+  };
+
+  /**
+   * Singleton accessor. Intentionally leaked so pool threads never race
+   * static destructors at process exit; Shutdown() joins them instead.
+   */
+  static CodecScheduler& Instance() {
+    static CodecScheduler* instance = new CodecScheduler();
+    return *instance;
+  }
+
+  // Non-copyable, non-movable
+  CodecScheduler(const CodecScheduler&) = delete;
+  CodecScheduler& operator=(const CodecScheduler&) = delete;
+
+  /**
+   * Set the pool size used by codec workers started from now on.
+   * 0 disables the pool (dedicated thread per codec, the default).
+   * The pool only grows: shrinking keeps existing threads running so
+   * already-pooled codecs are unaffected.
+   *
+   * @return the effective pool size (0 when disabled)
+   */
+  size_t Configure(size_t thread_count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+      return 0;
+    }
+    thread_count = std::min(thread_count, kMaxThreads);
+    enabled_ = thread_count > 0;
+    if (deques_.size() < thread_count) {
+      deques_.resize(thread_count);
+    }
+    while (threads_.size() < deques_.size()) {
+      threads_.emplace_back(&CodecScheduler::ThreadLoop, this,
+                            threads_.size());
+    }
+    return enabled_ ? threads_.size() : 0;
+  }
+
+  /**
+   * Whether newly started codec workers should use the pool.
+   */
+  [[nodiscard]] bool enabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_;
+  }
+
+  /**
+   * Number of pool threads (may be non-zero while disabled).
+   */
+  [[nodiscard]] size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return threads_.size();
+  }
+
+  /**
+   * Default pool size: one thread per core.
+   */
+  static size_t DefaultSize() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+
+  /**
+   * Queue |task| for execution. The caller guarantees |task| is not already
+   * queued or running.
+   *
+   * @return false if the pool is not running; the task will not run
+   */
+  [[nodiscard]] bool Schedule(Task* task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_ || deques_.empty()) {
+        return false;
+      }
+      // Pool threads push to their own deque (the task's next slice is
+      // likely to find its codec state still in cache); other threads
+      // spread work round-robin.
+      size_t index = current_index_ < deques_.size()
+                         ? current_index_
+                         : next_index_++ % deques_.size();
+      deques_[index].push_back(task);
+      ++pending_;
+    }
+    cv_.notify_one();
+    return true;
+  }
+
+  /**
+   * Stop and join all pool threads. Tasks still queued are cancelled.
+   * Called from the environment cleanup hook; afterwards Configure() is a
+   * no-op and codec workers fall back to dedicated threads.
+   */
+  void Shutdown() {
+    std::vector<std::thread> threads;
+    std::vector<Task*> dropped;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      stopping_ = true;
+      enabled_ = false;
+      threads.swap(threads_);
+      for (auto& deque : deques_) {
+        dropped.insert(dropped.end(), deque.begin(), deque.end());
+        deque.clear();
+      }
+      pending_ = 0;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+    for (Task* task : dropped) {
+      task->Cancel();
+    }
+  }
+
+ private:
+  CodecScheduler() = default;
+
+  /**
+   * Pop from the front of our own deque, otherwise steal from the back of
+   * another thread's. Caller holds mutex_ and has checked pending_.
+   */
+  Task* TakeTask(size_t index) {
+    size_t count = deques_.size();
+    for (size_t i = 0; i < count; ++i) {
+      std::deque<Task*>& deque = deques_[(index + i) % count];
+      if (deque.empty()) {
+        continue;
+      }
+      Task* task;
+      if (i == 0) {
+        task = deque.front();
+        deque.pop_front();
+      } else {
+        task = deque.back();
+        deque.pop_back();
+      }
+      return task;
+    }
+    return nullptr;
+  }
+
+  void ThreadLoop(size_t index) {
+    current_index_ = index;
+    while (true) {
+      Task* task = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return pending_ > 0 || stopping_; });
+        if (stopping_) {
+          return;
+        }
+        --pending_;
+        task = TakeTask(index);
+      }
+      if (task) {
+        task->Run();
+      }
+    }
+  }
+
+  static constexpr size_t kMaxThreads = 256;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::deque<Task*>> deques_;
+  std::vector<std::thread> threads_;
+  size_t pending_ = 0;  // Total tasks across all deques
+  size_t next_index_ = 0;
+  bool enabled_ = false;
+  bool stopping_ = false;
+
+  // Index of the pool thread running on this OS thread (or max if none).
+  static inline thread_local size_t current_index_ = static_cast<size_t>(-1);
+};
+
+}  // namespace webcodecs
@@ -0,0 +1,268 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * codec_stats.h - Per-Codec Pipeline Statistics
+ *
+ * Each codec instance owns one CodecStats, shared with its worker and its
+ * output TSFN. Stages are timed where they happen:
+ *
+ *   queueWait  encode()/decode() enqueue -> worker picks the message up
+ *   codec      worker time spent in the encode/decode handler
+ *   convert    swscale/swresample conversion inside that handler
+ *   delivery   worker hands an output to the TSFN -> JS callback runs
+ *   frameLatency  decode() enqueue -> that chunk's frame leaves the worker
+ *              (video decoders; reorder and frame-thread delay included)
+ *
+ * Every stage is a LatencyHistogram of relaxed atomics (log2 microsecond
+ * buckets), so recording is a handful of uncontended atomic adds and never
+ * takes a lock. Snapshots are read on the JS thread while workers keep
+ * recording; they are consistent per counter, not across counters.
+ *
+ * While TraceRecorder is recording, stages are also emitted as trace
+ * events under the codec's category (see trace_events.h).
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "trace_events.h"
+
+namespace webcodecs {
+
+/**
+ * Lock-free latency histogram with power-of-two microsecond buckets.
+ * Bucket 0 holds samples under 1us; bucket i holds [2^(i-1), 2^i) us; the
+ * last bucket also takes everything larger.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr size_t kBuckets = 32;
+
+  struct Snapshot {
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    std::array<uint64_t, kBuckets> buckets{};
+
+    double MeanUs() const {
+      return count > 0 ? static_cast<double>(total_ns) / 1000.0 /
+                             static_cast<double>(count)
+                       : 0.0;
+    }
+
+    /**
+     * Upper bound of the bucket holding quantile |q| (0..1), capped at the
+     * largest sample seen.
+     */
+    double PercentileUs(double q) const {
+      if (count == 0) {
+        return 0.0;
+      }
+      double max_us = static_cast<double>(max_ns) / 1000.0;
+      auto rank = static_cast<uint64_t>(q * static_cast<double>(count));
+      if (rank >= count) {
+        rank = count - 1;
+      }
+      uint64_t seen = 0;
+      for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+          double upper = static_cast<double>(uint64_t{1} << i);
+          return upper < max_us ? upper : max_us;
+        }
+      }
+      return max_us;
+    }
+  };
+
+  void Record(std::chrono::nanoseconds elapsed) {
+    uint64_t ns = elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count())
+                                      : 0;
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_ns_.fetch_add(ns, std::memory_order_relaxed);
+    buckets_[BucketFor(ns / 1000)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (ns > max && !max_ns_.compare_exchange_weak(
+                           max, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  Snapshot Read() const {
+    Snapshot snapshot;
+    snapshot.count = count_.load(std::memory_order_relaxed);
+    snapshot.total_ns = total_ns_.load(std::memory_order_relaxed);
+    snapshot.max_ns = max_ns_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kBuckets; ++i) {
+      snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+  }
+
+  void Reset() {
+    count_.store(0, std::memory_order_relaxed);
+    total_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+    for (auto& bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  static size_t BucketFor(uint64_t us) {
+    size_t bucket = 0;
+    while (us > 0 && bucket < kBuckets - 1) {
+      us >>= 1;
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> total_ns_{0};
+  std::atomic<uint64_t> max_ns_{0};
+  std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+};
+
+/**
+ * Statistics for one codec instance.
+ */
+class CodecStats {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Stage { kQueueWait, kCodec, kConvert, kDelivery, kFrameLatency };
+
+  /**
+   * @param category Trace category, e.g. "VideoEncoder" (string literal)
+   */
+  explicit CodecStats(const char* category) : category_(category) {}
+
+  CodecStats(const CodecStats&) = delete;
+  CodecStats& operator=(const CodecStats&) = delete;
+
+  /**
+   * Record one stage from |start| to |end|. |trace_name| names the trace
+   * event (defaults to the stage name).
+   */
+  void Record(Stage stage, Clock::time_point start, Clock::time_point end,
+              const char* trace_name = nullptr) {
+    Histogram(stage).Record(end - start);
+
+    TraceRecorder& tracer = TraceRecorder::Instance();
+    if (!tracer.enabled()) {
+      return;
+    }
+    const char* name = trace_name ? trace_name : StageName(stage);
+    if (stage == Stage::kQueueWait || stage == Stage::kDelivery ||
+        stage == Stage::kFrameLatency) {
+      tracer.AsyncSpan(category_, name, start, end);  // Crosses threads
+    } else {
+      tracer.Complete(category_, name, start, end);
+    }
+  }
+
+  void AddBytesCopied(size_t bytes) {
+    bytes_copied_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  LatencyHistogram& Histogram(Stage stage) {
+    switch (stage) {
+      case Stage::kQueueWait:
+        return queue_wait_;
+      case Stage::kCodec:
+        return codec_;
+      case Stage::kConvert:
+        return convert_;
+      case Stage::kFrameLatency:
+        return frame_latency_;
+      case Stage::kDelivery:
+      default:
+        return delivery_;
+    }
+  }
+
+  const LatencyHistogram& Histogram(Stage stage) const {
+    return const_cast<CodecStats*>(this)->Histogram(stage);
+  }
+
+  uint64_t bytes_copied() const {
+    return bytes_copied_.load(std::memory_order_relaxed);
+  }
+
+  const char* category() const { return category_; }
+
+  void Reset() {
+    queue_wait_.Reset();
+    codec_.Reset();
+    convert_.Reset();
+    delivery_.Reset();
+    frame_latency_.Reset();
+    bytes_copied_.store(0, std::memory_order_relaxed);
+  }
+
+  static const char* StageName(Stage stage) {
+    switch (stage) {
+      case Stage::kQueueWait:
+        return "queueWait";
+      case Stage::kCodec:
+        return "codec";
+      case Stage::kConvert:
+        return "convert";
+      case Stage::kFrameLatency:
+        return "frameLatency";
+      case Stage::kDelivery:
+      default:
+        return "delivery";
+    }
+  }
+
+ private:
+  const char* category_;
+  LatencyHistogram queue_wait_;
+  LatencyHistogram codec_;
+  LatencyHistogram convert_;
+  LatencyHistogram delivery_;
+  LatencyHistogram frame_latency_;
+  std::atomic<uint64_t> bytes_copied_{0};
+};
+
+/**
+ * Times a scope as one stage. A null |stats| makes it a no-op.
+ *
+ *   {
+ *     StageTimer timer(stats(), CodecStats::Stage::kConvert);
+ *     ScaleFrame(...);
+ *   }
+ */
+class StageTimer {
+ public:
+  StageTimer(CodecStats* stats, CodecStats::Stage stage,
+             const char* trace_name = nullptr)
+      : stats_(stats), stage_(stage), trace_name_(trace_name) {
+    if (stats_) {
+      start_ = CodecStats::Clock::now();
+    }
+  }
+
+  ~StageTimer() {
+    if (stats_) {
+      stats_->Record(stage_, start_, CodecStats::Clock::now(), trace_name_);
+    }
+  }
+
+  StageTimer(const StageTimer&) = delete;
+  StageTimer& operator=(const StageTimer&) = delete;
+
+ private:
+  CodecStats* stats_;
+  CodecStats::Stage stage_;
+  const char* trace_name_;
+  CodecStats::Clock::time_point start_;
+};
+
+}  // namespace webcodecs
@@ -5,19 +5,22 @@
 /**
  * codec_worker.h - Template Worker Thread for WebCodecs Decoders/Encoders
  *
- * Provides a dedicated worker thread that:
+ * Provides a worker (a dedicated thread, or a task on the shared
+ * CodecScheduler pool when enabled) that:
  * - Owns the AVCodecContext exclusively (no mutex needed for codec ops)
- * - Processes messages from ControlMessageQueue in FIFO order
+ * - Processes messages from its WorkerMessageQueue in FIFO order
  * - Guarantees output ordering per W3C spec
  * - Handles lifecycle (Start/Stop) with proper shutdown
  *
  * Thread Safety:
  * - Main thread: Enqueue messages, Start/Stop worker
- * - Worker thread: Dequeue and process messages, FFmpeg calls
+ * - Worker thread: Dequeue and process messages, FFmpeg calls. In pooled
+ *   mode this is whichever pool thread runs the current slice; slices never
+ *   overlap, so the codec still sees strictly serial, FIFO access.
  * - Output via SafeThreadSafeFunction to JS thread
  *
  * Usage:
- *   class VideoDecoderWorker : public CodecWorker<VideoControlQueue> {
+ *   class VideoDecoderWorker : public CodecWorker<VideoWorkerQueue> {
  *     void OnConfigure(const ConfigureMessage& msg) override;
  *     void OnDecode(const DecodeMessage& msg) override;
  *     // ...
@@ -28,6 +31,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -37,6 +41,9 @@
 #include <variant>
 
 #include "../ffmpeg_raii.h"
+#include "../thread_placement.h"
+#include "codec_scheduler.h"
+#include "codec_stats.h"
 #include "control_message_queue.h"
 #include "safe_tsfn.h"
 
@@ -75,11 +82,13 @@ struct DequeueEventData {
  * - OnFlush: drain codec, resolve promise
  * - OnReset: avcodec_flush_buffers
  *
- * @tparam MessageQueue ControlMessageQueue type (VideoControlQueue or
- * AudioControlQueue)
+ * @tparam MessageQueue WorkerMessageQueue type (VideoWorkerQueue or
+ * AudioWorkerQueue). The codec owning the queue chooses the implementation:
+ * ControlMessageQueue, or SpscControlMessageQueue when there is a single
+ * producer.
  */
 template <typename MessageQueue>
-class CodecWorker {
+class CodecWorker : private CodecScheduler::Task {
  public:
   using ConfigureMessage = typename MessageQueue::ConfigureMessage;
   using DecodeMessage = typename MessageQueue::DecodeMessage;
@@ -125,7 +134,8 @@ class CodecWorker {
   // ===========================================================================
 
   /**
-   * Start the worker thread.
+   * Start the worker thread, or join the shared pool when
+   * CodecScheduler::Instance() is enabled and no placement is set.
    * Safe to call multiple times (idempotent).
    *
    * @return true if worker started or already running, false on error
@@ -139,6 +149,18 @@ class CodecWorker {
 
     should_exit_.store(false, std::memory_order_release);
 
+    // Pool threads are shared by every codec, so they cannot be placed.
+    pooled_ = CodecScheduler::Instance().enabled() && placement_.IsDefault();
+    if (pooled_) {
+      running_.store(true, std::memory_order_release);
+      queue_->SetReadyCallback([this]() { ScheduleSlice(); });
+      // Pick up anything enqueued before Start().
+      if (!queue_->empty()) {
+        ScheduleSlice();
+      }
+      return true;
+    }
+
     try {
       worker_thread_ = std::thread(&CodecWorker::WorkerLoop, this);
       running_.store(true, std::memory_order_release);
@@ -168,8 +190,15 @@ class CodecWorker {
     // 2. Shutdown the queue to unblock any waiting Dequeue()
     queue_->Shutdown();
 
-    // 3. Join worker thread
-    if (worker_thread_.joinable()) {
+    // 3. Join worker thread, or wait out any queued/running pool slice
+    if (pooled_) {
+      queue_->SetReadyCallback(nullptr);
+      std::unique_lock<std::mutex> slice_lock(slice_mutex_);
+      slice_cv_.wait(slice_lock, [this] {
+        return slices_in_run_ == 0 &&
+               !scheduled_.load(std::memory_order_acquire);
+      });
+    } else if (worker_thread_.joinable()) {
       worker_thread_.join();
     }
 
@@ -225,6 +254,25 @@ class CodecWorker {
     dequeue_callback_ = std::move(cb);
   }
 
+  /**
+   * Run the worker thread, and the FFmpeg threads it starts, with
+   * |placement| (call before Start()). A placement other than the default
+   * always gets a dedicated thread.
+   */
+  void SetPlacement(ThreadPlacement placement) {
+    placement_ = std::move(placement);
+  }
+
+  [[nodiscard]] const ThreadPlacement& placement() const { return placement_; }
+
+  /**
+   * Record queue wait and codec time into |stats| (call before Start()).
+   * Subclasses add their conversion timings and copies through stats().
+   */
+  void SetStats(std::shared_ptr<CodecStats> stats) {
+    stats_ = std::move(stats);
+  }
+
  protected:
   // ===========================================================================
   // VIRTUAL HANDLERS (implement in subclass)
@@ -367,12 +415,29 @@ class CodecWorker {
    */
   MessageQueue* queue() { return queue_; }
 
+  /**
+   * Stats sink, or nullptr when none was set (StageTimer accepts either).
+   */
+  CodecStats* stats() const { return stats_.get(); }
+
  private:
+  // Messages handled per pool slice before yielding to other codecs.
+  static constexpr int kSliceBudget = 8;
+
   /**
-   * Main worker loop.
+   * Main worker loop (dedicated thread mode).
    * Dequeues messages and dispatches to handlers.
    */
   void WorkerLoop() {
+    // Placed before the first message, so the codec opened by Configure
+    // and its threads start out on the requested CPUs and node.
+    std::string placement_error;
+    if (!placement_.IsDefault() &&
+        !ApplyThreadPlacement(placement_, &placement_error)) {
+      OutputError(AVERROR(EPERM),
+                  "Could not apply thread placement: " + placement_error);
+    }
+
     while (!ShouldExit()) {
       // Dequeue with timeout to check for shutdown periodically
       auto msg_opt = queue_->DequeueFor(std::chrono::milliseconds(100));
@@ -382,28 +447,106 @@ class CodecWorker {
         continue;
       }
 
-      Message& msg = *msg_opt;
-
-      // Dispatch based on message type
-      std::visit(
-          MessageVisitor{
-              [this](ConfigureMessage& m) {
-                bool success = OnConfigure(m);
-                if (!success) {
-                  // Configuration failed - error already signaled by subclass
-                }
-              },
-              [this](DecodeMessage& m) { OnDecode(m); },
-              [this](EncodeMessage& m) { OnEncode(m); },
-              [this](FlushMessage& m) { OnFlush(m); },
-              [this](ResetMessage&) { OnReset(); },
-              [this](CloseMessage&) {
-                OnClose();
-                // Signal to exit after close
-                should_exit_.store(true, std::memory_order_release);
-              },
-          },
-          msg);
+      Dispatch(*msg_opt);
+    }
+  }
+
+  /**
+   * Queue a pool slice unless one is already queued or running.
+   * Called from the queue's ready callback and at the end of a slice.
+   */
+  void ScheduleSlice() {
+    if (scheduled_.exchange(true, std::memory_order_acq_rel)) {
+      return;  // The pending slice will see the new message
+    }
+    if (!CodecScheduler::Instance().Schedule(this)) {
+      // Pool is shutting down; nothing will run the slice.
+      Cancel();
+    }
+  }
+
+  /**
+   * Pool slice: process up to kSliceBudget messages in FIFO order, then
+   * requeue if more are waiting.
+   */
+  void Run() override {
+    {
+      std::lock_guard<std::mutex> lock(slice_mutex_);
+      ++slices_in_run_;
+    }
+
+    for (int i = 0; i < kSliceBudget && !ShouldExit(); ++i) {
+      auto msg_opt = queue_->TryDequeue();
+      if (!msg_opt) {
+        break;
+      }
+      Dispatch(*msg_opt);
+    }
+
+    // Clear the flag before re-checking the queue so a concurrent Enqueue
+    // either sees it cleared (and schedules) or is seen here.
+    scheduled_.store(false, std::memory_order_release);
+    if (!ShouldExit() && !queue_->empty()) {
+      ScheduleSlice();
+    }
+
+    std::lock_guard<std::mutex> lock(slice_mutex_);
+    --slices_in_run_;
+    slice_cv_.notify_all();
+  }
+
+  void Cancel() override {
+    scheduled_.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(slice_mutex_);
+    slice_cv_.notify_all();
+  }
+
+  /**
+   * Dispatch one message to its handler.
+   */
+  void Dispatch(Message& msg) {
+    std::visit(
+        MessageVisitor{
+            [this](ConfigureMessage& m) {
+              bool success = OnConfigure(m);
+              if (!success) {
+                // Configuration failed - error already signaled by subclass
+              }
+            },
+            [this](DecodeMessage& m) {
+              RecordQueueWait(m.enqueued_at);
+              StageTimer timer(stats(), CodecStats::Stage::kCodec, "decode");
+              OnDecode(m);
+            },
+            [this](EncodeMessage& m) {
+              RecordQueueWait(m.enqueued_at);
+              StageTimer timer(stats(), CodecStats::Stage::kCodec, "encode");
+              OnEncode(m);
+            },
+            [this](FlushMessage& m) {
+              // Traced, but kept out of the per-frame codec histogram
+              auto start = CodecStats::Clock::now();
+              OnFlush(m);
+              if (stats_ && TraceRecorder::Instance().enabled()) {
+                TraceRecorder::Instance().Complete(stats_->category(), "flush",
+                                                   start,
+                                                   CodecStats::Clock::now());
+              }
+            },
+            [this](ResetMessage&) { OnReset(); },
+            [this](CloseMessage&) {
+              OnClose();
+              // Signal to exit after close
+              should_exit_.store(true, std::memory_order_release);
+            },
+        },
+        msg);
+  }
+
+  void RecordQueueWait(CodecStats::Clock::time_point enqueued_at) {
+    if (stats_ && enqueued_at != CodecStats::Clock::time_point{}) {
+      stats_->Record(CodecStats::Stage::kQueueWait, enqueued_at,
+                     CodecStats::Clock::now());
     }
   }
 
@@ -416,11 +559,23 @@ class CodecWorker {
   std::atomic<bool> running_;
   std::atomic<bool> should_exit_;
 
+  // Placement of the dedicated thread
+  ThreadPlacement placement_;
+
+  // Pooled mode (CodecScheduler): at most one slice queued or running
+  bool pooled_ = false;
+  std::atomic<bool> scheduled_{false};
+  std::mutex slice_mutex_;
+  std::condition_variable slice_cv_;
+  int slices_in_run_ = 0;
+
   // Callbacks to parent codec
   OutputFrameCallback output_frame_callback_;
   OutputErrorCallback output_error_callback_;
   FlushCompleteCallback flush_complete_callback_;
   DequeueCallback dequeue_callback_;
+
+  std::shared_ptr<CodecStats> stats_;
 };
 
 // =============================================================================
@@ -430,21 +585,21 @@ class CodecWorker {
 /**
  * Base class for video decoder workers.
  */
-using VideoDecoderWorkerBase = CodecWorker<VideoControlQueue>;
+using VideoDecoderWorkerBase = CodecWorker<VideoWorkerQueue>;
 
 /**
  * Base class for audio decoder workers.
  */
-using AudioDecoderWorkerBase = CodecWorker<AudioControlQueue>;
+using AudioDecoderWorkerBase = CodecWorker<AudioWorkerQueue>;
 
 /**
  * Base class for video encoder workers.
  */
-using VideoEncoderWorkerBase = CodecWorker<VideoControlQueue>;
+using VideoEncoderWorkerBase = CodecWorker<VideoWorkerQueue>;
 
 /**
  * Base class for audio encoder workers.
  */
-using AudioEncoderWorkerBase = CodecWorker<AudioControlQueue>;
+using AudioEncoderWorkerBase = CodecWorker<AudioWorkerQueue>;
 
 }  // namespace webcodecs
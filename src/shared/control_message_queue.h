@@ -26,26 +26,31 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <iterator>
 #include <mutex>
 #include <optional>
-#include <queue>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "../ffmpeg_raii.h"
+#include "memory_accountant.h"
 
 namespace webcodecs {
 
 /**
- * Thread-safe control message queue per WebCodecs spec.
+ * The part of a control queue that a CodecWorker uses, with the message
+ * types every queue shares. ControlMessageQueue and SpscControlMessageQueue
+ * implement it, so a worker runs over either; whoever owns the queue picks
+ * the type.
  *
  * @tparam PacketType Type for encoded data (e.g., ffmpeg::AVPacketPtr)
  * @tparam FrameType Type for decoded data (e.g., ffmpeg::AVFramePtr)
  */
 template <typename PacketType, typename FrameType>
-class ControlMessageQueue {
+class WorkerMessageQueue {
  public:
   // ===========================================================================
   // MESSAGE TYPES
@@ -65,6 +70,8 @@ class ControlMessageQueue {
    */
   struct DecodeMessage {
     PacketType packet;
+    // Set by Enqueue(); the worker measures queue wait from it.
+    std::chrono::steady_clock::time_point enqueued_at{};
   };
 
   /**
@@ -74,6 +81,8 @@ class ControlMessageQueue {
   struct EncodeMessage {
     FrameType frame;
     bool key_frame = false;
+    // Set by Enqueue(); the worker measures queue wait from it.
+    std::chrono::steady_clock::time_point enqueued_at{};
   };
 
   /**
@@ -97,13 +106,50 @@ class ControlMessageQueue {
   using Message = std::variant<ConfigureMessage, DecodeMessage, EncodeMessage,
                                FlushMessage, ResetMessage, CloseMessage>;
 
+  virtual ~WorkerMessageQueue() = default;
+
+  [[nodiscard]] virtual bool Enqueue(Message msg) = 0;
+  [[nodiscard]] virtual std::optional<Message> DequeueFor(
+      std::chrono::milliseconds timeout) = 0;
+  [[nodiscard]] virtual std::optional<Message> TryDequeue() = 0;
+  virtual void SetReadyCallback(std::function<void()> cb) = 0;
+  virtual void Shutdown() = 0;
+  // Drop every pending message (reset), from the worker thread.
+  virtual void DiscardPending() = 0;
+  [[nodiscard]] virtual size_t size() const = 0;
+  [[nodiscard]] virtual bool empty() const = 0;
+};
+
+/**
+ * Thread-safe control message queue per WebCodecs spec.
+ *
+ * @tparam PacketType Type for encoded data (e.g., ffmpeg::AVPacketPtr)
+ * @tparam FrameType Type for decoded data (e.g., ffmpeg::AVFramePtr)
+ */
+template <typename PacketType, typename FrameType>
+class ControlMessageQueue final
+    : public WorkerMessageQueue<PacketType, FrameType> {
+  using Base = WorkerMessageQueue<PacketType, FrameType>;
+
+ public:
+  using ConfigureMessage = typename Base::ConfigureMessage;
+  using DecodeMessage = typename Base::DecodeMessage;
+  using EncodeMessage = typename Base::EncodeMessage;
+  using FlushMessage = typename Base::FlushMessage;
+  using ResetMessage = typename Base::ResetMessage;
+  using CloseMessage = typename Base::CloseMessage;
+  using Message = typename Base::Message;
+
   // ===========================================================================
   // CONSTRUCTORS / DESTRUCTOR
   // ===========================================================================
 
   ControlMessageQueue() = default;
 
-  ~ControlMessageQueue() { Shutdown(); }
+  ~ControlMessageQueue() override {
+    Shutdown();
+    SubBytesLocked(bytes_);  // Messages still queued go with the queue
+  }
 
   // Non-copyable, non-movable (owns synchronization primitives)
   ControlMessageQueue(const ControlMessageQueue&) = delete;
@@ -122,16 +168,62 @@ class ControlMessageQueue {
    * @param msg The message to enqueue
    * @return true if message was enqueued, false if queue is closed
    */
-  [[nodiscard]] bool Enqueue(Message msg) {
+  [[nodiscard]] bool Enqueue(Message msg) override {
+    StampEnqueued(&msg);
     std::lock_guard<std::mutex> lock(mutex_);
     if (closed_) {
       return false;
     }
-    queue_.push(std::move(msg));
+    AddBytesLocked(PayloadBytes(msg));
+    queue_.push_back(std::move(msg));
+    cv_.notify_one();
+    if (ready_callback_) {
+      ready_callback_();
+    }
+    return true;
+  }
+
+  /**
+   * Enqueue |msgs| in order under one lock, waking the consumer once.
+   * Used by the batch submit methods (encodeBatch()/decodeBatch()).
+   *
+   * @param msgs The messages to enqueue
+   * @return true if they were enqueued, false (with none enqueued) if the
+   *         queue is closed
+   */
+  [[nodiscard]] bool EnqueueAll(std::vector<Message> msgs) {
+    if (msgs.empty()) {
+      return true;
+    }
+    for (Message& msg : msgs) {
+      StampEnqueued(&msg);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+      return false;
+    }
+    for (Message& msg : msgs) {
+      AddBytesLocked(PayloadBytes(msg));
+      queue_.push_back(std::move(msg));
+    }
     cv_.notify_one();
+    if (ready_callback_) {
+      ready_callback_();
+    }
     return true;
   }
 
+  /**
+   * Install a callback run after every successful Enqueue().
+   * Used by pooled CodecWorkers to get scheduled instead of blocking in
+   * Dequeue(). Runs under the queue mutex, so it must not call back into
+   * the queue; clearing it also waits out any call in progress.
+   */
+  void SetReadyCallback(std::function<void()> cb) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_callback_ = std::move(cb);
+  }
+
   // ===========================================================================
   // CONSUMER API (Worker Thread)
   // ===========================================================================
@@ -151,9 +243,7 @@ class ControlMessageQueue {
       return std::nullopt;
     }
 
-    Message msg = std::move(queue_.front());
-    queue_.pop();
-    return msg;
+    return PopLocked();
   }
 
   /**
@@ -164,7 +254,7 @@ class ControlMessageQueue {
    * @return The next message, or std::nullopt on timeout or if closed
    */
   [[nodiscard]] std::optional<Message> DequeueFor(
-      std::chrono::milliseconds timeout) {
+      std::chrono::milliseconds timeout) override {
     std::unique_lock<std::mutex> lock(mutex_);
     if (!cv_.wait_for(lock, timeout,
                       [this] { return !queue_.empty() || closed_; })) {
@@ -175,9 +265,7 @@ class ControlMessageQueue {
       return std::nullopt;
     }
 
-    Message msg = std::move(queue_.front());
-    queue_.pop();
-    return msg;
+    return PopLocked();
   }
 
   /**
@@ -185,22 +273,21 @@ class ControlMessageQueue {
    *
    * @return The next message, or std::nullopt if queue is empty
    */
-  [[nodiscard]] std::optional<Message> TryDequeue() {
+  [[nodiscard]] std::optional<Message> TryDequeue() override {
     std::lock_guard<std::mutex> lock(mutex_);
     if (queue_.empty()) {
       return std::nullopt;
     }
 
-    Message msg = std::move(queue_.front());
-    queue_.pop();
-    return msg;
+    return PopLocked();
   }
 
   /**
    * Peek at the front message without removing it.
    * Required for W3C spec 2.2 "not processed" semantics.
    *
-   * @return Pointer to front message, or nullptr if queue is empty
+   * @return Pointer to front message, or nullptr if queue is empty. Valid
+   *         until the queue is next modified.
    */
   [[nodiscard]] const Message* Peek() const {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -218,7 +305,7 @@ class ControlMessageQueue {
   void PopFront() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (!queue_.empty()) {
-      queue_.pop();
+      PopLocked();
     }
   }
 
@@ -241,8 +328,9 @@ class ControlMessageQueue {
       if (auto* decode = std::get_if<DecodeMessage>(&msg)) {
         dropped.push_back(std::move(decode->packet));
       }
-      queue_.pop();
+      queue_.pop_front();
     }
+    SubBytesLocked(bytes_);
 
     return dropped;
   }
@@ -262,18 +350,127 @@ class ControlMessageQueue {
       if (auto* encode = std::get_if<EncodeMessage>(&msg)) {
         dropped.push_back(std::move(encode->frame));
       }
-      queue_.pop();
+      queue_.pop_front();
     }
+    SubBytesLocked(bytes_);
 
     return dropped;
   }
 
+  void DiscardPending() override { (void)Clear(); }
+
+  // ===========================================================================
+  // REAL-TIME DROPPING (JS Thread)
+  // ===========================================================================
+
+  /**
+   * Drop the oldest queued frame that is not a forced keyframe, for an
+   * encoder running the 'drop-oldest-delta' queue policy. When every queued
+   * frame is a forced keyframe the oldest one goes and its keyframe request
+   * moves to the next queued frame; if there is none, |orphaned_key| is set
+   * so the caller can carry the request onto the frame it is submitting.
+   *
+   * @return The dropped frame, or nullptr if no encode message is queued
+   */
+  FrameType DropOldestFrame(bool* orphaned_key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *orphaned_key = false;
+    auto victim = queue_.end();
+    for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+      auto* encode = std::get_if<EncodeMessage>(&*it);
+      if (!encode) {
+        continue;
+      }
+      if (victim == queue_.end()) {
+        victim = it;  // Fallback: the oldest frame, key or not
+      }
+      if (!encode->key_frame) {
+        victim = it;
+        break;
+      }
+    }
+    if (victim == queue_.end()) {
+      return FrameType();
+    }
+
+    auto& encode = std::get<EncodeMessage>(*victim);
+    if (encode.key_frame) {
+      *orphaned_key = true;
+      for (auto it = std::next(victim); it != queue_.end(); ++it) {
+        if (auto* next = std::get_if<EncodeMessage>(&*it)) {
+          next->key_frame = true;
+          *orphaned_key = false;
+          break;
+        }
+      }
+    }
+    SubBytesLocked(PayloadBytes(*victim));
+    FrameType frame = std::move(encode.frame);
+    queue_.erase(victim);
+    return frame;
+  }
+
+  /**
+   * Drop queued packets for a decoder running the 'drop-oldest-delta' queue
+   * policy: the oldest delta packet and every packet after it up to the next
+   * key packet, since none of them can be decoded correctly without it. A
+   * run never crosses a non-decode message. With no delta packet queued
+   * (intra-only streams) the oldest packet is dropped on its own.
+   *
+   * @param run_open Set when the run reached the end of the queue, so
+   *        incoming delta packets must also be dropped until a key arrives
+   * @return The dropped packets, oldest first
+   */
+  std::vector<PacketType> DropOldestDeltaRun(bool* run_open) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *run_open = false;
+    std::vector<PacketType> dropped;
+
+    auto first = queue_.end();
+    auto oldest = queue_.end();
+    for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+      auto* decode = std::get_if<DecodeMessage>(&*it);
+      if (!decode) {
+        continue;
+      }
+      if (oldest == queue_.end()) {
+        oldest = it;
+      }
+      if (!IsKeyPacket(decode->packet)) {
+        first = it;
+        break;
+      }
+    }
+    if (first == queue_.end()) {
+      if (oldest != queue_.end()) {
+        SubBytesLocked(PayloadBytes(*oldest));
+        dropped.push_back(std::move(std::get<DecodeMessage>(*oldest).packet));
+        queue_.erase(oldest);
+      }
+      return dropped;
+    }
+
+    auto last = first;
+    while (last != queue_.end()) {
+      auto* decode = std::get_if<DecodeMessage>(&*last);
+      if (!decode || (last != first && IsKeyPacket(decode->packet))) {
+        break;
+      }
+      SubBytesLocked(PayloadBytes(*last));
+      dropped.push_back(std::move(decode->packet));
+      ++last;
+    }
+    *run_open = (last == queue_.end());
+    queue_.erase(first, last);
+    return dropped;
+  }
+
   /**
    * Shutdown the queue permanently.
    * Any subsequent Enqueue() calls will return false.
    * Any blocked Dequeue() calls will return std::nullopt.
    */
-  void Shutdown() {
+  void Shutdown() override {
     {
       std::lock_guard<std::mutex> lock(mutex_);
       closed_ = true;
@@ -289,15 +486,56 @@ class ControlMessageQueue {
    * Get the current queue size (for decodeQueueSize/encodeQueueSize attribute).
    * Thread-safe.
    */
-  [[nodiscard]] size_t size() const {
+  [[nodiscard]] size_t size() const override {
     std::lock_guard<std::mutex> lock(mutex_);
     return queue_.size();
   }
 
+  /**
+   * Payload bytes held by queued decode/encode messages (packet data and
+   * frame buffers). Used to enforce maxQueueBytes. Thread-safe.
+   */
+  [[nodiscard]] size_t bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+  }
+
+  /**
+   * Record the enqueue time of decode/encode messages.
+   */
+  static void StampEnqueued(Message* msg) {
+    if (auto* decode = std::get_if<DecodeMessage>(msg)) {
+      decode->enqueued_at = std::chrono::steady_clock::now();
+    } else if (auto* encode = std::get_if<EncodeMessage>(msg)) {
+      encode->enqueued_at = std::chrono::steady_clock::now();
+    }
+  }
+
+  /**
+   * Payload bytes |msg| adds to bytes() once enqueued.
+   */
+  static size_t PayloadBytes(const Message& msg) {
+    if (auto* decode = std::get_if<DecodeMessage>(&msg)) {
+      return decode->packet ? static_cast<size_t>(decode->packet->size) : 0;
+    }
+    if (auto* encode = std::get_if<EncodeMessage>(&msg)) {
+      size_t total = 0;
+      if (encode->frame) {
+        for (AVBufferRef* buf : encode->frame->buf) {
+          if (buf) {
+            total += buf->size;
+          }
+        }
+      }
+      return total;
+    }
+    return 0;
+  }
+
   /**
    * Check if the queue is empty.
    */
-  [[nodiscard]] bool empty() const {
+  [[nodiscard]] bool empty() const override {
     std::lock_guard<std::mutex> lock(mutex_);
     return queue_.empty();
   }
@@ -325,11 +563,39 @@ class ControlMessageQueue {
   }
 
  private:
+  // Caller holds mutex_ and has checked the queue is not empty.
+  Message PopLocked() {
+    Message msg = std::move(queue_.front());
+    queue_.pop_front();
+    SubBytesLocked(PayloadBytes(msg));
+    return msg;
+  }
+
+  // Caller holds mutex_. bytes_ is mirrored into the process-wide
+  // MemoryAccountant so queued payloads count toward the soft limit.
+  void AddBytesLocked(size_t bytes) {
+    bytes_ += bytes;
+    MemoryAccountant::Instance().Add(MemoryCategory::kCodecQueues,
+                                     static_cast<int64_t>(bytes));
+  }
+
+  void SubBytesLocked(size_t bytes) {
+    bytes_ -= bytes;
+    MemoryAccountant::Instance().Add(MemoryCategory::kCodecQueues,
+                                     -static_cast<int64_t>(bytes));
+  }
+
+  static bool IsKeyPacket(const PacketType& packet) {
+    return packet && (packet->flags & AV_PKT_FLAG_KEY);
+  }
+
   mutable std::mutex mutex_;
   std::condition_variable cv_;
-  std::queue<Message> queue_;
+  std::deque<Message> queue_;
+  size_t bytes_ = 0;
   std::atomic<bool> blocked_{false};
   bool closed_{false};
+  std::function<void()> ready_callback_;
 };
 
 // =============================================================================
@@ -352,6 +618,40 @@ using VideoControlQueue =
 using AudioControlQueue =
     ControlMessageQueue<ffmpeg::AVPacketPtr, ffmpeg::AVFramePtr>;
 
+/**
+ * What a video or audio CodecWorker sees of its queue: a VideoControlQueue
+ * or AudioControlQueue, or their SpscControlMessageQueue counterparts.
+ */
+using VideoWorkerQueue =
+    WorkerMessageQueue<ffmpeg::AVPacketPtr, ffmpeg::AVFramePtr>;
+using AudioWorkerQueue =
+    WorkerMessageQueue<ffmpeg::AVPacketPtr, ffmpeg::AVFramePtr>;
+
+/**
+ * Messages built by one batch submit call (encodeBatch()/decodeBatch()) and
+ * held back to be enqueued together with EnqueueAll(). Queue limits count
+ * them as if they were already queued.
+ */
+template <typename Queue>
+struct StagedMessages {
+  std::vector<typename Queue::Message> messages;
+  size_t bytes = 0;  // Queue::PayloadBytes() of messages
+
+  void Add(typename Queue::Message msg) {
+    bytes += Queue::PayloadBytes(msg);
+    messages.push_back(std::move(msg));
+  }
+
+  // Hand the messages to EnqueueAll(), leaving this empty.
+  std::vector<typename Queue::Message> Take() {
+    bytes = 0;
+    return std::exchange(messages, {});
+  }
+
+  [[nodiscard]] size_t size() const { return messages.size(); }
+  [[nodiscard]] bool empty() const { return messages.empty(); }
+};
+
 // =============================================================================
 // VISITOR HELPER
 // =============================================================================
@@ -0,0 +1,74 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * dequeue_notifier.h - Wake-ups for 'block' Queue Policy Retries
+ *
+ * When the 'block' queue policy turns a request away, the JS layer parks it
+ * until the queue has room. The codec asks for one wake-up with Request();
+ * the next time its worker takes a message off the queue, Notify() posts
+ * the JS `dequeue` callback so the parked requests are retried. Nothing is
+ * posted while no request is parked, and at most one wake-up is pending.
+ *
+ * A decoder can free queue space without producing output (codec delay,
+ * skipOutput, corrupt packets), so output callbacks alone do not suffice.
+ *
+ * Thread Safety:
+ * - Init(), Request() and Release() run on the JS thread.
+ * - Notify() runs on the worker thread.
+ */
+
+#include <napi.h>
+
+#include <atomic>
+#include <cstddef>
+
+#include "src/shared/safe_tsfn.h"
+
+namespace webcodecs {
+
+class DequeueNotifier {
+ public:
+  /**
+   * Post wake-ups to |callback|, called without arguments. Replaces an
+   * earlier Init(); does nothing when |callback| is empty.
+   */
+  void Init(Napi::Env env, const Napi::FunctionReference& callback,
+            const char* name) {
+    tsfn_.Release();
+    if (callback.IsEmpty()) {
+      return;
+    }
+    tsfn_.Init(TSFN::TSFN::New(env, callback.Value(), name, 0, 1));
+  }
+
+  void Release() { tsfn_.Release(); }
+
+  /**
+   * Ask for a wake-up at the next dequeue. Callers check the queue again
+   * afterwards, in case the worker made room before seeing the request.
+   */
+  void Request() { wanted_.store(true); }
+
+  void Notify() {
+    if (wanted_.exchange(false)) {
+      (void)tsfn_.Call(nullptr);
+    }
+  }
+
+ private:
+  static void CallJs(Napi::Env env, Napi::Function fn, std::nullptr_t*,
+                     std::nullptr_t*) {
+    if (env != nullptr && !fn.IsEmpty()) {
+      fn.Call({});
+    }
+  }
+
+  using TSFN = SafeThreadSafeFunction<std::nullptr_t, std::nullptr_t, CallJs>;
+
+  std::atomic<bool> wanted_{false};
+  TSFN tsfn_;
+};
+
+}  // namespace webcodecs
@@ -0,0 +1,115 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * frame_info_ring.h - Per-Frame Metadata Ring for Encoder Reordering
+ *
+ * Maps the sequential frame index an encoder is fed as pts back to the
+ * caller's timestamp/duration when the packet comes out. Only frames still
+ * inside the codec need an entry, and the codec holds a bounded number of
+ * them (B-frames + lookahead + frame threads), so a power-of-two ring
+ * indexed by frame_index replaces a std::map: no allocation per frame and
+ * no growth when the encoder drops a frame without emitting a packet.
+ *
+ * Each slot remembers the index it was written for. A newer index landing
+ * on an occupied slot evicts the older entry, which by then is at least
+ * capacity() frames old and can no longer be in flight.
+ *
+ * Usage:
+ *   FrameInfoRing ring;
+ *   ring.Reset(ring_capacity);              // After opening the codec
+ *   ring.Put(frame_index, timestamp, duration);  // Per input frame
+ *   ring.Take(pkt->pts, &timestamp, &duration);  // Per output packet
+ *
+ * Not thread-safe; owned by the codec worker thread.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace webcodecs {
+
+class FrameInfoRing {
+ public:
+  // Floor on the capacity so encoders that report no delay still cover
+  // every frame the codec may hold.
+  static constexpr size_t kMinCapacity = 64;
+
+  FrameInfoRing() { Reset(kMinCapacity); }
+
+  /**
+   * Drop every entry and size the ring for |depth| frames in flight,
+   * rounded up to a power of two (at least kMinCapacity).
+   */
+  void Reset(size_t depth) {
+    size_t capacity = kMinCapacity;
+    while (capacity < depth) {
+      capacity <<= 1;
+    }
+    if (slots_.size() != capacity) {
+      slots_.assign(capacity, Slot{});
+    } else {
+      Clear();
+    }
+    mask_ = capacity - 1;
+  }
+
+  /**
+   * Drop every entry, keeping the capacity.
+   */
+  void Clear() {
+    for (Slot& slot : slots_) {
+      slot.frame_index = kEmpty;
+    }
+  }
+
+  /**
+   * Record the timestamp/duration of |frame_index| (must be >= 0).
+   * Returns true if this evicted a stale entry.
+   */
+  bool Put(int64_t frame_index, int64_t timestamp, int64_t duration) {
+    Slot& slot = slots_[static_cast<size_t>(frame_index) & mask_];
+    bool evicted =
+        slot.frame_index != kEmpty && slot.frame_index != frame_index;
+    slot.frame_index = frame_index;
+    slot.timestamp = timestamp;
+    slot.duration = duration;
+    return evicted;
+  }
+
+  /**
+   * Remove and return the entry for |frame_index|. Returns false (leaving
+   * the outputs untouched) if there is none or it was evicted.
+   */
+  bool Take(int64_t frame_index, int64_t* timestamp, int64_t* duration) {
+    if (frame_index < 0) {
+      return false;
+    }
+    Slot& slot = slots_[static_cast<size_t>(frame_index) & mask_];
+    if (slot.frame_index != frame_index) {
+      return false;
+    }
+    *timestamp = slot.timestamp;
+    *duration = slot.duration;
+    slot.frame_index = kEmpty;
+    return true;
+  }
+
+  size_t capacity() const { return slots_.size(); }
+
+ private:
+  static constexpr int64_t kEmpty = -1;
+
+  struct Slot {
+    int64_t frame_index = kEmpty;
+    int64_t timestamp = 0;
+    int64_t duration = 0;
+  };
+
+  std::vector<Slot> slots_;
+  size_t mask_ = 0;
+};
+
+}  // namespace webcodecs
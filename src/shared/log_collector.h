@@ -0,0 +1,220 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * log_collector.h - Contention-Free Capture of FFmpeg Log Lines
+ *
+ * FFmpeg calls its log callback from whichever thread logs: codec workers
+ * and the codecs' own slice and frame threads. A damaged HEVC stream can
+ * produce thousands of lines a second, and a single mutex-guarded queue
+ * made every one of those threads queue up behind each other.
+ *
+ * Each logging thread instead writes into its own fixed-size ring, which
+ * only that thread produces into and only Drain() consumes from, so the
+ * hot path takes no lock and touches no shared cache line. The registry
+ * mutex is taken once per thread (first line it logs) and by Drain().
+ *
+ * Lines are aggregated before they reach a ring:
+ * - A line identical to the thread's previous one only bumps a counter,
+ *   reported as "Last message repeated N times" (as FFmpeg's own logger
+ *   does).
+ * - At most kMaxLinesPerSecond lines per thread are kept, and a full ring
+ *   keeps nothing; the rest are counted and reported as suppressed.
+ *   Suppressed lines are never formatted.
+ *
+ * Lines keep their order within a thread; Drain() returns threads one
+ * after another.
+ *
+ * Thread Safety:
+ * - Add() may be called from any thread.
+ * - Drain() and Clear() may be called from any thread, typically the JS
+ *   thread.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace webcodecs {
+
+class LogCollector {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Lines each thread buffers between drains.
+  static constexpr uint32_t kRingCapacity = 64;
+  // Longest line kept, including the terminator; longer lines are cut.
+  static constexpr size_t kMaxLineLength = 256;
+  // Lines each thread may add per second before the rest are suppressed.
+  static constexpr uint32_t kMaxLinesPerSecond = 100;
+
+  /**
+   * Get the process-wide collector fed by the FFmpeg log callback.
+   * Intentionally leaked so late log lines never reach a destroyed object.
+   */
+  static LogCollector& Instance() {
+    static auto* collector = new LogCollector();
+    return *collector;
+  }
+
+  LogCollector() : id_(NextId()) {}
+
+  LogCollector(const LogCollector&) = delete;
+  LogCollector& operator=(const LogCollector&) = delete;
+
+  /**
+   * Add a line to the calling thread's ring. |format| is called as
+   * format(char* buffer, size_t size) to write the NUL-terminated line,
+   * only once the line is known to be kept. Empty lines are ignored.
+   */
+  template <typename Format>
+  void Add(Format&& format, Clock::time_point now = Clock::now()) {
+    ThreadRing* ring = RingForThisThread();
+    if (now - ring->window_start >= std::chrono::seconds(1)) {
+      ring->window_start = now;
+      ring->window_lines = 0;
+    }
+    if (ring->window_lines >= kMaxLinesPerSecond || ring->Full()) {
+      ring->suppressed.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    char* line = ring->NextSlot();
+    std::forward<Format>(format)(line, kMaxLineLength);
+    line[kMaxLineLength - 1] = '\0';
+    if (line[0] == '\0') {
+      return;
+    }
+    if (std::strcmp(line, ring->last) == 0) {
+      ring->repeats.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    std::memcpy(ring->last, line, kMaxLineLength);
+    ring->window_lines++;
+
+    uint32_t repeats = ring->repeats.exchange(0, std::memory_order_relaxed);
+    if (repeats > 0) {
+      // Report the earlier run before the new line. The slot we formatted
+      // into moves one along.
+      std::string notice = RepeatNotice(repeats);
+      std::memcpy(ring->NextSlot(), notice.c_str(), notice.size() + 1);
+      ring->Publish();
+      if (ring->Full()) {
+        ring->suppressed.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      std::memcpy(ring->NextSlot(), ring->last, kMaxLineLength);
+    }
+    ring->Publish();
+  }
+
+  /**
+   * Remove and return every buffered line, followed per thread by pending
+   * repeat and suppression notices.
+   */
+  std::vector<std::string> Drain() {
+    std::vector<std::string> lines;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = rings_.begin(); it != rings_.end();) {
+      ThreadRing& ring = **it;
+      uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+      uint32_t head = ring.head.load(std::memory_order_acquire);
+      for (; tail != head; tail++) {
+        lines.emplace_back(ring.slots[tail % kRingCapacity]);
+      }
+      ring.tail.store(tail, std::memory_order_release);
+
+      uint32_t repeats = ring.repeats.exchange(0, std::memory_order_relaxed);
+      if (repeats > 0) {
+        lines.push_back(RepeatNotice(repeats));
+      }
+      uint32_t suppressed =
+          ring.suppressed.exchange(0, std::memory_order_relaxed);
+      if (suppressed > 0) {
+        lines.push_back(std::to_string(suppressed) +
+                        " log messages suppressed");
+      }
+
+      // Only the registry still holds rings of threads that have exited.
+      if (it->use_count() == 1) {
+        it = rings_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return lines;
+  }
+
+  /**
+   * Discard every buffered line.
+   */
+  void Clear() { Drain(); }
+
+ private:
+  // Written only by its thread (head, window, last) and read and advanced
+  // only by Drain() (tail).
+  struct ThreadRing {
+    char slots[kRingCapacity][kMaxLineLength];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint32_t> repeats{0};
+    std::atomic<uint32_t> suppressed{0};
+    Clock::time_point window_start{};
+    uint32_t window_lines = 0;
+    char last[kMaxLineLength] = {};
+
+    bool Full() const {
+      return head.load(std::memory_order_relaxed) -
+                 tail.load(std::memory_order_acquire) >=
+             kRingCapacity;
+    }
+    char* NextSlot() {
+      return slots[head.load(std::memory_order_relaxed) % kRingCapacity];
+    }
+    void Publish() {
+      head.store(head.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+    }
+  };
+
+  // The calling thread's ring for the collector it last logged to. Owned
+  // jointly with rings_, so a thread that exits leaves its lines behind
+  // until the next Drain().
+  struct ThreadSlot {
+    uint64_t collector_id = 0;
+    std::shared_ptr<ThreadRing> ring;
+  };
+
+  static uint64_t NextId() {
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static std::string RepeatNotice(uint32_t repeats) {
+    return "Last message repeated " + std::to_string(repeats) + " times";
+  }
+
+  ThreadRing* RingForThisThread() {
+    static thread_local ThreadSlot slot;
+    if (slot.collector_id != id_) {
+      slot.ring = std::make_shared<ThreadRing>();
+      slot.collector_id = id_;
+      std::lock_guard<std::mutex> lock(mutex_);
+      rings_.push_back(slot.ring);
+    }
+    return slot.ring.get();
+  }
+
+  const uint64_t id_;
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<ThreadRing>> rings_;
+};
+
+}  // namespace webcodecs
@@ -0,0 +1,151 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * memory_accountant.h - Process-Wide Native Memory Accounting
+ *
+ * Bytes held natively by the addon, by category:
+ *
+ *   videoFrames    VideoFrame planes (owned copies or referenced AVFrames)
+ *   audioData      AudioData samples
+ *   encodedChunks  EncodedVideoChunk/EncodedAudioChunk packets
+ *   framePool      Buffers owned by FramePool (in use or idle)
+ *   codecQueues    Frames and packets waiting in codec control queues
+ *
+ * Categories count references, not distinct allocations: a pooled buffer
+ * held by an open VideoFrame is in both framePool and videoFrames, and a
+ * frame queued for encoding is in codecQueues until its VideoFrame is
+ * closed too. Total() is therefore an upper bound, which is the safe side
+ * for the soft limit.
+ *
+ * Counters are relaxed atomics updated from any thread, including
+ * finalizers and codec workers. The optional soft limit is only a
+ * threshold: codecs refuse new work with QuotaExceededError while Total()
+ * is above it, and the JS layer reclaims inactive codecs first.
+ *
+ * V8 external memory is reported separately (see ExternalMemory in
+ * common.h) because it may only be adjusted on the JS thread. Objects
+ * finalized without close() release their bytes here immediately and park
+ * the V8 side in a per-thread debt that the next adjustment on that
+ * thread settles.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace webcodecs {
+
+enum class MemoryCategory {
+  kVideoFrames,
+  kAudioData,
+  kEncodedChunks,
+  kFramePool,
+  kCodecQueues,
+};
+
+class MemoryAccountant {
+ public:
+  static constexpr size_t kCategories = 5;
+
+  /**
+   * Get the process-wide accountant. Intentionally leaked so buffers freed
+   * during static destruction can still release their bytes.
+   */
+  static MemoryAccountant& Instance() {
+    static auto* accountant = new MemoryAccountant();
+    return *accountant;
+  }
+
+  MemoryAccountant(const MemoryAccountant&) = delete;
+  MemoryAccountant& operator=(const MemoryAccountant&) = delete;
+
+  /**
+   * Add |delta| bytes (negative to release) to |category|. Thread-safe.
+   */
+  void Add(MemoryCategory category, int64_t delta) {
+    bytes_[Index(category)].fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] int64_t Bytes(MemoryCategory category) const {
+    return bytes_[Index(category)].load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] int64_t Total() const {
+    int64_t total = 0;
+    for (const auto& bytes : bytes_) {
+      total += bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  /**
+   * Set the soft limit in bytes; 0 (the default) disables it.
+   */
+  void SetSoftLimit(int64_t bytes) {
+    soft_limit_.store(bytes > 0 ? bytes : 0, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] int64_t soft_limit() const {
+    return soft_limit_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * True when a soft limit is set and Total() exceeds it. Costs a full
+   * Total() only when a limit is set.
+   */
+  [[nodiscard]] bool OverSoftLimit() const {
+    int64_t limit = soft_limit();
+    return limit > 0 && Total() > limit;
+  }
+
+  /**
+   * V8 external memory still reported for objects finalized on the
+   * calling thread. Only the owning thread may touch it.
+   */
+  static void DeferV8Release(int64_t bytes) { PendingV8Release() += bytes; }
+
+  static int64_t TakeDeferredV8Release() {
+    int64_t& pending = PendingV8Release();
+    int64_t bytes = pending;
+    pending = 0;
+    return bytes;
+  }
+
+  static const char* CategoryName(MemoryCategory category) {
+    switch (category) {
+      case MemoryCategory::kVideoFrames:
+        return "videoFrames";
+      case MemoryCategory::kAudioData:
+        return "audioData";
+      case MemoryCategory::kEncodedChunks:
+        return "encodedChunks";
+      case MemoryCategory::kFramePool:
+        return "framePool";
+      case MemoryCategory::kCodecQueues:
+      default:
+        return "codecQueues";
+    }
+  }
+
+ private:
+  MemoryAccountant() = default;
+
+  static size_t Index(MemoryCategory category) {
+    return static_cast<size_t>(category);
+  }
+
+  // Each JS environment runs on its own thread, so a thread-local debt is
+  // a per-environment one without a lookup.
+  static int64_t& PendingV8Release() {
+    thread_local int64_t pending = 0;
+    return pending;
+  }
+
+  std::array<std::atomic<int64_t>, kCategories> bytes_{};
+  std::atomic<int64_t> soft_limit_{0};
+};
+
+}  // namespace webcodecs
@@ -0,0 +1,56 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * packet_sink.h - Native Destination for Encoded Packets
+ *
+ * An encoder worker with a PacketSink attached hands its AVPackets straight
+ * to the sink on the worker thread instead of wrapping each one in a JS
+ * EncodedVideoChunk/EncodedAudioChunk. Muxer implements this so encoded
+ * output can be written without a round trip through JavaScript.
+ *
+ * Thread Safety:
+ * - WritePacket() and SetStreamExtradata() are called from encoder worker
+ *   threads, possibly several encoders at once, and must be safe against
+ *   the sink's own JS thread.
+ * - An encoder keeps its sink alive until no call into it is in progress.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/ffmpeg_raii.h"
+
+namespace webcodecs {
+
+class PacketSink {
+ public:
+  virtual ~PacketSink() = default;
+
+  /**
+   * Queue |packet| for its stream_index. Timestamps (pts, dts, duration)
+   * are in microseconds. May block while the sink is backed up, until
+   * |cancel| is set and WakeWriters() is called; the packet is then dropped.
+   *
+   * @return false once the sink no longer accepts packets, or on cancel
+   */
+  virtual bool WritePacket(ffmpeg::AVPacketPtr packet,
+                           const std::atomic<bool>& cancel) = 0;
+
+  /**
+   * Wake WritePacket() calls waiting for room so they recheck |cancel|.
+   * Called from the JS thread when an encoder detaches.
+   */
+  virtual void WakeWriters() = 0;
+
+  /**
+   * Codec extradata for |stream_index|, sent before its first packet.
+   * Ignored if the stream already has extradata or writing has begun.
+   */
+  virtual void SetStreamExtradata(int stream_index, const uint8_t* data,
+                                  size_t size) = 0;
+};
+
+}  // namespace webcodecs
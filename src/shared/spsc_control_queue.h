@@ -0,0 +1,472 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * spsc_control_queue.h - Lock-Free Single-Producer Control Message Queue
+ *
+ * Bounded ring variant of ControlMessageQueue for the strict one-producer
+ * (JS thread) / one-consumer (worker) access pattern of the codecs. It
+ * exposes the same message types and WorkerMessageQueue interface, so any
+ * CodecWorker can run over it; Pipeline's internal stage queues use it.
+ *
+ * Differences from ControlMessageQueue:
+ * - Enqueue(), size() and empty() never take a lock. A sleeping consumer
+ *   is woken with a futex (Linux) or a condition variable elsewhere, and
+ *   only when it is actually parked.
+ * - Capacity is fixed; Enqueue() returns false when the ring is full.
+ * - Only one thread may Enqueue() at a time, and only one thread may use
+ *   the consumer API (Dequeue*, TryDequeue, Peek, PopFront) at a time.
+ * - Clear() and ClearFrames() may be called from either side. They drop
+ *   every pending message at once as far as size() and the consumer are
+ *   concerned; the messages themselves are destroyed by the consumer's
+ *   next call (or the destructor), so they return a count, not the
+ *   dropped packets.
+ * - SetReadyCallback() costs Enqueue() a mutex only while a callback is
+ *   installed.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <climits>
+#include <ctime>
+#else
+#include <condition_variable>
+#endif
+
+#include "control_message_queue.h"
+
+namespace webcodecs {
+
+namespace detail {
+
+/**
+ * Event count: lets one thread sleep until another publishes something,
+ * without the publisher paying for a syscall when nobody sleeps.
+ *
+ * Waiter:    key = PrepareWait(); if (ready) CancelWait(); else Wait(key);
+ * Publisher: publish (release store); Notify();
+ */
+class EventCount {
+ public:
+  EventCount() = default;
+  EventCount(const EventCount&) = delete;
+  EventCount& operator=(const EventCount&) = delete;
+
+  uint32_t PrepareWait() {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    return epoch_.load(std::memory_order_acquire);
+  }
+
+  void CancelWait() { waiters_.fetch_sub(1, std::memory_order_seq_cst); }
+
+  /**
+   * Sleep until Notify() is called after PrepareWait() returned |key|, or
+   * until |deadline| (if given) passes.
+   *
+   * @return false on timeout
+   */
+  bool Wait(uint32_t key,
+            const std::chrono::steady_clock::time_point* deadline) {
+    bool notified = true;
+    while (epoch_.load(std::memory_order_acquire) == key) {
+      std::chrono::nanoseconds remaining{-1};
+      if (deadline != nullptr) {
+        remaining = *deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::nanoseconds::zero()) {
+          notified = epoch_.load(std::memory_order_acquire) != key;
+          break;
+        }
+      }
+      Park(key, deadline != nullptr ? &remaining : nullptr);
+    }
+    waiters_.fetch_sub(1, std::memory_order_seq_cst);
+    return notified;
+  }
+
+  void Notify() {
+    // An RMW rather than a load: it orders the caller's publish before the
+    // check against the waiter's increment in PrepareWait(), so either the
+    // waiter sees the publish or this sees the waiter.
+    if (waiters_.fetch_add(0, std::memory_order_seq_cst) == 0) {
+      return;  // Fast path: nobody is parked
+    }
+    epoch_.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_),
+            FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    cv_.notify_all();
+#endif
+  }
+
+ private:
+  void Park(uint32_t key, const std::chrono::nanoseconds* timeout) {
+#if defined(__linux__)
+    struct timespec ts;
+    struct timespec* ts_ptr = nullptr;
+    if (timeout != nullptr) {
+      ts.tv_sec = static_cast<time_t>(timeout->count() / 1000000000);
+      ts.tv_nsec = static_cast<long>(timeout->count() % 1000000000);  // NOLINT
+      ts_ptr = &ts;
+    }
+    // Returns at once if epoch_ no longer equals key; spurious wakeups are
+    // handled by the caller's loop.
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_),
+            FUTEX_WAIT_PRIVATE, key, ts_ptr, nullptr, 0);
+#else
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto changed = [&] {
+      return epoch_.load(std::memory_order_acquire) != key;
+    };
+    if (timeout != nullptr) {
+      cv_.wait_for(lock, *timeout, changed);
+    } else {
+      cv_.wait(lock, changed);
+    }
+#endif
+  }
+
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                "futex word must be a plain 32-bit integer");
+  std::atomic<uint32_t> epoch_{0};
+  std::atomic<uint32_t> waiters_{0};
+#if !defined(__linux__)
+  std::mutex mutex_;
+  std::condition_variable cv_;
+#endif
+};
+
+}  // namespace detail
+
+/**
+ * Lock-free SPSC control message queue.
+ *
+ * @tparam PacketType Type for encoded data (e.g., ffmpeg::AVPacketPtr)
+ * @tparam FrameType Type for decoded data (e.g., ffmpeg::AVFramePtr)
+ */
+template <typename PacketType, typename FrameType>
+class SpscControlMessageQueue final
+    : public WorkerMessageQueue<PacketType, FrameType> {
+  using Locked = ControlMessageQueue<PacketType, FrameType>;
+
+ public:
+  // Same message types as ControlMessageQueue, so workers and visitors
+  // written for one work with the other.
+  using ConfigureMessage = typename Locked::ConfigureMessage;
+  using DecodeMessage = typename Locked::DecodeMessage;
+  using EncodeMessage = typename Locked::EncodeMessage;
+  using FlushMessage = typename Locked::FlushMessage;
+  using ResetMessage = typename Locked::ResetMessage;
+  using CloseMessage = typename Locked::CloseMessage;
+  using Message = typename Locked::Message;
+
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  /**
+   * @param capacity Most pending messages; rounded up to a power of two
+   */
+  explicit SpscControlMessageQueue(size_t capacity = kDefaultCapacity)
+      : capacity_(RoundUpToPowerOfTwo(capacity)),
+        mask_(capacity_ - 1),
+        slots_(std::make_unique<std::optional<Message>[]>(capacity_)) {}
+
+  ~SpscControlMessageQueue() override { Shutdown(); }
+
+  // Non-copyable, non-movable (owns synchronization primitives)
+  SpscControlMessageQueue(const SpscControlMessageQueue&) = delete;
+  SpscControlMessageQueue& operator=(const SpscControlMessageQueue&) = delete;
+  SpscControlMessageQueue(SpscControlMessageQueue&&) = delete;
+  SpscControlMessageQueue& operator=(SpscControlMessageQueue&&) = delete;
+
+  // ===========================================================================
+  // PRODUCER API (JS Thread)
+  // ===========================================================================
+
+  /**
+   * Enqueue a message for processing. Producer thread only.
+   *
+   * @return true if enqueued, false if the queue is closed or full
+   */
+  [[nodiscard]] bool Enqueue(Message msg) override {
+    if (closed_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    Locked::StampEnqueued(&msg);
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ >= capacity_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ >= capacity_) {
+        return false;
+      }
+    }
+    slots_[tail & mask_].emplace(std::move(msg));
+    tail_.store(tail + 1, std::memory_order_release);
+    event_.Notify();
+
+    if (has_ready_callback_.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(callback_mutex_);
+      if (ready_callback_) {
+        ready_callback_();
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Install a callback run after every successful Enqueue(). Same contract
+   * as ControlMessageQueue::SetReadyCallback(): it must not call back into
+   * the queue, and clearing it waits out any call in progress.
+   */
+  void SetReadyCallback(std::function<void()> cb) override {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    ready_callback_ = std::move(cb);
+    has_ready_callback_.store(static_cast<bool>(ready_callback_),
+                              std::memory_order_release);
+  }
+
+  // ===========================================================================
+  // CONSUMER API (Worker Thread)
+  // ===========================================================================
+
+  /**
+   * Dequeue a message, blocking until one is available or the queue is
+   * closed.
+   *
+   * @return The next message, or std::nullopt if queue is closed and empty
+   */
+  [[nodiscard]] std::optional<Message> Dequeue() {
+    return WaitAndDequeue(nullptr);
+  }
+
+  /**
+   * Dequeue with timeout.
+   *
+   * @return The next message, or std::nullopt on timeout or if closed
+   */
+  [[nodiscard]] std::optional<Message> DequeueFor(
+      std::chrono::milliseconds timeout) override {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    return WaitAndDequeue(&deadline);
+  }
+
+  /**
+   * Try to dequeue without blocking.
+   *
+   * @return The next message, or std::nullopt if queue is empty
+   */
+  [[nodiscard]] std::optional<Message> TryDequeue() override {
+    const size_t head = Reclaim();
+    if (!Available(head)) {
+      return std::nullopt;
+    }
+    std::optional<Message>& slot = slots_[head & mask_];
+    std::optional<Message> msg(std::move(*slot));
+    slot.reset();
+    head_.store(head + 1, std::memory_order_release);
+    return msg;
+  }
+
+  /**
+   * Peek at the front message without removing it. The pointer stays
+   * valid until the next consumer call.
+   *
+   * @return Pointer to front message, or nullptr if queue is empty
+   */
+  [[nodiscard]] const Message* Peek() {
+    const size_t head = Reclaim();
+    if (!Available(head)) {
+      return nullptr;
+    }
+    return &*slots_[head & mask_];
+  }
+
+  /**
+   * Remove the front message, after Peek() found it "processed". If a
+   * Clear() landed in between, the peeked message went with it and
+   * nothing more is removed.
+   */
+  void PopFront() {
+    const size_t before = head_.load(std::memory_order_relaxed);
+    const size_t head = Reclaim();
+    if (head != before || !Available(head)) {
+      return;
+    }
+    slots_[head & mask_].reset();
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  // ===========================================================================
+  // RESET / SHUTDOWN
+  // ===========================================================================
+
+  /**
+   * Drop all pending messages (for reset). Either thread.
+   *
+   * @return Number of messages dropped
+   */
+  size_t Clear() {
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    size_t discard = discard_to_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t from = std::max(head, discard);
+    while (discard < tail &&
+           !discard_to_.compare_exchange_weak(discard, tail,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    }
+    // A parked consumer wakes up and frees the slots.
+    event_.Notify();
+    return tail > from ? tail - from : 0;
+  }
+
+  /**
+   * Drop all pending messages (for encoder reset). Either thread.
+   *
+   * @return Number of messages dropped
+   */
+  size_t ClearFrames() { return Clear(); }
+
+  void DiscardPending() override { (void)Clear(); }
+
+  /**
+   * Shutdown the queue permanently.
+   * Any subsequent Enqueue() calls will return false.
+   * A blocked Dequeue() drains what is left, then returns std::nullopt.
+   */
+  void Shutdown() override {
+    closed_.store(true, std::memory_order_release);
+    event_.Notify();
+  }
+
+  // ===========================================================================
+  // QUERY
+  // ===========================================================================
+
+  /**
+   * Current queue size (for decodeQueueSize/encodeQueueSize). Lock-free;
+   * any thread.
+   */
+  [[nodiscard]] size_t size() const override {
+    // tail_ is read last: it only grows and is never behind the others.
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t discard = discard_to_.load(std::memory_order_acquire);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return tail - std::max(head, discard);
+  }
+
+  [[nodiscard]] bool empty() const override { return size() == 0; }
+
+  [[nodiscard]] size_t capacity() const { return capacity_; }
+
+  [[nodiscard]] bool IsClosed() const {
+    return closed_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] bool IsBlocked() const {
+    return blocked_.load(std::memory_order_acquire);
+  }
+
+  void SetBlocked(bool blocked) {
+    blocked_.store(blocked, std::memory_order_release);
+  }
+
+ private:
+  static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t capacity = 2;
+    while (capacity < n) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
+
+  // Consumer: free slots dropped by Clear() and return the front index.
+  size_t Reclaim() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    const size_t discard = discard_to_.load(std::memory_order_acquire);
+    if (head < discard) {
+      for (; head < discard; ++head) {
+        slots_[head & mask_].reset();
+      }
+      head_.store(head, std::memory_order_release);
+    }
+    return head;
+  }
+
+  // Consumer: whether slot |head| has been published.
+  bool Available(size_t head) {
+    if (head < cached_tail_) {
+      return true;
+    }
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    return head < cached_tail_;
+  }
+
+  std::optional<Message> WaitAndDequeue(
+      const std::chrono::steady_clock::time_point* deadline) {
+    for (;;) {
+      if (auto msg = TryDequeue()) {
+        return msg;
+      }
+      if (closed_.load(std::memory_order_acquire)) {
+        return std::nullopt;
+      }
+      const uint32_t key = event_.PrepareWait();
+      if (!empty() || closed_.load(std::memory_order_acquire)) {
+        event_.CancelWait();
+        continue;
+      }
+      if (!event_.Wait(key, deadline)) {
+        return TryDequeue();  // Timed out
+      }
+    }
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<std::optional<Message>[]> slots_;
+
+  // Producer-owned line.
+  alignas(64) std::atomic<size_t> tail_{0};
+  size_t cached_head_ = 0;
+
+  // Consumer-owned line.
+  alignas(64) std::atomic<size_t> head_{0};
+  size_t cached_tail_ = 0;
+
+  // Shared, rarely written.
+  alignas(64) std::atomic<size_t> discard_to_{0};
+  std::atomic<bool> closed_{false};
+  std::atomic<bool> blocked_{false};
+  detail::EventCount event_;
+
+  std::atomic<bool> has_ready_callback_{false};
+  std::mutex callback_mutex_;
+  std::function<void()> ready_callback_;
+};
+
+// =============================================================================
+// TYPE ALIASES
+// =============================================================================
+
+using VideoSpscControlQueue =
+    SpscControlMessageQueue<ffmpeg::AVPacketPtr, ffmpeg::AVFramePtr>;
+using AudioSpscControlQueue =
+    SpscControlMessageQueue<ffmpeg::AVPacketPtr, ffmpeg::AVFramePtr>;
+
+}  // namespace webcodecs
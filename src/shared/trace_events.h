@@ -0,0 +1,193 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#pragma once
+/**
+ * trace_events.h - Chrome Trace Event Recorder
+ *
+ * Process-wide, opt-in recorder for codec pipeline stages. Between Start()
+ * and Stop() every codec records its stages (see codec_stats.h); Stop()
+ * returns them as Chrome trace-event JSON, which chrome://tracing and
+ * https://ui.perfetto.dev load directly.
+ *
+ * - Work on one thread (encode/decode, conversion) is a complete ("X")
+ *   event on that thread's track.
+ * - Spans that start on one thread and end on another (queue wait, output
+ *   delivery) are async ("b"/"e") events, which may overlap.
+ *
+ * When not recording, enabled() is a single relaxed load and nothing else
+ * runs. While recording, events are appended under a mutex up to a fixed
+ * budget; later events are counted as dropped rather than growing the
+ * buffer without bound.
+ *
+ * Event names and categories must be string literals (they are stored by
+ * pointer).
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace webcodecs {
+
+class TraceRecorder {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kDefaultMaxEvents = 1 << 20;
+
+  /**
+   * Get the process-wide recorder. Intentionally leaked so worker threads
+   * can record during static destruction.
+   */
+  static TraceRecorder& Instance() {
+    static auto* recorder = new TraceRecorder();
+    return *recorder;
+  }
+
+  [[nodiscard]] bool enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Discard anything recorded and start recording up to |max_events|.
+   */
+  void Start(size_t max_events = kDefaultMaxEvents) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+    events_.reserve(max_events < 4096 ? max_events : 4096);
+    max_events_ = max_events > 0 ? max_events : 1;
+    dropped_ = 0;
+    origin_ = Clock::now();
+    enabled_.store(true, std::memory_order_relaxed);
+  }
+
+  /**
+   * Stop recording and return the trace as JSON. Returns an empty trace if
+   * recording was never started.
+   */
+  std::string Stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_.store(false, std::memory_order_relaxed);
+    std::string json = ToJson();
+    events_.clear();
+    events_.shrink_to_fit();
+    return json;
+  }
+
+  /**
+   * Record work on the calling thread from |start| to |end|.
+   */
+  void Complete(const char* category, const char* name, Clock::time_point start,
+                Clock::time_point end) {
+    Append({'X', category, name, start, end, 0, ThreadId()});
+  }
+
+  /**
+   * Record a span that may cross threads and overlap other spans.
+   */
+  void AsyncSpan(const char* category, const char* name,
+                 Clock::time_point start, Clock::time_point end) {
+    uint64_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    Append({'b', category, name, start, end, id, ThreadId()});
+  }
+
+ private:
+  struct Event {
+    char phase;  // 'X' complete, 'b' async (expands to b/e on output)
+    const char* category;
+    const char* name;
+    Clock::time_point start;
+    Clock::time_point end;
+    uint64_t id;
+    uint32_t tid;
+  };
+
+  TraceRecorder() = default;
+
+  // Small sequential per-thread ids read better in trace viewers than
+  // hashed std::thread::id values.
+  static uint32_t ThreadId() {
+    static std::atomic<uint32_t> next{1};
+    thread_local uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+  }
+
+  void Append(const Event& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      return;  // Stopped while the caller was timing
+    }
+    if (event.start < origin_) {
+      return;  // Began before recording started
+    }
+    if (events_.size() >= max_events_) {
+      ++dropped_;
+      return;
+    }
+    events_.push_back(event);
+  }
+
+  // Microseconds since Start(), as trace-event "ts" expects.
+  double Micros(Clock::time_point t) const {
+    return std::chrono::duration<double, std::micro>(t - origin_).count();
+  }
+
+  void AppendEvent(std::string* out, char phase, const Event& event,
+                   double ts) const {
+    char buf[160];
+    int n = std::snprintf(buf, sizeof(buf),
+                          "{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,",
+                          phase, event.tid, ts);
+    out->append(buf, static_cast<size_t>(n));
+    out->append("\"cat\":\"").append(event.category);
+    out->append("\",\"name\":\"").append(event.name).append("\"");
+    if (phase == 'X') {
+      n = std::snprintf(buf, sizeof(buf), ",\"dur\":%.3f",
+                        Micros(event.end) - ts);
+      out->append(buf, static_cast<size_t>(n));
+    } else {
+      n = std::snprintf(buf, sizeof(buf), ",\"id\":\"0x%llx\"",
+                        static_cast<unsigned long long>(event.id));
+      out->append(buf, static_cast<size_t>(n));
+    }
+    out->append("}");
+  }
+
+  std::string ToJson() const {
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    for (const Event& event : events_) {
+      if (!first) {
+        out.append(",");
+      }
+      first = false;
+      if (event.phase == 'X') {
+        AppendEvent(&out, 'X', event, Micros(event.start));
+      } else {
+        AppendEvent(&out, 'b', event, Micros(event.start));
+        out.append(",");
+        AppendEvent(&out, 'e', event, Micros(event.end));
+      }
+    }
+    out.append("],\"displayTimeUnit\":\"ms\",");
+    out.append("\"otherData\":{\"droppedEvents\":");
+    out.append(std::to_string(dropped_)).append("}}");
+    return out;
+  }
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> next_id_{1};
+  std::mutex mutex_;
+  std::vector<Event> events_;
+  size_t max_events_ = kDefaultMaxEvents;
+  uint64_t dropped_ = 0;
+  Clock::time_point origin_;
+};
+
+}  // namespace webcodecs
@@ -0,0 +1,450 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#include "src/shared_frame_ring.h"
+
+extern "C" {
+#include <libavutil/buffer.h>
+}
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "src/common.h"
+#include "src/video_frame.h"
+
+namespace {
+
+// Owner of one consumer-side slot, attached to the AVBufferRef that wraps
+// it. Keeps the mapping alive after the SharedFrameRing is collected.
+struct SlotLease {
+  std::shared_ptr<webcodecs::ShmFrameRing> ring;
+  int slot;
+};
+
+// AVBuffer free callback; runs wherever the frame's last reference dies.
+void ReleaseSlot(void* opaque, uint8_t* data) {
+  auto* lease = static_cast<SlotLease*>(opaque);
+  lease->ring->Release(lease->slot);
+  delete lease;
+}
+
+void CopyName(const std::string& value, char* dst, size_t size) {
+  size_t length = std::min(value.size(), size - 1);
+  std::memcpy(dst, value.data(), length);
+  dst[length] = '\0';
+}
+
+}  // namespace
+
+Napi::Object SharedFrameRing::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "SharedFrameRing",
+      {
+          InstanceAccessor("name", &SharedFrameRing::GetName, nullptr),
+          InstanceAccessor("slotCount", &SharedFrameRing::GetSlotCount,
+                           nullptr),
+          InstanceAccessor("slotSize", &SharedFrameRing::GetSlotSize,
+                           nullptr),
+          InstanceAccessor("closed", &SharedFrameRing::GetClosed, nullptr),
+          InstanceMethod("tryWrite", &SharedFrameRing::TryWrite),
+          InstanceMethod("write", &SharedFrameRing::Write),
+          InstanceMethod("tryRead", &SharedFrameRing::TryRead),
+          InstanceMethod("read", &SharedFrameRing::Read),
+          InstanceMethod("close", &SharedFrameRing::Close),
+      });
+
+  exports.Set("SharedFrameRing", func);
+  return exports;
+}
+
+SharedFrameRing::SharedFrameRing(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SharedFrameRing>(info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Config object required")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Object config = info[0].As<Napi::Object>();
+  std::string name = webcodecs::AttrAsStr(config, "name", "");
+  if (name.empty()) {
+    Napi::TypeError::New(env, "name is required")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  std::string error;
+  if (webcodecs::AttrAsBool(config, "create", false)) {
+    int32_t slots = webcodecs::AttrAsInt32(config, "slots", 4);
+    int64_t slot_size = webcodecs::AttrAsInt64(config, "slotSize", 0);
+    if (slots <= 0 || slot_size <= 0) {
+      Napi::RangeError::New(env, "slots and slotSize must be positive")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    ring_ = webcodecs::ShmFrameRing::Create(
+        name, static_cast<uint32_t>(slots), static_cast<size_t>(slot_size),
+        &error);
+  } else {
+    ring_ = webcodecs::ShmFrameRing::Open(name, &error);
+  }
+  if (!ring_) {
+    Napi::Error::New(env,
+                     "Could not map frame ring '" + name + "': " + error)
+        .ThrowAsJavaScriptException();
+  }
+}
+
+Napi::Value SharedFrameRing::GetName(const Napi::CallbackInfo& info) {
+  return Napi::String::New(info.Env(), ring_->name());
+}
+
+Napi::Value SharedFrameRing::GetSlotCount(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), ring_->slot_count());
+}
+
+Napi::Value SharedFrameRing::GetSlotSize(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(),
+                           static_cast<double>(ring_->slot_size()));
+}
+
+Napi::Value SharedFrameRing::GetClosed(const Napi::CallbackInfo& info) {
+  return Napi::Boolean::New(info.Env(), ring_->closed());
+}
+
+VideoFrame* SharedFrameRing::PrepareWrite(Napi::Env env, Napi::Value frame,
+                                          Napi::Value options,
+                                          PendingWrite* write) {
+  if (!frame.IsObject()) {
+    throw Napi::TypeError::New(env, "frame must be a VideoFrame object");
+  }
+  VideoFrame* video_frame =
+      Napi::ObjectWrap<VideoFrame>::Unwrap(frame.As<Napi::Object>());
+  PixelFormat format = video_frame->GetFormat();
+  int width = video_frame->GetWidth();
+  int height = video_frame->GetHeight();
+  size_t size = CalculateAllocationSize(format, width, height);
+  if (size == 0 || PixelFormatToAV(format) == AV_PIX_FMT_NONE) {
+    throw Napi::TypeError::New(env, "Unsupported VideoFrame format");
+  }
+  if (size > ring_->slot_size()) {
+    throw Napi::RangeError::New(
+        env, "VideoFrame needs " + std::to_string(size) +
+                 " bytes but ring slots hold " +
+                 std::to_string(ring_->slot_size()));
+  }
+
+  if (video_frame->GetAVFrame()) {
+    // A new reference (downloading GPU surfaces), so the copy into the slot
+    // can happen off the JS thread.
+    write->frame = ffmpeg::make_frame();
+    if (!write->frame || !video_frame->RefAVFrame(write->frame.get())) {
+      throw Napi::Error::New(env, "Failed to reference VideoFrame data");
+    }
+  } else {
+    write->packed = video_frame->GetData();
+    write->packed_size = video_frame->GetDataSize();
+    if (write->packed_size < size) {
+      throw Napi::Error::New(env, "VideoFrame data is truncated");
+    }
+  }
+
+  webcodecs::ShmFrameInfo& slot_info = write->info;
+  slot_info.width = width;
+  slot_info.height = height;
+  slot_info.format = PixelFormatToAV(format);
+  slot_info.timestamp = video_frame->GetTimestampValue();
+  slot_info.has_duration = video_frame->HasDuration() ? 1 : 0;
+  slot_info.duration = video_frame->GetDurationValue();
+  slot_info.data_size = size;
+  slot_info.full_range = -1;
+  if (!options.IsObject()) {
+    return video_frame;
+  }
+
+  // The JS wrapper passes what the frame reports, including overrides from
+  // VideoFrame-from-VideoFrame construction that the native frame lacks.
+  Napi::Object opts = options.As<Napi::Object>();
+  if (opts.Get("timestamp").IsNumber()) {
+    slot_info.timestamp = webcodecs::AttrAsInt64(opts, "timestamp");
+  }
+  if (opts.Get("duration").IsNumber()) {
+    slot_info.duration = webcodecs::AttrAsInt64(opts, "duration");
+    slot_info.has_duration = 1;
+  }
+  if (opts.Get("colorSpace").IsObject()) {
+    Napi::Object cs = opts.Get("colorSpace").As<Napi::Object>();
+    CopyName(webcodecs::AttrAsStr(cs, "primaries", ""),
+             slot_info.color_primaries, sizeof(slot_info.color_primaries));
+    CopyName(webcodecs::AttrAsStr(cs, "transfer", ""),
+             slot_info.color_transfer, sizeof(slot_info.color_transfer));
+    CopyName(webcodecs::AttrAsStr(cs, "matrix", ""), slot_info.color_matrix,
+             sizeof(slot_info.color_matrix));
+    if (cs.Get("fullRange").IsBoolean()) {
+      slot_info.full_range = webcodecs::AttrAsBool(cs, "fullRange") ? 1 : 0;
+    }
+  }
+  return video_frame;
+}
+
+void SharedFrameRing::CommitWrite(webcodecs::ShmFrameRing* ring, int slot,
+                                  const PendingWrite& write) {
+  uint8_t* data = ring->SlotData(slot);
+  if (write.frame) {
+    CopyFrameToPackedBuffer(
+        write.frame.get(),
+        PixelFormatFromAV(static_cast<AVPixelFormat>(write.info.format)), data,
+        ring->slot_size());
+  } else {
+    std::memcpy(data, write.packed, write.info.data_size);
+  }
+  *ring->SlotInfo(slot) = write.info;
+  ring->Publish(slot);
+}
+
+Napi::Value SharedFrameRing::TryWrite(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PendingWrite write;
+  PrepareWrite(env, info[0], info[1], &write);
+
+  int slot = ring_->AcquireWrite(0);
+  if (slot == webcodecs::ShmFrameRing::kClosed) {
+    throw Napi::Error::New(env, "InvalidStateError: SharedFrameRing is closed");
+  }
+  if (slot < 0) {
+    return Napi::Boolean::New(env, false);
+  }
+  CommitWrite(ring_.get(), slot, write);
+  return Napi::Boolean::New(env, true);
+}
+
+class SharedFrameRing::WriteWorker : public Napi::AsyncWorker {
+ public:
+  WriteWorker(Napi::Env env, SharedFrameRing* ring, PendingWrite write,
+              int timeout_ms)
+      : Napi::AsyncWorker(env, "SharedFrameRing.write"),
+        ring_(ring->ring_),
+        ring_ref_(Napi::Persistent(ring->Value())),
+        write_(std::move(write)),
+        timeout_ms_(timeout_ms),
+        deferred_(Napi::Promise::Deferred::New(env)) {}
+
+  Napi::Promise Promise() const { return deferred_.Promise(); }
+
+  void Execute() override {
+    int slot = ring_->AcquireWrite(timeout_ms_);
+    if (slot == webcodecs::ShmFrameRing::kClosed) {
+      SetError("InvalidStateError: SharedFrameRing is closed");
+      return;
+    }
+    if (slot >= 0) {
+      CommitWrite(ring_.get(), slot, write_);
+      written_ = true;
+    }
+    write_.frame.reset();
+  }
+
+  void OnOK() override {
+    deferred_.Resolve(Napi::Boolean::New(Env(), written_));
+  }
+
+  void OnError(const Napi::Error& e) override { deferred_.Reject(e.Value()); }
+
+ private:
+  std::shared_ptr<webcodecs::ShmFrameRing> ring_;
+  Napi::ObjectReference ring_ref_;
+  PendingWrite write_;
+  int timeout_ms_;
+  bool written_ = false;
+  Napi::Promise::Deferred deferred_;
+};
+
+Napi::Value SharedFrameRing::Write(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PendingWrite write;
+  VideoFrame* video_frame = PrepareWrite(env, info[0], info[2], &write);
+  int timeout_ms = info[1].IsNumber() ? info[1].As<Napi::Number>().Int32Value()
+                                      : -1;
+
+  // A free slot is filled right away; only waiting goes to the pool.
+  int slot = ring_->AcquireWrite(0);
+  if (slot == webcodecs::ShmFrameRing::kClosed) {
+    throw Napi::Error::New(env, "InvalidStateError: SharedFrameRing is closed");
+  }
+  if (slot >= 0) {
+    CommitWrite(ring_.get(), slot, write);
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    deferred.Resolve(Napi::Boolean::New(env, true));
+    return deferred.Promise();
+  }
+
+  if (!write.frame) {
+    // The packed buffer belongs to the VideoFrame, which JS may close while
+    // the worker waits; take pooled planes of our own.
+    write.frame = ffmpeg::make_frame();
+    if (!write.frame || !video_frame->RefAVFrame(write.frame.get())) {
+      throw Napi::Error::New(env, "Failed to reference VideoFrame data");
+    }
+    write.packed = nullptr;
+  }
+
+  // The worker deletes itself after settling the promise.
+  auto* worker = new WriteWorker(env, this, std::move(write), timeout_ms);
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::Value SharedFrameRing::WrapSlot(
+    Napi::Env env, const std::shared_ptr<webcodecs::ShmFrameRing>& ring,
+    int slot) {
+  const webcodecs::ShmFrameInfo& slot_info = *ring->SlotInfo(slot);
+  PixelFormat format =
+      PixelFormatFromAV(static_cast<AVPixelFormat>(slot_info.format));
+  size_t size = format == PixelFormat::UNKNOWN || slot_info.width <= 0 ||
+                        slot_info.height <= 0
+                    ? 0
+                    : CalculateAllocationSize(format, slot_info.width,
+                                              slot_info.height);
+  // The producer is another process; trust nothing it wrote.
+  if (size == 0 || size > ring->slot_size()) {
+    ring->Release(slot);
+    throw Napi::Error::New(env, "Frame ring slot holds an invalid frame");
+  }
+
+  ffmpeg::AVFramePtr frame = ffmpeg::make_frame();
+  if (!frame) {
+    ring->Release(slot);
+    throw Napi::Error::New(env, "Failed to allocate frame");
+  }
+  auto* lease = new SlotLease{ring, slot};
+  uint8_t* data = ring->SlotData(slot);
+  frame->buf[0] = av_buffer_create(data, size, ReleaseSlot, lease,
+                                   AV_BUFFER_FLAG_READONLY);
+  if (!frame->buf[0]) {
+    delete lease;
+    ring->Release(slot);
+    throw Napi::Error::New(env, "Failed to allocate frame");
+  }
+  // From here on |frame| owns the slot.
+  frame->width = slot_info.width;
+  frame->height = slot_info.height;
+  frame->format = slot_info.format;
+  int row_bytes[4] = {0};
+  int rows[4] = {0};
+  int planes = GetPackedPlaneLayout(format, slot_info.width, slot_info.height,
+                                    row_bytes, rows);
+  for (int plane = 0; plane < planes; ++plane) {
+    frame->data[plane] = data;
+    frame->linesize[plane] = row_bytes[plane];
+    data += static_cast<size_t>(row_bytes[plane]) * rows[plane];
+  }
+
+  Napi::Object init = Napi::Object::New(env);
+  init.Set("timestamp", Napi::Number::New(env, slot_info.timestamp));
+  if (slot_info.has_duration) {
+    init.Set("duration", Napi::Number::New(env, slot_info.duration));
+  }
+  std::string primaries(slot_info.color_primaries,
+                        strnlen(slot_info.color_primaries,
+                                sizeof(slot_info.color_primaries)));
+  std::string transfer(slot_info.color_transfer,
+                       strnlen(slot_info.color_transfer,
+                               sizeof(slot_info.color_transfer)));
+  std::string matrix(slot_info.color_matrix,
+                     strnlen(slot_info.color_matrix,
+                             sizeof(slot_info.color_matrix)));
+  if (!primaries.empty() || !transfer.empty() || !matrix.empty() ||
+      slot_info.full_range >= 0) {
+    Napi::Object cs = Napi::Object::New(env);
+    if (!primaries.empty()) {
+      cs.Set("primaries", primaries);
+    }
+    if (!transfer.empty()) {
+      cs.Set("transfer", transfer);
+    }
+    if (!matrix.empty()) {
+      cs.Set("matrix", matrix);
+    }
+    cs.Set("fullRange", Napi::Boolean::New(env, slot_info.full_range == 1));
+    init.Set("colorSpace", cs);
+  }
+  return VideoFrame::CreateFromAVFrame(env, std::move(frame), init);
+}
+
+Napi::Value SharedFrameRing::TryRead(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  int slot = ring_->AcquireRead(0);
+  if (slot < 0) {
+    return env.Null();
+  }
+  return WrapSlot(env, ring_, slot);
+}
+
+class SharedFrameRing::ReadWorker : public Napi::AsyncWorker {
+ public:
+  ReadWorker(Napi::Env env, SharedFrameRing* ring, int timeout_ms)
+      : Napi::AsyncWorker(env, "SharedFrameRing.read"),
+        ring_(ring->ring_),
+        ring_ref_(Napi::Persistent(ring->Value())),
+        timeout_ms_(timeout_ms),
+        deferred_(Napi::Promise::Deferred::New(env)) {}
+
+  Napi::Promise Promise() const { return deferred_.Promise(); }
+
+  void Execute() override {
+    slot_ = ring_->AcquireRead(timeout_ms_);
+    if (slot_ == webcodecs::ShmFrameRing::kTimedOut) {
+      SetError("TimeoutError: No frame arrived in time");
+    }
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+    if (slot_ == webcodecs::ShmFrameRing::kClosed) {
+      deferred_.Resolve(env.Null());
+      return;
+    }
+    try {
+      deferred_.Resolve(WrapSlot(env, ring_, slot_));
+    } catch (const Napi::Error& e) {
+      deferred_.Reject(e.Value());
+    }
+  }
+
+  void OnError(const Napi::Error& e) override { deferred_.Reject(e.Value()); }
+
+ private:
+  std::shared_ptr<webcodecs::ShmFrameRing> ring_;
+  Napi::ObjectReference ring_ref_;
+  int timeout_ms_;
+  int slot_ = webcodecs::ShmFrameRing::kTimedOut;
+  Napi::Promise::Deferred deferred_;
+};
+
+Napi::Value SharedFrameRing::Read(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  int timeout_ms = info[0].IsNumber() ? info[0].As<Napi::Number>().Int32Value()
+                                      : -1;
+
+  // The worker deletes itself after settling the promise.
+  auto* worker = new ReadWorker(env, this, timeout_ms);
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
+}
+
+void SharedFrameRing::Close(const Napi::CallbackInfo& info) {
+  // Ends the stream for both processes; frames still held stay valid.
+  ring_->Close();
+}
+
+Napi::Object InitSharedFrameRing(Napi::Env env, Napi::Object exports) {
+  return SharedFrameRing::Init(env, exports);
+}
@@ -0,0 +1,81 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// SharedFrameRing - JavaScript face of ShmFrameRing, for passing VideoFrames
+// between processes.
+//
+// The producer copies each frame's pixels once, straight into a shared slot
+// (downloading hardware frames first). The consumer gets a VideoFrame whose
+// planes are the slot itself; the slot returns to the producer when that
+// frame's last reference goes away, so close() it or hand it to an encoder
+// promptly. Blocking waits run on the libuv thread pool.
+
+#ifndef SRC_SHARED_FRAME_RING_H_
+#define SRC_SHARED_FRAME_RING_H_
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+#include <napi.h>
+
+#include <memory>
+#include <string>
+
+#include "src/ffmpeg_raii.h"
+#include "src/shm_frame_ring.h"
+
+class VideoFrame;
+
+class SharedFrameRing : public Napi::ObjectWrap<SharedFrameRing> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  explicit SharedFrameRing(const Napi::CallbackInfo& info);
+  ~SharedFrameRing() = default;
+
+  // Disallow copy and assign.
+  SharedFrameRing(const SharedFrameRing&) = delete;
+  SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+ private:
+  // Pixels and properties of one frame to write, captured on the JS thread.
+  struct PendingWrite {
+    ffmpeg::AVFramePtr frame;  // Null when the source is a packed buffer
+    const uint8_t* packed = nullptr;
+    size_t packed_size = 0;
+    webcodecs::ShmFrameInfo info = {};
+  };
+
+  class WriteWorker;
+  class ReadWorker;
+
+  Napi::Value GetName(const Napi::CallbackInfo& info);
+  Napi::Value GetSlotCount(const Napi::CallbackInfo& info);
+  Napi::Value GetSlotSize(const Napi::CallbackInfo& info);
+  Napi::Value GetClosed(const Napi::CallbackInfo& info);
+
+  Napi::Value TryWrite(const Napi::CallbackInfo& info);
+  Napi::Value Write(const Napi::CallbackInfo& info);
+  Napi::Value TryRead(const Napi::CallbackInfo& info);
+  Napi::Value Read(const Napi::CallbackInfo& info);
+  void Close(const Napi::CallbackInfo& info);
+
+  // Validate a frame and write() options and describe the frame in
+  // |write|. Packed-buffer frames are referenced in place, so |write| is
+  // only valid until JS runs again. Throws on invalid arguments.
+  VideoFrame* PrepareWrite(Napi::Env env, Napi::Value frame,
+                           Napi::Value options, PendingWrite* write);
+  // Fill |slot| from |write| and publish it.
+  static void CommitWrite(webcodecs::ShmFrameRing* ring, int slot,
+                          const PendingWrite& write);
+  // VideoFrame over the pixels of a slot from AcquireRead(). The slot is
+  // released when the frame's planes are freed, or here on failure.
+  static Napi::Value WrapSlot(Napi::Env env,
+                              const std::shared_ptr<webcodecs::ShmFrameRing>&
+                                  ring,
+                              int slot);
+
+  std::shared_ptr<webcodecs::ShmFrameRing> ring_;
+};
+
+#endif  // SRC_SHARED_FRAME_RING_H_
@@ -0,0 +1,314 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#include "src/shm_frame_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace webcodecs {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x52464357;  // "WCFR"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kAlignment = 64;
+// Upper bound on one sleep, so a waiter notices Close() even if its wake-up
+// raced with going to sleep.
+constexpr int64_t kMaxWaitSliceNs = 50 * 1000 * 1000;
+
+enum SlotState : uint32_t {
+  kFree = 0,
+  kReady = 1,  // Published, not yet taken by the consumer
+  kInUse = 2,  // Held by the consumer
+};
+
+size_t AlignUp(size_t value) {
+  return (value + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+std::string ErrnoMessage(const char* what) {
+  return std::string(what) + ": " + std::strerror(errno);
+}
+
+}  // namespace
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+
+struct ShmFrameRing::Header {
+  std::atomic<uint32_t> magic;  // Stored last by Create()
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t reserved;
+  uint64_t slot_size;
+  uint64_t slot_stride;
+  alignas(kAlignment) std::atomic<uint32_t> closed;
+  // Only the producer (write) or consumer (read) side touches each index.
+  alignas(kAlignment) std::atomic<uint32_t> write_index;
+  alignas(kAlignment) std::atomic<uint32_t> read_index;
+};
+
+struct ShmFrameRing::Slot {
+  std::atomic<uint32_t> state;
+  uint32_t reserved;
+  ShmFrameInfo info;
+};
+
+size_t ShmFrameRing::SlotStride(size_t slot_size) {
+  return AlignUp(sizeof(Slot)) + AlignUp(slot_size);
+}
+
+size_t ShmFrameRing::MappingSize(uint32_t slot_count, size_t slot_stride) {
+  return AlignUp(sizeof(Header)) + slot_count * slot_stride;
+}
+
+std::shared_ptr<ShmFrameRing> ShmFrameRing::Create(const std::string& name,
+                                                   uint32_t slot_count,
+                                                   size_t slot_size,
+                                                   std::string* error) {
+  if (slot_count == 0 || slot_size == 0) {
+    *error = "slot count and size must be positive";
+    return nullptr;
+  }
+  if (slot_size > (SIZE_MAX / 2) / slot_count) {
+    *error = "ring is too large";
+    return nullptr;
+  }
+  size_t stride = SlotStride(slot_size);
+  size_t size = MappingSize(slot_count, stride);
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    *error = ErrnoMessage("shm_open");
+    return nullptr;
+  }
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    *error = ErrnoMessage("ftruncate");
+    close(fd);
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    *error = ErrnoMessage("mmap");
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+
+  // ftruncate() zero-fills, so every slot starts out free.
+  auto* header = new (base) Header();
+  header->version = kVersion;
+  header->slot_count = slot_count;
+  header->slot_size = slot_size;
+  header->slot_stride = stride;
+  std::shared_ptr<ShmFrameRing> ring(
+      new ShmFrameRing(name, base, size, true));
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    new (ring->slot(static_cast<int>(i))) Slot();
+  }
+  header->magic.store(kMagic, std::memory_order_release);
+  return ring;
+}
+
+std::shared_ptr<ShmFrameRing> ShmFrameRing::Open(const std::string& name,
+                                                 std::string* error) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    *error = ErrnoMessage("shm_open");
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    *error = ErrnoMessage("fstat");
+    close(fd);
+    return nullptr;
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  if (size < sizeof(Header)) {
+    *error = "not a frame ring";
+    close(fd);
+    return nullptr;
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    *error = ErrnoMessage("mmap");
+    return nullptr;
+  }
+
+  std::shared_ptr<ShmFrameRing> ring(
+      new ShmFrameRing(name, base, size, false));
+  Header* header = ring->header();
+  if (header->magic.load(std::memory_order_acquire) != kMagic ||
+      header->version != kVersion || header->slot_count == 0 ||
+      header->slot_stride != SlotStride(header->slot_size) ||
+      MappingSize(header->slot_count, header->slot_stride) > size) {
+    *error = "not a frame ring, or one from another version";
+    return nullptr;
+  }
+  return ring;
+}
+
+ShmFrameRing::~ShmFrameRing() {
+  if (owner_ && !unlinked_.exchange(true)) {
+    shm_unlink(name_.c_str());
+  }
+  munmap(base_, size_);
+}
+
+ShmFrameRing::Header* ShmFrameRing::header() const {
+  return static_cast<Header*>(base_);
+}
+
+ShmFrameRing::Slot* ShmFrameRing::slot(int index) const {
+  auto* first = static_cast<uint8_t*>(base_) + AlignUp(sizeof(Header));
+  return reinterpret_cast<Slot*>(first + index * header()->slot_stride);
+}
+
+uint32_t ShmFrameRing::slot_count() const { return header()->slot_count; }
+
+size_t ShmFrameRing::slot_size() const {
+  return static_cast<size_t>(header()->slot_size);
+}
+
+uint8_t* ShmFrameRing::SlotData(int index) {
+  return reinterpret_cast<uint8_t*>(slot(index)) + AlignUp(sizeof(Slot));
+}
+
+ShmFrameInfo* ShmFrameRing::SlotInfo(int index) { return &slot(index)->info; }
+
+bool ShmFrameRing::WaitWhile(std::atomic<uint32_t>* word, uint32_t expected,
+                             int64_t deadline_ns) {
+  int64_t slice = kMaxWaitSliceNs;
+  if (deadline_ns >= 0) {
+    int64_t remaining = deadline_ns - NowNs();
+    if (remaining <= 0) {
+      return false;
+    }
+    slice = std::min(slice, remaining);
+  }
+#if defined(__linux__)
+  // Shared (not FUTEX_PRIVATE) futex: the waker is another process.
+  struct timespec ts;
+  ts.tv_sec = static_cast<time_t>(slice / 1000000000);
+  ts.tv_nsec = static_cast<long>(slice % 1000000000);  // NOLINT(runtime/int)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected,
+          &ts, nullptr, 0);
+#else
+  if (word->load(std::memory_order_acquire) == expected) {
+    std::this_thread::sleep_for(
+        std::chrono::nanoseconds(std::min<int64_t>(slice, 200000)));
+  }
+#endif
+  return true;
+}
+
+void ShmFrameRing::Wake(std::atomic<uint32_t>* word) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT32_MAX,
+          nullptr, nullptr, 0);
+#else
+  (void)word;
+#endif
+}
+
+int ShmFrameRing::AcquireWrite(int timeout_ms) {
+  Header* h = header();
+  uint32_t index = h->write_index.load(std::memory_order_relaxed);
+  int slot_index = static_cast<int>(index % h->slot_count);
+  Slot* s = slot(slot_index);
+  int64_t deadline =
+      timeout_ms < 0 ? -1 : NowNs() + int64_t{timeout_ms} * 1000000;
+  for (;;) {
+    if (h->closed.load(std::memory_order_acquire)) {
+      return kClosed;
+    }
+    uint32_t state = s->state.load(std::memory_order_acquire);
+    if (state == kFree) {
+      break;
+    }
+    if (!WaitWhile(&s->state, state, deadline)) {
+      return kTimedOut;
+    }
+  }
+  h->write_index.store(index + 1, std::memory_order_relaxed);
+  return slot_index;
+}
+
+void ShmFrameRing::Publish(int index) {
+  Slot* s = slot(index);
+  s->state.store(kReady, std::memory_order_release);
+  Wake(&s->state);
+}
+
+int ShmFrameRing::AcquireRead(int timeout_ms) {
+  Header* h = header();
+  uint32_t index = h->read_index.load(std::memory_order_relaxed);
+  int slot_index = static_cast<int>(index % h->slot_count);
+  Slot* s = slot(slot_index);
+  int64_t deadline =
+      timeout_ms < 0 ? -1 : NowNs() + int64_t{timeout_ms} * 1000000;
+  for (;;) {
+    uint32_t state = s->state.load(std::memory_order_acquire);
+    if (state == kReady) {
+      break;
+    }
+    // Re-check after seeing closed: a slot published just before Close()
+    // must still be delivered.
+    if (h->closed.load(std::memory_order_acquire) &&
+        s->state.load(std::memory_order_acquire) != kReady) {
+      return kClosed;
+    }
+    if (!WaitWhile(&s->state, state, deadline)) {
+      return kTimedOut;
+    }
+  }
+  s->state.store(kInUse, std::memory_order_relaxed);
+  h->read_index.store(index + 1, std::memory_order_relaxed);
+  return slot_index;
+}
+
+void ShmFrameRing::Release(int index) {
+  Slot* s = slot(index);
+  s->state.store(kFree, std::memory_order_release);
+  Wake(&s->state);
+}
+
+void ShmFrameRing::Close() {
+  Header* h = header();
+  h->closed.store(1, std::memory_order_release);
+  for (uint32_t i = 0; i < h->slot_count; ++i) {
+    Wake(&slot(static_cast<int>(i))->state);
+  }
+  if (owner_ && !unlinked_.exchange(true)) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+bool ShmFrameRing::closed() const {
+  return header()->closed.load(std::memory_order_acquire) != 0;
+}
+
+}  // namespace webcodecs
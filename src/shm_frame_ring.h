@@ -0,0 +1,128 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// ShmFrameRing - fixed-size ring of frame slots in POSIX shared memory, for
+// handing decoded frames between processes.
+//
+// One process creates the ring under a name (shm_open) and produces; another
+// opens it by name and consumes. Each slot holds one frame's pixels in the
+// tightly packed VideoFrame layout plus a small ShmFrameInfo, and moves
+// through free -> ready (published by the producer) -> in use (handed to
+// the consumer) -> free (released by the consumer). The consumer wraps
+// in-use slots directly, so pixels are never copied on its side, and may
+// release them in any order; the producer always fills the oldest slot and
+// waits for it if it is still in use. Waiting is a futex on the slot state
+// on Linux and a short sleep loop elsewhere.
+//
+// All methods are thread-safe for one producer and one consumer; Release()
+// may be called from any thread of the consumer process.
+
+#ifndef SRC_SHM_FRAME_RING_H_
+#define SRC_SHM_FRAME_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace webcodecs {
+
+// Describes the frame in a slot. Plain data: it lives in shared memory.
+struct ShmFrameInfo {
+  int32_t width;
+  int32_t height;
+  int32_t format;  // AVPixelFormat
+  int32_t has_duration;
+  int64_t timestamp;
+  int64_t duration;
+  uint64_t data_size;  // Bytes of packed pixels in the slot
+  // WebCodecs VideoColorSpace members, empty when unset; full_range is -1
+  // when unset.
+  char color_primaries[16];
+  char color_transfer[16];
+  char color_matrix[16];
+  int32_t full_range;
+  int32_t reserved;
+};
+
+class ShmFrameRing {
+ public:
+  // Result of AcquireWrite()/AcquireRead() when no slot is available.
+  static constexpr int kTimedOut = -1;
+  static constexpr int kClosed = -2;
+
+  // Create and map a new ring of |slot_count| slots of |slot_size| bytes
+  // under |name| (a shm_open name such as "/my-ring"). Fails if the name is
+  // in use. Returns nullptr and sets |error| on failure.
+  static std::shared_ptr<ShmFrameRing> Create(const std::string& name,
+                                              uint32_t slot_count,
+                                              size_t slot_size,
+                                              std::string* error);
+  // Map an existing ring created by another process.
+  static std::shared_ptr<ShmFrameRing> Open(const std::string& name,
+                                            std::string* error);
+
+  ~ShmFrameRing();
+
+  // Disallow copy and assign.
+  ShmFrameRing(const ShmFrameRing&) = delete;
+  ShmFrameRing& operator=(const ShmFrameRing&) = delete;
+
+  uint32_t slot_count() const;
+  size_t slot_size() const;
+  const std::string& name() const { return name_; }
+  bool is_owner() const { return owner_; }
+
+  // Producer: claim the next slot, waiting up to |timeout_ms| (negative:
+  // no limit) for the consumer to release it. Returns the slot index,
+  // kTimedOut or kClosed.
+  int AcquireWrite(int timeout_ms);
+  // Producer: make a slot filled after AcquireWrite() visible to the
+  // consumer.
+  void Publish(int slot);
+
+  // Consumer: take the next published slot, waiting up to |timeout_ms|.
+  // Frames published before Close() are still delivered; after those,
+  // returns kClosed.
+  int AcquireRead(int timeout_ms);
+  // Consumer: hand a slot from AcquireRead() back to the producer.
+  void Release(int slot);
+
+  uint8_t* SlotData(int slot);
+  ShmFrameInfo* SlotInfo(int slot);
+
+  // Mark the ring closed for both sides and wake any waiter. The creator
+  // also unlinks the name, so no new process can open it.
+  void Close();
+  bool closed() const;
+
+ private:
+  struct Header;
+  struct Slot;
+
+  ShmFrameRing(std::string name, void* base, size_t size, bool owner)
+      : name_(std::move(name)), base_(base), size_(size), owner_(owner) {}
+
+  static size_t SlotStride(size_t slot_size);
+  static size_t MappingSize(uint32_t slot_count, size_t slot_stride);
+
+  Header* header() const;
+  Slot* slot(int index) const;
+  // Wait until |word| no longer holds |expected| or |deadline_ns| (steady
+  // clock, negative: none) passes. Returns false on timeout.
+  bool WaitWhile(std::atomic<uint32_t>* word, uint32_t expected,
+                 int64_t deadline_ns);
+  static void Wake(std::atomic<uint32_t>* word);
+
+  std::string name_;
+  void* base_;
+  size_t size_;
+  bool owner_;
+  std::atomic<bool> unlinked_{false};
+};
+
+}  // namespace webcodecs
+
+#endif  // SRC_SHM_FRAME_RING_H_
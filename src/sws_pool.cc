@@ -0,0 +1,242 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// SwsPool implementation.
+
+#include "src/sws_pool.h"
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+#include "src/yuv_kernels.h"
+
+namespace webcodecs {
+
+namespace {
+
+// Options the kernels do not reproduce: libswscale's accurate rounding
+// and full-resolution chroma interpolation.
+constexpr int kKernelIncompatibleFlags =
+    SWS_ACCURATE_RND | SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP |
+    SWS_BITEXACT;
+
+bool RgbOrder(AVPixelFormat format, bool* bgr) {
+  switch (format) {
+    case AV_PIX_FMT_RGBA:
+    case AV_PIX_FMT_RGB0:
+      *bgr = false;
+      return true;
+    case AV_PIX_FMT_BGRA:
+    case AV_PIX_FMT_BGR0:
+      *bgr = true;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// |full_range| is set for formats that imply it (yuvj).
+bool YuvSource(AVPixelFormat format, YuvLayout* layout, bool* full_range) {
+  *full_range = false;
+  switch (format) {
+    case AV_PIX_FMT_YUVJ420P:
+      *full_range = true;
+      [[fallthrough]];
+    case AV_PIX_FMT_YUV420P:
+      *layout = YuvLayout::kI420;
+      return true;
+    case AV_PIX_FMT_NV12:
+      *layout = YuvLayout::kNV12;
+      return true;
+    case AV_PIX_FMT_P010LE:
+      *layout = YuvLayout::kP010;
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool KernelMatrix(int colorspace, YuvMatrix* matrix) {
+  switch (colorspace) {
+    case SWS_CS_DEFAULT:  // Also SWS_CS_ITU601 and SWS_CS_SMPTE170M
+      *matrix = YuvMatrix::kBT601;
+      return true;
+    case SWS_CS_ITU709:
+      *matrix = YuvMatrix::kBT709;
+      return true;
+    case SWS_CS_BT2020:
+      *matrix = YuvMatrix::kBT2020;
+      return true;
+    case SWS_CS_SMPTE240M:
+      *matrix = YuvMatrix::kSMPTE240M;
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+void SwsPool::Releaser::operator()(SwsContext* ctx) const {
+  SwsPool::Instance().Release(key_, ctx);
+}
+
+SwsPool& SwsPool::Instance() {
+  // Leaked intentionally: leases held by objects destroyed during process
+  // exit may still be returned after static destructors have run.
+  static SwsPool* instance = new SwsPool();
+  return *instance;
+}
+
+SwsContext* SwsPool::Create(const SwsKey& key) {
+  SwsContext* ctx = sws_alloc_context();
+  if (!ctx) {
+    return nullptr;
+  }
+  av_opt_set_int(ctx, "srcw", key.src_width, 0);
+  av_opt_set_int(ctx, "srch", key.src_height, 0);
+  av_opt_set_int(ctx, "src_format", key.src_format, 0);
+  av_opt_set_int(ctx, "dstw", key.dst_width, 0);
+  av_opt_set_int(ctx, "dsth", key.dst_height, 0);
+  av_opt_set_int(ctx, "dst_format", key.dst_format, 0);
+  av_opt_set_int(ctx, "sws_flags", key.flags, 0);
+  av_opt_set_int(ctx, "threads", key.threads, 0);
+  if (sws_init_context(ctx, nullptr, nullptr) < 0) {
+    sws_freeContext(ctx);
+    return nullptr;
+  }
+
+  // YUV output stays BT.601 limited range; libswscale ignores range for RGB.
+  if (key.colorspace != SWS_CS_DEFAULT || key.src_full_range) {
+    sws_setColorspaceDetails(ctx, sws_getCoefficients(key.colorspace),
+                             key.src_full_range ? 1 : 0,
+                             sws_getCoefficients(SWS_CS_DEFAULT), 0, 0,
+                             1 << 16, 1 << 16);
+  }
+  return ctx;
+}
+
+int ScaleFrame(SwsContext* ctx, AVFrame* dst, const AVFrame* src) {
+  // sws_scale_frame() takes references to both frames; for unowned planes
+  // that would mean converting into a fresh copy instead of |dst|.
+  if (dst->buf[0] && src->buf[0]) {
+    return sws_scale_frame(ctx, dst, src);
+  }
+  int ret = sws_scale(ctx, src->data, src->linesize, 0, src->height,
+                      dst->data, dst->linesize);
+  return ret > 0 ? 0 : AVERROR(EINVAL);
+}
+
+bool ConvertWithKernels(const SwsKey& key, const uint8_t* const src_data[4],
+                        const int src_linesize[4], uint8_t* const dst_data[4],
+                        const int dst_linesize[4]) {
+  // Sliced conversions keep libswscale's threads.
+  if (!HasYuvKernels() || key.threads != 1 ||
+      key.src_width != key.dst_width || key.src_height != key.dst_height ||
+      (key.flags & kKernelIncompatibleFlags)) {
+    return false;
+  }
+
+  YuvLayout layout;
+  bool bgr = false;
+  bool full_range = false;
+  if (YuvSource(key.src_format, &layout, &full_range) &&
+      RgbOrder(key.dst_format, &bgr)) {
+    YuvMatrix matrix;
+    if (!KernelMatrix(key.colorspace, &matrix)) {
+      return false;
+    }
+    ConvertYuvToRgb(layout, src_data, src_linesize, dst_data[0],
+                    dst_linesize[0], bgr, key.src_width, key.src_height,
+                    matrix, full_range || key.src_full_range);
+    return true;
+  }
+
+  // RGB sources produce BT.601 limited range, as libswscale does by default.
+  if (RgbOrder(key.src_format, &bgr) &&
+      (key.dst_format == AV_PIX_FMT_YUV420P ||
+       key.dst_format == AV_PIX_FMT_NV12)) {
+    layout = key.dst_format == AV_PIX_FMT_NV12 ? YuvLayout::kNV12
+                                               : YuvLayout::kI420;
+    ConvertRgbToYuv(src_data[0], src_linesize[0], bgr, layout, dst_data,
+                    dst_linesize, key.src_width, key.src_height);
+    return true;
+  }
+  return false;
+}
+
+int ScaleFrame(const SwsPool::Lease& lease, AVFrame* dst, const AVFrame* src) {
+  const SwsKey& key = lease.get_deleter().key();
+  if (src->width == key.src_width && src->height == key.src_height &&
+      src->format == key.src_format && dst->width == key.dst_width &&
+      dst->height == key.dst_height && dst->format == key.dst_format &&
+      ConvertWithKernels(key, src->data, src->linesize, dst->data,
+                         dst->linesize)) {
+    return 0;
+  }
+  return ScaleFrame(lease.get(), dst, src);
+}
+
+SwsPool::Lease SwsPool::Acquire(const SwsKey& key) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+      if (it->first == key) {
+        SwsContext* ctx = it->second;
+        idle_.erase(it);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return Lease(ctx, Releaser(key));
+      }
+    }
+  }
+
+  // Build outside the lock; coefficient setup is the slow part.
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  SwsContext* ctx = Create(key);
+  return ctx ? Lease(ctx, Releaser(key)) : Lease(nullptr, Releaser());
+}
+
+bool SwsPool::Ensure(Lease* lease, const SwsKey& key) {
+  if (*lease && lease->get_deleter().key() == key) {
+    return true;
+  }
+  lease->reset();  // Return the old context before leasing the new one
+  *lease = Acquire(key);
+  return static_cast<bool>(*lease);
+}
+
+void SwsPool::Release(const SwsKey& key, SwsContext* ctx) {
+  SwsContext* evicted = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.emplace_front(key, ctx);
+    if (idle_.size() > kMaxIdle) {
+      evicted = idle_.back().second;
+      idle_.pop_back();
+    }
+  }
+  sws_freeContext(evicted);
+}
+
+SwsPoolStats SwsPool::GetStats() const {
+  SwsPoolStats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats.idle_contexts = idle_.size();
+  return stats;
+}
+
+void SwsPool::Trim() {
+  std::list<std::pair<SwsKey, SwsContext*>> idle;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle.swap(idle_);
+  }
+  for (auto& entry : idle) {
+    sws_freeContext(entry.second);
+  }
+}
+
+}  // namespace webcodecs
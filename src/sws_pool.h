@@ -0,0 +1,144 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// SwsPool - process-wide cache of libswscale contexts.
+//
+// Creating a SwsContext builds filter coefficient tables, which costs far
+// more than a typical conversion, especially for odd sizes. Call sites lease
+// a context for a conversion (SwsKey) and hand it back when the conversion
+// changes or they go away; the next lease of the same key reuses it. A
+// SwsContext is not thread-safe, so each lease is exclusive while held.
+//
+// Same-size conversions between 4:2:0 YUV and packed RGB skip libswscale
+// when the CPU has the vectorised kernels in yuv_kernels.h
+// (ConvertWithKernels).
+
+#ifndef SRC_SWS_POOL_H_
+#define SRC_SWS_POOL_H_
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace webcodecs {
+
+// Everything a pooled SwsContext is configured with.
+struct SwsKey {
+  int src_width = 0;
+  int src_height = 0;
+  AVPixelFormat src_format = AV_PIX_FMT_NONE;
+  int dst_width = 0;
+  int dst_height = 0;
+  AVPixelFormat dst_format = AV_PIX_FMT_NONE;
+  int flags = SWS_BILINEAR;
+  // Matrix and range YUV sources are read with. The defaults leave
+  // libswscale's own choice (BT.601; full range for yuvj formats).
+  int colorspace = SWS_CS_DEFAULT;
+  bool src_full_range = false;
+  int threads = 1;  // Slice threads for sws_scale_frame(); 0 = per core
+
+  static SwsKey Scale(int src_width, int src_height, AVPixelFormat src_format,
+                      int dst_width, int dst_height,
+                      AVPixelFormat dst_format) {
+    SwsKey key;
+    key.src_width = src_width;
+    key.src_height = src_height;
+    key.src_format = src_format;
+    key.dst_width = dst_width;
+    key.dst_height = dst_height;
+    key.dst_format = dst_format;
+    return key;
+  }
+
+  // Same-size conversion between two formats.
+  static SwsKey Convert(int width, int height, AVPixelFormat src,
+                        AVPixelFormat dst) {
+    return Scale(width, height, src, width, height, dst);
+  }
+
+  bool operator==(const SwsKey& other) const = default;
+};
+
+// Convert |src| into the buffers |dst| already has. Uses sws_scale_frame()
+// (and so the context's slice threads) when both frames own their buffers,
+// plain sws_scale() otherwise. Returns a negative AVERROR on failure.
+int ScaleFrame(SwsContext* ctx, AVFrame* dst, const AVFrame* src);
+
+// Convert planes as a context for |key| would, with the vectorised kernels
+// in yuv_kernels.h. Returns false, leaving |dst_data| untouched, unless the
+// key is a single-threaded same-size conversion they reproduce.
+bool ConvertWithKernels(const SwsKey& key, const uint8_t* const src_data[4],
+                        const int src_linesize[4], uint8_t* const dst_data[4],
+                        const int dst_linesize[4]);
+
+struct SwsPoolStats {
+  uint64_t hits = 0;           // Leases served by an idle context
+  uint64_t misses = 0;         // Leases that created a context
+  uint64_t idle_contexts = 0;  // Contexts waiting for reuse
+};
+
+class SwsPool {
+ public:
+  // Idle contexts kept; the least recently returned is freed beyond this.
+  static constexpr size_t kMaxIdle = 32;
+
+  // unique_ptr deleter that returns the context to the pool.
+  class Releaser {
+   public:
+    Releaser() = default;
+    explicit Releaser(const SwsKey& key) : key_(key) {}
+    void operator()(SwsContext* ctx) const;
+    const SwsKey& key() const { return key_; }
+
+   private:
+    SwsKey key_;
+  };
+  using Lease = std::unique_ptr<SwsContext, Releaser>;
+
+  static SwsPool& Instance();
+
+  // Disallow copy and assign.
+  SwsPool(const SwsPool&) = delete;
+  SwsPool& operator=(const SwsPool&) = delete;
+
+  // Context for |key|, reused if one is idle. Empty on failure.
+  Lease Acquire(const SwsKey& key);
+
+  // Point |lease| at a context for |key|, keeping it if it already matches.
+  // Returns false (and leaves |lease| empty) on failure.
+  bool Ensure(Lease* lease, const SwsKey& key);
+
+  SwsPoolStats GetStats() const;
+
+  // Free every idle context.
+  void Trim();
+
+ private:
+  SwsPool() = default;
+
+  static SwsContext* Create(const SwsKey& key);
+  void Release(const SwsKey& key, SwsContext* ctx);
+
+  mutable std::mutex mutex_;
+  std::list<std::pair<SwsKey, SwsContext*>> idle_;  // Most recent first
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+// ScaleFrame() for the conversion |lease| was acquired for: through
+// ConvertWithKernels() when it applies, the leased context otherwise.
+int ScaleFrame(const SwsPool::Lease& lease, AVFrame* dst, const AVFrame* src);
+
+}  // namespace webcodecs
+
+#endif  // SRC_SWS_POOL_H_
@@ -5,6 +5,7 @@
 
 #include <cstdio>
 #include <string>
+#include <utility>
 
 #include "src/common.h"
 #include "src/video_frame.h"
@@ -30,6 +31,8 @@ TestVideoGenerator::TestVideoGenerator(const Napi::CallbackInfo& info)
       height_(0),
       frame_rate_(30),
       duration_(1),
+      pool_size_(0),
+      format_(AV_PIX_FMT_RGBA),
       pattern_("testsrc"),
       state_("unconfigured") {}
 
@@ -37,8 +40,7 @@ TestVideoGenerator::~TestVideoGenerator() { Cleanup(); }
 
 void TestVideoGenerator::Cleanup() {
   filter_graph_.reset();
-  sws_yuv_to_rgba_.reset();
-  output_frame_.reset();
+  pool_.clear();
   buffersink_ctx_ = nullptr;
 }
 
@@ -88,19 +90,32 @@ Napi::Value TestVideoGenerator::Configure(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  // Initialize swscale for RGB24 -> RGBA conversion
-  // Note: testsrc outputs RGB24 by default, not YUV420P
-  sws_yuv_to_rgba_.reset(
-      sws_getContext(width_, height_, AV_PIX_FMT_RGB24, width_, height_,
-                     AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr, nullptr, nullptr));
+  if (webcodecs::HasAttr(config, "poolSize")) {
+    pool_size_ = webcodecs::AttrAsInt32(config, "poolSize");
+    if (pool_size_ < 0) {
+      Napi::RangeError::New(env, "poolSize must not be negative")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
 
-  if (!sws_yuv_to_rgba_) {
-    Napi::Error::New(env, "Failed to create swscale context")
+  // Frames leave the filter graph in the requested VideoFrame format, so
+  // no per-frame conversion happens here.
+  std::string format = webcodecs::AttrAsStr(config, "format", "RGBA");
+  if (format == "RGBA") {
+    format_ = AV_PIX_FMT_RGBA;
+  } else if (format == "I420") {
+    format_ = AV_PIX_FMT_YUV420P;
+  } else if (format == "NV12") {
+    format_ = AV_PIX_FMT_NV12;
+  } else {
+    Napi::TypeError::New(env, "format must be 'RGBA', 'I420' or 'NV12'")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
-  output_frame_ = ffmpeg::make_frame();
+  // A new configuration synthesises a new pool.
+  pool_.clear();
 
   state_ = "configured";
   return env.Undefined();
@@ -128,19 +143,45 @@ bool TestVideoGenerator::InitFilterGraph() {
                                          nullptr, filter_graph_.get());
   if (ret < 0) return false;
 
+  // Convert to the output format inside the graph
+  AVFilterContext* format_ctx = nullptr;
+  snprintf(args, sizeof(args), "pix_fmts=%s", av_get_pix_fmt_name(format_));
+  ret = avfilter_graph_create_filter(&format_ctx,
+                                     avfilter_get_by_name("format"), "format",
+                                     args, nullptr, filter_graph_.get());
+  if (ret < 0) return false;
+
   // Create buffersink
   ret = avfilter_graph_create_filter(&buffersink_ctx_, buffersink, "out",
                                      nullptr, nullptr, filter_graph_.get());
   if (ret < 0) return false;
 
-  // Link testsrc -> buffersink
-  ret = avfilter_link(testsrc_ctx, 0, buffersink_ctx_, 0);
+  // Link testsrc -> format -> buffersink
+  ret = avfilter_link(testsrc_ctx, 0, format_ctx, 0);
+  if (ret < 0) return false;
+  ret = avfilter_link(format_ctx, 0, buffersink_ctx_, 0);
   if (ret < 0) return false;
 
   ret = avfilter_graph_config(filter_graph_.get(), nullptr);
   return ret >= 0;
 }
 
+bool TestVideoGenerator::FillPool() {
+  if (!InitFilterGraph()) {
+    return false;
+  }
+  while (static_cast<int>(pool_.size()) < pool_size_) {
+    ffmpeg::AVFramePtr frame = ffmpeg::make_frame();
+    if (!frame || av_buffersink_get_frame(buffersink_ctx_, frame.get()) < 0) {
+      break;  // The graph's duration is shorter than the pool
+    }
+    pool_.push_back(std::move(frame));
+  }
+  filter_graph_.reset();
+  buffersink_ctx_ = nullptr;
+  return !pool_.empty();
+}
+
 Napi::Value TestVideoGenerator::Generate(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -158,50 +199,53 @@ Napi::Value TestVideoGenerator::Generate(const Napi::CallbackInfo& info) {
 
   Napi::Function callback = info[0].As<Napi::Function>();
 
-  // Initialize filter graph
-  if (!InitFilterGraph()) {
+  // Initialize filter graph, or the pool synthesised from it
+  bool ready = pool_size_ > 0 ? (!pool_.empty() || FillPool())
+                              : InitFilterGraph();
+  if (!ready) {
     Napi::Error::New(env, "Failed to initialize filter graph")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
-  // Generate frames
-  int64_t frame_count = 0;
-  size_t output_size = width_ * height_ * 4;
-
-  while (true) {
-    av_frame_unref(output_frame_.get());
-    int ret = av_buffersink_get_frame(buffersink_ctx_, output_frame_.get());
-
-    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-      break;
+  // Generate frames. VideoFrames adopt the frames' refcounted planes; pool
+  // frames are shared, never copied.
+  int64_t total_frames = static_cast<int64_t>(duration_) * frame_rate_;
+  for (int64_t frame_count = 0;; frame_count++) {
+    ffmpeg::AVFramePtr frame;
+    if (!pool_.empty()) {
+      if (frame_count >= total_frames) {
+        break;
+      }
+      frame.reset(av_frame_clone(pool_[frame_count % pool_.size()].get()));
+      if (!frame) {
+        Napi::Error::New(env, "Failed to reference pooled frame")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+    } else {
+      frame = ffmpeg::make_frame();
+      int ret = frame ? av_buffersink_get_frame(buffersink_ctx_, frame.get())
+                      : AVERROR(ENOMEM);
+      if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        break;
+      }
+      if (ret < 0) {
+        Napi::Error::New(env, "Error getting frame from filter")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
     }
-    if (ret < 0) {
-      Napi::Error::New(env, "Error getting frame from filter")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
-    }
-
-    // Convert YUV420P to RGBA
-    Napi::Buffer<uint8_t> output_buffer =
-        Napi::Buffer<uint8_t>::New(env, output_size);
-    uint8_t* output_data = output_buffer.Data();
-    uint8_t* dst_slices[1] = {output_data};
-    int dst_stride[1] = {width_ * 4};
-
-    sws_scale(sws_yuv_to_rgba_.get(), output_frame_->data,
-              output_frame_->linesize, 0, height_, dst_slices, dst_stride);
 
     // Calculate timestamp in microseconds
     int64_t timestamp = (frame_count * 1000000) / frame_rate_;
 
     // Create VideoFrame
-    Napi::Value frame = VideoFrame::CreateInstance(
-        env, output_data, output_size, width_, height_, timestamp, "RGBA");
+    Napi::Value video_frame = VideoFrame::CreateInstance(
+        env, std::move(frame), timestamp, 0, false, width_, height_);
 
     // Call callback with frame
-    callback.Call({frame});
-    frame_count++;
+    callback.Call({video_frame});
   }
 
   // Return a resolved promise
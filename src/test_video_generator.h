@@ -11,10 +11,10 @@ extern "C" {
 #include <libavfilter/buffersink.h>
 #include <libavfilter/buffersrc.h>
 #include <libavutil/frame.h>
-#include <libswscale/swscale.h>
 }
 
 #include <string>
+#include <vector>
 
 #include "src/ffmpeg_raii.h"
 
@@ -33,15 +33,22 @@ class TestVideoGenerator : public Napi::ObjectWrap<TestVideoGenerator> {
   void Cleanup();
   bool InitFilterGraph();
 
+  // Pull up to pool_size_ frames from the filter graph into pool_.
+  bool FillPool();
+
   ffmpeg::AVFilterGraphPtr filter_graph_;
   AVFilterContext* buffersink_ctx_;
-  ffmpeg::SwsContextPtr sws_yuv_to_rgba_;
-  ffmpeg::AVFramePtr output_frame_;
+
+  // Frames generate() cycles through when pool_size_ > 0, synthesised
+  // once. Emitted frames share their (read-only) planes.
+  std::vector<ffmpeg::AVFramePtr> pool_;
 
   int width_;
   int height_;
   int frame_rate_;
   int duration_;
+  int pool_size_;
+  AVPixelFormat format_;
   std::string pattern_;
   std::string state_;
 };
@@ -0,0 +1,214 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// ThreadPlacement implementation.
+
+#include "src/thread_placement.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+#ifdef __APPLE__
+#include <pthread/qos.h>
+#endif
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace webcodecs {
+
+namespace {
+
+thread_local int current_numa_node = -1;
+
+[[maybe_unused]] std::string ErrorMessage(const char* what, int errnum) {
+  return std::string(what) + ": " + std::strerror(errnum);
+}
+
+#ifdef __linux__
+// From <linux/mempolicy.h>, which needs kernel headers.
+constexpr int kMpolPreferred = 1;
+
+int NiceValue(ThreadPriority priority) {
+  switch (priority) {
+    case ThreadPriority::kBackground:
+      return 19;
+    case ThreadPriority::kLow:
+      return 10;
+    case ThreadPriority::kHigh:
+      return -10;
+    case ThreadPriority::kNormal:
+      break;
+  }
+  return 0;
+}
+
+bool ReadNodeCpuList(int node, std::string* list) {
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) +
+                     "/cpulist");
+  if (!file) {
+    return false;
+  }
+  std::getline(file, *list);
+  return true;
+}
+#endif  // __linux__
+
+#ifdef __APPLE__
+qos_class_t QosClass(ThreadPriority priority) {
+  switch (priority) {
+    case ThreadPriority::kBackground:
+      return QOS_CLASS_BACKGROUND;
+    case ThreadPriority::kLow:
+      return QOS_CLASS_UTILITY;
+    case ThreadPriority::kHigh:
+      return QOS_CLASS_USER_INTERACTIVE;
+    case ThreadPriority::kNormal:
+      break;
+  }
+  return QOS_CLASS_DEFAULT;
+}
+#endif  // __APPLE__
+
+}  // namespace
+
+bool ParseCpuList(const std::string& list, std::vector<int>* cpus) {
+  cpus->clear();
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    range.erase(range.find_last_not_of(" \t\r\n") + 1);
+    if (range.empty()) {
+      return cpus->empty() && stream.eof();  // A node without CPUs
+    }
+    char* end = nullptr;
+    long first = std::strtol(range.c_str(), &end, 10);
+    long last = first;
+    if (end == range.c_str() || first < 0) {
+      return false;
+    }
+    if (*end == '-') {
+      const char* start = end + 1;
+      last = std::strtol(start, &end, 10);
+      if (end == start || last < first) {
+        return false;
+      }
+    }
+    if (*end != '\0') {
+      return false;
+    }
+    for (long cpu = first; cpu <= last; ++cpu) {
+      cpus->push_back(static_cast<int>(cpu));
+    }
+  }
+  return true;
+}
+
+std::vector<int> NumaNodeCpus(int node) {
+  std::vector<int> cpus;
+#ifdef __linux__
+  std::string list;
+  if (node >= 0 && ReadNodeCpuList(node, &list) && !ParseCpuList(list, &cpus)) {
+    cpus.clear();
+  }
+#else
+  (void)node;
+#endif
+  return cpus;
+}
+
+bool ValidateThreadPlacement(const ThreadPlacement& placement,
+                             std::string* error) {
+  long configured = sysconf(_SC_NPROCESSORS_CONF);
+  for (int cpu : placement.cpus) {
+    bool exists = cpu >= 0 && (configured <= 0 || cpu < configured);
+#ifdef __linux__
+    exists = exists && cpu < CPU_SETSIZE;
+#endif
+    if (!exists) {
+      *error = "threading.cpus: no CPU " + std::to_string(cpu) +
+               " on this machine";
+      return false;
+    }
+  }
+#ifdef __linux__
+  std::string list;
+  if (placement.numa_node >= 0 &&
+      !ReadNodeCpuList(placement.numa_node, &list)) {
+    *error = "threading.numaNode: no NUMA node " +
+             std::to_string(placement.numa_node) + " on this machine";
+    return false;
+  }
+#endif
+  return true;
+}
+
+bool ApplyThreadPlacement(const ThreadPlacement& placement,
+                          std::string* error) {
+#ifdef __linux__
+  std::vector<int> cpus = placement.cpus;
+  if (cpus.empty() && placement.numa_node >= 0) {
+    cpus = NumaNodeCpus(placement.numa_node);
+  }
+  if (!cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+      CPU_SET(cpu, &set);
+    }
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (ret != 0) {
+      *error = ErrorMessage("sched_setaffinity", ret);
+      return false;
+    }
+  }
+
+  if (placement.numa_node >= 0) {
+    // Preferred rather than bound, so allocations fall back to other nodes
+    // instead of failing once this one is full.
+    constexpr int kBitsPerLong = 8 * sizeof(unsigned long);
+    unsigned long mask[kMaxNumaNodes / kBitsPerLong] = {};
+    mask[placement.numa_node / kBitsPerLong] |=
+        1UL << (placement.numa_node % kBitsPerLong);
+    if (syscall(SYS_set_mempolicy, kMpolPreferred, mask,
+                static_cast<unsigned long>(kMaxNumaNodes + 1)) != 0) {
+      *error = ErrorMessage("set_mempolicy", errno);
+      return false;
+    }
+    current_numa_node = placement.numa_node;
+  }
+
+  if (placement.priority != ThreadPriority::kNormal) {
+    // Nice values are per thread on Linux.
+    auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    if (setpriority(PRIO_PROCESS, tid, NiceValue(placement.priority)) != 0) {
+      *error = ErrorMessage("setpriority", errno);
+      return false;
+    }
+  }
+#elif defined(__APPLE__)
+  if (placement.priority != ThreadPriority::kNormal) {
+    int ret = pthread_set_qos_class_self_np(QosClass(placement.priority), 0);
+    if (ret != 0) {
+      *error = ErrorMessage("pthread_set_qos_class_self_np", ret);
+      return false;
+    }
+  }
+#else
+  (void)placement;
+  (void)error;
+#endif
+  return true;
+}
+
+int CurrentNumaNode() { return current_numa_node; }
+
+}  // namespace webcodecs
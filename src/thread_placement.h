@@ -0,0 +1,75 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// ThreadPlacement - CPU affinity, scheduling priority and NUMA node of a
+// codec worker thread, from the non-standard `threading` config member.
+//
+// Applied by the worker thread to itself before it opens the codec. On Linux
+// CPU affinity, nice value and memory policy are inherited by the threads it
+// creates afterwards, so FFmpeg's frame and slice threads land on the same
+// CPUs and allocate from the same node. Elsewhere:
+// - macOS: priority maps to a QoS class of the worker thread; it has no
+//   affinity or NUMA API, so cpus and numaNode are ignored.
+// - Other platforms: ignored.
+
+#ifndef SRC_THREAD_PLACEMENT_H_
+#define SRC_THREAD_PLACEMENT_H_
+
+#include <string>
+#include <vector>
+
+namespace webcodecs {
+
+enum class ThreadPriority {
+  kNormal,      // Leave as created
+  kBackground,  // Linux nice 19, macOS QOS_CLASS_BACKGROUND
+  kLow,         // Linux nice 10, macOS QOS_CLASS_UTILITY
+  kHigh,        // Linux nice -10 (needs CAP_SYS_NICE), macOS
+                // QOS_CLASS_USER_INTERACTIVE
+};
+
+struct ThreadPlacement {
+  std::vector<int> cpus;  // Empty = any CPU (or the NUMA node's CPUs)
+  ThreadPriority priority = ThreadPriority::kNormal;
+  int numa_node = -1;  // -1 = no preference
+
+  bool IsDefault() const {
+    return cpus.empty() && priority == ThreadPriority::kNormal &&
+           numa_node < 0;
+  }
+  bool operator==(const ThreadPlacement& other) const {
+    return cpus == other.cpus && priority == other.priority &&
+           numa_node == other.numa_node;
+  }
+  bool operator!=(const ThreadPlacement& other) const {
+    return !(*this == other);
+  }
+};
+
+// Highest NUMA node accepted, plus one.
+constexpr int kMaxNumaNodes = 64;
+
+// Check |placement| against this machine: CPUs must exist and the NUMA node
+// must be present. Returns false and sets |error| otherwise.
+bool ValidateThreadPlacement(const ThreadPlacement& placement,
+                             std::string* error);
+
+// Apply |placement| to the calling thread. Returns false and sets |error|
+// when a setting is refused (for example raising priority without
+// privileges); settings applied before it are kept.
+bool ApplyThreadPlacement(const ThreadPlacement& placement, std::string* error);
+
+// NUMA node the calling thread's memory is placed on by
+// ApplyThreadPlacement(), or -1 when it has no preference.
+int CurrentNumaNode();
+
+// CPUs of NUMA node |node|, or empty when unknown (no such node, not Linux).
+std::vector<int> NumaNodeCpus(int node);
+
+// Parse a kernel CPU list such as "0-3,8,10-11" into |cpus|. Returns false
+// when malformed.
+bool ParseCpuList(const std::string& list, std::vector<int>* cpus);
+
+}  // namespace webcodecs
+
+#endif  // SRC_THREAD_PLACEMENT_H_
@@ -0,0 +1,46 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#include "src/transfer_registry.h"
+
+#include <utility>
+
+namespace webcodecs {
+
+TransferRegistry& TransferRegistry::Instance() {
+  // Leaked intentionally: a worker may still claim or release a handle
+  // while the main environment's static destructors run.
+  static TransferRegistry* instance = new TransferRegistry();
+  return *instance;
+}
+
+uint64_t TransferRegistry::Put(TransferPayload payload) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t handle = next_handle_++;
+  entries_.emplace(handle, std::move(payload));
+  return handle;
+}
+
+bool TransferRegistry::Take(uint64_t handle, TransferPayload* payload) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(handle);
+  if (it == entries_.end()) {
+    return false;
+  }
+  *payload = std::move(it->second);
+  entries_.erase(it);
+  return true;
+}
+
+bool TransferRegistry::Release(uint64_t handle) {
+  TransferPayload payload;
+  // Freed outside the lock; dropping frames may return buffers to pools.
+  return Take(handle, &payload);
+}
+
+size_t TransferRegistry::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+}  // namespace webcodecs
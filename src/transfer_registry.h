@@ -0,0 +1,69 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// TransferRegistry - process-wide parking lot for media payloads moving
+// between worker_threads.
+//
+// N-API objects belong to one environment, but the AVFrame, AVPacket and
+// packed buffers behind VideoFrame, AudioData and the chunk classes are
+// plain process memory. detach() moves an object's storage in here and
+// returns a numeric handle that survives postMessage(); the receiving
+// environment takes the payload back out with that handle and wraps it in
+// its own object. Nothing is copied on either side, and each handle can be
+// claimed exactly once.
+
+#ifndef SRC_TRANSFER_REGISTRY_H_
+#define SRC_TRANSFER_REGISTRY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "src/ffmpeg_raii.h"
+
+namespace webcodecs {
+
+// Storage of one detached object. Exactly one member is set, matching the
+// storage the object was using.
+struct TransferPayload {
+  ffmpeg::AVFramePtr frame;    // Refcounted VideoFrame/AudioData planes
+  ffmpeg::AVPacketPtr packet;  // Encoded chunk payload
+  std::vector<uint8_t> data;   // Packed VideoFrame/AudioData buffer
+};
+
+class TransferRegistry {
+ public:
+  static TransferRegistry& Instance();
+
+  // Disallow copy and assign.
+  TransferRegistry(const TransferRegistry&) = delete;
+  TransferRegistry& operator=(const TransferRegistry&) = delete;
+
+  // Park |payload| and return its handle. Handles start at 1, are never
+  // reused and stay below 2^53, so they round-trip through a JS number.
+  uint64_t Put(TransferPayload payload);
+
+  // Move the payload for |handle| into |payload|. Returns false if the
+  // handle is unknown or was already taken or released.
+  bool Take(uint64_t handle, TransferPayload* payload);
+
+  // Free the payload for |handle| without claiming it (e.g. the message
+  // carrying it was never delivered). Returns false if it was not parked.
+  bool Release(uint64_t handle);
+
+  // Payloads parked and not yet claimed.
+  size_t size() const;
+
+ private:
+  TransferRegistry() = default;
+
+  mutable std::mutex mutex_;
+  uint64_t next_handle_ = 1;
+  std::unordered_map<uint64_t, TransferPayload> entries_;
+};
+
+}  // namespace webcodecs
+
+#endif  // SRC_TRANSFER_REGISTRY_H_
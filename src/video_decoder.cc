@@ -8,6 +8,7 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -19,6 +20,45 @@ namespace {
 
 constexpr int kMaxDimension = 16384;
 
+// Parse the decode-skip options (node-webcodecs extension): skipFrames
+// ('none', 'nonref' or 'nonkey'), skipLoopFilter and skipIdct. Returns
+// false with |error| set when one is malformed.
+bool ParseDecodeSkip(Napi::Object config, webcodecs::DecodeSkipConfig* out,
+                     std::string* error) {
+  static const std::unordered_map<std::string, AVDiscard> kSkipFrames = {
+      {"none", AVDISCARD_DEFAULT},
+      {"nonref", AVDISCARD_NONREF},
+      {"nonkey", AVDISCARD_NONKEY},
+  };
+  if (webcodecs::HasAttr(config, "skipFrames")) {
+    Napi::Value value = config.Get("skipFrames");
+    auto it = value.IsString()
+                  ? kSkipFrames.find(value.As<Napi::String>().Utf8Value())
+                  : kSkipFrames.end();
+    if (it == kSkipFrames.end()) {
+      *error = "skipFrames must be 'none', 'nonref' or 'nonkey'";
+      return false;
+    }
+    out->frames = it->second;
+  }
+  // The boolean levels skip the stage on every frame.
+  auto parse_flag = [&](const char* name, AVDiscard* level) {
+    if (!webcodecs::HasAttr(config, name)) {
+      return true;
+    }
+    Napi::Value value = config.Get(name);
+    if (!value.IsBoolean()) {
+      *error = std::string(name) + " must be a boolean";
+      return false;
+    }
+    *level =
+        value.As<Napi::Boolean>().Value() ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+    return true;
+  };
+  return parse_flag("skipLoopFilter", &out->loop_filter) &&
+         parse_flag("skipIdct", &out->idct);
+}
+
 }  // namespace
 
 Napi::Object InitVideoDecoder(Napi::Env env, Napi::Object exports) {
@@ -31,6 +71,7 @@ Napi::Object VideoDecoder::Init(Napi::Env env, Napi::Object exports) {
       {
           InstanceMethod("configure", &VideoDecoder::Configure),
           InstanceMethod("decode", &VideoDecoder::Decode),
+          InstanceMethod("decodeBatch", &VideoDecoder::DecodeBatch),
           InstanceMethod("flush", &VideoDecoder::Flush),
           InstanceMethod("reset", &VideoDecoder::Reset),
           InstanceMethod("close", &VideoDecoder::Close),
@@ -41,6 +82,8 @@ Napi::Object VideoDecoder::Init(Napi::Env env, Napi::Object exports) {
                            nullptr),
           InstanceAccessor("pendingFrames", &VideoDecoder::GetPendingFrames,
                            nullptr),
+          InstanceMethod("getStats", &VideoDecoder::GetStats),
+          InstanceMethod("resetStats", &VideoDecoder::ResetStats),
           StaticMethod("isConfigSupported", &VideoDecoder::IsConfigSupported),
       });
 
@@ -76,6 +119,12 @@ VideoDecoder::VideoDecoder(const Napi::CallbackInfo& info)
 
   output_callback_ = Napi::Persistent(init.Get("output").As<Napi::Function>());
   error_callback_ = Napi::Persistent(init.Get("error").As<Napi::Function>());
+  // Runs when a decode() turned away by the 'block' policy may be retried.
+  if (webcodecs::HasAttr(init, "dequeue") &&
+      init.Get("dequeue").IsFunction()) {
+    dequeue_callback_ =
+        Napi::Persistent(init.Get("dequeue").As<Napi::Function>());
+  }
 }
 
 VideoDecoder::~VideoDecoder() {
@@ -88,34 +137,40 @@ VideoDecoder::~VideoDecoder() {
 }
 
 void VideoDecoder::Cleanup() {
-  // Stop worker first
-  if (worker_) {
-    worker_->Stop();
-    worker_.reset();
-  }
-
-  // Shutdown control queue
-  if (control_queue_) {
-    control_queue_->Shutdown();
-    control_queue_.reset();
-  }
+  // No output reaches JS from here on, as if the worker had been joined.
+  RetireWorker();
 
   // Release TSFNs
   frame_tsfn_.Release();
   flush_tsfn_.Release();
   error_tsfn_.Release();
-  dequeue_tsfn_.Release();
+  dequeue_notifier_.Release();
 
   // Clear pending promises
   pending_flushes_.clear();
 }
 
+void VideoDecoder::RetireWorker() {
+  if (output_gate_) {
+    output_gate_->Close();
+    output_gate_.reset();
+  }
+  // The worker exits after the message in progress, on the reaper thread.
+  if (control_queue_) {
+    control_queue_->Shutdown();
+  }
+  webcodecs::CodecReaper::Instance().Retire(std::move(worker_),
+                                            std::move(control_queue_));
+}
+
 void VideoDecoder::SetupWorkerCallbacks(Napi::Env env) {
-  // Capture 'this' pointer and metadata config for callbacks
+  // Capture 'this' pointer and metadata config for callbacks. The gate
+  // keeps the callbacks from touching it once the worker is retired.
   auto* self = this;
+  webcodecs::OutputGate& gate = *output_gate_;
 
   // Set output frame callback
-  worker_->SetOutputFrameCallback([self](ffmpeg::AVFramePtr frame) {
+  worker_->SetOutputFrameCallback(gate.Guard([self](ffmpeg::AVFramePtr frame) {
     // Create callback data with frame and metadata
     auto* data = new FrameCallbackData();
     data->frame = std::move(frame);
@@ -135,33 +190,28 @@ void VideoDecoder::SetupWorkerCallbacks(Napi::Env env) {
       self->pending_frames_--;
       delete data;
     }
-  });
+  }));
 
   // Set error callback
   worker_->SetOutputErrorCallback(
-      [self](int error_code, const std::string& message) {
+      gate.Guard([self](int error_code, const std::string& message) {
         auto* data = new ErrorCallbackData{error_code, message};
         if (!self->error_tsfn_.Call(data)) {
           delete data;
         }
-      });
+      }));
 
   // Set flush complete callback
-  worker_->SetFlushCompleteCallback(
+  worker_->SetFlushCompleteCallback(gate.Guard(
       [self](uint32_t promise_id, bool success, const std::string& error) {
         auto* data = new FlushCallbackData{promise_id, success, error, self};
         if (!self->flush_tsfn_.Call(data)) {
           delete data;
         }
-      });
+      }));
 
-  // Set dequeue callback
-  worker_->SetDequeueCallback([self](uint32_t new_queue_size) {
-    auto* data = new uint32_t(new_queue_size);
-    if (!self->dequeue_tsfn_.Call(data)) {
-      delete data;
-    }
-  });
+  worker_->SetDequeueCallback(gate.Guard(
+      [self](uint32_t) { self->dequeue_notifier_.Notify(); }));
 }
 
 // TSFN callback: handle decoded frame on JS thread
@@ -198,26 +248,29 @@ void VideoDecoder::OnFrameCallback(Napi::Env env, Napi::Function fn,
     int display_height =
         frame->sample_aspect_ratio.den > 0 ? frame->sample_aspect_ratio.den : height;
 
-    // Get rotation and flip from opaque (encoded by worker)
-    intptr_t opaque_val = reinterpret_cast<intptr_t>(frame->opaque);
-    int rotation = static_cast<int>((opaque_val >> 1) & 0x3) * 90;
-    bool flip = (opaque_val & 1) != 0;
+    // Rotation and flip come from the configure-time metadata.
+    int rotation = data->metadata.rotation;
+    bool flip = data->metadata.flip;
 
-    // Frame data is already in RGBA format
-    size_t data_size = width * height * 4;
+    // The VideoFrame adopts the decoded AVFrame's refcounted planes; no
+    // pixel data is copied. Native-format frames keep the decoder's layout
+    // (I420, NV12, ...); everything else arrives as RGBA. Reset the side
+    // channel so the display size is not mistaken for a sample aspect ratio
+    // if the frame is re-encoded.
+    frame->sample_aspect_ratio = AVRational{0, 1};
 
     // Create VideoFrame
     Napi::Object video_frame;
     if (data->metadata.has_color_space) {
       video_frame = VideoFrame::CreateInstance(
-          env, frame->data[0], data_size, width, height, timestamp, "RGBA",
-          rotation, flip, display_width, display_height,
-          data->metadata.color_primaries, data->metadata.color_transfer,
-          data->metadata.color_matrix, data->metadata.color_full_range);
+          env, std::move(data->frame), timestamp, rotation, flip,
+          display_width, display_height, data->metadata.color_primaries,
+          data->metadata.color_transfer, data->metadata.color_matrix,
+          data->metadata.color_full_range);
     } else {
       video_frame = VideoFrame::CreateInstance(
-          env, frame->data[0], data_size, width, height, timestamp, "RGBA",
-          rotation, flip, display_width, display_height);
+          env, std::move(data->frame), timestamp, rotation, flip,
+          display_width, display_height);
     }
 
     fn.Call({video_frame});
@@ -277,20 +330,6 @@ void VideoDecoder::OnErrorCallback(Napi::Env env, Napi::Function fn,
   delete data;
 }
 
-// TSFN callback: handle dequeue event on JS thread
-void VideoDecoder::OnDequeueCallback(Napi::Env env, Napi::Function /* fn */,
-                                     std::nullptr_t*, uint32_t* data) {
-  if (env == nullptr || data == nullptr) {
-    delete data;
-    return;
-  }
-
-  // Note: Queue size update is handled internally
-  // This callback allows future extensions (e.g., dequeue event emission)
-
-  delete data;
-}
-
 Napi::Value VideoDecoder::Configure(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -374,6 +413,15 @@ Napi::Value VideoDecoder::Configure(const Napi::CallbackInfo& info) {
   optimize_for_latency_ =
       webcodecs::AttrAsBool(config, "optimizeForLatency", false);
 
+  // Parse optional outputFormat (node-webcodecs extension).
+  std::string output_format =
+      webcodecs::AttrAsStr(config, "outputFormat", "RGBA");
+  if (output_format != "RGBA" && output_format != "native") {
+    throw Napi::TypeError::New(env,
+                               "outputFormat must be 'RGBA' or 'native'");
+  }
+  native_output_ = output_format == "native";
+
   // Parse optional hardwareAcceleration (per W3C spec).
   hardware_acceleration_ =
       webcodecs::AttrAsStr(config, "hardwareAcceleration", "no-preference");
@@ -386,6 +434,42 @@ Napi::Value VideoDecoder::Configure(const Napi::CallbackInfo& info) {
         "or 'prefer-software'");
   }
 
+  // Parse optional threading (node-webcodecs extension).
+  std::string threading_error;
+  if (!webcodecs::ParseThreadingConfig(config, &threading_, &threading_error)) {
+    throw Napi::TypeError::New(env, threading_error);
+  }
+
+  // Parse optional RGBA conversion quality (node-webcodecs extension).
+  webcodecs::ScalingConfig scaling;
+  std::string scaling_error;
+  if (!webcodecs::ParseScalingConfig(config, &scaling, &scaling_error)) {
+    throw Napi::TypeError::New(env, scaling_error);
+  }
+
+  // Parse optional output batching (node-webcodecs extension).
+  int output_batch_size = 1;
+  std::string batch_error;
+  if (!webcodecs::ParseOutputBatchSize(config, &output_batch_size,
+                                       &batch_error)) {
+    throw Napi::TypeError::New(env, batch_error);
+  }
+
+  // Parse optional queue limits (node-webcodecs extension).
+  webcodecs::QueueLimits queue_limits;
+  std::string limits_error;
+  if (!webcodecs::ParseQueueLimits(config, &queue_limits, &limits_error)) {
+    throw Napi::TypeError::New(env, limits_error);
+  }
+  queue_limits_ = queue_limits;
+
+  // Parse optional decode-skip levels (node-webcodecs extension).
+  webcodecs::DecodeSkipConfig skip;
+  std::string skip_error;
+  if (!ParseDecodeSkip(config, &skip, &skip_error)) {
+    throw Napi::TypeError::New(env, skip_error);
+  }
+
   // Handle optional description (extradata / SPS+PPS for H.264).
   auto [desc_data, desc_size] = webcodecs::AttrAsBuffer(config, "description");
   std::vector<uint8_t> extradata;
@@ -393,15 +477,17 @@ Napi::Value VideoDecoder::Configure(const Napi::CallbackInfo& info) {
     extradata.assign(desc_data, desc_data + desc_size);
   }
 
-  // Create control queue and worker
+  // Create control queue and worker, retiring any previous one
+  RetireWorker();
   control_queue_ = std::make_unique<webcodecs::VideoControlQueue>();
   worker_ =
       std::make_unique<webcodecs::VideoDecoderWorker>(control_queue_.get());
+  output_gate_ = webcodecs::OutputGate::Create();
 
   // Create TSFNs for callbacks
   auto frame_tsfn = FrameTSFN::TSFN::New(
       env, output_callback_.Value(), "VideoDecoderFrame", 0, 1);
-  frame_tsfn_.Init(std::move(frame_tsfn));
+  frame_tsfn_.Init(std::move(frame_tsfn), output_batch_size, stats_.get());
 
   // Create a dummy function for flush TSFN since we use stored deferred
   // Note: We'll handle flush completion via a different mechanism
@@ -414,10 +500,7 @@ Napi::Value VideoDecoder::Configure(const Napi::CallbackInfo& info) {
                                          "VideoDecoderError", 0, 1);
   error_tsfn_.Init(std::move(error_tsfn));
 
-  auto dequeue_fn = Napi::Function::New(env, [](const Napi::CallbackInfo&) {});
-  auto dequeue_tsfn =
-      DequeueTSFN::TSFN::New(env, dequeue_fn, "VideoDecoderDequeue", 0, 1);
-  dequeue_tsfn_.Init(std::move(dequeue_tsfn));
+  dequeue_notifier_.Init(env, dequeue_callback_, "VideoDecoderDequeue");
 
   // Setup worker callbacks
   SetupWorkerCallbacks(env);
@@ -429,6 +512,10 @@ Napi::Value VideoDecoder::Configure(const Napi::CallbackInfo& info) {
   decoder_config.coded_height = coded_height_;
   decoder_config.extradata = std::move(extradata);
   decoder_config.optimize_for_latency = optimize_for_latency_;
+  decoder_config.native_output = native_output_;
+  decoder_config.hw_accel = hardware_acceleration_;
+  decoder_config.threading = threading_;
+  decoder_config.scaling = scaling;
   decoder_config.metadata.rotation = rotation_;
   decoder_config.metadata.flip = flip_;
   decoder_config.metadata.display_width = display_aspect_width_;
@@ -438,9 +525,14 @@ Napi::Value VideoDecoder::Configure(const Napi::CallbackInfo& info) {
   decoder_config.metadata.color_matrix = color_matrix_;
   decoder_config.metadata.color_full_range = color_full_range_;
   decoder_config.metadata.has_color_space = has_color_space_;
+  decoder_config.skip = skip;
+  skip_delta_frames_ = skip.frames == AVDISCARD_NONKEY;
 
   worker_->SetConfig(decoder_config);
 
+  worker_->SetStats(stats_);
+  worker_->SetPlacement(threading_.placement);
+
   // Start worker
   if (!worker_->Start()) {
     throw Napi::Error::New(env, "Failed to start decoder worker");
@@ -456,6 +548,7 @@ Napi::Value VideoDecoder::Configure(const Napi::CallbackInfo& info) {
 
   state_ = "configured";
   key_chunk_required_ = true;
+  drop_until_key_ = false;
 
   return env.Undefined();
 }
@@ -483,6 +576,14 @@ Napi::Value VideoDecoder::GetPendingFrames(const Napi::CallbackInfo& info) {
   return Napi::Number::New(info.Env(), pending_frames_.load());
 }
 
+Napi::Value VideoDecoder::GetStats(const Napi::CallbackInfo& info) {
+  return webcodecs::CodecStatsToObject(info.Env(), *stats_);
+}
+
+void VideoDecoder::ResetStats(const Napi::CallbackInfo& info) {
+  stats_->Reset();
+}
+
 Napi::Value VideoDecoder::Decode(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -490,67 +591,217 @@ Napi::Value VideoDecoder::Decode(const Napi::CallbackInfo& info) {
     throw Napi::Error::New(env, "InvalidStateError: Decoder not configured");
   }
 
-  // Reject if queue is too large (prevents OOM).
-  if (control_queue_ && control_queue_->size() >= kMaxHardQueueSize) {
-    throw Napi::Error::New(
-        env,
-        "QuotaExceededError: Decode queue is full. You must handle "
-        "backpressure by waiting for decodeQueueSize to decrease.");
-  }
-
   if (info.Length() < 1 || !info[0].IsObject()) {
     throw Napi::Error::New(env, "decode requires EncodedVideoChunk");
   }
 
+  return Napi::Number::New(
+      env, DecodeChunk(env, info[0].As<Napi::Object>(),
+                       info.Length() >= 2 ? info[1] : env.Undefined(),
+                       nullptr));
+}
+
+Napi::Value VideoDecoder::DecodeBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (state_ != "configured") {
+    throw Napi::Error::New(env, "InvalidStateError: Decoder not configured");
+  }
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    throw Napi::TypeError::New(
+        env, "decodeBatch requires an array of EncodedVideoChunks");
+  }
+  Napi::Array chunks = info[0].As<Napi::Array>();
+  Napi::Array options = info.Length() >= 2 && info[1].IsArray()
+                            ? info[1].As<Napi::Array>()
+                            : Napi::Array();
+
+  // Chunks are staged and enqueued under one lock. Returns [chunks
+  // consumed, requests dropped]; a 'block' policy stop leaves the rest to
+  // the JS layer.
+  Staged staged;
+  uint32_t consumed = 0;
+  int dropped = 0;
+  try {
+    for (; consumed < chunks.Length(); ++consumed) {
+      Napi::Value chunk = chunks.Get(consumed);
+      if (!chunk.IsObject()) {
+        throw Napi::Error::New(env, "decode requires EncodedVideoChunk");
+      }
+      int result = DecodeChunk(
+          env, chunk.As<Napi::Object>(),
+          options.IsEmpty() ? env.Undefined() : options.Get(consumed),
+          &staged);
+      if (result < 0) {
+        break;
+      }
+      dropped += result;
+    }
+  } catch (const Napi::Error&) {
+    // Chunks before the failing one stay queued, as with decode() calls.
+    size_t count = staged.size();
+    if (control_queue_->EnqueueAll(staged.Take())) {
+      webcodecs::counterQueue += static_cast<int>(count);
+    }
+    throw;
+  }
+  EnqueueStaged(env, &staged);
+
+  Napi::Array result = Napi::Array::New(env, 2);
+  result.Set(0u, Napi::Number::New(env, consumed));
+  result.Set(1u, Napi::Number::New(env, dropped));
+  return result;
+}
+
+void VideoDecoder::EnqueueStaged(Napi::Env env, Staged* staged) {
+  size_t count = staged->size();
+  if (!control_queue_->EnqueueAll(staged->Take())) {
+    throw Napi::Error::New(env, "Failed to enqueue decode message");
+  }
+  webcodecs::counterQueue += static_cast<int>(count);
+}
+
+int VideoDecoder::DecodeChunk(Napi::Env env, Napi::Object chunk_obj,
+                              Napi::Value options, Staged* staged) {
   // Get EncodedVideoChunk.
   EncodedVideoChunk* chunk =
-      Napi::ObjectWrap<EncodedVideoChunk>::Unwrap(info[0].As<Napi::Object>());
+      Napi::ObjectWrap<EncodedVideoChunk>::Unwrap(chunk_obj);
 
-  // Get data from chunk.
-  const uint8_t* data = chunk->GetData();
-  size_t data_size = chunk->GetDataSize();
   int64_t timestamp = chunk->GetTimestampValue();
   bool is_key_frame = (chunk->GetTypeValue() == "key");
 
+  // Share the chunk's refcounted payload with the worker; no data is copied.
+  auto packet = chunk->RefPacket();
+  if (!packet) {
+    throw Napi::Error::New(env,
+                           "InvalidStateError: EncodedVideoChunk is closed");
+  }
+
   // Check key chunk requirement
   if (key_chunk_required_ && !is_key_frame) {
     // Per W3C spec, first chunk after configure/reset must be a key frame
     throw Napi::Error::New(
         env, "DataError: First chunk after configure/reset must be a key frame");
   }
-  if (is_key_frame) {
-    key_chunk_required_ = false;
+
+  // Refuse new work while native memory is over the soft limit set with
+  // setMemoryLimit() (node-webcodecs extension).
+  if (webcodecs::MemoryAccountant::Instance().OverSoftLimit()) {
+    throw Napi::Error::New(
+        env,
+        "QuotaExceededError: Native memory is over the soft limit. Close "
+        "frames and chunks you no longer need before decoding more.");
   }
 
-  // Create packet for decode message
-  auto packet = ffmpeg::make_packet();
-  if (!packet) {
-    throw Napi::Error::New(env, "Failed to allocate packet");
+  // A batch stops staging once its chunks would break the queue limits:
+  // they are enqueued and the limits then apply to this chunk as usual.
+  if (staged && !staged->empty() &&
+      QueueFull(static_cast<size_t>(packet->size), staged)) {
+    EnqueueStaged(env, staged);
   }
 
-  // Allocate buffer and copy data
-  int ret = av_new_packet(packet.get(), static_cast<int>(data_size));
-  if (ret < 0) {
-    throw Napi::Error::New(env, "Failed to allocate packet buffer");
+  // Apply the queue limits. Returns how many decode requests were dropped
+  // (including this one), or -1 when the 'block' policy wants the JS layer
+  // to retry once the queue drains.
+  int dropped = 0;
+  while (QueueFull(static_cast<size_t>(packet->size))) {
+    if (queue_limits_.policy == webcodecs::QueuePolicy::kBlock) {
+      // Look again after asking for a wake-up; the worker may have made
+      // room before it could see the request.
+      dequeue_notifier_.Request();
+      if (QueueFull(static_cast<size_t>(packet->size))) {
+        return -1;
+      }
+      break;
+    }
+    if (queue_limits_.policy == webcodecs::QueuePolicy::kReject) {
+      throw Napi::Error::New(
+          env,
+          "QuotaExceededError: Decode queue is full. You must handle "
+          "backpressure by waiting for decodeQueueSize to decrease.");
+    }
+    bool run_open = false;
+    size_t count = control_queue_->DropOldestDeltaRun(&run_open).size();
+    if (count == 0) {
+      // Only key chunks, in-flight packets or control messages fill the
+      // limit. Drop this chunk instead, or refuse a key chunk.
+      if (is_key_frame) {
+        throw Napi::Error::New(
+            env,
+            "QuotaExceededError: Decode queue is full and holds no delta "
+            "chunks to drop. Wait for decodeQueueSize to decrease.");
+      }
+      drop_until_key_ = true;  // Later deltas depend on this one
+      return dropped + 1;
+    }
+    webcodecs::counterQueue -= static_cast<int>(count);
+    dropped += static_cast<int>(count);
+    drop_until_key_ = drop_until_key_ || run_open;
   }
-  memcpy(packet->data, data, data_size);
-  packet->pts = timestamp;
-  packet->dts = timestamp;
+  if (drop_until_key_ && !is_key_frame) {
+    // The packet it depends on was dropped.
+    return dropped + 1;
+  }
+
   if (is_key_frame) {
-    packet->flags |= AV_PKT_FLAG_KEY;
+    key_chunk_required_ = false;
+    drop_until_key_ = false;
+  }
+
+  // Demuxed packets carry container timing; the decoder works in chunk
+  // microseconds.
+  packet->pts = timestamp;
+  packet->dts = chunk->GetDecodeTimestampValue();
+  packet->duration = 0;
+  packet->flags = is_key_frame ? AV_PKT_FLAG_KEY : 0;
+
+  // skipOutput (node-webcodecs extension): decode the chunk for reference
+  // but emit no frame for it, so seeking to a frame costs no conversions or
+  // VideoFrame allocations for the ones before it.
+  bool skip_output = options.IsObject() &&
+                     webcodecs::AttrAsBool(options.As<Napi::Object>(),
+                                           webcodecs::Key::kSkipOutput, false);
+  if (skip_output) {
+    packet->flags |= AV_PKT_FLAG_DISCARD;
+  }
+  // A chunk that will never produce a frame is reported with the dropped
+  // ones: the JS layer counts decodeQueueSize down on output.
+  if (skip_output || (skip_delta_frames_ && !is_key_frame)) {
+    ++dropped;
   }
 
   // Enqueue decode message
   webcodecs::VideoControlQueue::DecodeMessage decode_msg;
   decode_msg.packet = std::move(packet);
 
+  if (staged) {
+    staged->Add(std::move(decode_msg));
+    return dropped;  // Counted once enqueued
+  }
   if (!control_queue_->Enqueue(std::move(decode_msg))) {
     throw Napi::Error::New(env, "Failed to enqueue decode message");
   }
 
   webcodecs::counterQueue++;
 
-  return env.Undefined();
+  return dropped;
+}
+
+bool VideoDecoder::QueueFull(size_t incoming_bytes,
+                             const Staged* staged) const {
+  if (!control_queue_) {
+    return false;
+  }
+  size_t max_size =
+      queue_limits_.max_size > 0 ? queue_limits_.max_size : kMaxHardQueueSize;
+  if (control_queue_->size() + (staged ? staged->size() : 0) >= max_size) {
+    return true;
+  }
+  // An empty queue always takes one request, however large.
+  size_t queued_bytes = control_queue_->bytes() + (staged ? staged->bytes : 0);
+  return queue_limits_.max_bytes > 0 && queued_bytes > 0 &&
+         queued_bytes + incoming_bytes > queue_limits_.max_bytes;
 }
 
 Napi::Value VideoDecoder::Flush(const Napi::CallbackInfo& info) {
@@ -596,30 +847,14 @@ Napi::Value VideoDecoder::Reset(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  // Stop worker and clear queue
-  if (worker_) {
-    // Enqueue reset message to clear internal state (best-effort, ignore result)
-    if (control_queue_) {
-      webcodecs::VideoControlQueue::ResetMessage reset_msg;
-      (void)control_queue_->Enqueue(std::move(reset_msg));
-    }
-
-    // Stop the worker
-    worker_->Stop();
-    worker_.reset();
-  }
-
-  // Shutdown and recreate control queue
-  if (control_queue_) {
-    control_queue_->Shutdown();
-    control_queue_.reset();
-  }
+  // Drop queued decodes and the codec; the next configure() starts over.
+  RetireWorker();
 
   // Release TSFNs
   frame_tsfn_.Release();
   flush_tsfn_.Release();
   error_tsfn_.Release();
-  dequeue_tsfn_.Release();
+  dequeue_notifier_.Release();
 
   // Clear pending promises
   for (auto& [id, deferred] : pending_flushes_) {
@@ -634,6 +869,7 @@ Napi::Value VideoDecoder::Reset(const Napi::CallbackInfo& info) {
   decode_queue_size_ = 0;
   pending_frames_.store(0);
   key_chunk_required_ = true;
+  drop_until_key_ = false;
 
   return env.Undefined();
 }
@@ -667,28 +903,28 @@ Napi::Value VideoDecoder::IsConfigSupported(const Napi::CallbackInfo& info) {
 
     // Check if codec is supported.
     if (codec.find("avc1") == 0 || codec == "h264") {
-      const AVCodec* c = avcodec_find_decoder(AV_CODEC_ID_H264);
+      const AVCodec* c = webcodecs::FindDecoder(AV_CODEC_ID_H264);
       if (!c) {
         supported = false;
       }
     } else if (codec == "vp8") {
-      const AVCodec* c = avcodec_find_decoder(AV_CODEC_ID_VP8);
+      const AVCodec* c = webcodecs::FindDecoder(AV_CODEC_ID_VP8);
       if (!c) {
         supported = false;
       }
     } else if (codec.find("vp09") == 0 || codec == "vp9") {
-      const AVCodec* c = avcodec_find_decoder(AV_CODEC_ID_VP9);
+      const AVCodec* c = webcodecs::FindDecoder(AV_CODEC_ID_VP9);
       if (!c) {
         supported = false;
       }
     } else if (codec.find("av01") == 0 || codec == "av1") {
-      const AVCodec* c = avcodec_find_decoder(AV_CODEC_ID_AV1);
+      const AVCodec* c = webcodecs::FindDecoder(AV_CODEC_ID_AV1);
       if (!c) {
         supported = false;
       }
     } else if (codec.find("hev1") == 0 || codec.find("hvc1") == 0 ||
                codec == "hevc") {
-      const AVCodec* c = avcodec_find_decoder(AV_CODEC_ID_HEVC);
+      const AVCodec* c = webcodecs::FindDecoder(AV_CODEC_ID_HEVC);
       if (!c) {
         supported = false;
       }
@@ -791,6 +1027,58 @@ Napi::Value VideoDecoder::IsConfigSupported(const Napi::CallbackInfo& info) {
   if (config.Has("flip") && config.Get("flip").IsBoolean()) {
     normalized_config.Set("flip", config.Get("flip"));
   }
+  if (config.Has("outputFormat") && config.Get("outputFormat").IsString()) {
+    std::string output_format = webcodecs::AttrAsStr(config, "outputFormat");
+    if (output_format == "RGBA" || output_format == "native") {
+      normalized_config.Set("outputFormat", output_format);
+    } else {
+      supported = false;
+    }
+  }
+  webcodecs::CodecThreadingConfig threading;
+  std::string threading_error;
+  if (!webcodecs::ParseThreadingConfig(config, &threading, &threading_error)) {
+    supported = false;
+  } else if (threading.specified) {
+    normalized_config.Set("threading",
+                          webcodecs::ThreadingConfigToObject(env, threading));
+  }
+  webcodecs::ScalingConfig scaling;
+  std::string scaling_error;
+  if (!webcodecs::ParseScalingConfig(config, &scaling, &scaling_error)) {
+    supported = false;
+  } else {
+    if (webcodecs::HasAttr(config, "resizeQuality")) {
+      normalized_config.Set("resizeQuality", scaling.resize_quality);
+    }
+    if (scaling.threads >= 0) {
+      normalized_config.Set("scalingThreads", scaling.threads);
+    }
+  }
+
+  int output_batch_size = 1;
+  std::string batch_error;
+  if (!webcodecs::ParseOutputBatchSize(config, &output_batch_size,
+                                       &batch_error)) {
+    supported = false;
+  } else if (webcodecs::HasAttr(config, "outputBatchSize")) {
+    normalized_config.Set("outputBatchSize", output_batch_size);
+  }
+
+  if (!webcodecs::CopyQueueLimits(config, normalized_config)) {
+    supported = false;
+  }
+
+  webcodecs::DecodeSkipConfig skip;
+  std::string skip_error;
+  if (!ParseDecodeSkip(config, &skip, &skip_error)) {
+    supported = false;
+  }
+  for (const char* name : {"skipFrames", "skipLoopFilter", "skipIdct"}) {
+    if (webcodecs::HasAttr(config, name)) {
+      normalized_config.Set(name, config.Get(name));
+    }
+  }
 
   result.Set("supported", supported);
   result.Set("config", normalized_config);
@@ -19,8 +19,13 @@ extern "C" {
 #include <string>
 #include <unordered_map>
 
+#include "src/common.h"
 #include "src/ffmpeg_raii.h"
 #include "src/shared/control_message_queue.h"
+#include "src/shared/batched_tsfn.h"
+#include "src/shared/codec_reaper.h"
+#include "src/shared/codec_stats.h"
+#include "src/shared/dequeue_notifier.h"
 #include "src/shared/safe_tsfn.h"
 #include "src/video_decoder_worker.h"
 
@@ -42,6 +47,7 @@ class VideoDecoder : public Napi::ObjectWrap<VideoDecoder> {
   // WebCodecs API methods.
   Napi::Value Configure(const Napi::CallbackInfo& info);
   Napi::Value Decode(const Napi::CallbackInfo& info);
+  Napi::Value DecodeBatch(const Napi::CallbackInfo& info);
   Napi::Value Flush(const Napi::CallbackInfo& info);
   Napi::Value Reset(const Napi::CallbackInfo& info);
   void Close(const Napi::CallbackInfo& info);
@@ -49,10 +55,27 @@ class VideoDecoder : public Napi::ObjectWrap<VideoDecoder> {
   Napi::Value GetDecodeQueueSize(const Napi::CallbackInfo& info);
   Napi::Value GetCodecSaturated(const Napi::CallbackInfo& info);
   Napi::Value GetPendingFrames(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+  void ResetStats(const Napi::CallbackInfo& info);
 
   // Internal helpers.
   void Cleanup();
+  // Cut off the worker's output and hand it to the CodecReaper, which
+  // waits out its current message and frees the codec off the event loop.
+  void RetireWorker();
   void SetupWorkerCallbacks(Napi::Env env);
+  using Staged = webcodecs::StagedMessages<webcodecs::VideoControlQueue>;
+  // Queue |chunk| with |options| (undefined for none), or add it to
+  // |staged| when given. Returns how many decode requests were dropped
+  // (including this one, also when it is queued but will output no
+  // frame), or -1 when the 'block' policy found the queue full.
+  int DecodeChunk(Napi::Env env, Napi::Object chunk, Napi::Value options,
+                  Staged* staged);
+  void EnqueueStaged(Napi::Env env, Staged* staged);
+  // True when one more decode request of |incoming_bytes|, after the
+  // |staged| ones, breaks the queue limits.
+  bool QueueFull(size_t incoming_bytes,
+                 const Staged* staged = nullptr) const;
 
   // TSFN callback data types
   struct FrameCallbackData {
@@ -80,12 +103,11 @@ class VideoDecoder : public Napi::ObjectWrap<VideoDecoder> {
                               std::nullptr_t*, FlushCallbackData* data);
   static void OnErrorCallback(Napi::Env env, Napi::Function fn,
                               std::nullptr_t*, ErrorCallbackData* data);
-  static void OnDequeueCallback(Napi::Env env, Napi::Function fn,
-                                std::nullptr_t*, uint32_t* data);
 
   // Callbacks.
   Napi::FunctionReference output_callback_;
   Napi::FunctionReference error_callback_;
+  Napi::FunctionReference dequeue_callback_;  // Optional
 
   // State.
   std::string state_;
@@ -95,6 +117,13 @@ class VideoDecoder : public Napi::ObjectWrap<VideoDecoder> {
   std::atomic<bool> codec_saturated_{false};
   static constexpr size_t kMaxQueueSize = 16;
   static constexpr size_t kMaxHardQueueSize = 64;
+  // maxQueueSize/maxQueueBytes/queuePolicy; the default keeps the
+  // kMaxHardQueueSize safety valve.
+  webcodecs::QueueLimits queue_limits_;
+  // Per-instance pipeline stats; shared with the worker and output TSFN and
+  // kept across reconfigure.
+  std::shared_ptr<webcodecs::CodecStats> stats_ =
+      std::make_shared<webcodecs::CodecStats>("VideoDecoder");
 
   // Rotation and flip config (per W3C spec).
   int rotation_ = 0;   // 0, 90, 180, 270
@@ -114,31 +143,39 @@ class VideoDecoder : public Napi::ObjectWrap<VideoDecoder> {
   // Low-latency optimization (per W3C spec).
   bool optimize_for_latency_ = false;
 
+  // Output pixel format (node-webcodecs extension): when true, frames keep
+  // the decoder's native format instead of being converted to RGBA.
+  bool native_output_ = false;
+
   // Hardware acceleration config (per W3C spec).
-  // Note: This is a stub - FFmpeg uses software decoding.
+  // "prefer-hardware" decodes on a hw_device_ctx when one is available.
   std::string hardware_acceleration_ = "no-preference";
 
+  // FFmpeg threading (node-webcodecs extension).
+  webcodecs::CodecThreadingConfig threading_;
+
   // Worker-owned codec model
   std::unique_ptr<webcodecs::VideoControlQueue> control_queue_;
   std::unique_ptr<webcodecs::VideoDecoderWorker> worker_;
+  // Guards worker_'s callbacks; closed when the worker is retired.
+  std::shared_ptr<webcodecs::OutputGate> output_gate_;
 
   // ThreadSafeFunctions for async callbacks
   using FrameTSFN =
-      webcodecs::SafeThreadSafeFunction<std::nullptr_t, FrameCallbackData,
-                                        OnFrameCallback>;
+      webcodecs::BatchedThreadSafeFunction<std::nullptr_t, FrameCallbackData,
+                                           OnFrameCallback>;
   using FlushTSFN =
       webcodecs::SafeThreadSafeFunction<std::nullptr_t, FlushCallbackData,
                                         OnFlushCallback>;
   using ErrorTSFN =
       webcodecs::SafeThreadSafeFunction<std::nullptr_t, ErrorCallbackData,
                                         OnErrorCallback>;
-  using DequeueTSFN = webcodecs::SafeThreadSafeFunction<std::nullptr_t,
-                                                        uint32_t, OnDequeueCallback>;
 
   FrameTSFN frame_tsfn_;
   FlushTSFN flush_tsfn_;
   ErrorTSFN error_tsfn_;
-  DequeueTSFN dequeue_tsfn_;
+  // Retries of decode() calls parked by the 'block' policy.
+  webcodecs::DequeueNotifier dequeue_notifier_;
 
   // Promise management for flush
   uint32_t next_promise_id_ = 0;
@@ -149,6 +186,11 @@ class VideoDecoder : public Napi::ObjectWrap<VideoDecoder> {
 
   // Key chunk required flag (reset after flush/reset)
   bool key_chunk_required_ = true;
+  // Set after 'drop-oldest-delta' dropped packets later deltas depend on;
+  // incoming delta chunks are dropped until the next key chunk.
+  bool drop_until_key_ = false;
+  // skipFrames: 'nonkey'; delta chunks then never produce a frame.
+  bool skip_delta_frames_ = false;
 };
 
 #endif  // SRC_VIDEO_DECODER_H_
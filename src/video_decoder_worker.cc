@@ -7,26 +7,53 @@
 
 #include <cmath>
 #include <cstring>
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
 #include <libswscale/swscale.h>
 }
 
 #include "src/common.h"
+#include "src/frame_pool.h"
+#include "src/video_frame.h"
 
 namespace {
 // Used to calculate RGBA buffer size
 [[maybe_unused]] constexpr int kBytesPerPixelRgba = 4;
+
+// Hardware device types to probe for decoding, in order of preference.
+constexpr AVHWDeviceType kHwDeviceTypes[] = {
+#ifdef __APPLE__
+    AV_HWDEVICE_TYPE_VIDEOTOOLBOX,
+#endif
+#ifdef _WIN32
+    AV_HWDEVICE_TYPE_CUDA,
+    AV_HWDEVICE_TYPE_QSV,
+    AV_HWDEVICE_TYPE_D3D11VA,
+#endif
+#ifdef __linux__
+    AV_HWDEVICE_TYPE_VAAPI,
+    AV_HWDEVICE_TYPE_CUDA,
+    AV_HWDEVICE_TYPE_QSV,
+#endif
+    AV_HWDEVICE_TYPE_NONE,
+};
+
+// Packets timed for frameLatency at most; far more than any decoder holds.
+constexpr size_t kMaxPacketTimes = 256;
 }  // namespace
 
 namespace webcodecs {
 
-VideoDecoderWorker::VideoDecoderWorker(VideoControlQueue* queue)
-    : CodecWorker<VideoControlQueue>(queue) {}
+VideoDecoderWorker::VideoDecoderWorker(VideoWorkerQueue* queue)
+    : CodecWorker<VideoWorkerQueue>(queue) {}
 
 VideoDecoderWorker::~VideoDecoderWorker() {
   // Stop() is called by CodecWorker destructor, but we call it here to ensure
@@ -57,17 +84,56 @@ bool VideoDecoderWorker::OnConfigure(const ConfigureMessage& msg) {
   }
 
   // Find decoder
-  codec_ = avcodec_find_decoder(config_.codec_id);
+  codec_ = FindDecoder(config_.codec_id);
   if (!codec_) {
     OutputError(AVERROR_DECODER_NOT_FOUND, "Decoder not found for codec");
     return false;
   }
 
+  // Open on a hardware device if requested, falling back to software when
+  // no device is available or the hardware open fails
+  int ret = AVERROR(ENOSYS);
+  if (config_.hw_accel == "prefer-hardware") {
+    ret = OpenCodec(true);
+  }
+  if (ret < 0) {
+    ret = OpenCodec(false);
+  }
+  if (ret < 0) {
+    std::string error_msg =
+        "Could not open decoder: " + webcodecs::FFmpegErrorString(ret);
+    OutputError(ret, error_msg);
+    codec_context_.reset();
+    return false;
+  }
+
+  // Allocate frame and packet
+  frame_ = ffmpeg::make_frame();
+  if (!frame_) {
+    OutputError(AVERROR(ENOMEM), "Could not allocate frame");
+    codec_context_.reset();
+    return false;
+  }
+
+  packet_ = ffmpeg::make_packet();
+  if (!packet_) {
+    OutputError(AVERROR(ENOMEM), "Could not allocate packet");
+    codec_context_.reset();
+    frame_.reset();
+    return false;
+  }
+
+  codec_configured_.store(true, std::memory_order_release);
+  return true;
+}
+
+int VideoDecoderWorker::OpenCodec(bool use_hardware) {
+  hw_pix_fmt_.store(AV_PIX_FMT_NONE, std::memory_order_release);
+
   // Allocate codec context
   codec_context_ = ffmpeg::make_codec_context(codec_);
   if (!codec_context_) {
-    OutputError(AVERROR(ENOMEM), "Could not allocate codec context");
-    return false;
+    return AVERROR(ENOMEM);
   }
 
   // Set dimensions only if provided (decoder will use bitstream dimensions
@@ -99,34 +165,29 @@ bool VideoDecoderWorker::OnConfigure(const ConfigureMessage& msg) {
     codec_context_->flags2 |= AV_CODEC_FLAG2_FAST;
   }
 
-  // Open codec
-  int ret = avcodec_open2(codec_context_.get(), codec_, nullptr);
-  if (ret < 0) {
-    std::string error_msg =
-        "Could not open decoder: " + webcodecs::FFmpegErrorString(ret);
-    OutputError(ret, error_msg);
-    codec_context_.reset();
-    return false;
+  codec_context_->skip_frame = config_.skip.frames;
+  codec_context_->skip_loop_filter = config_.skip.loop_filter;
+  codec_context_->skip_idct = config_.skip.idct;
+
+  ApplyThreadingConfig(codec_context_.get(), config_.threading);
+  if (config_.optimize_for_latency &&
+      (!config_.threading.specified || config_.threading.mode == "auto")) {
+    // Frame threading holds one frame per thread before the first output;
+    // slice threads add none. An explicit threading.mode still wins.
+    codec_context_->thread_type = FF_THREAD_SLICE;
   }
 
-  // Allocate frame and packet
-  frame_ = ffmpeg::make_frame();
-  if (!frame_) {
-    OutputError(AVERROR(ENOMEM), "Could not allocate frame");
+  if (use_hardware && !SetupHardwareDecoding()) {
     codec_context_.reset();
-    return false;
+    return AVERROR(ENOSYS);  // No usable device for this codec
   }
 
-  packet_ = ffmpeg::make_packet();
-  if (!packet_) {
-    OutputError(AVERROR(ENOMEM), "Could not allocate packet");
+  int ret = avcodec_open2(codec_context_.get(), codec_, nullptr);
+  if (ret < 0) {
     codec_context_.reset();
-    frame_.reset();
-    return false;
+    hw_pix_fmt_.store(AV_PIX_FMT_NONE, std::memory_order_release);
   }
-
-  codec_configured_.store(true, std::memory_order_release);
-  return true;
+  return ret;
 }
 
 void VideoDecoderWorker::OnDecode(const DecodeMessage& msg) {
@@ -142,6 +203,16 @@ void VideoDecoderWorker::OnDecode(const DecodeMessage& msg) {
     return;
   }
 
+  if (pkt->flags & AV_PKT_FLAG_DISCARD) {
+    discard_pts_.insert(pkt->pts);
+  } else if (stats() && msg.enqueued_at != CodecStats::Clock::time_point{}) {
+    // Bounded even if a decoder swallows packets without output.
+    if (packet_times_.size() >= kMaxPacketTimes) {
+      packet_times_.erase(packet_times_.begin());
+    }
+    packet_times_[pkt->pts] = msg.enqueued_at;
+  }
+
   // Send packet to decoder
   int ret = avcodec_send_packet(codec_context_.get(), pkt);
   if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
@@ -164,7 +235,10 @@ void VideoDecoderWorker::OnDecode(const DecodeMessage& msg) {
     }
 
     // Emit the decoded frame
-    EmitFrame(frame_.get(), frame_->pts);
+    if (!TakeDiscarded(frame_->pts)) {
+      EmitFrame(frame_.get(), frame_->pts);
+      RecordFrameLatency(frame_->pts);
+    }
     av_frame_unref(frame_.get());
   }
 
@@ -200,9 +274,14 @@ void VideoDecoderWorker::OnFlush(const FlushMessage& msg) {
       return;
     }
 
-    EmitFrame(frame_.get(), frame_->pts);
+    if (!TakeDiscarded(frame_->pts)) {
+      EmitFrame(frame_.get(), frame_->pts);
+      RecordFrameLatency(frame_->pts);
+    }
     av_frame_unref(frame_.get());
   }
+  discard_pts_.clear();
+  packet_times_.clear();
 
   // Reset decoder to accept new packets after drain.
   // Without this, decoder stays in drain mode and rejects further input.
@@ -213,7 +292,7 @@ void VideoDecoderWorker::OnFlush(const FlushMessage& msg) {
 
 void VideoDecoderWorker::OnReset() {
   // Clear any pending work in the queue
-  queue()->Clear();
+  queue()->DiscardPending();
 
   // Flush decoder buffers if configured
   if (codec_context_ && codec_configured_.load(std::memory_order_acquire) &&
@@ -221,11 +300,11 @@ void VideoDecoderWorker::OnReset() {
     avcodec_flush_buffers(codec_context_.get());
   }
 
-  // Reset sws context tracking (will be recreated on next frame)
+  discard_pts_.clear();
+  packet_times_.clear();
+
+  // Return the sws context to the pool (re-leased on next frame)
   sws_context_.reset();
-  last_frame_format_ = AV_PIX_FMT_NONE;
-  last_frame_width_ = 0;
-  last_frame_height_ = 0;
 }
 
 void VideoDecoderWorker::OnClose() {
@@ -241,52 +320,118 @@ void VideoDecoderWorker::OnClose() {
   sws_context_.reset();
   codec_context_.reset();
   codec_ = nullptr;
+  hw_pix_fmt_.store(AV_PIX_FMT_NONE, std::memory_order_release);
 }
 
-bool VideoDecoderWorker::EnsureSwsContext(AVFrame* frame) {
-  AVPixelFormat frame_format = static_cast<AVPixelFormat>(frame->format);
+bool VideoDecoderWorker::TakeDiscarded(int64_t pts) {
+  if (discard_pts_.empty()) {
+    return false;
+  }
+  // Frames leave the decoder in presentation order, so discarded
+  // timestamps at or before this one will never be seen again.
+  auto end = discard_pts_.upper_bound(pts);
+  bool discarded = end != discard_pts_.begin() && *std::prev(end) == pts;
+  discard_pts_.erase(discard_pts_.begin(), end);
+  return discarded;
+}
 
-  // Check if we need to recreate the context
-  if (sws_context_ && last_frame_format_ == frame_format &&
-      last_frame_width_ == frame->width &&
-      last_frame_height_ == frame->height) {
-    return true;  // Existing context is valid
+void VideoDecoderWorker::RecordFrameLatency(int64_t pts) {
+  if (packet_times_.empty()) {
+    return;
+  }
+  // As with discard_pts_, earlier timestamps will not be output any more.
+  auto end = packet_times_.upper_bound(pts);
+  if (end != packet_times_.begin() && std::prev(end)->first == pts) {
+    stats()->Record(CodecStats::Stage::kFrameLatency, std::prev(end)->second,
+                    CodecStats::Clock::now(), "frameLatency");
   }
+  packet_times_.erase(packet_times_.begin(), end);
+}
 
-  // Create new SwsContext (RAII handles cleanup of old one)
-  sws_context_.reset(
-      sws_getContext(frame->width, frame->height, frame_format, frame->width,
-                     frame->height, AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr,
-                     nullptr, nullptr));
+bool VideoDecoderWorker::SetupHardwareDecoding() {
+  for (AVHWDeviceType type : kHwDeviceTypes) {
+    if (type == AV_HWDEVICE_TYPE_NONE) {
+      break;
+    }
 
-  if (!sws_context_) {
-    OutputError(AVERROR(ENOMEM), "Could not create sws context");
-    return false;
-  }
+    // Find a device-context config for this device type
+    AVPixelFormat hw_fmt = AV_PIX_FMT_NONE;
+    for (int i = 0;; ++i) {
+      const AVCodecHWConfig* hw_config = avcodec_get_hw_config(codec_, i);
+      if (!hw_config) {
+        break;
+      }
+      if ((hw_config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX) &&
+          hw_config->device_type == type) {
+        hw_fmt = hw_config->pix_fmt;
+        break;
+      }
+    }
+    if (hw_fmt == AV_PIX_FMT_NONE) {
+      continue;
+    }
 
-  last_frame_format_ = frame_format;
-  last_frame_width_ = frame->width;
-  last_frame_height_ = frame->height;
-  return true;
+    // Device creation is the slow part of a miss; skip recent failures.
+    std::string device_key =
+        std::string("hwdevice:") + av_hwdevice_get_type_name(type);
+    CodecCapabilities& capabilities = CodecCapabilities::Instance();
+    if (capabilities.HardwareRecentlyFailed(device_key)) {
+      continue;
+    }
+
+    AVBufferRef* device_ctx = nullptr;
+    if (av_hwdevice_ctx_create(&device_ctx, type, nullptr, nullptr, 0) < 0) {
+      capabilities.MarkHardwareFailed(device_key);
+      continue;  // Device not present on this machine
+    }
+
+    // Codec context takes ownership of the device reference
+    codec_context_->hw_device_ctx = device_ctx;
+    codec_context_->opaque = this;
+    codec_context_->get_format = &VideoDecoderWorker::SelectPixelFormat;
+    hw_pix_fmt_.store(hw_fmt, std::memory_order_release);
+    return true;
+  }
+  return false;
 }
 
-void VideoDecoderWorker::EmitFrame(AVFrame* frame, int64_t timestamp) {
-  if (!EnsureSwsContext(frame)) {
-    return;  // Error already reported
+AVPixelFormat VideoDecoderWorker::SelectPixelFormat(
+    AVCodecContext* ctx, const AVPixelFormat* formats) {
+  auto* self = static_cast<VideoDecoderWorker*>(ctx->opaque);
+  AVPixelFormat hw_fmt = self->hw_pix_fmt_.load(std::memory_order_acquire);
+
+  for (const AVPixelFormat* p = formats; *p != AV_PIX_FMT_NONE; ++p) {
+    if (*p == hw_fmt) {
+      return *p;
+    }
   }
 
-  // Create output frame with RGBA data
-  auto output_frame = ffmpeg::make_frame();
-  if (!output_frame) {
-    OutputError(AVERROR(ENOMEM), "Could not allocate output frame");
-    return;
+  // Stream not decodable on the device (e.g. unsupported profile): fall back
+  // to the first software format
+  for (const AVPixelFormat* p = formats; *p != AV_PIX_FMT_NONE; ++p) {
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(*p);
+    if (desc && !(desc->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+      return *p;
+    }
   }
+  return AV_PIX_FMT_NONE;
+}
 
-  output_frame->width = frame->width;
-  output_frame->height = frame->height;
-  output_frame->format = AV_PIX_FMT_RGBA;
-  output_frame->pts = timestamp;
+bool VideoDecoderWorker::EnsureSwsContext(AVFrame* frame) {
+  // Keeps the current lease when the frame geometry is unchanged.
+  webcodecs::SwsKey key = webcodecs::SwsKey::Convert(
+      frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+      AV_PIX_FMT_RGBA);
+  key.flags = config_.scaling.SwsFlags();
+  key.threads = config_.scaling.ThreadsOr(1);
+  if (!webcodecs::SwsPool::Instance().Ensure(&sws_context_, key)) {
+    OutputError(AVERROR(ENOMEM), "Could not create sws context");
+    return false;
+  }
+  return true;
+}
 
+void VideoDecoderWorker::EmitFrame(AVFrame* frame, int64_t timestamp) {
   // Calculate display dimensions based on aspect ratio (per W3C spec)
   int display_width = frame->width;
   int display_height = frame->height;
@@ -300,31 +445,86 @@ void VideoDecoderWorker::EmitFrame(AVFrame* frame, int64_t timestamp) {
     display_height = frame->height;
   }
 
-  // Allocate buffer for RGBA data
-  int ret = av_frame_get_buffer(output_frame.get(), 0);
-  if (ret < 0) {
-    OutputError(ret, "Could not allocate output frame buffer");
+  auto output_frame = ffmpeg::make_frame();
+  if (!output_frame) {
+    OutputError(AVERROR(ENOMEM), "Could not allocate output frame");
     return;
   }
 
-  // Convert to RGBA
-  sws_scale(sws_context_.get(), frame->data, frame->linesize, 0, frame->height,
-            output_frame->data, output_frame->linesize);
+  bool passthrough = config_.native_output &&
+                     FramePixelFormat(frame) != PixelFormat::UNKNOWN;
+
+  // Hardware frames stay on the GPU when passed through natively (the
+  // VideoFrame downloads them on first pixel access). Every other path needs
+  // system-memory pixels.
+  ffmpeg::AVFramePtr sw_frame;
+  if (frame->hw_frames_ctx && !passthrough) {
+    sw_frame = ffmpeg::make_frame();
+    if (!sw_frame) {
+      OutputError(AVERROR(ENOMEM), "Could not allocate download frame");
+      return;
+    }
+    int ret = av_hwframe_transfer_data(sw_frame.get(), frame, 0);
+    if (ret < 0) {
+      OutputError(ret, "Could not download hardware frame: " +
+                           webcodecs::FFmpegErrorString(ret));
+      return;
+    }
+    av_frame_copy_props(sw_frame.get(), frame);
+    int download_bytes = av_image_get_buffer_size(
+        static_cast<AVPixelFormat>(sw_frame->format), sw_frame->width,
+        sw_frame->height, 1);
+    if (stats() && download_bytes > 0) {
+      stats()->AddBytesCopied(static_cast<size_t>(download_bytes));
+    }
+    frame = sw_frame.get();
+    passthrough = config_.native_output &&
+                  FramePixelFormat(frame) != PixelFormat::UNKNOWN;
+  }
 
-  // Store metadata in frame for later use by VideoFrame creation
-  // Using opaque_ref to pass display dimensions and metadata
-  // Note: We encode display dimensions in the frame's sample_aspect_ratio
-  // since AVFrame doesn't have display_width/height fields
+  if (passthrough) {
+    // Native passthrough: take over the decoder's buffer references without
+    // copying or converting. The caller unrefs |frame| afterwards, which is
+    // a no-op once its references have been moved.
+    av_frame_move_ref(output_frame.get(), frame);
+  } else {
+    if (!EnsureSwsContext(frame)) {
+      return;  // Error already reported
+    }
+
+    output_frame->width = frame->width;
+    output_frame->height = frame->height;
+    output_frame->format = AV_PIX_FMT_RGBA;
+
+    // Allocate RGBA planes from the shared pool; VideoFrame::close() hands
+    // them back
+    int ret = FramePool::Instance().GetBuffer(output_frame.get());
+    if (ret < 0) {
+      OutputError(ret, "Could not allocate output frame buffer");
+      return;
+    }
+
+    // Convert to RGBA
+    {
+      StageTimer timer(stats(), CodecStats::Stage::kConvert);
+      ret = webcodecs::ScaleFrame(sws_context_, output_frame.get(),
+                                  frame);
+    }
+    if (ret < 0) {
+      OutputError(ret, "Could not convert frame: " +
+                           webcodecs::FFmpegErrorString(ret));
+      return;
+    }
+  }
+  output_frame->pts = timestamp;
+
+  // Store display dimensions in the frame for later use by VideoFrame
+  // creation. AVFrame doesn't have display_width/height fields, so they are
+  // carried in sample_aspect_ratio. Rotation/flip travel with the callback's
+  // metadata config.
   output_frame->sample_aspect_ratio.num = display_width;
   output_frame->sample_aspect_ratio.den = display_height;
 
-  // Store rotation/flip in opaque (simple encoding for now)
-  // Note: This is a workaround since AVFrame lacks rotation/flip fields
-  // We'll need to handle this properly in the TSFN callback
-  output_frame->opaque = reinterpret_cast<void*>(
-      static_cast<intptr_t>((config_.metadata.rotation << 1) |
-                            (config_.metadata.flip ? 1 : 0)));
-
   // Output the frame via callback
   OutputFrame(std::move(output_frame));
 }
@@ -12,10 +12,15 @@ extern "C" {
 }
 
 #include <atomic>
+#include <cstdint>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "src/common.h"
 #include "src/ffmpeg_raii.h"
+#include "src/sws_pool.h"
 #include "src/shared/codec_worker.h"
 #include "src/shared/control_message_queue.h"
 
@@ -37,6 +42,17 @@ struct VideoDecoderMetadataConfig {
   bool has_color_space = false;
 };
 
+/**
+ * Decode-skip levels (node-webcodecs extension) for the AVCodecContext
+ * fields of the same names. Thumbnails and scrubbing trade skipped frames
+ * or rougher pictures for decode speed.
+ */
+struct DecodeSkipConfig {
+  AVDiscard frames = AVDISCARD_DEFAULT;       // skip_frame
+  AVDiscard loop_filter = AVDISCARD_DEFAULT;  // skip_loop_filter
+  AVDiscard idct = AVDISCARD_DEFAULT;         // skip_idct
+};
+
 /**
  * Configuration for VideoDecoder.
  * Passed to worker thread via ConfigureMessage.
@@ -47,7 +63,18 @@ struct VideoDecoderConfig {
   int coded_height = 0;
   std::vector<uint8_t> extradata;
   bool optimize_for_latency = false;
+  // Emit frames in the decoder's own pixel format (I420, NV12, I420P10, ...)
+  // instead of converting to RGBA. Formats without a WebCodecs equivalent
+  // still fall back to RGBA.
+  bool native_output = false;
+  // W3C hardwareAcceleration hint. "prefer-hardware" tries a hw_device_ctx
+  // decode path and falls back to software when none is available.
+  std::string hw_accel = "no-preference";
+  CodecThreadingConfig threading;
+  // Quality and slice threads of the RGBA conversion.
+  ScalingConfig scaling;
   VideoDecoderMetadataConfig metadata;
+  DecodeSkipConfig skip;
 };
 
 /**
@@ -63,9 +90,9 @@ struct VideoDecoderConfig {
  * - Reset: Clears state, flushes buffers
  * - Close: Releases resources
  */
-class VideoDecoderWorker : public CodecWorker<VideoControlQueue> {
+class VideoDecoderWorker : public CodecWorker<VideoWorkerQueue> {
  public:
-  explicit VideoDecoderWorker(VideoControlQueue* queue);
+  explicit VideoDecoderWorker(VideoWorkerQueue* queue);
   ~VideoDecoderWorker() override;
 
   // Non-copyable, non-movable
@@ -85,6 +112,13 @@ class VideoDecoderWorker : public CodecWorker<VideoControlQueue> {
    */
   bool IsCodecOpen() const;
 
+  /**
+   * Check if the open codec decodes on a hardware device.
+   */
+  bool IsHardwareAccelerated() const {
+    return hw_pix_fmt_.load(std::memory_order_acquire) != AV_PIX_FMT_NONE;
+  }
+
  protected:
   // CodecWorker virtual overrides
   bool OnConfigure(const ConfigureMessage& msg) override;
@@ -96,10 +130,24 @@ class VideoDecoderWorker : public CodecWorker<VideoControlQueue> {
  private:
   /**
    * Emit a decoded frame via output callback.
-   * Converts from decoder's pixel format to RGBA.
+   * Passes the decoder's frame through untouched when native output is
+   * enabled and the format maps to a WebCodecs PixelFormat; otherwise
+   * converts to RGBA.
    */
   void EmitFrame(AVFrame* frame, int64_t timestamp);
 
+  /**
+   * True when |pts| belongs to a packet sent with AV_PKT_FLAG_DISCARD.
+   * Forgets every discarded timestamp up to |pts|.
+   */
+  bool TakeDiscarded(int64_t pts);
+
+  /**
+   * Record frameLatency for the frame at |pts| against the decode() that
+   * queued its packet. Forgets every packet time up to |pts|.
+   */
+  void RecordFrameLatency(int64_t pts);
+
   /**
    * Initialize or recreate SwsContext for format conversion.
    * Called when frame format/dimensions change.
@@ -108,20 +156,53 @@ class VideoDecoderWorker : public CodecWorker<VideoControlQueue> {
    */
   bool EnsureSwsContext(AVFrame* frame);
 
+  /**
+   * Allocate and open codec_context_ from config_, optionally on a hardware
+   * device. Resets codec_context_ on failure.
+   *
+   * @return 0 on success, negative AVERROR on failure
+   */
+  int OpenCodec(bool use_hardware);
+
+  /**
+   * Attach a hardware device context to codec_context_ for the first
+   * platform device type the decoder supports (VideoToolbox, VAAPI,
+   * CUDA/NVDEC, QSV, ...). Leaves the context untouched on failure.
+   *
+   * @return true if a hardware device was attached
+   */
+  bool SetupHardwareDecoding();
+
+  /**
+   * AVCodecContext::get_format callback. Picks the hardware surface format
+   * negotiated in SetupHardwareDecoding(), or the first software format when
+   * the stream cannot be decoded on the device.
+   */
+  static AVPixelFormat SelectPixelFormat(AVCodecContext* ctx,
+                                         const AVPixelFormat* formats);
+
   // Decoder configuration
   VideoDecoderConfig config_;
 
+  // Timestamps of packets sent with AV_PKT_FLAG_DISCARD, whose frames are
+  // decoded for reference but not output. Most libavcodec decoders drop
+  // such frames themselves; this catches wrappers that do not.
+  std::set<int64_t> discard_pts_;
+
+  // When each packet still inside the decoder was queued, by pts, for the
+  // frameLatency stat. Only kept while stats are attached.
+  std::map<int64_t, CodecStats::Clock::time_point> packet_times_;
+
   // FFmpeg resources (owned by this worker)
   const AVCodec* codec_ = nullptr;
   ffmpeg::AVCodecContextPtr codec_context_;
-  ffmpeg::SwsContextPtr sws_context_;
+  webcodecs::SwsPool::Lease sws_context_;  // Leased from SwsPool
   ffmpeg::AVFramePtr frame_;
   ffmpeg::AVPacketPtr packet_;
 
-  // Track last frame format/dimensions for sws_context recreation
-  AVPixelFormat last_frame_format_ = AV_PIX_FMT_NONE;
-  int last_frame_width_ = 0;
-  int last_frame_height_ = 0;
+  // Hardware surface format, AV_PIX_FMT_NONE for software decoding.
+  // Atomic because IsHardwareAccelerated() may be called from main thread.
+  std::atomic<AVPixelFormat> hw_pix_fmt_{AV_PIX_FMT_NONE};
 
   // Track if codec is configured (for reset safety)
   // Atomic because IsCodecOpen() may be called from main thread
@@ -3,15 +3,19 @@
 
 #include "src/video_encoder.h"
 
-#include <chrono>
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 #include <string>
-#include <thread>
 #include <utility>
+#include <vector>
 
 #include "src/common.h"
 #include "src/encoded_video_chunk.h"
+#include "src/frame_pool.h"
+#include "src/muxer.h"
 #include "src/video_frame.h"
 
 namespace {
@@ -22,23 +26,96 @@ constexpr int kDefaultTemporalLayers = 1;
 constexpr int kDefaultFramerate = 30;
 constexpr int kDefaultGopSize = 30;
 constexpr int kDefaultMaxBFrames = 2;
-constexpr int kBytesPerPixelRgba = 4;
 constexpr int kMaxDimension = 16384;
 
-// Compute temporal layer ID based on frame position and layer count.
-int ComputeTemporalLayerId(int64_t frame_index, int temporal_layer_count) {
-  if (temporal_layer_count <= 1) return 0;
+// Temporal layer count of |mode| when it is one this encoder produces for
+// |codec|: L1T1 everywhere, L1T2/L1T3 on libvpx (VP8, VP9) and SVT-AV1.
+// Spatial modes (L2T*, S2T*, ...) need per-layer frames, which none of the
+// FFmpeg wrappers expose. Returns 0 when unsupported.
+int SupportedTemporalLayers(const std::string& mode,
+                            const std::string& codec) {
+  if (mode == "L1T1") return 1;
+  if (mode != "L1T2" && mode != "L1T3") return 0;
+  bool layered = codec == "vp8" || codec.find("vp09") == 0 || codec == "vp9" ||
+                 ((codec.find("av01") == 0 || codec == "av1") &&
+                  webcodecs::FindEncoderByName("libsvtav1"));
+  return layered ? mode[3] - '0' : 0;
+}
+
+bool IsValidEncoderPreset(const std::string& preset) {
+  return preset == "speed" || preset == "balanced" || preset == "quality";
+}
 
-  if (temporal_layer_count == 2) {
-    // L1T2: alternating pattern [0, 1, 0, 1, ...]
-    return (frame_index % 2 == 0) ? 0 : 1;
+// Most regionsOfInterest entries accepted per frame. The encoders walk the
+// list for every macroblock row, so a runaway list costs real encode time.
+constexpr uint32_t kMaxRegionsOfInterest = 64;
+
+// Parse the regionsOfInterest encode option (node-webcodecs extension) into
+// AVRegionOfInterest entries clipped to a |width| x |height| frame. Regions
+// left empty by clipping are dropped. Returns false with |error| set when
+// the option is malformed.
+bool ParseRegionsOfInterest(Napi::Value value, int width, int height,
+                            std::vector<AVRegionOfInterest>* out,
+                            std::string* error) {
+  if (!value.IsArray()) {
+    *error = "regionsOfInterest must be an array";
+    return false;
   }
+  Napi::Array regions = value.As<Napi::Array>();
+  if (regions.Length() > kMaxRegionsOfInterest) {
+    *error = "regionsOfInterest accepts at most " +
+             std::to_string(kMaxRegionsOfInterest) + " regions";
+    return false;
+  }
+  for (uint32_t i = 0; i < regions.Length(); i++) {
+    Napi::Value entry = regions.Get(i);
+    if (!entry.IsObject()) {
+      *error = "regionsOfInterest entries must be objects";
+      return false;
+    }
+    Napi::Object region = entry.As<Napi::Object>();
+    double rect[4];
+    const char* names[4] = {"x", "y", "width", "height"};
+    for (int k = 0; k < 4; k++) {
+      Napi::Value v = region.Get(names[k]);
+      if (!v.IsNumber() || !std::isfinite(v.As<Napi::Number>().DoubleValue())) {
+        *error = std::string("regionsOfInterest[].") + names[k] +
+                 " must be a finite number";
+        return false;
+      }
+      rect[k] = v.As<Napi::Number>().DoubleValue();
+    }
+    if (rect[2] < 0 || rect[3] < 0) {
+      *error = "regionsOfInterest[].width and height must not be negative";
+      return false;
+    }
+    Napi::Value q = region.Get("qpOffset");
+    double qp_offset = q.IsNumber() ? q.As<Napi::Number>().DoubleValue() : NAN;
+    if (!(qp_offset >= -1.0 && qp_offset <= 1.0)) {
+      *error = "regionsOfInterest[].qpOffset must be between -1 and 1";
+      return false;
+    }
 
-  // L1T3: pyramid pattern [0, 2, 1, 2, 0, 2, 1, 2, ...]
-  int pos = frame_index % 4;
-  if (pos == 0) return 0;  // Base layer
-  if (pos == 2) return 1;  // Middle layer
-  return 2;                // Enhancement layer (pos 1, 3)
+    int left = static_cast<int>(std::clamp(rect[0], 0.0, double(width)));
+    int top = static_cast<int>(std::clamp(rect[1], 0.0, double(height)));
+    int right =
+        static_cast<int>(std::clamp(rect[0] + rect[2], 0.0, double(width)));
+    int bottom =
+        static_cast<int>(std::clamp(rect[1] + rect[3], 0.0, double(height)));
+    if (right <= left || bottom <= top) {
+      continue;
+    }
+    AVRegionOfInterest roi = {};
+    roi.self_size = sizeof(AVRegionOfInterest);
+    roi.top = top;
+    roi.bottom = bottom;
+    roi.left = left;
+    roi.right = right;
+    roi.qoffset = av_make_q(static_cast<int>(std::lround(qp_offset * 1000)),
+                            1000);
+    out->push_back(roi);
+  }
+  return true;
 }
 
 }  // namespace
@@ -53,6 +130,7 @@ Napi::Object VideoEncoder::Init(Napi::Env env, Napi::Object exports) {
       {
           InstanceMethod("configure", &VideoEncoder::Configure),
           InstanceMethod("encode", &VideoEncoder::Encode),
+          InstanceMethod("encodeBatch", &VideoEncoder::EncodeBatch),
           InstanceMethod("flush", &VideoEncoder::Flush),
           InstanceMethod("reset", &VideoEncoder::Reset),
           InstanceMethod("close", &VideoEncoder::Close),
@@ -63,6 +141,9 @@ Napi::Object VideoEncoder::Init(Napi::Env env, Napi::Object exports) {
                            nullptr),
           InstanceAccessor("pendingChunks", &VideoEncoder::GetPendingChunks,
                            nullptr),
+          InstanceMethod("attachMuxer", &VideoEncoder::AttachMuxer),
+          InstanceMethod("getStats", &VideoEncoder::GetStats),
+          InstanceMethod("resetStats", &VideoEncoder::ResetStats),
           StaticMethod("isConfigSupported", &VideoEncoder::IsConfigSupported),
       });
 
@@ -95,6 +176,17 @@ VideoEncoder::VideoEncoder(const Napi::CallbackInfo& info)
 
   output_callback_ = Napi::Persistent(init.Get("output").As<Napi::Function>());
   error_callback_ = Napi::Persistent(init.Get("error").As<Napi::Function>());
+  if (webcodecs::HasAttr(init, "sinkProgress") &&
+      init.Get("sinkProgress").IsFunction()) {
+    sink_progress_callback_ =
+        Napi::Persistent(init.Get("sinkProgress").As<Napi::Function>());
+  }
+  // Runs when an encode() turned away by the 'block' policy may be retried.
+  if (webcodecs::HasAttr(init, "dequeue") &&
+      init.Get("dequeue").IsFunction()) {
+    dequeue_callback_ =
+        Napi::Persistent(init.Get("dequeue").As<Napi::Function>());
+  }
 }
 
 VideoEncoder::~VideoEncoder() {
@@ -106,30 +198,22 @@ VideoEncoder::~VideoEncoder() {
 
 void VideoEncoder::Cleanup() {
   // Mark as not alive immediately to prevent callbacks from accessing members
-  // This provides defense-in-depth even though Stop() joins the worker thread
+  // This provides defense-in-depth behind the output gate
   alive_.store(false, std::memory_order_release);
 
-  // Stop worker first
-  if (worker_) {
-    worker_->Stop();
-
-    // Wait for pending chunks to be processed
-    auto deadline =
-        std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
-    while (worker_->GetPendingChunks() > 0 &&
-           std::chrono::steady_clock::now() < deadline) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
-  }
+  // No output reaches JS from here on, as if the worker had been joined.
+  // Chunks already handed to the output TSFN are still delivered.
+  RetireWorker();
 
   // Release TSFNs
   output_tsfn_.Release();
   error_tsfn_.Release();
   flush_tsfn_.Release();
+  dequeue_notifier_.Release();
 
-  // Clean up worker and queue
-  worker_.reset();
-  control_queue_.reset();
+  // No worker can reach the muxer any more.
+  sink_ = nullptr;
+  sink_ref_.Reset();
 
   // Reject any pending flush promises
   {
@@ -142,6 +226,24 @@ void VideoEncoder::Cleanup() {
   }
 }
 
+void VideoEncoder::RetireWorker() {
+  if (output_gate_) {
+    output_gate_->Close();
+    output_gate_.reset();
+  }
+  if (worker_) {
+    // Cancels a write blocked on the muxer's full queue and waits for the
+    // one in progress, so the muxer may be released after this.
+    worker_->SetPacketSink(nullptr, -1);
+  }
+  // The worker exits after the frame in progress, on the reaper thread.
+  if (control_queue_) {
+    control_queue_->Shutdown();
+  }
+  webcodecs::CodecReaper::Instance().Retire(std::move(worker_),
+                                            std::move(control_queue_));
+}
+
 // TSFN callback for output packets
 void VideoEncoder::OnOutputTSFN(Napi::Env env, Napi::Function fn,
                                 VideoEncoder* ctx,
@@ -154,21 +256,31 @@ void VideoEncoder::OnOutputTSFN(Napi::Env env, Napi::Function fn,
 
   // Decrement pending count
   data->pending->fetch_sub(1);
+
+  if (data->sink_progress) {
+    // Packets went to a muxer natively; only report how many.
+    int count = data->sink_progress->exchange(0);
+    webcodecs::counterQueue -= count;
+    delete data;
+    if (!ctx->sink_progress_callback_.IsEmpty()) {
+      ctx->sink_progress_callback_.Call({Napi::Number::New(env, count)});
+    }
+    return;
+  }
   webcodecs::counterQueue--;
 
-  // Create native EncodedVideoChunk
+  // Create native EncodedVideoChunk (copies the payload once more)
+  ctx->stats_->AddBytesCopied(data->data.size());
   Napi::Object chunk = EncodedVideoChunk::CreateInstance(
       env, data->is_key ? "key" : "delta", data->timestamp, data->duration,
-      data->data.data(), data->data.size());
+      data->data.data(), data->data.size(), data->decode_timestamp);
 
   // Create metadata object
   Napi::Object metadata = Napi::Object::New(env);
 
   // Add SVC metadata per W3C spec
   Napi::Object svc = Napi::Object::New(env);
-  int temporal_layer =
-      ComputeTemporalLayerId(data->frame_index, data->metadata.temporal_layer_count);
-  svc.Set("temporalLayerId", Napi::Number::New(env, temporal_layer));
+  svc.Set("temporalLayerId", Napi::Number::New(env, data->temporal_layer_id));
   metadata.Set("svc", svc);
 
   // Add decoderConfig for keyframes per W3C spec
@@ -281,6 +393,44 @@ Napi::Value VideoEncoder::Configure(const Napi::CallbackInfo& info) {
   std::string hw_accel =
       webcodecs::AttrAsStr(config, "hardwareAcceleration", "no-preference");
 
+  // Parse software encoder preset (node-webcodecs extension)
+  std::string preset =
+      webcodecs::AttrAsStr(config, "encoderPreset", "balanced");
+  if (!IsValidEncoderPreset(preset)) {
+    throw Napi::TypeError::New(
+        env, "encoderPreset must be 'speed', 'balanced' or 'quality'");
+  }
+
+  // Parse threading (node-webcodecs extension)
+  webcodecs::CodecThreadingConfig threading;
+  std::string threading_error;
+  if (!webcodecs::ParseThreadingConfig(config, &threading, &threading_error)) {
+    throw Napi::TypeError::New(env, threading_error);
+  }
+
+  // Parse input conversion quality (node-webcodecs extension)
+  webcodecs::ScalingConfig scaling;
+  std::string scaling_error;
+  if (!webcodecs::ParseScalingConfig(config, &scaling, &scaling_error)) {
+    throw Napi::TypeError::New(env, scaling_error);
+  }
+
+  // Parse output batching (node-webcodecs extension)
+  int output_batch_size = 1;
+  std::string batch_error;
+  if (!webcodecs::ParseOutputBatchSize(config, &output_batch_size,
+                                       &batch_error)) {
+    throw Napi::TypeError::New(env, batch_error);
+  }
+
+  // Parse queue limits (node-webcodecs extension)
+  webcodecs::QueueLimits queue_limits;
+  std::string limits_error;
+  if (!webcodecs::ParseQueueLimits(config, &queue_limits, &limits_error)) {
+    throw Napi::TypeError::New(env, limits_error);
+  }
+  queue_limits_ = queue_limits;
+
   // Parse colorSpace config
   color_primaries_ = "";
   color_transfer_ = "";
@@ -300,12 +450,13 @@ Napi::Value VideoEncoder::Configure(const Napi::CallbackInfo& info) {
   std::string scalability_mode =
       webcodecs::AttrAsStr(config, "scalabilityMode", "");
   if (!scalability_mode.empty()) {
-    size_t t_pos = scalability_mode.find('T');
-    if (t_pos != std::string::npos && t_pos + 1 < scalability_mode.size()) {
-      int t_count = scalability_mode[t_pos + 1] - '0';
-      if (t_count >= 1 && t_count <= 3) {
-        temporal_layer_count_ = t_count;
-      }
+    temporal_layer_count_ =
+        SupportedTemporalLayers(scalability_mode, codec_str);
+    if (temporal_layer_count_ == 0) {
+      throw Napi::Error::New(env, "NotSupportedError: scalabilityMode '" +
+                                      scalability_mode +
+                                      "' is not supported for codec '" +
+                                      codec_str + "'");
     }
   }
 
@@ -328,8 +479,10 @@ Napi::Value VideoEncoder::Configure(const Napi::CallbackInfo& info) {
   encoder_config_.bitrate = bitrate;
   encoder_config_.framerate = framerate;
   encoder_config_.gop_size = kDefaultGopSize;
+  encoder_config_.realtime = (latency_mode == "realtime");
   encoder_config_.max_b_frames =
-      (latency_mode == "realtime") ? 0 : kDefaultMaxBFrames;
+      encoder_config_.realtime ? 0 : kDefaultMaxBFrames;
+  encoder_config_.preset = preset;
   encoder_config_.use_qscale = (bitrate_mode == "quantizer");
   encoder_config_.codec_string = codec_string_;
   encoder_config_.bitstream_format = bitstream_format_;
@@ -339,16 +492,34 @@ Napi::Value VideoEncoder::Configure(const Napi::CallbackInfo& info) {
   encoder_config_.color_full_range = color_full_range_;
   encoder_config_.temporal_layer_count = temporal_layer_count_;
   encoder_config_.hw_accel = hw_accel;
+  encoder_config_.threading = threading;
+  encoder_config_.scaling = scaling;
+
+  // Reconfigure in place: the running worker applies the new settings after
+  // the frames already queued, changing the bitrate live where the codec
+  // allows and otherwise reopening the codec on the same thread. A new
+  // thread placement needs a new thread.
+  if (state_ == "configured" && worker_ &&
+      output_batch_size == output_batch_size_ &&
+      threading.placement == worker_->placement()) {
+    if (!worker_->Configure(encoder_config_)) {
+      throw Napi::Error::New(env, "Failed to queue encoder configuration");
+    }
+    return env.Undefined();
+  }
 
-  // Create control queue and worker
+  // Create control queue and worker, retiring any previous one
+  RetireWorker();
   control_queue_ = std::make_unique<webcodecs::VideoControlQueue>();
   worker_ = std::make_unique<webcodecs::VideoEncoderWorker>(control_queue_.get());
+  output_gate_ = webcodecs::OutputGate::Create();
+  webcodecs::OutputGate& gate = *output_gate_;
 
   // Create ThreadSafeFunctions
-  auto output_tsfn = Napi::TypedThreadSafeFunction<
-      VideoEncoder, webcodecs::EncodedPacketData, OnOutputTSFN>::
-      New(env, output_callback_.Value(), "VideoEncoderOutput", 0, 1, this);
-  output_tsfn_.Init(output_tsfn);
+  auto output_tsfn = OutputTSFN::TSFN::New(
+      env, output_callback_.Value(), "VideoEncoderOutput", 0, 1, this);
+  output_tsfn_.Init(std::move(output_tsfn), output_batch_size, stats_.get());
+  output_batch_size_ = output_batch_size;
 
   auto error_tsfn = Napi::TypedThreadSafeFunction<
       VideoEncoder, webcodecs::ErrorOutputData, OnErrorTSFN>::
@@ -361,13 +532,14 @@ Napi::Value VideoEncoder::Configure(const Napi::CallbackInfo& info) {
       VideoEncoder, webcodecs::FlushCompleteData, OnFlushTSFN>::
       New(env, flush_fn, "VideoEncoderFlush", 0, 1, this);
   flush_tsfn_.Init(flush_tsfn);
+  dequeue_notifier_.Init(env, dequeue_callback_, "VideoEncoderDequeue");
 
   // Set up worker callbacks
   // Note: These callbacks capture 'this' but are protected by:
-  // 1. alive_ atomic flag checked before accessing members
-  // 2. Stop() joining the worker thread before destruction
+  // 1. output_gate_, closed before the worker is retired
+  // 2. alive_ atomic flag checked before accessing members
   // 3. SafeThreadSafeFunction::Call() failing if TSFN is released
-  worker_->SetPacketOutputCallback(
+  worker_->SetPacketOutputCallback(gate.Guard(
       [this](std::unique_ptr<webcodecs::EncodedPacketData> data) {
         // Check alive flag before accessing members (defense-in-depth)
         if (!alive_.load(std::memory_order_acquire)) {
@@ -381,21 +553,26 @@ Napi::Value VideoEncoder::Configure(const Napi::CallbackInfo& info) {
           raw_data->pending->fetch_sub(1);
           delete raw_data;
         }
-      });
+      }));
 
-  worker_->SetErrorOutputCallback([this](int error_code,
-                                         const std::string& message) {
-    // Check alive flag before accessing members (defense-in-depth)
-    if (!alive_.load(std::memory_order_acquire)) {
-      return;
-    }
-    auto* error_data = new webcodecs::ErrorOutputData{error_code, message};
-    if (!error_tsfn_.Call(error_data)) {
-      delete error_data;
-    }
-  });
+  if (sink_) {
+    worker_->SetPacketSink(sink_, sink_stream_index_);
+  }
+
+  worker_->SetErrorOutputCallback(
+      gate.Guard([this](int error_code, const std::string& message) {
+        // Check alive flag before accessing members (defense-in-depth)
+        if (!alive_.load(std::memory_order_acquire)) {
+          return;
+        }
+        auto* error_data =
+            new webcodecs::ErrorOutputData{error_code, message};
+        if (!error_tsfn_.Call(error_data)) {
+          delete error_data;
+        }
+      }));
 
-  worker_->SetFlushCompleteCallback(
+  worker_->SetFlushCompleteCallback(gate.Guard(
       [this](uint32_t promise_id, bool success, const std::string& error) {
         // Check alive flag before accessing members (defense-in-depth)
         if (!alive_.load(std::memory_order_acquire)) {
@@ -406,13 +583,18 @@ Napi::Value VideoEncoder::Configure(const Napi::CallbackInfo& info) {
         if (!flush_tsfn_.Call(flush_data)) {
           delete flush_data;
         }
-      });
+      }));
+
+  worker_->SetDequeueEventCallback(
+      gate.Guard([this](uint32_t) { dequeue_notifier_.Notify(); }));
 
   // Configure and start the worker
   if (!worker_->Configure(encoder_config_)) {
     throw Napi::Error::New(env, "Failed to queue encoder configuration");
   }
 
+  worker_->SetStats(stats_);
+  worker_->SetPlacement(threading.placement);
   if (!worker_->Start()) {
     throw Napi::Error::New(env, "Failed to start encoder worker");
   }
@@ -449,6 +631,14 @@ Napi::Value VideoEncoder::GetPendingChunks(const Napi::CallbackInfo& info) {
   return Napi::Number::New(info.Env(), 0);
 }
 
+Napi::Value VideoEncoder::GetStats(const Napi::CallbackInfo& info) {
+  return webcodecs::CodecStatsToObject(info.Env(), *stats_);
+}
+
+void VideoEncoder::ResetStats(const Napi::CallbackInfo& info) {
+  stats_->Reset();
+}
+
 Napi::Value VideoEncoder::Encode(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -456,27 +646,81 @@ Napi::Value VideoEncoder::Encode(const Napi::CallbackInfo& info) {
     throw Napi::Error::New(env, "Encoder not configured");
   }
 
-  // Safety valve: reject if queue is too large
-  if (control_queue_) {
-    size_t queue_size = control_queue_->size();
-    if (worker_) {
-      queue_size += worker_->GetPendingChunks();
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    throw Napi::Error::New(env, "encode requires VideoFrame");
+  }
+
+  return Napi::Number::New(
+      env, EncodeFrame(env, info[0].As<Napi::Object>(),
+                       info.Length() >= 2 ? info[1] : env.Undefined(),
+                       nullptr));
+}
+
+Napi::Value VideoEncoder::EncodeBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (state_ != "configured") {
+    throw Napi::Error::New(env, "Encoder not configured");
+  }
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    throw Napi::TypeError::New(env,
+                               "encodeBatch requires an array of VideoFrames");
+  }
+  Napi::Array frames = info[0].As<Napi::Array>();
+  Napi::Array options = info.Length() >= 2 && info[1].IsArray()
+                            ? info[1].As<Napi::Array>()
+                            : Napi::Array();
+
+  // Frames are staged and enqueued under one lock. Returns [frames
+  // consumed, requests dropped]; a 'block' policy stop leaves the rest to
+  // the JS layer.
+  Staged staged;
+  uint32_t consumed = 0;
+  int dropped = 0;
+  try {
+    for (; consumed < frames.Length(); ++consumed) {
+      Napi::Value frame = frames.Get(consumed);
+      if (!frame.IsObject()) {
+        throw Napi::Error::New(env, "encode requires VideoFrame");
+      }
+      int result = EncodeFrame(
+          env, frame.As<Napi::Object>(),
+          options.IsEmpty() ? env.Undefined() : options.Get(consumed),
+          &staged);
+      if (result < 0) {
+        break;
+      }
+      dropped += result;
     }
-    if (queue_size >= kMaxHardQueueSize) {
-      throw Napi::Error::New(
-          env,
-          "QuotaExceededError: Encode queue is full. You must handle "
-          "backpressure by waiting for encodeQueueSize to decrease.");
+  } catch (const Napi::Error&) {
+    // Frames before the failing one stay queued, as with encode() calls.
+    size_t count = staged.size();
+    if (!control_queue_->EnqueueAll(staged.Take())) {
+      webcodecs::counterQueue -= static_cast<int>(count);
     }
+    throw;
   }
+  EnqueueStaged(env, &staged);
 
-  if (info.Length() < 1 || !info[0].IsObject()) {
-    throw Napi::Error::New(env, "encode requires VideoFrame");
+  Napi::Array result = Napi::Array::New(env, 2);
+  result.Set(0u, Napi::Number::New(env, consumed));
+  result.Set(1u, Napi::Number::New(env, dropped));
+  return result;
+}
+
+void VideoEncoder::EnqueueStaged(Napi::Env env, Staged* staged) {
+  size_t count = staged->size();
+  if (!control_queue_->EnqueueAll(staged->Take())) {
+    webcodecs::counterQueue -= static_cast<int>(count);
+    throw Napi::Error::New(env, "Failed to enqueue encode request");
   }
+}
 
+int VideoEncoder::EncodeFrame(Napi::Env env, Napi::Object frame_obj,
+                              Napi::Value options_value, Staged* staged) {
   // Get VideoFrame
-  VideoFrame* video_frame =
-      Napi::ObjectWrap<VideoFrame>::Unwrap(info[0].As<Napi::Object>());
+  VideoFrame* video_frame = Napi::ObjectWrap<VideoFrame>::Unwrap(frame_obj);
 
   // Validate frame size
   PixelFormat frame_format = video_frame->GetFormat();
@@ -489,59 +733,154 @@ Napi::Value VideoEncoder::Encode(const Napi::CallbackInfo& info) {
                                     std::to_string(actual_size));
   }
 
-  // Parse encode options
+  // Parse encode options; skipped entirely when none are passed. Keys are
+  // interned, so each option costs one property read.
   bool force_key_frame = false;
   int quantizer = -1;
-  if (info.Length() >= 2 && info[1].IsObject()) {
-    Napi::Object options = info[1].As<Napi::Object>();
-    force_key_frame = webcodecs::AttrAsBool(options, "keyFrame", false);
-
-    // Parse codec-specific quantizer options
-    if (webcodecs::HasAttr(options, "avc") && options.Get("avc").IsObject()) {
-      Napi::Object avc_opts = options.Get("avc").As<Napi::Object>();
-      int q = webcodecs::AttrAsInt32(avc_opts, "quantizer", -1);
-      if (q >= 0 && q <= 51) quantizer = q;
-    } else if (webcodecs::HasAttr(options, "hevc") &&
-               options.Get("hevc").IsObject()) {
-      Napi::Object hevc_opts = options.Get("hevc").As<Napi::Object>();
-      int q = webcodecs::AttrAsInt32(hevc_opts, "quantizer", -1);
-      if (q >= 0 && q <= 51) quantizer = q;
-    } else if (webcodecs::HasAttr(options, "vp9") &&
-               options.Get("vp9").IsObject()) {
-      Napi::Object vp9_opts = options.Get("vp9").As<Napi::Object>();
-      int q = webcodecs::AttrAsInt32(vp9_opts, "quantizer", -1);
-      if (q >= 0 && q <= 63) quantizer = q;
-    } else if (webcodecs::HasAttr(options, "av1") &&
-               options.Get("av1").IsObject()) {
-      Napi::Object av1_opts = options.Get("av1").As<Napi::Object>();
-      int q = webcodecs::AttrAsInt32(av1_opts, "quantizer", -1);
-      if (q >= 0 && q <= 63) quantizer = q;
-    }
-  }
-
-  // Create an AVFrame to pass to the worker
-  // The worker expects RGBA data packed in data[0]
-  ffmpeg::AVFramePtr frame = ffmpeg::make_frame();
-  frame->width = video_frame->GetWidth();
-  frame->height = video_frame->GetHeight();
-  frame->format = AV_PIX_FMT_RGBA;
-  frame->pts = video_frame->GetTimestampValue();
-  frame->duration = video_frame->GetDurationValue();
+  std::vector<AVRegionOfInterest> regions;
+  if (options_value.IsObject()) {
+    Napi::Object options = options_value.As<Napi::Object>();
+    force_key_frame =
+        webcodecs::AttrAsBool(options, webcodecs::Key::kKeyFrame, false);
+
+    // Parse codec-specific quantizer options; the first present one wins.
+    static constexpr struct {
+      webcodecs::Key key;
+      int max_quantizer;
+    } kQuantizerOptions[] = {
+        {webcodecs::Key::kAvc, 51},
+        {webcodecs::Key::kHevc, 51},
+        {webcodecs::Key::kVp9, 63},
+        {webcodecs::Key::kAv1, 63},
+    };
+    for (const auto& codec : kQuantizerOptions) {
+      Napi::Value codec_options = webcodecs::Attr(options, codec.key);
+      if (codec_options.IsObject()) {
+        int q = webcodecs::AttrAsInt32(codec_options.As<Napi::Object>(),
+                                       webcodecs::Key::kQuantizer, -1);
+        if (q >= 0 && q <= codec.max_quantizer) quantizer = q;
+        break;
+      }
+    }
+
+    // Parse per-frame quantizer offsets by region (node-webcodecs extension)
+    Napi::Value roi_value =
+        webcodecs::Attr(options, webcodecs::Key::kRegionsOfInterest);
+    if (!roi_value.IsUndefined()) {
+      std::string roi_error;
+      if (!ParseRegionsOfInterest(roi_value, video_frame->GetWidth(),
+                                  video_frame->GetHeight(), &regions,
+                                  &roi_error)) {
+        throw Napi::TypeError::New(env, roi_error);
+      }
+    }
+  }
+
+  // Refuse new work while native memory is over the soft limit set with
+  // setMemoryLimit() (node-webcodecs extension).
+  if (webcodecs::MemoryAccountant::Instance().OverSoftLimit()) {
+    throw Napi::Error::New(
+        env,
+        "QuotaExceededError: Native memory is over the soft limit. Close "
+        "frames and chunks you no longer need before encoding more.");
+  }
+
+  // A batch stops staging once its frames would break the queue limits:
+  // they are enqueued and the limits then apply to this frame as usual.
+  if (staged && !staged->empty() && QueueFull(actual_size, staged)) {
+    EnqueueStaged(env, staged);
+  }
+
+  // Apply the queue limits before touching the pixels. Returns how many
+  // encode requests were dropped (including this one), or -1 when the
+  // 'block' policy wants the JS layer to retry once the queue drains.
+  int dropped = 0;
+  while (QueueFull(actual_size)) {
+    if (queue_limits_.policy == webcodecs::QueuePolicy::kBlock) {
+      // Look again after asking for a wake-up; the worker may have made
+      // room before it could see the request.
+      dequeue_notifier_.Request();
+      if (QueueFull(actual_size)) {
+        return -1;
+      }
+      break;
+    }
+    if (queue_limits_.policy == webcodecs::QueuePolicy::kReject) {
+      throw Napi::Error::New(
+          env,
+          "QuotaExceededError: Encode queue is full. You must handle "
+          "backpressure by waiting for encodeQueueSize to decrease.");
+    }
+    bool orphaned_key = false;
+    if (!control_queue_->DropOldestFrame(&orphaned_key)) {
+      // Only in-flight frames or control messages fill the limit; drop
+      // this frame instead, or refuse it when a key frame is owed.
+      if (force_key_frame) {
+        throw Napi::Error::New(
+            env,
+            "QuotaExceededError: Encode queue is full and holds no frames "
+            "to drop. Wait for encodeQueueSize to decrease.");
+      }
+      return dropped + 1;
+    }
+    force_key_frame = force_key_frame || orphaned_key;
+    webcodecs::counterQueue--;
+    dropped++;
+  }
 
-  // Copy RGBA data
-  size_t data_size = frame->width * frame->height * kBytesPerPixelRgba;
-  int ret = av_frame_get_buffer(frame.get(), 32);
-  if (ret < 0) {
-    throw Napi::Error::New(env, "Failed to allocate frame buffer");
+  // Create an AVFrame to pass to the worker in the VideoFrame's own pixel
+  // format. The worker only converts when it differs from the codec's format.
+  AVPixelFormat av_format = PixelFormatToAV(frame_format);
+  if (av_format == AV_PIX_FMT_NONE) {
+    throw Napi::Error::New(env,
+                           "NotSupportedError: Unsupported VideoFrame format");
   }
 
-  std::memcpy(frame->data[0], video_frame->GetData(), data_size);
+  ffmpeg::AVFramePtr frame = ffmpeg::make_frame();
+  if (const AVFrame* src = video_frame->GetAVFrame()) {
+    // AVFrame-backed VideoFrame (e.g. decoder output): share its refcounted
+    // planes with the worker instead of copying them.
+    int ret = av_frame_ref(frame.get(), src);
+    if (ret < 0) {
+      throw Napi::Error::New(env, "Failed to reference VideoFrame data");
+    }
+  } else {
+    frame->width = video_frame->GetWidth();
+    frame->height = video_frame->GetHeight();
+    frame->format = av_format;
+
+    int ret = webcodecs::FramePool::Instance().GetBuffer(frame.get());
+    if (ret < 0) {
+      throw Napi::Error::New(env, "Failed to allocate frame buffer");
+    }
+
+    if (!CopyPackedBufferToFrame(video_frame->GetData(), actual_size,
+                                 frame_format, frame.get())) {
+      throw Napi::Error::New(env, "VideoFrame buffer too small for its format");
+    }
+  }
+  frame->pts = video_frame->GetTimestampValue();
+  frame->duration = video_frame->GetDurationValue();
 
   // Store quantizer in quality field
   if (quantizer >= 0) {
     frame->quality = quantizer * FF_QP2LAMBDA;
   }
 
+  // Regions of interest travel as frame side data, which libx264, libx265,
+  // libvpx, VAAPI and QSV turn into per-block quantizer offsets. Replace any
+  // list inherited from a referenced decoder frame.
+  av_frame_remove_side_data(frame.get(), AV_FRAME_DATA_REGIONS_OF_INTEREST);
+  if (!regions.empty()) {
+    AVFrameSideData* side_data = av_frame_new_side_data(
+        frame.get(), AV_FRAME_DATA_REGIONS_OF_INTEREST,
+        regions.size() * sizeof(AVRegionOfInterest));
+    if (!side_data) {
+      throw Napi::Error::New(env, "Failed to allocate regionsOfInterest");
+    }
+    memcpy(side_data->data, regions.data(), side_data->size);
+  }
+
   // Create encode message
   webcodecs::VideoControlQueue::EncodeMessage msg;
   msg.frame = std::move(frame);
@@ -549,14 +888,44 @@ Napi::Value VideoEncoder::Encode(const Napi::CallbackInfo& info) {
 
   // Enqueue the message
   webcodecs::counterQueue++;
-  if (!control_queue_->Enqueue(std::move(msg))) {
+  if (staged) {
+    staged->Add(std::move(msg));
+  } else if (!control_queue_->Enqueue(std::move(msg))) {
     webcodecs::counterQueue--;
     throw Napi::Error::New(env, "Failed to enqueue encode request");
   }
 
   frame_count_++;
 
-  return env.Undefined();
+  return dropped;
+}
+
+bool VideoEncoder::QueueFull(size_t incoming_bytes,
+                             const Staged* staged) const {
+  if (!control_queue_) {
+    return false;
+  }
+  size_t queue_size = control_queue_->size() + (staged ? staged->size() : 0);
+  if (queue_limits_.max_size > 0) {
+    // Frames inside the codec are bounded by its delay and only leave on
+    // output, so a limit below that delay would never drain; don't count
+    // them.
+    if (queue_size >= queue_limits_.max_size) {
+      return true;
+    }
+  } else {
+    // Safety valve: everything not yet output.
+    if (worker_) {
+      queue_size += worker_->GetPendingChunks();
+    }
+    if (queue_size >= kMaxHardQueueSize) {
+      return true;
+    }
+  }
+  // An empty queue always takes one request, however large.
+  size_t queued_bytes = control_queue_->bytes() + (staged ? staged->bytes : 0);
+  return queue_limits_.max_bytes > 0 && queued_bytes > 0 &&
+         queued_bytes + incoming_bytes > queue_limits_.max_bytes;
 }
 
 Napi::Value VideoEncoder::Flush(const Napi::CallbackInfo& info) {
@@ -614,6 +983,42 @@ Napi::Value VideoEncoder::Flush(const Napi::CallbackInfo& info) {
   return Napi::Promise::Deferred::New(env).Promise();
 }
 
+Napi::Value VideoEncoder::AttachMuxer(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (state_ == "closed") {
+    throw Napi::Error::New(env, "InvalidStateError: Encoder is closed");
+  }
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsNumber() ||
+      Muxer::constructor.IsEmpty() ||
+      !info[0].As<Napi::Object>().InstanceOf(Muxer::constructor.Value())) {
+    throw Napi::TypeError::New(env,
+                               "attachMuxer requires a Muxer and a trackIndex");
+  }
+  if (sink_) {
+    throw Napi::Error::New(env,
+                           "InvalidStateError: Encoder already has a muxer");
+  }
+
+  Napi::Object muxer_obj = info[0].As<Napi::Object>();
+  Muxer* muxer = Napi::ObjectWrap<Muxer>::Unwrap(muxer_obj);
+  int stream_index = info[1].As<Napi::Number>().Int32Value();
+  if (!muxer->HasTrack(stream_index, AVMEDIA_TYPE_VIDEO)) {
+    throw Napi::TypeError::New(env, "trackIndex is not a video track");
+  }
+  if (!muxer->AttachEncoder(env)) {
+    throw Napi::Error::New(env, "InvalidStateError: Muxer is finalized");
+  }
+
+  sink_ref_ = Napi::Persistent(muxer_obj);
+  sink_ = muxer;
+  sink_stream_index_ = stream_index;
+  if (worker_) {
+    worker_->SetPacketSink(sink_, sink_stream_index_);
+  }
+  return env.Undefined();
+}
+
 Napi::Value VideoEncoder::Reset(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -621,22 +1026,17 @@ Napi::Value VideoEncoder::Reset(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  // Stop worker and clean up
-  if (worker_) {
-    worker_->Stop();
-    worker_.reset();
+  // Drop queued frames now; the worker and codec go off-loop.
+  if (control_queue_) {
+    control_queue_->ClearFrames();
   }
+  RetireWorker();
 
   // Release TSFNs
   output_tsfn_.Release();
   error_tsfn_.Release();
   flush_tsfn_.Release();
-
-  // Clear control queue
-  if (control_queue_) {
-    control_queue_->ClearFrames();
-    control_queue_.reset();
-  }
+  dequeue_notifier_.Release();
 
   // Reject any pending flush promises
   {
@@ -685,20 +1085,20 @@ Napi::Value VideoEncoder::IsConfigSupported(const Napi::CallbackInfo& info) {
 
     // Check if codec is supported
     if (codec.find("avc1") == 0 || codec == "h264") {
-      const AVCodec* c = avcodec_find_encoder(AV_CODEC_ID_H264);
+      const AVCodec* c = webcodecs::FindEncoder(AV_CODEC_ID_H264);
       if (!c) supported = false;
     } else if (codec == "vp8") {
-      const AVCodec* c = avcodec_find_encoder(AV_CODEC_ID_VP8);
+      const AVCodec* c = webcodecs::FindEncoder(AV_CODEC_ID_VP8);
       if (!c) supported = false;
     } else if (codec.find("vp09") == 0 || codec == "vp9") {
-      const AVCodec* c = avcodec_find_encoder(AV_CODEC_ID_VP9);
+      const AVCodec* c = webcodecs::FindEncoder(AV_CODEC_ID_VP9);
       if (!c) supported = false;
     } else if (codec.find("av01") == 0 || codec == "av1") {
-      const AVCodec* c = avcodec_find_encoder(AV_CODEC_ID_AV1);
+      const AVCodec* c = webcodecs::FindEncoder(AV_CODEC_ID_AV1);
       if (!c) supported = false;
     } else if (codec.find("hev1") == 0 || codec.find("hvc1") == 0 ||
                codec == "hevc") {
-      const AVCodec* c = avcodec_find_encoder(AV_CODEC_ID_HEVC);
+      const AVCodec* c = webcodecs::FindEncoder(AV_CODEC_ID_HEVC);
       if (!c) supported = false;
     } else {
       supported = false;
@@ -759,7 +1159,9 @@ Napi::Value VideoEncoder::IsConfigSupported(const Napi::CallbackInfo& info) {
   }
   if (webcodecs::HasAttr(config, "scalabilityMode") &&
       config.Get("scalabilityMode").IsString()) {
-    normalized_config.Set("scalabilityMode", config.Get("scalabilityMode"));
+    std::string mode = webcodecs::AttrAsStr(config, "scalabilityMode");
+    if (SupportedTemporalLayers(mode, codec) == 0) supported = false;
+    normalized_config.Set("scalabilityMode", mode);
   }
   if (webcodecs::HasAttr(config, "contentHint") &&
       config.Get("contentHint").IsString()) {
@@ -806,6 +1208,55 @@ Napi::Value VideoEncoder::IsConfigSupported(const Napi::CallbackInfo& info) {
     normalized_config.Set("hevc", normalized_hevc);
   }
 
+  // Copy software encoder preset (node-webcodecs extension)
+  if (webcodecs::HasAttr(config, "encoderPreset")) {
+    std::string preset = webcodecs::AttrAsStr(config, "encoderPreset");
+    if (!IsValidEncoderPreset(preset)) {
+      supported = false;
+    } else {
+      normalized_config.Set("encoderPreset", preset);
+    }
+  }
+
+  // Copy threading (node-webcodecs extension)
+  webcodecs::CodecThreadingConfig threading;
+  std::string threading_error;
+  if (!webcodecs::ParseThreadingConfig(config, &threading, &threading_error)) {
+    supported = false;
+  } else if (threading.specified) {
+    normalized_config.Set("threading",
+                          webcodecs::ThreadingConfigToObject(env, threading));
+  }
+
+  // Copy input conversion quality (node-webcodecs extension)
+  webcodecs::ScalingConfig scaling;
+  std::string scaling_error;
+  if (!webcodecs::ParseScalingConfig(config, &scaling, &scaling_error)) {
+    supported = false;
+  } else {
+    if (webcodecs::HasAttr(config, "resizeQuality")) {
+      normalized_config.Set("resizeQuality", scaling.resize_quality);
+    }
+    if (scaling.threads >= 0) {
+      normalized_config.Set("scalingThreads", scaling.threads);
+    }
+  }
+
+  // Copy output batching (node-webcodecs extension)
+  int output_batch_size = 1;
+  std::string batch_error;
+  if (!webcodecs::ParseOutputBatchSize(config, &output_batch_size,
+                                       &batch_error)) {
+    supported = false;
+  } else if (webcodecs::HasAttr(config, "outputBatchSize")) {
+    normalized_config.Set("outputBatchSize", output_batch_size);
+  }
+
+  // Copy queue limits (node-webcodecs extension)
+  if (!webcodecs::CopyQueueLimits(config, normalized_config)) {
+    supported = false;
+  }
+
   result.Set("supported", supported);
   result.Set("config", normalized_config);
 
@@ -21,11 +21,18 @@ extern "C" {
 #include <string>
 #include <unordered_map>
 
+#include "src/common.h"
 #include "src/ffmpeg_raii.h"
 #include "src/shared/control_message_queue.h"
+#include "src/shared/batched_tsfn.h"
+#include "src/shared/codec_reaper.h"
+#include "src/shared/codec_stats.h"
+#include "src/shared/dequeue_notifier.h"
 #include "src/shared/safe_tsfn.h"
 #include "src/video_encoder_worker.h"
 
+class Muxer;
+
 class VideoEncoder : public Napi::ObjectWrap<VideoEncoder> {
  public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -41,6 +48,7 @@ class VideoEncoder : public Napi::ObjectWrap<VideoEncoder> {
   // WebCodecs API methods.
   Napi::Value Configure(const Napi::CallbackInfo& info);
   Napi::Value Encode(const Napi::CallbackInfo& info);
+  Napi::Value EncodeBatch(const Napi::CallbackInfo& info);
   Napi::Value Flush(const Napi::CallbackInfo& info);
   Napi::Value Reset(const Napi::CallbackInfo& info);
   void Close(const Napi::CallbackInfo& info);
@@ -48,9 +56,27 @@ class VideoEncoder : public Napi::ObjectWrap<VideoEncoder> {
   Napi::Value GetEncodeQueueSize(const Napi::CallbackInfo& info);
   Napi::Value GetCodecSaturated(const Napi::CallbackInfo& info);
   Napi::Value GetPendingChunks(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+  void ResetStats(const Napi::CallbackInfo& info);
+  Napi::Value AttachMuxer(const Napi::CallbackInfo& info);
 
   // Internal helpers.
   void Cleanup();
+  // Cut off the worker's output and muxer sink and hand it to the
+  // CodecReaper, which waits out its current frame and frees the codec off
+  // the event loop.
+  void RetireWorker();
+  using Staged = webcodecs::StagedMessages<webcodecs::VideoControlQueue>;
+  // Queue |frame| with |options| (undefined for none), or add it to |staged|
+  // when given. Returns how many encode requests were dropped (including
+  // this one), or -1 when the 'block' policy found the queue full.
+  int EncodeFrame(Napi::Env env, Napi::Object frame, Napi::Value options,
+                  Staged* staged);
+  void EnqueueStaged(Napi::Env env, Staged* staged);
+  // True when one more encode request of |incoming_bytes|, after the
+  // |staged| ones, breaks the queue limits.
+  bool QueueFull(size_t incoming_bytes,
+                 const Staged* staged = nullptr) const;
 
   // TSFN callback helpers
   static void OnOutputTSFN(Napi::Env env, Napi::Function fn, VideoEncoder* ctx,
@@ -63,6 +89,15 @@ class VideoEncoder : public Napi::ObjectWrap<VideoEncoder> {
   // Callbacks from JS
   Napi::FunctionReference output_callback_;
   Napi::FunctionReference error_callback_;
+  // Receives the packet count of sink progress events (attachMuxer).
+  Napi::FunctionReference sink_progress_callback_;
+  Napi::FunctionReference dequeue_callback_;  // Optional
+
+  // Muxer receiving packets natively; sink_ref_ keeps it alive until the
+  // worker is gone.
+  Napi::ObjectReference sink_ref_;
+  Muxer* sink_ = nullptr;
+  int sink_stream_index_ = -1;
 
   // State
   std::string state_;
@@ -84,6 +119,16 @@ class VideoEncoder : public Napi::ObjectWrap<VideoEncoder> {
   std::atomic<bool> codec_saturated_{false};
   static constexpr size_t kMaxQueueSize = 16;
   static constexpr size_t kMaxHardQueueSize = 64;
+  // maxQueueSize/maxQueueBytes/queuePolicy; the default keeps the
+  // kMaxHardQueueSize safety valve.
+  webcodecs::QueueLimits queue_limits_;
+  // outputBatchSize of the live output TSFN; a reconfigure that keeps it
+  // reuses the worker.
+  int output_batch_size_ = 1;
+  // Per-instance pipeline stats; shared with the worker and output TSFN and
+  // kept across reconfigure.
+  std::shared_ptr<webcodecs::CodecStats> stats_ =
+      std::make_shared<webcodecs::CodecStats>("VideoEncoder");
 
   // Lifecycle safety flag - prevents use-after-free in callbacks
   // Set to false at the start of Cleanup() before any member access
@@ -92,9 +137,11 @@ class VideoEncoder : public Napi::ObjectWrap<VideoEncoder> {
   // Worker-based encoding (new architecture)
   std::unique_ptr<webcodecs::VideoControlQueue> control_queue_;
   std::unique_ptr<webcodecs::VideoEncoderWorker> worker_;
+  // Guards worker_'s callbacks; closed when the worker is retired.
+  std::shared_ptr<webcodecs::OutputGate> output_gate_;
 
   // ThreadSafeFunctions for async callbacks
-  using OutputTSFN = webcodecs::SafeThreadSafeFunction<
+  using OutputTSFN = webcodecs::BatchedThreadSafeFunction<
       VideoEncoder, webcodecs::EncodedPacketData, OnOutputTSFN>;
   using ErrorTSFN = webcodecs::SafeThreadSafeFunction<
       VideoEncoder, webcodecs::ErrorOutputData, OnErrorTSFN>;
@@ -104,6 +151,8 @@ class VideoEncoder : public Napi::ObjectWrap<VideoEncoder> {
   OutputTSFN output_tsfn_;
   ErrorTSFN error_tsfn_;
   FlushTSFN flush_tsfn_;
+  // Retries of encode() calls parked by the 'block' policy.
+  webcodecs::DequeueNotifier dequeue_notifier_;
 
   // Promise tracking for flush
   uint32_t next_promise_id_ = 0;
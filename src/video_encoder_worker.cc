@@ -5,6 +5,13 @@
 
 #include "src/video_encoder_worker.h"
 
+extern "C" {
+#include <libavfilter/buffersink.h>
+#include <libavfilter/buffersrc.h>
+#include <libavutil/cpu.h>
+}
+
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <memory>
@@ -20,13 +27,133 @@ namespace {
 
 // Encoder configuration constants
 constexpr int kFrameBufferAlignment = 32;
-constexpr int kBytesPerPixelRgba = 4;
 constexpr int kDefaultGopSize = 30;
 
+// Software encoder settings for one encoderPreset.
+struct EncoderPresetOptions {
+  const char* x26x_preset;  // libx264/libx265 preset
+  int vpx_speed;            // libvpx cpu-used
+  int aom_cpu_used;         // libaom cpu-used
+  int svt_preset;           // libsvtav1 preset
+};
+
+// Indexed by PresetIndex(). Realtime 'balanced' is the long-standing
+// low-latency profile.
+constexpr EncoderPresetOptions kRealtimePresets[] = {
+    {"veryfast", 8, 9, 10},  // speed
+    {"fast", 6, 8, 8},       // balanced
+    {"medium", 5, 7, 6},     // quality
+};
+
+// latencyMode 'quality' trades latency for compression: lookahead,
+// B-frames (x264/x265), alt-ref frames (VP9) and frame threading.
+constexpr EncoderPresetOptions kQualityPresets[] = {
+    {"veryfast", 5, 7, 10},  // speed
+    {"medium", 3, 5, 6},     // balanced
+    {"slow", 1, 3, 4},       // quality
+};
+
+// Frames libvpx may look ahead in quality mode (its 'good' default).
+constexpr int kVpxLagInFrames = 25;
+
+// Upper bound on the lookahead of the quality presets (x264 'slow' uses 50
+// frames), for sizing the frame metadata ring.
+constexpr size_t kMaxLookaheadFrames = 64;
+
+// Cumulative bitrate share (percent) of each temporal layer, as in the
+// libvpx temporal scalability examples.
+constexpr int kTwoLayerShares[] = {60, 100};
+constexpr int kThreeLayerShares[] = {40, 60, 100};
+
+// Hardware encoders for |codec_id| on this platform, best first.
+std::vector<const char*> HardwareEncoderNames(AVCodecID codec_id) {
+#ifdef __APPLE__
+  if (codec_id == AV_CODEC_ID_H264) return {"h264_videotoolbox"};
+  if (codec_id == AV_CODEC_ID_HEVC) return {"hevc_videotoolbox"};
+#endif
+#ifdef _WIN32
+  if (codec_id == AV_CODEC_ID_H264) {
+    return {"h264_nvenc", "h264_qsv", "h264_amf"};
+  }
+  if (codec_id == AV_CODEC_ID_HEVC) return {"hevc_nvenc", "hevc_qsv"};
+#endif
+#ifdef __linux__
+  if (codec_id == AV_CODEC_ID_H264) return {"h264_vaapi", "h264_nvenc"};
+  if (codec_id == AV_CODEC_ID_HEVC) return {"hevc_vaapi", "hevc_nvenc"};
+#endif
+  return {};
+}
+
+// Whether two configs open the same codec. Bitrate, display size and the
+// input conversion are left out: they change without a reopen.
+bool SameCodecSettings(const VideoEncoderConfig& a,
+                       const VideoEncoderConfig& b) {
+  return a.width == b.width && a.height == b.height &&
+         a.framerate == b.framerate && a.gop_size == b.gop_size &&
+         a.max_b_frames == b.max_b_frames && a.realtime == b.realtime &&
+         a.preset == b.preset && a.use_qscale == b.use_qscale &&
+         a.codec_string == b.codec_string &&
+         a.bitstream_format == b.bitstream_format &&
+         a.color_primaries == b.color_primaries &&
+         a.color_transfer == b.color_transfer &&
+         a.color_matrix == b.color_matrix &&
+         a.color_full_range == b.color_full_range &&
+         a.temporal_layer_count == b.temporal_layer_count &&
+         a.hw_accel == b.hw_accel &&
+         a.threading.specified == b.threading.specified &&
+         a.threading.count == b.threading.count &&
+         a.threading.mode == b.threading.mode;
+}
+
+// Encoders whose FFmpeg wrapper passes a changed AVCodecContext::bit_rate
+// to the running encoder (x264_encoder_reconfig, NVENC reconfiguration).
+// libx265, libvpx and libaom only read it in avcodec_open2.
+bool SupportsLiveBitrate(const AVCodec* codec) {
+  return strcmp(codec->name, "libx264") == 0 ||
+         strstr(codec->name, "nvenc") != nullptr;
+}
+
+size_t PresetIndex(const std::string& preset) {
+  if (preset == "speed") return 0;
+  if (preset == "quality") return 2;
+  return 1;
+}
+
+// Give |dst| the regions of interest attached to |src|, rescaled from
+// |src|'s dimensions to |dst|'s. Conversion and upload produce a new frame
+// that does not inherit the caller's side data, and frame_ is reused across
+// frames, so a stale list has to be removed even when |src| has none.
+void CopyRegionsOfInterest(const AVFrame* src, AVFrame* dst) {
+  av_frame_remove_side_data(dst, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+  const AVFrameSideData* sd =
+      av_frame_get_side_data(src, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+  if (!sd || src->width <= 0 || src->height <= 0) {
+    return;
+  }
+  AVFrameSideData* copy = av_frame_new_side_data(
+      dst, AV_FRAME_DATA_REGIONS_OF_INTEREST, sd->size);
+  if (!copy) {
+    return;  // Encode without ROI rather than fail the frame
+  }
+  memcpy(copy->data, sd->data, sd->size);
+  if (dst->width == src->width && dst->height == src->height) {
+    return;
+  }
+  auto* regions = reinterpret_cast<AVRegionOfInterest*>(copy->data);
+  size_t count = copy->size / sizeof(AVRegionOfInterest);
+  for (size_t i = 0; i < count; i++) {
+    regions[i].left = av_rescale(regions[i].left, dst->width, src->width);
+    regions[i].right = av_rescale(regions[i].right, dst->width, src->width);
+    regions[i].top = av_rescale(regions[i].top, dst->height, src->height);
+    regions[i].bottom =
+        av_rescale(regions[i].bottom, dst->height, src->height);
+  }
+}
+
 }  // namespace
 
-VideoEncoderWorker::VideoEncoderWorker(VideoControlQueue* queue)
-    : CodecWorker<VideoControlQueue>(queue) {}
+VideoEncoderWorker::VideoEncoderWorker(VideoWorkerQueue* queue)
+    : CodecWorker<VideoWorkerQueue>(queue) {}
 
 VideoEncoderWorker::~VideoEncoderWorker() {
   // Stop() is called by base class destructor, but we call it here first
@@ -35,12 +162,11 @@ VideoEncoderWorker::~VideoEncoderWorker() {
 }
 
 bool VideoEncoderWorker::Configure(const VideoEncoderConfig& config) {
-  config_ = config;
-
   // Queue a configure message that will initialize the codec on the worker
-  // thread
+  // thread. The config travels with the message: config_ belongs to the
+  // worker thread once it runs.
   ConfigureMessage msg;
-  msg.configure_fn = [this]() -> bool { return InitializeCodec(); };
+  msg.configure_fn = [this, config]() -> bool { return ApplyConfig(config); };
 
   return Enqueue(std::move(msg));
 }
@@ -50,6 +176,52 @@ bool VideoEncoderWorker::OnConfigure(const ConfigureMessage& msg) {
   return msg.configure_fn();
 }
 
+bool VideoEncoderWorker::ApplyConfig(const VideoEncoderConfig& config) {
+  if (!codec_context_) {
+    config_ = config;
+    return InitializeCodec();
+  }
+
+  if (SameCodecSettings(config_, config) &&
+      (config.bitrate == config_.bitrate || SupportsLiveBitrate(codec_))) {
+    // Picked up by the wrapper on the next frame; no IDR, no reopen.
+    config_ = config;
+    if (!config_.use_qscale) {
+      codec_context_->bit_rate = config_.bitrate;
+    }
+    sws_context_.reset();  // Scaling options may have changed
+    return true;
+  }
+
+  // Frames queued before configure() were meant for the old settings.
+  DrainCodec();
+  config_ = config;
+  codec_context_.reset();
+  sws_context_.reset();
+  hw_scale_graph_.reset();
+  hw_scale_src_ = nullptr;
+  hw_scale_sink_ = nullptr;
+  hw_frames_ctx_.reset();
+  return InitializeCodec();
+}
+
+void VideoEncoderWorker::DrainCodec() {
+  if (codec_context_ && packet_) {
+    // Send NULL frame to flush encoder
+    avcodec_send_frame(codec_context_.get(), nullptr);
+
+    // Drain all remaining packets
+    while (avcodec_receive_packet(codec_context_.get(), packet_.get()) == 0) {
+      EmitPacket(packet_.get());
+      av_packet_unref(packet_.get());
+    }
+  }
+
+  frame_info_.Clear();
+  input_timestamps_.clear();
+  input_timestamps_base_ = 0;
+}
+
 bool VideoEncoderWorker::InitializeCodec() {
   // Find encoder based on codec string
   AVCodecID codec_id = AV_CODEC_ID_NONE;
@@ -72,37 +244,19 @@ bool VideoEncoderWorker::InitializeCodec() {
     return false;
   }
 
-  // Try hardware encoders first based on platform and hardwareAcceleration
+  // Try hardware encoders first based on platform and hardwareAcceleration,
+  // skipping any that recently failed to open on this machine.
   codec_ = nullptr;
-  const std::string& hw_accel = config_.hw_accel;
-
-  if (hw_accel != "prefer-software") {
-#ifdef __APPLE__
-    if (codec_id == AV_CODEC_ID_H264) {
-      codec_ = avcodec_find_encoder_by_name("h264_videotoolbox");
-    } else if (codec_id == AV_CODEC_ID_HEVC) {
-      codec_ = avcodec_find_encoder_by_name("hevc_videotoolbox");
-    }
-#endif
-#ifdef _WIN32
-    if (codec_id == AV_CODEC_ID_H264) {
-      codec_ = avcodec_find_encoder_by_name("h264_nvenc");
-      if (!codec_) codec_ = avcodec_find_encoder_by_name("h264_qsv");
-      if (!codec_) codec_ = avcodec_find_encoder_by_name("h264_amf");
-    } else if (codec_id == AV_CODEC_ID_HEVC) {
-      codec_ = avcodec_find_encoder_by_name("hevc_nvenc");
-      if (!codec_) codec_ = avcodec_find_encoder_by_name("hevc_qsv");
-    }
-#endif
-#ifdef __linux__
-    if (codec_id == AV_CODEC_ID_H264) {
-      codec_ = avcodec_find_encoder_by_name("h264_vaapi");
-      if (!codec_) codec_ = avcodec_find_encoder_by_name("h264_nvenc");
-    } else if (codec_id == AV_CODEC_ID_HEVC) {
-      codec_ = avcodec_find_encoder_by_name("hevc_vaapi");
-      if (!codec_) codec_ = avcodec_find_encoder_by_name("hevc_nvenc");
+  CodecCapabilities& capabilities = CodecCapabilities::Instance();
+  if (config_.hw_accel != "prefer-software") {
+    for (const char* name : HardwareEncoderNames(codec_id)) {
+      if (!capabilities.HardwareRecentlyFailed(name)) {
+        codec_ = FindEncoderByName(name);
+      }
+      if (codec_) {
+        break;
+      }
     }
-#endif
   }
 
   // Fallback to software encoder
@@ -111,20 +265,23 @@ bool VideoEncoderWorker::InitializeCodec() {
   // hardware encoder (e.g., VideoToolbox on macOS).
   if (!codec_) {
     if (codec_id == AV_CODEC_ID_H264) {
-      codec_ = avcodec_find_encoder_by_name("libx264");
+      codec_ = FindEncoderByName("libx264");
     } else if (codec_id == AV_CODEC_ID_HEVC) {
-      codec_ = avcodec_find_encoder_by_name("libx265");
+      codec_ = FindEncoderByName("libx265");
     } else if (codec_id == AV_CODEC_ID_VP8) {
-      codec_ = avcodec_find_encoder_by_name("libvpx");
+      codec_ = FindEncoderByName("libvpx");
     } else if (codec_id == AV_CODEC_ID_VP9) {
-      codec_ = avcodec_find_encoder_by_name("libvpx-vp9");
+      codec_ = FindEncoderByName("libvpx-vp9");
     } else if (codec_id == AV_CODEC_ID_AV1) {
-      codec_ = avcodec_find_encoder_by_name("libsvtav1");
-      if (!codec_) codec_ = avcodec_find_encoder_by_name("libaom-av1");
+      codec_ = FindEncoderByName("libsvtav1");
+      if (!codec_) codec_ = FindEncoderByName("libaom-av1");
     }
     // Final fallback to generic encoder lookup
     if (!codec_) {
-      codec_ = avcodec_find_encoder(codec_id);
+      codec_ = FindEncoder(codec_id);
+      if (codec_ && capabilities.HardwareRecentlyFailed(codec_->name)) {
+        codec_ = nullptr;  // The default is a hardware encoder that failed
+      }
     }
   }
 
@@ -146,12 +303,21 @@ bool VideoEncoderWorker::InitializeCodec() {
   codec_context_->time_base = {1, config_.framerate};
   codec_context_->framerate = {config_.framerate, 1};
   codec_context_->pix_fmt = AV_PIX_FMT_YUV420P;
-  codec_context_->gop_size = config_.gop_size;
-  // CRITICAL: Disable B-frames for reliable keyframe control.
-  // B-frames cause frame reordering which breaks pict_type hints.
-  // Per WebCodecs spec, when keyFrame=true, the output MUST be a keyframe,
-  // which requires no frame reordering.
-  codec_context_->max_b_frames = 0;
+  if (hw_frames_ctx_) {
+    // Encode straight from GPU surfaces (see BindHardwareFrames)
+    auto* frames = reinterpret_cast<AVHWFramesContext*>(hw_frames_ctx_->data);
+    codec_context_->pix_fmt = frames->format;
+    codec_context_->sw_pix_fmt = frames->sw_format;
+    codec_context_->hw_frames_ctx = av_buffer_ref(hw_frames_ctx_.get());
+  }
+  // With temporal layers, automatic key frames land on base-layer frames.
+  int period = TemporalLayerPeriod(config_.temporal_layer_count);
+  codec_context_->gop_size = (config_.gop_size + period - 1) / period * period;
+  // B-frames only outside realtime mode (see VideoEncoder::Configure).
+  // Forced keyframes still work with reordering because the encoders below
+  // are opened with forced-idr; chunks carry the encoder's DTS so reordered
+  // output can be muxed directly.
+  codec_context_->max_b_frames = config_.max_b_frames;
 
   if (config_.use_qscale) {
     codec_context_->flags |= AV_CODEC_FLAG_QSCALE;
@@ -172,41 +338,9 @@ bool VideoEncoderWorker::InitializeCodec() {
                  strstr(codec_->name, "vaapi") != nullptr ||
                  strstr(codec_->name, "amf") != nullptr);
 
-  // Detect specific software encoder libraries
-  bool is_libx264 = codec_ && strcmp(codec_->name, "libx264") == 0;
-  bool is_libx265 = codec_ && strcmp(codec_->name, "libx265") == 0;
-  bool is_libvpx =
-      codec_ && (strcmp(codec_->name, "libvpx") == 0 ||
-                 strcmp(codec_->name, "libvpx-vp9") == 0);
-  bool is_libaom = codec_ && strcmp(codec_->name, "libaom-av1") == 0;
-  bool is_libsvtav1 = codec_ && strcmp(codec_->name, "libsvtav1") == 0;
-
   // Codec-specific options
   if (!is_hw_encoder) {
-    if (codec_id == AV_CODEC_ID_H264 && is_libx264) {
-      av_opt_set(codec_context_->priv_data, "preset", "fast", 0);
-      av_opt_set(codec_context_->priv_data, "tune", "zerolatency", 0);
-      // CRITICAL: Enable forced-idr so pict_type=I produces IDR frames
-      // Without this, x264 may ignore the pict_type hint
-      av_opt_set(codec_context_->priv_data, "forced-idr", "1", 0);
-      if (config_.use_qscale) {
-        av_opt_set_int(codec_context_->priv_data, "qp", 23, 0);
-      }
-    } else if ((codec_id == AV_CODEC_ID_VP8 || codec_id == AV_CODEC_ID_VP9) &&
-               is_libvpx) {
-      av_opt_set(codec_context_->priv_data, "quality", "realtime", 0);
-      av_opt_set(codec_context_->priv_data, "speed", "6", 0);
-      codec_context_->max_b_frames = 0;
-    } else if (codec_id == AV_CODEC_ID_AV1 && is_libaom) {
-      av_opt_set(codec_context_->priv_data, "cpu-used", "8", 0);
-    } else if (codec_id == AV_CODEC_ID_AV1 && is_libsvtav1) {
-      av_opt_set(codec_context_->priv_data, "preset", "8", 0);
-    } else if (codec_id == AV_CODEC_ID_HEVC && is_libx265) {
-      av_opt_set(codec_context_->priv_data, "preset", "fast", 0);
-      // Enable forced-idr for keyframe control
-      av_opt_set(codec_context_->priv_data, "x265-params",
-                 "bframes=0:forced-idr=1", 0);
-    }
+    ApplyEncoderProfile(codec_context_.get());
   }
 
   // Hardware encoder-specific options
@@ -216,55 +350,26 @@ bool VideoEncoderWorker::InitializeCodec() {
     }
   }
 
+  ApplyThreadingConfig(codec_context_.get(), config_.threading);
+
   int ret = avcodec_open2(codec_context_.get(), codec_, nullptr);
 
-  // If hardware encoder failed, fall back to software encoder
+  // Encoder refused the surfaces: reopen on system memory and download
+  if (ret < 0 && hw_frames_ctx_) {
+    codec_context_.reset();
+    hw_frames_ctx_.reset();
+    hw_scale_graph_.reset();
+    hw_scale_src_ = nullptr;
+    hw_scale_sink_ = nullptr;
+    return InitializeCodec();
+  }
+
+  // If the hardware encoder failed, remember it and start over: the next
+  // candidate (or the software encoder) is picked without retrying it.
   if (ret < 0 && is_hw_encoder) {
+    capabilities.MarkHardwareFailed(codec_->name);
     codec_context_.reset();
-    codec_ = avcodec_find_encoder(codec_id);
-    if (codec_) {
-      codec_context_ = ffmpeg::make_codec_context(codec_);
-      if (codec_context_) {
-        // Reconfigure for software
-        codec_context_->width = config_.width;
-        codec_context_->height = config_.height;
-        codec_context_->time_base = {1, config_.framerate};
-        codec_context_->framerate = {config_.framerate, 1};
-        codec_context_->pix_fmt = AV_PIX_FMT_YUV420P;
-        codec_context_->gop_size = config_.gop_size;
-        // Disable B-frames for reliable keyframe control
-        codec_context_->max_b_frames = 0;
-
-        if (config_.use_qscale) {
-          codec_context_->flags |= AV_CODEC_FLAG_QSCALE;
-          codec_context_->global_quality = FF_QP2LAMBDA * 23;
-        } else {
-          codec_context_->bit_rate = config_.bitrate;
-        }
-
-        if (config_.bitstream_format != "annexb") {
-          codec_context_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
-        }
-
-        // Set software encoder-specific options
-        if (codec_id == AV_CODEC_ID_H264 &&
-            strcmp(codec_->name, "libx264") == 0) {
-          av_opt_set(codec_context_->priv_data, "preset", "fast", 0);
-          av_opt_set(codec_context_->priv_data, "tune", "zerolatency", 0);
-          av_opt_set(codec_context_->priv_data, "forced-idr", "1", 0);
-          if (config_.use_qscale) {
-            av_opt_set_int(codec_context_->priv_data, "qp", 23, 0);
-          }
-        } else if (codec_id == AV_CODEC_ID_HEVC &&
-                   strcmp(codec_->name, "libx265") == 0) {
-          av_opt_set(codec_context_->priv_data, "preset", "fast", 0);
-          av_opt_set(codec_context_->priv_data, "x265-params",
-                     "bframes=0:forced-idr=1", 0);
-        }
-
-        ret = avcodec_open2(codec_context_.get(), codec_, nullptr);
-      }
-    }
+    return InitializeCodec();
   }
 
   if (ret < 0) {
@@ -273,9 +378,11 @@ bool VideoEncoderWorker::InitializeCodec() {
     return false;
   }
 
-  // Allocate frame and packet
+  // Allocate frame and packet. Hardware-frame encoders get a staging frame
+  // in the surface's sw_format, used to upload system-memory input.
   frame_ = ffmpeg::make_frame();
-  frame_->format = codec_context_->pix_fmt;
+  frame_->format = hw_frames_ctx_ ? codec_context_->sw_pix_fmt
+                                  : codec_context_->pix_fmt;
   frame_->width = config_.width;
   frame_->height = config_.height;
   ret = av_frame_get_buffer(frame_.get(), kFrameBufferAlignment);
@@ -287,17 +394,110 @@ bool VideoEncoderWorker::InitializeCodec() {
 
   packet_ = ffmpeg::make_packet();
 
-  // Setup color converter (RGBA -> YUV420P)
-  sws_context_.reset(
-      sws_getContext(config_.width, config_.height, AV_PIX_FMT_RGBA,
-                     config_.width, config_.height, AV_PIX_FMT_YUV420P,
-                     SWS_BILINEAR, nullptr, nullptr, nullptr));
+  // Color converter is created lazily, only for inputs whose format or
+  // dimensions differ from the codec's (see EnsureSwsContext).
+  sws_context_.reset();
 
+  // Sized for every frame the codec can hold before emitting its packet
+  // (delay covers lookahead; B-frames and frame threads add to it). Auto
+  // threading leaves thread_count at 0 and the library wrappers do not all
+  // report their lookahead, so quality mode budgets for both.
+  size_t threads =
+      codec_context_->thread_count > 0
+          ? static_cast<size_t>(codec_context_->thread_count)
+          : 2 * static_cast<size_t>(std::max(av_cpu_count(), 1));
+  frame_info_.Reset(
+      static_cast<size_t>(std::max(codec_context_->delay, 0)) +
+      static_cast<size_t>(std::max(codec_context_->max_b_frames, 0)) +
+      threads + (config_.realtime ? 0 : kMaxLookaheadFrames));
   frame_count_ = 0;
 
   return true;
 }
 
+void VideoEncoderWorker::ApplyEncoderProfile(AVCodecContext* ctx) const {
+  const EncoderPresetOptions& options =
+      config_.realtime ? kRealtimePresets[PresetIndex(config_.preset)]
+                       : kQualityPresets[PresetIndex(config_.preset)];
+  void* priv = ctx->priv_data;
+  const char* name = codec_->name;
+  int layers = config_.temporal_layer_count;
+
+  if (!config_.realtime && !config_.threading.specified) {
+    // FFmpeg defaults encoders to one thread; frame threads are where the
+    // throughput of lookahead encoders comes from.
+    ctx->thread_count = 0;
+    ctx->thread_type = FF_THREAD_FRAME;
+  }
+
+  if (strcmp(name, "libx264") == 0) {
+    av_opt_set(priv, "preset", options.x26x_preset, 0);
+    // zerolatency turns off B-frames and lookahead, so only use it when
+    // reordering is not wanted anyway.
+    if (config_.max_b_frames == 0) {
+      av_opt_set(priv, "tune", "zerolatency", 0);
+    }
+    // CRITICAL: Enable forced-idr so pict_type=I produces IDR frames
+    // Without this, x264 may ignore the pict_type hint
+    av_opt_set(priv, "forced-idr", "1", 0);
+    if (config_.use_qscale) {
+      av_opt_set_int(priv, "qp", 23, 0);
+    }
+  } else if (strcmp(name, "libx265") == 0) {
+    av_opt_set(priv, "preset", options.x26x_preset, 0);
+    // Enable forced-idr for keyframe control
+    std::string x265_params =
+        "bframes=" + std::to_string(config_.max_b_frames) + ":forced-idr=1";
+    av_opt_set(priv, "x265-params", x265_params.c_str(), 0);
+  } else if (strcmp(name, "libvpx") == 0 ||
+             strcmp(name, "libvpx-vp9") == 0) {
+    av_opt_set_int(priv, "speed", options.vpx_speed, 0);
+    if (config_.realtime) {
+      av_opt_set(priv, "quality", "realtime", 0);
+    } else {
+      av_opt_set(priv, "quality", "good", 0);
+      if (layers == 1) {
+        av_opt_set_int(priv, "lag-in-frames", kVpxLagInFrames, 0);
+      }
+      if (strcmp(name, "libvpx-vp9") == 0) {
+        av_opt_set_int(priv, "row-mt", 1, 0);
+      }
+    }
+    if (layers > 1) {
+      // libvpx's predefined temporal patterns (ts_layering_mode 2 and 3)
+      // match TemporalLayerId(). Each layer gets a cumulative share of the
+      // bitrate in kbps; ts_layering_mode must come last. The layer
+      // prediction structure cannot be combined with alt-ref frames or
+      // lookahead.
+      const int* shares = layers == 2 ? kTwoLayerShares : kThreeLayerShares;
+      std::string ts_params = "ts_target_bitrate=";
+      for (int i = 0; i < layers; ++i) {
+        ts_params += (i > 0 ? "," : "") +
+                     std::to_string(config_.bitrate / 1000 * shares[i] / 100);
+      }
+      ts_params += ":ts_layering_mode=" + std::to_string(layers);
+      av_opt_set(priv, "ts-parameters", ts_params.c_str(), 0);
+      av_opt_set_int(priv, "auto-alt-ref", 0, 0);
+      av_opt_set_int(priv, "lag-in-frames", 0, 0);
+    }
+    ctx->max_b_frames = 0;
+  } else if (strcmp(name, "libaom-av1") == 0) {
+    av_opt_set_int(priv, "cpu-used", options.aom_cpu_used, 0);
+    if (!config_.realtime) {
+      av_opt_set_int(priv, "row-mt", 1, 0);
+    }
+  } else if (strcmp(name, "libsvtav1") == 0) {
+    av_opt_set_int(priv, "preset", options.svt_preset, 0);
+    if (layers > 1) {
+      // A 2^(layers-1) frame prediction pyramid has exactly |layers|
+      // temporal layers, in TemporalLayerId() order.
+      std::string svt_params =
+          "hierarchical-levels=" + std::to_string(layers - 1);
+      av_opt_set(priv, "svtav1-params", svt_params.c_str(), 0);
+    }
+  }
+}
+
 bool VideoEncoderWorker::ReinitializeCodec() {
   if (!codec_) {
     return false;  // No codec to reinitialize
@@ -316,68 +516,295 @@ bool VideoEncoderWorker::ReinitializeCodec() {
   return true;
 }
 
+bool VideoEncoderWorker::EnsureSwsContext(const AVFrame* frame) {
+  // Keeps the current lease when the input geometry is unchanged.
+  SwsKey key = SwsKey::Scale(
+      frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+      codec_context_->width, codec_context_->height,
+      static_cast<AVPixelFormat>(frame_->format));
+  key.flags = config_.scaling.SwsFlags();
+  key.threads = config_.scaling.ThreadsOr(1);
+  if (!SwsPool::Instance().Ensure(&sws_context_, key)) {
+    OutputError(AVERROR(ENOMEM), "Could not create sws context");
+    return false;
+  }
+  return true;
+}
+
+bool VideoEncoderWorker::AcceptsHardwareFrames(const AVFrame* frame) const {
+  for (int i = 0;; i++) {
+    const AVCodecHWConfig* hw_config = avcodec_get_hw_config(codec_, i);
+    if (!hw_config) {
+      return false;
+    }
+    if ((hw_config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_FRAMES_CTX) &&
+        hw_config->pix_fmt == frame->format) {
+      return true;
+    }
+  }
+}
+
+bool VideoEncoderWorker::BindHardwareFrames(const AVFrame* frame) {
+  if (frame->width != config_.width || frame->height != config_.height) {
+    if (!InitHardwareScaler(frame)) {
+      return false;
+    }
+    hw_frames_ctx_.reset(
+        av_buffer_ref(av_buffersink_get_hw_frames_ctx(hw_scale_sink_)));
+  } else {
+    hw_frames_ctx_.reset(av_buffer_ref(frame->hw_frames_ctx));
+  }
+  if (!hw_frames_ctx_) {
+    hw_scale_graph_.reset();
+    hw_scale_src_ = nullptr;
+    hw_scale_sink_ = nullptr;
+    return false;
+  }
+
+  // Nothing has been sent to the encoder yet, so reopening loses no state.
+  // InitializeCodec drops hw_frames_ctx_ again if the encoder refuses it.
+  int64_t frame_count = frame_count_;
+  codec_context_.reset();
+  if (!InitializeCodec()) {
+    return false;
+  }
+  frame_count_ = frame_count;
+  return hw_frames_ctx_ != nullptr;
+}
+
+bool VideoEncoderWorker::InitHardwareScaler(const AVFrame* frame) {
+  const char* filter_name = nullptr;
+  switch (frame->format) {
+    case AV_PIX_FMT_CUDA:
+      filter_name = "scale_cuda";
+      break;
+    case AV_PIX_FMT_VAAPI:
+      filter_name = "scale_vaapi";
+      break;
+    case AV_PIX_FMT_VIDEOTOOLBOX:
+      filter_name = "scale_vt";
+      break;
+    case AV_PIX_FMT_QSV:
+      filter_name = "vpp_qsv";
+      break;
+    default:
+      return false;
+  }
+  const AVFilter* scale = avfilter_get_by_name(filter_name);
+  if (!scale) {
+    return false;  // FFmpeg built without this GPU scaler
+  }
+
+  hw_scale_graph_ = ffmpeg::make_filter_graph();
+  if (!hw_scale_graph_) {
+    return false;
+  }
+  AVFilterGraph* graph = hw_scale_graph_.get();
+
+  // buffersrc must be told about the frames context before init, so it is
+  // built with alloc + parameters_set rather than create_filter.
+  hw_scale_src_ = avfilter_graph_alloc_filter(
+      graph, avfilter_get_by_name("buffer"), "in");
+  AVBufferSrcParameters* params = av_buffersrc_parameters_alloc();
+  if (!hw_scale_src_ || !params) {
+    av_free(params);
+    hw_scale_graph_.reset();
+    return false;
+  }
+  params->format = frame->format;
+  params->width = frame->width;
+  params->height = frame->height;
+  params->time_base = {1, config_.framerate};
+  params->hw_frames_ctx = frame->hw_frames_ctx;
+  int ret = av_buffersrc_parameters_set(hw_scale_src_, params);
+  av_free(params);
+  if (ret >= 0) {
+    ret = avfilter_init_str(hw_scale_src_, nullptr);
+  }
+
+  AVFilterContext* scale_ctx = nullptr;
+  char args[64];
+  snprintf(args, sizeof(args), "w=%d:h=%d", config_.width, config_.height);
+  if (ret >= 0) {
+    ret = avfilter_graph_create_filter(&scale_ctx, scale, "scale", args,
+                                       nullptr, graph);
+  }
+  if (ret >= 0) {
+    ret = avfilter_graph_create_filter(&hw_scale_sink_,
+                                       avfilter_get_by_name("buffersink"),
+                                       "out", nullptr, nullptr, graph);
+  }
+  if (ret >= 0) ret = avfilter_link(hw_scale_src_, 0, scale_ctx, 0);
+  if (ret >= 0) ret = avfilter_link(scale_ctx, 0, hw_scale_sink_, 0);
+  if (ret >= 0) ret = avfilter_graph_config(graph, nullptr);
+
+  if (ret < 0) {
+    hw_scale_graph_.reset();
+    hw_scale_src_ = nullptr;
+    hw_scale_sink_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool VideoEncoderWorker::ScaleHardwareFrame(AVFrame* frame, AVFrame* out) {
+  int ret = av_buffersrc_add_frame_flags(hw_scale_src_, frame,
+                                         AV_BUFFERSRC_FLAG_KEEP_REF);
+  if (ret >= 0) {
+    ret = av_buffersink_get_frame(hw_scale_sink_, out);
+  }
+  if (ret < 0) {
+    OutputError(ret, "GPU scaling failed: " + FFmpegErrorString(ret));
+    return false;
+  }
+  return true;
+}
+
 void VideoEncoderWorker::OnEncode(const EncodeMessage& msg) {
-  if (!codec_context_ || !sws_context_ || !frame_ || !packet_) {
+  if (!codec_context_ || !frame_ || !packet_) {
     OutputError(AVERROR_INVALIDDATA, "Encoder not initialized");
     return;
   }
 
-  // Get frame data from the message
+  // Get frame data from the message. Hardware surfaces (e.g. VAAPI) may
+  // carry their handle outside data[0].
   AVFrame* src_frame = msg.frame.get();
-  if (!src_frame || !src_frame->data[0]) {
+  if (!src_frame || (!src_frame->data[0] && !src_frame->hw_frames_ctx)) {
     OutputError(AVERROR_INVALIDDATA, "Invalid frame data");
     return;
   }
 
-  // CRITICAL: Make frame writable before modifying
-  // This ensures we don't corrupt shared frame data
-  int ret = av_frame_make_writable(frame_.get());
-  if (ret < 0) {
-    OutputError(ret, "Failed to make frame writable: " + FFmpegErrorString(ret));
-    return;
-  }
-
-  // Get dimensions and timestamp from source frame
-  int src_width = src_frame->width;
-  int src_height = src_frame->height;
+  // Get timestamp from source frame
   int64_t timestamp = src_frame->pts;
   int64_t duration = src_frame->duration;
 
-  // For RGBA input, convert to YUV420P
-  // The source frame contains RGBA data packed in data[0]
-  const uint8_t* src_data[1] = {src_frame->data[0]};
-  int src_linesize[1] = {src_width * kBytesPerPixelRgba};
+  // A hardware encoder on the same device as a hardware decoder takes its
+  // surfaces directly, so a transcode never touches system memory.
+  if (src_frame->hw_frames_ctx && !hw_frames_ctx_ && frame_count_ == 0 &&
+      AcceptsHardwareFrames(src_frame)) {
+    if (!BindHardwareFrames(src_frame) && !codec_context_) {
+      return;  // Reopen failed; error already reported
+    }
+  }
 
-  sws_scale(sws_context_.get(), src_data, src_linesize, 0, src_height,
-            frame_->data, frame_->linesize);
+  AVFrame* enc_frame = src_frame;
+  ffmpeg::AVFramePtr downloaded;
+  ffmpeg::AVFramePtr hw_frame;
+  if (hw_frames_ctx_ && src_frame->format == codec_context_->pix_fmt) {
+    // GPU-resident path: scale on the device if needed, then encode
+    if (hw_scale_graph_) {
+      hw_frame = ffmpeg::make_frame();
+      if (!hw_frame || !ScaleHardwareFrame(src_frame, hw_frame.get())) {
+        return;  // Error already reported
+      }
+      enc_frame = hw_frame.get();
+    }
+  } else {
+    // Hardware decoder output lives in GPU surfaces; download it before
+    // handing it to a system-memory encoder
+    if (src_frame->hw_frames_ctx) {
+      downloaded = ffmpeg::make_frame();
+      int ret = downloaded
+                    ? av_hwframe_transfer_data(downloaded.get(), src_frame, 0)
+                    : AVERROR(ENOMEM);
+      if (ret < 0) {
+        OutputError(ret, "Failed to download hardware frame: " +
+                             FFmpegErrorString(ret));
+        return;
+      }
+      av_frame_copy_props(downloaded.get(), src_frame);
+      int download_bytes = av_image_get_buffer_size(
+          static_cast<AVPixelFormat>(downloaded->format), downloaded->width,
+          downloaded->height, 1);
+      if (stats() && download_bytes > 0) {
+        stats()->AddBytesCopied(static_cast<size_t>(download_bytes));
+      }
+      src_frame = downloaded.get();
+    }
+
+    // Frames already in the codec's format and size (e.g. I420 into
+    // libx264) are sent as-is; anything else goes through swscale into
+    // frame_, which is in the surfaces' sw_format for hw-frame encoders.
+    enc_frame = src_frame;
+    if (src_frame->format != frame_->format ||
+        src_frame->width != codec_context_->width ||
+        src_frame->height != codec_context_->height) {
+      if (!EnsureSwsContext(src_frame)) {
+        return;  // Error already reported
+      }
+
+      // CRITICAL: Make frame writable before modifying
+      // This ensures we don't corrupt shared frame data
+      int ret = av_frame_make_writable(frame_.get());
+      if (ret < 0) {
+        OutputError(ret,
+                    "Failed to make frame writable: " + FFmpegErrorString(ret));
+        return;
+      }
+
+      {
+        StageTimer timer(stats(), CodecStats::Stage::kConvert);
+        ret = ScaleFrame(sws_context_, frame_.get(), src_frame);
+      }
+      if (ret < 0) {
+        OutputError(ret, "Failed to convert frame: " + FFmpegErrorString(ret));
+        return;
+      }
+      enc_frame = frame_.get();
+    }
+
+    // System-memory input to a hw-frame encoder is uploaded to a surface
+    if (hw_frames_ctx_) {
+      hw_frame = ffmpeg::make_frame();
+      int ret = hw_frame ? av_hwframe_get_buffer(hw_frames_ctx_.get(),
+                                                 hw_frame.get(), 0)
+                         : AVERROR(ENOMEM);
+      if (ret >= 0) {
+        ret = av_hwframe_transfer_data(hw_frame.get(), enc_frame, 0);
+      }
+      if (ret < 0) {
+        OutputError(ret, "Failed to upload frame to hardware: " +
+                             FFmpegErrorString(ret));
+        return;
+      }
+      enc_frame = hw_frame.get();
+    }
+  }
 
   // Use frame_count_ as pts for consistent SVC layer computation
-  frame_->pts = frame_count_;
-  frame_info_[frame_count_] = std::make_pair(timestamp, duration);
+  enc_frame->pts = frame_count_;
+  frame_info_.Put(frame_count_, timestamp, duration);
+  if (frame_count_ == 0) {
+    first_frame_duration_ = duration;
+  }
+  input_timestamps_.push_back(timestamp);
 
   // Honor keyFrame flag per W3C WebCodecs spec
   // The most reliable cross-encoder method is setting pict_type = AV_PICTURE_TYPE_I
-  // This works because we configure encoders without B-frames for realtime mode.
+  // (an IDR with forced-idr, which also closes any pending B-frame group).
   if (msg.key_frame) {
-    frame_->pict_type = AV_PICTURE_TYPE_I;
-    frame_->flags |= AV_FRAME_FLAG_KEY;
+    enc_frame->pict_type = AV_PICTURE_TYPE_I;
+    enc_frame->flags |= AV_FRAME_FLAG_KEY;
   } else {
-    frame_->pict_type = AV_PICTURE_TYPE_NONE;
-    frame_->flags &= ~AV_FRAME_FLAG_KEY;
+    enc_frame->pict_type = AV_PICTURE_TYPE_NONE;
+    enc_frame->flags &= ~AV_FRAME_FLAG_KEY;
   }
 
   // Apply per-frame quantizer if stored in quality field
   // The quality field is set by the caller via src_frame->quality
   if (src_frame->quality > 0) {
-    frame_->quality = src_frame->quality;
+    enc_frame->quality = src_frame->quality;
   } else {
-    frame_->quality = 0;
+    enc_frame->quality = 0;
+  }
+  if (enc_frame != src_frame) {
+    CopyRegionsOfInterest(src_frame, enc_frame);
   }
 
   frame_count_++;
 
   // Send frame to encoder
-  ret = avcodec_send_frame(codec_context_.get(), frame_.get());
+  int ret = avcodec_send_frame(codec_context_.get(), enc_frame);
   if (ret < 0 && ret != AVERROR(EAGAIN)) {
     OutputError(ret, "Error sending frame: " + FFmpegErrorString(ret));
     return;
@@ -403,17 +830,7 @@ void VideoEncoderWorker::OnFlush(const FlushMessage& msg) {
     return;
   }
 
-  // Send NULL frame to flush encoder
-  avcodec_send_frame(codec_context_.get(), nullptr);
-
-  // Drain all remaining packets
-  while (avcodec_receive_packet(codec_context_.get(), packet_.get()) == 0) {
-    EmitPacket(packet_.get());
-    av_packet_unref(packet_.get());
-  }
-
-  // Clear frame info map after flush
-  frame_info_.clear();
+  DrainCodec();
 
   // Reinitialize codec (FFmpeg enters EOF mode after NULL frame)
   bool reinit_success = ReinitializeCodec();
@@ -443,41 +860,105 @@ void VideoEncoderWorker::OnReset() {
   packet_.reset();
   sws_context_.reset();
   codec_context_.reset();
+  hw_scale_graph_.reset();
+  hw_scale_src_ = nullptr;
+  hw_scale_sink_ = nullptr;
+  hw_frames_ctx_.reset();
   codec_ = nullptr;
 
   // Reset state
   frame_count_ = 0;
-  frame_info_.clear();
+  frame_info_.Clear();
+  input_timestamps_.clear();
+  input_timestamps_base_ = 0;
 }
 
 void VideoEncoderWorker::OnClose() {
   OnReset();
 }
 
-void VideoEncoderWorker::EmitPacket(AVPacket* pkt) {
-  // Increment pending count before async operation
-  pending_chunks_->fetch_add(1);
+void VideoEncoderWorker::SetPacketSink(PacketSink* sink, int stream_index) {
+  std::unique_lock<std::mutex> lock(sink_mutex_);
+  PacketSink* old_sink = sink_;
+  sink_ = sink;
+  sink_stream_index_ = stream_index;
+  sink_extradata_sent_ = false;
+  sink_failed_ = false;
+  if (sink_writes_ == 0) {
+    return;
+  }
+
+  // Cancel a write blocked on the old sink's full queue and wait it out,
+  // so the caller may release the old sink once this returns.
+  sink_cancel_.store(true);
+  lock.unlock();
+  old_sink->WakeWriters();
+  lock.lock();
+  sink_idle_cv_.wait(lock, [this] { return sink_writes_ == 0; });
+  sink_cancel_.store(false);
+}
 
+void VideoEncoderWorker::EndSinkWrite() {
+  {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    --sink_writes_;
+  }
+  sink_idle_cv_.notify_all();
+}
+
+void VideoEncoderWorker::EmitPacket(AVPacket* pkt) {
   // pkt->pts is the frame_index (set in OnEncode)
   int64_t frame_index = pkt->pts;
 
-  // Look up original timestamp/duration from the map
+  // Look up original timestamp/duration
   int64_t timestamp = 0;
   int64_t duration = 0;
-  auto it = frame_info_.find(frame_index);
-  if (it != frame_info_.end()) {
-    timestamp = it->second.first;
-    duration = it->second.second;
-    frame_info_.erase(it);
+  frame_info_.Take(frame_index, &timestamp, &duration);
+  int64_t decode_timestamp = DecodeTimestamp(pkt, timestamp);
+
+  PacketSink* sink;
+  int sink_stream_index;
+  bool send_extradata = false;
+  bool sink_failed;
+  {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    sink = sink_;
+    sink_stream_index = sink_stream_index_;
+    sink_failed = sink_failed_;
+    if (sink) {
+      send_extradata = !sink_extradata_sent_;
+      sink_extradata_sent_ = true;
+      if (!sink_failed) {
+        ++sink_writes_;
+      }
+    }
+  }
+  if (sink) {
+    // Packets after a sink failure are dropped; the error was reported.
+    if (!sink_failed) {
+      EmitToSink(sink, sink_stream_index, send_extradata, pkt, timestamp,
+                 decode_timestamp, duration);
+      EndSinkWrite();
+    }
+    return;
   }
 
+  // Increment pending count before async operation
+  pending_chunks_->fetch_add(1);
+
   // Create packet data
   auto packet_data = std::make_unique<EncodedPacketData>();
   packet_data->data.assign(pkt->data, pkt->data + pkt->size);
+  if (stats()) {
+    stats()->AddBytesCopied(static_cast<size_t>(pkt->size));
+  }
   packet_data->timestamp = timestamp;
+  packet_data->decode_timestamp = decode_timestamp;
   packet_data->duration = duration;
   packet_data->is_key = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
   packet_data->frame_index = frame_index;
+  packet_data->temporal_layer_id =
+      TemporalLayerId(frame_index, config_.temporal_layer_count);
   packet_data->metadata = config_;
   packet_data->pending = pending_chunks_;
 
@@ -498,19 +979,79 @@ void VideoEncoderWorker::EmitPacket(AVPacket* pkt) {
   }
 }
 
-int VideoEncoderWorker::ComputeTemporalLayerId(int64_t frame_index) const {
-  if (config_.temporal_layer_count <= 1) return 0;
+void VideoEncoderWorker::EmitToSink(PacketSink* sink, int stream_index,
+                                    bool send_extradata, AVPacket* pkt,
+                                    int64_t timestamp, int64_t decode_timestamp,
+                                    int64_t duration) {
+  if (send_extradata && codec_context_ && codec_context_->extradata &&
+      codec_context_->extradata_size > 0) {
+    sink->SetStreamExtradata(stream_index, codec_context_->extradata,
+                             codec_context_->extradata_size);
+  }
 
-  if (config_.temporal_layer_count == 2) {
-    // L1T2: alternating pattern [0, 1, 0, 1, ...]
-    return (frame_index % 2 == 0) ? 0 : 1;
+  // Shares the encoder's refcounted payload; nothing is copied.
+  ffmpeg::AVPacketPtr packet = ffmpeg::ref_packet(pkt);
+  if (!packet) {
+    OutputError(AVERROR(ENOMEM), "Failed to allocate packet");
+    return;
+  }
+  packet->stream_index = stream_index;
+  packet->pts = timestamp;
+  packet->dts = decode_timestamp;
+  packet->duration = duration;
+  packet->pos = -1;
+  packet->flags &= AV_PKT_FLAG_KEY;
+  if (!sink->WritePacket(std::move(packet), sink_cancel_)) {
+    if (sink_cancel_.load()) {
+      return;  // Detached mid-write; the packet is dropped.
+    }
+    {
+      std::lock_guard<std::mutex> lock(sink_mutex_);
+      sink_failed_ = true;
+    }
+    OutputError(AVERROR(EPIPE),
+                "InvalidStateError: Muxer stopped accepting packets");
+    return;
+  }
+
+  // One progress event in flight at a time; it reports every packet sunk
+  // until JS picks it up.
+  if (sink_unreported_->fetch_add(1) == 0 && packet_output_callback_) {
+    pending_chunks_->fetch_add(1);
+    auto progress = std::make_unique<EncodedPacketData>();
+    progress->pending = pending_chunks_;
+    progress->sink_progress = sink_unreported_;
+    packet_output_callback_(std::move(progress));
+  }
+}
+
+int64_t VideoEncoderWorker::DecodeTimestamp(const AVPacket* pkt,
+                                            int64_t timestamp) {
+  // Frame indices are assigned in presentation order, so a DTS of n is the
+  // timestamp of the n-th input frame. Reordering encoders start with
+  // negative DTS values, which come before the first frame.
+  int64_t decode_index = pkt->dts == AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+  int64_t decode_timestamp = timestamp;
+  if (decode_index < input_timestamps_base_) {
+    if (!input_timestamps_.empty()) {
+      int64_t step = first_frame_duration_ > 0
+                         ? first_frame_duration_
+                         : 1000000 / std::max(config_.framerate, 1);
+      decode_timestamp = input_timestamps_.front() -
+                         (input_timestamps_base_ - decode_index) * step;
+    }
+  } else if (decode_index - input_timestamps_base_ <
+             static_cast<int64_t>(input_timestamps_.size())) {
+    decode_timestamp =
+        input_timestamps_[decode_index - input_timestamps_base_];
   }
 
-  // L1T3: pyramid pattern [0, 2, 1, 2, 0, 2, 1, 2, ...]
-  int pos = frame_index % 4;
-  if (pos == 0) return 0;  // Base layer
-  if (pos == 2) return 1;  // Middle layer
-  return 2;                // Enhancement layer (pos 1, 3)
+  // DTS only grows, so earlier entries are no longer needed.
+  while (!input_timestamps_.empty() && input_timestamps_base_ < decode_index) {
+    input_timestamps_.pop_front();
+    input_timestamps_base_++;
+  }
+  return std::min(decode_timestamp, timestamp);
 }
 
 }  // namespace webcodecs
@@ -11,6 +11,7 @@
 
 extern "C" {
 #include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
 #include <libswscale/swscale.h>
@@ -19,20 +20,47 @@ extern "C" {
 #include <napi.h>
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
-#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "src/common.h"
 #include "src/ffmpeg_raii.h"
 #include "src/shared/codec_worker.h"
 #include "src/shared/control_message_queue.h"
+#include "src/shared/frame_info_ring.h"
+#include "src/shared/packet_sink.h"
 #include "src/shared/safe_tsfn.h"
+#include "src/sws_pool.h"
 
 namespace webcodecs {
 
+/**
+ * Frames in one cycle of the L1T2/L1T3 temporal pattern.
+ */
+inline int TemporalLayerPeriod(int temporal_layer_count) {
+  if (temporal_layer_count <= 1) return 1;
+  return temporal_layer_count == 2 ? 2 : 4;
+}
+
+/**
+ * Temporal layer of the |frame_index|-th frame since the codec was opened:
+ * L1T2 alternates [0, 1], L1T3 is the pyramid [0, 2, 1, 2]. This is the
+ * prediction structure the encoder is configured with, not a label, so a
+ * receiver may drop the upper layers.
+ */
+inline int TemporalLayerId(int64_t frame_index, int temporal_layer_count) {
+  if (temporal_layer_count <= 1) return 0;
+  if (temporal_layer_count == 2) return frame_index % 2 == 0 ? 0 : 1;
+  static constexpr int kPyramid[] = {0, 2, 1, 2};
+  return kPyramid[frame_index % 4];
+}
+
 /**
  * Encoder configuration for worker initialization.
  */
@@ -45,6 +73,11 @@ struct VideoEncoderConfig {
   int framerate = 30;
   int gop_size = 30;
   int max_b_frames = 2;
+  // latencyMode 'realtime': no lookahead or reordering.
+  bool realtime = false;
+  // Software encoder speed/quality trade-off: "speed", "balanced" or
+  // "quality" (node-webcodecs extension encoderPreset).
+  std::string preset = "balanced";
   bool use_qscale = false;
   std::string codec_string;
   std::string bitstream_format = "annexb";
@@ -52,8 +85,13 @@ struct VideoEncoderConfig {
   std::string color_transfer;
   std::string color_matrix;
   bool color_full_range = false;
+  // Temporal layers of an L1T1/L1T2/L1T3 scalabilityMode; more than one
+  // only for encoders with real temporal scalability (libvpx, SVT-AV1).
   int temporal_layer_count = 1;
   std::string hw_accel = "no-preference";
+  CodecThreadingConfig threading;
+  // Quality and slice threads of the input conversion.
+  ScalingConfig scaling;
 };
 
 /**
@@ -62,22 +100,27 @@ struct VideoEncoderConfig {
 struct EncodedPacketData {
   std::vector<uint8_t> data;
   int64_t timestamp;
+  int64_t decode_timestamp;  // Equals |timestamp| unless frames are reordered
   int64_t duration;
   bool is_key;
   int64_t frame_index;
+  int temporal_layer_id = 0;  // svc.temporalLayerId
   VideoEncoderConfig metadata;
   std::vector<uint8_t> extradata;
   std::shared_ptr<std::atomic<int>> pending;
+  // Set for progress events of a PacketSink-attached worker; no payload.
+  // Holds the count of packets sunk since the last event.
+  std::shared_ptr<std::atomic<int>> sink_progress;
 };
 
 /**
  * VideoEncoderWorker - Worker thread for video encoding operations.
  *
- * Extends CodecWorker<VideoControlQueue> to provide video-specific encoding.
+ * Extends CodecWorker<VideoWorkerQueue> to provide video-specific encoding.
  * The worker owns the AVCodecContext and processes encode operations in FIFO
  * order.
  */
-class VideoEncoderWorker : public CodecWorker<VideoControlQueue> {
+class VideoEncoderWorker : public CodecWorker<VideoWorkerQueue> {
  public:
   using PacketOutputCallback =
       std::function<void(std::unique_ptr<EncodedPacketData>)>;
@@ -88,7 +131,7 @@ class VideoEncoderWorker : public CodecWorker<VideoControlQueue> {
                          const std::string& error)>;
   using DequeueCallback = std::function<void(uint32_t new_queue_size)>;
 
-  explicit VideoEncoderWorker(VideoControlQueue* queue);
+  explicit VideoEncoderWorker(VideoWorkerQueue* queue);
   ~VideoEncoderWorker() override;
 
   // Disallow copy and assign
@@ -98,6 +141,8 @@ class VideoEncoderWorker : public CodecWorker<VideoControlQueue> {
   /**
    * Configure the encoder.
    * Called from JS thread; actual codec initialization happens on worker.
+   * On a running worker the new settings apply in order with queued
+   * frames, without a new thread (see ApplyConfig).
    *
    * @param config Encoder configuration
    * @return true if configuration was queued successfully
@@ -132,6 +177,15 @@ class VideoEncoderWorker : public CodecWorker<VideoControlQueue> {
     dequeue_callback_ = std::move(cb);
   }
 
+  /**
+   * Send packets to |sink| as stream |stream_index| instead of the packet
+   * output callback, which then only receives coalesced progress events
+   * (EncodedPacketData::sink_progress). May be called while running; a
+   * write to the previous sink is cancelled and waited for, so that sink
+   * may be released once this returns.
+   */
+  void SetPacketSink(PacketSink* sink, int stream_index);
+
   /**
    * Get pending chunks counter for JS-side polling.
    */
@@ -159,6 +213,25 @@ class VideoEncoderWorker : public CodecWorker<VideoControlQueue> {
    */
   bool InitializeCodec();
 
+  /**
+   * Switch to |config| on the worker thread. A bitrate change is applied to
+   * the open codec when its wrapper supports that (libx264, NVENC); any
+   * other codec-level change drains the encoder and reopens it.
+   */
+  bool ApplyConfig(const VideoEncoderConfig& config);
+
+  /**
+   * Send EOF and emit every packet the encoder still holds. The codec must
+   * be reopened before the next frame.
+   */
+  void DrainCodec();
+
+  /**
+   * Set the speed/quality options of software encoders for config_'s
+   * latency mode and preset. Hardware encoders keep their defaults.
+   */
+  void ApplyEncoderProfile(AVCodecContext* ctx) const;
+
   /**
    * Reinitialize codec after flush (FFmpeg enters EOF mode).
    * @return true on success, false on failure
@@ -171,9 +244,54 @@ class VideoEncoderWorker : public CodecWorker<VideoControlQueue> {
   void EmitPacket(AVPacket* pkt);
 
   /**
-   * Compute temporal layer ID for SVC.
+   * Hand |pkt| to the attached sink and schedule a progress event.
    */
-  int ComputeTemporalLayerId(int64_t frame_index) const;
+  void EmitToSink(PacketSink* sink, int stream_index, bool send_extradata,
+                  AVPacket* pkt, int64_t timestamp, int64_t decode_timestamp,
+                  int64_t duration);
+  // Ends a sink_writes_ call and wakes SetPacketSink().
+  void EndSinkWrite();
+
+  /**
+   * Map the encoder's DTS (in frame-index units) of |pkt| to microseconds.
+   * @return |timestamp| when the encoder does not reorder frames
+   */
+  int64_t DecodeTimestamp(const AVPacket* pkt, int64_t timestamp);
+
+  /**
+   * Initialize or recreate SwsContext converting |frame| to the codec's
+   * pixel format and dimensions. Called only when the input differs.
+   *
+   * @return true on success, false on error
+   */
+  bool EnsureSwsContext(const AVFrame* frame);
+
+  /**
+   * Check whether the selected encoder accepts |frame|'s hardware surfaces
+   * directly (e.g. AV_PIX_FMT_CUDA into h264_nvenc).
+   */
+  bool AcceptsHardwareFrames(const AVFrame* frame) const;
+
+  /**
+   * Reopen the encoder on |frame|'s hw_frames_ctx so GPU surfaces are
+   * encoded without a round trip through system memory. When the input
+   * size differs from the configured size a GPU scaler is set up first.
+   * Called before the first frame is encoded.
+   *
+   * @return true if the encoder now consumes hardware frames
+   */
+  bool BindHardwareFrames(const AVFrame* frame);
+
+  /**
+   * Build a scale_cuda/scale_vaapi/scale_vt/vpp_qsv graph resizing
+   * |frame|'s surfaces to the codec dimensions.
+   */
+  bool InitHardwareScaler(const AVFrame* frame);
+
+  /**
+   * Scale |frame| on the GPU into |out|.
+   */
+  bool ScaleHardwareFrame(AVFrame* frame, AVFrame* out);
 
   // Configuration
   VideoEncoderConfig config_;
@@ -181,19 +299,43 @@ class VideoEncoderWorker : public CodecWorker<VideoControlQueue> {
   // FFmpeg resources (owned by this worker)
   const AVCodec* codec_ = nullptr;
   ffmpeg::AVCodecContextPtr codec_context_;
-  ffmpeg::SwsContextPtr sws_context_;
+  SwsPool::Lease sws_context_;  // Leased from SwsPool
   ffmpeg::AVFramePtr frame_;
   ffmpeg::AVPacketPtr packet_;
 
+  // GPU-resident input: when set, the encoder was opened with this frames
+  // context and consumes hardware surfaces (see BindHardwareFrames).
+  ffmpeg::AVBufferRefPtr hw_frames_ctx_;
+  ffmpeg::AVFilterGraphPtr hw_scale_graph_;
+  AVFilterContext* hw_scale_src_ = nullptr;   // Owned by hw_scale_graph_
+  AVFilterContext* hw_scale_sink_ = nullptr;  // Owned by hw_scale_graph_
+
   // Frame tracking
   int64_t frame_count_ = 0;
-  std::map<int64_t, std::pair<int64_t, int64_t>>
-      frame_info_;  // frame_index -> (timestamp, duration)
+  FrameInfoRing frame_info_;  // frame_index -> (timestamp, duration)
+  // Input timestamps in presentation order, from frame index
+  // |input_timestamps_base_| on; maps encoder DTS back to microseconds.
+  std::deque<int64_t> input_timestamps_;
+  int64_t input_timestamps_base_ = 0;
+  int64_t first_frame_duration_ = 0;
 
   // Pending chunks counter (shared_ptr for safe access in TSFN callbacks)
   std::shared_ptr<std::atomic<int>> pending_chunks_ =
       std::make_shared<std::atomic<int>>(0);
 
+  // Native packet destination; fields guarded by sink_mutex_.
+  std::mutex sink_mutex_;
+  PacketSink* sink_ = nullptr;
+  int sink_stream_index_ = -1;
+  bool sink_extradata_sent_ = false;
+  bool sink_failed_ = false;
+  int sink_writes_ = 0;  // Calls into sink_ in progress
+  std::condition_variable sink_idle_cv_;  // Signalled as sink_writes_ drops
+  std::atomic<bool> sink_cancel_{false};  // Set while SetPacketSink() waits
+  // Packets sunk but not yet reported; an event is scheduled on 0 -> 1.
+  std::shared_ptr<std::atomic<int>> sink_unreported_ =
+      std::make_shared<std::atomic<int>>(0);
+
   // Callbacks
   PacketOutputCallback packet_output_callback_;
   ErrorCallback error_output_callback_;
@@ -5,6 +5,9 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -18,6 +21,9 @@ Napi::Object VideoFilter::Init(Napi::Env env, Napi::Object exports) {
       {
           InstanceMethod("configure", &VideoFilter::Configure),
           InstanceMethod("applyBlur", &VideoFilter::ApplyBlur),
+          InstanceMethod("configureGraph", &VideoFilter::ConfigureGraph),
+          InstanceMethod("process", &VideoFilter::Process),
+          InstanceMethod("flush", &VideoFilter::Flush),
           InstanceMethod("close", &VideoFilter::Close),
           InstanceAccessor("state", &VideoFilter::GetState, nullptr),
       });
@@ -30,6 +36,12 @@ VideoFilter::VideoFilter(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<VideoFilter>(info),
       buffersrc_ctx_(nullptr),
       buffersink_ctx_(nullptr),
+      next_pts_(0),
+      custom_output_count_(0),
+      custom_configured_(false),
+      next_ticket_(0),
+      serving_ticket_(0),
+      closed_(false),
       width_(0),
       height_(0),
       state_("unconfigured") {}
@@ -38,12 +50,10 @@ VideoFilter::~VideoFilter() { Cleanup(); }
 
 void VideoFilter::Cleanup() {
   filter_graph_.reset();
-  sws_rgba_to_yuv_.reset();
-  sws_yuv_to_rgba_.reset();
-  yuv_frame_.reset();
-  output_frame_.reset();
   buffersrc_ctx_ = nullptr;
   buffersink_ctx_ = nullptr;
+  graph_key_ = GraphKey();
+  graph_regions_.clear();
 }
 
 Napi::Value VideoFilter::GetState(const Napi::CallbackInfo& info) {
@@ -51,10 +61,44 @@ Napi::Value VideoFilter::GetState(const Napi::CallbackInfo& info) {
 }
 
 void VideoFilter::Close(const Napi::CallbackInfo& info) {
+  // Wait for a running worker; queued ones see closed_ and reject.
+  std::lock_guard<std::mutex> lock(graph_mutex_);
+  closed_ = true;
+  custom_graph_.reset();
+  custom_sources_.clear();
+  custom_sinks_.clear();
+  custom_configured_ = false;
   Cleanup();
   state_ = "closed";
 }
 
+namespace {
+
+// "pix_fmts=" argument listing every format a VideoFrame can hold, so graph
+// outputs are always convertible.
+const std::string& OutputFormatsArg() {
+  static const std::string arg = [] {
+    std::string list;
+    const AVPixFmtDescriptor* desc = nullptr;
+    while ((desc = av_pix_fmt_desc_next(desc))) {
+      AVPixelFormat format = av_pix_fmt_desc_get_id(desc);
+      if (PixelFormatFromAV(format) != PixelFormat::UNKNOWN) {
+        list += (list.empty() ? "" : "|") + std::string(desc->name);
+      }
+    }
+    return "pix_fmts=" + list;
+  }();
+  return arg;
+}
+
+// Pad label of graph input/output |index|: a lone pad is "in"/"out", which
+// libavfilter lets the description leave out.
+std::string PadLabel(const char* prefix, size_t index, size_t count) {
+  return count == 1 ? prefix : prefix + std::to_string(index);
+}
+
+}  // namespace
+
 Napi::Value VideoFilter::Configure(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -87,112 +131,212 @@ Napi::Value VideoFilter::Configure(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  // Initialize swscale contexts for RGBA <-> YUV420P conversion
-  sws_rgba_to_yuv_.reset(sws_getContext(
-      width_, height_, AV_PIX_FMT_RGBA, width_, height_, AV_PIX_FMT_YUV420P,
-      SWS_BILINEAR, nullptr, nullptr, nullptr));
-
-  sws_yuv_to_rgba_.reset(
-      sws_getContext(width_, height_, AV_PIX_FMT_YUV420P, width_, height_,
-                     AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr, nullptr, nullptr));
-
-  if (!sws_rgba_to_yuv_ || !sws_yuv_to_rgba_) {
-    Cleanup();
-    Napi::Error::New(env, "Failed to create swscale contexts")
-        .ThrowAsJavaScriptException();
-    return env.Undefined();
-  }
-
-  // Allocate YUV frame for filter input
-  yuv_frame_ = ffmpeg::make_frame();
-  yuv_frame_->format = AV_PIX_FMT_YUV420P;
-  yuv_frame_->width = width_;
-  yuv_frame_->height = height_;
-  av_frame_get_buffer(yuv_frame_.get(), 0);
-
-  // Allocate output frame
-  output_frame_ = ffmpeg::make_frame();
-
+  // The graph is built lazily for the first frame's size and format.
+  Cleanup();
   state_ = "configured";
   return env.Undefined();
 }
 
-std::string VideoFilter::BuildFilterString(
-    const std::vector<std::tuple<int, int, int, int>>& regions,
-    int blur_strength) {
-  // If no regions, return null filter (passthrough)
-  if (regions.empty()) {
-    return "null";
+std::vector<VideoFilter::Region> VideoFilter::ClampRegions(
+    const std::vector<Region>& regions, int width, int height) {
+  std::vector<Region> clamped;
+  clamped.reserve(regions.size());
+  for (const Region& region : regions) {
+    int x = std::max(0, std::min(std::get<0>(region), width - 1));
+    int y = std::max(0, std::min(std::get<1>(region), height - 1));
+    int w = std::min(std::get<2>(region), width - x);
+    int h = std::min(std::get<3>(region), height - y);
+    if (w > 0 && h > 0) {
+      clamped.emplace_back(x, y, w, h);
+    }
   }
+  return clamped;
+}
 
-  // Build filter: for each region, crop blurred area and overlay
-  // Strategy: blur entire frame, then overlay original except for regions
+std::string VideoFilter::BuildFilterString(const std::vector<Region>& regions,
+                                           int radius) {
+  // Strategy: blur the entire frame, then overlay blurred crops of each
+  // region onto the original. Crops and overlays are named so their
+  // geometry can be changed later with filter commands.
   std::ostringstream oss;
-
-  // boxblur uses radius:power format. strength 1-100 maps to radius 1-50
-  int radius = std::max(1, blur_strength / 2);
-
-  // Split input into original and blurred version
   oss << "[in]split=2[orig][toblur];";
-  oss << "[toblur]boxblur=" << radius << ":1[blurred];";
+  oss << "[toblur]boxblur=" << radius << ":1,split=" << regions.size();
+  for (size_t i = 0; i < regions.size(); ++i) {
+    oss << "[blurred" << i << "]";
+  }
+  oss << ";";
 
-  // For each region, crop from blurred and overlay onto original
   std::string current = "orig";
   for (size_t i = 0; i < regions.size(); ++i) {
     int x = std::get<0>(regions[i]);
     int y = std::get<1>(regions[i]);
     int w = std::get<2>(regions[i]);
     int h = std::get<3>(regions[i]);
+    std::string next = "tmp" + std::to_string(i);
 
-    // Clamp to frame bounds
-    x = std::max(0, std::min(x, width_ - 1));
-    y = std::max(0, std::min(y, height_ - 1));
-    w = std::min(w, width_ - x);
-    h = std::min(h, height_ - y);
+    oss << "[blurred" << i << "]crop@crop" << i << "=w=" << w << ":h=" << h
+        << ":x=" << x << ":y=" << y << ":exact=1[crop" << i << "];";
+    oss << "[" << current << "][crop" << i << "]overlay@overlay" << i
+        << "=x=" << x << ":y=" << y << ":format=auto[" << next << "];";
+    current = next;
+  }
 
-    if (w <= 0 || h <= 0) continue;
+  oss << "[" << current << "]null[out]";
+  return oss.str();
+}
 
-    std::string crop_label = "crop" + std::to_string(i);
-    std::string out_label =
-        (i == regions.size() - 1) ? "out" : ("tmp" + std::to_string(i));
+bool VideoFilter::BuildGraph(const GraphKey& key,
+                             const std::vector<Region>& regions,
+                             std::string* error) {
+  Cleanup();
 
-    oss << "[blurred]crop=" << w << ":" << h << ":" << x << ":" << y << "["
-        << crop_label << "];";
-    oss << "[" << current << "][" << crop_label << "]overlay=" << x << ":" << y
-        << "[" << out_label << "]";
+  filter_graph_ = ffmpeg::make_filter_graph();
+  if (!filter_graph_) {
+    *error = "Failed to allocate filter graph";
+    return false;
+  }
 
-    if (i < regions.size() - 1) {
-      oss << ";";
-    }
-    current = out_label;
+  const AVFilter* buffersrc = avfilter_get_by_name("buffer");
+  const AVFilter* buffersink = avfilter_get_by_name("buffersink");
+
+  // Microsecond time base; pts are assigned by ProcessFrame().
+  char args[512];
+  snprintf(args, sizeof(args),
+           "video_size=%dx%d:pix_fmt=%d:time_base=1/1000000:pixel_aspect=1/1",
+           key.width, key.height, key.format);
+
+  int ret = avfilter_graph_create_filter(&buffersrc_ctx_, buffersrc, "in", args,
+                                         nullptr, filter_graph_.get());
+  if (ret < 0) {
+    Cleanup();
+    *error = "Failed to create buffer source";
+    return false;
   }
 
-  return oss.str();
+  ret = avfilter_graph_create_filter(&buffersink_ctx_, buffersink, "out",
+                                     nullptr, nullptr, filter_graph_.get());
+  if (ret < 0) {
+    Cleanup();
+    *error = "Failed to create buffer sink";
+    return false;
+  }
+
+  // Hand frames back in the caller's pixel format; libavfilter inserts any
+  // conversions the blur filters need.
+  std::string filter_str = BuildFilterString(regions, key.radius);
+  const char* format_name =
+      av_get_pix_fmt_name(static_cast<AVPixelFormat>(key.format));
+  if (format_name) {
+    filter_str += ";[out]format=pix_fmts=" + std::string(format_name) +
+                  "[formatted]";
+  }
+  const char* sink_label = format_name ? "formatted" : "out";
+
+  // Parse and link filter graph (RAII for initial allocation safety)
+  ffmpeg::AVFilterInOutPtr outputs_raii = ffmpeg::make_filter_inout();
+  ffmpeg::AVFilterInOutPtr inputs_raii = ffmpeg::make_filter_inout();
+
+  if (!outputs_raii || !inputs_raii) {
+    Cleanup();
+    *error = "Failed to allocate filter inout";
+    return false;
+  }
+
+  outputs_raii->name = av_strdup("in");
+  outputs_raii->filter_ctx = buffersrc_ctx_;
+  outputs_raii->pad_idx = 0;
+  outputs_raii->next = nullptr;
+
+  inputs_raii->name = av_strdup(sink_label);
+  inputs_raii->filter_ctx = buffersink_ctx_;
+  inputs_raii->pad_idx = 0;
+  inputs_raii->next = nullptr;
+
+  // Release ownership before parse_ptr (it may modify/consume the pointers)
+  AVFilterInOut* outputs = outputs_raii.release();
+  AVFilterInOut* inputs = inputs_raii.release();
+
+  ret = avfilter_graph_parse_ptr(filter_graph_.get(), filter_str.c_str(),
+                                 &inputs, &outputs, nullptr);
+  // parse_ptr may have modified pointers, free remaining
+  avfilter_inout_free(&inputs);
+  avfilter_inout_free(&outputs);
+
+  if (ret < 0) {
+    Cleanup();
+    *error = "Failed to parse filter graph: " + filter_str;
+    return false;
+  }
+
+  ret = avfilter_graph_config(filter_graph_.get(), nullptr);
+  if (ret < 0) {
+    Cleanup();
+    *error = webcodecs::FFmpegErrorString(ret);
+    *error = "Failed to configure filter graph: " + *error;
+    return false;
+  }
+
+  graph_key_ = key;
+  graph_regions_ = regions;
+  return true;
 }
 
-// InitFilterGraph not needed - filter graph is built dynamically per-frame
-// based on blur regions. See BuildFilterString() for filter construction.
+bool VideoFilter::UpdateRegions(const std::vector<Region>& regions) {
+  char arg[32];
+  for (size_t i = 0; i < regions.size(); ++i) {
+    if (regions[i] == graph_regions_[i]) {
+      continue;
+    }
+    // Record the change first: a failed command leaves the graph in an
+    // unknown state and the caller rebuilds it.
+    graph_regions_[i] = regions[i];
+
+    std::string crop = "crop@crop" + std::to_string(i);
+    std::string overlay = "overlay@overlay" + std::to_string(i);
+    const int values[] = {std::get<2>(regions[i]), std::get<3>(regions[i]),
+                          std::get<0>(regions[i]), std::get<1>(regions[i])};
+    const char* crop_commands[] = {"w", "h", "x", "y"};
+    for (int c = 0; c < 4; ++c) {
+      snprintf(arg, sizeof(arg), "%d", values[c]);
+      if (avfilter_graph_send_command(filter_graph_.get(), crop.c_str(),
+                                      crop_commands[c], arg, nullptr, 0,
+                                      0) < 0) {
+        return false;
+      }
+    }
+    for (int c = 2; c < 4; ++c) {
+      snprintf(arg, sizeof(arg), "%d", values[c]);
+      if (avfilter_graph_send_command(filter_graph_.get(), overlay.c_str(),
+                                      crop_commands[c], arg, nullptr, 0,
+                                      0) < 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 
-AVFrame* VideoFilter::ProcessFrame(AVFrame* input) {
+ffmpeg::AVFramePtr VideoFilter::ProcessFrame(AVFrame* input) {
   // Safety check: filter contexts must be valid
   if (!buffersrc_ctx_ || !buffersink_ctx_) {
     return nullptr;
   }
 
-  // This processes a YUV frame through the filter graph
-  // Returns filtered frame (caller does NOT own - internal buffer)
+  // The graph lives across calls, so its overlays need increasing pts even
+  // when callers filter frames out of order.
+  input->pts = next_pts_++;
+
   int ret = av_buffersrc_add_frame_flags(buffersrc_ctx_, input,
                                          AV_BUFFERSRC_FLAG_KEEP_REF);
   if (ret < 0) {
     return nullptr;
   }
 
-  ret = av_buffersink_get_frame(buffersink_ctx_, output_frame_.get());
-  if (ret < 0) {
+  ffmpeg::AVFramePtr output = ffmpeg::make_frame();
+  if (!output || av_buffersink_get_frame(buffersink_ctx_, output.get()) < 0) {
     return nullptr;
   }
-
-  return output_frame_.get();
+  return output;
 }
 
 Napi::Value VideoFilter::ApplyBlur(const Napi::CallbackInfo& info) {
@@ -225,9 +369,15 @@ Napi::Value VideoFilter::ApplyBlur(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
+  if (!info[1].IsArray()) {
+    Napi::TypeError::New(env, "regions must be an array")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
   // Get regions array
   Napi::Array regions_arr = info[1].As<Napi::Array>();
-  std::vector<std::tuple<int, int, int, int>> regions;
+  std::vector<Region> regions;
 
   for (uint32_t i = 0; i < regions_arr.Length(); ++i) {
     Napi::Object region = regions_arr.Get(i).As<Napi::Object>();
@@ -245,132 +395,463 @@ Napi::Value VideoFilter::ApplyBlur(const Napi::CallbackInfo& info) {
     blur_strength = std::max(1, std::min(100, blur_strength));
   }
 
-  // If no regions, create a clone of the original frame
-  if (regions.empty()) {
-    return VideoFrame::CreateInstance(
-        env, video_frame->GetData(), video_frame->GetDataSize(),
-        video_frame->GetWidth(), video_frame->GetHeight(),
-        video_frame->GetTimestampValue(), "RGBA");
+  int width = video_frame->GetWidth();
+  int height = video_frame->GetHeight();
+  int64_t timestamp = video_frame->GetTimestampValue();
+  PixelFormat format = video_frame->GetFormat();
+  AVPixelFormat av_format = PixelFormatToAV(format);
+  if (av_format == AV_PIX_FMT_NONE) {
+    Napi::TypeError::New(env, "Unsupported VideoFrame format")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
   }
 
-  // Get RGBA data from frame
-  uint8_t* rgba_data = video_frame->GetData();
-  int64_t timestamp = video_frame->GetTimestampValue();
+  // Reference the frame's planes where possible instead of copying them.
+  ffmpeg::AVFramePtr input = ffmpeg::make_frame();
+  if (!video_frame->RefAVFrame(input.get())) {
+    Napi::Error::New(env, "Failed to reference VideoFrame data")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
 
-  // Build and initialize filter graph for these regions
-  std::string filter_str = BuildFilterString(regions, blur_strength);
+  std::vector<Region> clamped = ClampRegions(regions, width, height);
 
-  // Clean up previous filter graph
-  filter_graph_.reset();
+  // Nothing to blur: hand back the same pixels.
+  if (clamped.empty()) {
+    return VideoFrame::CreateInstance(env, std::move(input), timestamp, 0,
+                                      false, width, height);
+  }
 
-  filter_graph_ = ffmpeg::make_filter_graph();
-  if (!filter_graph_) {
-    Napi::Error::New(env, "Failed to allocate filter graph")
+  // boxblur uses radius:power format. strength 1-100 maps to radius 1-50
+  GraphKey key;
+  key.width = width;
+  key.height = height;
+  key.format = av_format;
+  key.radius = std::max(1, blur_strength / 2);
+  key.regions = clamped.size();
+
+  // Reuse the graph if only region geometry changed; rebuild when its shape
+  // changed or a filter rejects the new geometry.
+  if (!filter_graph_ || !(key == graph_key_) || !UpdateRegions(clamped)) {
+    std::string error;
+    if (!BuildGraph(key, clamped, &error)) {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
+
+  ffmpeg::AVFramePtr filtered = ProcessFrame(input.get());
+  if (!filtered) {
+    // Leave no half-fed graph behind for the next frame.
+    Cleanup();
+    Napi::Error::New(env, "Filter processing failed")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
-  // Create buffer source
-  const AVFilter* buffersrc = avfilter_get_by_name("buffer");
-  const AVFilter* buffersink = avfilter_get_by_name("buffersink");
+  return VideoFrame::CreateInstance(env, std::move(filtered), timestamp, 0,
+                                    false, width, height);
+}
 
-  char args[512];
-  snprintf(args, sizeof(args),
-           "video_size=%dx%d:pix_fmt=%d:time_base=1/30:pixel_aspect=1/1",
-           width_, height_, AV_PIX_FMT_YUV420P);
+Napi::Value VideoFilter::ConfigureGraph(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-  int ret = avfilter_graph_create_filter(&buffersrc_ctx_, buffersrc, "in", args,
-                                         nullptr, filter_graph_.get());
-  if (ret < 0) {
-    Napi::Error::New(env, "Failed to create buffer source")
+  if (state_ == "closed") {
+    Napi::Error::New(env, "VideoFilter is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Config object required")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
-  ret = avfilter_graph_create_filter(&buffersink_ctx_, buffersink, "out",
-                                     nullptr, nullptr, filter_graph_.get());
-  if (ret < 0) {
-    Napi::Error::New(env, "Failed to create buffer sink")
+  Napi::Object config = info[0].As<Napi::Object>();
+  std::string description = webcodecs::AttrAsStr(config, "graph");
+  if (description.empty()) {
+    Napi::TypeError::New(env, "graph description required")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
-  // Parse and link filter graph (RAII for initial allocation safety)
-  ffmpeg::AVFilterInOutPtr outputs_raii = ffmpeg::make_filter_inout();
-  ffmpeg::AVFilterInOutPtr inputs_raii = ffmpeg::make_filter_inout();
+  if (!config.Has("inputs") || !config.Get("inputs").IsArray() ||
+      config.Get("inputs").As<Napi::Array>().Length() == 0) {
+    Napi::TypeError::New(env, "inputs must be a non-empty array")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
 
-  if (!outputs_raii || !inputs_raii) {
-    Napi::Error::New(env, "Failed to allocate filter inout")
+  Napi::Array inputs_arr = config.Get("inputs").As<Napi::Array>();
+  std::vector<GraphInput> inputs;
+  for (uint32_t i = 0; i < inputs_arr.Length(); ++i) {
+    if (!inputs_arr.Get(i).IsObject()) {
+      Napi::TypeError::New(env, "each input must be an object")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Object input_obj = inputs_arr.Get(i).As<Napi::Object>();
+    GraphInput input;
+    input.width = webcodecs::AttrAsInt32(input_obj, "width", 0);
+    input.height = webcodecs::AttrAsInt32(input_obj, "height", 0);
+    input.format = PixelFormatToAV(
+        ParsePixelFormat(webcodecs::AttrAsStr(input_obj, "format", "I420")));
+    if (input.width <= 0 || input.height <= 0) {
+      Napi::RangeError::New(env, "input width and height must be positive")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (input.format == AV_PIX_FMT_NONE) {
+      Napi::TypeError::New(env, "Unsupported input format")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (input_obj.Has("frameRate") && input_obj.Get("frameRate").IsNumber()) {
+      double frame_rate = input_obj.Get("frameRate").As<Napi::Number>();
+      if (frame_rate > 0) {
+        input.frame_rate = av_d2q(frame_rate, 1000000);
+      }
+    }
+    inputs.push_back(input);
+  }
+
+  int output_count = webcodecs::AttrAsInt32(config, "outputs", 1);
+  if (output_count <= 0) {
+    Napi::RangeError::New(env, "outputs must be positive")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
-  outputs_raii->name = av_strdup("in");
-  outputs_raii->filter_ctx = buffersrc_ctx_;
-  outputs_raii->pad_idx = 0;
-  outputs_raii->next = nullptr;
+  // Build now so a bad description fails here rather than in process().
+  std::lock_guard<std::mutex> lock(graph_mutex_);
+  custom_description_ = description;
+  custom_inputs_ = std::move(inputs);
+  custom_output_count_ = static_cast<size_t>(output_count);
+  std::string error;
+  if (!BuildCustomGraph(&error)) {
+    custom_configured_ = false;
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
 
-  inputs_raii->name = av_strdup("out");
-  inputs_raii->filter_ctx = buffersink_ctx_;
-  inputs_raii->pad_idx = 0;
-  inputs_raii->next = nullptr;
+  custom_configured_ = true;
+  state_ = "configured";
+  return env.Undefined();
+}
 
-  // Release ownership before parse_ptr (it may modify/consume the pointers)
-  AVFilterInOut* outputs = outputs_raii.release();
-  AVFilterInOut* inputs = inputs_raii.release();
+bool VideoFilter::BuildCustomGraph(std::string* error) {
+  custom_graph_ = ffmpeg::make_filter_graph();
+  custom_sources_.clear();
+  custom_sinks_.clear();
+  if (!custom_graph_) {
+    *error = "Failed to allocate filter graph";
+    return false;
+  }
 
-  ret = avfilter_graph_parse_ptr(filter_graph_.get(), filter_str.c_str(),
-                                 &inputs, &outputs, nullptr);
-  // parse_ptr may have modified pointers, free remaining
-  avfilter_inout_free(&inputs);
-  avfilter_inout_free(&outputs);
+  const AVFilter* buffersrc = avfilter_get_by_name("buffer");
+  const AVFilter* buffersink = avfilter_get_by_name("buffersink");
+  const AVFilter* format_filter = avfilter_get_by_name("format");
+
+  // Graph outputs are the description's open inputs and vice versa; both
+  // lists are freed by avfilter_inout_free below whatever happens.
+  AVFilterInOut* outputs = nullptr;
+  AVFilterInOut* inputs = nullptr;
+  AVFilterInOut** outputs_tail = &outputs;
+  AVFilterInOut** inputs_tail = &inputs;
+  auto fail = [&](const std::string& message) {
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    custom_graph_.reset();
+    custom_sources_.clear();
+    custom_sinks_.clear();
+    *error = message;
+    return false;
+  };
+
+  for (size_t i = 0; i < custom_inputs_.size(); ++i) {
+    const GraphInput& input = custom_inputs_[i];
+    // Timestamps are WebCodecs microseconds.
+    char args[256];
+    int len = snprintf(
+        args, sizeof(args),
+        "video_size=%dx%d:pix_fmt=%d:time_base=1/1000000:pixel_aspect=1/1",
+        input.width, input.height, input.format);
+    if (input.frame_rate.num > 0) {
+      snprintf(args + len, sizeof(args) - len, ":frame_rate=%d/%d",
+               input.frame_rate.num, input.frame_rate.den);
+    }
+
+    std::string label = PadLabel("in", i, custom_inputs_.size());
+    AVFilterContext* source = nullptr;
+    if (avfilter_graph_create_filter(&source, buffersrc, label.c_str(), args,
+                                     nullptr, custom_graph_.get()) < 0) {
+      return fail("Failed to create buffer source");
+    }
+    custom_sources_.push_back(source);
+
+    AVFilterInOut* inout = avfilter_inout_alloc();
+    if (!inout) {
+      return fail("Failed to allocate filter inout");
+    }
+    inout->name = av_strdup(label.c_str());
+    inout->filter_ctx = source;
+    inout->pad_idx = 0;
+    inout->next = nullptr;
+    *outputs_tail = inout;
+    outputs_tail = &inout->next;
+  }
+
+  for (size_t i = 0; i < custom_output_count_; ++i) {
+    std::string label = PadLabel("out", i, custom_output_count_);
+    AVFilterContext* sink = nullptr;
+    AVFilterContext* format = nullptr;
+    if (avfilter_graph_create_filter(&sink, buffersink, label.c_str(), nullptr,
+                                     nullptr, custom_graph_.get()) < 0 ||
+        avfilter_graph_create_filter(&format, format_filter,
+                                     (label + "_format").c_str(),
+                                     OutputFormatsArg().c_str(), nullptr,
+                                     custom_graph_.get()) < 0 ||
+        avfilter_link(format, 0, sink, 0) < 0) {
+      return fail("Failed to create buffer sink");
+    }
+    custom_sinks_.push_back(sink);
 
+    AVFilterInOut* inout = avfilter_inout_alloc();
+    if (!inout) {
+      return fail("Failed to allocate filter inout");
+    }
+    inout->name = av_strdup(label.c_str());
+    inout->filter_ctx = format;
+    inout->pad_idx = 0;
+    inout->next = nullptr;
+    *inputs_tail = inout;
+    inputs_tail = &inout->next;
+  }
+
+  int ret = avfilter_graph_parse_ptr(custom_graph_.get(),
+                                     custom_description_.c_str(), &inputs,
+                                     &outputs, nullptr);
   if (ret < 0) {
-    Napi::Error::New(env, "Failed to parse filter graph: " + filter_str)
-        .ThrowAsJavaScriptException();
-    return env.Undefined();
+    return fail("Failed to parse filter graph: " +
+                webcodecs::FFmpegErrorString(ret));
+  }
+  if (inputs || outputs) {
+    return fail("Filter graph leaves pad [" +
+                std::string(inputs ? inputs->name : outputs->name) +
+                "] unconnected");
   }
 
-  ret = avfilter_graph_config(filter_graph_.get(), nullptr);
+  ret = avfilter_graph_config(custom_graph_.get(), nullptr);
   if (ret < 0) {
-    Napi::Error::New(env, "Failed to configure filter graph")
-        .ThrowAsJavaScriptException();
-    return env.Undefined();
+    return fail("Failed to configure filter graph: " +
+                webcodecs::FFmpegErrorString(ret));
+  }
+  return true;
+}
+
+bool VideoFilter::RunCustomGraph(
+    std::vector<ffmpeg::AVFramePtr>* inputs, bool flush,
+    std::vector<std::vector<ffmpeg::AVFramePtr>>* outputs,
+    std::string* error) {
+  for (size_t i = 0; i < custom_sources_.size(); ++i) {
+    AVFrame* frame = i < inputs->size() ? (*inputs)[i].get() : nullptr;
+    if (!frame && !flush) {
+      continue;
+    }
+    // Passing ownership of the reference; a null frame marks end of stream.
+    int ret = av_buffersrc_add_frame(custom_sources_[i], frame);
+    if (ret < 0) {
+      *error = "Failed to feed filter graph: " +
+               webcodecs::FFmpegErrorString(ret);
+      return false;
+    }
   }
 
-  // Convert RGBA to YUV420P
-  const uint8_t* src_slices[1] = {rgba_data};
-  int src_stride[1] = {width_ * 4};
+  outputs->assign(custom_sinks_.size(), {});
+  for (size_t i = 0; i < custom_sinks_.size(); ++i) {
+    AVRational time_base = av_buffersink_get_time_base(custom_sinks_[i]);
+    while (true) {
+      ffmpeg::AVFramePtr frame = ffmpeg::make_frame();
+      if (!frame) {
+        *error = "Failed to allocate frame";
+        return false;
+      }
+      int ret = av_buffersink_get_frame(custom_sinks_[i], frame.get());
+      if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        break;
+      }
+      if (ret < 0) {
+        *error = "Filter processing failed: " +
+                 webcodecs::FFmpegErrorString(ret);
+        return false;
+      }
+      frame->pts = frame->pts == AV_NOPTS_VALUE
+                       ? 0
+                       : av_rescale_q(frame->pts, time_base, {1, 1000000});
+      (*outputs)[i].push_back(std::move(frame));
+    }
+  }
+  return true;
+}
 
-  sws_scale(sws_rgba_to_yuv_.get(), src_slices, src_stride, 0, height_,
-            yuv_frame_->data, yuv_frame_->linesize);
+class VideoFilter::GraphWorker : public Napi::AsyncWorker {
+ public:
+  GraphWorker(Napi::Env env, VideoFilter* filter,
+              std::vector<ffmpeg::AVFramePtr> inputs, bool flush)
+      : Napi::AsyncWorker(env, flush ? "VideoFilter.flush"
+                                     : "VideoFilter.process"),
+        filter_(filter),
+        filter_ref_(Napi::Persistent(filter->Value())),
+        inputs_(std::move(inputs)),
+        flush_(flush),
+        ticket_(filter->next_ticket_++),
+        deferred_(Napi::Promise::Deferred::New(env)) {}
+
+  Napi::Promise Promise() const { return deferred_.Promise(); }
+
+  void Execute() override {
+    std::unique_lock<std::mutex> lock(filter_->graph_mutex_);
+    // The thread pool may start workers out of order; frames must not be.
+    filter_->graph_turn_.wait(
+        lock, [this] { return filter_->serving_ticket_ == ticket_; });
+    std::string error;
+    if (!Run(&error)) {
+      SetError(error);
+    }
+    ++filter_->serving_ticket_;
+    filter_->graph_turn_.notify_all();
+  }
 
-  yuv_frame_->pts = 0;
+  void OnOK() override {
+    Napi::Env env = Env();
+    Napi::Array result = Napi::Array::New(env, outputs_.size());
+    try {
+      for (size_t i = 0; i < outputs_.size(); ++i) {
+        Napi::Array frames = Napi::Array::New(env, outputs_[i].size());
+        for (size_t j = 0; j < outputs_[i].size(); ++j) {
+          ffmpeg::AVFramePtr& frame = outputs_[i][j];
+          int64_t timestamp = frame->pts;
+          int width = frame->width;
+          int height = frame->height;
+          frames.Set(static_cast<uint32_t>(j),
+                     VideoFrame::CreateInstance(env, std::move(frame),
+                                                timestamp, 0, false, width,
+                                                height));
+        }
+        result.Set(static_cast<uint32_t>(i), frames);
+      }
+    } catch (const Napi::Error& e) {
+      deferred_.Reject(e.Value());
+      return;
+    }
+    deferred_.Resolve(result);
+  }
 
-  // Process through filter
-  av_frame_unref(output_frame_.get());
-  AVFrame* filtered = ProcessFrame(yuv_frame_.get());
-  if (!filtered) {
-    Napi::Error::New(env, "Filter processing failed")
+  void OnError(const Napi::Error& e) override { deferred_.Reject(e.Value()); }
+
+ private:
+  bool Run(std::string* error) {
+    if (filter_->closed_ || !filter_->custom_graph_) {
+      *error = "AbortError: VideoFilter was closed";
+      return false;
+    }
+    if (!filter_->RunCustomGraph(&inputs_, flush_, &outputs_, error)) {
+      return false;
+    }
+    // A flushed graph has seen end of stream; start afresh for the next
+    // process() call.
+    return !flush_ || filter_->BuildCustomGraph(error);
+  }
+
+  VideoFilter* filter_;
+  Napi::ObjectReference filter_ref_;  // Keeps filter_ alive
+  std::vector<ffmpeg::AVFramePtr> inputs_;
+  bool flush_;
+  uint64_t ticket_;
+  std::vector<std::vector<ffmpeg::AVFramePtr>> outputs_;
+  Napi::Promise::Deferred deferred_;
+};
+
+Napi::Value VideoFilter::Process(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (state_ == "closed") {
+    Napi::Error::New(env, "VideoFilter is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!custom_configured_) {
+    Napi::Error::New(env, "VideoFilter graph not configured")
         .ThrowAsJavaScriptException();
     return env.Undefined();
   }
 
-  // Convert YUV420P back to RGBA
-  size_t output_size = width_ * height_ * 4;
-  Napi::Buffer<uint8_t> output_buffer =
-      Napi::Buffer<uint8_t>::New(env, output_size);
-  uint8_t* output_data = output_buffer.Data();
+  if (info.Length() < 1 || !info[0].IsArray() ||
+      info[0].As<Napi::Array>().Length() != custom_inputs_.size()) {
+    Napi::TypeError::New(env,
+                         "frames must be an array with one entry per input")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
 
-  uint8_t* dst_slices[1] = {output_data};
-  int dst_stride[1] = {width_ * 4};
+  // Take references on the main thread; the worker never touches JS objects.
+  Napi::Array frames_arr = info[0].As<Napi::Array>();
+  std::vector<ffmpeg::AVFramePtr> inputs(custom_inputs_.size());
+  for (uint32_t i = 0; i < frames_arr.Length(); ++i) {
+    Napi::Value value = frames_arr.Get(i);
+    if (value.IsNull() || value.IsUndefined()) {
+      continue;
+    }
+    if (!value.IsObject()) {
+      Napi::TypeError::New(env, "frames must be VideoFrame objects or null")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    VideoFrame* video_frame =
+        Napi::ObjectWrap<VideoFrame>::Unwrap(value.As<Napi::Object>());
+    const GraphInput& input = custom_inputs_[i];
+    if (video_frame->GetWidth() != input.width ||
+        video_frame->GetHeight() != input.height ||
+        PixelFormatToAV(video_frame->GetFormat()) != input.format) {
+      Napi::TypeError::New(env, "frame " + std::to_string(i) +
+                                    " does not match its input's size and "
+                                    "format")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
 
-  sws_scale(sws_yuv_to_rgba_.get(), filtered->data, filtered->linesize, 0,
-            height_, dst_slices, dst_stride);
+    inputs[i] = ffmpeg::make_frame();
+    if (!inputs[i] || !video_frame->RefAVFrame(inputs[i].get())) {
+      Napi::Error::New(env, "Failed to reference VideoFrame data")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    inputs[i]->pts = video_frame->GetTimestampValue();
+  }
+
+  // The worker deletes itself after settling the promise.
+  auto* worker = new GraphWorker(env, this, std::move(inputs), false);
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::Value VideoFilter::Flush(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (state_ == "closed") {
+    Napi::Error::New(env, "VideoFilter is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!custom_configured_) {
+    Napi::Error::New(env, "VideoFilter graph not configured")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
 
-  // Create new VideoFrame with blurred data using VideoFrame::CreateInstance
-  return VideoFrame::CreateInstance(env, output_data, output_size, width_,
-                                    height_, timestamp, "RGBA");
+  auto* worker = new GraphWorker(env, this, {}, true);
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
 }
 
 Napi::Object InitVideoFilter(Napi::Env env, Napi::Object exports) {
@@ -2,6 +2,15 @@
 // SPDX-License-Identifier: MIT
 //
 // VideoFilter implementation wrapping FFmpeg libavfilter for blur effects.
+//
+// The blur graph is built once per topology (frame size, pixel format, blur
+// radius and region count) and kept alive; when only the region geometry
+// changes between frames it is updated in place with filter commands. Frames
+// go through the graph in their own pixel format and come back in it.
+//
+// configureGraph() instead takes an arbitrary libavfilter description with
+// any number of inputs and outputs. Its frames are filtered on the libuv
+// thread pool and handed in and out by reference, never copied.
 
 #ifndef SRC_VIDEO_FILTER_H_
 #define SRC_VIDEO_FILTER_H_
@@ -13,12 +22,15 @@ extern "C" {
 #include <libavfilter/buffersrc.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
-#include <libswscale/swscale.h>
 }
 
 #include <napi.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "src/ffmpeg_raii.h"
@@ -37,24 +49,84 @@ class VideoFilter : public Napi::ObjectWrap<VideoFilter> {
   // WebCodecs-style API methods.
   Napi::Value Configure(const Napi::CallbackInfo& info);
   Napi::Value ApplyBlur(const Napi::CallbackInfo& info);
+  Napi::Value ConfigureGraph(const Napi::CallbackInfo& info);
+  Napi::Value Process(const Napi::CallbackInfo& info);
+  Napi::Value Flush(const Napi::CallbackInfo& info);
   void Close(const Napi::CallbackInfo& info);
   Napi::Value GetState(const Napi::CallbackInfo& info);
 
+  // Blur region as (x, y, width, height), clamped to the frame.
+  using Region = std::tuple<int, int, int, int>;
+
+  // What the graph's shape depends on; anything else is a filter command.
+  struct GraphKey {
+    int width = 0;
+    int height = 0;
+    int format = AV_PIX_FMT_NONE;
+    int radius = 0;
+    size_t regions = 0;
+
+    bool operator==(const GraphKey& other) const {
+      return width == other.width && height == other.height &&
+             format == other.format && radius == other.radius &&
+             regions == other.regions;
+    }
+  };
+
+  // Buffer source parameters of one configureGraph() input.
+  struct GraphInput {
+    int width = 0;
+    int height = 0;
+    AVPixelFormat format = AV_PIX_FMT_NONE;
+    AVRational frame_rate = {0, 1};
+  };
+
+  // Runs one process() or flush() call against custom_graph_.
+  class GraphWorker;
+
   // Internal helpers.
   void Cleanup();
-  AVFrame* ProcessFrame(AVFrame* input);
-  std::string BuildFilterString(
-      const std::vector<std::tuple<int, int, int, int>>& regions,
-      int blur_strength);
+  static std::vector<Region> ClampRegions(const std::vector<Region>& regions,
+                                          int width, int height);
+  static std::string BuildFilterString(const std::vector<Region>& regions,
+                                       int radius);
+  // Build and configure a graph for |key|; false with |error| set on failure.
+  bool BuildGraph(const GraphKey& key, const std::vector<Region>& regions,
+                  std::string* error);
+  // Move the existing graph's crop/overlay filters to |regions|.
+  bool UpdateRegions(const std::vector<Region>& regions);
+  ffmpeg::AVFramePtr ProcessFrame(AVFrame* input);
+  // Build custom_graph_ from custom_description_; caller holds graph_mutex_.
+  bool BuildCustomGraph(std::string* error);
+  // Feed |inputs| (null entries are skipped), or end of stream on every
+  // input when |flush| is set, then drain every output. Caller holds
+  // graph_mutex_.
+  bool RunCustomGraph(std::vector<ffmpeg::AVFramePtr>* inputs, bool flush,
+                      std::vector<std::vector<ffmpeg::AVFramePtr>>* outputs,
+                      std::string* error);
 
   // FFmpeg filter state.
   ffmpeg::AVFilterGraphPtr filter_graph_;
   AVFilterContext* buffersrc_ctx_;   // Not owned - owned by filter_graph_
   AVFilterContext* buffersink_ctx_;  // Not owned - owned by filter_graph_
-  ffmpeg::SwsContextPtr sws_rgba_to_yuv_;
-  ffmpeg::SwsContextPtr sws_yuv_to_rgba_;
-  ffmpeg::AVFramePtr yuv_frame_;
-  ffmpeg::AVFramePtr output_frame_;
+  GraphKey graph_key_;               // Shape of filter_graph_
+  std::vector<Region> graph_regions_;  // Geometry filter_graph_ applies
+  int64_t next_pts_;  // Graph-internal timestamps, always increasing
+
+  // configureGraph() state.
+  ffmpeg::AVFilterGraphPtr custom_graph_;
+  std::vector<AVFilterContext*> custom_sources_;  // Owned by custom_graph_
+  std::vector<AVFilterContext*> custom_sinks_;    // Owned by custom_graph_
+  std::string custom_description_;
+  std::vector<GraphInput> custom_inputs_;
+  size_t custom_output_count_;
+  bool custom_configured_;      // Main thread only
+  std::mutex graph_mutex_;      // Serialises workers on custom_graph_
+  // Workers take a ticket when queued and run in ticket order.
+  std::condition_variable graph_turn_;
+  uint64_t next_ticket_;        // Main thread only
+  uint64_t serving_ticket_;     // Guarded by graph_mutex_
+  std::atomic<bool> closed_;
 
   // Configuration.
   int width_;
@@ -9,11 +9,20 @@
 #include <utility>
 #include <vector>
 
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+}
+
 #include "src/common.h"
 #include "src/ffmpeg_raii.h"
+#include "src/frame_pool.h"
+#include "src/pixel_kernels.h"
+#include "src/sws_pool.h"
+#include "src/transfer_registry.h"
 
-// Static constructor reference for clone().
-Napi::FunctionReference VideoFrame::constructor;
+// Per-thread constructor reference for clone() and CreateInstance().
+thread_local Napi::FunctionReference VideoFrame::constructor;
 
 // Sentinel for unknown formats (trivially destructible - safe as file-scope
 // static)
@@ -158,6 +167,23 @@ GetFormatNameLookup() {
   return *lookup;
 }
 
+// Reverse lookup accessor: FFmpeg pixel format to PixelFormat enum.
+// NV12A shares AV_PIX_FMT_NV12 with NV12 and is excluded so that decoded NV12
+// frames map to NV12. Uses function-local static with heap allocation.
+static const std::unordered_map<int, PixelFormat>& GetAVFormatLookup() {
+  static const auto* lookup =
+      new std::unordered_map<int, PixelFormat>([]() {
+        std::unordered_map<int, PixelFormat> result;
+        for (const auto& [format, info] : GetFormatRegistry()) {
+          if (format != PixelFormat::UNKNOWN && format != PixelFormat::NV12A) {
+            result[info.av_format] = format;
+          }
+        }
+        return result;
+      }());
+  return *lookup;
+}
+
 const PixelFormatInfo& GetFormatInfo(PixelFormat format) {
   const auto& registry = GetFormatRegistry();
   auto it = registry.find(format);
@@ -184,6 +210,15 @@ AVPixelFormat PixelFormatToAV(PixelFormat format) {
   return GetFormatInfo(format).av_format;
 }
 
+PixelFormat PixelFormatFromAV(AVPixelFormat av_format) {
+  const auto& lookup = GetAVFormatLookup();
+  auto it = lookup.find(av_format);
+  if (it != lookup.end()) {
+    return it->second;
+  }
+  return PixelFormat::UNKNOWN;
+}
+
 size_t CalculateAllocationSize(PixelFormat format, uint32_t width,
                                uint32_t height) {
   const auto& info = GetFormatInfo(format);
@@ -226,6 +261,92 @@ size_t CalculateAllocationSize(PixelFormat format, uint32_t width,
   return total;
 }
 
+PixelFormat FramePixelFormat(const AVFrame* frame) {
+  if (frame->hw_frames_ctx) {
+    const auto* frames_ctx =
+        reinterpret_cast<const AVHWFramesContext*>(frame->hw_frames_ctx->data);
+    return PixelFormatFromAV(frames_ctx->sw_format);
+  }
+  return PixelFormatFromAV(static_cast<AVPixelFormat>(frame->format));
+}
+
+int GetPackedPlaneLayout(PixelFormat format, int width, int height,
+                         int row_bytes[4], int rows[4]) {
+  const auto& info = GetFormatInfo(format);
+
+  // Packed RGB formats: single plane, 4 bytes per pixel.
+  if (info.num_planes == 1) {
+    row_bytes[0] = width * 4;
+    rows[0] = height;
+    return 1;
+  }
+
+  const int bytes_per_sample = (info.bit_depth + 7) / 8;
+  const int chroma_width = width >> info.chroma_h_shift;
+  const int chroma_height = height >> info.chroma_v_shift;
+
+  row_bytes[0] = width * bytes_per_sample;
+  rows[0] = height;
+
+  if (info.is_semi_planar) {
+    // Interleaved UV plane.
+    row_bytes[1] = chroma_width * 2 * bytes_per_sample;
+    rows[1] = chroma_height;
+    return 2;
+  }
+
+  // U and V planes.
+  row_bytes[1] = row_bytes[2] = chroma_width * bytes_per_sample;
+  rows[1] = rows[2] = chroma_height;
+  if (info.has_alpha && info.num_planes > 3) {
+    // Alpha plane (same dimensions as Y).
+    row_bytes[3] = row_bytes[0];
+    rows[3] = height;
+    return 4;
+  }
+  return 3;
+}
+
+size_t CopyFrameToPackedBuffer(const AVFrame* frame, PixelFormat format,
+                               uint8_t* dst, size_t dst_size) {
+  size_t total = CalculateAllocationSize(format, frame->width, frame->height);
+  if (total == 0 || total > dst_size) {
+    return 0;
+  }
+
+  int row_bytes[4] = {0};
+  int rows[4] = {0};
+  int planes = GetPackedPlaneLayout(format, frame->width, frame->height,
+                                    row_bytes, rows);
+  uint8_t* out = dst;
+  for (int plane = 0; plane < planes; ++plane) {
+    av_image_copy_plane(out, row_bytes[plane], frame->data[plane],
+                        frame->linesize[plane], row_bytes[plane], rows[plane]);
+    out += static_cast<size_t>(row_bytes[plane]) * rows[plane];
+  }
+  return total;
+}
+
+bool CopyPackedBufferToFrame(const uint8_t* src, size_t src_size,
+                             PixelFormat format, AVFrame* frame) {
+  size_t total = CalculateAllocationSize(format, frame->width, frame->height);
+  if (total == 0 || total > src_size) {
+    return false;
+  }
+
+  int row_bytes[4] = {0};
+  int rows[4] = {0};
+  int planes = GetPackedPlaneLayout(format, frame->width, frame->height,
+                                    row_bytes, rows);
+  const uint8_t* in = src;
+  for (int plane = 0; plane < planes; ++plane) {
+    av_image_copy_plane(frame->data[plane], frame->linesize[plane], in,
+                        row_bytes[plane], row_bytes[plane], rows[plane]);
+    in += static_cast<size_t>(row_bytes[plane]) * rows[plane];
+  }
+  return true;
+}
+
 Napi::Object InitVideoFrame(Napi::Env env, Napi::Object exports) {
   return VideoFrame::Init(env, exports);
 }
@@ -252,6 +373,7 @@ Napi::Object VideoFrame::Init(Napi::Env env, Napi::Object exports) {
           InstanceMethod("clone", &VideoFrame::Clone),
           InstanceMethod("allocationSize", &VideoFrame::AllocationSize),
           InstanceMethod("copyTo", &VideoFrame::CopyTo),
+          InstanceMethod("detach", &VideoFrame::Detach),
       });
 
   constructor = Napi::Persistent(func);
@@ -267,21 +389,46 @@ VideoFrame::VideoFrame(const Napi::CallbackInfo& info)
       has_duration_(false),
       closed_(false) {
   webcodecs::counterVideoFrames++;
+  // Pixel conversions may log; route FFmpeg output through our callback.
+  webcodecs::InitFFmpeg();
+  webcodecs::InitFFmpegLogging();
   Napi::Env env = info.Env();
 
   if (info.Length() < 2) {
     throw Napi::Error::New(env, "VideoFrame requires buffer and options");
   }
 
-  // Get buffer data.
-  Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
-  data_.assign(buffer.Data(), buffer.Data() + buffer.Length());
+  if (info[0].IsExternal()) {
+    // Zero-copy construction via CreateInstance(AVFramePtr): adopt the
+    // refcounted frame. Its planes stay in FFmpeg's buffer pool and return to
+    // it as soon as close() drops the reference.
+    auto* owned = info[0].As<Napi::External<ffmpeg::AVFramePtr>>().Data();
+    if (!owned || !*owned) {
+      throw Napi::Error::New(env, "VideoFrame requires a valid AVFrame");
+    }
+    frame_ = std::move(*owned);
+  } else if (info[0].IsNumber()) {
+    // Transfer from another environment via detach(): adopt the parked
+    // frame or packed buffer without copying it.
+    webcodecs::TransferPayload payload;
+    uint64_t handle =
+        static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value());
+    if (!webcodecs::TransferRegistry::Instance().Take(handle, &payload)) {
+      throw Napi::Error::New(
+          env, "DataCloneError: VideoFrame transfer handle is not valid");
+    }
+    frame_ = std::move(payload.frame);
+    data_ = std::move(payload.data);
+  } else {
+    // Get buffer data.
+    Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+    data_.assign(buffer.Data(), buffer.Data() + buffer.Length());
+  }
 
   // Inform V8 of external memory allocation for GC pressure calculation.
   // Without this, V8 sees this wrapper as ~64 bytes while the actual buffer
   // can be 8MB+ for 1080p RGBA frames.
-  Napi::MemoryManagement::AdjustExternalMemory(env,
-                                                static_cast<int64_t>(data_.size()));
+  external_memory_.Set(env, PixelBytes());
 
   // Get options.
   Napi::Object opts = info[1].As<Napi::Object>();
@@ -311,61 +458,34 @@ VideoFrame::VideoFrame(const Napi::CallbackInfo& info)
     throw Napi::TypeError::New(env, "alpha must be 'keep' or 'discard'");
   }
 
-  // Handle alpha="discard" by converting to non-alpha format
+  // Handle alpha="discard" by switching to the non-alpha equivalent. The
+  // packed layouts are identical apart from the alpha byte, which becomes
+  // opaque padding; planar ones just drop their trailing alpha plane.
   AVPixelFormat av_fmt = PixelFormatToAV(format_);
-  if (alpha_option == "discard" && FormatHasAlpha(av_fmt)) {
-    AVPixelFormat dst_fmt = GetNonAlphaEquivalent(av_fmt);
-
-    ffmpeg::SwsContextPtr sws(sws_getContext(coded_width_, coded_height_,
-                                             av_fmt, coded_width_,
-                                             coded_height_, dst_fmt,
-                                             SWS_BILINEAR, nullptr, nullptr,
-                                             nullptr));
-
-    if (!sws) {
-      throw Napi::Error::New(env, "Failed to create alpha conversion context");
+  AVPixelFormat dst_fmt = GetNonAlphaEquivalent(av_fmt);
+  if (alpha_option == "discard" && FormatHasAlpha(av_fmt) &&
+      dst_fmt != av_fmt) {
+    if (!PackFrameData()) {
+      throw Napi::Error::New(env, "Failed to download hardware frame");
     }
 
-    // Set up source planes from input data
-    const uint8_t* src_data[4] = {nullptr};
-    int src_linesize[4] = {0};
-    const auto& src_info = GetFormatInfo(format_);
-
-    if (src_info.num_planes == 1) {
-      // Packed RGBA/BGRA
-      src_data[0] = data_.data();
-      src_linesize[0] = coded_width_ * 4;
-    }
-
-    // Allocate destination buffer
+    PixelFormat dst_format = AVToPixelFormat(dst_fmt);
     size_t dst_size =
-        CalculateAllocationSize(AVToPixelFormat(dst_fmt), coded_width_,
-                                coded_height_);
-    std::vector<uint8_t> dst_buffer(dst_size);
-
-    uint8_t* dst_data[4] = {nullptr};
-    int dst_linesize[4] = {0};
-    const auto& dst_info = GetFormatInfo(AVToPixelFormat(dst_fmt));
-
-    if (dst_info.num_planes == 1) {
-      // Packed RGBX/BGRX
-      dst_data[0] = dst_buffer.data();
-      dst_linesize[0] = coded_width_ * 4;
+        CalculateAllocationSize(dst_format, coded_width_, coded_height_);
+    if (data_.size() < dst_size) {
+      throw Napi::TypeError::New(env, "Buffer too small for VideoFrame");
+    }
+    if (GetFormatInfo(format_).num_planes == 1) {
+      webcodecs::SetOpaqueAlpha(data_.data(), coded_width_, coded_height_,
+                                coded_width_ * 4);
+    } else {
+      data_.resize(dst_size);
+      data_.shrink_to_fit();
     }
 
-    // Perform conversion
-    sws_scale(sws.get(), src_data, src_linesize, 0, coded_height_, dst_data,
-              dst_linesize);
-
-    // Replace data with converted buffer.
     // Adjust external memory tracking for the size difference.
-    size_t old_size = data_.size();
-    data_ = std::move(dst_buffer);
-    if (old_size != data_.size()) {
-      Napi::MemoryManagement::AdjustExternalMemory(
-          env, static_cast<int64_t>(data_.size()) - static_cast<int64_t>(old_size));
-    }
-    format_ = AVToPixelFormat(dst_fmt);
+    external_memory_.Set(env, PixelBytes());
+    format_ = dst_format;
   }
 
   rotation_ = webcodecs::AttrAsInt32(opts, "rotation", 0);
@@ -431,14 +551,64 @@ VideoFrame::~VideoFrame() {
   // race conditions with V8's ArrayBufferSweeper during Heap::TearDown().
   // See: https://github.com/nodejs/node-addon-api/issues/1153
   //
-  // The WebCodecs spec mandates that close() must be called for proper
-  // resource management. External memory tracking is handled exclusively
-  // in Close() to avoid shutdown crashes.
-  //
-  // If close() wasn't called, external memory accounting will be slightly off,
-  // but this is a user error (violating WebCodecs spec) and won't crash.
+  // If close() wasn't called, external_memory_'s destructor releases the
+  // accounted bytes now and the V8 side on the next adjustment.
   data_.clear();
   data_.shrink_to_fit();
+  frame_.reset();
+}
+
+bool VideoFrame::DownloadHardwareFrame() {
+  if (!frame_ || !frame_->hw_frames_ctx) {
+    return true;
+  }
+  ffmpeg::AVFramePtr sw_frame = ffmpeg::make_frame();
+  if (!sw_frame ||
+      av_hwframe_transfer_data(sw_frame.get(), frame_.get(), 0) < 0) {
+    return false;
+  }
+  av_frame_copy_props(sw_frame.get(), frame_.get());
+  frame_ = std::move(sw_frame);
+  external_memory_.Set(Env(), PixelBytes());
+  return true;
+}
+
+int64_t VideoFrame::PixelBytes() const {
+  if (!frame_) {
+    return static_cast<int64_t>(data_.size());
+  }
+  int64_t bytes = 0;
+  for (int i = 0; i < AV_NUM_DATA_POINTERS && frame_->buf[i]; ++i) {
+    bytes += static_cast<int64_t>(frame_->buf[i]->size);
+  }
+  return bytes;
+}
+
+bool VideoFrame::PackFrameData() {
+  if (!frame_) {
+    return true;
+  }
+  // Never hand out GPU surface pointers as packed data. A failed download
+  // keeps the surface, so a later access can retry.
+  if (!DownloadHardwareFrame()) {
+    return false;
+  }
+  data_.resize(CalculateAllocationSize(format_, coded_width_, coded_height_));
+  CopyFrameToPackedBuffer(frame_.get(), format_, data_.data(), data_.size());
+  frame_.reset();
+  external_memory_.Set(Env(), PixelBytes());
+  return true;
+}
+
+bool VideoFrame::RefAVFrame(AVFrame* dst) {
+  if (frame_) {
+    return DownloadHardwareFrame() && av_frame_ref(dst, frame_.get()) >= 0;
+  }
+  dst->width = coded_width_;
+  dst->height = coded_height_;
+  dst->format = PixelFormatToAV(format_);
+  return webcodecs::FramePool::Instance().GetBuffer(dst) >= 0 &&
+         CopyPackedBufferToFrame(data_.data(), data_.size(), format_, dst);
 }
 
 Napi::Value VideoFrame::GetCodedWidth(const Napi::CallbackInfo& info) {
@@ -568,14 +738,13 @@ Napi::Value VideoFrame::GetColorSpace(const Napi::CallbackInfo& info) {
 void VideoFrame::Close(const Napi::CallbackInfo& info) {
   if (!closed_) {
     // Release external memory tracking before clearing data.
-    if (!data_.empty()) {
-      Napi::MemoryManagement::AdjustExternalMemory(
-          info.Env(), -static_cast<int64_t>(data_.size()));
-    }
+    external_memory_.Release(info.Env());
     // clear() + shrink_to_fit() actually releases memory
     // (clear() alone keeps capacity allocated).
     data_.clear();
     data_.shrink_to_fit();
+    // Dropping the reference hands AVFrame planes back to their buffer pool.
+    frame_.reset();
     closed_ = true;
   }
 }
@@ -584,18 +753,19 @@ Napi::Value VideoFrame::GetDataBuffer(const Napi::CallbackInfo& info) {
   if (closed_) {
     throw Napi::Error::New(info.Env(), "VideoFrame is closed");
   }
+  if (!DownloadHardwareFrame()) {
+    throw Napi::Error::New(info.Env(), "Failed to download hardware frame");
+  }
+  if (frame_) {
+    size_t size = GetDataSize();
+    Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(info.Env(), size);
+    CopyFrameToPackedBuffer(frame_.get(), format_, buffer.Data(), size);
+    return buffer;
+  }
   return Napi::Buffer<uint8_t>::Copy(info.Env(), data_.data(), data_.size());
 }
 
-Napi::Value VideoFrame::Clone(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-
-  if (closed_) {
-    throw Napi::Error::New(
-        env, "InvalidStateError: Cannot clone a closed VideoFrame");
-  }
-
-  // Create init object with current properties.
+Napi::Object VideoFrame::CreateInit(Napi::Env env) const {
   Napi::Object init = Napi::Object::New(env);
   init.Set("codedWidth", coded_width_);
   init.Set("codedHeight", coded_height_);
@@ -632,6 +802,27 @@ Napi::Value VideoFrame::Clone(const Napi::CallbackInfo& info) {
     cs.Set("fullRange", Napi::Boolean::New(env, color_full_range_));
     init.Set("colorSpace", cs);
   }
+  return init;
+}
+
+Napi::Value VideoFrame::Clone(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    throw Napi::Error::New(
+        env, "InvalidStateError: Cannot clone a closed VideoFrame");
+  }
+
+  Napi::Object init = CreateInit(env);
+
+  // AVFrame-backed frames share their planes with the clone (av_frame_ref).
+  if (frame_) {
+    ffmpeg::AVFramePtr ref(av_frame_clone(frame_.get()));
+    if (!ref) {
+      throw Napi::Error::New(env, "Failed to reference VideoFrame data");
+    }
+    return CreateFromAVFrame(env, std::move(ref), init);
+  }
 
   // Copy data to new buffer.
   Napi::Buffer<uint8_t> data_buffer =
@@ -641,6 +832,32 @@ Napi::Value VideoFrame::Clone(const Napi::CallbackInfo& info) {
   return constructor.New({data_buffer, init});
 }
 
+Napi::Value VideoFrame::Detach(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    throw Napi::Error::New(
+        env, "InvalidStateError: Cannot transfer a closed VideoFrame");
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("init", CreateInit(env));
+
+  // Ownership of the pixels moves to the registry; this frame ends up closed
+  // exactly as if close() had been called.
+  webcodecs::TransferPayload payload;
+  payload.frame = std::move(frame_);
+  payload.data = std::move(data_);
+  uint64_t handle =
+      webcodecs::TransferRegistry::Instance().Put(std::move(payload));
+  external_memory_.Release(env);
+  data_.clear();
+  closed_ = true;
+
+  result.Set("handle", Napi::Number::New(env, static_cast<double>(handle)));
+  return result;
+}
+
 Napi::Value VideoFrame::AllocationSize(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -661,6 +878,14 @@ Napi::Value VideoFrame::AllocationSize(const Napi::CallbackInfo& info) {
     if (!format_str.empty()) {
       target_format = ParsePixelFormat(format_str);
     }
+
+    // Only sRGB output is supported; YUV is converted using the frame's own
+    // matrix and range.
+    std::string color_space = webcodecs::AttrAsStr(opts, "colorSpace", "srgb");
+    if (color_space != "srgb") {
+      throw Napi::Error::New(env, "NotSupportedError: colorSpace '" +
+                                      color_space + "' is not supported");
+    }
   }
 
   size_t size = CalculateAllocationSize(target_format, width, height);
@@ -775,6 +1000,74 @@ static void SetupDestPlanes(PixelFormat format, uint8_t* data, int width,
   }
 }
 
+namespace {
+
+// libswscale coefficient table for a VideoColorSpace matrix.
+int SwsColorspace(const std::string& matrix) {
+  if (matrix == "bt709") return SWS_CS_ITU709;
+  if (matrix == "bt2020-ncl") return SWS_CS_BT2020;
+  if (matrix == "smpte240m") return SWS_CS_SMPTE240M;
+  return SWS_CS_DEFAULT;  // bt470bg, smpte170m and unspecified
+}
+
+// Frames at least this large are converted with slice threads.
+constexpr int64_t kThreadedConversionPixels = 1920 * 1080;
+
+// copyTo() conversion. YUV sources are read with their own matrix and
+// range; YUV output is BT.601 limited range as before. Without an explicit
+// scalingThreads, large frames get one slice thread per core.
+webcodecs::SwsKey CopyConverterKey(int width, int height,
+                                   AVPixelFormat src_format,
+                                   AVPixelFormat dst_format, int colorspace,
+                                   bool full_range,
+                                   const webcodecs::ScalingConfig& scaling) {
+  webcodecs::SwsKey key =
+      webcodecs::SwsKey::Convert(width, height, src_format, dst_format);
+  key.colorspace = colorspace;
+  key.src_full_range = full_range;
+  key.flags = scaling.SwsFlags();
+  bool large =
+      static_cast<int64_t>(width) * height >= kThreadedConversionPixels;
+  key.threads = scaling.ThreadsOr(large ? 0 : 1);
+  return key;
+}
+
+void NoopFree(void*, uint8_t*) {}
+
+// Convert between planes this code does not own. sws_scale_frame() is used
+// so threaded contexts split the work into slices; the planes are wrapped in
+// non-owning buffers so it neither copies nor frees them.
+bool ConvertPlanes(SwsContext* ctx, const uint8_t* const src_data[4],
+                   const int src_linesize[4], int width, int height,
+                   AVPixelFormat src_format, uint8_t* const dst_data[4],
+                   const int dst_linesize[4], AVPixelFormat dst_format,
+                   uint8_t* dst_buffer, size_t dst_size) {
+  ffmpeg::AVFramePtr src = ffmpeg::make_frame();
+  ffmpeg::AVFramePtr dst = ffmpeg::make_frame();
+  if (!src || !dst) {
+    return false;
+  }
+  src->buf[0] = av_buffer_create(const_cast<uint8_t*>(src_data[0]), 1,
+                                 NoopFree, nullptr, AV_BUFFER_FLAG_READONLY);
+  dst->buf[0] = av_buffer_create(dst_buffer, dst_size, NoopFree, nullptr, 0);
+  if (!src->buf[0] || !dst->buf[0]) {
+    return false;
+  }
+  for (int i = 0; i < 4; i++) {
+    src->data[i] = const_cast<uint8_t*>(src_data[i]);
+    src->linesize[i] = src_linesize[i];
+    dst->data[i] = dst_data[i];
+    dst->linesize[i] = dst_linesize[i];
+  }
+  src->width = dst->width = width;
+  src->height = dst->height = height;
+  src->format = src_format;
+  dst->format = dst_format;
+  return sws_scale_frame(ctx, dst.get(), src.get()) >= 0;
+}
+
+}  // namespace
+
 Napi::Value VideoFrame::CopyTo(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -789,6 +1082,11 @@ Napi::Value VideoFrame::CopyTo(const Napi::CallbackInfo& info) {
   // Get destination buffer
   Napi::Buffer<uint8_t> dest = info[0].As<Napi::Buffer<uint8_t>>();
 
+  // Hardware frames are read back from the GPU on first pixel access.
+  if (!DownloadHardwareFrame()) {
+    throw Napi::Error::New(env, "Failed to download hardware frame");
+  }
+
   PixelFormat target_format = format_;
 
   // Default copy region is the visible rect
@@ -802,11 +1100,18 @@ Napi::Value VideoFrame::CopyTo(const Napi::CallbackInfo& info) {
   std::vector<int> custom_strides;
   std::vector<size_t> custom_offsets;
   bool has_custom_layout = false;
+  webcodecs::ScalingConfig scaling;
 
   // Check if options object is provided
   if (info.Length() > 1 && info[1].IsObject()) {
     Napi::Object opts = info[1].As<Napi::Object>();
 
+    // Parse resizeQuality/scalingThreads (node-webcodecs extension)
+    std::string scaling_error;
+    if (!webcodecs::ParseScalingConfig(opts, &scaling, &scaling_error)) {
+      throw Napi::TypeError::New(env, scaling_error);
+    }
+
     // Parse format option
     std::string format_str = webcodecs::AttrAsStr(opts, "format", "");
     if (!format_str.empty()) {
@@ -902,9 +1207,14 @@ Napi::Value VideoFrame::CopyTo(const Napi::CallbackInfo& info) {
   // If same format, full copy, and no custom layout, just copy the data
   // directly
   if (target_format == format_ && full_copy && !has_custom_layout) {
-    memcpy(dest.Data(), data_.data(), data_.size());
+    if (frame_) {
+      CopyFrameToPackedBuffer(frame_.get(), format_, dest.Data(),
+                              dest.Length());
+    } else {
+      memcpy(dest.Data(), data_.data(), data_.size());
+    }
   } else {
-    // Perform format conversion and/or cropping using sws_scale
+    // Crop and/or convert straight from the source planes into |dest|
     AVPixelFormat src_av_fmt = PixelFormatToAV(format_);
     AVPixelFormat dst_av_fmt = PixelFormatToAV(target_format);
 
@@ -912,21 +1222,18 @@ Napi::Value VideoFrame::CopyTo(const Napi::CallbackInfo& info) {
       throw Napi::Error::New(env, "Unsupported pixel format for conversion");
     }
 
-    // Create sws context with source=copy rect dimensions, dest=copy dimensions
-    // (RAII managed)
-    ffmpeg::SwsContextPtr sws_ctx(sws_getContext(
-        dest_width, dest_height, src_av_fmt, dest_width, dest_height,
-        dst_av_fmt, SWS_BILINEAR, nullptr, nullptr, nullptr));
-
-    if (!sws_ctx) {
-      throw Napi::Error::New(env, "Failed to create sws context");
-    }
-
     // Set up source planes with full coded dimensions
     const uint8_t* src_data[4];
     int src_linesize[4];
-    SetupSourcePlanes(format_, data_.data(), coded_width_, coded_height_,
-                      src_data, src_linesize);
+    if (frame_) {
+      for (int i = 0; i < 4; i++) {
+        src_data[i] = frame_->data[i];
+        src_linesize[i] = frame_->linesize[i];
+      }
+    } else {
+      SetupSourcePlanes(format_, data_.data(), coded_width_, coded_height_,
+                        src_data, src_linesize);
+    }
 
     // Offset source planes for rect cropping using format metadata
     const auto& src_fmt_info = GetFormatInfo(format_);
@@ -1000,11 +1307,28 @@ Napi::Value VideoFrame::CopyTo(const Napi::CallbackInfo& info) {
                       dst_data, dst_linesize);
     }
 
-    // Perform the conversion/crop
-    sws_scale(sws_ctx.get(), src_data_offset, src_linesize, 0, dest_height,
-              dst_data, dst_linesize);
-
-    // RAII handles sws_ctx cleanup
+    if (target_format == format_) {
+      // Crop only: copy the rect's rows straight into the destination.
+      av_image_copy(dst_data, dst_linesize, src_data_offset, src_linesize,
+                    src_av_fmt, dest_width, dest_height);
+    } else {
+      webcodecs::SwsKey key = CopyConverterKey(
+          dest_width, dest_height, src_av_fmt, dst_av_fmt,
+          SwsColorspace(color_matrix_), color_full_range_, scaling);
+      // Common YUV <-> RGB copies need no SwsContext at all.
+      if (!webcodecs::ConvertWithKernels(key, src_data_offset, src_linesize,
+                                         dst_data, dst_linesize)) {
+        webcodecs::SwsPool::Lease sws_ctx =
+            webcodecs::SwsPool::Instance().Acquire(key);
+        if (!sws_ctx ||
+            !ConvertPlanes(sws_ctx.get(), src_data_offset, src_linesize,
+                           dest_width, dest_height, src_av_fmt, dst_data,
+                           dst_linesize, dst_av_fmt, dest.Data(),
+                           dest.Length())) {
+          throw Napi::Error::New(env, "Failed to convert frame");
+        }
+      }
+    }
   }
 
   // Build plane layout array using copy dimensions and format metadata
@@ -1178,3 +1502,67 @@ Napi::Object VideoFrame::CreateInstance(
   // Create new VideoFrame instance.
   return constructor.New({data_buffer, init});
 }
+
+Napi::Object VideoFrame::CreateFromAVFrame(Napi::Env env,
+                                           ffmpeg::AVFramePtr frame,
+                                           Napi::Object init) {
+  PixelFormat format = FramePixelFormat(frame.get());
+  if (format == PixelFormat::UNKNOWN) {
+    throw Napi::Error::New(env, "Unsupported AVFrame pixel format");
+  }
+  init.Set("codedWidth", frame->width);
+  init.Set("codedHeight", frame->height);
+  init.Set("format", PixelFormatToString(format));
+
+  // The constructor moves the frame out of |frame| synchronously; if it throws
+  // first, |frame| still owns the reference and frees it on return.
+  Napi::External<ffmpeg::AVFramePtr> external =
+      Napi::External<ffmpeg::AVFramePtr>::New(env, &frame);
+  return constructor.New({external, init});
+}
+
+Napi::Object VideoFrame::CreateInstance(Napi::Env env,
+                                        ffmpeg::AVFramePtr frame,
+                                        int64_t timestamp, int rotation,
+                                        bool flip, int display_width,
+                                        int display_height) {
+  // Create init object with properties.
+  Napi::Object init = Napi::Object::New(env);
+  init.Set("displayWidth", display_width);
+  init.Set("displayHeight", display_height);
+  init.Set("timestamp", Napi::Number::New(env, timestamp));
+  init.Set("rotation", rotation);
+  init.Set("flip", flip);
+
+  return CreateFromAVFrame(env, std::move(frame), init);
+}
+
+Napi::Object VideoFrame::CreateInstance(
+    Napi::Env env, ffmpeg::AVFramePtr frame, int64_t timestamp, int rotation,
+    bool flip, int display_width, int display_height,
+    const std::string& color_primaries, const std::string& color_transfer,
+    const std::string& color_matrix, bool color_full_range) {
+  // Create init object with properties.
+  Napi::Object init = Napi::Object::New(env);
+  init.Set("displayWidth", display_width);
+  init.Set("displayHeight", display_height);
+  init.Set("timestamp", Napi::Number::New(env, timestamp));
+  init.Set("rotation", rotation);
+  init.Set("flip", flip);
+
+  // Set colorSpace if any values are provided.
+  Napi::Object cs = Napi::Object::New(env);
+  if (!color_primaries.empty()) {
+    cs.Set("primaries", Napi::String::New(env, color_primaries));
+  }
+  if (!color_transfer.empty()) {
+    cs.Set("transfer", Napi::String::New(env, color_transfer));
+  }
+  if (!color_matrix.empty()) {
+    cs.Set("matrix", Napi::String::New(env, color_matrix));
+  }
+  cs.Set("fullRange", Napi::Boolean::New(env, color_full_range));
+  init.Set("colorSpace", cs);
+
+  return CreateFromAVFrame(env, std::move(frame), init);
+}
@@ -18,6 +18,9 @@ extern "C" {
 #include <string>
 #include <vector>
 
+#include "src/common.h"
+#include "src/ffmpeg_raii.h"
+
 enum class PixelFormat {
   // 8-bit formats
   RGBA,
@@ -80,6 +83,34 @@ AVPixelFormat PixelFormatToAV(PixelFormat format);
 size_t CalculateAllocationSize(PixelFormat format, uint32_t width,
                                uint32_t height);
 
+// Map an FFmpeg pixel format to the matching WebCodecs format. Returns UNKNOWN
+// when the format has no WebCodecs equivalent (e.g. hardware surfaces).
+PixelFormat PixelFormatFromAV(AVPixelFormat av_format);
+
+// WebCodecs format of |frame|'s pixels. For hardware frames this is the
+// format of the underlying surface (hw_frames_ctx->sw_format), i.e. the
+// format the pixels will have once downloaded.
+PixelFormat FramePixelFormat(const AVFrame* frame);
+
+// Copy the planes of |frame| into |dst| using the tightly packed layout
+// described by CalculateAllocationSize(), honouring the frame's linesizes.
+// Returns the number of bytes written, or 0 if |dst_size| is too small or the
+// format is unknown.
+size_t CopyFrameToPackedBuffer(const AVFrame* frame, PixelFormat format,
+                               uint8_t* dst, size_t dst_size);
+
+// Row geometry of each plane in the tightly packed layout produced by
+// CalculateAllocationSize(). Returns the number of planes that map onto
+// AVFrame planes (NV12A's alpha has no AVFrame counterpart and is skipped).
+int GetPackedPlaneLayout(PixelFormat format, int width, int height,
+                         int row_bytes[4], int rows[4]);
+
+// Inverse of CopyFrameToPackedBuffer(): fill the planes of |frame|, which must
+// already be allocated for |format| (e.g. via av_frame_get_buffer), from a
+// tightly packed buffer. Returns false if |src_size| is too small.
+bool CopyPackedBufferToFrame(const uint8_t* src, size_t src_size,
+                             PixelFormat format, AVFrame* frame);
+
 class VideoFrame : public Napi::ObjectWrap<VideoFrame> {
  public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -104,6 +135,24 @@ class VideoFrame : public Napi::ObjectWrap<VideoFrame> {
       bool flip, int display_width, int display_height,
       const std::string& color_primaries, const std::string& color_transfer,
       const std::string& color_matrix, bool color_full_range);
+  // Zero-copy overloads: the VideoFrame adopts |frame|'s refcounted planes
+  // (AVBufferRef) instead of copying them. |frame->format| must map to a
+  // PixelFormat via PixelFormatFromAV().
+  static Napi::Object CreateInstance(Napi::Env env, ffmpeg::AVFramePtr frame,
+                                     int64_t timestamp, int rotation,
+                                     bool flip, int display_width,
+                                     int display_height);
+  static Napi::Object CreateInstance(
+      Napi::Env env, ffmpeg::AVFramePtr frame, int64_t timestamp,
+      int rotation, bool flip, int display_width, int display_height,
+      const std::string& color_primaries, const std::string& color_transfer,
+      const std::string& color_matrix, bool color_full_range);
+  // Adopt |frame| with the remaining properties taken from |init| (as for
+  // the VideoFrame constructor); codedWidth, codedHeight and format come
+  // from the frame.
+  static Napi::Object CreateFromAVFrame(Napi::Env env,
+                                        ffmpeg::AVFramePtr frame,
+                                        Napi::Object init);
   explicit VideoFrame(const Napi::CallbackInfo& info);
   ~VideoFrame();
 
@@ -112,16 +161,33 @@ class VideoFrame : public Napi::ObjectWrap<VideoFrame> {
   VideoFrame& operator=(const VideoFrame&) = delete;
 
   // Internal accessors for VideoEncoder.
-  uint8_t* GetData() { return data_.data(); }
-  size_t GetDataSize() const { return data_.size(); }
+  // Packed pixel data. AVFrame-backed frames are packed on first access and
+  // release their AVFrame afterwards. nullptr if a hardware frame cannot be
+  // downloaded.
+  uint8_t* GetData() { return PackFrameData() ? data_.data() : nullptr; }
+  size_t GetDataSize() const {
+    return frame_ ? CalculateAllocationSize(format_, coded_width_,
+                                            coded_height_)
+                  : data_.size();
+  }
+  // Refcounted frame backing this VideoFrame, or nullptr when the pixels live
+  // in a packed buffer. May be a hardware frame (hw_frames_ctx set) whose
+  // planes are GPU surfaces.
+  const AVFrame* GetAVFrame() const { return frame_.get(); }
+  // Point |dst| at this frame's pixels in system memory: a new reference to
+  // the backing AVFrame (downloading GPU surfaces first) or a copy of the
+  // packed buffer into pooled planes. Returns false on failure.
+  bool RefAVFrame(AVFrame* dst);
   int GetWidth() const { return coded_width_; }
   int GetHeight() const { return coded_height_; }
   int64_t GetTimestampValue() const { return timestamp_; }
   int64_t GetDurationValue() const { return duration_; }
+  bool HasDuration() const { return has_duration_; }
   PixelFormat GetFormat() const { return format_; }
 
-  // Static constructor reference for clone().
-  static Napi::FunctionReference constructor;
+  // Constructor reference for clone() and CreateInstance(). One per thread:
+  // each environment (main thread or worker_thread) defines its own class.
+  static thread_local Napi::FunctionReference constructor;
 
  private:
   // Property getters.
@@ -143,8 +209,32 @@ class VideoFrame : public Napi::ObjectWrap<VideoFrame> {
   Napi::Value Clone(const Napi::CallbackInfo& info);
   Napi::Value AllocationSize(const Napi::CallbackInfo& info);
   Napi::Value CopyTo(const Napi::CallbackInfo& info);
+  // Move the pixels into the TransferRegistry and close this frame. Returns
+  // {handle, init}; `new VideoFrame(handle, init)` in any environment of
+  // this process takes them back out.
+  Napi::Value Detach(const Napi::CallbackInfo& info);
+
+  // Internal helpers.
+  // Init dictionary describing this frame, as used by clone() and detach().
+  Napi::Object CreateInit(Napi::Env env) const;
+  // Move the pixels from frame_ into data_. Returns false, keeping frame_,
+  // when a hardware frame cannot be downloaded.
+  bool PackFrameData();
+  // Replace a hardware frame_ with a system-memory copy. Both update the
+  // external memory charge.
+  bool DownloadHardwareFrame();
+  // Bytes held by data_ or frame_'s buffers.
+  int64_t PixelBytes() const;
 
+  // Pixel storage: either a tightly packed buffer (data_) or a refcounted
+  // AVFrame (frame_) whose planes may have padded linesizes. Hardware frames
+  // stay on the GPU until pixels are read (copyTo/getData), at which point
+  // frame_ is replaced by a downloaded system-memory copy.
   std::vector<uint8_t> data_;
+  ffmpeg::AVFramePtr frame_;
+  // Pixel bytes reported to V8 and the MemoryAccountant, released in Close().
+  webcodecs::ExternalMemory external_memory_{
+      webcodecs::MemoryCategory::kVideoFrames};
   int coded_width_;
   int coded_height_;
   int display_width_;
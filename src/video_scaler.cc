@@ -0,0 +1,269 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+#include "src/video_scaler.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/common.h"
+#include "src/frame_pool.h"
+#include "src/video_frame.h"
+
+Napi::Object VideoScaler::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "VideoScaler",
+      {
+          InstanceMethod("scale", &VideoScaler::Scale),
+          InstanceMethod("close", &VideoScaler::Close),
+      });
+
+  exports.Set("VideoScaler", func);
+  return exports;
+}
+
+VideoScaler::VideoScaler(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<VideoScaler>(info), threads_(1), closed_(false) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Config object required")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Object config = info[0].As<Napi::Object>();
+  if (!config.Has("renditions") || !config.Get("renditions").IsArray() ||
+      config.Get("renditions").As<Napi::Array>().Length() == 0) {
+    Napi::TypeError::New(env, "renditions must be a non-empty array")
+        .ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Array renditions = config.Get("renditions").As<Napi::Array>();
+  for (uint32_t i = 0; i < renditions.Length(); ++i) {
+    if (!renditions.Get(i).IsObject()) {
+      Napi::TypeError::New(env, "each rendition must be an object")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    Napi::Object obj = renditions.Get(i).As<Napi::Object>();
+    Rendition rendition;
+    rendition.width = webcodecs::AttrAsInt32(obj, "width", 0);
+    rendition.height = webcodecs::AttrAsInt32(obj, "height", 0);
+    rendition.format = PixelFormatToAV(
+        ParsePixelFormat(webcodecs::AttrAsStr(obj, "format", "I420")));
+    if (rendition.width <= 0 || rendition.height <= 0) {
+      Napi::RangeError::New(env, "rendition width and height must be positive")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    if (rendition.format == AV_PIX_FMT_NONE) {
+      Napi::TypeError::New(env, "Unsupported rendition format")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    renditions_.push_back(std::move(rendition));
+  }
+
+  threads_ = std::max(0, webcodecs::AttrAsInt32(config, "threads", 1));
+  bool cascade = webcodecs::AttrAsBool(config, "cascade", true);
+
+  // Produce the largest rendition first so smaller ones can be scaled from
+  // it: each takes the smallest already-produced rendition that covers it.
+  order_.resize(renditions_.size());
+  for (size_t i = 0; i < order_.size(); ++i) {
+    order_[i] = static_cast<int>(i);
+  }
+  std::stable_sort(order_.begin(), order_.end(), [this](int a, int b) {
+    return static_cast<int64_t>(renditions_[a].width) * renditions_[a].height >
+           static_cast<int64_t>(renditions_[b].width) * renditions_[b].height;
+  });
+  if (cascade) {
+    for (size_t i = 1; i < order_.size(); ++i) {
+      Rendition& rendition = renditions_[order_[i]];
+      for (size_t j = i; j-- > 0;) {
+        const Rendition& larger = renditions_[order_[j]];
+        if (larger.width >= rendition.width &&
+            larger.height >= rendition.height) {
+          rendition.source = order_[j];
+          break;
+        }
+      }
+    }
+  }
+}
+
+bool VideoScaler::EnsureSwsContext(Rendition* rendition,
+                                   const AVFrame* source, std::string* error) {
+  webcodecs::SwsKey key = webcodecs::SwsKey::Scale(
+      source->width, source->height,
+      static_cast<AVPixelFormat>(source->format), rendition->width,
+      rendition->height, rendition->format);
+  // Slice threads within one rendition; 0 picks one per core.
+  key.threads = threads_;
+  if (!webcodecs::SwsPool::Instance().Ensure(&rendition->sws, key)) {
+    *error = "Could not create sws context";
+    return false;
+  }
+  return true;
+}
+
+bool VideoScaler::ScaleFrame(const AVFrame* input,
+                             std::vector<ffmpeg::AVFramePtr>* outputs,
+                             std::string* error) {
+  outputs->clear();
+  outputs->resize(renditions_.size());
+  for (int index : order_) {
+    Rendition& rendition = renditions_[index];
+    const AVFrame* source =
+        rendition.source < 0 ? input : (*outputs)[rendition.source].get();
+
+    // A rendition matching its source needs no work; share the planes.
+    if (source->width == rendition.width &&
+        source->height == rendition.height &&
+        source->format == rendition.format) {
+      (*outputs)[index].reset(av_frame_clone(source));
+      if (!(*outputs)[index]) {
+        *error = "Failed to reference frame";
+        return false;
+      }
+      continue;
+    }
+
+    if (!EnsureSwsContext(&rendition, source, error)) {
+      return false;
+    }
+
+    ffmpeg::AVFramePtr output = ffmpeg::make_frame();
+    if (!output) {
+      *error = "Failed to allocate frame";
+      return false;
+    }
+    output->width = rendition.width;
+    output->height = rendition.height;
+    output->format = rendition.format;
+    if (webcodecs::FramePool::Instance().GetBuffer(output.get()) < 0) {
+      *error = "Failed to allocate frame buffer";
+      return false;
+    }
+    int ret = sws_scale_frame(rendition.sws.get(), output.get(), source);
+    if (ret < 0) {
+      *error = "Failed to scale frame: " + webcodecs::FFmpegErrorString(ret);
+      return false;
+    }
+    (*outputs)[index] = std::move(output);
+  }
+  return true;
+}
+
+class VideoScaler::ScaleWorker : public Napi::AsyncWorker {
+ public:
+  ScaleWorker(Napi::Env env, VideoScaler* scaler, ffmpeg::AVFramePtr input,
+              int64_t timestamp)
+      : Napi::AsyncWorker(env, "VideoScaler.scale"),
+        scaler_(scaler),
+        scaler_ref_(Napi::Persistent(scaler->Value())),
+        input_(std::move(input)),
+        timestamp_(timestamp),
+        deferred_(Napi::Promise::Deferred::New(env)) {}
+
+  Napi::Promise Promise() const { return deferred_.Promise(); }
+
+  void Execute() override {
+    std::lock_guard<std::mutex> lock(scaler_->mutex_);
+    if (scaler_->closed_) {
+      SetError("AbortError: VideoScaler was closed");
+      return;
+    }
+    std::string error;
+    if (!scaler_->ScaleFrame(input_.get(), &outputs_, &error)) {
+      SetError(error);
+    }
+    input_.reset();
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+    Napi::Array result = Napi::Array::New(env, outputs_.size());
+    try {
+      for (size_t i = 0; i < outputs_.size(); ++i) {
+        int width = outputs_[i]->width;
+        int height = outputs_[i]->height;
+        result.Set(static_cast<uint32_t>(i),
+                   VideoFrame::CreateInstance(env, std::move(outputs_[i]),
+                                              timestamp_, 0, false, width,
+                                              height));
+      }
+    } catch (const Napi::Error& e) {
+      deferred_.Reject(e.Value());
+      return;
+    }
+    deferred_.Resolve(result);
+  }
+
+  void OnError(const Napi::Error& e) override { deferred_.Reject(e.Value()); }
+
+ private:
+  VideoScaler* scaler_;
+  Napi::ObjectReference scaler_ref_;  // Keeps scaler_ alive
+  ffmpeg::AVFramePtr input_;
+  int64_t timestamp_;
+  std::vector<ffmpeg::AVFramePtr> outputs_;
+  Napi::Promise::Deferred deferred_;
+};
+
+Napi::Value VideoScaler::Scale(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "VideoScaler is closed")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "frame must be a VideoFrame object")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  VideoFrame* video_frame =
+      Napi::ObjectWrap<VideoFrame>::Unwrap(info[0].As<Napi::Object>());
+  if (PixelFormatToAV(video_frame->GetFormat()) == AV_PIX_FMT_NONE) {
+    Napi::TypeError::New(env, "Unsupported VideoFrame format")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // Take the reference on the main thread; the worker never touches JS.
+  ffmpeg::AVFramePtr input = ffmpeg::make_frame();
+  if (!input || !video_frame->RefAVFrame(input.get())) {
+    Napi::Error::New(env, "Failed to reference VideoFrame data")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // The worker deletes itself after settling the promise.
+  auto* worker = new ScaleWorker(env, this, std::move(input),
+                                 video_frame->GetTimestampValue());
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
+}
+
+void VideoScaler::Close(const Napi::CallbackInfo& info) {
+  // Wait for a running worker; queued ones see closed_ and reject.
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+  for (Rendition& rendition : renditions_) {
+    rendition.sws.reset();
+  }
+}
+
+Napi::Object InitVideoScaler(Napi::Env env, Napi::Object exports) {
+  return VideoScaler::Init(env, exports);
+}
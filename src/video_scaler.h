@@ -0,0 +1,73 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// VideoScaler - scale one frame into several renditions (an ABR ladder).
+//
+// Each rendition is produced once, directly in the pixel format its encoder
+// takes, so VideoEncoderWorker sends it as-is instead of running its own
+// full-resolution conversion. With cascading enabled each rendition is
+// scaled from the next larger one rather than from the source. Scaling runs
+// on the libuv thread pool.
+
+#ifndef SRC_VIDEO_SCALER_H_
+#define SRC_VIDEO_SCALER_H_
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+#include <napi.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "src/ffmpeg_raii.h"
+#include "src/sws_pool.h"
+
+class VideoScaler : public Napi::ObjectWrap<VideoScaler> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  explicit VideoScaler(const Napi::CallbackInfo& info);
+  ~VideoScaler() = default;
+
+  // Disallow copy and assign.
+  VideoScaler(const VideoScaler&) = delete;
+  VideoScaler& operator=(const VideoScaler&) = delete;
+
+ private:
+  struct Rendition {
+    int width = 0;
+    int height = 0;
+    AVPixelFormat format = AV_PIX_FMT_NONE;
+    // Rendition scaled from, or -1 for the source frame. Fixed at
+    // construction.
+    int source = -1;
+    // Leased for the last source geometry seen.
+    webcodecs::SwsPool::Lease sws;
+  };
+
+  // Runs one scale() call.
+  class ScaleWorker;
+
+  Napi::Value Scale(const Napi::CallbackInfo& info);
+  void Close(const Napi::CallbackInfo& info);
+
+  // Fill |outputs| (one per rendition) from |input|; caller holds mutex_.
+  bool ScaleFrame(const AVFrame* input,
+                  std::vector<ffmpeg::AVFramePtr>* outputs,
+                  std::string* error);
+  bool EnsureSwsContext(Rendition* rendition, const AVFrame* source,
+                        std::string* error);
+
+  std::vector<Rendition> renditions_;
+  // Renditions in the order they are produced (largest first).
+  std::vector<int> order_;
+  int threads_;
+  std::mutex mutex_;  // Serialises workers on the sws contexts
+  std::atomic<bool> closed_;
+};
+
+#endif  // SRC_VIDEO_SCALER_H_
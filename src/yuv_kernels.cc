@@ -0,0 +1,699 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// YUV kernel implementations and runtime dispatch.
+//
+// Every version evaluates the same 32-bit fixed-point formulas:
+//   RGB: c = clamp((ky * (Y - y0) + ku * (U - c0) + kv * (V - c0) + r) >> s)
+//   Y:   clamp(((kr * R + kg * G + kb * B + r) >> 15) + 16)
+//   U/V: clamp(((kr * sR + kg * sG + kb * sB + r) >> 17) + 128)
+// where sR, sG and sB sum a 2x2 block. P010 samples are used at 10 bits
+// with the 8-bit coefficients and two more bits of shift.
+//
+// The x86 kernels use per-function target attributes, as in
+// pixel_kernels.cc.
+
+#include "src/yuv_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WEBCODECS_YUV_KERNELS_X86 1
+#define WEBCODECS_TARGET(x) __attribute__((target(x)))
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define WEBCODECS_YUV_KERNELS_NEON 1
+#endif
+
+namespace webcodecs {
+
+namespace {
+
+constexpr int kYuvToRgbShift = 14;
+constexpr int kRgbToYShift = 15;
+constexpr int kRgbToChromaShift = kRgbToYShift + 2;  // Sums of four pixels
+
+struct YuvToRgbConstants {
+  int32_t y;    // Luma scale
+  int32_t v_r;  // Cr contribution to R
+  int32_t u_g;  // Cb contribution to G (negative)
+  int32_t v_g;  // Cr contribution to G (negative)
+  int32_t u_b;  // Cb contribution to B
+  int32_t y_offset;
+  int32_t c_offset;
+  int32_t round;
+  int shift;
+};
+
+struct RgbToYuvConstants {
+  int32_t y_r, y_g, y_b;
+  int32_t u_r, u_g, u_b;
+  int32_t v_r, v_g, v_b;
+};
+
+// Source rows of one YUV row. |uv| is the U plane (I420) or interleaved UV
+// plane (NV12, P010).
+struct YuvRow {
+  const uint8_t* y;
+  const uint8_t* uv;
+  const uint8_t* v;
+};
+
+struct RgbToYuvRow {
+  const uint8_t* rgb0;
+  const uint8_t* rgb1;  // Same as rgb0 for the last row of an odd height
+  uint8_t* y0;
+  uint8_t* y1;
+  uint8_t* u;  // Or interleaved UV for NV12
+  uint8_t* v;
+};
+
+void MatrixWeights(YuvMatrix matrix, double* kr, double* kb) {
+  switch (matrix) {
+    case YuvMatrix::kBT709:
+      *kr = 0.2126;
+      *kb = 0.0722;
+      return;
+    case YuvMatrix::kBT2020:
+      *kr = 0.2627;
+      *kb = 0.0593;
+      return;
+    case YuvMatrix::kSMPTE240M:
+      *kr = 0.212;
+      *kb = 0.087;
+      return;
+    case YuvMatrix::kBT601:
+      break;
+  }
+  *kr = 0.299;
+  *kb = 0.114;
+}
+
+int32_t Fixed(double v, int shift) {
+  return static_cast<int32_t>(std::lround(v * (1 << shift)));
+}
+
+YuvToRgbConstants MakeYuvToRgbConstants(YuvMatrix matrix, bool full_range,
+                                        bool ten_bit) {
+  double kr, kb;
+  MatrixWeights(matrix, &kr, &kb);
+  double kg = 1.0 - kr - kb;
+  double ys = full_range ? 1.0 : 255.0 / 219.0;
+  double cs = full_range ? 1.0 : 255.0 / 224.0;
+  int depth_shift = ten_bit ? 2 : 0;
+
+  YuvToRgbConstants k;
+  k.y = Fixed(ys, kYuvToRgbShift);
+  k.v_r = Fixed(cs * 2 * (1 - kr), kYuvToRgbShift);
+  k.u_g = -Fixed(cs * 2 * (1 - kb) * kb / kg, kYuvToRgbShift);
+  k.v_g = -Fixed(cs * 2 * (1 - kr) * kr / kg, kYuvToRgbShift);
+  k.u_b = Fixed(cs * 2 * (1 - kb), kYuvToRgbShift);
+  k.y_offset = (full_range ? 0 : 16) << depth_shift;
+  k.c_offset = 128 << depth_shift;
+  k.shift = kYuvToRgbShift + depth_shift;
+  k.round = 1 << (k.shift - 1);
+  return k;
+}
+
+RgbToYuvConstants MakeRgbToYuvConstants() {
+  // BT.601 limited range.
+  const double kr = 0.299;
+  const double kb = 0.114;
+  const double kg = 1.0 - kr - kb;
+  const double ys = 219.0 / 255.0;
+  const double cs = 224.0 / 255.0;
+
+  RgbToYuvConstants k;
+  k.y_r = Fixed(ys * kr, kRgbToYShift);
+  k.y_g = Fixed(ys * kg, kRgbToYShift);
+  k.y_b = Fixed(ys * kb, kRgbToYShift);
+  k.u_r = Fixed(-cs * kr / (2 * (1 - kb)), kRgbToYShift);
+  k.u_g = Fixed(-cs * kg / (2 * (1 - kb)), kRgbToYShift);
+  k.u_b = Fixed(cs * 0.5, kRgbToYShift);
+  k.v_r = Fixed(cs * 0.5, kRgbToYShift);
+  k.v_g = Fixed(-cs * kg / (2 * (1 - kr)), kRgbToYShift);
+  k.v_b = Fixed(-cs * kb / (2 * (1 - kr)), kRgbToYShift);
+  return k;
+}
+
+using YuvToRgbKernel = void (*)(const YuvRow& src, uint8_t* dst, int width,
+                                bool bgr, const YuvToRgbConstants& k);
+using RgbToYuvKernel = void (*)(const RgbToYuvRow& row, int width, bool bgr,
+                                bool nv12, const RgbToYuvConstants& k);
+
+struct YuvKernels {
+  YuvToRgbKernel i420_to_rgb;
+  YuvToRgbKernel nv12_to_rgb;
+  YuvToRgbKernel p010_to_rgb;
+  RgbToYuvKernel rgb_to_yuv;
+  bool vectorised;
+};
+
+// --- Scalar ----------------------------------------------------------------
+
+inline uint8_t Clamp255(int32_t v) {
+  return static_cast<uint8_t>(std::min(255, std::max(0, v)));
+}
+
+inline uint16_t Load16(const uint8_t* p) {
+  uint16_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline void YuvToRgbPixel(int32_t y, int32_t u, int32_t v, uint8_t* dst,
+                          bool bgr, const YuvToRgbConstants& k) {
+  int32_t yv = k.y * (y - k.y_offset) + k.round;
+  u -= k.c_offset;
+  v -= k.c_offset;
+  uint8_t r = Clamp255((yv + k.v_r * v) >> k.shift);
+  uint8_t g = Clamp255((yv + k.u_g * u + k.v_g * v) >> k.shift);
+  uint8_t b = Clamp255((yv + k.u_b * u) >> k.shift);
+  dst[0] = bgr ? b : r;
+  dst[1] = g;
+  dst[2] = bgr ? r : b;
+  dst[3] = 255;
+}
+
+// Scalar rows start at pixel |begin|, so SIMD kernels finish with them.
+void I420ToRgbRowScalar(const YuvRow& src, uint8_t* dst, int begin,
+                        int width, bool bgr, const YuvToRgbConstants& k) {
+  for (int x = begin; x < width; ++x) {
+    YuvToRgbPixel(src.y[x], src.uv[x / 2], src.v[x / 2], dst + x * 4, bgr, k);
+  }
+}
+
+void NV12ToRgbRowScalar(const YuvRow& src, uint8_t* dst, int begin,
+                        int width, bool bgr, const YuvToRgbConstants& k) {
+  for (int x = begin; x < width; ++x) {
+    const uint8_t* uv = src.uv + (x / 2) * 2;
+    YuvToRgbPixel(src.y[x], uv[0], uv[1], dst + x * 4, bgr, k);
+  }
+}
+
+void P010ToRgbRowScalar(const YuvRow& src, uint8_t* dst, int begin,
+                        int width, bool bgr, const YuvToRgbConstants& k) {
+  for (int x = begin; x < width; ++x) {
+    const uint8_t* uv = src.uv + (x / 2) * 4;
+    YuvToRgbPixel(Load16(src.y + x * 2) >> 6, Load16(uv) >> 6,
+                  Load16(uv + 2) >> 6, dst + x * 4, bgr, k);
+  }
+}
+
+void I420ToRgbScalar(const YuvRow& src, uint8_t* dst, int width, bool bgr,
+                     const YuvToRgbConstants& k) {
+  I420ToRgbRowScalar(src, dst, 0, width, bgr, k);
+}
+
+void NV12ToRgbScalar(const YuvRow& src, uint8_t* dst, int width, bool bgr,
+                     const YuvToRgbConstants& k) {
+  NV12ToRgbRowScalar(src, dst, 0, width, bgr, k);
+}
+
+void P010ToRgbScalar(const YuvRow& src, uint8_t* dst, int width, bool bgr,
+                     const YuvToRgbConstants& k) {
+  P010ToRgbRowScalar(src, dst, 0, width, bgr, k);
+}
+
+inline uint8_t RgbToY(int32_t r, int32_t g, int32_t b,
+                      const RgbToYuvConstants& k) {
+  int32_t sum = k.y_r * r + k.y_g * g + k.y_b * b + (1 << (kRgbToYShift - 1));
+  return Clamp255((sum >> kRgbToYShift) + 16);
+}
+
+inline uint8_t RgbToChroma(int32_t r, int32_t g, int32_t b, int32_t kr,
+                           int32_t kg, int32_t kb) {
+  int32_t sum = kr * r + kg * g + kb * b + (1 << (kRgbToChromaShift - 1));
+  return Clamp255((sum >> kRgbToChromaShift) + 128);
+}
+
+void RgbToYuvRowScalar(const RgbToYuvRow& row, int begin, int width, bool bgr,
+                       bool nv12, const RgbToYuvConstants& k) {
+  const int ri = bgr ? 2 : 0;
+  const int bi = bgr ? 0 : 2;
+  for (int x = begin; x < width; x += 2) {
+    // The last column of an odd width stands in for its missing neighbour.
+    int x1 = std::min(x + 1, width - 1);
+    const uint8_t* p[4] = {row.rgb0 + x * 4, row.rgb0 + x1 * 4,
+                           row.rgb1 + x * 4, row.rgb1 + x1 * 4};
+    row.y0[x] = RgbToY(p[0][ri], p[0][1], p[0][bi], k);
+    row.y1[x] = RgbToY(p[2][ri], p[2][1], p[2][bi], k);
+    if (x1 != x) {
+      row.y0[x1] = RgbToY(p[1][ri], p[1][1], p[1][bi], k);
+      row.y1[x1] = RgbToY(p[3][ri], p[3][1], p[3][bi], k);
+    }
+    int32_t r = p[0][ri] + p[1][ri] + p[2][ri] + p[3][ri];
+    int32_t g = p[0][1] + p[1][1] + p[2][1] + p[3][1];
+    int32_t b = p[0][bi] + p[1][bi] + p[2][bi] + p[3][bi];
+    uint8_t u = RgbToChroma(r, g, b, k.u_r, k.u_g, k.u_b);
+    uint8_t v = RgbToChroma(r, g, b, k.v_r, k.v_g, k.v_b);
+    if (nv12) {
+      row.u[x] = u;
+      row.u[x + 1] = v;
+    } else {
+      row.u[x / 2] = u;
+      row.v[x / 2] = v;
+    }
+  }
+}
+
+void RgbToYuvScalar(const RgbToYuvRow& row, int width, bool bgr, bool nv12,
+                    const RgbToYuvConstants& k) {
+  RgbToYuvRowScalar(row, 0, width, bgr, nv12, k);
+}
+
+#if defined(WEBCODECS_YUV_KERNELS_X86)
+
+// --- AVX2 ------------------------------------------------------------------
+
+// Eight pixels' samples as 32-bit lanes, chroma repeated for each pixel of a
+// pair. |x| is even.
+template <YuvLayout L>
+WEBCODECS_TARGET("avx2")
+inline void LoadYuv8AVX2(const YuvRow& src, int x, __m256i* y, __m256i* u,
+                         __m256i* v) {
+  const __m256i dup = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+  if (L == YuvLayout::kI420) {
+    *y = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src.y + x)));
+    int32_t u4, v4;
+    std::memcpy(&u4, src.uv + x / 2, sizeof(u4));
+    std::memcpy(&v4, src.v + x / 2, sizeof(v4));
+    *u = _mm256_permutevar8x32_epi32(
+        _mm256_cvtepu8_epi32(_mm_cvtsi32_si128(u4)), dup);
+    *v = _mm256_permutevar8x32_epi32(
+        _mm256_cvtepu8_epi32(_mm_cvtsi32_si128(v4)), dup);
+    return;
+  }
+  __m256i uv;
+  if (L == YuvLayout::kNV12) {
+    *y = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src.y + x)));
+    uv = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src.uv + x)));
+  } else {
+    *y = _mm256_srli_epi32(
+        _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.y + x * 2))),
+        6);
+    uv = _mm256_srli_epi32(
+        _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.uv + x * 2))),
+        6);
+  }
+  *u = _mm256_permutevar8x32_epi32(uv,
+                                   _mm256_setr_epi32(0, 0, 2, 2, 4, 4, 6, 6));
+  *v = _mm256_permutevar8x32_epi32(uv,
+                                   _mm256_setr_epi32(1, 1, 3, 3, 5, 5, 7, 7));
+}
+
+template <YuvLayout L>
+WEBCODECS_TARGET("avx2")
+void YuvToRgbRowAVX2(const YuvRow& src, uint8_t* dst, int width, bool bgr,
+                     const YuvToRgbConstants& k) {
+  const __m256i ky = _mm256_set1_epi32(k.y);
+  const __m256i kvr = _mm256_set1_epi32(k.v_r);
+  const __m256i kug = _mm256_set1_epi32(k.u_g);
+  const __m256i kvg = _mm256_set1_epi32(k.v_g);
+  const __m256i kub = _mm256_set1_epi32(k.u_b);
+  const __m256i y_offset = _mm256_set1_epi32(k.y_offset);
+  const __m256i c_offset = _mm256_set1_epi32(k.c_offset);
+  const __m256i round = _mm256_set1_epi32(k.round);
+  const __m128i shift = _mm_cvtsi32_si128(k.shift);
+  const __m256i alpha = _mm256_set1_epi32(255);
+  // Per lane, [c0 x4, c1 x4, c2 x4, a x4] to four interleaved pixels.
+  const __m256i interleave = _mm256_setr_epi8(
+      0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,  //
+      0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    __m256i y, u, v;
+    LoadYuv8AVX2<L>(src, x, &y, &u, &v);
+    __m256i yv = _mm256_add_epi32(
+        _mm256_mullo_epi32(_mm256_sub_epi32(y, y_offset), ky), round);
+    u = _mm256_sub_epi32(u, c_offset);
+    v = _mm256_sub_epi32(v, c_offset);
+    __m256i r = _mm256_sra_epi32(
+        _mm256_add_epi32(yv, _mm256_mullo_epi32(v, kvr)), shift);
+    __m256i g = _mm256_sra_epi32(
+        _mm256_add_epi32(yv, _mm256_add_epi32(_mm256_mullo_epi32(u, kug),
+                                              _mm256_mullo_epi32(v, kvg))),
+        shift);
+    __m256i b = _mm256_sra_epi32(
+        _mm256_add_epi32(yv, _mm256_mullo_epi32(u, kub)), shift);
+    // Packing works within 128-bit lanes, so lane 0 holds pixels 0-3 and
+    // lane 1 pixels 4-7 throughout.
+    __m256i c0g = _mm256_packs_epi32(bgr ? b : r, g);
+    __m256i c2a = _mm256_packs_epi32(bgr ? r : b, alpha);
+    __m256i px = _mm256_shuffle_epi8(_mm256_packus_epi16(c0g, c2a),
+                                     interleave);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), px);
+  }
+  if (L == YuvLayout::kI420) {
+    I420ToRgbRowScalar(src, dst, x, width, bgr, k);
+  } else if (L == YuvLayout::kNV12) {
+    NV12ToRgbRowScalar(src, dst, x, width, bgr, k);
+  } else {
+    P010ToRgbRowScalar(src, dst, x, width, bgr, k);
+  }
+}
+
+// Eight pixels' channels as 32-bit lanes; |c0| is R for RGBA, B for BGRA.
+WEBCODECS_TARGET("avx2")
+inline void LoadRgb8AVX2(const uint8_t* p, __m256i* c0, __m256i* c1,
+                         __m256i* c2) {
+  const __m256i planar = _mm256_setr_epi8(
+      0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,  //
+      0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+  __m256i px = _mm256_shuffle_epi8(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), planar);
+  px = _mm256_permutevar8x32_epi32(px,
+                                   _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+  __m128i lo = _mm256_castsi256_si128(px);
+  *c0 = _mm256_cvtepu8_epi32(lo);
+  *c1 = _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8));
+  *c2 = _mm256_cvtepu8_epi32(_mm256_extracti128_si256(px, 1));
+}
+
+WEBCODECS_TARGET("avx2")
+inline __m256i WeightedSumAVX2(__m256i r, __m256i g, __m256i b, int32_t kr,
+                               int32_t kg, int32_t kb, int shift) {
+  __m256i sum = _mm256_add_epi32(
+      _mm256_add_epi32(_mm256_mullo_epi32(r, _mm256_set1_epi32(kr)),
+                       _mm256_mullo_epi32(g, _mm256_set1_epi32(kg))),
+      _mm256_add_epi32(_mm256_mullo_epi32(b, _mm256_set1_epi32(kb)),
+                       _mm256_set1_epi32(1 << (shift - 1))));
+  return _mm256_sra_epi32(sum, _mm_cvtsi32_si128(shift));
+}
+
+// Saturate the low four 32-bit lanes of each 128-bit half to bytes: bytes
+// 0-3 are lanes 0-3 and bytes 4-7 are lanes 4-7.
+WEBCODECS_TARGET("avx2")
+inline __m128i PackLanesAVX2(__m256i v) {
+  __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(v, v),
+                                      _mm256_setzero_si256());
+  return _mm_unpacklo_epi32(_mm256_castsi256_si128(bytes),
+                            _mm256_extracti128_si256(bytes, 1));
+}
+
+WEBCODECS_TARGET("avx2")
+void RgbToYuvRowAVX2(const RgbToYuvRow& row, int width, bool bgr, bool nv12,
+                     const RgbToYuvConstants& k) {
+  const __m256i luma_offset = _mm256_set1_epi32(16);
+  const __m256i chroma_offset = _mm256_set1_epi32(128);
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    __m256i r0, g0, b0, r1, g1, b1;
+    LoadRgb8AVX2(row.rgb0 + x * 4, &r0, &g0, &b0);
+    LoadRgb8AVX2(row.rgb1 + x * 4, &r1, &g1, &b1);
+    if (bgr) {
+      std::swap(r0, b0);
+      std::swap(r1, b1);
+    }
+
+    __m256i y0 = _mm256_add_epi32(
+        WeightedSumAVX2(r0, g0, b0, k.y_r, k.y_g, k.y_b, kRgbToYShift),
+        luma_offset);
+    __m256i y1 = _mm256_add_epi32(
+        WeightedSumAVX2(r1, g1, b1, k.y_r, k.y_g, k.y_b, kRgbToYShift),
+        luma_offset);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(row.y0 + x),
+                     PackLanesAVX2(y0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(row.y1 + x),
+                     PackLanesAVX2(y1));
+
+    // hadd sums horizontal pairs within each half: lanes 0-1 are blocks
+    // 0-1 and lanes 4-5 are blocks 2-3.
+    __m256i r = _mm256_add_epi32(r0, r1);
+    __m256i g = _mm256_add_epi32(g0, g1);
+    __m256i b = _mm256_add_epi32(b0, b1);
+    r = _mm256_hadd_epi32(r, r);
+    g = _mm256_hadd_epi32(g, g);
+    b = _mm256_hadd_epi32(b, b);
+    const __m256i blocks = _mm256_setr_epi32(0, 1, 4, 5, 0, 1, 4, 5);
+    __m256i u = _mm256_permutevar8x32_epi32(
+        _mm256_add_epi32(WeightedSumAVX2(r, g, b, k.u_r, k.u_g, k.u_b,
+                                         kRgbToChromaShift),
+                         chroma_offset),
+        blocks);
+    __m256i v = _mm256_permutevar8x32_epi32(
+        _mm256_add_epi32(WeightedSumAVX2(r, g, b, k.v_r, k.v_g, k.v_b,
+                                         kRgbToChromaShift),
+                         chroma_offset),
+        blocks);
+    __m128i u4 = PackLanesAVX2(u);
+    __m128i v4 = PackLanesAVX2(v);
+    if (nv12) {
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(row.u + x),
+                       _mm_unpacklo_epi8(u4, v4));
+    } else {
+      int32_t u_bytes = _mm_cvtsi128_si32(u4);
+      int32_t v_bytes = _mm_cvtsi128_si32(v4);
+      std::memcpy(row.u + x / 2, &u_bytes, sizeof(u_bytes));
+      std::memcpy(row.v + x / 2, &v_bytes, sizeof(v_bytes));
+    }
+  }
+  RgbToYuvRowScalar(row, x, width, bgr, nv12, k);
+}
+
+#endif  // WEBCODECS_YUV_KERNELS_X86
+
+#if defined(WEBCODECS_YUV_KERNELS_NEON)
+
+// --- NEON ------------------------------------------------------------------
+
+// Eight pixels' samples as 16-bit lanes, chroma repeated for each pixel of
+// a pair. |x| is even.
+template <YuvLayout L>
+inline void LoadYuv8NEON(const YuvRow& src, int x, uint16x8_t* y,
+                         uint16x8_t* u, uint16x8_t* v) {
+  if (L == YuvLayout::kP010) {
+    *y = vshrq_n_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(src.y) + x),
+                     6);
+    uint16x8_t uv = vshrq_n_u16(
+        vld1q_u16(reinterpret_cast<const uint16_t*>(src.uv) + x), 6);
+    uint16x8_t us = vuzp1q_u16(uv, uv);
+    uint16x8_t vs = vuzp2q_u16(uv, uv);
+    *u = vzip1q_u16(us, us);
+    *v = vzip1q_u16(vs, vs);
+    return;
+  }
+  *y = vmovl_u8(vld1_u8(src.y + x));
+  uint8x8_t us, vs;
+  if (L == YuvLayout::kI420) {
+    uint32_t u4, v4;
+    std::memcpy(&u4, src.uv + x / 2, sizeof(u4));
+    std::memcpy(&v4, src.v + x / 2, sizeof(v4));
+    us = vcreate_u8(u4);
+    vs = vcreate_u8(v4);
+  } else {
+    uint8x8_t uv = vld1_u8(src.uv + x);
+    us = vuzp1_u8(uv, uv);
+    vs = vuzp2_u8(uv, uv);
+  }
+  *u = vmovl_u8(vzip1_u8(us, us));
+  *v = vmovl_u8(vzip1_u8(vs, vs));
+}
+
+inline int32x4_t Widen(uint16x4_t v, int32_t offset) {
+  return vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(v)), vdupq_n_s32(offset));
+}
+
+// One channel of four pixels, saturated to 16 bits.
+inline int16x4_t Channel(int32x4_t yv, int32x4_t u, int32_t ku, int32x4_t v,
+                         int32_t kv, int32x4_t shift) {
+  int32x4_t sum = vmlaq_n_s32(vmlaq_n_s32(yv, u, ku), v, kv);
+  return vqmovn_s32(vshlq_s32(sum, shift));
+}
+
+template <YuvLayout L>
+void YuvToRgbRowNEON(const YuvRow& src, uint8_t* dst, int width, bool bgr,
+                     const YuvToRgbConstants& k) {
+  const int32x4_t shift = vdupq_n_s32(-k.shift);
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    uint16x8_t y, u, v;
+    LoadYuv8NEON<L>(src, x, &y, &u, &v);
+    int16x4_t r[2], g[2], b[2];
+    for (int h = 0; h < 2; ++h) {
+      uint16x4_t yh = h ? vget_high_u16(y) : vget_low_u16(y);
+      uint16x4_t uh = h ? vget_high_u16(u) : vget_low_u16(u);
+      uint16x4_t vh = h ? vget_high_u16(v) : vget_low_u16(v);
+      int32x4_t yv = vmlaq_n_s32(vdupq_n_s32(k.round), Widen(yh, k.y_offset),
+                                 k.y);
+      int32x4_t uc = Widen(uh, k.c_offset);
+      int32x4_t vc = Widen(vh, k.c_offset);
+      r[h] = Channel(yv, uc, 0, vc, k.v_r, shift);
+      g[h] = Channel(yv, uc, k.u_g, vc, k.v_g, shift);
+      b[h] = Channel(yv, uc, k.u_b, vc, 0, shift);
+    }
+    uint8x8_t r8 = vqmovun_s16(vcombine_s16(r[0], r[1]));
+    uint8x8_t g8 = vqmovun_s16(vcombine_s16(g[0], g[1]));
+    uint8x8_t b8 = vqmovun_s16(vcombine_s16(b[0], b[1]));
+    uint8x8x4_t px;
+    px.val[0] = bgr ? b8 : r8;
+    px.val[1] = g8;
+    px.val[2] = bgr ? r8 : b8;
+    px.val[3] = vdup_n_u8(255);
+    vst4_u8(dst + x * 4, px);
+  }
+  if (L == YuvLayout::kI420) {
+    I420ToRgbRowScalar(src, dst, x, width, bgr, k);
+  } else if (L == YuvLayout::kNV12) {
+    NV12ToRgbRowScalar(src, dst, x, width, bgr, k);
+  } else {
+    P010ToRgbRowScalar(src, dst, x, width, bgr, k);
+  }
+}
+
+inline int32x4_t WeightedSumNEON(uint32x4_t r, uint32x4_t g, uint32x4_t b,
+                                 int32_t kr, int32_t kg, int32_t kb,
+                                 int shift) {
+  int32x4_t sum = vdupq_n_s32(1 << (shift - 1));
+  sum = vmlaq_n_s32(sum, vreinterpretq_s32_u32(r), kr);
+  sum = vmlaq_n_s32(sum, vreinterpretq_s32_u32(g), kg);
+  sum = vmlaq_n_s32(sum, vreinterpretq_s32_u32(b), kb);
+  return vshlq_s32(sum, vdupq_n_s32(-shift));
+}
+
+inline uint8x8_t LumaNEON(uint8x8x4_t px, bool bgr,
+                          const RgbToYuvConstants& k) {
+  uint16x8_t r = vmovl_u8(px.val[bgr ? 2 : 0]);
+  uint16x8_t g = vmovl_u8(px.val[1]);
+  uint16x8_t b = vmovl_u8(px.val[bgr ? 0 : 2]);
+  const int32x4_t offset = vdupq_n_s32(16);
+  int32x4_t lo = vaddq_s32(
+      WeightedSumNEON(vmovl_u16(vget_low_u16(r)), vmovl_u16(vget_low_u16(g)),
+                      vmovl_u16(vget_low_u16(b)), k.y_r, k.y_g, k.y_b,
+                      kRgbToYShift),
+      offset);
+  int32x4_t hi = vaddq_s32(
+      WeightedSumNEON(vmovl_u16(vget_high_u16(r)),
+                      vmovl_u16(vget_high_u16(g)),
+                      vmovl_u16(vget_high_u16(b)), k.y_r, k.y_g, k.y_b,
+                      kRgbToYShift),
+      offset);
+  return vqmovun_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+}
+
+inline uint8x8_t ChromaNEON(uint32x4_t r, uint32x4_t g, uint32x4_t b,
+                            int32_t kr, int32_t kg, int32_t kb) {
+  int32x4_t c = vaddq_s32(
+      WeightedSumNEON(r, g, b, kr, kg, kb, kRgbToChromaShift),
+      vdupq_n_s32(128));
+  int16x4_t c16 = vqmovn_s32(c);
+  return vqmovun_s16(vcombine_s16(c16, c16));  // Bytes 0-3
+}
+
+void RgbToYuvRowNEON(const RgbToYuvRow& row, int width, bool bgr, bool nv12,
+                     const RgbToYuvConstants& k) {
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    uint8x8x4_t p0 = vld4_u8(row.rgb0 + x * 4);
+    uint8x8x4_t p1 = vld4_u8(row.rgb1 + x * 4);
+    vst1_u8(row.y0 + x, LumaNEON(p0, bgr, k));
+    vst1_u8(row.y1 + x, LumaNEON(p1, bgr, k));
+
+    // Sums of each 2x2 block.
+    uint32x4_t r = vpaddlq_u16(vaddl_u8(p0.val[bgr ? 2 : 0],
+                                        p1.val[bgr ? 2 : 0]));
+    uint32x4_t g = vpaddlq_u16(vaddl_u8(p0.val[1], p1.val[1]));
+    uint32x4_t b = vpaddlq_u16(vaddl_u8(p0.val[bgr ? 0 : 2],
+                                        p1.val[bgr ? 0 : 2]));
+    uint8x8_t u = ChromaNEON(r, g, b, k.u_r, k.u_g, k.u_b);
+    uint8x8_t v = ChromaNEON(r, g, b, k.v_r, k.v_g, k.v_b);
+    if (nv12) {
+      vst1_u8(row.u + x, vzip1_u8(u, v));
+    } else {
+      uint32_t u_bytes = vget_lane_u32(vreinterpret_u32_u8(u), 0);
+      uint32_t v_bytes = vget_lane_u32(vreinterpret_u32_u8(v), 0);
+      std::memcpy(row.u + x / 2, &u_bytes, sizeof(u_bytes));
+      std::memcpy(row.v + x / 2, &v_bytes, sizeof(v_bytes));
+    }
+  }
+  RgbToYuvRowScalar(row, x, width, bgr, nv12, k);
+}
+
+#endif  // WEBCODECS_YUV_KERNELS_NEON
+
+YuvKernels SelectKernels() {
+#if defined(WEBCODECS_YUV_KERNELS_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {YuvToRgbRowAVX2<YuvLayout::kI420>,
+            YuvToRgbRowAVX2<YuvLayout::kNV12>,
+            YuvToRgbRowAVX2<YuvLayout::kP010>, RgbToYuvRowAVX2, true};
+  }
+#elif defined(WEBCODECS_YUV_KERNELS_NEON)
+  return {YuvToRgbRowNEON<YuvLayout::kI420>,
+          YuvToRgbRowNEON<YuvLayout::kNV12>,
+          YuvToRgbRowNEON<YuvLayout::kP010>, RgbToYuvRowNEON, true};
+#endif
+  return {I420ToRgbScalar, NV12ToRgbScalar, P010ToRgbScalar, RgbToYuvScalar,
+          false};
+}
+
+const YuvKernels& Kernels() {
+  static const YuvKernels kernels = SelectKernels();
+  return kernels;
+}
+
+}  // namespace
+
+bool HasYuvKernels() { return Kernels().vectorised; }
+
+void ConvertYuvToRgb(YuvLayout layout, const uint8_t* const planes[3],
+                     const int linesizes[3], uint8_t* rgb, int rgb_linesize,
+                     bool bgr, int width, int height, YuvMatrix matrix,
+                     bool full_range) {
+  if (width <= 0) {
+    return;
+  }
+  const YuvKernels& kernels = Kernels();
+  YuvToRgbKernel kernel = layout == YuvLayout::kI420   ? kernels.i420_to_rgb
+                          : layout == YuvLayout::kNV12 ? kernels.nv12_to_rgb
+                                                       : kernels.p010_to_rgb;
+  YuvToRgbConstants k = MakeYuvToRgbConstants(
+      matrix, full_range, layout == YuvLayout::kP010);
+  for (int y = 0; y < height; ++y) {
+    ptrdiff_t chroma_row = static_cast<ptrdiff_t>(y / 2);
+    YuvRow row;
+    row.y = planes[0] + static_cast<ptrdiff_t>(y) * linesizes[0];
+    row.uv = planes[1] + chroma_row * linesizes[1];
+    row.v = layout == YuvLayout::kI420 ? planes[2] + chroma_row * linesizes[2]
+                                       : nullptr;
+    kernel(row, rgb + static_cast<ptrdiff_t>(y) * rgb_linesize, width, bgr,
+           k);
+  }
+}
+
+void ConvertRgbToYuv(const uint8_t* rgb, int rgb_linesize, bool bgr,
+                     YuvLayout layout, uint8_t* const planes[3],
+                     const int linesizes[3], int width, int height) {
+  if (width <= 0 || layout == YuvLayout::kP010) {
+    return;
+  }
+  const YuvKernels& kernels = Kernels();
+  const RgbToYuvConstants k = MakeRgbToYuvConstants();
+  const bool nv12 = layout == YuvLayout::kNV12;
+  for (int y = 0; y < height; y += 2) {
+    // The last row of an odd height stands in for its missing neighbour.
+    int y1 = std::min(y + 1, height - 1);
+    ptrdiff_t chroma_row = static_cast<ptrdiff_t>(y / 2);
+    RgbToYuvRow row;
+    row.rgb0 = rgb + static_cast<ptrdiff_t>(y) * rgb_linesize;
+    row.rgb1 = rgb + static_cast<ptrdiff_t>(y1) * rgb_linesize;
+    row.y0 = planes[0] + static_cast<ptrdiff_t>(y) * linesizes[0];
+    row.y1 = planes[0] + static_cast<ptrdiff_t>(y1) * linesizes[0];
+    row.u = planes[1] + chroma_row * linesizes[1];
+    row.v = nv12 ? nullptr : planes[2] + chroma_row * linesizes[2];
+    kernels.rgb_to_yuv(row, width, bgr, nv12, k);
+  }
+}
+
+}  // namespace webcodecs
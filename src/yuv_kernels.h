@@ -0,0 +1,54 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// YUV kernels - vectorised same-size conversion between 4:2:0 YUV and packed
+// 8-bit RGB, for the handful of conversions every decode, encode and
+// copyTo() goes through.
+//
+// Like pixel_kernels.h, each kernel has a scalar version plus AVX2 (x86) and
+// NEON (ARM) versions picked once per process, and all of them produce
+// bit-identical output. The maths is fixed point:
+// - YUV to RGB reads the source with the given matrix and range, with each
+//   chroma sample covering its 2x2 block (as libswscale's unscaled
+//   converters do).
+// - RGB to YUV writes BT.601 limited range (libswscale's default output),
+//   averaging each 2x2 block for chroma.
+// The RGB side is RGBA or BGRA order; the fourth byte is written as 255 and
+// ignored on input, so RGBX and BGRX use the same kernels.
+
+#ifndef SRC_YUV_KERNELS_H_
+#define SRC_YUV_KERNELS_H_
+
+#include <cstdint>
+
+namespace webcodecs {
+
+enum class YuvLayout {
+  kI420,  // Y, U and V planes, 8-bit
+  kNV12,  // Y plane and interleaved UV plane, 8-bit
+  kP010,  // NV12 layout, 16-bit little-endian samples with 10 high bits
+};
+
+enum class YuvMatrix { kBT601, kBT709, kBT2020, kSMPTE240M };
+
+// Whether vectorised kernels exist for this CPU. Without them the
+// conversions below still work, but libswscale's own SIMD is the better
+// choice.
+bool HasYuvKernels();
+
+// Convert |width| x |height| YUV pixels to RGB. |planes| and |linesizes|
+// hold Y, U, V (I420) or Y, UV (NV12, P010) rows.
+void ConvertYuvToRgb(YuvLayout layout, const uint8_t* const planes[3],
+                     const int linesizes[3], uint8_t* rgb, int rgb_linesize,
+                     bool bgr, int width, int height, YuvMatrix matrix,
+                     bool full_range);
+
+// Convert |width| x |height| RGB pixels to BT.601 limited range I420 or
+// NV12 (P010 is not supported as a destination).
+void ConvertRgbToYuv(const uint8_t* rgb, int rgb_linesize, bool bgr,
+                     YuvLayout layout, uint8_t* const planes[3],
+                     const int linesizes[3], int width, int height);
+
+}  // namespace webcodecs
+
+#endif  // SRC_YUV_KERNELS_H_
@@ -72,6 +72,41 @@ describe('AudioDecoder', () => {
         });
       });
     });
+
+    it('should throw TypeError for an invalid threading mode', () => {
+      const decoder = new AudioDecoder({
+        output: () => {},
+        error: () => {},
+      });
+
+      assert.throws(() => {
+        decoder.configure({
+          codec: 'opus',
+          sampleRate: 48000,
+          numberOfChannels: 2,
+          threading: { mode: 'bogus' } as unknown as AudioDecoderConfig['threading'],
+        });
+      }, TypeError);
+
+      decoder.close();
+    });
+
+    it('should accept single-threaded decoding', () => {
+      const decoder = new AudioDecoder({
+        output: () => {},
+        error: () => {},
+      });
+
+      decoder.configure({
+        codec: 'opus',
+        sampleRate: 48000,
+        numberOfChannels: 2,
+        threading: { count: 1, mode: 'none' },
+      });
+      assert.strictEqual(decoder.state, 'configured');
+
+      decoder.close();
+    });
   });
 
   describe('decode() W3C compliance', () => {
@@ -221,6 +256,70 @@ describe('AudioDecoder', () => {
     });
   });
 
+  describe('worker thread decoding', () => {
+    it('should deliver output asynchronously with chunk timestamps', async () => {
+      // Encode 10 opus frames to get real chunks
+      const chunks: EncodedAudioChunk[] = [];
+      const encoder = new AudioEncoder({
+        output: (chunk) => {
+          chunks.push(chunk);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({ codec: 'opus', sampleRate: 48000, numberOfChannels: 2 });
+      for (let i = 0; i < 10; i++) {
+        const audioData = new AudioData({
+          format: 'f32',
+          sampleRate: 48000,
+          numberOfFrames: 960,
+          numberOfChannels: 2,
+          timestamp: i * 20_000,
+          data: new Float32Array(960 * 2).fill(0.25),
+        });
+        encoder.encode(audioData);
+        audioData.close();
+      }
+      await encoder.flush();
+      encoder.close();
+      assert.ok(chunks.length > 0);
+
+      const outputs: AudioData[] = [];
+      const decoder = new AudioDecoder({
+        output: (data) => {
+          outputs.push(data);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      decoder.configure({ codec: 'opus', sampleRate: 48000, numberOfChannels: 2 });
+      for (const chunk of chunks) {
+        decoder.decode(chunk);
+      }
+
+      // Decoding happens on the worker; nothing is emitted synchronously
+      assert.strictEqual(outputs.length, 0);
+
+      await decoder.flush();
+      assert.ok(outputs.length > 0);
+      // Decoder output keeps the codec's own (planar) float format
+      assert.strictEqual(outputs[0].format, 'f32-planar');
+      assert.strictEqual(outputs[0].numberOfChannels, 2);
+      const timestamps = outputs.map((d) => d.timestamp);
+      assert.deepStrictEqual(
+        timestamps,
+        [...timestamps].sort((a, b) => a - b),
+      );
+
+      for (const data of outputs) {
+        data.close();
+      }
+      decoder.close();
+    });
+  });
+
   describe('FLAC codec support', () => {
     it('should support flac codec string', async () => {
       const result = await AudioDecoder.isConfigSupported({
@@ -306,4 +405,230 @@ describe('AudioDecoder', () => {
       decoder.close();
     });
   });
+
+  describe('decoded AudioData', () => {
+    async function encodeTone(codec: string, frames: number): Promise<EncodedAudioChunk[]> {
+      const chunks: EncodedAudioChunk[] = [];
+      const encoder = new AudioEncoder({
+        output: (chunk) => {
+          chunks.push(chunk);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({ codec, sampleRate: 48000, numberOfChannels: 2, bitrate: 128_000 });
+      for (let i = 0; i < frames; i++) {
+        const data = new Float32Array(1024 * 2);
+        for (let j = 0; j < 1024; j++) {
+          data[j * 2] = 0.5 * Math.sin((2 * Math.PI * 440 * (i * 1024 + j)) / 48000);
+          data[j * 2 + 1] = -data[j * 2];
+        }
+        const audioData = new AudioData({
+          format: 'f32',
+          sampleRate: 48000,
+          numberOfFrames: 1024,
+          numberOfChannels: 2,
+          timestamp: Math.round((i * 1024 * 1e6) / 48000),
+          data,
+        });
+        encoder.encode(audioData);
+        audioData.close();
+      }
+      await encoder.flush();
+      encoder.close();
+      return chunks;
+    }
+
+    async function decodeAll(codec: string, chunks: EncodedAudioChunk[]): Promise<AudioData[]> {
+      const outputs: AudioData[] = [];
+      const decoder = new AudioDecoder({
+        output: (data) => {
+          outputs.push(data);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      decoder.configure({ codec, sampleRate: 48000, numberOfChannels: 2 });
+      for (const chunk of chunks) {
+        decoder.decode(chunk);
+      }
+      await decoder.flush();
+      decoder.close();
+      return outputs;
+    }
+
+    it('converts to any format in copyTo and survives closing its clone', async () => {
+      const outputs = await decodeAll('mp4a.40.2', await encodeTone('mp4a.40.2', 20));
+      assert.ok(outputs.length > 0);
+      const data = outputs[outputs.length - 2];
+      assert.strictEqual(data.format, 'f32-planar');
+
+      const clone = data.clone();
+      data.close();
+
+      const left = new Float32Array(clone.numberOfFrames);
+      clone.copyTo(left, { planeIndex: 0 });
+      const interleaved = new Float32Array(clone.numberOfFrames * 2);
+      clone.copyTo(interleaved, { planeIndex: 0, format: 'f32' });
+      const right = new Int16Array(clone.numberOfFrames);
+      clone.copyTo(right, { planeIndex: 1, format: 's16-planar' });
+
+      let peak = 0;
+      for (let i = 0; i < clone.numberOfFrames; i++) {
+        assert.strictEqual(interleaved[i * 2], left[i]);
+        assert.ok(Math.abs(right[i] / 32768 + left[i]) < 0.01);
+        peak = Math.max(peak, Math.abs(left[i]));
+      }
+      assert.ok(peak > 0.25, `decoded peak ${peak}`);
+
+      clone.close();
+      for (const output of outputs) output.close();
+    });
+
+    it('feeds an encoder with the same format directly', async () => {
+      const decoded = await decodeAll('mp4a.40.2', await encodeTone('mp4a.40.2', 20));
+      const chunks: EncodedAudioChunk[] = [];
+      const encoder = new AudioEncoder({
+        output: (chunk) => {
+          chunks.push(chunk);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({ codec: 'mp4a.40.2', sampleRate: 48000, numberOfChannels: 2 });
+      for (const data of decoded) {
+        encoder.encode(data);
+        data.close();
+      }
+      await encoder.flush();
+      encoder.close();
+
+      assert.ok(Math.abs(chunks.length - decoded.length) <= 2, `${chunks.length} chunks`);
+      for (let i = 1; i < chunks.length; i++) {
+        assert.ok(chunks[i].timestamp > chunks[i - 1].timestamp);
+      }
+    });
+  });
+
+  describe('analysis', () => {
+    // 4 s of a 1 kHz stereo sine at -23 dBFS: -23 LUFS.
+    async function encodeReference(): Promise<EncodedAudioChunk[]> {
+      const chunks: EncodedAudioChunk[] = [];
+      const encoder = new AudioEncoder({
+        output: (chunk) => {
+          chunks.push(chunk);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({
+        codec: 'mp4a.40.2',
+        sampleRate: 48000,
+        numberOfChannels: 2,
+        bitrate: 192_000,
+      });
+      const amplitude = 10 ** (-23 / 20);
+      for (let i = 0; i < 188; i++) {
+        const data = new Float32Array(1024 * 2);
+        for (let j = 0; j < 1024; j++) {
+          data[j * 2] = amplitude * Math.sin((2 * Math.PI * 1000 * (i * 1024 + j)) / 48000);
+          data[j * 2 + 1] = data[j * 2];
+        }
+        const audioData = new AudioData({
+          format: 'f32',
+          sampleRate: 48000,
+          numberOfFrames: 1024,
+          numberOfChannels: 2,
+          timestamp: Math.round((i * 1024 * 1e6) / 48000),
+          data,
+        });
+        encoder.encode(audioData);
+        audioData.close();
+      }
+      await encoder.flush();
+      encoder.close();
+      return chunks;
+    }
+
+    it('measures loudness without delivering audio', async () => {
+      const chunks = await encodeReference();
+      let outputs = 0;
+      const decoder = new AudioDecoder({
+        output: (data) => {
+          outputs++;
+          data.close();
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      decoder.configure({
+        codec: 'mp4a.40.2',
+        sampleRate: 48000,
+        numberOfChannels: 2,
+        analysis: { output: false },
+      });
+      for (const chunk of chunks) {
+        decoder.decode(chunk);
+      }
+      await decoder.flush();
+      decoder.close();
+
+      assert.strictEqual(outputs, 0);
+      const analysis = decoder.getAnalysis();
+      assert.ok(analysis);
+      assert.ok(Math.abs(analysis.integratedLoudness + 23) < 0.5, `${analysis.integratedLoudness}`);
+      assert.ok(analysis.loudnessRange < 1);
+      assert.ok(analysis.truePeak !== undefined && analysis.truePeak >= analysis.samplePeak);
+      assert.ok(Math.abs(analysis.samplePeak + 23) < 1, `${analysis.samplePeak}`);
+      assert.ok(analysis.duration > 3_900_000);
+    });
+
+    it('is null without the option and cleared by reset()', async () => {
+      const decoder = new AudioDecoder({ output: () => {}, error: () => {} });
+      decoder.configure({ codec: 'opus', sampleRate: 48000, numberOfChannels: 2 });
+      assert.strictEqual(decoder.getAnalysis(), null);
+
+      decoder.configure({
+        codec: 'opus',
+        sampleRate: 48000,
+        numberOfChannels: 2,
+        analysis: { truePeak: false },
+      });
+      const empty = decoder.getAnalysis();
+      assert.strictEqual(empty?.integratedLoudness, -Infinity);
+      assert.strictEqual(empty?.truePeak, undefined);
+
+      decoder.reset();
+      assert.strictEqual(decoder.getAnalysis(), null);
+      decoder.close();
+    });
+
+    it('rejects a malformed analysis option', async () => {
+      const decoder = new AudioDecoder({ output: () => {}, error: () => {} });
+      assert.throws(
+        () =>
+          decoder.configure({
+            codec: 'opus',
+            sampleRate: 48000,
+            numberOfChannels: 2,
+            analysis: { output: 'no' } as unknown as AudioDecoderConfig['analysis'],
+          }),
+        TypeError,
+      );
+      decoder.close();
+
+      const support = await AudioDecoder.isConfigSupported({
+        codec: 'opus',
+        sampleRate: 48000,
+        numberOfChannels: 2,
+        analysis: {},
+      });
+      assert.deepStrictEqual(support.config.analysis, { truePeak: true, output: true });
+    });
+  });
 });
@@ -43,6 +43,184 @@ describe('codec support', () => {
   });
 });
 
+describe('worker thread encoding', () => {
+  function makeAudioData(timestamp: number): AudioData {
+    const numberOfFrames = 960;
+    const data = new Float32Array(numberOfFrames * 2);
+    for (let i = 0; i < numberOfFrames; i++) {
+      const sample = Math.sin((2 * Math.PI * 440 * i) / 48000);
+      data[i * 2] = sample;
+      data[i * 2 + 1] = sample;
+    }
+    return new AudioData({
+      format: 'f32',
+      sampleRate: 48000,
+      numberOfFrames,
+      numberOfChannels: 2,
+      timestamp,
+      data,
+    });
+  }
+
+  it('should deliver output asynchronously and accept encodes after flush', async () => {
+    const outputChunks: EncodedAudioChunk[] = [];
+    const encoder = new AudioEncoder({
+      output: (chunk) => {
+        outputChunks.push(chunk);
+      },
+      error: (e) => {
+        throw e;
+      },
+    });
+    encoder.configure({ codec: 'opus', sampleRate: 48000, numberOfChannels: 2 });
+
+    for (let i = 0; i < 10; i++) {
+      const audioData = makeAudioData(i * 20_000);
+      encoder.encode(audioData);
+      // The encoder copies the samples; closing right away must be safe
+      audioData.close();
+    }
+
+    // Encoding happens on the worker; nothing is emitted synchronously
+    assert.strictEqual(outputChunks.length, 0);
+
+    await encoder.flush();
+    const afterFirstFlush = outputChunks.length;
+    assert.ok(afterFirstFlush > 0);
+
+    for (let i = 0; i < 10; i++) {
+      const audioData = makeAudioData(200_000 + i * 20_000);
+      encoder.encode(audioData);
+      audioData.close();
+    }
+    await encoder.flush();
+    assert.ok(outputChunks.length > afterFirstFlush);
+
+    encoder.close();
+  });
+});
+
+describe('input conversion', () => {
+  // 100 ms of a 440 Hz tone in any sample format
+  function makeTone(
+    format: AudioSampleFormat,
+    sampleRate: number,
+    numberOfChannels: number,
+    timestamp = 0,
+  ): AudioData {
+    const numberOfFrames = sampleRate / 10;
+    const planar = format.endsWith('-planar');
+    const data = new Int16Array(numberOfFrames * numberOfChannels);
+    const floats = new Float32Array(numberOfFrames * numberOfChannels);
+    for (let i = 0; i < numberOfFrames; i++) {
+      const sample = 0.5 * Math.sin((2 * Math.PI * 440 * i) / sampleRate);
+      for (let c = 0; c < numberOfChannels; c++) {
+        const index = planar ? c * numberOfFrames + i : i * numberOfChannels + c;
+        data[index] = Math.round(sample * 32767);
+        floats[index] = sample;
+      }
+    }
+    return new AudioData({
+      format,
+      sampleRate,
+      numberOfFrames,
+      numberOfChannels,
+      timestamp,
+      data: format.startsWith('s16') ? data : floats,
+    });
+  }
+
+  async function encodeAll(config: AudioEncoderConfig, inputs: AudioData[]) {
+    const chunks: EncodedAudioChunk[] = [];
+    const encoder = new AudioEncoder({
+      output: (chunk) => {
+        chunks.push(chunk);
+      },
+      error: (e) => {
+        throw e;
+      },
+    });
+    encoder.configure(config);
+    for (const input of inputs) {
+      encoder.encode(input);
+      input.close();
+    }
+    await encoder.flush();
+    encoder.close();
+    return chunks;
+  }
+
+  it('resamples 44.1 kHz input for a 48 kHz encoder', async () => {
+    const inputs = Array.from({ length: 5 }, (_, i) => makeTone('f32', 44100, 2, i * 100_000));
+    const chunks = await encodeAll({ codec: 'opus', sampleRate: 48000, numberOfChannels: 2 }, inputs);
+
+    // 500 ms at 20 ms per Opus packet, give or take resampler delay
+    assert.ok(chunks.length >= 24 && chunks.length <= 27, `got ${chunks.length} chunks`);
+    for (let i = 1; i < chunks.length; i++) {
+      assert.ok(chunks[i].timestamp > chunks[i - 1].timestamp);
+    }
+  });
+
+  it('downmixes 5.1 planar s16 input to stereo', async () => {
+    const inputs = [makeTone('s16-planar', 48000, 6), makeTone('s16-planar', 48000, 6, 100_000)];
+    const chunks = await encodeAll(
+      { codec: 'mp4a.40.2', sampleRate: 48000, numberOfChannels: 2, bitrate: 128_000 },
+      inputs,
+    );
+    assert.ok(chunks.length > 0);
+  });
+
+  it('accepts inputs whose format changes between encodes', async () => {
+    const inputs = [
+      makeTone('f32', 48000, 1),
+      makeTone('s16', 48000, 2, 100_000),
+      makeTone('f32-planar', 32000, 2, 200_000),
+    ];
+    const chunks = await encodeAll({ codec: 'opus', sampleRate: 48000, numberOfChannels: 2 }, inputs);
+    assert.ok(chunks.length >= 14, `got ${chunks.length} chunks`);
+  });
+
+  it('buffers inputs smaller than one codec frame', async () => {
+    // 10 ms inputs; AAC consumes 1024 samples per frame
+    const inputs = Array.from({ length: 20 }, (_, i) => {
+      const data = new Float32Array(480 * 2);
+      return new AudioData({
+        format: 'f32',
+        sampleRate: 48000,
+        numberOfFrames: 480,
+        numberOfChannels: 2,
+        timestamp: i * 10_000,
+        data,
+      });
+    });
+    const chunks = await encodeAll({ codec: 'mp4a.40.2', sampleRate: 48000, numberOfChannels: 2 }, inputs);
+
+    // 9600 samples make 9 full frames and one short frame, plus priming
+    assert.ok(chunks.length >= 10 && chunks.length <= 12, `got ${chunks.length} chunks`);
+  });
+
+  it('carries timestamps sample-accurately across odd-sized inputs', async () => {
+    // 300-sample (6.25 ms) inputs; each 960-sample Opus frame spans 3.2 of them
+    const inputs = Array.from({ length: 64 }, (_, i) => {
+      return new AudioData({
+        format: 'f32',
+        sampleRate: 48000,
+        numberOfFrames: 300,
+        numberOfChannels: 2,
+        timestamp: i * 6250,
+        data: new Float32Array(300 * 2),
+      });
+    });
+    const chunks = await encodeAll({ codec: 'opus', sampleRate: 48000, numberOfChannels: 2 }, inputs);
+
+    assert.ok(chunks.length >= 20, `got ${chunks.length} chunks`);
+    for (let i = 2; i < chunks.length; i++) {
+      const step = chunks[i].timestamp - chunks[i - 1].timestamp;
+      assert.ok(Math.abs(step - 20_000) <= 1, `chunk ${i} step ${step}`);
+    }
+  });
+});
+
 describe('encodeQueueSize tracking', () => {
   it('should track pending encode operations', async () => {
     const outputChunks: EncodedAudioChunk[] = [];
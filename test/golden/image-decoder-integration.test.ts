@@ -108,6 +108,159 @@ describe('ImageDecoder Integration', () => {
     });
   });
 
+  describe('Decode-time scaling', () => {
+    // Solid red RGB PNG of the given size
+    function createSolidPNG(width: number, height: number): Buffer {
+      const ihdr = Buffer.alloc(13);
+      ihdr.writeUInt32BE(width, 0);
+      ihdr.writeUInt32BE(height, 4);
+      ihdr[8] = 8; // bit depth
+      ihdr[9] = 2; // color type (RGB)
+      const row = Buffer.concat([Buffer.from([0]), Buffer.alloc(width * 3)]);
+      for (let x = 0; x < width; x++) {
+        row[1 + x * 3] = 255;
+      }
+      const rawData = Buffer.concat(Array.from({ length: height }, () => row));
+      return Buffer.concat([
+        Buffer.from([0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a]),
+        createChunk('IHDR', ihdr),
+        createChunk('IDAT', zlib.deflateSync(rawData)),
+        createChunk('IEND', Buffer.alloc(0)),
+      ]);
+    }
+
+    it('decodes at desiredWidth x desiredHeight', async () => {
+      const decoder = new ImageDecoder({
+        type: 'image/png',
+        data: createSolidPNG(64, 32),
+        desiredWidth: 16,
+        desiredHeight: 8,
+      });
+
+      const result = await decoder.decode();
+      assert.strictEqual(result.image.codedWidth, 16);
+      assert.strictEqual(result.image.codedHeight, 8);
+      const rgba = new Uint8Array(result.image.allocationSize());
+      await result.image.copyTo(rgba);
+      assert.deepStrictEqual(Array.from(rgba.subarray(0, 4)), [255, 0, 0, 255]);
+
+      result.image.close();
+      decoder.close();
+    });
+
+    for (const resizeQuality of ['pixelated', 'high'] as const) {
+      it(`downscales with resizeQuality '${resizeQuality}'`, async () => {
+        const decoder = new ImageDecoder({
+          type: 'image/png',
+          data: createSolidPNG(64, 32),
+          desiredWidth: 20,
+          desiredHeight: 10,
+          resizeQuality,
+          scalingThreads: 2,
+        });
+
+        const result = await decoder.decode();
+        assert.strictEqual(result.image.codedWidth, 20);
+        assert.strictEqual(result.image.codedHeight, 10);
+        const rgba = new Uint8Array(result.image.allocationSize());
+        await result.image.copyTo(rgba);
+        assert.deepStrictEqual(Array.from(rgba.subarray(0, 4)), [255, 0, 0, 255]);
+
+        result.image.close();
+        decoder.close();
+      });
+    }
+
+    it('throws for an invalid resizeQuality', () => {
+      assert.throws(
+        () =>
+          new ImageDecoder({
+            type: 'image/png',
+            data: createSolidPNG(4, 4),
+            resizeQuality: 'bogus' as 'low',
+          }),
+        TypeError,
+      );
+    });
+
+    it('downscales a JPEG file if available', async () => {
+      const testFile = path.join(__dirname, '../fixtures/test.jpg');
+      if (!fs.existsSync(testFile)) {
+        console.log('Skipping: test.jpg not found');
+        return;
+      }
+
+      const decoder = new ImageDecoder({
+        type: 'image/jpeg',
+        data: fs.readFileSync(testFile),
+        desiredWidth: 32,
+        desiredHeight: 24,
+      });
+
+      const result = await decoder.decode();
+      assert.strictEqual(result.image.codedWidth, 32);
+      assert.strictEqual(result.image.codedHeight, 24);
+
+      result.image.close();
+      decoder.close();
+    });
+  });
+
+  describe('premultiplyAlpha', () => {
+    it('premultiplies every colour/alpha pair exactly', async () => {
+      // 256x256 RGBA: x is the colour value, y the alpha
+      const ihdr = Buffer.alloc(13);
+      ihdr.writeUInt32BE(256, 0);
+      ihdr.writeUInt32BE(256, 4);
+      ihdr[8] = 8; // bit depth
+      ihdr[9] = 6; // color type (RGBA)
+      const rawData = Buffer.alloc(256 * (1 + 256 * 4));
+      for (let y = 0; y < 256; y++) {
+        const row = y * (1 + 256 * 4) + 1;
+        for (let x = 0; x < 256; x++) {
+          rawData[row + x * 4] = x;
+          rawData[row + x * 4 + 1] = 255 - x;
+          rawData[row + x * 4 + 2] = x ^ y;
+          rawData[row + x * 4 + 3] = y;
+        }
+      }
+      const data = Buffer.concat([
+        Buffer.from([0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a]),
+        createChunk('IHDR', ihdr),
+        createChunk('IDAT', zlib.deflateSync(rawData)),
+        createChunk('IEND', Buffer.alloc(0)),
+      ]);
+
+      const decoder = new ImageDecoder({
+        type: 'image/png',
+        data,
+        premultiplyAlpha: 'premultiply',
+      });
+      const result = await decoder.decode();
+      const rgba = new Uint8Array(result.image.allocationSize());
+      await result.image.copyTo(rgba);
+      result.image.close();
+      decoder.close();
+
+      let mismatches = 0;
+      for (let y = 0; y < 256; y++) {
+        for (let x = 0; x < 256; x++) {
+          const i = (y * 256 + x) * 4;
+          const expected = [x, 255 - x, x ^ y].map((c) => Math.floor((c * y + 127) / 255));
+          if (
+            rgba[i] !== expected[0] ||
+            rgba[i + 1] !== expected[1] ||
+            rgba[i + 2] !== expected[2] ||
+            rgba[i + 3] !== y
+          ) {
+            mismatches++;
+          }
+        }
+      }
+      assert.strictEqual(mismatches, 0);
+    });
+  });
+
   describe('Error handling', () => {
     it('throws for unsupported type', () => {
       assert.throws(() => {
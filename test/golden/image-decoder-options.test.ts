@@ -4,7 +4,10 @@
 // Tests for ImageDecoder configuration options per W3C spec.
 
 import * as assert from 'node:assert/strict';
-import { describe, it } from 'node:test';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import { after, describe, it } from 'node:test';
 import { ImageDecoder } from '../../lib';
 
 describe('ImageDecoder Configuration Options', () => {
@@ -160,6 +163,71 @@ describe('ImageDecoder Configuration Options', () => {
       assert.strictEqual(decoder.type, 'image/png');
       decoder.close();
     });
+
+    it('decodes transferred data read in place', async () => {
+      const pngData = createMinimalPNG();
+      const arrayBuffer = pngData.buffer.slice(
+        pngData.byteOffset,
+        pngData.byteOffset + pngData.byteLength,
+      );
+      const other = new ArrayBuffer(8);
+
+      const decoder = new ImageDecoder({
+        type: 'image/png',
+        data: arrayBuffer,
+        transfer: [arrayBuffer, other],
+      });
+      assert.strictEqual(arrayBuffer.byteLength, 0);
+      assert.strictEqual(other.byteLength, 0);
+
+      const result = await decoder.decode();
+      assert.strictEqual(result.image.codedWidth, 1);
+      result.image.close();
+      decoder.close();
+    });
+  });
+
+  describe('file source (node-webcodecs extension)', () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'image-decoder-'));
+    const file = path.join(dir, 'pixel.png');
+    fs.writeFileSync(file, createMinimalPNG());
+
+    after(() => {
+      fs.rmSync(dir, { recursive: true, force: true });
+    });
+
+    it('decodes a mapped file path', async () => {
+      const decoder = new ImageDecoder({ type: 'image/png', data: { path: file } });
+      const result = await decoder.decode();
+      assert.strictEqual(result.image.codedWidth, 1);
+      assert.strictEqual(result.image.codedHeight, 1);
+      result.image.close();
+      decoder.close();
+    });
+
+    it('decodes a mapped file descriptor', async () => {
+      const fd = fs.openSync(file, 'r');
+      const decoder = new ImageDecoder({ type: 'image/png', data: { fd } });
+      // The mapping outlives the descriptor.
+      fs.closeSync(fd);
+      const result = await decoder.decode();
+      assert.strictEqual(result.image.codedWidth, 1);
+      result.image.close();
+      decoder.close();
+    });
+
+    it('throws for a missing or empty file', () => {
+      assert.throws(
+        () => new ImageDecoder({ type: 'image/png', data: { path: path.join(dir, 'missing') } }),
+        /Failed to map/,
+      );
+      const empty = path.join(dir, 'empty.png');
+      fs.writeFileSync(empty, Buffer.alloc(0));
+      assert.throws(
+        () => new ImageDecoder({ type: 'image/png', data: { path: empty } }),
+        /file is empty/,
+      );
+    });
   });
 
   describe('combined options', () => {
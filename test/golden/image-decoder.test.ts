@@ -473,6 +473,19 @@ describe('ImageDecoder', () => {
 
       await assert.rejects(decoder.decode(), /closed|InvalidStateError/);
     });
+
+    it('rejects a decode still pending at close() without waiting for it', async () => {
+      const data = createMinimalPNG();
+      const decoder = new ImageDecoder({
+        type: 'image/png',
+        data: data,
+      });
+
+      const pending = decoder.decode();
+      decoder.close();
+
+      await assert.rejects(pending, /AbortError|closed/);
+    });
   });
 
   describe('completed property', () => {
@@ -588,6 +601,68 @@ describe('ImageDecoder', () => {
       decoder.close();
     });
 
+    it('decodes frames out of order on demand', async () => {
+      const data = createAnimatedGIF();
+      const decoder = new ImageDecoder({
+        type: 'image/gif',
+        data: data,
+      });
+      assert.strictEqual(decoder.complete, true);
+
+      // Backwards access restarts decoding; repeated access hits the cache.
+      const timestamps: number[] = [];
+      for (const frameIndex of [1, 0, 1, 1]) {
+        const result = await decoder.decode({ frameIndex });
+        timestamps.push(result.image.timestamp);
+        result.image.close();
+      }
+      assert.deepStrictEqual(timestamps, [100000, 0, 100000, 100000]);
+
+      decoder.close();
+    });
+
+    it('decodes frame pixels as RGBA', async () => {
+      const data = createAnimatedGIF();
+      const decoder = new ImageDecoder({
+        type: 'image/gif',
+        data: data,
+      });
+
+      const pixels: number[][] = [];
+      for (const frameIndex of [0, 1]) {
+        const result = await decoder.decode({ frameIndex });
+        const rgba = new Uint8Array(result.image.allocationSize());
+        await result.image.copyTo(rgba);
+        pixels.push(Array.from(rgba.subarray(0, 4)));
+        result.image.close();
+      }
+      assert.deepStrictEqual(pixels, [
+        [255, 0, 0, 255],
+        [0, 0, 255, 255],
+      ]);
+
+      decoder.close();
+    });
+
+    it('decodes several images concurrently', async () => {
+      const decoders = Array.from(
+        { length: 8 },
+        () => new ImageDecoder({ type: 'image/gif', data: createAnimatedGIF() }),
+      );
+
+      const results = await Promise.all(
+        decoders.map((decoder, i) => decoder.decode({ frameIndex: i % 2 })),
+      );
+      results.forEach((result, i) => {
+        assert.strictEqual(result.image.timestamp, (i % 2) * 100000);
+        result.image.close();
+      });
+
+      for (const decoder of decoders) {
+        decoder.close();
+      }
+    });
+
     it('throws RangeError for invalid frame index', async () => {
       const data = createAnimatedGIF(); // 2 frames
       const decoder = new ImageDecoder({
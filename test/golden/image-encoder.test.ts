@@ -0,0 +1,118 @@
+/**
+ * Tests for ImageEncoder
+ */
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+import { ImageDecoder, ImageEncoder, VideoFrame } from '../../lib';
+
+const WIDTH = 64;
+const HEIGHT = 48;
+
+// Left half dark, right half bright, in limited-range BT.709 I420.
+function makeI420Frame(): VideoFrame {
+  const data = new Uint8Array((WIDTH * HEIGHT * 3) / 2).fill(128);
+  for (let y = 0; y < HEIGHT; y++) {
+    for (let x = 0; x < WIDTH; x++) {
+      data[y * WIDTH + x] = x < WIDTH / 2 ? 32 : 220;
+    }
+  }
+  return new VideoFrame(data, {
+    format: 'I420',
+    codedWidth: WIDTH,
+    codedHeight: HEIGHT,
+    timestamp: 0,
+    colorSpace: { primaries: 'bt709', transfer: 'bt709', matrix: 'bt709', fullRange: false },
+  });
+}
+
+async function decode(type: string, data: Buffer): Promise<VideoFrame> {
+  const decoder = new ImageDecoder({ type, data });
+  const { image } = await decoder.decode();
+  decoder.close();
+  return image;
+}
+
+async function rgbaOf(frame: VideoFrame): Promise<Uint8Array> {
+  const out = new Uint8Array(frame.allocationSize({ format: 'RGBA' }));
+  await frame.copyTo(out, { format: 'RGBA' });
+  return out;
+}
+
+describe('ImageEncoder', () => {
+  it('should encode I420 to a JPEG that decodes to the same picture', async () => {
+    const frame = makeI420Frame();
+    const encoder = new ImageEncoder({ type: 'image/jpeg', quality: 0.95 });
+    const result = await encoder.encode(frame);
+    frame.close();
+    encoder.close();
+
+    assert.strictEqual(result.type, 'image/jpeg');
+    assert.strictEqual(result.width, WIDTH);
+    assert.strictEqual(result.height, HEIGHT);
+    assert.deepStrictEqual([...result.data.subarray(0, 3)], [0xff, 0xd8, 0xff]);
+
+    const image = await decode('image/jpeg', result.data);
+    assert.strictEqual(image.displayWidth, WIDTH);
+    const rgba = await rgbaOf(image);
+    image.close();
+    // Limited-range 32 and 220 are about 19 and 238 at full range.
+    const row = 10 * WIDTH * 4;
+    assert.ok(Math.abs(rgba[row + 4 * 4] - 19) < 12, `dark ${rgba[row + 4 * 4]}`);
+    assert.ok(Math.abs(rgba[row + (WIDTH - 4) * 4] - 238) < 12, 'bright');
+  });
+
+  it('should make smaller JPEGs at lower quality', async () => {
+    const frame = makeI420Frame();
+    const high = await new ImageEncoder({ type: 'image/jpeg', quality: 1 }).encode(frame);
+    const low = await new ImageEncoder({ type: 'image/jpeg', quality: 0 }).encode(frame);
+    frame.close();
+    assert.ok(low.data.length < high.data.length);
+  });
+
+  it('should encode PNG losslessly and resize keeping the aspect ratio', async () => {
+    const frame = makeI420Frame();
+    const encoder = new ImageEncoder({ type: 'image/png', width: 32 });
+    const result = await encoder.encode(frame);
+    frame.close();
+    encoder.close();
+
+    assert.strictEqual(result.width, 32);
+    assert.strictEqual(result.height, 24);
+    const image = await decode('image/png', result.data);
+    assert.strictEqual(image.displayWidth, 32);
+    assert.strictEqual(image.displayHeight, 24);
+    image.close();
+  });
+
+  for (const type of ['image/webp', 'image/avif']) {
+    it(`should encode ${type} when an encoder is built in`, async (t) => {
+      if (!(await ImageEncoder.isTypeSupported(type))) {
+        t.skip(`${type} encoder not available`);
+        return;
+      }
+      const frame = makeI420Frame();
+      const encoder = new ImageEncoder({ type, quality: 0.7 });
+      const result = await encoder.encode(frame);
+      frame.close();
+      encoder.close();
+      assert.ok(result.data.length > 0);
+      const marker = type === 'image/webp' ? 'WEBP' : 'ftyp';
+      assert.ok(result.data.subarray(0, 16).toString('latin1').includes(marker));
+    });
+  }
+
+  it('should reject unsupported types and closed use', async () => {
+    assert.strictEqual(await ImageEncoder.isTypeSupported('image/x-unknown'), false);
+    assert.throws(() => new ImageEncoder({ type: 'image/x-unknown' }), {
+      name: 'NotSupportedError',
+    });
+    assert.throws(() => new ImageEncoder({ type: 'image/jpeg', quality: 2 }), RangeError);
+
+    const encoder = new ImageEncoder({ type: 'image/png' });
+    encoder.close();
+    const frame = makeI420Frame();
+    await assert.rejects(encoder.encode(frame), { name: 'InvalidStateError' });
+    frame.close();
+  });
+});
@@ -3,10 +3,14 @@
 // SPDX-License-Identifier: MIT
 
 import * as assert from 'node:assert/strict';
+import { spawnSync } from 'node:child_process';
 import * as fs from 'node:fs';
 import * as os from 'node:os';
 import * as path from 'node:path';
 import { after, before, describe, it } from 'node:test';
+import { fileURLToPath, pathToFileURL } from 'node:url';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
 
 describe('Muxer Integration', () => {
   let tempDir: string;
@@ -133,8 +137,13 @@ describe('Muxer Integration', () => {
     const HEIGHT = 240;
     const FRAME_COUNT = 5;
 
-    const chunks: Array<{ type: string; timestamp: number; duration: number; data: Uint8Array }> =
-      [];
+    const chunks: Array<{
+      type: string;
+      timestamp: number;
+      decodeTimestamp: number;
+      duration: number;
+      data: Uint8Array;
+    }> = [];
     let codecDescription: ArrayBuffer | undefined;
 
     const encoder = new VideoEncoder({
@@ -144,6 +153,7 @@ describe('Muxer Integration', () => {
         chunks.push({
           type: chunk.type,
           timestamp: chunk.timestamp,
+          decodeTimestamp: chunk.decodeTimestamp,
           duration: chunk.duration || 33333,
           data,
         });
@@ -191,9 +201,6 @@ describe('Muxer Integration', () => {
     await encoder.flush();
     encoder.close();
 
-    // Sort chunks by timestamp to handle B-frames (see first test for explanation)
-    const sortedChunks = [...chunks].sort((a, b) => a.timestamp - b.timestamp);
-
     // Mux
     const muxer = new Muxer({ filename: outputPath });
     muxer.addVideoTrack({
@@ -203,7 +210,8 @@ describe('Muxer Integration', () => {
       description: codecDescription,
     });
 
-    for (const chunk of sortedChunks) {
+    // Chunks carry their decode timestamp, so they go in in output order.
+    for (const chunk of chunks) {
       muxer.writeVideoChunk(chunk as any);
     }
 
@@ -237,4 +245,314 @@ describe('Muxer Integration', () => {
     assert.strictEqual(videoTrack.height, HEIGHT);
     assert.strictEqual(demuxedChunks, chunks.length);
   });
+
+  it('should mux reordered B-frame output in one pass', async () => {
+    const { VideoEncoder, VideoFrame, Muxer, Demuxer, EncodedVideoChunk } = await import(
+      '../../dist/index.js'
+    );
+
+    const outputPath = path.join(tempDir, 'bframes.mp4');
+    const WIDTH = 160;
+    const HEIGHT = 120;
+    const FRAME_COUNT = 30;
+
+    const chunks: InstanceType<typeof EncodedVideoChunk>[] = [];
+    let codecDescription: ArrayBuffer | undefined;
+
+    const encoder = new VideoEncoder({
+      output: (chunk, metadata) => {
+        chunks.push(chunk);
+        if (metadata?.decoderConfig?.description) {
+          codecDescription = metadata.decoderConfig.description;
+        }
+      },
+      error: (e) => {
+        throw e;
+      },
+    });
+
+    // High profile with the default 'quality' latency mode allows B-frames.
+    encoder.configure({
+      codec: 'avc1.64001f',
+      width: WIDTH,
+      height: HEIGHT,
+      bitrate: 500_000,
+      framerate: 30,
+      avc: { format: 'avc' },
+    });
+
+    for (let i = 0; i < FRAME_COUNT; i++) {
+      const buffer = Buffer.alloc(WIDTH * HEIGHT * 4, (i * 8) % 256);
+      const frame = new VideoFrame(buffer, {
+        codedWidth: WIDTH,
+        codedHeight: HEIGHT,
+        timestamp: i * 33333,
+        duration: 33333,
+      });
+      encoder.encode(frame, { keyFrame: i === 0 });
+      frame.close();
+    }
+
+    await encoder.flush();
+    encoder.close();
+
+    assert.strictEqual(chunks.length, FRAME_COUNT);
+    for (let i = 1; i < chunks.length; i++) {
+      assert.ok(chunks[i].decodeTimestamp >= chunks[i - 1].decodeTimestamp);
+    }
+    for (const chunk of chunks) {
+      assert.ok(chunk.decodeTimestamp <= chunk.timestamp);
+    }
+
+    const muxer = new Muxer({ filename: outputPath });
+    muxer.addVideoTrack({
+      codec: 'avc1.64001f',
+      width: WIDTH,
+      height: HEIGHT,
+      description: codecDescription,
+    });
+    for (const chunk of chunks) {
+      muxer.writeVideoChunk(chunk);
+    }
+    muxer.finalize();
+    muxer.close();
+
+    const demuxed: Array<{ timestamp: number; decodeTimestamp: number }> = [];
+    const demuxer = new Demuxer({
+      onTrack: () => {},
+      onChunk: (chunk) => {
+        demuxed.push({ timestamp: chunk.timestamp, decodeTimestamp: chunk.decodeTimestamp ?? 0 });
+      },
+    });
+    await demuxer.open(outputPath);
+    await demuxer.demux();
+    demuxer.close();
+
+    assert.strictEqual(demuxed.length, FRAME_COUNT);
+    for (let i = 1; i < demuxed.length; i++) {
+      assert.ok(demuxed[i].decodeTimestamp >= demuxed[i - 1].decodeTimestamp);
+    }
+    // Every frame keeps a distinct presentation time.
+    assert.strictEqual(new Set(demuxed.map((c) => c.timestamp)).size, FRAME_COUNT);
+  });
+
+  describe('streaming output (node-webcodecs extension)', () => {
+    const WIDTH = 160;
+    const HEIGHT = 120;
+    const FRAME_COUNT = 30;
+    const GOP = 10;
+
+    async function encodeChunks(): Promise<{
+      chunks: Array<{ type: string; timestamp: number; duration: number; data: Uint8Array }>;
+      description: ArrayBuffer | undefined;
+    }> {
+      const { VideoEncoder, VideoFrame } = await import('../../dist/index.js');
+      const chunks: Array<{ type: string; timestamp: number; duration: number; data: Uint8Array }> =
+        [];
+      let description: ArrayBuffer | undefined;
+      const encoder = new VideoEncoder({
+        output: (chunk, metadata) => {
+          const data = new Uint8Array(chunk.byteLength);
+          chunk.copyTo(data);
+          chunks.push({
+            type: chunk.type,
+            timestamp: chunk.timestamp,
+            duration: chunk.duration || 33333,
+            data,
+          });
+          if (metadata?.decoderConfig?.description) {
+            description = metadata.decoderConfig.description;
+          }
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({
+        codec: 'avc1.42001e',
+        width: WIDTH,
+        height: HEIGHT,
+        bitrate: 500_000,
+        framerate: 30,
+        avc: { format: 'avc' },
+      });
+      for (let i = 0; i < FRAME_COUNT; i++) {
+        const frame = new VideoFrame(Buffer.alloc(WIDTH * HEIGHT * 4, i * 8), {
+          codedWidth: WIDTH,
+          codedHeight: HEIGHT,
+          timestamp: i * 33333,
+        });
+        encoder.encode(frame, { keyFrame: i % GOP === 0 });
+        frame.close();
+      }
+      await encoder.flush();
+      encoder.close();
+      return { chunks, description };
+    }
+
+    it('should emit init segment and fragments before finalize', async () => {
+      const { Muxer, Demuxer } = await import('../../dist/index.js');
+      const { chunks, description } = await encodeChunks();
+
+      const pieces: Uint8Array[] = [];
+      let expectedOffset = 0;
+      const muxer = new Muxer({
+        format: 'fmp4',
+        onData: (data, offset) => {
+          assert.strictEqual(offset, expectedOffset);
+          expectedOffset += data.byteLength;
+          pieces.push(data);
+        },
+      });
+      muxer.addVideoTrack({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT, description });
+      for (const chunk of chunks) {
+        muxer.writeVideoChunk(chunk as any);
+      }
+      // Writes happen on the writer thread; once it has caught up, every
+      // completed GOP is already out, well before the trailer.
+      await muxer.flush();
+      assert.strictEqual(muxer.writeQueueSize, 0);
+      const beforeFinalize = pieces.length;
+      muxer.finalize();
+      muxer.close();
+
+      assert.ok(beforeFinalize >= FRAME_COUNT / GOP, `got ${beforeFinalize} pieces`);
+      const output = Buffer.concat(pieces);
+      assert.strictEqual(output.subarray(4, 8).toString('latin1'), 'ftyp');
+      assert.ok(output.includes('moof'));
+
+      let demuxed = 0;
+      const demuxer = new Demuxer({
+        onChunk: () => {
+          demuxed++;
+        },
+      });
+      await demuxer.open(output);
+      demuxer.demuxPackets(0);
+      demuxer.close();
+      assert.strictEqual(demuxed, chunks.length);
+    });
+
+    it('should reject plain mp4 without a file', async () => {
+      const { Muxer } = await import('../../dist/index.js');
+      assert.throws(() => new Muxer({ format: 'mp4', onData: () => {} }), TypeError);
+    });
+
+    it('should reject filename together with onData', async () => {
+      const { Muxer } = await import('../../dist/index.js');
+      assert.throws(
+        () => new Muxer({ filename: path.join(tempDir, 'x.mp4'), onData: () => {} }),
+        TypeError,
+      );
+    });
+  });
+
+  describe('encoder sink (node-webcodecs extension)', () => {
+    const WIDTH = 160;
+    const HEIGHT = 120;
+    const FRAME_COUNT = 30;
+
+    it('should mux encoder output without the output callback', async () => {
+      const { VideoEncoder, VideoFrame, Muxer, Demuxer } = await import('../../dist/index.js');
+
+      const outputPath = path.join(tempDir, 'sink.mp4');
+      const muxer = new Muxer({ filename: outputPath });
+      // No description: the encoder hands its extradata to the muxer.
+      const track = muxer.addVideoTrack({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT });
+
+      let outputs = 0;
+      let dequeues = 0;
+      const encoder = new VideoEncoder({
+        output: () => {
+          outputs++;
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.ondequeue = () => {
+        dequeues++;
+      };
+      encoder.configure({
+        codec: 'avc1.42001e',
+        width: WIDTH,
+        height: HEIGHT,
+        bitrate: 500_000,
+        framerate: 30,
+        avc: { format: 'avc' },
+      });
+      encoder.attachMuxer(muxer, track);
+
+      for (let i = 0; i < FRAME_COUNT; i++) {
+        const frame = new VideoFrame(Buffer.alloc(WIDTH * HEIGHT * 4, i * 8), {
+          codedWidth: WIDTH,
+          codedHeight: HEIGHT,
+          timestamp: i * 33333,
+          duration: 33333,
+        });
+        encoder.encode(frame, { keyFrame: i === 0 });
+        frame.close();
+      }
+      await encoder.flush();
+      encoder.close();
+      muxer.finalize();
+      muxer.close();
+
+      assert.strictEqual(outputs, 0);
+      assert.ok(dequeues > 0);
+      assert.strictEqual(encoder.encodeQueueSize, 0);
+
+      let demuxed = 0;
+      const demuxer = new Demuxer({
+        onChunk: () => {
+          demuxed++;
+        },
+      });
+      await demuxer.open(outputPath);
+      await demuxer.demux();
+      demuxer.close();
+      assert.strictEqual(demuxed, FRAME_COUNT);
+    });
+
+    it('should not keep the process alive when dropped unfinalized', () => {
+      // The child encodes into a Muxer, writes a chunk from JS and awaits a
+      // flush, then leaves the Muxer without finalize() or close().
+      const indexUrl = pathToFileURL(path.join(__dirname, '..', '..', 'dist', 'index.js')).href;
+      const script = `
+        const { VideoEncoder, VideoFrame, Muxer } = await import(${JSON.stringify(indexUrl)});
+        const muxer = new Muxer({ filename: ${JSON.stringify(path.join(tempDir, 'dropped.mp4'))} });
+        const track = muxer.addVideoTrack({ codec: 'avc1.42001e', width: ${WIDTH}, height: ${HEIGHT} });
+        const encoder = new VideoEncoder({ output: () => {}, error: (e) => { throw e; } });
+        encoder.configure({ codec: 'avc1.42001e', width: ${WIDTH}, height: ${HEIGHT}, bitrate: 500_000 });
+        encoder.attachMuxer(muxer, track);
+        for (let i = 0; i < 5; i++) {
+          const frame = new VideoFrame(Buffer.alloc(${WIDTH * HEIGHT * 4}), {
+            codedWidth: ${WIDTH}, codedHeight: ${HEIGHT}, timestamp: i * 33333,
+          });
+          encoder.encode(frame, { keyFrame: i === 0 });
+          frame.close();
+        }
+        await encoder.flush();
+        encoder.close();
+        muxer.writeVideoChunk({ type: 'delta', timestamp: 5 * 33333, duration: 33333, data: new Uint8Array(16) });
+        await muxer.flush();
+      `;
+      const result = spawnSync(process.execPath, ['--input-type=module', '-e', script], {
+        encoding: 'utf8',
+        timeout: 30_000,
+      });
+      assert.strictEqual(result.signal, null, 'child kept running');
+      assert.strictEqual(result.status, 0, result.stderr);
+    });
+
+    it('should reject a track of the wrong type', async () => {
+      const { VideoEncoder, Muxer } = await import('../../dist/index.js');
+      const muxer = new Muxer({ filename: path.join(tempDir, 'sink-audio.mp4') });
+      const track = muxer.addAudioTrack({ codec: 'mp4a.40.2', sampleRate: 48000, numberOfChannels: 2 });
+      const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+      assert.throws(() => encoder.attachMuxer(muxer, track), TypeError);
+      encoder.close();
+      muxer.close();
+    });
+  });
 });
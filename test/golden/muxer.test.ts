@@ -80,6 +80,420 @@ describe('Demuxer', () => {
       demuxer.close();
     });
   });
+
+  describe('chunks', () => {
+    it('should hand out Encoded*Chunk instances that stay valid after later reads', async () => {
+      const { Demuxer, EncodedAudioChunk, EncodedVideoChunk } = await import(
+        '../../dist/index.js'
+      );
+
+      const tracks = new Map<number, string>();
+      const chunks: { chunk: any; trackIndex: number }[] = [];
+      const demuxer = new Demuxer({
+        onTrack: (track) => tracks.set(track.index, track.type),
+        onChunk: (chunk, trackIndex) => chunks.push({ chunk, trackIndex }),
+      });
+      await demuxer.open(testFilePath);
+
+      demuxer.demuxPackets(8);
+      const early = chunks.map(({ chunk }) => {
+        const bytes = new Uint8Array(chunk.byteLength);
+        chunk.copyTo(bytes);
+        return bytes;
+      });
+      demuxer.demuxPackets(0);
+      demuxer.close();
+
+      for (const { chunk, trackIndex } of chunks) {
+        const expected = tracks.get(trackIndex) === 'audio' ? EncodedAudioChunk : EncodedVideoChunk;
+        assert.ok(chunk instanceof expected);
+        assert.ok(chunk.byteLength > 0);
+      }
+
+      // Chunks own their packets; later reads must not overwrite them.
+      for (let i = 0; i < early.length; i++) {
+        const bytes = new Uint8Array(chunks[i].chunk.byteLength);
+        chunks[i].chunk.copyTo(bytes);
+        assert.deepStrictEqual(bytes, early[i]);
+      }
+    });
+  });
+
+  describe('selectTracks (node-webcodecs extension)', () => {
+    async function demuxTracks(select?: (tracks: { index: number; type: string }[]) => number[]) {
+      const { Demuxer } = await import('../../dist/index.js');
+      const tracks: { index: number; type: string }[] = [];
+      const counts = new Map<number, number>();
+      const demuxer = new Demuxer({
+        onTrack: (track) => tracks.push(track),
+        onChunk: (_chunk, trackIndex) => counts.set(trackIndex, (counts.get(trackIndex) ?? 0) + 1),
+      });
+      await demuxer.open(testFilePath);
+      if (select) {
+        demuxer.selectTracks(select(tracks));
+      }
+      await demuxer.demux();
+      demuxer.close();
+      return { tracks, counts };
+    }
+
+    it('should deliver one video and one audio track by default', async () => {
+      const { tracks, counts } = await demuxTracks();
+      const types = [...counts.keys()].map((index) => tracks.find((t) => t.index === index)?.type);
+      assert.deepStrictEqual(types.sort(), ['audio', 'video']);
+    });
+
+    it('should deliver only the selected tracks', async () => {
+      const all = await demuxTracks();
+      const { tracks, counts } = await demuxTracks((tracks) =>
+        tracks.filter((t) => t.type === 'audio').map((t) => t.index),
+      );
+      const audio = tracks.find((t) => t.type === 'audio');
+      assert.ok(audio);
+      assert.deepStrictEqual([...counts.keys()], [audio.index]);
+      assert.strictEqual(counts.get(audio.index), all.counts.get(audio.index));
+    });
+
+    it('should deliver nothing for an empty selection', async () => {
+      const { counts } = await demuxTracks(() => []);
+      assert.strictEqual(counts.size, 0);
+    });
+
+    it('should reject unknown tracks', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+      const demuxer = new Demuxer({});
+      assert.throws(() => demuxer.selectTracks([0]), /InvalidStateError/);
+      await demuxer.open(testFilePath);
+      assert.throws(() => demuxer.selectTracks([99]), RangeError);
+      demuxer.close();
+    });
+  });
+
+  describe('demuxAsync (node-webcodecs extension)', () => {
+    async function collectSync(): Promise<string[]> {
+      const { Demuxer } = await import('../../dist/index.js');
+      const seen: string[] = [];
+      const demuxer = new Demuxer({
+        onChunk: (chunk, trackIndex) => {
+          seen.push(`${trackIndex}:${chunk.timestamp}:${chunk.byteLength}`);
+        },
+      });
+      await demuxer.open(testFilePath);
+      demuxer.demuxPackets(0);
+      demuxer.close();
+      return seen;
+    }
+
+    it('should deliver the same chunks in the same order as demuxPackets', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+      const expected = await collectSync();
+
+      const seen: string[] = [];
+      const demuxer = new Demuxer({
+        onChunk: (chunk, trackIndex) => {
+          seen.push(`${trackIndex}:${chunk.timestamp}:${chunk.byteLength}`);
+        },
+      });
+      await demuxer.open(testFilePath);
+      await demuxer.demuxAsync({ highWaterMark: 4 });
+      demuxer.close();
+
+      assert.ok(expected.length > 0);
+      assert.deepStrictEqual(seen, expected);
+    });
+
+    it('should pause while the downstream decode queue is full', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+
+      class FakeDecoder extends EventTarget {
+        decodeQueueSize = 0;
+      }
+      const decoder = new FakeDecoder();
+      let delivered = 0;
+      const demuxer = new Demuxer({
+        onChunk: () => {
+          delivered++;
+          decoder.decodeQueueSize++;
+        },
+      });
+      await demuxer.open(testFilePath);
+
+      let finished = false;
+      const done = demuxer
+        .demuxAsync({ decoder, decodeQueueHighWaterMark: 3 })
+        .then(() => {
+          finished = true;
+        });
+
+      // Nothing dequeues, so delivery stalls at the high-water mark.
+      await new Promise((r) => setTimeout(r, 50));
+      assert.strictEqual(delivered, 3);
+      assert.strictEqual(finished, false);
+
+      // Drain the fake decoder until the demuxer reaches end of stream.
+      while (!finished) {
+        decoder.decodeQueueSize = 0;
+        decoder.dispatchEvent(new Event('dequeue'));
+        await new Promise((r) => setTimeout(r, 1));
+      }
+      await done;
+      demuxer.close();
+
+      assert.strictEqual(delivered, (await collectSync()).length);
+    });
+
+    it('should reject demuxPackets while reading asynchronously', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+
+      class FakeDecoder extends EventTarget {
+        decodeQueueSize = 0;
+      }
+      const decoder = new FakeDecoder();
+      const demuxer = new Demuxer({
+        onChunk: () => {
+          decoder.decodeQueueSize++;
+        },
+      });
+      await demuxer.open(testFilePath);
+
+      const done = demuxer.demuxAsync({ decoder, decodeQueueHighWaterMark: 1 });
+      assert.throws(() => demuxer.demuxPackets(1), /InvalidStateError/);
+
+      demuxer.close();
+      await assert.rejects(done, /AbortError/);
+    });
+
+    it('should reject an invalid highWaterMark', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+      const demuxer = new Demuxer({});
+      await demuxer.open(testFilePath);
+      await assert.rejects(demuxer.demuxAsync({ highWaterMark: 0 }), TypeError);
+      demuxer.close();
+    });
+  });
+
+  describe('seek (node-webcodecs extension)', () => {
+    async function firstVideoAfterSeek(
+      timestamp: number,
+      mode: 'keyframe' | 'precise',
+      index?: Uint8Array,
+    ): Promise<{ type: string; timestamp: number }> {
+      const { Demuxer } = await import('../../dist/index.js');
+      const chunks: Array<{ type: string; timestamp: number }> = [];
+      const demuxer = new Demuxer({
+        onChunk: (chunk, trackIndex) => {
+          if (trackIndex === demuxer.getVideoTrack()?.index) {
+            chunks.push({ type: chunk.type, timestamp: chunk.timestamp });
+          }
+        },
+      });
+      await demuxer.open(testFilePath);
+      if (index) {
+        demuxer.loadKeyframeIndex(index);
+      }
+      await demuxer.seek(timestamp, { mode });
+      while (chunks.length === 0) {
+        if (demuxer.demuxPackets(1) === 0) break;
+      }
+      demuxer.close();
+      assert.ok(chunks.length > 0);
+      return chunks[0];
+    }
+
+    it('should resume at a keyframe at or before the target in precise mode', async () => {
+      const first = await firstVideoAfterSeek(1_000_000, 'precise');
+      assert.strictEqual(first.type, 'key');
+      assert.ok(first.timestamp <= 1_000_000);
+    });
+
+    it('should rewind to the start', async () => {
+      const first = await firstVideoAfterSeek(0, 'keyframe');
+      assert.strictEqual(first.type, 'key');
+      assert.strictEqual(first.timestamp, 0);
+    });
+
+    it('should seek through a serialized keyframe index', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+      const demuxer = new Demuxer({});
+      await demuxer.open(testFilePath);
+      const index = await demuxer.buildKeyframeIndex();
+      demuxer.close();
+      assert.ok(index.byteLength > 24);
+
+      const withoutIndex = await firstVideoAfterSeek(1_000_000, 'precise');
+      const withIndex = await firstVideoAfterSeek(1_000_000, 'precise', index);
+      assert.deepStrictEqual(withIndex, withoutIndex);
+    });
+
+    it('should reject an index that does not match the input', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+      const demuxer = new Demuxer({});
+      await demuxer.open(testFilePath);
+      assert.throws(() => demuxer.loadKeyframeIndex(new Uint8Array(8)), /DataError/);
+      demuxer.close();
+    });
+
+    it('should reject an unknown mode', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+      const demuxer = new Demuxer({});
+      await demuxer.open(testFilePath);
+      await assert.rejects(
+        demuxer.seek(0, { mode: 'nearest' as unknown as 'keyframe' }),
+        TypeError,
+      );
+      demuxer.close();
+    });
+  });
+
+  describe('open options (node-webcodecs extension)', () => {
+    type Track = import('../../dist/index.js').TrackInfo;
+
+    async function openWith(options?: object): Promise<{ tracks: Track[]; chunks: number }> {
+      const { Demuxer } = await import('../../dist/index.js');
+      const tracks: Track[] = [];
+      let chunks = 0;
+      const demuxer = new Demuxer({
+        onTrack: (track) => tracks.push(track),
+        onChunk: () => chunks++,
+      });
+      await demuxer.open(testFilePath, options);
+      await demuxer.demux();
+      demuxer.close();
+      return { tracks, chunks };
+    }
+
+    it('should report the same tracks with tuned or skipped probing', async () => {
+      const probed = await openWith();
+      for (const options of [
+        { probeSize: 4096, analyzeDuration: 0 },
+        { trustContainerHeader: true },
+        { tracks: probed.tracks },
+        { memoryMap: true },
+      ]) {
+        const { tracks, chunks } = await openWith(options);
+        assert.deepStrictEqual(tracks, probed.tracks, JSON.stringify(Object.keys(options)));
+        assert.strictEqual(chunks, probed.chunks);
+      }
+    });
+
+    it('should probe when cached tracks do not match the input', async () => {
+      const probed = await openWith();
+      const wrong = probed.tracks.map((track) => ({ ...track, codec: 'vp9' }));
+      const { tracks } = await openWith({ tracks: wrong });
+      assert.deepStrictEqual(tracks, probed.tracks);
+    });
+
+    it('should report why a memory-mapped path cannot be opened', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+      const demuxer = new Demuxer({});
+      await assert.rejects(
+        demuxer.open(`${testFilePath}.missing`, { memoryMap: true }),
+        /Failed to map/,
+      );
+      demuxer.close();
+    });
+
+    it('should reject invalid probe limits', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+      const demuxer = new Demuxer({});
+      await assert.rejects(demuxer.open(testFilePath, { probeSize: 8 }), RangeError);
+      await assert.rejects(demuxer.open(testFilePath, { analyzeDuration: -1 }), RangeError);
+      demuxer.close();
+    });
+  });
+
+  describe('custom input (node-webcodecs extension)', () => {
+    type DemuxerInstance = import('../../dist/index.js').Demuxer;
+
+    async function countChunks(
+      open: (demuxer: DemuxerInstance) => Promise<void>,
+      read: (demuxer: DemuxerInstance) => Promise<void>,
+    ): Promise<number> {
+      const { Demuxer } = await import('../../dist/index.js');
+      let count = 0;
+      const demuxer = new Demuxer({
+        onChunk: () => {
+          count++;
+        },
+      });
+      await open(demuxer);
+      await read(demuxer);
+      demuxer.close();
+      return count;
+    }
+
+    it('should demux an in-memory buffer synchronously', async () => {
+      const bytes = fs.readFileSync(testFilePath);
+      const expected = await countChunks(
+        (d) => d.open(testFilePath),
+        async (d) => void d.demuxPackets(0),
+      );
+      const count = await countChunks(
+        (d) => d.open(new Uint8Array(bytes)),
+        async (d) => void d.demuxPackets(0),
+      );
+      assert.ok(expected > 0);
+      assert.strictEqual(count, expected);
+    });
+
+    it('should demux a pull source serving byte ranges', async () => {
+      const bytes = fs.readFileSync(testFilePath);
+      const offsets: number[] = [];
+      const source = {
+        size: bytes.byteLength,
+        read: async (offset: number, length: number) => {
+          offsets.push(offset);
+          return bytes.subarray(offset, offset + length);
+        },
+      };
+      const expected = await countChunks(
+        (d) => d.open(testFilePath),
+        async (d) => void d.demuxPackets(0),
+      );
+      const count = await countChunks(
+        (d) => d.open(source),
+        (d) => d.demuxAsync(),
+      );
+      assert.strictEqual(count, expected);
+      assert.ok(offsets.length > 0);
+    });
+
+    it('should demux a readable stream', async () => {
+      const expected = await countChunks(
+        (d) => d.open(testFilePath),
+        async (d) => void d.demuxPackets(0),
+      );
+      const count = await countChunks(
+        (d) => d.open(fs.createReadStream(testFilePath, { highWaterMark: 4096 })),
+        (d) => d.demux(),
+      );
+      assert.strictEqual(count, expected);
+    });
+
+    it('should reject demuxPackets on a streaming source', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+      const bytes = fs.readFileSync(testFilePath);
+      const demuxer = new Demuxer({});
+      await demuxer.open({ read: (offset, length) => bytes.subarray(offset, offset + length) });
+      assert.throws(() => demuxer.demuxPackets(1), /InvalidStateError/);
+      demuxer.close();
+    });
+
+    it('should reject when the pull source fails', async () => {
+      const { Demuxer } = await import('../../dist/index.js');
+      const errors: Error[] = [];
+      const demuxer = new Demuxer({ onError: (e) => errors.push(e) });
+      await assert.rejects(
+        demuxer.open({
+          read: () => {
+            throw new Error('network down');
+          },
+        }),
+      );
+      assert.strictEqual(errors[0]?.message, 'network down');
+      demuxer.close();
+    });
+  });
 });
 
 describe('Muxer', () => {
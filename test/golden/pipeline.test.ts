@@ -0,0 +1,195 @@
+// test/golden/pipeline.test.ts
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+import * as assert from 'node:assert/strict';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import { after, before, describe, it } from 'node:test';
+
+const WIDTH = 160;
+const HEIGHT = 120;
+const FRAME_COUNT = 30;
+
+describe('Pipeline (node-webcodecs extension)', () => {
+  let tempDir: string;
+  let sourcePath: string;
+
+  before(async () => {
+    const { VideoEncoder, VideoFrame, Muxer } = await import('../../dist/index.js');
+    tempDir = fs.mkdtempSync(path.join(os.tmpdir(), 'pipeline-'));
+    sourcePath = path.join(tempDir, 'source.mp4');
+
+    const muxer = new Muxer({ filename: sourcePath });
+    const track = muxer.addVideoTrack({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT });
+    const encoder = new VideoEncoder({
+      output: () => {},
+      error: (e) => {
+        throw e;
+      },
+    });
+    encoder.configure({
+      codec: 'avc1.42001e',
+      width: WIDTH,
+      height: HEIGHT,
+      bitrate: 500_000,
+      framerate: 30,
+      avc: { format: 'avc' },
+    });
+    encoder.attachMuxer(muxer, track);
+    for (let i = 0; i < FRAME_COUNT; i++) {
+      const frame = new VideoFrame(Buffer.alloc(WIDTH * HEIGHT * 4, i * 8), {
+        codedWidth: WIDTH,
+        codedHeight: HEIGHT,
+        timestamp: i * 33333,
+        duration: 33333,
+      });
+      encoder.encode(frame, { keyFrame: i === 0 });
+      frame.close();
+    }
+    await encoder.flush();
+    encoder.close();
+    muxer.finalize();
+    muxer.close();
+  });
+
+  after(() => {
+    fs.rmSync(tempDir, { recursive: true, force: true });
+  });
+
+  it('should transcode a file into a Muxer track', async () => {
+    const { Pipeline, Muxer, Demuxer } = await import('../../dist/index.js');
+
+    const outputPath = path.join(tempDir, 'scaled.mp4');
+    const muxer = new Muxer({ filename: outputPath });
+    const trackIndex = muxer.addVideoTrack({ codec: 'avc1.42001e', width: 80, height: 60 });
+    let progressed = 0;
+    const pipeline = new Pipeline({
+      input: sourcePath,
+      muxer,
+      trackIndex,
+      video: { codec: 'avc1.42001e', width: 80, height: 60, bitrate: 200_000 },
+      maxQueuedFrames: 2,
+      onProgress: (progress) => {
+        assert.ok(progress.packetsWritten >= progressed);
+        progressed = progress.packetsWritten;
+      },
+    });
+    assert.strictEqual(pipeline.state, 'idle');
+
+    const run = pipeline.run();
+    assert.strictEqual(pipeline.state, 'running');
+    const stats = await run;
+    muxer.finalize();
+    muxer.close();
+
+    assert.strictEqual(pipeline.state, 'done');
+    assert.strictEqual(stats.packetsRead, FRAME_COUNT);
+    assert.strictEqual(stats.framesDecoded, FRAME_COUNT);
+    assert.strictEqual(stats.packetsWritten, FRAME_COUNT);
+    assert.ok(stats.elapsedMs >= 0);
+    assert.ok(progressed <= stats.packetsWritten);
+
+    const tracks: Array<{ width: number; height: number }> = [];
+    let demuxed = 0;
+    const demuxer = new Demuxer({
+      onTrack: (track) => {
+        tracks.push(track);
+      },
+      onChunk: () => {
+        demuxed++;
+      },
+    });
+    await demuxer.open(outputPath);
+    await demuxer.demux();
+    demuxer.close();
+    assert.strictEqual(demuxed, FRAME_COUNT);
+    assert.strictEqual(tracks[0].width, 80);
+    assert.strictEqual(tracks[0].height, 60);
+  });
+
+  it('should read its input from memory', async () => {
+    const { Pipeline, Muxer } = await import('../../dist/index.js');
+
+    const muxer = new Muxer({ filename: path.join(tempDir, 'memory.mp4') });
+    const trackIndex = muxer.addVideoTrack({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT });
+    const pipeline = new Pipeline({
+      input: fs.readFileSync(sourcePath),
+      muxer,
+      trackIndex,
+      video: { codec: 'avc1.42001e' },
+    });
+    const stats = await pipeline.run();
+    muxer.finalize();
+    muxer.close();
+    assert.strictEqual(stats.packetsWritten, FRAME_COUNT);
+  });
+
+  it('should reject with AbortError when cancelled', async () => {
+    const { Pipeline, Muxer } = await import('../../dist/index.js');
+
+    const muxer = new Muxer({ filename: path.join(tempDir, 'cancelled.mp4') });
+    const trackIndex = muxer.addVideoTrack({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT });
+    const pipeline = new Pipeline({
+      input: sourcePath,
+      muxer,
+      trackIndex,
+      video: { codec: 'avc1.42001e' },
+    });
+    const run = pipeline.run();
+    pipeline.cancel();
+    await assert.rejects(run, /AbortError/);
+    muxer.close();
+  });
+
+  it('should reject a missing input', async () => {
+    const { Pipeline, Muxer } = await import('../../dist/index.js');
+
+    const muxer = new Muxer({ filename: path.join(tempDir, 'missing.mp4') });
+    const trackIndex = muxer.addVideoTrack({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT });
+    const pipeline = new Pipeline({
+      input: path.join(tempDir, 'does-not-exist.mp4'),
+      muxer,
+      trackIndex,
+      video: { codec: 'avc1.42001e' },
+    });
+    await assert.rejects(pipeline.run(), /open file/);
+    await assert.rejects(pipeline.run(), /InvalidStateError/);
+    muxer.close();
+  });
+
+  it('should require a video track', async () => {
+    const { Pipeline, Muxer } = await import('../../dist/index.js');
+
+    const muxer = new Muxer({ filename: path.join(tempDir, 'audio-only.mp4') });
+    const trackIndex = muxer.addAudioTrack({
+      codec: 'mp4a.40.2',
+      sampleRate: 48000,
+      numberOfChannels: 2,
+    });
+    assert.throws(
+      () =>
+        new Pipeline({ input: sourcePath, muxer, trackIndex, video: { codec: 'avc1.42001e' } }),
+      TypeError,
+    );
+    muxer.close();
+  });
+
+  it('should reject queue limits beyond its stage queues', async () => {
+    const { Pipeline, Muxer } = await import('../../dist/index.js');
+
+    const muxer = new Muxer({ filename: path.join(tempDir, 'limits.mp4') });
+    const trackIndex = muxer.addVideoTrack({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT });
+    const video = { codec: 'avc1.42001e' };
+    assert.throws(
+      () => new Pipeline({ input: sourcePath, muxer, trackIndex, video, maxQueuedFrames: 4096 }),
+      /maxQueuedFrames/,
+    );
+    assert.throws(
+      () => new Pipeline({ input: sourcePath, muxer, trackIndex, video, maxQueuedPackets: 0 }),
+      /maxQueuedPackets/,
+    );
+    muxer.close();
+  });
+});
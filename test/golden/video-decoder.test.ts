@@ -6,6 +6,49 @@ import * as assert from 'node:assert/strict';
 import { after, before, describe, it } from 'node:test';
 import { expectDOMException, expectDOMExceptionAsync, TEST_CONSTANTS } from '../fixtures/test-helpers';
 
+/** Encode a single mid-gray H.264 keyframe for decode tests. */
+async function encodeGrayKeyFrame(width: number, height: number): Promise<EncodedVideoChunk[]> {
+  const encodedChunks: EncodedVideoChunk[] = [];
+  const encoder = new VideoEncoder({
+    output: (chunk) => {
+      const data = new Uint8Array(chunk.byteLength);
+      chunk.copyTo(data);
+      encodedChunks.push(
+        new EncodedVideoChunk({
+          type: chunk.type,
+          timestamp: chunk.timestamp,
+          duration: chunk.duration ?? undefined,
+          data: data,
+        }),
+      );
+    },
+    error: (e) => {
+      throw e;
+    },
+  });
+
+  encoder.configure({
+    codec: 'avc1.42001e',
+    width,
+    height,
+    bitrate: 500_000,
+    framerate: 30,
+  });
+
+  const frameData = new Uint8Array(width * height * TEST_CONSTANTS.RGBA_BPP).fill(128);
+  const frame = new VideoFrame(frameData, {
+    format: 'RGBA',
+    codedWidth: width,
+    codedHeight: height,
+    timestamp: 0,
+  });
+  encoder.encode(frame, { keyFrame: true });
+  await encoder.flush();
+  frame.close();
+  encoder.close();
+  return encodedChunks;
+}
+
 describe('VideoDecoder', () => {
   describe('VideoDecoderConfig validation', () => {
     it('should throw TypeError for invalid rotation value', () => {
@@ -387,6 +430,75 @@ describe('VideoDecoder', () => {
     });
   });
 
+  describe('outputFormat', () => {
+    it('should throw TypeError for invalid outputFormat value', () => {
+      const decoder = new VideoDecoder({
+        output: () => {},
+        error: () => {},
+      });
+
+      assert.throws(
+        () =>
+          decoder.configure({
+            codec: 'avc1.42E01E',
+            outputFormat: 'YUV' as any,
+          }),
+        TypeError,
+      );
+
+      decoder.close();
+    });
+
+    it('should emit frames in the decoder native format', async () => {
+      const { width, height } = TEST_CONSTANTS.MEDIUM_FRAME;
+      const encodedChunks = await encodeGrayKeyFrame(width, height);
+
+      const outputFrames: VideoFrame[] = [];
+      const decoder = new VideoDecoder({
+        output: (outputFrame) => {
+          outputFrames.push(outputFrame);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+
+      decoder.configure({
+        codec: 'avc1.42001e',
+        codedWidth: width,
+        codedHeight: height,
+        outputFormat: 'native',
+      });
+      decoder.decode(encodedChunks[0]);
+      await decoder.flush();
+      decoder.close();
+
+      assert.ok(outputFrames.length > 0);
+      const output = outputFrames[0];
+      // H.264 baseline decodes to 8-bit 4:2:0.
+      assert.strictEqual(output.format, 'I420');
+      assert.strictEqual(output.allocationSize(), (width * height * 3) / 2);
+
+      // Clones share the decoded planes and stay readable after the source
+      // frame is closed.
+      const clone = output.clone();
+      outputFrames.forEach((f) => f.close());
+      const pixels = new Uint8Array(clone.allocationSize());
+      await clone.copyTo(pixels);
+      assert.ok(Math.abs(pixels[0] - 128) < 16, `unexpected luma ${pixels[0]}`);
+      clone.close();
+    });
+
+    it('should include outputFormat in isConfigSupported result', async () => {
+      const result = await VideoDecoder.isConfigSupported({
+        codec: 'avc1.42001e',
+        outputFormat: 'native',
+      });
+      assert.strictEqual(result.supported, true);
+      assert.strictEqual(result.config.outputFormat, 'native');
+    });
+  });
+
   describe('optimizeForLatency', () => {
     it('should accept optimizeForLatency config option', async () => {
       const decoder = new VideoDecoder({
@@ -444,6 +556,38 @@ describe('VideoDecoder', () => {
       assert.strictEqual(result.config.hardwareAcceleration, 'prefer-hardware');
     });
 
+    it('should decode with prefer-hardware, falling back to software', async () => {
+      const { width, height } = TEST_CONSTANTS.MEDIUM_FRAME;
+      const encodedChunks = await encodeGrayKeyFrame(width, height);
+
+      const outputFrames: VideoFrame[] = [];
+      const decoder = new VideoDecoder({
+        output: (outputFrame) => {
+          outputFrames.push(outputFrame);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      decoder.configure({
+        codec: 'avc1.42001e',
+        hardwareAcceleration: 'prefer-hardware',
+        outputFormat: 'native',
+      });
+      decoder.decode(encodedChunks[0]);
+      await decoder.flush();
+      decoder.close();
+
+      assert.strictEqual(outputFrames.length, 1);
+      const frame = outputFrames[0];
+      assert.strictEqual(frame.codedWidth, width);
+      // Hardware surfaces are downloaded on first pixel access.
+      const pixels = new Uint8Array(frame.allocationSize());
+      await frame.copyTo(pixels);
+      assert.ok(Math.abs(pixels[0] - 128) < 16, `unexpected luma ${pixels[0]}`);
+      frame.close();
+    });
+
     it('should default to no-preference', async () => {
       const result = await VideoDecoder.isConfigSupported({
         codec: 'avc1.42001e',
@@ -1103,4 +1247,133 @@ describe('VideoDecoder', () => {
       });
     });
   });
+
+  describe('queue limits (node-webcodecs extension)', () => {
+    // 30 frames with a keyframe every 10; timestamps are frame indices
+    async function encodeClip(): Promise<EncodedVideoChunk[]> {
+      const chunks: EncodedVideoChunk[] = [];
+      const encoder = new VideoEncoder({
+        output: (chunk) => {
+          const data = new Uint8Array(chunk.byteLength);
+          chunk.copyTo(data);
+          chunks.push(new EncodedVideoChunk({ type: chunk.type, timestamp: chunk.timestamp, data }));
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({
+        codec: 'avc1.42001e',
+        width: 320,
+        height: 240,
+        bitrate: 500_000,
+        framerate: 30,
+        latencyMode: 'realtime',
+      });
+      for (let i = 0; i < 30; i++) {
+        const frame = new VideoFrame(new Uint8Array(320 * 240 * 4).fill(i * 8), {
+          format: 'RGBA',
+          codedWidth: 320,
+          codedHeight: 240,
+          timestamp: i,
+        });
+        encoder.encode(frame, { keyFrame: i % 10 === 0 });
+        frame.close();
+      }
+      await encoder.flush();
+      encoder.close();
+      return chunks;
+    }
+
+    it("should decode every chunk under 'block'", async () => {
+      const chunks = await encodeClip();
+      const timestamps: number[] = [];
+      const decoder = new VideoDecoder({
+        output: (frame) => {
+          timestamps.push(frame.timestamp);
+          frame.close();
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      decoder.configure({ codec: 'avc1.42001e', maxQueueSize: 1, queuePolicy: 'block' });
+
+      const parked = chunks
+        .map((chunk) => decoder.decode(chunk))
+        .filter((result) => result instanceof Promise);
+      await Promise.all(parked);
+      await decoder.flush();
+      decoder.close();
+
+      assert.deepStrictEqual(
+        timestamps,
+        chunks.map((chunk) => chunk.timestamp),
+      );
+    });
+
+    it("should decodeBatch() every chunk in order under 'block'", async () => {
+      const chunks = await encodeClip();
+      const timestamps: number[] = [];
+      const decoder = new VideoDecoder({
+        output: (frame) => {
+          timestamps.push(frame.timestamp);
+          frame.close();
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      decoder.configure({ codec: 'avc1.42001e', maxQueueSize: 1, queuePolicy: 'block' });
+
+      const result = decoder.decodeBatch(
+        chunks,
+        chunks.map((chunk) => ({ skipOutput: chunk.timestamp % 2 === 1 })),
+      );
+      assert.ok(result instanceof Promise, 'expected chunks to wait for queue space');
+      await result;
+      await decoder.flush();
+      decoder.close();
+
+      assert.deepStrictEqual(
+        timestamps,
+        chunks.map((chunk) => chunk.timestamp).filter((timestamp) => timestamp % 2 === 0),
+      );
+    });
+
+    it("should only drop whole delta runs under 'drop-oldest-delta'", async () => {
+      const chunks = await encodeClip();
+      const errors: DOMException[] = [];
+      const timestamps: number[] = [];
+      const decoder = new VideoDecoder({
+        output: (frame) => {
+          timestamps.push(frame.timestamp);
+          frame.close();
+        },
+        error: (e) => errors.push(e),
+      });
+      decoder.configure({
+        codec: 'avc1.42001e',
+        maxQueueSize: 1,
+        queuePolicy: 'drop-oldest-delta',
+      });
+
+      for (const chunk of chunks) {
+        assert.strictEqual(decoder.decode(chunk), undefined);
+      }
+      await decoder.flush();
+      assert.strictEqual(decoder.decodeQueueSize, 0);
+      decoder.close();
+
+      assert.deepStrictEqual(errors, []);
+      assert.ok(timestamps.length > 0);
+      // A dropped frame takes every later frame of its GOP with it, so each
+      // delta frame decoded follows the frame before it.
+      const keys = new Set(chunks.filter((c) => c.type === 'key').map((c) => c.timestamp));
+      for (let i = 1; i < timestamps.length; i++) {
+        const ts = timestamps[i];
+        assert.ok(keys.has(ts) || timestamps[i - 1] === ts - 1, `frame ${ts} decoded without its reference`);
+      }
+    });
+  });
 });
@@ -4,11 +4,8 @@ import { describe, it } from 'node:test';
 /**
  * Tests for VideoEncoder async infrastructure.
  *
- * Note: The AsyncEncodeWorker infrastructure is implemented but currently
- * disabled by default (async_mode_ = false). These tests verify that the
- * synchronous encoding path works correctly with proper queue tracking.
- *
- * When async mode is enabled in the future, these tests will validate:
+ * Encoding runs on the CodecWorker-based VideoEncoderWorker thread. These
+ * tests verify:
  * - Non-blocking encoding on the main thread
  * - Proper encodeQueueSize tracking across thread boundaries
  * - Correct flush semantics with ThreadSafeFunction callbacks
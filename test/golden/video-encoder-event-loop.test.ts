@@ -6,8 +6,8 @@ import { describe, it } from 'node:test';
  * Event loop blocking verification tests for VideoEncoder.
  *
  * These tests verify that encoding operations do not block the Node.js event loop,
- * which is a key requirement for production use. When async_mode_ is enabled in
- * the native layer, encoding runs on a worker thread via AsyncEncodeWorker.
+ * which is a key requirement for production use. In the native layer, encoding
+ * runs on a worker thread via VideoEncoderWorker.
  *
  * The test creates frames and verifies that setInterval callbacks can fire
  * during the flush() phase, proving the event loop is not blocked.
@@ -63,4 +63,42 @@ describe('VideoEncoder event loop', () => {
 
     encoder.close();
   });
+
+  it('should not wait for frames in flight on close()', async () => {
+    const { VideoEncoder, VideoFrame } = await import('../../lib/index');
+
+    let closed = false;
+    let outputsAfterClose = 0;
+    const encoder = new VideoEncoder({
+      output: () => {
+        if (closed) outputsAfterClose++;
+      },
+      error: (e) => {
+        throw e;
+      },
+    });
+    encoder.configure({ codec: 'avc1.640028', width: 1920, height: 1080, bitrate: 8_000_000 });
+
+    for (let i = 0; i < 10; i++) {
+      const frame = new VideoFrame(new Uint8Array(1920 * 1080 * 4), {
+        format: 'RGBA',
+        codedWidth: 1920,
+        codedHeight: 1080,
+        timestamp: i * 33333,
+      });
+      encoder.encode(frame);
+      frame.close();
+    }
+
+    // The worker is still encoding; close() retires it off the event loop.
+    const start = performance.now();
+    encoder.close();
+    closed = true;
+    const elapsed = performance.now() - start;
+
+    await new Promise((r) => setTimeout(r, 100));
+    assert.strictEqual(encoder.state, 'closed');
+    assert.strictEqual(outputsAfterClose, 0);
+    assert.ok(elapsed < 50, `close() took ${elapsed.toFixed(1)} ms`);
+  });
 });
@@ -85,7 +85,7 @@ describe('VideoEncoder', () => {
 
     it('should echo scalabilityMode in config', async () => {
       const result = await VideoEncoder.isConfigSupported({
-        codec: 'avc1.42E01E',
+        codec: 'vp8',
         width: 640,
         height: 480,
         scalabilityMode: 'L1T2',
@@ -94,6 +94,18 @@ describe('VideoEncoder', () => {
       assert.strictEqual(result.config.scalabilityMode, 'L1T2');
     });
 
+    it('should not support temporal layers the encoder cannot produce', async () => {
+      for (const [codec, scalabilityMode] of [
+        ['avc1.42E01E', 'L1T2'],
+        ['vp09.00.10.08', 'L2T2'],
+        ['vp8', 'L1T4'],
+      ]) {
+        const result = await VideoEncoder.isConfigSupported({ codec, width: 640, height: 480, scalabilityMode });
+        assert.strictEqual(result.supported, false, `${codec} ${scalabilityMode}`);
+        assert.strictEqual(result.config.scalabilityMode, scalabilityMode);
+      }
+    });
+
     it('should echo contentHint in config', async () => {
       const result = await VideoEncoder.isConfigSupported({
         codec: 'avc1.42E01E',
@@ -152,7 +164,7 @@ describe('VideoEncoder', () => {
         framerate: 30,
         hardwareAcceleration: 'prefer-software' as const,
         alpha: 'discard' as const,
-        scalabilityMode: 'L1T2',
+        scalabilityMode: 'L1T1',
         bitrateMode: 'variable' as const,
         latencyMode: 'quality' as const,
         contentHint: 'motion',
@@ -526,6 +538,119 @@ describe('VideoEncoder', () => {
     });
   });
 
+  describe('input pixel formats', () => {
+    for (const format of ['I420', 'NV12', 'I444'] as const) {
+      it(`should encode ${format} frames`, async () => {
+        const chunks: EncodedVideoChunk[] = [];
+        const encoder = new VideoEncoder({
+          output: (chunk) => {
+            chunks.push(chunk);
+          },
+          error: (e) => {
+            throw e;
+          },
+        });
+
+        const { width, height } = TEST_CONSTANTS.MEDIUM_FRAME;
+        encoder.configure({
+          codec: 'avc1.42E01E',
+          width,
+          height,
+          bitrate: 500_000,
+        });
+
+        const size = format === 'I444' ? width * height * 3 : (width * height * 3) / 2;
+        const frame = new VideoFrame(new Uint8Array(size).fill(128), {
+          format,
+          codedWidth: width,
+          codedHeight: height,
+          timestamp: 0,
+        });
+        encoder.encode(frame, { keyFrame: true });
+        frame.close();
+
+        await encoder.flush();
+        encoder.close();
+
+        assert.ok(chunks.length > 0);
+        assert.strictEqual(chunks[0].type, 'key');
+      });
+    }
+  });
+
+  describe('decoder to encoder transcode', () => {
+    it('should encode frames straight from a prefer-hardware decoder', async () => {
+      const { width, height } = TEST_CONSTANTS.MEDIUM_FRAME;
+
+      // Produce a key chunk to decode
+      const source: EncodedVideoChunk[] = [];
+      const sourceEncoder = new VideoEncoder({
+        output: (chunk) => {
+          source.push(chunk);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      sourceEncoder.configure({ codec: 'avc1.42E01E', width, height, bitrate: 500_000 });
+      const input = new VideoFrame(new Uint8Array((width * height * 3) / 2).fill(128), {
+        format: 'I420',
+        codedWidth: width,
+        codedHeight: height,
+        timestamp: 0,
+      });
+      sourceEncoder.encode(input, { keyFrame: true });
+      input.close();
+      await sourceEncoder.flush();
+      sourceEncoder.close();
+
+      // Decoded frames may hold GPU surfaces; the encoder consumes them
+      // directly or downloads them, so the result is the same either way.
+      const chunks: EncodedVideoChunk[] = [];
+      const encoder = new VideoEncoder({
+        output: (chunk) => {
+          chunks.push(chunk);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({
+        codec: 'avc1.42E01E',
+        width: width / 2,
+        height: height / 2,
+        bitrate: 250_000,
+        hardwareAcceleration: 'prefer-hardware',
+      });
+
+      const decoder = new VideoDecoder({
+        output: (frame) => {
+          encoder.encode(frame, { keyFrame: true });
+          frame.close();
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      decoder.configure({
+        codec: 'avc1.42E01E',
+        codedWidth: width,
+        codedHeight: height,
+        hardwareAcceleration: 'prefer-hardware',
+        outputFormat: 'native',
+      });
+      decoder.decode(source[0]);
+      await decoder.flush();
+      decoder.close();
+
+      await encoder.flush();
+      encoder.close();
+
+      assert.ok(chunks.length > 0);
+      assert.strictEqual(chunks[0].type, 'key');
+    });
+  });
+
   describe('AVC bitstream format', () => {
     it('should produce annexb bitstream with start codes when avc.format = annexb', async () => {
       const chunks: Array<{ chunk: EncodedVideoChunk; metadata?: EncodedVideoChunkMetadata }> = [];
@@ -919,7 +1044,7 @@ describe('VideoEncoder', () => {
 
       const { width, height } = TEST_CONSTANTS.MEDIUM_FRAME;
       encoder.configure({
-        codec: 'avc1.42E01E',
+        codec: 'vp8',
         width,
         height,
         scalabilityMode: 'L1T2',
@@ -967,7 +1092,7 @@ describe('VideoEncoder', () => {
 
       const { width, height } = TEST_CONSTANTS.MEDIUM_FRAME;
       encoder.configure({
-        codec: 'avc1.42E01E',
+        codec: 'vp8',
         width,
         height,
         scalabilityMode: 'L1T3',
@@ -1037,4 +1162,477 @@ describe('VideoEncoder', () => {
       assert.strictEqual(chunks.every((c) => c.layerId === 0), true);
     });
   });
+
+  describe('threading (node-webcodecs extension)', () => {
+    it('should echo threading from isConfigSupported', async () => {
+      const result = await VideoEncoder.isConfigSupported({
+        codec: 'avc1.42E01E',
+        width: 640,
+        height: 480,
+        threading: { count: 2, mode: 'slice' },
+      });
+      assert.strictEqual(result.supported, true);
+      assert.deepStrictEqual(result.config.threading, { count: 2, mode: 'slice' });
+    });
+
+    it('should report an invalid threading mode as unsupported', async () => {
+      const result = await VideoEncoder.isConfigSupported({
+        codec: 'avc1.42E01E',
+        width: 640,
+        height: 480,
+        threading: { mode: 'bogus' as 'auto' },
+      });
+      assert.strictEqual(result.supported, false);
+    });
+
+    it('should throw TypeError for an invalid threading count', () => {
+      const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+      assert.throws(
+        () =>
+          encoder.configure({
+            codec: 'avc1.42E01E',
+            width: 64,
+            height: 64,
+            threading: { count: -1 },
+          }),
+        TypeError,
+      );
+      encoder.close();
+    });
+
+    for (const mode of ['frame', 'slice', 'none'] as const) {
+      it(`should encode with threading mode '${mode}'`, async () => {
+        const chunks: EncodedVideoChunk[] = [];
+        const encoder = new VideoEncoder({
+          output: (chunk) => chunks.push(chunk),
+          error: (e) => {
+            throw e;
+          },
+        });
+
+        const { width, height } = TEST_CONSTANTS.MEDIUM_FRAME;
+        encoder.configure({
+          codec: 'avc1.42E01E',
+          width,
+          height,
+          threading: { count: 2, mode },
+        });
+
+        for (let i = 0; i < 4; i++) {
+          const frame = new VideoFrame(new Uint8Array(width * height * TEST_CONSTANTS.RGBA_BPP), {
+            format: 'RGBA',
+            codedWidth: width,
+            codedHeight: height,
+            timestamp: i * TEST_CONSTANTS.FPS_30_TIMESTAMP_DELTA,
+          });
+          encoder.encode(frame);
+          frame.close();
+        }
+
+        await encoder.flush();
+        encoder.close();
+
+        assert.strictEqual(chunks.length, 4);
+      });
+    }
+
+    it('should echo thread placement from isConfigSupported', async () => {
+      const result = await VideoEncoder.isConfigSupported({
+        codec: 'avc1.42E01E',
+        width: 640,
+        height: 480,
+        threading: { cpus: [0], priority: 'low' },
+      });
+      assert.strictEqual(result.supported, true);
+      assert.deepStrictEqual(result.config.threading, { count: 0, mode: 'auto', cpus: [0], priority: 'low' });
+    });
+
+    const invalidPlacements = [
+      ['cpus', [1 << 20]],
+      ['cpus', 0],
+      ['priority', 'urgent'],
+      ['numaNode', -1],
+    ] as const;
+    for (const [key, value] of invalidPlacements) {
+      it(`should throw TypeError for threading.${key} ${JSON.stringify(value)}`, () => {
+        const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+        assert.throws(
+          () =>
+            encoder.configure({
+              codec: 'avc1.42E01E',
+              width: 64,
+              height: 64,
+              threading: { [key]: value } as any,
+            }),
+          TypeError,
+        );
+        encoder.close();
+      });
+    }
+
+    it('should encode on a pinned, low-priority thread', async () => {
+      const chunks: EncodedVideoChunk[] = [];
+      const encoder = new VideoEncoder({
+        output: (chunk) => chunks.push(chunk),
+        error: (e) => {
+          throw e;
+        },
+      });
+
+      const { width, height } = TEST_CONSTANTS.MEDIUM_FRAME;
+      encoder.configure({
+        codec: 'avc1.42E01E',
+        width,
+        height,
+        threading: { count: 2, cpus: [0], priority: 'low' },
+      });
+
+      for (let i = 0; i < 4; i++) {
+        const frame = new VideoFrame(new Uint8Array(width * height * TEST_CONSTANTS.RGBA_BPP), {
+          format: 'RGBA',
+          codedWidth: width,
+          codedHeight: height,
+          timestamp: i * TEST_CONSTANTS.FPS_30_TIMESTAMP_DELTA,
+        });
+        encoder.encode(frame);
+        frame.close();
+      }
+
+      await encoder.flush();
+      encoder.close();
+
+      assert.strictEqual(chunks.length, 4);
+    });
+  });
+
+  describe('resizeQuality (node-webcodecs extension)', () => {
+    it('should echo resizeQuality and scalingThreads from isConfigSupported', async () => {
+      const result = await VideoEncoder.isConfigSupported({
+        codec: 'avc1.42E01E',
+        width: 640,
+        height: 480,
+        resizeQuality: 'high',
+        scalingThreads: 0,
+      });
+      assert.strictEqual(result.supported, true);
+      assert.strictEqual(result.config.resizeQuality, 'high');
+      assert.strictEqual(result.config.scalingThreads, 0);
+    });
+
+    it('should throw TypeError for an invalid resizeQuality', () => {
+      const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+      assert.throws(
+        () =>
+          encoder.configure({
+            codec: 'avc1.42E01E',
+            width: 64,
+            height: 64,
+            resizeQuality: 'bogus' as 'low',
+          }),
+        TypeError,
+      );
+      encoder.close();
+    });
+
+    for (const resizeQuality of ['pixelated', 'low', 'high'] as const) {
+      it(`should scale input with resizeQuality '${resizeQuality}'`, async () => {
+        const chunks: EncodedVideoChunk[] = [];
+        const encoder = new VideoEncoder({
+          output: (chunk) => chunks.push(chunk),
+          error: (e) => {
+            throw e;
+          },
+        });
+        encoder.configure({
+          codec: 'avc1.42E01E',
+          width: 64,
+          height: 48,
+          resizeQuality,
+          scalingThreads: 2,
+        });
+
+        // Input is larger than the codec size, so every frame is converted
+        for (let i = 0; i < 3; i++) {
+          const frame = new VideoFrame(new Uint8Array(128 * 96 * TEST_CONSTANTS.RGBA_BPP), {
+            format: 'RGBA',
+            codedWidth: 128,
+            codedHeight: 96,
+            timestamp: i * TEST_CONSTANTS.FPS_30_TIMESTAMP_DELTA,
+          });
+          encoder.encode(frame);
+          frame.close();
+        }
+
+        await encoder.flush();
+        encoder.close();
+
+        assert.strictEqual(chunks.length, 3);
+      });
+    }
+  });
+
+  describe('outputBatchSize (node-webcodecs extension)', () => {
+    it('should echo outputBatchSize from isConfigSupported', async () => {
+      const result = await VideoEncoder.isConfigSupported({
+        codec: 'avc1.42E01E',
+        width: 640,
+        height: 480,
+        outputBatchSize: 16,
+      });
+      assert.strictEqual(result.supported, true);
+      assert.strictEqual(result.config.outputBatchSize, 16);
+    });
+
+    for (const outputBatchSize of [0, 1.5, 4096]) {
+      it(`should throw TypeError for outputBatchSize ${outputBatchSize}`, () => {
+        const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+        assert.throws(
+          () =>
+            encoder.configure({
+              codec: 'avc1.42E01E',
+              width: 64,
+              height: 64,
+              outputBatchSize,
+            }),
+          TypeError,
+        );
+        encoder.close();
+      });
+    }
+
+    it('should deliver every chunk in order when outputs pile up', async () => {
+      const timestamps: number[] = [];
+      const encoder = new VideoEncoder({
+        output: (chunk) => timestamps.push(chunk.timestamp),
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({
+        codec: 'avc1.42E01E',
+        width: 64,
+        height: 64,
+        bitrate: 200_000,
+        framerate: 30,
+        outputBatchSize: 8,
+      });
+
+      const frameCount = 20;
+      for (let i = 0; i < frameCount; i++) {
+        const frame = new VideoFrame(new Uint8Array(64 * 64 * TEST_CONSTANTS.RGBA_BPP).fill(i), {
+          format: 'RGBA',
+          codedWidth: 64,
+          codedHeight: 64,
+          timestamp: i * TEST_CONSTANTS.FPS_30_TIMESTAMP_DELTA,
+        });
+        encoder.encode(frame);
+        frame.close();
+      }
+
+      // Keep the main thread busy so the worker queues several outputs.
+      const busyUntil = Date.now() + 100;
+      while (Date.now() < busyUntil) {
+        // spin
+      }
+
+      await encoder.flush();
+      encoder.close();
+
+      assert.deepStrictEqual(
+        timestamps,
+        Array.from({ length: frameCount }, (_, i) => i * TEST_CONSTANTS.FPS_30_TIMESTAMP_DELTA),
+      );
+    });
+  });
+
+  describe('queue limits (node-webcodecs extension)', () => {
+    const config = {
+      codec: 'avc1.42E01E',
+      width: 640,
+      height: 480,
+      bitrate: 1_000_000,
+      framerate: 30,
+    };
+
+    function makeFrame(i: number): VideoFrame {
+      return new VideoFrame(new Uint8Array(640 * 480 * TEST_CONSTANTS.RGBA_BPP).fill(i), {
+        format: 'RGBA',
+        codedWidth: 640,
+        codedHeight: 480,
+        timestamp: i * TEST_CONSTANTS.FPS_30_TIMESTAMP_DELTA,
+      });
+    }
+
+    it('should echo queue limits from isConfigSupported', async () => {
+      const result = await VideoEncoder.isConfigSupported({
+        ...config,
+        maxQueueSize: 4,
+        maxQueueBytes: 8_000_000,
+        queuePolicy: 'block',
+      });
+      assert.strictEqual(result.supported, true);
+      assert.strictEqual(result.config.maxQueueSize, 4);
+      assert.strictEqual(result.config.maxQueueBytes, 8_000_000);
+      assert.strictEqual(result.config.queuePolicy, 'block');
+    });
+
+    const invalid = [
+      ['maxQueueSize', 0],
+      ['maxQueueSize', 2.5],
+      ['maxQueueBytes', -1],
+      ['queuePolicy', 'wait'],
+    ] as const;
+    for (const [key, value] of invalid) {
+      it(`should throw TypeError for ${key} ${value}`, () => {
+        const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+        assert.throws(() => encoder.configure({ ...config, [key]: value } as any), TypeError);
+        encoder.close();
+      });
+    }
+
+    it("should throw QuotaExceededError under 'reject'", () => {
+      const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+      encoder.configure({ ...config, maxQueueSize: 1 });
+
+      const frame = makeFrame(0);
+      let error: unknown;
+      for (let i = 0; i < 200 && !error; i++) {
+        try {
+          encoder.encode(frame);
+        } catch (e) {
+          error = e;
+        }
+      }
+      frame.close();
+      encoder.close();
+
+      assert.match(String(error), /QuotaExceededError/);
+    });
+
+    it("should park encode() calls under 'block' and keep their order", async () => {
+      const timestamps: number[] = [];
+      const encoder = new VideoEncoder({
+        output: (chunk) => timestamps.push(chunk.timestamp),
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({ ...config, maxQueueSize: 1, queuePolicy: 'block' });
+
+      const frameCount = 30;
+      const parked: Promise<void>[] = [];
+      for (let i = 0; i < frameCount; i++) {
+        const frame = makeFrame(i);
+        const result = encoder.encode(frame);
+        frame.close(); // The parked call holds its own reference
+        if (result instanceof Promise) {
+          parked.push(result);
+        }
+      }
+      assert.ok(parked.length > 0, 'expected some encode() calls to wait for queue space');
+
+      await Promise.all(parked);
+      await encoder.flush();
+      encoder.close();
+
+      assert.deepStrictEqual(
+        timestamps,
+        Array.from({ length: frameCount }, (_, i) => i * TEST_CONSTANTS.FPS_30_TIMESTAMP_DELTA),
+      );
+    });
+
+    it('should reject parked encode() calls on reset', async () => {
+      const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+      encoder.configure({ ...config, maxQueueSize: 1, queuePolicy: 'block' });
+
+      const parked: Promise<void>[] = [];
+      for (let i = 0; i < 30 && parked.length === 0; i++) {
+        const frame = makeFrame(i);
+        const result = encoder.encode(frame);
+        frame.close();
+        if (result instanceof Promise) {
+          parked.push(result);
+        }
+      }
+      assert.strictEqual(parked.length, 1);
+
+      encoder.reset();
+      await assert.rejects(parked[0], { name: 'AbortError' });
+      assert.strictEqual(encoder.encodeQueueSize, 0);
+      encoder.close();
+    });
+
+    it("should drop frames in order under 'drop-oldest-delta'", async () => {
+      const timestamps: number[] = [];
+      const types: string[] = [];
+      const encoder = new VideoEncoder({
+        output: (chunk) => {
+          timestamps.push(chunk.timestamp);
+          types.push(chunk.type);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({ ...config, maxQueueSize: 1, queuePolicy: 'drop-oldest-delta' });
+
+      const frameCount = 60;
+      for (let i = 0; i < frameCount; i++) {
+        const frame = makeFrame(i);
+        const result = encoder.encode(frame, { keyFrame: i === 0 });
+        frame.close();
+        assert.strictEqual(result, undefined);
+      }
+      await encoder.flush();
+
+      assert.strictEqual(encoder.encodeQueueSize, 0);
+      encoder.close();
+
+      assert.ok(timestamps.length > 0 && timestamps.length <= frameCount);
+      assert.strictEqual(types[0], 'key'); // Dropping never loses the keyframe request
+      for (let i = 1; i < timestamps.length; i++) {
+        assert.ok(timestamps[i] > timestamps[i - 1]);
+      }
+    });
+
+    for (const queuePolicy of ['reject', 'block'] as const) {
+      it(`should encodeBatch() every frame in order under '${queuePolicy}'`, async () => {
+        const timestamps: number[] = [];
+        const types: string[] = [];
+        const encoder = new VideoEncoder({
+          output: (chunk) => {
+            timestamps.push(chunk.timestamp);
+            types.push(chunk.type);
+          },
+          error: (e) => {
+            throw e;
+          },
+        });
+        const limits = queuePolicy === 'block' ? { maxQueueSize: 1 } : {};
+        encoder.configure({ ...config, ...limits, queuePolicy });
+
+        const frameCount = 30;
+        const frames = Array.from({ length: frameCount }, (_, i) => makeFrame(i));
+        const result = encoder.encodeBatch(
+          frames,
+          frames.map((_, i) => (i === 15 ? { keyFrame: true } : undefined)),
+        );
+        for (const frame of frames) {
+          frame.close(); // Parked frames hold their own reference
+        }
+        if (queuePolicy === 'block') {
+          assert.ok(result instanceof Promise, 'expected frames to wait for queue space');
+        }
+        await result;
+        await encoder.flush();
+        encoder.close();
+
+        assert.deepStrictEqual(
+          timestamps,
+          Array.from({ length: frameCount }, (_, i) => i * TEST_CONSTANTS.FPS_30_TIMESTAMP_DELTA),
+        );
+        assert.strictEqual(types[15], 'key');
+      });
+    }
+  });
 });
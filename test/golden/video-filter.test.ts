@@ -0,0 +1,280 @@
+// test/golden/video-filter.test.ts
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+import { VideoFilter, VideoFrame } from '../../lib';
+
+const WIDTH = 64;
+const HEIGHT = 64;
+
+// Vertical stripes so a blur visibly changes pixel values.
+function createStripedRGBA(): Uint8Array {
+  const data = new Uint8Array(WIDTH * HEIGHT * 4);
+  for (let y = 0; y < HEIGHT; y++) {
+    for (let x = 0; x < WIDTH; x++) {
+      const i = (y * WIDTH + x) * 4;
+      const v = x % 2 === 0 ? 255 : 0;
+      data[i] = v;
+      data[i + 1] = v;
+      data[i + 2] = v;
+      data[i + 3] = 255;
+    }
+  }
+  return data;
+}
+
+async function readPixels(frame: VideoFrame): Promise<Uint8Array> {
+  const data = new Uint8Array(frame.allocationSize());
+  await frame.copyTo(data);
+  return data;
+}
+
+function rgbaAt(data: Uint8Array, x: number, y: number): number[] {
+  const i = (y * WIDTH + x) * 4;
+  return Array.from(data.subarray(i, i + 4));
+}
+
+describe('VideoFilter', () => {
+  it('blurs only the requested region and keeps the input format', async () => {
+    const filter = new VideoFilter({ width: WIDTH, height: HEIGHT });
+    filter.configure({ width: WIDTH, height: HEIGHT });
+    const input = new VideoFrame(createStripedRGBA(), {
+      format: 'RGBA',
+      codedWidth: WIDTH,
+      codedHeight: HEIGHT,
+      timestamp: 1234,
+    });
+
+    const output = filter.applyBlur(input, [{ x: 16, y: 16, width: 16, height: 16 }]);
+    assert.strictEqual(output.format, 'RGBA');
+    assert.strictEqual(output.codedWidth, WIDTH);
+    assert.strictEqual(output.codedHeight, HEIGHT);
+    assert.strictEqual(output.timestamp, 1234);
+
+    const pixels = await readPixels(output);
+    assert.deepStrictEqual(rgbaAt(pixels, 2, 2), [255, 255, 255, 255]);
+    assert.deepStrictEqual(rgbaAt(pixels, 3, 2), [0, 0, 0, 255]);
+    const blurred = rgbaAt(pixels, 24, 24)[0];
+    assert.ok(blurred > 0 && blurred < 255, `expected a blurred value, got ${blurred}`);
+
+    output.close();
+    input.close();
+    filter.close();
+  });
+
+  it('follows moving regions across calls', async () => {
+    const filter = new VideoFilter({ width: WIDTH, height: HEIGHT });
+    filter.configure({ width: WIDTH, height: HEIGHT });
+    const input = new VideoFrame(createStripedRGBA(), {
+      format: 'RGBA',
+      codedWidth: WIDTH,
+      codedHeight: HEIGHT,
+      timestamp: 0,
+    });
+
+    for (let step = 0; step < 4; step++) {
+      const x = step * 12;
+      const output = filter.applyBlur(input, [
+        { x, y: 0, width: 12, height: 12 },
+        { x, y: 40, width: 12, height: 12 },
+      ]);
+      const pixels = await readPixels(output);
+      const inside = rgbaAt(pixels, x + 6, 6)[0];
+      assert.ok(inside > 0 && inside < 255, `step ${step}: region not blurred`);
+      // The previous position must be back to the original stripes.
+      if (step > 0) {
+        assert.deepStrictEqual(rgbaAt(pixels, x - 6, 6), [255, 255, 255, 255]);
+      }
+      output.close();
+    }
+
+    input.close();
+    filter.close();
+  });
+
+  it('filters I420 frames without converting them', async () => {
+    const filter = new VideoFilter({ width: WIDTH, height: HEIGHT });
+    filter.configure({ width: WIDTH, height: HEIGHT });
+    const ySize = WIDTH * HEIGHT;
+    const data = new Uint8Array(ySize * 1.5).fill(128);
+    for (let y = 0; y < HEIGHT; y++) {
+      for (let x = 0; x < WIDTH; x++) {
+        data[y * WIDTH + x] = x % 2 === 0 ? 235 : 16;
+      }
+    }
+    const input = new VideoFrame(data, {
+      format: 'I420',
+      codedWidth: WIDTH,
+      codedHeight: HEIGHT,
+      timestamp: 0,
+    });
+
+    const output = filter.applyBlur(input, [{ x: 0, y: 0, width: 32, height: 32 }]);
+    assert.strictEqual(output.format, 'I420');
+    const pixels = await readPixels(output);
+    assert.strictEqual(pixels.length, data.length);
+    assert.strictEqual(pixels[48 * WIDTH + 48], 235);
+    assert.strictEqual(pixels[48 * WIDTH + 49], 16);
+    const blurred = pixels[8 * WIDTH + 8];
+    assert.ok(blurred > 16 && blurred < 235, `expected a blurred luma, got ${blurred}`);
+
+    output.close();
+    input.close();
+    filter.close();
+  });
+
+  it('returns the frame unchanged when no region is inside it', async () => {
+    const filter = new VideoFilter({ width: WIDTH, height: HEIGHT });
+    filter.configure({ width: WIDTH, height: HEIGHT });
+    const source = createStripedRGBA();
+    const input = new VideoFrame(source, {
+      format: 'RGBA',
+      codedWidth: WIDTH,
+      codedHeight: HEIGHT,
+      timestamp: 0,
+    });
+
+    const output = filter.applyBlur(input, [{ x: 0, y: 0, width: 0, height: 0 }]);
+    assert.deepStrictEqual(await readPixels(output), source);
+
+    output.close();
+    input.close();
+    filter.close();
+  });
+
+  describe('configureGraph', () => {
+    function solidRGBA(width: number, height: number, rgba: number[], timestamp = 0): VideoFrame {
+      const data = new Uint8Array(width * height * 4);
+      for (let i = 0; i < data.length; i += 4) {
+        data.set(rgba, i);
+      }
+      return new VideoFrame(data, {
+        format: 'RGBA',
+        codedWidth: width,
+        codedHeight: height,
+        timestamp,
+      });
+    }
+
+    it('scales a frame with an unlabelled single-input graph', async () => {
+      const filter = new VideoFilter({ width: WIDTH, height: HEIGHT });
+      filter.configureGraph({
+        graph: 'scale=32:16',
+        inputs: [{ width: WIDTH, height: HEIGHT, format: 'RGBA' }],
+      });
+      const input = solidRGBA(WIDTH, HEIGHT, [255, 0, 0, 255], 5000);
+
+      const [outputs] = await filter.process(input);
+      input.close();
+      assert.strictEqual(outputs.length, 1);
+      const output = outputs[0];
+      assert.strictEqual(output.format, 'RGBA');
+      assert.strictEqual(output.codedWidth, 32);
+      assert.strictEqual(output.codedHeight, 16);
+      assert.strictEqual(output.timestamp, 5000);
+      const pixels = new Uint8Array(output.allocationSize());
+      await output.copyTo(pixels);
+      assert.deepStrictEqual(Array.from(pixels.subarray(0, 4)), [255, 0, 0, 255]);
+
+      output.close();
+      filter.close();
+    });
+
+    it('overlays one input onto another', async () => {
+      const filter = new VideoFilter({ width: WIDTH, height: HEIGHT });
+      filter.configureGraph({
+        graph: '[in0][in1]overlay=x=8:y=8[out]',
+        inputs: [
+          { width: WIDTH, height: HEIGHT, format: 'RGBA' },
+          { width: 16, height: 16, format: 'RGBA' },
+        ],
+      });
+      const base = solidRGBA(WIDTH, HEIGHT, [0, 0, 255, 255]);
+      const logo = solidRGBA(16, 16, [0, 255, 0, 255]);
+
+      const outputs = await filter.process([base, logo]);
+      base.close();
+      logo.close();
+      const frames = [...outputs[0], ...(await filter.flush())[0]];
+      assert.ok(frames.length >= 1);
+      const pixels = new Uint8Array(frames[0].allocationSize());
+      await frames[0].copyTo(pixels);
+      assert.deepStrictEqual(rgbaAt(pixels, 0, 0), [0, 0, 255, 255]);
+      assert.deepStrictEqual(rgbaAt(pixels, 12, 12), [0, 255, 0, 255]);
+
+      for (const frame of frames) frame.close();
+      filter.close();
+    });
+
+    it('delivers each output separately', async () => {
+      const filter = new VideoFilter({ width: WIDTH, height: HEIGHT });
+      filter.configureGraph({
+        graph: '[in]split=2[a][b];[a]null[out0];[b]scale=16:16[out1]',
+        inputs: [{ width: WIDTH, height: HEIGHT, format: 'I420' }],
+        outputs: 2,
+      });
+      const input = new VideoFrame(new Uint8Array(WIDTH * HEIGHT * 1.5).fill(128), {
+        format: 'I420',
+        codedWidth: WIDTH,
+        codedHeight: HEIGHT,
+        timestamp: 0,
+      });
+
+      const outputs = await filter.process(input);
+      input.close();
+      assert.strictEqual(outputs.length, 2);
+      assert.strictEqual(outputs[0][0].codedWidth, WIDTH);
+      assert.strictEqual(outputs[0][0].format, 'I420');
+      assert.strictEqual(outputs[1][0].codedWidth, 16);
+
+      for (const frames of outputs) for (const frame of frames) frame.close();
+      filter.close();
+    });
+
+    it('changes frame rate and drains on flush', async () => {
+      const filter = new VideoFilter({ width: WIDTH, height: HEIGHT });
+      filter.configureGraph({
+        graph: 'fps=15',
+        inputs: [{ width: WIDTH, height: HEIGHT, format: 'RGBA', frameRate: 30 }],
+      });
+
+      const frames: VideoFrame[] = [];
+      for (let i = 0; i < 12; i++) {
+        const input = solidRGBA(WIDTH, HEIGHT, [i, i, i, 255], Math.round((i * 1e6) / 30));
+        frames.push(...(await filter.process(input))[0]);
+        input.close();
+      }
+      frames.push(...(await filter.flush())[0]);
+
+      assert.ok(frames.length >= 5 && frames.length <= 7, `got ${frames.length} frames`);
+      for (let i = 1; i < frames.length; i++) {
+        assert.ok(frames[i].timestamp > frames[i - 1].timestamp);
+      }
+
+      for (const frame of frames) frame.close();
+      filter.close();
+    });
+
+    it('throws for an invalid graph description', () => {
+      const filter = new VideoFilter({ width: WIDTH, height: HEIGHT });
+      assert.throws(() =>
+        filter.configureGraph({
+          graph: 'no_such_filter=1',
+          inputs: [{ width: WIDTH, height: HEIGHT }],
+        }),
+      );
+      filter.close();
+    });
+
+    it('rejects process() after close', async () => {
+      const filter = new VideoFilter({ width: WIDTH, height: HEIGHT });
+      filter.configureGraph({ graph: 'null', inputs: [{ width: WIDTH, height: HEIGHT }] });
+      filter.close();
+      const input = solidRGBA(WIDTH, HEIGHT, [0, 0, 0, 255]);
+      await assert.rejects(filter.process(input), /closed|InvalidStateError/);
+      input.close();
+    });
+  });
+});
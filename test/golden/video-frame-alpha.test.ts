@@ -28,6 +28,47 @@ describe('VideoFrame alpha option', () => {
     frame.close();
   });
 
+  it('should keep colour bytes and make alpha opaque when discarding RGBA', async () => {
+    const rgba = new Uint8Array(5 * 3 * 4);
+    for (let i = 0; i < rgba.length; i++) {
+      rgba[i] = i;
+    }
+    const frame = new VideoFrame(rgba, {
+      format: 'RGBA',
+      codedWidth: 5,
+      codedHeight: 3,
+      timestamp: 0,
+      alpha: 'discard',
+    });
+    assert.strictEqual(frame.format, 'RGBX');
+    const out = new Uint8Array(frame.allocationSize());
+    await frame.copyTo(out);
+    for (let i = 0; i < out.length; i++) {
+      assert.strictEqual(out[i], i % 4 === 3 ? 255 : i);
+    }
+    frame.close();
+  });
+
+  it('should drop the alpha plane when discarding I420A', async () => {
+    const i420Size = 64 * 64 * 1.5;
+    const i420a = new Uint8Array(i420Size + 64 * 64);
+    i420a.fill(7, 0, i420Size);
+    i420a.fill(200, i420Size);
+    const frame = new VideoFrame(i420a, {
+      format: 'I420A',
+      codedWidth: 64,
+      codedHeight: 64,
+      timestamp: 0,
+      alpha: 'discard',
+    });
+    assert.strictEqual(frame.format, 'I420');
+    assert.strictEqual(frame.allocationSize(), i420Size);
+    const out = new Uint8Array(i420Size);
+    await frame.copyTo(out);
+    assert.ok(out.every((v) => v === 7));
+    frame.close();
+  });
+
   it('should be no-op for formats without alpha', () => {
     const i420Size = Math.floor(64 * 64 * 1.5);
     const i420 = new Uint8Array(i420Size);
@@ -109,3 +109,97 @@ describe('VideoFrame.copyTo() with layout option', () => {
     frame.close();
   });
 });
+
+describe('VideoFrame.copyTo() with format option', () => {
+  // I420 frame whose left half is black and right half white (full range).
+  function createSplitI420(width: number, height: number): VideoFrame {
+    const data = new Uint8Array(width * height * 1.5).fill(128);
+    for (let y = 0; y < height; y++) {
+      for (let x = 0; x < width; x++) {
+        data[y * width + x] = x < width / 2 ? 0 : 255;
+      }
+    }
+    return new VideoFrame(data, {
+      format: 'I420',
+      codedWidth: width,
+      codedHeight: height,
+      timestamp: 0,
+      colorSpace: { matrix: 'bt709', fullRange: true },
+    });
+  }
+
+  it('should convert and crop in one pass', async () => {
+    const frame = createSplitI420(16, 8);
+    const dest = new Uint8Array(4 * 4 * 4);
+
+    const layout = await frame.copyTo(dest, {
+      format: 'RGBA',
+      rect: { x: 8, y: 2, width: 4, height: 4 },
+    });
+
+    assert.deepStrictEqual(layout, [{ offset: 0, stride: 16 }]);
+    for (let i = 0; i < dest.length; i += 4) {
+      assert.deepStrictEqual(Array.from(dest.subarray(i, i + 4)), [255, 255, 255, 255]);
+    }
+    frame.close();
+  });
+
+  it('should give the same result on repeated conversions', async () => {
+    const frame = createSplitI420(16, 8);
+    const first = new Uint8Array(16 * 8 * 4);
+    const second = new Uint8Array(16 * 8 * 4);
+
+    await frame.copyTo(first, { format: 'BGRA' });
+    await frame.copyTo(second, { format: 'BGRA' });
+
+    assert.deepStrictEqual(second, first);
+    assert.deepStrictEqual(Array.from(first.subarray(0, 4)), [0, 0, 0, 255]);
+    frame.close();
+  });
+
+  it('should crop planar frames without converting', async () => {
+    const frame = createSplitI420(16, 8);
+    const dest = new Uint8Array(8 * 4 * 1.5);
+
+    await frame.copyTo(dest, { rect: { x: 4, y: 2, width: 8, height: 4 } });
+
+    assert.deepStrictEqual(Array.from(dest.subarray(0, 8)), [0, 0, 0, 0, 255, 255, 255, 255]);
+    assert.ok(dest.subarray(32).every((v) => v === 128));
+    frame.close();
+  });
+
+  for (const resizeQuality of ['pixelated', 'low', 'medium', 'high'] as const) {
+    it(`should convert with resizeQuality '${resizeQuality}'`, async () => {
+      const frame = createSplitI420(16, 8);
+      const dest = new Uint8Array(16 * 8 * 4);
+
+      await frame.copyTo(dest, { format: 'RGBA', resizeQuality, scalingThreads: 0 });
+
+      assert.deepStrictEqual(Array.from(dest.subarray(0, 4)), [0, 0, 0, 255]);
+      assert.deepStrictEqual(Array.from(dest.subarray(dest.length - 4)), [255, 255, 255, 255]);
+      frame.close();
+    });
+  }
+
+  it('should reject an invalid resizeQuality', async () => {
+    const frame = createSplitI420(16, 8);
+    const dest = new Uint8Array(16 * 8 * 4);
+
+    await assert.rejects(
+      frame.copyTo(dest, { format: 'RGBA', resizeQuality: 'bogus' as 'low' }),
+      TypeError,
+    );
+    frame.close();
+  });
+
+  it('should reject unsupported colorSpace', async () => {
+    const frame = createSplitI420(16, 8);
+    const dest = new Uint8Array(16 * 8 * 4);
+
+    await assert.rejects(
+      frame.copyTo(dest, { format: 'RGBA', colorSpace: 'display-p3' }),
+      /NotSupportedError/,
+    );
+    frame.close();
+  });
+});
@@ -0,0 +1,115 @@
+// test/golden/video-scaler.test.ts
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+import { type EncodedVideoChunk, VideoEncoder, VideoFrame, VideoScaler } from '../../lib';
+
+const WIDTH = 128;
+const HEIGHT = 96;
+
+function solidRGBA(rgba: number[], timestamp = 0): VideoFrame {
+  const data = new Uint8Array(WIDTH * HEIGHT * 4);
+  for (let i = 0; i < data.length; i += 4) {
+    data.set(rgba, i);
+  }
+  return new VideoFrame(data, {
+    format: 'RGBA',
+    codedWidth: WIDTH,
+    codedHeight: HEIGHT,
+    timestamp,
+  });
+}
+
+describe('VideoScaler', () => {
+  for (const cascade of [true, false]) {
+    it(`produces every rendition in its own format (cascade: ${cascade})`, async () => {
+      const scaler = new VideoScaler({
+        renditions: [
+          { width: 32, height: 24 },
+          { width: 64, height: 48 },
+          { width: WIDTH, height: HEIGHT, format: 'RGBA' },
+          { width: 96, height: 72, format: 'NV12' },
+        ],
+        cascade,
+      });
+      const input = solidRGBA([255, 255, 255, 255], 4242);
+
+      const frames = await scaler.scale(input);
+      input.close();
+
+      assert.deepStrictEqual(
+        frames.map((f) => [f.codedWidth, f.codedHeight, f.format, f.timestamp]),
+        [
+          [32, 24, 'I420', 4242],
+          [64, 48, 'I420', 4242],
+          [WIDTH, HEIGHT, 'RGBA', 4242],
+          [96, 72, 'NV12', 4242],
+        ],
+      );
+
+      // White stays white (limited-range luma 235) through the cascade.
+      const smallest = new Uint8Array(frames[0].allocationSize());
+      await frames[0].copyTo(smallest);
+      assert.ok(Math.abs(smallest[0] - 235) <= 1, `luma ${smallest[0]}`);
+
+      for (const frame of frames) frame.close();
+      scaler.close();
+    });
+  }
+
+  it('feeds renditions straight into matching encoders', async () => {
+    const sizes = [
+      { width: 64, height: 48 },
+      { width: 32, height: 24 },
+    ];
+    const scaler = new VideoScaler({ renditions: sizes });
+    const chunks: EncodedVideoChunk[][] = sizes.map(() => []);
+    const encoders = sizes.map((size, i) => {
+      const encoder = new VideoEncoder({
+        output: (chunk) => {
+          chunks[i].push(chunk);
+        },
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({ codec: 'avc1.42001e', ...size, bitrate: 100_000, framerate: 30 });
+      return encoder;
+    });
+
+    for (let i = 0; i < 5; i++) {
+      const input = solidRGBA([i * 40, 0, 0, 255], i * 33333);
+      const renditions = await scaler.scale(input);
+      input.close();
+      renditions.forEach((frame, r) => {
+        encoders[r].encode(frame, { keyFrame: i === 0 });
+        frame.close();
+      });
+    }
+    for (const encoder of encoders) {
+      await encoder.flush();
+      encoder.close();
+    }
+    scaler.close();
+
+    assert.deepStrictEqual(
+      chunks.map((list) => list.length),
+      [5, 5],
+    );
+  });
+
+  it('rejects invalid configurations', () => {
+    assert.throws(() => new VideoScaler({ renditions: [] }), TypeError);
+    assert.throws(() => new VideoScaler({ renditions: [{ width: 0, height: 10 }] }), RangeError);
+  });
+
+  it('rejects scale() after close', async () => {
+    const scaler = new VideoScaler({ renditions: [{ width: 16, height: 16 }] });
+    scaler.close();
+    const input = solidRGBA([0, 0, 0, 255]);
+    await assert.rejects(scaler.scale(input), /closed|InvalidStateError/);
+    input.close();
+  });
+});
@@ -0,0 +1,191 @@
+import {writeFileSync} from 'node:fs';
+import {
+  type EncodedVideoChunk,
+  VideoDecoder,
+  type VideoDecoderConfig,
+  VideoEncoder,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+// End-to-end pipeline benchmark through the real addon: every frame crosses
+// the CodecWorker thread and comes back through the output TSFN, which the
+// native suite (test/native/benchmark/pipeline_throughput.cpp) cannot
+// include. Prints one JSON report; pass a path to also write it to a file.
+//
+//   npm run bench:pipeline -- pipeline.json
+
+const WIDTH = 1280;
+const HEIGHT = 720;
+const FRAMES = 120;
+const CODEC = 'avc1.42001f';
+const INSTANCES = [1, 2, 4];
+
+interface ScenarioResult {
+  name: string;
+  frames: number;
+  fps: number;
+  p50Ms?: number;
+  p99Ms?: number;
+  peakRssMb: number;
+}
+
+function percentile(samples: number[], p: number): number {
+  const sorted = [...samples].sort((a, b) => a - b);
+  return sorted[Math.floor(p * (sorted.length - 1))];
+}
+
+function peakRssMb(): number {
+  return process.resourceUsage().maxRSS / 1024;
+}
+
+function makeFrame(i: number): VideoFrame {
+  const data = new Uint8Array(WIDTH * HEIGHT * 4);
+  for (let p = 0; p < data.length; p += 4) {
+    data[p] = (p / 4 + i * 3) & 0xff;
+    data[p + 1] = (p / 64) & 0xff;
+    data[p + 3] = 255;
+  }
+  return new VideoFrame(data, {format: 'RGBA', codedWidth: WIDTH, codedHeight: HEIGHT, timestamp: i * 33333});
+}
+
+function newEncoder(onChunk: (chunk: EncodedVideoChunk, config?: VideoDecoderConfig) => void): VideoEncoder {
+  const encoder = new VideoEncoder({
+    output: (chunk, metadata) => onChunk(chunk, metadata?.decoderConfig),
+    error: error => {
+      throw error;
+    },
+  });
+  // Realtime mode: one chunk per frame, so latency pairs up by timestamp.
+  encoder.configure({codec: CODEC, width: WIDTH, height: HEIGHT, bitrate: 2_000_000, latencyMode: 'realtime'});
+  return encoder;
+}
+
+/** encode() call to output callback, per frame. */
+async function encodeLatency(frames: VideoFrame[]): Promise<ScenarioResult> {
+  const submitted = new Map<number, number>();
+  const latencies: number[] = [];
+  const encoder = newEncoder(chunk => {
+    latencies.push(performance.now() - (submitted.get(chunk.timestamp) ?? 0));
+  });
+  const start = performance.now();
+  for (const [i, frame] of frames.entries()) {
+    submitted.set(frame.timestamp, performance.now());
+    encoder.encode(frame, {keyFrame: i === 0});
+  }
+  await encoder.flush();
+  const seconds = (performance.now() - start) / 1000;
+  encoder.close();
+  return {
+    name: 'encode',
+    frames: latencies.length,
+    fps: latencies.length / seconds,
+    p50Ms: percentile(latencies, 0.5),
+    p99Ms: percentile(latencies, 0.99),
+    peakRssMb: peakRssMb(),
+  };
+}
+
+/** Decode -> encode; latency is decode() call to re-encoded chunk. */
+async function transcode(chunks: EncodedVideoChunk[], config: VideoDecoderConfig): Promise<ScenarioResult> {
+  const submitted = new Map<number, number>();
+  const latencies: number[] = [];
+  const encoder = newEncoder(chunk => {
+    latencies.push(performance.now() - (submitted.get(chunk.timestamp) ?? 0));
+  });
+  const decoder = new VideoDecoder({
+    output: frame => {
+      encoder.encode(frame);
+      frame.close();
+    },
+    error: error => {
+      throw error;
+    },
+  });
+  decoder.configure(config);
+  const start = performance.now();
+  for (const chunk of chunks) {
+    submitted.set(chunk.timestamp, performance.now());
+    decoder.decode(chunk);
+  }
+  await decoder.flush();
+  await encoder.flush();
+  const seconds = (performance.now() - start) / 1000;
+  decoder.close();
+  encoder.close();
+  return {
+    name: 'transcode',
+    frames: latencies.length,
+    fps: latencies.length / seconds,
+    p50Ms: percentile(latencies, 0.5),
+    p99Ms: percentile(latencies, 0.99),
+    peakRssMb: peakRssMb(),
+  };
+}
+
+/** N encoders fed concurrently; fps is the aggregate. */
+async function concurrentEncoders(frames: VideoFrame[], instances: number): Promise<ScenarioResult> {
+  let produced = 0;
+  const encoders = Array.from({length: instances}, () =>
+    newEncoder(() => {
+      produced++;
+    }),
+  );
+  const start = performance.now();
+  for (const [i, frame] of frames.entries()) {
+    for (const encoder of encoders) {
+      encoder.encode(frame, {keyFrame: i === 0});
+    }
+  }
+  await Promise.all(encoders.map(encoder => encoder.flush()));
+  const seconds = (performance.now() - start) / 1000;
+  for (const encoder of encoders) {
+    encoder.close();
+  }
+  return {name: `concurrent-encoders-${instances}`, frames: produced, fps: produced / seconds, peakRssMb: peakRssMb()};
+}
+
+async function run(): Promise<void> {
+  const frames = Array.from({length: FRAMES}, (_, i) => makeFrame(i));
+
+  const results: ScenarioResult[] = [];
+  results.push(await encodeLatency(frames));
+
+  const chunks: EncodedVideoChunk[] = [];
+  let decoderConfig: VideoDecoderConfig | undefined;
+  const source = newEncoder((chunk, config) => {
+    chunks.push(chunk);
+    decoderConfig ??= config;
+  });
+  for (const [i, frame] of frames.entries()) {
+    source.encode(frame, {keyFrame: i === 0});
+  }
+  await source.flush();
+  source.close();
+  if (!decoderConfig) {
+    throw new Error('Encoder produced no decoderConfig');
+  }
+  results.push(await transcode(chunks, decoderConfig));
+
+  for (const instances of INSTANCES) {
+    results.push(await concurrentEncoders(frames, instances));
+  }
+  for (const frame of frames) {
+    frame.close();
+  }
+
+  const report = JSON.stringify(
+    {width: WIDTH, height: HEIGHT, codec: CODEC, framesPerScenario: FRAMES, results},
+    null,
+    2,
+  );
+  console.log(report);
+  if (process.argv[2]) {
+    writeFileSync(process.argv[2], `${report}\n`);
+  }
+}
+
+run().catch(error => {
+  const message = error instanceof Error ? error.message : String(error);
+  console.error('FAILURE:', message);
+  process.exit(1);
+});
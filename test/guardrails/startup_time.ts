@@ -0,0 +1,62 @@
+import {execFileSync} from 'node:child_process';
+
+// Cold start of a fresh process: loading the package, then the first codec.
+// Codec classes and FFmpeg setup are deferred until first use, so a plain
+// require() must stay well below the cost of configuring an encoder.
+const MAX_REQUIRE_MS = 150;
+const RUNS = 10;
+
+const SCRIPT = `
+const start = process.hrtime.bigint();
+const webcodecs = require('@pproenca/node-webcodecs');
+const loaded = process.hrtime.bigint();
+const encoder = new webcodecs.VideoEncoder({output: () => {}, error: () => {}});
+encoder.configure({codec: 'avc1.42001E', width: 640, height: 480});
+const configured = process.hrtime.bigint();
+encoder.close();
+process.stdout.write(JSON.stringify({
+  require: Number(loaded - start) / 1e6,
+  firstConfigure: Number(configured - loaded) / 1e6,
+}));
+`;
+
+function median(values: number[]): number {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+function run(): void {
+  console.log(`Startup Benchmark (${RUNS} cold processes)`);
+
+  const requireMs: number[] = [];
+  const configureMs: number[] = [];
+  for (let i = 0; i < RUNS; i++) {
+    const output = execFileSync(process.execPath, ['-e', SCRIPT], {
+      cwd: process.cwd(),
+      encoding: 'utf8',
+    });
+    const result = JSON.parse(output) as {require: number; firstConfigure: number};
+    requireMs.push(result.require);
+    configureMs.push(result.firstConfigure);
+  }
+
+  const requireMedian = median(requireMs);
+  console.log(`  require():                 ${requireMedian.toFixed(2)}ms (median)`);
+  console.log(`  first VideoEncoder config: ${median(configureMs).toFixed(2)}ms (median)`);
+
+  if (requireMedian > MAX_REQUIRE_MS) {
+    console.error(
+      `FAILURE: Module load too slow (${requireMedian.toFixed(2)}ms > ${MAX_REQUIRE_MS}ms)`,
+    );
+    process.exit(1);
+  }
+  console.log('SUCCESS: Startup target met.');
+}
+
+try {
+  run();
+} catch (error) {
+  const message = error instanceof Error ? error.message : String(error);
+  console.error('FAILURE:', message);
+  process.exit(1);
+}
@@ -10,6 +10,7 @@
  * - AV1 encode/decode throughput
  * - Different resolutions (VGA, HD, 4K)
  * - Different preset/quality settings
+ * - Colour conversion, libswscale vs the vectorised kernels
  *
  * Run with: make run_benchmarks
  */
@@ -20,12 +21,14 @@
 #include <string>
 
 #include "src/ffmpeg_raii.h"
+#include "src/yuv_kernels.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavutil/frame.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
+#include <libswscale/swscale.h>
 }
 
 namespace {
@@ -337,36 +340,95 @@ BENCHMARK(BM_VP9_Encode)
 
 /**
  * Benchmark: Pixel format conversion overhead.
- * WebCodecs often needs to convert between RGB and YUV.
+ * WebCodecs often needs to convert between RGB and YUV. Compares
+ * libswscale (as a pooled SwsContext is set up) with the vectorised
+ * kernels in yuv_kernels.h for the same-size conversions they cover.
+ *
+ * Args: width, height, conversion (kConversions index), implementation
+ * (0 = libswscale, 1 = kernels).
  */
+struct Conversion {
+  AVPixelFormat src;
+  AVPixelFormat dst;
+  const char* name;
+};
+
+constexpr Conversion kConversions[] = {
+    {AV_PIX_FMT_YUV420P, AV_PIX_FMT_RGBA, "I420->RGBA"},
+    {AV_PIX_FMT_NV12, AV_PIX_FMT_BGRA, "NV12->BGRA"},
+    {AV_PIX_FMT_P010LE, AV_PIX_FMT_RGBA, "P010->RGBA"},
+    {AV_PIX_FMT_RGBA, AV_PIX_FMT_YUV420P, "RGBA->I420"},
+    {AV_PIX_FMT_BGRA, AV_PIX_FMT_NV12, "BGRA->NV12"},
+};
+
+webcodecs::YuvLayout KernelLayout(AVPixelFormat format) {
+  if (format == AV_PIX_FMT_NV12) return webcodecs::YuvLayout::kNV12;
+  if (format == AV_PIX_FMT_P010LE) return webcodecs::YuvLayout::kP010;
+  return webcodecs::YuvLayout::kI420;
+}
+
+bool IsRgb(AVPixelFormat format) {
+  return format == AV_PIX_FMT_RGBA || format == AV_PIX_FMT_BGRA;
+}
+
 static void BM_PixelFormat_Conversion(benchmark::State& state) {
   const int width = state.range(0);
   const int height = state.range(1);
+  const Conversion& conversion = kConversions[state.range(2)];
+  const bool kernels = state.range(3) != 0;
 
   ffmpeg::AVFramePtr src_frame =
-      CreateTestFrame(width, height, AV_PIX_FMT_YUV420P);
+      CreateTestFrame(width, height, conversion.src);
   ffmpeg::AVFramePtr dst_frame = ffmpeg::make_frame();
-  dst_frame->format = AV_PIX_FMT_RGBA;
+  dst_frame->format = conversion.dst;
   dst_frame->width = width;
   dst_frame->height = height;
-  av_frame_get_buffer(dst_frame.get(), 0);
+  if (!src_frame || av_frame_get_buffer(dst_frame.get(), 0) < 0) {
+    state.SkipWithError("Failed to create test frames");
+    return;
+  }
+
+  SwsContext* sws = nullptr;
+  if (!kernels) {
+    sws = sws_getContext(width, height, conversion.src, width, height,
+                         conversion.dst, SWS_BILINEAR, nullptr, nullptr,
+                         nullptr);
+    if (!sws) {
+      state.SkipWithError("Failed to create SwsContext");
+      return;
+    }
+  }
 
   for (auto _ : state) {
-    // Simple memcpy as placeholder for format conversion
-    // Real implementation would use swscale
-    for (int i = 0; i < 3; ++i) {
-      int size = src_frame->linesize[i] * (height >> (i > 0 ? 1 : 0));
-      std::memcpy(dst_frame->data[i], src_frame->data[i], size);
+    if (!kernels) {
+      sws_scale(sws, src_frame->data, src_frame->linesize, 0, height,
+                dst_frame->data, dst_frame->linesize);
+    } else if (IsRgb(conversion.src)) {
+      webcodecs::ConvertRgbToYuv(
+          src_frame->data[0], src_frame->linesize[0],
+          conversion.src == AV_PIX_FMT_BGRA, KernelLayout(conversion.dst),
+          dst_frame->data, dst_frame->linesize, width, height);
+    } else {
+      webcodecs::ConvertYuvToRgb(
+          KernelLayout(conversion.src), src_frame->data,
+          src_frame->linesize, dst_frame->data[0], dst_frame->linesize[0],
+          conversion.dst == AV_PIX_FMT_BGRA, width, height,
+          webcodecs::YuvMatrix::kBT601, false);
     }
-    benchmark::DoNotOptimize(dst_frame);
+    benchmark::DoNotOptimize(dst_frame->data[0]);
   }
+  sws_freeContext(sws);
 
   state.SetItemsProcessed(state.iterations());
-  state.SetLabel("conversions/sec");
+  state.SetLabel(std::string(conversion.name) +
+                 (kernels ? (webcodecs::HasYuvKernels() ? " kernels"
+                                                        : " kernels (scalar)")
+                          : " swscale"));
 }
 BENCHMARK(BM_PixelFormat_Conversion)
-    ->Args({640, 480})
-    ->Args({1280, 720})
-    ->Args({1920, 1080});
+    ->ArgsProduct({{1280}, {720}, {0, 1, 2, 3, 4}, {0, 1}})
+    ->ArgsProduct({{1920}, {1080}, {0, 1, 2, 3, 4}, {0, 1}})
+    ->Args({640, 480, 0, 0})
+    ->Args({640, 480, 0, 1});
 
 }  // namespace
@@ -0,0 +1,522 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+
+/**
+ * pipeline_throughput.cpp - End-to-end pipeline benchmarks.
+ *
+ * Measures what production workloads run rather than single codec calls:
+ * - Decode -> scale -> encode transcode throughput and per-frame latency
+ * - Encode latency across a worker thread handoff (ControlMessageQueue in,
+ *   a second queue standing in for the TSFN hop back out)
+ * - Aggregate throughput of 1..N concurrent encoders
+ * - Every PixelFormat conversion pair through libswscale
+ *
+ * Each benchmark reports fps, p50_ms and p99_ms (where latency applies)
+ * and peak_rss_mb as counters, so JSON output carries them:
+ *
+ *   ./webcodecs_benchmarks --benchmark_filter=BM_Pipeline \
+ *       --benchmark_out=pipeline.json --benchmark_out_format=json
+ *
+ * Run with: npm run bench:native:json
+ */
+
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/ffmpeg_raii.h"
+#include "src/shared/control_message_queue.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+using namespace webcodecs;
+
+namespace {
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+struct CodecContextDeleter {
+  void operator()(AVCodecContext* ctx) const { avcodec_free_context(&ctx); }
+};
+using CodecContextPtr = std::unique_ptr<AVCodecContext, CodecContextDeleter>;
+
+struct SwsContextDeleter {
+  void operator()(SwsContext* ctx) const { sws_freeContext(ctx); }
+};
+using SwsContextPtr = std::unique_ptr<SwsContext, SwsContextDeleter>;
+
+using Clock = std::chrono::steady_clock;
+
+// Frames in the pre-encoded source clip; also its GOP, so cycling through
+// it always restarts at a key frame.
+constexpr int kSourceFrames = 60;
+
+/**
+ * Open libx264 the way the realtime encoder path does: no B-frames, so one
+ * frame in gives one packet out.
+ */
+CodecContextPtr OpenH264Encoder(int width, int height, int threads) {
+  const AVCodec* codec = avcodec_find_encoder_by_name("libx264");
+  if (!codec) {
+    return nullptr;
+  }
+  CodecContextPtr ctx(avcodec_alloc_context3(codec));
+  if (!ctx) {
+    return nullptr;
+  }
+  ctx->width = width;
+  ctx->height = height;
+  ctx->time_base = AVRational{1, 30};
+  ctx->framerate = AVRational{30, 1};
+  ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+  ctx->bit_rate = 2000000;
+  ctx->gop_size = kSourceFrames;
+  ctx->max_b_frames = 0;
+  ctx->thread_count = threads;
+  av_opt_set(ctx->priv_data, "preset", "ultrafast", 0);
+  av_opt_set(ctx->priv_data, "tune", "zerolatency", 0);
+  if (avcodec_open2(ctx.get(), codec, nullptr) < 0) {
+    return nullptr;
+  }
+  return ctx;
+}
+
+CodecContextPtr OpenH264Decoder() {
+  const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+  if (!codec) {
+    return nullptr;
+  }
+  CodecContextPtr ctx(avcodec_alloc_context3(codec));
+  if (!ctx || avcodec_open2(ctx.get(), codec, nullptr) < 0) {
+    return nullptr;
+  }
+  return ctx;
+}
+
+/**
+ * Frame with a moving gradient, so the encoder does real work.
+ */
+ffmpeg::AVFramePtr CreatePatternFrame(int width, int height,
+                                      AVPixelFormat format, int index) {
+  ffmpeg::AVFramePtr frame = ffmpeg::make_frame();
+  frame->format = format;
+  frame->width = width;
+  frame->height = height;
+  if (av_frame_get_buffer(frame.get(), 0) < 0) {
+    return nullptr;
+  }
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+  for (int plane = 0; plane < 4 && frame->data[plane]; ++plane) {
+    int rows = height;
+    if (plane > 0 && !(desc->flags & AV_PIX_FMT_FLAG_RGB)) {
+      rows = AV_CEIL_RSHIFT(height, desc->log2_chroma_h);
+    }
+    for (int y = 0; y < rows; ++y) {
+      uint8_t* row = frame->data[plane] + y * frame->linesize[plane];
+      for (int x = 0; x < frame->linesize[plane]; ++x) {
+        row[x] = static_cast<uint8_t>(x + y + index * 3 + plane * 64);
+      }
+    }
+  }
+  return frame;
+}
+
+/**
+ * Encode kSourceFrames pattern frames into one closed GOP of H.264.
+ */
+std::vector<ffmpeg::AVPacketPtr> EncodeSourceClip(int width, int height) {
+  std::vector<ffmpeg::AVPacketPtr> packets;
+  CodecContextPtr enc = OpenH264Encoder(width, height, 0);
+  if (!enc) {
+    return packets;
+  }
+  for (int i = 0; i <= kSourceFrames; ++i) {
+    ffmpeg::AVFramePtr frame;
+    if (i < kSourceFrames) {
+      frame = CreatePatternFrame(width, height, AV_PIX_FMT_YUV420P, i);
+      frame->pts = i;
+    }
+    // The last pass drains the encoder.
+    avcodec_send_frame(enc.get(), frame.get());
+    ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
+    while (avcodec_receive_packet(enc.get(), packet.get()) == 0) {
+      packets.push_back(std::move(packet));
+      packet = ffmpeg::make_packet();
+    }
+  }
+  return packets;
+}
+
+/**
+ * Per-frame latency samples, reported as percentiles in milliseconds.
+ */
+class LatencyRecorder {
+ public:
+  void Add(Clock::duration d) {
+    samples_.push_back(std::chrono::duration<double, std::milli>(d).count());
+  }
+
+  double Percentile(double p) {
+    if (samples_.empty()) {
+      return 0;
+    }
+    size_t rank = static_cast<size_t>(p * (samples_.size() - 1));
+    std::nth_element(samples_.begin(), samples_.begin() + rank,
+                     samples_.end());
+    return samples_[rank];
+  }
+
+  size_t count() const { return samples_.size(); }
+
+ private:
+  std::vector<double> samples_;
+};
+
+double PeakRssMb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  return usage.ru_maxrss / (1024.0 * 1024.0);  // Bytes
+#else
+  return usage.ru_maxrss / 1024.0;  // Kilobytes
+#endif
+}
+
+void ReportCounters(benchmark::State& state, int64_t frames,
+                    LatencyRecorder* latency) {
+  state.counters["fps"] =
+      benchmark::Counter(static_cast<double>(frames),
+                         benchmark::Counter::kIsRate);
+  if (latency && latency->count() > 0) {
+    state.counters["p50_ms"] = latency->Percentile(0.50);
+    state.counters["p99_ms"] = latency->Percentile(0.99);
+  }
+  // Peak for the process so far; run one filter per process to isolate.
+  state.counters["peak_rss_mb"] = PeakRssMb();
+  state.SetItemsProcessed(frames);
+}
+
+// =============================================================================
+// TRANSCODE
+// =============================================================================
+
+/**
+ * Benchmark: decode -> scale -> encode, one frame per iteration.
+ * Latency is from sending a packet to receiving its re-encoded packet.
+ *
+ * Args: source width, source height, output width, output height.
+ */
+static void BM_Pipeline_Transcode(benchmark::State& state) {
+  const int src_width = state.range(0);
+  const int src_height = state.range(1);
+  const int dst_width = state.range(2);
+  const int dst_height = state.range(3);
+
+  std::vector<ffmpeg::AVPacketPtr> source =
+      EncodeSourceClip(src_width, src_height);
+  CodecContextPtr dec = OpenH264Decoder();
+  CodecContextPtr enc = OpenH264Encoder(dst_width, dst_height, 0);
+  if (source.empty() || !dec || !enc) {
+    state.SkipWithError("libx264 or the H.264 decoder is not available");
+    return;
+  }
+  SwsContextPtr sws(sws_getContext(src_width, src_height, AV_PIX_FMT_YUV420P,
+                                   dst_width, dst_height, AV_PIX_FMT_YUV420P,
+                                   SWS_BILINEAR, nullptr, nullptr, nullptr));
+  ffmpeg::AVFramePtr decoded = ffmpeg::make_frame();
+  ffmpeg::AVFramePtr scaled = ffmpeg::make_frame();
+  scaled->format = AV_PIX_FMT_YUV420P;
+  scaled->width = dst_width;
+  scaled->height = dst_height;
+  if (!sws || av_frame_get_buffer(scaled.get(), 0) < 0) {
+    state.SkipWithError("Failed to set up scaling");
+    return;
+  }
+
+  LatencyRecorder latency;
+  ffmpeg::AVPacketPtr out = ffmpeg::make_packet();
+  int64_t frames = 0;
+  size_t next = 0;
+  for (auto _ : state) {
+    Clock::time_point start = Clock::now();
+    if (avcodec_send_packet(dec.get(), source[next].get()) < 0) {
+      state.SkipWithError("Decode failed");
+      return;
+    }
+    next = (next + 1) % source.size();
+    while (avcodec_receive_frame(dec.get(), decoded.get()) == 0) {
+      av_frame_make_writable(scaled.get());
+      sws_scale(sws.get(), decoded->data, decoded->linesize, 0, src_height,
+                scaled->data, scaled->linesize);
+      scaled->pts = frames;
+      scaled->pict_type =
+          decoded->pict_type == AV_PICTURE_TYPE_I ? AV_PICTURE_TYPE_I
+                                                  : AV_PICTURE_TYPE_NONE;
+      av_frame_unref(decoded.get());
+      avcodec_send_frame(enc.get(), scaled.get());
+      while (avcodec_receive_packet(enc.get(), out.get()) == 0) {
+        latency.Add(Clock::now() - start);
+        benchmark::DoNotOptimize(out->data);
+        av_packet_unref(out.get());
+        frames++;
+      }
+    }
+  }
+
+  ReportCounters(state, frames, &latency);
+}
+BENCHMARK(BM_Pipeline_Transcode)
+    ->Args({1280, 720, 1280, 720})
+    ->Args({1920, 1080, 1280, 720})
+    ->Args({1920, 1080, 640, 360})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// =============================================================================
+// WORKER HANDOFF LATENCY
+// =============================================================================
+
+/**
+ * Benchmark: encode through a worker thread, as VideoEncoder does.
+ * Frames go in through a ControlMessageQueue; packets come back through a
+ * second queue drained by the benchmark thread, standing in for the TSFN
+ * hop to the JS thread. Latency is enqueue to delivery.
+ *
+ * Args: width, height, frames in flight.
+ */
+static void BM_Pipeline_WorkerLatency(benchmark::State& state) {
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const int in_flight = std::max<int>(1, state.range(2));
+
+  CodecContextPtr enc = OpenH264Encoder(width, height, 0);
+  if (!enc) {
+    state.SkipWithError("libx264 encoder not available");
+    return;
+  }
+  std::vector<ffmpeg::AVFramePtr> pool;
+  for (int i = 0; i < kSourceFrames; ++i) {
+    pool.push_back(CreatePatternFrame(width, height, AV_PIX_FMT_YUV420P, i));
+  }
+
+  VideoControlQueue to_worker;
+  VideoControlQueue to_main;
+  std::thread worker([&]() {
+    while (auto msg = to_worker.Dequeue()) {
+      auto* encode = std::get_if<VideoControlQueue::EncodeMessage>(&*msg);
+      if (!encode) {
+        continue;
+      }
+      avcodec_send_frame(enc.get(), encode->frame.get());
+      ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
+      while (avcodec_receive_packet(enc.get(), packet.get()) == 0) {
+        VideoControlQueue::DecodeMessage out;
+        out.packet = std::move(packet);
+        (void)to_main.Enqueue(std::move(out));
+        packet = ffmpeg::make_packet();
+      }
+    }
+  });
+
+  LatencyRecorder latency;
+  std::vector<Clock::time_point> sent;  // By pts
+  int64_t pts = 0;
+  int64_t frames = 0;
+  auto submit = [&]() {
+    VideoControlQueue::EncodeMessage msg;
+    msg.frame = ffmpeg::AVFramePtr(
+        av_frame_clone(pool[pts % kSourceFrames].get()));
+    msg.frame->pts = pts++;
+    sent.push_back(Clock::now());
+    (void)to_worker.Enqueue(std::move(msg));
+  };
+  for (int i = 0; i < in_flight; ++i) {
+    submit();
+  }
+  for (auto _ : state) {
+    auto msg = to_main.Dequeue();
+    auto* out = std::get_if<VideoControlQueue::DecodeMessage>(&*msg);
+    latency.Add(Clock::now() - sent[out->packet->pts]);
+    frames++;
+    submit();
+  }
+
+  to_worker.Shutdown();
+  worker.join();
+  ReportCounters(state, frames, &latency);
+}
+BENCHMARK(BM_Pipeline_WorkerLatency)
+    ->Args({1280, 720, 1})
+    ->Args({1280, 720, 4})
+    ->Args({1920, 1080, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// =============================================================================
+// MULTI-INSTANCE SCALING
+// =============================================================================
+
+/**
+ * Benchmark: N independent encoders on their own threads, each encoding 30
+ * frames per iteration. fps is the aggregate; compare across N for scaling.
+ * Encoders run single-threaded, as many-instance servers configure them.
+ *
+ * Args: instances.
+ */
+static void BM_Pipeline_ConcurrentEncoders(benchmark::State& state) {
+  const int instances = state.range(0);
+  constexpr int kWidth = 1280;
+  constexpr int kHeight = 720;
+  constexpr int kFramesPerIteration = 30;
+
+  std::vector<CodecContextPtr> encoders;
+  for (int i = 0; i < instances; ++i) {
+    encoders.push_back(OpenH264Encoder(kWidth, kHeight, 1));
+    if (!encoders.back()) {
+      state.SkipWithError("libx264 encoder not available");
+      return;
+    }
+  }
+  std::vector<ffmpeg::AVFramePtr> pool;
+  for (int i = 0; i < kFramesPerIteration; ++i) {
+    pool.push_back(CreatePatternFrame(kWidth, kHeight, AV_PIX_FMT_YUV420P, i));
+  }
+
+  std::atomic<int64_t> frames{0};
+  int64_t pts = 0;
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < instances; ++i) {
+      threads.emplace_back([&, i, pts]() {
+        AVCodecContext* enc = encoders[i].get();
+        ffmpeg::AVPacketPtr packet = ffmpeg::make_packet();
+        for (int f = 0; f < kFramesPerIteration; ++f) {
+          ffmpeg::AVFramePtr frame(av_frame_clone(pool[f].get()));
+          frame->pts = pts + f;
+          avcodec_send_frame(enc, frame.get());
+          while (avcodec_receive_packet(enc, packet.get()) == 0) {
+            av_packet_unref(packet.get());
+            frames.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    pts += kFramesPerIteration;
+  }
+
+  ReportCounters(state, frames.load(), nullptr);
+  state.counters["fps_per_instance"] = benchmark::Counter(
+      static_cast<double>(frames.load()) / instances,
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Pipeline_ConcurrentEncoders)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// =============================================================================
+// PIXEL FORMAT MATRIX
+// =============================================================================
+
+// FFmpeg formats behind every WebCodecs PixelFormat (the format table in
+// src/video_frame.cc); keep in step with it. NV12A shares NV12's format.
+constexpr AVPixelFormat kPixelFormats[] = {
+    AV_PIX_FMT_RGBA,          // RGBA
+    AV_PIX_FMT_RGB0,          // RGBX
+    AV_PIX_FMT_BGRA,          // BGRA
+    AV_PIX_FMT_BGR0,          // BGRX
+    AV_PIX_FMT_YUV420P,       // I420
+    AV_PIX_FMT_YUVA420P,      // I420A
+    AV_PIX_FMT_YUV422P,       // I422
+    AV_PIX_FMT_YUVA422P,      // I422A
+    AV_PIX_FMT_YUV444P,       // I444
+    AV_PIX_FMT_YUVA444P,      // I444A
+    AV_PIX_FMT_NV12,          // NV12
+    AV_PIX_FMT_NV21,          // NV21
+    AV_PIX_FMT_YUV420P10LE,   // I420P10
+    AV_PIX_FMT_YUV422P10LE,   // I422P10
+    AV_PIX_FMT_YUV444P10LE,   // I444P10
+    AV_PIX_FMT_P010LE,        // NV12P10
+    AV_PIX_FMT_YUVA420P10LE,  // I420AP10
+    AV_PIX_FMT_YUVA422P10LE,  // I422AP10
+    AV_PIX_FMT_YUVA444P10LE,  // I444AP10
+    AV_PIX_FMT_YUV420P12LE,   // I420P12
+    AV_PIX_FMT_YUV422P12LE,   // I422P12
+    AV_PIX_FMT_YUV444P12LE,   // I444P12
+};
+constexpr int kPixelFormatCount =
+    static_cast<int>(sizeof(kPixelFormats) / sizeof(kPixelFormats[0]));
+
+/**
+ * Benchmark: same-size 720p conversion between two PixelFormats, as
+ * VideoFrame.copyTo({format}) performs it.
+ *
+ * Args: source and destination kPixelFormats indices.
+ */
+static void BM_Pipeline_PixelFormatMatrix(benchmark::State& state) {
+  constexpr int kWidth = 1280;
+  constexpr int kHeight = 720;
+  AVPixelFormat src_format = kPixelFormats[state.range(0)];
+  AVPixelFormat dst_format = kPixelFormats[state.range(1)];
+
+  ffmpeg::AVFramePtr src =
+      CreatePatternFrame(kWidth, kHeight, src_format, 0);
+  ffmpeg::AVFramePtr dst = ffmpeg::make_frame();
+  dst->format = dst_format;
+  dst->width = kWidth;
+  dst->height = kHeight;
+  SwsContextPtr sws(sws_getContext(kWidth, kHeight, src_format, kWidth,
+                                   kHeight, dst_format, SWS_BILINEAR, nullptr,
+                                   nullptr, nullptr));
+  if (!src || av_frame_get_buffer(dst.get(), 0) < 0 || !sws) {
+    state.SkipWithError("Conversion not supported");
+    return;
+  }
+
+  for (auto _ : state) {
+    sws_scale(sws.get(), src->data, src->linesize, 0, kHeight, dst->data,
+              dst->linesize);
+    benchmark::DoNotOptimize(dst->data[0]);
+  }
+
+  ReportCounters(state, state.iterations(), nullptr);
+  state.SetLabel(std::string(av_get_pix_fmt_name(src_format)) + "->" +
+                 av_get_pix_fmt_name(dst_format));
+}
+
+void PixelFormatPairs(benchmark::internal::Benchmark* b) {
+  for (int src = 0; src < kPixelFormatCount; ++src) {
+    for (int dst = 0; dst < kPixelFormatCount; ++dst) {
+      if (kPixelFormats[src] != kPixelFormats[dst]) {
+        b->Args({src, dst});
+      }
+    }
+  }
+}
+BENCHMARK(BM_Pipeline_PixelFormatMatrix)
+    ->Apply(PixelFormatPairs)
+    ->MinTime(0.1);
+
+}  // namespace
@@ -9,6 +9,10 @@
  * - Concurrent producer-consumer throughput
  * - Peek/PopFront vs TryDequeue patterns
  * - Queue size impact on performance
+ * - Blocking wakeup latency
+ *
+ * Every benchmark runs against both the mutex-based ControlMessageQueue
+ * (<LockedQueue>) and the lock-free SpscControlMessageQueue (<SpscQueue>).
  *
  * Run with: make run_benchmarks
  */
@@ -19,6 +23,7 @@
 #include <vector>
 
 #include "src/shared/control_message_queue.h"
+#include "src/shared/spsc_control_queue.h"
 #include "test_utils.h"
 
 using namespace webcodecs;
@@ -26,9 +31,41 @@ using namespace webcodecs::testing;
 
 namespace {
 
-using VideoQueue = VideoControlQueue;
-using DecodeMessage = VideoQueue::DecodeMessage;
-using FlushMessage = VideoQueue::FlushMessage;
+using LockedQueue = VideoControlQueue;
+using DecodeMessage = LockedQueue::DecodeMessage;
+using FlushMessage = LockedQueue::FlushMessage;
+
+// Large enough for every pre-fill below.
+class SpscQueue : public VideoSpscControlQueue {
+ public:
+  SpscQueue() : VideoSpscControlQueue(16384) {}
+};
+
+// Enqueue into a queue that may be bounded, draining it when full so
+// enqueue-only loops keep measuring enqueues.
+template <typename Queue>
+bool EnqueueDraining(Queue* queue, DecodeMessage msg,
+                     benchmark::State* state) {
+  if (queue->Enqueue(std::move(msg))) {
+    return true;
+  }
+  state->PauseTiming();
+  while (queue->TryDequeue().has_value()) {
+  }
+  state->ResumeTiming();
+  DecodeMessage retry;
+  retry.packet = CreateEmptyPacket();
+  return queue->Enqueue(std::move(retry));
+}
+
+template <typename Queue>
+void Fill(Queue* queue, int count) {
+  for (int i = 0; i < count; ++i) {
+    DecodeMessage msg;
+    msg.packet = CreateEmptyPacket();
+    (void)queue->Enqueue(std::move(msg));
+  }
+}
 
 // =============================================================================
 // SINGLE-THREADED THROUGHPUT
@@ -38,13 +75,14 @@ using FlushMessage = VideoQueue::FlushMessage;
  * Benchmark: Enqueue throughput (messages/sec).
  * Measures raw enqueue performance without dequeue.
  */
+template <typename Queue>
 static void BM_Enqueue_SingleThread(benchmark::State& state) {
-  VideoQueue queue;
+  Queue queue;
 
   for (auto _ : state) {
     DecodeMessage msg;
     msg.packet = CreateEmptyPacket();
-    benchmark::DoNotOptimize(queue.Enqueue(std::move(msg)));
+    benchmark::DoNotOptimize(EnqueueDraining(&queue, std::move(msg), &state));
   }
 
   // Cleanup
@@ -53,22 +91,20 @@ static void BM_Enqueue_SingleThread(benchmark::State& state) {
   state.SetItemsProcessed(state.iterations());
   state.SetLabel("messages/sec");
 }
-BENCHMARK(BM_Enqueue_SingleThread);
+BENCHMARK_TEMPLATE(BM_Enqueue_SingleThread, LockedQueue);
+BENCHMARK_TEMPLATE(BM_Enqueue_SingleThread, SpscQueue);
 
 /**
  * Benchmark: Dequeue throughput (messages/sec).
  * Measures raw dequeue performance with pre-filled queue.
  */
+template <typename Queue>
 static void BM_Dequeue_SingleThread(benchmark::State& state) {
-  VideoQueue queue;
+  Queue queue;
   const int kPreFill = 10000;
 
   // Pre-fill queue
-  for (int i = 0; i < kPreFill; ++i) {
-    DecodeMessage msg;
-    msg.packet = CreateEmptyPacket();
-    queue.Enqueue(std::move(msg));
-  }
+  Fill(&queue, kPreFill);
 
   int dequeued = 0;
   for (auto _ : state) {
@@ -78,11 +114,7 @@ static void BM_Dequeue_SingleThread(benchmark::State& state) {
       dequeued++;
     } else {
       // Refill when empty
-      for (int i = 0; i < kPreFill; ++i) {
-        DecodeMessage refill_msg;
-        refill_msg.packet = CreateEmptyPacket();
-        queue.Enqueue(std::move(refill_msg));
-      }
+      Fill(&queue, kPreFill);
     }
   }
 
@@ -91,19 +123,21 @@ static void BM_Dequeue_SingleThread(benchmark::State& state) {
   state.SetItemsProcessed(dequeued);
   state.SetLabel("messages/sec");
 }
-BENCHMARK(BM_Dequeue_SingleThread);
+BENCHMARK_TEMPLATE(BM_Dequeue_SingleThread, LockedQueue);
+BENCHMARK_TEMPLATE(BM_Dequeue_SingleThread, SpscQueue);
 
 /**
  * Benchmark: Enqueue + Dequeue roundtrip.
  * Measures full cycle latency.
  */
+template <typename Queue>
 static void BM_EnqueueDequeue_Roundtrip(benchmark::State& state) {
-  VideoQueue queue;
+  Queue queue;
 
   for (auto _ : state) {
     DecodeMessage msg;
     msg.packet = CreateEmptyPacket();
-    queue.Enqueue(std::move(msg));
+    (void)queue.Enqueue(std::move(msg));
 
     auto dequeued = queue.TryDequeue();
     benchmark::DoNotOptimize(dequeued);
@@ -114,7 +148,8 @@ static void BM_EnqueueDequeue_Roundtrip(benchmark::State& state) {
   state.SetItemsProcessed(state.iterations());
   state.SetLabel("roundtrips/sec");
 }
-BENCHMARK(BM_EnqueueDequeue_Roundtrip);
+BENCHMARK_TEMPLATE(BM_EnqueueDequeue_Roundtrip, LockedQueue);
+BENCHMARK_TEMPLATE(BM_EnqueueDequeue_Roundtrip, SpscQueue);
 
 // =============================================================================
 // PEEK/POPFRONT VS TRYDEQUEUE
@@ -123,16 +158,13 @@ BENCHMARK(BM_EnqueueDequeue_Roundtrip);
 /**
  * Benchmark: TryDequeue pattern (atomic).
  */
+template <typename Queue>
 static void BM_TryDequeue_Pattern(benchmark::State& state) {
-  VideoQueue queue;
+  Queue queue;
   const int kPreFill = 10000;
 
   // Pre-fill
-  for (int i = 0; i < kPreFill; ++i) {
-    DecodeMessage msg;
-    msg.packet = CreateEmptyPacket();
-    queue.Enqueue(std::move(msg));
-  }
+  Fill(&queue, kPreFill);
 
   int processed = 0;
   for (auto _ : state) {
@@ -144,11 +176,7 @@ static void BM_TryDequeue_Pattern(benchmark::State& state) {
 
     // Refill when empty
     if (queue.empty()) {
-      for (int i = 0; i < kPreFill; ++i) {
-        DecodeMessage refill_msg;
-        refill_msg.packet = CreateEmptyPacket();
-        queue.Enqueue(std::move(refill_msg));
-      }
+      Fill(&queue, kPreFill);
     }
   }
 
@@ -157,22 +185,20 @@ static void BM_TryDequeue_Pattern(benchmark::State& state) {
   state.SetItemsProcessed(processed);
   state.SetLabel("messages/sec");
 }
-BENCHMARK(BM_TryDequeue_Pattern);
+BENCHMARK_TEMPLATE(BM_TryDequeue_Pattern, LockedQueue);
+BENCHMARK_TEMPLATE(BM_TryDequeue_Pattern, SpscQueue);
 
 /**
  * Benchmark: Peek + PopFront pattern.
- * Should be slower than TryDequeue (two mutex locks).
+ * Should be slower than TryDequeue (two mutex locks on LockedQueue).
  */
+template <typename Queue>
 static void BM_PeekPopFront_Pattern(benchmark::State& state) {
-  VideoQueue queue;
+  Queue queue;
   const int kPreFill = 10000;
 
   // Pre-fill
-  for (int i = 0; i < kPreFill; ++i) {
-    DecodeMessage msg;
-    msg.packet = CreateEmptyPacket();
-    queue.Enqueue(std::move(msg));
-  }
+  Fill(&queue, kPreFill);
 
   int processed = 0;
   for (auto _ : state) {
@@ -185,11 +211,7 @@ static void BM_PeekPopFront_Pattern(benchmark::State& state) {
 
     // Refill when empty
     if (queue.empty()) {
-      for (int i = 0; i < kPreFill; ++i) {
-        DecodeMessage refill_msg;
-        refill_msg.packet = CreateEmptyPacket();
-        queue.Enqueue(std::move(refill_msg));
-      }
+      Fill(&queue, kPreFill);
     }
   }
 
@@ -198,7 +220,8 @@ static void BM_PeekPopFront_Pattern(benchmark::State& state) {
   state.SetItemsProcessed(processed);
   state.SetLabel("messages/sec");
 }
-BENCHMARK(BM_PeekPopFront_Pattern);
+BENCHMARK_TEMPLATE(BM_PeekPopFront_Pattern, LockedQueue);
+BENCHMARK_TEMPLATE(BM_PeekPopFront_Pattern, SpscQueue);
 
 // =============================================================================
 // QUEUE SIZE IMPACT
@@ -208,16 +231,13 @@ BENCHMARK(BM_PeekPopFront_Pattern);
  * Benchmark: Dequeue performance with varying queue sizes.
  * Tests if large queue size impacts dequeue speed.
  */
+template <typename Queue>
 static void BM_Dequeue_VaryingSize(benchmark::State& state) {
-  VideoQueue queue;
+  Queue queue;
   const int queue_size = state.range(0);
 
   // Fill queue to target size
-  for (int i = 0; i < queue_size; ++i) {
-    DecodeMessage msg;
-    msg.packet = CreateEmptyPacket();
-    queue.Enqueue(std::move(msg));
-  }
+  Fill(&queue, queue_size);
 
   int dequeued = 0;
   for (auto _ : state) {
@@ -230,7 +250,7 @@ static void BM_Dequeue_VaryingSize(benchmark::State& state) {
       // Enqueue one to maintain size
       DecodeMessage refill_msg;
       refill_msg.packet = CreateEmptyPacket();
-      queue.Enqueue(std::move(refill_msg));
+      (void)queue.Enqueue(std::move(refill_msg));
     }
   }
 
@@ -239,11 +259,16 @@ static void BM_Dequeue_VaryingSize(benchmark::State& state) {
   state.SetItemsProcessed(dequeued);
   state.SetLabel("messages/sec");
 }
-BENCHMARK(BM_Dequeue_VaryingSize)
+BENCHMARK_TEMPLATE(BM_Dequeue_VaryingSize, LockedQueue)
     ->Arg(10)      // Small queue
     ->Arg(100)     // Medium queue
     ->Arg(1000)    // Large queue
     ->Arg(10000);  // Very large queue
+BENCHMARK_TEMPLATE(BM_Dequeue_VaryingSize, SpscQueue)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000);
 
 // =============================================================================
 // CONCURRENT THROUGHPUT
@@ -253,8 +278,9 @@ BENCHMARK(BM_Dequeue_VaryingSize)
  * Benchmark: Concurrent producer-consumer throughput.
  * Measures messages/sec with N producers and N consumers.
  */
+template <typename Queue>
 static void BM_ProducerConsumer_Concurrent(benchmark::State& state) {
-  VideoQueue queue;
+  Queue queue;
   const int kThreadPairs = state.range(0);
   const int kMessagesPerThread = 1000;
 
@@ -270,7 +296,10 @@ static void BM_ProducerConsumer_Concurrent(benchmark::State& state) {
         for (int j = 0; j < kMessagesPerThread; ++j) {
           DecodeMessage msg;
           msg.packet = CreateEmptyPacket();
-          queue.Enqueue(std::move(msg));
+          while (!queue.Enqueue(std::move(msg))) {
+            msg.packet = CreateEmptyPacket();  // Full: retry
+            std::this_thread::yield();
+          }
           produced.fetch_add(1);
         }
       });
@@ -310,11 +339,46 @@ static void BM_ProducerConsumer_Concurrent(benchmark::State& state) {
   state.SetItemsProcessed(state.iterations() * total_messages);
   state.SetLabel("messages/sec");
 }
-BENCHMARK(BM_ProducerConsumer_Concurrent)
+BENCHMARK_TEMPLATE(BM_ProducerConsumer_Concurrent, LockedQueue)
     ->Arg(1)   // 1 producer, 1 consumer
     ->Arg(2)   // 2 producers, 2 consumers
     ->Arg(4)   // 4 producers, 4 consumers
     ->Arg(8);  // 8 producers, 8 consumers
+// Single producer, single consumer only.
+BENCHMARK_TEMPLATE(BM_ProducerConsumer_Concurrent, SpscQueue)->Arg(1);
+
+/**
+ * Benchmark: Blocking wakeup round trip.
+ * The main thread enqueues one message and waits for the echo from a
+ * worker blocked in Dequeue(), as a codec worker waits for input.
+ */
+template <typename Queue>
+static void BM_PingPong_BlockingDequeue(benchmark::State& state) {
+  Queue to_worker;
+  Queue to_main;
+
+  std::thread worker([&]() {
+    while (auto msg = to_worker.Dequeue()) {
+      (void)to_main.Enqueue(std::move(*msg));
+    }
+  });
+
+  for (auto _ : state) {
+    FlushMessage msg;
+    msg.promise_id = 1;
+    (void)to_worker.Enqueue(std::move(msg));
+    auto echo = to_main.Dequeue();
+    benchmark::DoNotOptimize(echo);
+  }
+
+  to_worker.Shutdown();
+  worker.join();
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel("roundtrips/sec");
+}
+BENCHMARK_TEMPLATE(BM_PingPong_BlockingDequeue, LockedQueue)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PingPong_BlockingDequeue, SpscQueue)->UseRealTime();
 
 // =============================================================================
 // MESSAGE TYPE OVERHEAD
@@ -324,13 +388,14 @@ BENCHMARK(BM_ProducerConsumer_Concurrent)
  * Benchmark: Different message types (decode vs flush).
  * Measures if variant size impacts performance.
  */
+template <typename Queue>
 static void BM_Enqueue_DecodeMessage(benchmark::State& state) {
-  VideoQueue queue;
+  Queue queue;
 
   for (auto _ : state) {
     DecodeMessage msg;
     msg.packet = CreateEmptyPacket();
-    benchmark::DoNotOptimize(queue.Enqueue(std::move(msg)));
+    benchmark::DoNotOptimize(EnqueueDraining(&queue, std::move(msg), &state));
   }
 
   queue.Shutdown();
@@ -338,15 +403,22 @@ static void BM_Enqueue_DecodeMessage(benchmark::State& state) {
   state.SetItemsProcessed(state.iterations());
   state.SetLabel("messages/sec");
 }
-BENCHMARK(BM_Enqueue_DecodeMessage);
+BENCHMARK_TEMPLATE(BM_Enqueue_DecodeMessage, LockedQueue);
+BENCHMARK_TEMPLATE(BM_Enqueue_DecodeMessage, SpscQueue);
 
+template <typename Queue>
 static void BM_Enqueue_FlushMessage(benchmark::State& state) {
-  VideoQueue queue;
+  Queue queue;
 
   for (auto _ : state) {
     FlushMessage msg;
     msg.promise_id = 42;
-    benchmark::DoNotOptimize(queue.Enqueue(std::move(msg)));
+    if (!queue.Enqueue(std::move(msg))) {
+      state.PauseTiming();
+      while (queue.TryDequeue().has_value()) {
+      }
+      state.ResumeTiming();
+    }
   }
 
   queue.Shutdown();
@@ -354,6 +426,7 @@ static void BM_Enqueue_FlushMessage(benchmark::State& state) {
   state.SetItemsProcessed(state.iterations());
   state.SetLabel("messages/sec");
 }
-BENCHMARK(BM_Enqueue_FlushMessage);
+BENCHMARK_TEMPLATE(BM_Enqueue_FlushMessage, LockedQueue);
+BENCHMARK_TEMPLATE(BM_Enqueue_FlushMessage, SpscQueue);
 
 }  // namespace
@@ -114,6 +114,20 @@ TEST(FFmpegRAIITest, AVFilterGraphPtr_CreateAndDestroy) {
   // Graph will be automatically freed when going out of scope
 }
 
+// Test that AVAudioFifoPtr properly manages AVAudioFifo lifecycle
+TEST(FFmpegRAIITest, AVAudioFifoPtr_CreateAndDestroy) {
+  ffmpeg::AVAudioFifoPtr fifo(av_audio_fifo_alloc(AV_SAMPLE_FMT_FLTP, 2, 1024));
+  ASSERT_NE(fifo.get(), nullptr);
+
+  float left[480] = {0};
+  float right[480] = {0};
+  void* planes[] = {left, right};
+  EXPECT_EQ(av_audio_fifo_write(fifo.get(), planes, 480), 480);
+  EXPECT_EQ(av_audio_fifo_size(fifo.get()), 480);
+
+  // FIFO will be automatically freed when going out of scope
+}
+
 // Test nullptr handling
 TEST(FFmpegRAIITest, NullptrHandling) {
   // All deleters should handle nullptr gracefully
@@ -122,7 +136,9 @@ TEST(FFmpegRAIITest, NullptrHandling) {
   ffmpeg::AVCodecContextPtr null_ctx(nullptr);
   ffmpeg::SwsContextPtr null_sws(nullptr);
   ffmpeg::AVFilterGraphPtr null_graph(nullptr);
+  ffmpeg::AVAudioFifoPtr null_fifo(nullptr);
 
+  EXPECT_EQ(null_fifo.get(), nullptr);
   EXPECT_EQ(null_frame.get(), nullptr);
   EXPECT_EQ(null_packet.get(), nullptr);
   EXPECT_EQ(null_ctx.get(), nullptr);
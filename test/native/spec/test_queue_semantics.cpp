@@ -12,6 +12,9 @@
 // 3. "not processed" messages remain in queue and retry later
 // 4. [[message queue blocked]] pauses processing
 // 5. Configure operations block the queue
+//
+// Every test runs against both ControlMessageQueue and the lock-free
+// SpscControlMessageQueue.
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -25,6 +28,7 @@
 #include <vector>
 
 #include "src/shared/control_message_queue.h"
+#include "src/shared/spsc_control_queue.h"
 #include "test_utils.h"
 
 using namespace webcodecs;
@@ -45,6 +49,7 @@ using namespace webcodecs::testing;
  *    c. If outcome = "not processed", break
  *    d. If outcome = "processed", dequeue message
  */
+template <typename Queue>
 class QueueProcessor {
  public:
   enum class Outcome {
@@ -60,7 +65,7 @@ class QueueProcessor {
     int retry_count = 0;
   };
 
-  explicit QueueProcessor(VideoControlQueue* queue)
+  explicit QueueProcessor(Queue* queue)
       : queue_(queue), blocked_(false), saturated_(false) {}
 
   /**
@@ -136,7 +141,7 @@ class QueueProcessor {
     return Outcome::kProcessed;
   }
 
-  VideoControlQueue* queue_;
+  Queue* queue_;
   std::atomic<bool> blocked_;
   std::atomic<bool> saturated_;
 };
@@ -145,97 +150,101 @@ class QueueProcessor {
 // TEST FIXTURE
 // =============================================================================
 
+template <typename Queue>
 class QueueSemanticsTest : public ::testing::Test {
  protected:
   void SetUp() override {
-    processor_ = std::make_unique<QueueProcessor>(&queue_);
+    processor_ = std::make_unique<QueueProcessor<Queue>>(&queue_);
   }
 
-  VideoControlQueue queue_;
-  std::unique_ptr<QueueProcessor> processor_;
+  Queue queue_;
+  std::unique_ptr<QueueProcessor<Queue>> processor_;
 };
 
+using QueueTypes = ::testing::Types<VideoControlQueue, VideoSpscControlQueue>;
+TYPED_TEST_SUITE(QueueSemanticsTest, QueueTypes);
+
 // =============================================================================
 // HAPPY PATH TESTS - QUEUE PROCESSING
 // =============================================================================
 
-TEST_F(QueueSemanticsTest, ProcessQueue_WhenEmpty_ReturnsZero) {
-  int processed = processor_->ProcessQueue();
+TYPED_TEST(QueueSemanticsTest, ProcessQueue_WhenEmpty_ReturnsZero) {
+  int processed = this->processor_->ProcessQueue();
 
   EXPECT_EQ(processed, 0);
 }
 
-TEST_F(QueueSemanticsTest, ProcessQueue_SingleMessage_ProcessesOne) {
+TYPED_TEST(QueueSemanticsTest, ProcessQueue_SingleMessage_ProcessesOne) {
   VideoControlQueue::ConfigureMessage msg;
   msg.configure_fn = []() { return true; };
-  queue_.Enqueue(msg);
+  this->queue_.Enqueue(msg);
 
-  int processed = processor_->ProcessQueue();
+  int processed = this->processor_->ProcessQueue();
 
   EXPECT_EQ(processed, 1);
-  EXPECT_TRUE(queue_.empty());
+  EXPECT_TRUE(this->queue_.empty());
 }
 
-TEST_F(QueueSemanticsTest, ProcessQueue_MultipleMessages_ProcessesAllFIFO) {
+TYPED_TEST(QueueSemanticsTest, ProcessQueue_MultipleMessages_ProcessesAllFIFO) {
   // Enqueue 5 messages
   for (int i = 0; i < 5; ++i) {
     VideoControlQueue::FlushMessage msg;
     msg.promise_id = i;
-    queue_.Enqueue(msg);
+    this->queue_.Enqueue(msg);
   }
 
-  int processed = processor_->ProcessQueue();
+  int processed = this->processor_->ProcessQueue();
 
   // Per spec 2.2: all messages processed in FIFO order
   EXPECT_EQ(processed, 5);
-  EXPECT_TRUE(queue_.empty());
+  EXPECT_TRUE(this->queue_.empty());
 }
 
-TEST_F(QueueSemanticsTest, ProcessQueue_WhenBlocked_ProcessesZero) {
+TYPED_TEST(QueueSemanticsTest, ProcessQueue_WhenBlocked_ProcessesZero) {
   VideoControlQueue::ConfigureMessage msg;
   msg.configure_fn = []() { return true; };
-  queue_.Enqueue(msg);
+  this->queue_.Enqueue(msg);
 
   // Set blocked per spec
-  processor_->SetBlocked(true);
+  this->processor_->SetBlocked(true);
 
-  int processed = processor_->ProcessQueue();
+  int processed = this->processor_->ProcessQueue();
 
   // Per spec 2.2: while [[message queue blocked]] is false
   EXPECT_EQ(processed, 0);
-  EXPECT_FALSE(queue_.empty());  // Message remains in queue
+  EXPECT_FALSE(this->queue_.empty());  // Message remains in queue
 }
 
-TEST_F(QueueSemanticsTest, ProcessQueue_AfterUnblock_ProcessesMessages) {
+TYPED_TEST(QueueSemanticsTest, ProcessQueue_AfterUnblock_ProcessesMessages) {
   VideoControlQueue::ConfigureMessage msg;
   msg.configure_fn = []() { return true; };
-  queue_.Enqueue(msg);
+  this->queue_.Enqueue(msg);
 
-  processor_->SetBlocked(true);
-  int processed1 = processor_->ProcessQueue();
+  this->processor_->SetBlocked(true);
+  int processed1 = this->processor_->ProcessQueue();
   EXPECT_EQ(processed1, 0);
 
   // Unblock and reprocess per spec
-  processor_->SetBlocked(false);
-  int processed2 = processor_->ProcessQueue();
+  this->processor_->SetBlocked(false);
+  int processed2 = this->processor_->ProcessQueue();
 
   EXPECT_EQ(processed2, 1);
-  EXPECT_TRUE(queue_.empty());
+  EXPECT_TRUE(this->queue_.empty());
 }
 
 // =============================================================================
 // "NOT PROCESSED" SEMANTICS TESTS
 // =============================================================================
 
-TEST_F(QueueSemanticsTest, ProcessQueue_WhenSaturated_ReturnsNotProcessed) {
+TYPED_TEST(QueueSemanticsTest, ProcessQueue_WhenSaturated_ReturnsNotProcessed) {
   VideoControlQueue::DecodeMessage msg;
   msg.packet = ffmpeg::make_packet();
-  queue_.Enqueue(std::move(msg));
+  this->queue_.Enqueue(std::move(msg));
 
   // Simulate codec saturation
-  processor_->SetSaturated(true);
+  this->processor_->SetSaturated(true);
 
-  int processed = processor_->ProcessQueue();
+  int processed = this->processor_->ProcessQueue();
 
   // Per spec: "not processed" stops queue processing
   EXPECT_EQ(processed, 0);
@@ -245,56 +254,56 @@ TEST_F(QueueSemanticsTest, ProcessQueue_WhenSaturated_ReturnsNotProcessed) {
  * Per W3C spec: "not processed" messages should remain in queue for retry.
  * Tests Peek()/PopFront() pattern for proper retry behavior.
  */
-TEST_F(QueueSemanticsTest,
-       ProcessQueue_NotProcessed_MessageRemainsForRetry) {
+TYPED_TEST(QueueSemanticsTest,
+           ProcessQueue_NotProcessed_MessageRemainsForRetry) {
   VideoControlQueue::DecodeMessage msg1;
   msg1.packet = ffmpeg::make_packet();
-  queue_.Enqueue(std::move(msg1));
+  this->queue_.Enqueue(std::move(msg1));
 
   VideoControlQueue::DecodeMessage msg2;
   msg2.packet = ffmpeg::make_packet();
-  queue_.Enqueue(std::move(msg2));
+  this->queue_.Enqueue(std::move(msg2));
 
   // First message returns "not processed" (saturated)
-  processor_->SetSaturated(true);
-  int processed1 = processor_->ProcessQueue();
+  this->processor_->SetSaturated(true);
+  int processed1 = this->processor_->ProcessQueue();
 
   EXPECT_EQ(processed1, 0);
 
   // Per spec: Both messages remain in queue (Peek doesn't remove)
-  EXPECT_EQ(queue_.size(), 2u);
+  EXPECT_EQ(this->queue_.size(), 2u);
 
   // Desaturate and retry
-  processor_->SetSaturated(false);
-  int processed2 = processor_->ProcessQueue();
+  this->processor_->SetSaturated(false);
+  int processed2 = this->processor_->ProcessQueue();
 
   // Now both messages process successfully
   EXPECT_EQ(processed2, 2);
-  EXPECT_TRUE(queue_.empty());
+  EXPECT_TRUE(this->queue_.empty());
 }
 
 /**
  * Per spec 2.2: When first message returns "not processed", processing
  * stops and ALL messages remain in queue.
  */
-TEST_F(QueueSemanticsTest,
-       ProcessQueue_NotProcessed_BlocksSubsequentMessages) {
+TYPED_TEST(QueueSemanticsTest,
+           ProcessQueue_NotProcessed_BlocksSubsequentMessages) {
   // Enqueue 3 messages
   for (int i = 0; i < 3; ++i) {
     VideoControlQueue::DecodeMessage msg;
     msg.packet = ffmpeg::make_packet();
-    queue_.Enqueue(std::move(msg));
+    this->queue_.Enqueue(std::move(msg));
   }
 
   // First message returns "not processed"
-  processor_->SetSaturated(true);
-  int processed = processor_->ProcessQueue();
+  this->processor_->SetSaturated(true);
+  int processed = this->processor_->ProcessQueue();
 
   // Per spec 2.2 step 3: "If outcome equals 'not processed', break"
   EXPECT_EQ(processed, 0);
 
   // All 3 messages remain in queue (Peek doesn't remove)
-  EXPECT_EQ(queue_.size(), 3u);
+  EXPECT_EQ(this->queue_.size(), 3u);
 }
 
 // =============================================================================
@@ -305,7 +314,7 @@ TEST_F(QueueSemanticsTest,
  * Per spec: Configure operations block the queue.
  * Simulates configure blocking until completion.
  */
-TEST_F(QueueSemanticsTest, Configure_BlocksQueue_UntilComplete) {
+TYPED_TEST(QueueSemanticsTest, Configure_BlocksQueue_UntilComplete) {
   SimpleLatch configure_started;
   SimpleLatch configure_can_complete;
   std::atomic<bool> configure_completed{false};
@@ -321,37 +330,37 @@ TEST_F(QueueSemanticsTest, Configure_BlocksQueue_UntilComplete) {
     configure_completed.store(true);
     return true;
   };
-  queue_.Enqueue(configure_msg);
+  this->queue_.Enqueue(configure_msg);
 
   // Enqueue encode message after configure
   VideoControlQueue::EncodeMessage encode_msg;
   encode_msg.frame = CreateTestFrame(320, 240);
-  queue_.Enqueue(std::move(encode_msg));
+  this->queue_.Enqueue(std::move(encode_msg));
 
   // Process queue in background
   std::thread processor_thread([&]() {
     // Block queue during configure per spec
-    processor_->SetBlocked(true);
+    this->processor_->SetBlocked(true);
 
     // Dequeue and execute configure
-    auto msg = queue_.Dequeue();
+    auto msg = this->queue_.Dequeue();
     auto* config = std::get_if<VideoControlQueue::ConfigureMessage>(&*msg);
     if (config) {
       config->configure_fn();
     }
 
     // Unblock queue after configure per spec
-    processor_->SetBlocked(false);
+    this->processor_->SetBlocked(false);
 
     // Process remaining messages
-    processor_->ProcessQueue();
+    this->processor_->ProcessQueue();
   });
 
   // Wait for configure to start
   ASSERT_TRUE(configure_started.Wait());
 
   // Queue should be blocked, encode message not processed yet
-  EXPECT_TRUE(processor_->IsBlocked());
+  EXPECT_TRUE(this->processor_->IsBlocked());
 
   // Allow configure to complete
   configure_can_complete.Signal();
@@ -359,8 +368,8 @@ TEST_F(QueueSemanticsTest, Configure_BlocksQueue_UntilComplete) {
   processor_thread.join();
 
   EXPECT_TRUE(configure_completed.load());
-  EXPECT_FALSE(processor_->IsBlocked());
-  EXPECT_TRUE(queue_.empty());  // Both messages processed
+  EXPECT_FALSE(this->processor_->IsBlocked());
+  EXPECT_TRUE(this->queue_.empty());  // Both messages processed
 }
 
 // =============================================================================
@@ -371,19 +380,19 @@ TEST_F(QueueSemanticsTest, Configure_BlocksQueue_UntilComplete) {
  * Test exact algorithm from spec 2.2:
  * "While [[message queue blocked]] is false AND queue is not empty"
  */
-TEST_F(QueueSemanticsTest, Spec_ProcessingAlgorithm_ExactSemantics) {
+TYPED_TEST(QueueSemanticsTest, Spec_ProcessingAlgorithm_ExactSemantics) {
   std::vector<int> processed_ids;
 
   // Enqueue 10 messages
   for (int i = 0; i < 10; ++i) {
     VideoControlQueue::FlushMessage msg;
     msg.promise_id = i;
-    queue_.Enqueue(msg);
+    this->queue_.Enqueue(msg);
   }
 
   // Process first 5
   for (int i = 0; i < 5; ++i) {
-    auto msg = queue_.Dequeue();
+    auto msg = this->queue_.Dequeue();
     if (msg.has_value()) {
       auto* flush = std::get_if<VideoControlQueue::FlushMessage>(&*msg);
       if (flush) {
@@ -393,16 +402,16 @@ TEST_F(QueueSemanticsTest, Spec_ProcessingAlgorithm_ExactSemantics) {
   }
 
   // Block queue
-  processor_->SetBlocked(true);
+  this->processor_->SetBlocked(true);
 
   // Try to process remaining - should process 0
-  int processed = processor_->ProcessQueue();
+  int processed = this->processor_->ProcessQueue();
   EXPECT_EQ(processed, 0);
 
   // Unblock and process remaining 5
-  processor_->SetBlocked(false);
+  this->processor_->SetBlocked(false);
   for (int i = 0; i < 5; ++i) {
-    auto msg = queue_.Dequeue();
+    auto msg = this->queue_.Dequeue();
     if (msg.has_value()) {
       auto* flush = std::get_if<VideoControlQueue::FlushMessage>(&*msg);
       if (flush) {
@@ -422,56 +431,56 @@ TEST_F(QueueSemanticsTest, Spec_ProcessingAlgorithm_ExactSemantics) {
  * Per spec: "not processed" messages stay in queue and retry.
  * Test retry behavior with saturation using Peek()/PopFront().
  */
-TEST_F(QueueSemanticsTest, Spec_NotProcessed_RetryBehavior) {
+TYPED_TEST(QueueSemanticsTest, Spec_NotProcessed_RetryBehavior) {
   VideoControlQueue::DecodeMessage msg;
   msg.packet = ffmpeg::make_packet();
-  bool enqueued = queue_.Enqueue(std::move(msg));
+  bool enqueued = this->queue_.Enqueue(std::move(msg));
   EXPECT_TRUE(enqueued);
 
   // First attempt: saturated, returns "not processed"
-  processor_->SetSaturated(true);
-  int processed1 = processor_->ProcessQueue();
+  this->processor_->SetSaturated(true);
+  int processed1 = this->processor_->ProcessQueue();
   EXPECT_EQ(processed1, 0);
 
   // Message remains in queue per spec (Peek doesn't remove)
-  EXPECT_EQ(queue_.size(), 1u);
+  EXPECT_EQ(this->queue_.size(), 1u);
 
   // Second attempt: desaturated, returns "processed"
-  processor_->SetSaturated(false);
-  int processed2 = processor_->ProcessQueue();
+  this->processor_->SetSaturated(false);
+  int processed2 = this->processor_->ProcessQueue();
 
   // Message now processes successfully
   EXPECT_EQ(processed2, 1);
-  EXPECT_TRUE(queue_.empty());
+  EXPECT_TRUE(this->queue_.empty());
 }
 
 /**
  * Test queue size tracking with blocked processing.
  * Per spec 3.5: queue size increments before, decrements during processing.
  */
-TEST_F(QueueSemanticsTest, Spec_QueueSize_IncrementBeforeDecrementDuring) {
+TYPED_TEST(QueueSemanticsTest, Spec_QueueSize_IncrementBeforeDecrementDuring) {
   std::vector<size_t> queue_sizes;
 
   // Enqueue 3 messages, record size after each
   for (int i = 0; i < 3; ++i) {
     VideoControlQueue::DecodeMessage msg;
     msg.packet = ffmpeg::make_packet();
-    bool enqueued = queue_.Enqueue(std::move(msg));
+    bool enqueued = this->queue_.Enqueue(std::move(msg));
     EXPECT_TRUE(enqueued);
 
     // Per spec: size increments BEFORE processing
-    queue_sizes.push_back(queue_.size());
+    queue_sizes.push_back(this->queue_.size());
   }
 
   EXPECT_THAT(queue_sizes, ::testing::ElementsAre(1, 2, 3));
 
   // Process messages, record size after each
   queue_sizes.clear();
-  while (!queue_.empty()) {
-    auto msg = queue_.Dequeue();
+  while (!this->queue_.empty()) {
+    auto msg = this->queue_.Dequeue();
 
     // Per spec: size decrements DURING processing (after dequeue)
-    queue_sizes.push_back(queue_.size());
+    queue_sizes.push_back(this->queue_.size());
   }
 
   EXPECT_THAT(queue_sizes, ::testing::ElementsAre(2, 1, 0));
@@ -485,7 +494,7 @@ TEST_F(QueueSemanticsTest, Spec_QueueSize_IncrementBeforeDecrementDuring) {
  * Test queue blocking under concurrent pressure.
  * Verifies blocked flag prevents race conditions.
  */
-TEST_F(QueueSemanticsTest, Concurrent_BlockedFlag_PreventsRaces) {
+TYPED_TEST(QueueSemanticsTest, Concurrent_BlockedFlag_PreventsRaces) {
   std::atomic<int> processed_count{0};
   std::atomic<bool> stop{false};
 
@@ -494,7 +503,7 @@ TEST_F(QueueSemanticsTest, Concurrent_BlockedFlag_PreventsRaces) {
     for (int i = 0; i < 100; ++i) {
       VideoControlQueue::FlushMessage msg;
       msg.promise_id = i;
-      queue_.Enqueue(msg);
+      this->queue_.Enqueue(msg);
       std::this_thread::sleep_for(std::chrono::microseconds(100));
     }
   });
@@ -504,10 +513,10 @@ TEST_F(QueueSemanticsTest, Concurrent_BlockedFlag_PreventsRaces) {
     while (!stop.load()) {
       // Randomly block/unblock
       bool should_block = (processed_count.load() % 5 == 0);
-      processor_->SetBlocked(should_block);
+      this->processor_->SetBlocked(should_block);
 
       if (!should_block) {
-        int count = processor_->ProcessQueue();
+        int count = this->processor_->ProcessQueue();
         processed_count.fetch_add(count);
       }
 
@@ -522,9 +531,9 @@ TEST_F(QueueSemanticsTest, Concurrent_BlockedFlag_PreventsRaces) {
   consumer.join();
 
   // Final processing (no concurrent threads now)
-  processor_->SetBlocked(false);
-  while (!queue_.empty()) {
-    int count = processor_->ProcessQueue();
+  this->processor_->SetBlocked(false);
+  while (!this->queue_.empty()) {
+    int count = this->processor_->ProcessQueue();
     processed_count.fetch_add(count);
   }
 
@@ -535,7 +544,7 @@ TEST_F(QueueSemanticsTest, Concurrent_BlockedFlag_PreventsRaces) {
 /**
  * Test that blocked flag is atomic and thread-safe.
  */
-TEST_F(QueueSemanticsTest, Concurrent_BlockedFlag_Atomic) {
+TYPED_TEST(QueueSemanticsTest, Concurrent_BlockedFlag_Atomic) {
   std::vector<std::thread> threads;
   std::atomic<bool> stop{false};
 
@@ -543,8 +552,8 @@ TEST_F(QueueSemanticsTest, Concurrent_BlockedFlag_Atomic) {
   for (int i = 0; i < 10; ++i) {
     threads.emplace_back([&, i]() {
       while (!stop.load()) {
-        processor_->SetBlocked(i % 2 == 0);
-        bool is_blocked = processor_->IsBlocked();
+        this->processor_->SetBlocked(i % 2 == 0);
+        bool is_blocked = this->processor_->IsBlocked();
         (void)is_blocked;  // Prevent unused warning
       }
     });
@@ -569,7 +578,7 @@ TEST_F(QueueSemanticsTest, Concurrent_BlockedFlag_Atomic) {
  * Full workflow: configure blocks, then encode processes.
  * Simulates real VideoEncoder usage.
  */
-TEST_F(QueueSemanticsTest, Integration_ConfigureThenEncode_Workflow) {
+TYPED_TEST(QueueSemanticsTest, Integration_ConfigureThenEncode_Workflow) {
   std::atomic<bool> configured{false};
   std::atomic<int> encoded_count{0};
 
@@ -579,18 +588,18 @@ TEST_F(QueueSemanticsTest, Integration_ConfigureThenEncode_Workflow) {
     configured.store(true);
     return true;
   };
-  queue_.Enqueue(config_msg);
+  this->queue_.Enqueue(config_msg);
 
   // Enqueue 5 encode messages
   for (int i = 0; i < 5; ++i) {
     VideoControlQueue::EncodeMessage encode_msg;
     encode_msg.frame = CreateTestFrame(320, 240);
-    queue_.Enqueue(std::move(encode_msg));
+    this->queue_.Enqueue(std::move(encode_msg));
   }
 
   // Process configure (blocks queue)
-  processor_->SetBlocked(true);
-  auto config = queue_.Dequeue();
+  this->processor_->SetBlocked(true);
+  auto config = this->queue_.Dequeue();
   if (config.has_value()) {
     auto* cfg = std::get_if<VideoControlQueue::ConfigureMessage>(&*config);
     if (cfg) {
@@ -601,9 +610,9 @@ TEST_F(QueueSemanticsTest, Integration_ConfigureThenEncode_Workflow) {
   EXPECT_TRUE(configured.load());
 
   // Unblock and process encode messages
-  processor_->SetBlocked(false);
-  while (!queue_.empty()) {
-    auto msg = queue_.Dequeue();
+  this->processor_->SetBlocked(false);
+  while (!this->queue_.empty()) {
+    auto msg = this->queue_.Dequeue();
     if (msg.has_value() &&
         std::holds_alternative<VideoControlQueue::EncodeMessage>(*msg)) {
       encoded_count.fetch_add(1);
@@ -612,3 +621,36 @@ TEST_F(QueueSemanticsTest, Integration_ConfigureThenEncode_Workflow) {
 
   EXPECT_EQ(encoded_count.load(), 5);
 }
+
+// =============================================================================
+// WORKER VIEW - what CodecWorker uses, through the WorkerMessageQueue base
+// =============================================================================
+
+TYPED_TEST(QueueSemanticsTest, WorkerView_DequeueDiscardAndShutdown) {
+  VideoWorkerQueue* worker_queue = &this->queue_;
+  int ready = 0;
+  worker_queue->SetReadyCallback([&]() { ++ready; });
+
+  for (uint32_t i = 0; i < 3; ++i) {
+    VideoControlQueue::FlushMessage msg;
+    msg.promise_id = i;
+    ASSERT_TRUE(worker_queue->Enqueue(msg));
+  }
+  worker_queue->SetReadyCallback(nullptr);
+  EXPECT_EQ(ready, 3);
+  EXPECT_EQ(worker_queue->size(), 3u);
+
+  auto first = worker_queue->DequeueFor(std::chrono::milliseconds(100));
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(std::get<VideoControlQueue::FlushMessage>(*first).promise_id, 0u);
+
+  // Reset drops the rest.
+  worker_queue->DiscardPending();
+  EXPECT_TRUE(worker_queue->empty());
+  EXPECT_FALSE(worker_queue->TryDequeue().has_value());
+
+  worker_queue->Shutdown();
+  EXPECT_FALSE(worker_queue->Enqueue(VideoControlQueue::CloseMessage{}));
+  EXPECT_FALSE(worker_queue->DequeueFor(std::chrono::milliseconds(10))
+                   .has_value());
+}
@@ -0,0 +1,107 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for CodecCapabilities.
+// Validates memoised codec lookups and the hardware failure window.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "src/shared/codec_capabilities.h"
+
+using namespace webcodecs;
+
+namespace {
+
+// The cache is process-wide, so every test starts from a clean one.
+class CodecCapabilitiesTest : public ::testing::Test {
+ protected:
+  void SetUp() override { capabilities_.Clear(); }
+  void TearDown() override { capabilities_.Clear(); }
+
+  CodecCapabilities& capabilities_ = CodecCapabilities::Instance();
+};
+
+// Any non-null pointer will do; the cache never dereferences it.
+const AVCodec* FakeCodec() {
+  static int storage = 0;
+  return reinterpret_cast<const AVCodec*>(&storage);
+}
+
+}  // namespace
+
+// =============================================================================
+// CODEC LOOKUP
+// =============================================================================
+
+TEST_F(CodecCapabilitiesTest, FindCodec_ProbesOncePerKey) {
+  int probes = 0;
+  auto probe = [&probes]() {
+    ++probes;
+    return FakeCodec();
+  };
+
+  EXPECT_EQ(capabilities_.FindCodec("encoder:libx264", probe), FakeCodec());
+  EXPECT_EQ(capabilities_.FindCodec("encoder:libx264", probe), FakeCodec());
+  EXPECT_EQ(probes, 1);
+
+  capabilities_.FindCodec("encoder:libx265", probe);
+  EXPECT_EQ(probes, 2);
+}
+
+TEST_F(CodecCapabilitiesTest, FindCodec_CachesMisses) {
+  int probes = 0;
+  auto probe = [&probes]() -> const AVCodec* {
+    ++probes;
+    return nullptr;
+  };
+
+  EXPECT_EQ(capabilities_.FindCodec("encoder:h264_nvenc", probe), nullptr);
+  EXPECT_EQ(capabilities_.FindCodec("encoder:h264_nvenc", probe), nullptr);
+  EXPECT_EQ(probes, 1);
+}
+
+// =============================================================================
+// HARDWARE FAILURES
+// =============================================================================
+
+TEST_F(CodecCapabilitiesTest, Hardware_UnknownIsNotFailed) {
+  EXPECT_FALSE(capabilities_.HardwareRecentlyFailed("h264_vaapi"));
+}
+
+TEST_F(CodecCapabilitiesTest, Hardware_SkippedWithinRetryInterval) {
+  auto now = CodecCapabilities::Clock::now();
+  capabilities_.MarkHardwareFailed("h264_vaapi", now);
+
+  EXPECT_TRUE(capabilities_.HardwareRecentlyFailed("h264_vaapi", now));
+  EXPECT_TRUE(capabilities_.HardwareRecentlyFailed(
+      "h264_vaapi", now + CodecCapabilities::kHardwareRetryInterval -
+                        std::chrono::seconds(1)));
+  EXPECT_FALSE(capabilities_.HardwareRecentlyFailed("h264_nvenc", now));
+}
+
+TEST_F(CodecCapabilitiesTest, Hardware_RetriedAfterInterval) {
+  auto now = CodecCapabilities::Clock::now();
+  capabilities_.MarkHardwareFailed("hwdevice:cuda", now);
+
+  auto later = now + CodecCapabilities::kHardwareRetryInterval;
+  EXPECT_FALSE(capabilities_.HardwareRecentlyFailed("hwdevice:cuda", later));
+  // Expired entries are dropped, not just ignored
+  EXPECT_FALSE(capabilities_.HardwareRecentlyFailed("hwdevice:cuda", now));
+}
+
+TEST_F(CodecCapabilitiesTest, Clear_ForgetsEverything) {
+  int probes = 0;
+  auto probe = [&probes]() {
+    ++probes;
+    return FakeCodec();
+  };
+  capabilities_.FindCodec("decoder-id:27", probe);
+  capabilities_.MarkHardwareFailed("hevc_vaapi");
+
+  capabilities_.Clear();
+  capabilities_.FindCodec("decoder-id:27", probe);
+  EXPECT_EQ(probes, 2);
+  EXPECT_FALSE(capabilities_.HardwareRecentlyFailed("hevc_vaapi"));
+}
@@ -0,0 +1,132 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for OutputGate and CodecReaper.
+// Validates that a closed gate drops worker callbacks and that retiring a
+// busy worker returns without waiting for it.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "src/shared/codec_reaper.h"
+
+using namespace webcodecs;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Stand-in for a codec worker whose current message is slow to finish.
+class SlowWorker {
+ public:
+  SlowWorker(std::atomic<bool>* stopped, std::atomic<bool>* destroyed)
+      : stopped_(stopped), destroyed_(destroyed) {}
+  ~SlowWorker() { destroyed_->store(true); }
+
+  void Stop() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    stopped_->store(true);
+  }
+
+ private:
+  std::atomic<bool>* stopped_;
+  std::atomic<bool>* destroyed_;
+};
+
+struct FakeQueue {};
+
+}  // namespace
+
+TEST(OutputGateTest, DropsCallbacksAfterClose) {
+  auto gate = OutputGate::Create();
+  int calls = 0;
+  std::function<void(int)> callback =
+      gate->Guard([&calls](int value) { calls += value; });
+
+  callback(1);
+  gate->Close();
+  callback(10);
+
+  EXPECT_EQ(calls, 1);
+  EXPECT_TRUE(gate->closed());
+}
+
+TEST(OutputGateTest, ForwardsMoveOnlyArguments) {
+  auto gate = OutputGate::Create();
+  int received = 0;
+  std::function<void(std::unique_ptr<int>)> callback = gate->Guard(
+      [&received](std::unique_ptr<int> value) { received = *value; });
+
+  callback(std::make_unique<int>(7));
+  EXPECT_EQ(received, 7);
+}
+
+TEST(OutputGateTest, CloseWaitsForCallbackInProgress) {
+  auto gate = OutputGate::Create();
+  std::atomic<bool> entered{false};
+  std::atomic<bool> finished{false};
+  std::function<void()> callback = gate->Guard([&] {
+    entered.store(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    finished.store(true);
+  });
+
+  std::thread worker(callback);
+  while (!entered.load()) {
+    std::this_thread::yield();
+  }
+  gate->Close();
+  EXPECT_TRUE(finished.load());
+  worker.join();
+}
+
+TEST(OutputGateTest, WrapperOutlivesOwner) {
+  std::function<void()> callback;
+  int calls = 0;
+  {
+    auto gate = OutputGate::Create();
+    callback = gate->Guard([&calls] { ++calls; });
+  }
+  callback();
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(CodecReaperTest, RetireReturnsBeforeWorkerStops) {
+  std::atomic<bool> stopped{false};
+  std::atomic<bool> destroyed{false};
+  auto worker = std::make_unique<SlowWorker>(&stopped, &destroyed);
+
+  auto start = Clock::now();
+  CodecReaper::Instance().Retire(std::move(worker),
+                                 std::make_unique<FakeQueue>());
+  auto elapsed = Clock::now() - start;
+
+  EXPECT_LT(elapsed, std::chrono::milliseconds(100));
+  EXPECT_FALSE(destroyed.load());
+
+  CodecReaper::Instance().Drain();
+  EXPECT_TRUE(stopped.load());
+  EXPECT_TRUE(destroyed.load());
+  EXPECT_EQ(CodecReaper::Instance().pending(), 0u);
+}
+
+TEST(CodecReaperTest, RunsTasksInPostingOrder) {
+  std::string order;
+  for (char c : std::string("abcde")) {
+    CodecReaper::Instance().Post([&order, c] { order += c; });
+  }
+  CodecReaper::Instance().Drain();
+  EXPECT_EQ(order, "abcde");
+}
+
+TEST(CodecReaperTest, IgnoresEmptyRetire) {
+  CodecReaper::Instance().Retire(std::unique_ptr<SlowWorker>(),
+                                 std::unique_ptr<FakeQueue>());
+  EXPECT_EQ(CodecReaper::Instance().pending(), 0u);
+}
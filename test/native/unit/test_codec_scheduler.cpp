@@ -0,0 +1,169 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for CodecScheduler.
+// Validates that pooled tasks run serially per task (FIFO per codec) while
+// many tasks share a small number of threads.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/shared/codec_scheduler.h"
+
+using namespace webcodecs;
+
+namespace {
+
+// Minimal stand-in for a pooled CodecWorker: a FIFO of ints processed in
+// bounded slices, scheduled at most once at a time.
+class FakeStrand : public CodecScheduler::Task {
+ public:
+  void Push(int value) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.push_back(value);
+    }
+    ScheduleSlice();
+  }
+
+  void Run() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++slices_in_run_;
+    }
+    if (running_.exchange(true)) {
+      overlapped_ = true;
+    }
+    for (int i = 0; i < 4; ++i) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (pending_.empty()) {
+        break;
+      }
+      processed_.push_back(pending_.front());
+      pending_.pop_front();
+    }
+    running_.store(false);
+
+    scheduled_.store(false);
+    bool more;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      more = !pending_.empty();
+    }
+    if (more) {
+      ScheduleSlice();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    --slices_in_run_;
+    cv_.notify_all();
+  }
+
+  void Cancel() override { scheduled_.store(false); }
+
+  // Same shutdown handshake as CodecWorker::Stop(): safe to destroy after.
+  void WaitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return slices_in_run_ == 0 && !scheduled_.load(); });
+  }
+
+  bool WaitForCount(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, std::chrono::seconds(5),
+                        [&] { return processed_.size() >= count; });
+  }
+
+  std::vector<int> processed() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return processed_;
+  }
+
+  bool overlapped() const { return overlapped_.load(); }
+
+ private:
+  void ScheduleSlice() {
+    if (!scheduled_.exchange(true)) {
+      EXPECT_TRUE(CodecScheduler::Instance().Schedule(this));
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<int> pending_;
+  std::vector<int> processed_;
+  int slices_in_run_ = 0;
+  std::atomic<bool> scheduled_{false};
+  std::atomic<bool> running_{false};
+  std::atomic<bool> overlapped_{false};
+};
+
+}  // namespace
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+TEST(CodecSchedulerTest, Configure_Zero_DisablesPool) {
+  CodecScheduler::Instance().Configure(2);
+  EXPECT_TRUE(CodecScheduler::Instance().enabled());
+
+  EXPECT_EQ(CodecScheduler::Instance().Configure(0), 0u);
+  EXPECT_FALSE(CodecScheduler::Instance().enabled());
+  // Threads stay alive for codecs that already joined the pool.
+  EXPECT_GE(CodecScheduler::Instance().size(), 2u);
+}
+
+TEST(CodecSchedulerTest, DefaultSize_IsAtLeastOne) {
+  EXPECT_GE(CodecScheduler::DefaultSize(), 1u);
+}
+
+// =============================================================================
+// ORDERING
+// =============================================================================
+
+TEST(CodecSchedulerTest, ManyStrands_FewThreads_PreserveFifoPerStrand) {
+  CodecScheduler::Instance().Configure(2);
+
+  constexpr int kStrands = 32;
+  constexpr int kMessages = 200;
+  std::vector<std::unique_ptr<FakeStrand>> strands;
+  for (int i = 0; i < kStrands; ++i) {
+    strands.push_back(std::make_unique<FakeStrand>());
+  }
+
+  // Producers on several threads, as with many JS-side codecs.
+  std::vector<std::thread> producers;
+  for (int p = 0; p < 4; ++p) {
+    producers.emplace_back([&, p]() {
+      for (int s = p; s < kStrands; s += 4) {
+        for (int m = 0; m < kMessages; ++m) {
+          strands[s]->Push(m);
+        }
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+
+  for (auto& strand : strands) {
+    ASSERT_TRUE(strand->WaitForCount(kMessages));
+    std::vector<int> processed = strand->processed();
+    ASSERT_EQ(processed.size(), static_cast<size_t>(kMessages));
+    for (int m = 0; m < kMessages; ++m) {
+      EXPECT_EQ(processed[m], m);
+    }
+    EXPECT_FALSE(strand->overlapped());
+    strand->WaitIdle();
+  }
+
+  CodecScheduler::Instance().Configure(0);
+}
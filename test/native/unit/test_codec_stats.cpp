@@ -0,0 +1,202 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for CodecStats, LatencyHistogram and TraceRecorder.
+// Validates bucketing, percentiles, concurrent recording and trace output.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/shared/codec_stats.h"
+#include "src/shared/trace_events.h"
+
+using namespace webcodecs;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace {
+
+size_t CountOf(const std::string& haystack, const std::string& needle) {
+  size_t count = 0;
+  for (size_t pos = haystack.find(needle); pos != std::string::npos;
+       pos = haystack.find(needle, pos + needle.size())) {
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+// =============================================================================
+// HISTOGRAM
+// =============================================================================
+
+TEST(LatencyHistogramTest, Empty_ReportsZero) {
+  LatencyHistogram histogram;
+  auto snapshot = histogram.Read();
+  EXPECT_EQ(snapshot.count, 0u);
+  EXPECT_EQ(snapshot.MeanUs(), 0.0);
+  EXPECT_EQ(snapshot.PercentileUs(0.99), 0.0);
+}
+
+TEST(LatencyHistogramTest, Record_TracksCountMeanAndMax) {
+  LatencyHistogram histogram;
+  histogram.Record(microseconds(10));
+  histogram.Record(microseconds(30));
+
+  auto snapshot = histogram.Read();
+  EXPECT_EQ(snapshot.count, 2u);
+  EXPECT_DOUBLE_EQ(snapshot.MeanUs(), 20.0);
+  EXPECT_EQ(snapshot.max_ns, 30000u);
+}
+
+TEST(LatencyHistogramTest, Percentile_IsBucketUpperBound) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 99; ++i) {
+    histogram.Record(microseconds(5));  // Bucket [4, 8)
+  }
+  histogram.Record(milliseconds(3));  // Bucket [2048, 4096)
+
+  auto snapshot = histogram.Read();
+  EXPECT_EQ(snapshot.PercentileUs(0.50), 8.0);
+  EXPECT_EQ(snapshot.PercentileUs(0.99), 3000.0);  // Capped at the max
+}
+
+TEST(LatencyHistogramTest, Record_NegativeCountsAsZero) {
+  LatencyHistogram histogram;
+  histogram.Record(std::chrono::nanoseconds(-5));
+
+  auto snapshot = histogram.Read();
+  EXPECT_EQ(snapshot.count, 1u);
+  EXPECT_EQ(snapshot.buckets[0], 1u);
+  EXPECT_EQ(snapshot.total_ns, 0u);
+}
+
+TEST(LatencyHistogramTest, Record_HugeSamplesLandInLastBucket) {
+  LatencyHistogram histogram;
+  histogram.Record(std::chrono::hours(2));
+  EXPECT_EQ(histogram.Read().buckets[LatencyHistogram::kBuckets - 1], 1u);
+}
+
+TEST(LatencyHistogramTest, Record_FromManyThreads) {
+  LatencyHistogram histogram;
+  constexpr int kThreads = 4;
+  constexpr int kSamples = 10000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&histogram, t]() {
+      for (int i = 0; i < kSamples; ++i) {
+        histogram.Record(microseconds(t + 1));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto snapshot = histogram.Read();
+  EXPECT_EQ(snapshot.count, static_cast<uint64_t>(kThreads * kSamples));
+  EXPECT_EQ(snapshot.max_ns, 4000u);
+}
+
+// =============================================================================
+// CODEC STATS
+// =============================================================================
+
+TEST(CodecStatsTest, StageTimer_RecordsIntoStage) {
+  CodecStats stats("VideoEncoder");
+  {
+    StageTimer timer(&stats, CodecStats::Stage::kConvert);
+  }
+  EXPECT_EQ(stats.Histogram(CodecStats::Stage::kConvert).Read().count, 1u);
+  EXPECT_EQ(stats.Histogram(CodecStats::Stage::kCodec).Read().count, 0u);
+}
+
+TEST(CodecStatsTest, StageTimer_NullStatsIsNoOp) {
+  StageTimer timer(nullptr, CodecStats::Stage::kCodec);  // Must not crash
+}
+
+TEST(CodecStatsTest, Reset_ClearsEverything) {
+  CodecStats stats("VideoDecoder");
+  auto now = CodecStats::Clock::now();
+  stats.Record(CodecStats::Stage::kQueueWait, now - milliseconds(1), now);
+  stats.Record(CodecStats::Stage::kFrameLatency, now - milliseconds(5), now);
+  stats.AddBytesCopied(1024);
+  EXPECT_EQ(stats.Histogram(CodecStats::Stage::kFrameLatency).Read().count,
+            1u);
+  EXPECT_EQ(stats.Histogram(CodecStats::Stage::kDelivery).Read().count, 0u);
+
+  stats.Reset();
+  EXPECT_EQ(stats.Histogram(CodecStats::Stage::kQueueWait).Read().count, 0u);
+  EXPECT_EQ(stats.Histogram(CodecStats::Stage::kFrameLatency).Read().count,
+            0u);
+  EXPECT_EQ(stats.bytes_copied(), 0u);
+}
+
+// =============================================================================
+// TRACING
+// =============================================================================
+
+TEST(TraceRecorderTest, Disabled_RecordsNothing) {
+  TraceRecorder& tracer = TraceRecorder::Instance();
+  tracer.Stop();
+  CodecStats stats("AudioEncoder");
+  auto now = CodecStats::Clock::now();
+  stats.Record(CodecStats::Stage::kCodec, now, now);
+
+  tracer.Start();
+  std::string json = tracer.Stop();
+  EXPECT_EQ(json.find("AudioEncoder"), std::string::npos);
+}
+
+TEST(TraceRecorderTest, Stop_EmitsCompleteAndAsyncEvents) {
+  TraceRecorder& tracer = TraceRecorder::Instance();
+  tracer.Start();
+  EXPECT_TRUE(tracer.enabled());
+
+  CodecStats stats("VideoEncoder");
+  auto start = CodecStats::Clock::now();
+  auto end = start + microseconds(250);
+  stats.Record(CodecStats::Stage::kCodec, start, end, "encode");
+  stats.Record(CodecStats::Stage::kDelivery, start, end);
+
+  std::string json = tracer.Stop();
+  EXPECT_FALSE(tracer.enabled());
+  EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+  EXPECT_EQ(CountOf(json, "\"ph\":\"X\""), 1u);
+  EXPECT_EQ(CountOf(json, "\"ph\":\"b\""), 1u);
+  EXPECT_EQ(CountOf(json, "\"ph\":\"e\""), 1u);
+  EXPECT_NE(json.find("\"name\":\"encode\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"delivery\""), std::string::npos);
+  EXPECT_NE(json.find("\"cat\":\"VideoEncoder\""), std::string::npos);
+  EXPECT_NE(json.find("\"dur\":250.000"), std::string::npos);
+  EXPECT_NE(json.find("\"droppedEvents\":0"), std::string::npos);
+}
+
+TEST(TraceRecorderTest, Start_CountsEventsPastBudgetAsDropped) {
+  TraceRecorder& tracer = TraceRecorder::Instance();
+  tracer.Start(2);
+
+  auto now = CodecStats::Clock::now();
+  for (int i = 0; i < 5; ++i) {
+    tracer.Complete("test", "work", now, now);
+  }
+
+  std::string json = tracer.Stop();
+  EXPECT_EQ(CountOf(json, "\"ph\":\"X\""), 2u);
+  EXPECT_NE(json.find("\"droppedEvents\":3"), std::string::npos);
+}
+
+TEST(TraceRecorderTest, SpansStartedBeforeRecordingAreSkipped) {
+  TraceRecorder& tracer = TraceRecorder::Instance();
+  auto before = CodecStats::Clock::now() - milliseconds(5);
+  tracer.Start();
+  tracer.AsyncSpan("test", "queueWait", before, CodecStats::Clock::now());
+
+  std::string json = tracer.Stop();
+  EXPECT_EQ(json.find("queueWait"), std::string::npos);
+}
@@ -356,6 +356,177 @@ TEST_F(ControlMessageQueueTest, Clear_MixedMessages_OnlyReturnsPackets) {
   }
 }
 
+// =============================================================================
+// BACKPRESSURE TESTS
+// =============================================================================
+
+namespace {
+
+void EnqueuePacket(VideoControlQueue* queue, bool is_key, uint8_t tag) {
+  const uint8_t payload[4] = {tag, tag, tag, tag};
+  VideoControlQueue::DecodeMessage msg;
+  msg.packet = CreateTestPacket(payload, sizeof(payload), is_key);
+  ASSERT_TRUE(queue->Enqueue(std::move(msg)));
+}
+
+void EnqueueFrame(VideoControlQueue* queue, bool key_frame, int64_t pts) {
+  VideoControlQueue::EncodeMessage msg;
+  msg.frame = CreateTestFrame(64, 48);
+  msg.frame->pts = pts;
+  msg.key_frame = key_frame;
+  ASSERT_TRUE(queue->Enqueue(std::move(msg)));
+}
+
+std::vector<uint8_t> QueuedPacketTags(VideoControlQueue* queue) {
+  std::vector<uint8_t> tags;
+  while (auto msg = queue->TryDequeue()) {
+    if (auto* decode = std::get_if<VideoControlQueue::DecodeMessage>(&*msg)) {
+      tags.push_back(decode->packet->data[0]);
+    }
+  }
+  return tags;
+}
+
+}  // namespace
+
+TEST_F(ControlMessageQueueTest, Bytes_TracksQueuedPayload) {
+  EnqueuePacket(&queue_, true, 1);
+  EnqueuePacket(&queue_, false, 2);
+  VideoControlQueue::FlushMessage flush;
+  flush.promise_id = 1;
+  queue_.Enqueue(flush);
+  EXPECT_EQ(queue_.bytes(), 8u);
+
+  (void)queue_.TryDequeue();
+  EXPECT_EQ(queue_.bytes(), 4u);
+
+  queue_.Clear();
+  EXPECT_EQ(queue_.bytes(), 0u);
+
+  EnqueueFrame(&queue_, false, 0);
+  EXPECT_GE(queue_.bytes(), 64u * 48u * 3u / 2u);
+  queue_.PopFront();
+  EXPECT_EQ(queue_.bytes(), 0u);
+}
+
+TEST_F(ControlMessageQueueTest, EnqueueAll_KeepsOrderAndCountsBytes) {
+  EnqueuePacket(&queue_, true, 1);
+  std::vector<VideoControlQueue::Message> batch;
+  for (uint8_t tag = 2; tag <= 4; ++tag) {
+    const uint8_t payload[4] = {tag, tag, tag, tag};
+    VideoControlQueue::DecodeMessage msg;
+    msg.packet = CreateTestPacket(payload, sizeof(payload), false);
+    batch.push_back(std::move(msg));
+  }
+  int ready_calls = 0;
+  queue_.SetReadyCallback([&ready_calls] { ++ready_calls; });
+
+  ASSERT_TRUE(queue_.EnqueueAll(std::move(batch)));
+  EXPECT_EQ(ready_calls, 1);
+  EXPECT_EQ(queue_.size(), 4u);
+  EXPECT_EQ(queue_.bytes(), 16u);
+  EXPECT_EQ(QueuedPacketTags(&queue_), (std::vector<uint8_t>{1, 2, 3, 4}));
+  queue_.SetReadyCallback(nullptr);
+}
+
+TEST_F(ControlMessageQueueTest, EnqueueAll_WhenClosed_EnqueuesNothing) {
+  std::vector<VideoControlQueue::Message> batch(2);
+  EXPECT_TRUE(queue_.EnqueueAll({}));
+  queue_.Shutdown();
+  EXPECT_FALSE(queue_.EnqueueAll(std::move(batch)));
+  EXPECT_EQ(queue_.size(), 0u);
+}
+
+TEST_F(ControlMessageQueueTest, DropOldestDeltaRun_DropsUntilNextKey) {
+  EnqueuePacket(&queue_, true, 1);
+  EnqueuePacket(&queue_, false, 2);
+  EnqueuePacket(&queue_, false, 3);
+  EnqueuePacket(&queue_, true, 4);
+  EnqueuePacket(&queue_, false, 5);
+
+  bool run_open = true;
+  auto dropped = queue_.DropOldestDeltaRun(&run_open);
+  ASSERT_EQ(dropped.size(), 2u);
+  EXPECT_EQ(dropped[0]->data[0], 2);
+  EXPECT_EQ(dropped[1]->data[0], 3);
+  EXPECT_FALSE(run_open);
+  EXPECT_EQ(queue_.bytes(), 12u);
+
+  EXPECT_EQ(QueuedPacketTags(&queue_), (std::vector<uint8_t>{1, 4, 5}));
+}
+
+TEST_F(ControlMessageQueueTest, DropOldestDeltaRun_OpenRunReachesQueueEnd) {
+  EnqueuePacket(&queue_, true, 1);
+  EnqueuePacket(&queue_, false, 2);
+  EnqueuePacket(&queue_, false, 3);
+
+  bool run_open = false;
+  EXPECT_EQ(queue_.DropOldestDeltaRun(&run_open).size(), 2u);
+  EXPECT_TRUE(run_open);
+  EXPECT_EQ(QueuedPacketTags(&queue_), (std::vector<uint8_t>{1}));
+}
+
+TEST_F(ControlMessageQueueTest, DropOldestDeltaRun_StopsAtNonDecodeMessage) {
+  EnqueuePacket(&queue_, false, 1);
+  VideoControlQueue::FlushMessage flush;
+  flush.promise_id = 1;
+  queue_.Enqueue(flush);
+  EnqueuePacket(&queue_, false, 2);
+
+  bool run_open = true;
+  EXPECT_EQ(queue_.DropOldestDeltaRun(&run_open).size(), 1u);
+  EXPECT_FALSE(run_open);
+  EXPECT_EQ(queue_.size(), 2u);
+}
+
+TEST_F(ControlMessageQueueTest, DropOldestDeltaRun_IntraOnlyDropsOldestKey) {
+  EnqueuePacket(&queue_, true, 1);
+  EnqueuePacket(&queue_, true, 2);
+
+  bool run_open = true;
+  auto dropped = queue_.DropOldestDeltaRun(&run_open);
+  ASSERT_EQ(dropped.size(), 1u);
+  EXPECT_EQ(dropped[0]->data[0], 1);
+  EXPECT_FALSE(run_open);
+
+  queue_.Clear();
+  EXPECT_TRUE(queue_.DropOldestDeltaRun(&run_open).empty());
+}
+
+TEST_F(ControlMessageQueueTest, DropOldestFrame_PrefersNonKeyFrames) {
+  EnqueueFrame(&queue_, true, 0);
+  EnqueueFrame(&queue_, false, 1);
+  EnqueueFrame(&queue_, false, 2);
+
+  bool orphaned_key = true;
+  auto dropped = queue_.DropOldestFrame(&orphaned_key);
+  ASSERT_NE(dropped, nullptr);
+  EXPECT_EQ(dropped->pts, 1);
+  EXPECT_FALSE(orphaned_key);
+  EXPECT_EQ(queue_.size(), 2u);
+}
+
+TEST_F(ControlMessageQueueTest, DropOldestFrame_MovesKeyRequestForward) {
+  EnqueueFrame(&queue_, true, 0);
+  EnqueueFrame(&queue_, true, 1);
+
+  bool orphaned_key = true;
+  auto dropped = queue_.DropOldestFrame(&orphaned_key);
+  ASSERT_NE(dropped, nullptr);
+  EXPECT_EQ(dropped->pts, 0);
+  EXPECT_FALSE(orphaned_key);
+
+  // The last forced keyframe has no successor to inherit the request.
+  dropped = queue_.DropOldestFrame(&orphaned_key);
+  ASSERT_NE(dropped, nullptr);
+  EXPECT_EQ(dropped->pts, 1);
+  EXPECT_TRUE(orphaned_key);
+
+  EXPECT_EQ(queue_.DropOldestFrame(&orphaned_key), nullptr);
+  EXPECT_FALSE(orphaned_key);
+  EXPECT_EQ(queue_.bytes(), 0u);
+}
+
 // =============================================================================
 // SPEC COMPLIANCE TESTS
 // =============================================================================
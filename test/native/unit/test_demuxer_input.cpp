@@ -0,0 +1,187 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for DemuxerInput.
+// Validates memory reads and seeks, for copies and mapped files, and the
+// request/response handshake used by callback inputs, including
+// interruption of a blocked read.
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+extern "C" {
+#include <libavformat/avio.h>
+#include <libavutil/error.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/demuxer_input.h"
+
+using namespace webcodecs;
+
+namespace {
+
+std::vector<uint8_t> MakeBytes(size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (size_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>(i & 0xFF);
+  }
+  return bytes;
+}
+
+}  // namespace
+
+// =============================================================================
+// MEMORY INPUT
+// =============================================================================
+
+TEST(DemuxerInputTest, Memory_ReadAndSeek) {
+  std::vector<uint8_t> bytes = MakeBytes(1000);
+  auto input = DemuxerInput::FromMemory(bytes.data(), bytes.size());
+  ASSERT_NE(input, nullptr);
+  EXPECT_FALSE(input->blocking());
+
+  AVIOContext* pb = input->avio();
+  EXPECT_EQ(avio_size(pb), 1000);
+
+  uint8_t buf[16];
+  ASSERT_EQ(avio_read(pb, buf, sizeof(buf)), 16);
+  EXPECT_EQ(buf[0], 0);
+  EXPECT_EQ(buf[15], 15);
+
+  ASSERT_EQ(avio_seek(pb, 500, SEEK_SET), 500);
+  ASSERT_EQ(avio_read(pb, buf, 4), 4);
+  EXPECT_EQ(buf[0], static_cast<uint8_t>(500 & 0xFF));
+
+  ASSERT_EQ(avio_seek(pb, -10, SEEK_END), 990);
+  EXPECT_EQ(avio_read(pb, buf, sizeof(buf)), 10);
+  EXPECT_EQ(avio_read(pb, buf, sizeof(buf)), AVERROR_EOF);
+}
+
+TEST(DemuxerInputTest, Memory_ReadsMappedFileInPlace) {
+  std::vector<uint8_t> bytes = MakeBytes(100000);
+  char path[] = "/tmp/webcodecs-input-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(write(fd, bytes.data(), bytes.size()),
+            static_cast<ssize_t>(bytes.size()));
+  std::string error;
+  auto file = MappedFile::FromDescriptor(fd, 0, &error);
+  close(fd);
+  unlink(path);  // The mapping keeps the data
+  ASSERT_NE(file, nullptr) << error;
+
+  auto input = DemuxerInput::FromMapping(std::move(file));
+  ASSERT_NE(input, nullptr);
+  EXPECT_FALSE(input->blocking());
+
+  AVIOContext* pb = input->avio();
+  EXPECT_EQ(avio_size(pb), 100000);
+  ASSERT_EQ(avio_seek(pb, 70000, SEEK_SET), 70000);
+  uint8_t buf[4];
+  ASSERT_EQ(avio_read(pb, buf, sizeof(buf)), 4);
+  EXPECT_EQ(buf[0], static_cast<uint8_t>(70000 & 0xFF));
+}
+
+// =============================================================================
+// CALLBACK INPUT
+// =============================================================================
+
+TEST(DemuxerInputTest, Callback_AnsweredFromAnotherThread) {
+  std::vector<uint8_t> bytes = MakeBytes(300);
+  DemuxerInput* raw = nullptr;
+  std::vector<std::thread> responders;
+
+  auto input = DemuxerInput::FromCallback(
+      [&](uint64_t id, int64_t offset, int length) {
+        responders.emplace_back([&, id, offset, length]() {
+          size_t start = static_cast<size_t>(offset);
+          size_t count = std::min<size_t>(length, bytes.size() - start);
+          raw->Respond(id, bytes.data() + start, count, 0);
+        });
+        return true;
+      },
+      static_cast<int64_t>(bytes.size()));
+  ASSERT_NE(input, nullptr);
+  raw = input.get();
+  EXPECT_TRUE(input->blocking());
+
+  AVIOContext* pb = input->avio();
+  ASSERT_EQ(avio_seek(pb, 100, SEEK_SET), 100);
+  uint8_t buf[8];
+  ASSERT_EQ(avio_read(pb, buf, sizeof(buf)), 8);
+  EXPECT_EQ(buf[0], 100);
+  EXPECT_EQ(buf[7], 107);
+
+  for (auto& t : responders) {
+    t.join();
+  }
+}
+
+TEST(DemuxerInputTest, Callback_IgnoresStaleResponse) {
+  std::vector<uint8_t> bytes = MakeBytes(64);
+  DemuxerInput* raw = nullptr;
+  std::thread responder;
+
+  auto input = DemuxerInput::FromCallback(
+      [&](uint64_t id, int64_t offset, int length) {
+        responder = std::thread([&, id, offset, length]() {
+          // An answer for an id that is not outstanding must be dropped.
+          uint8_t junk = 0xEE;
+          raw->Respond(id + 1, &junk, 1, 0);
+          raw->Respond(id, bytes.data() + offset,
+                       std::min<size_t>(length, bytes.size() - offset), 0);
+        });
+        return true;
+      },
+      static_cast<int64_t>(bytes.size()));
+  ASSERT_NE(input, nullptr);
+  raw = input.get();
+
+  uint8_t buf[4];
+  ASSERT_EQ(avio_read(input->avio(), buf, sizeof(buf)), 4);
+  EXPECT_EQ(buf[0], 0);
+  EXPECT_EQ(buf[3], 3);
+  responder.join();
+}
+
+TEST(DemuxerInputTest, Callback_SetInterrupted_WakesBlockedRead) {
+  std::atomic<bool> requested{false};
+  auto input = DemuxerInput::FromCallback(
+      [&](uint64_t, int64_t, int) {
+        requested.store(true);
+        return true;  // Never answered.
+      },
+      -1);
+  ASSERT_NE(input, nullptr);
+
+  std::thread interrupter([&]() {
+    while (!requested.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    input->SetInterrupted(true);
+  });
+
+  uint8_t buf[4];
+  int ret = avio_read(input->avio(), buf, sizeof(buf));
+  interrupter.join();
+  EXPECT_EQ(ret, AVERROR_EXIT);
+}
+
+TEST(DemuxerInputTest, Callback_UnknownSize_SeekFromEndFails) {
+  auto input =
+      DemuxerInput::FromCallback([](uint64_t, int64_t, int) { return false; },
+                                 -1);
+  ASSERT_NE(input, nullptr);
+  EXPECT_LT(avio_size(input->avio()), 0);
+}
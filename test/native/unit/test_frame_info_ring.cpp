@@ -0,0 +1,114 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for FrameInfoRing.
+// Validates reordered lookup, capacity sizing and stale-entry eviction.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "src/shared/frame_info_ring.h"
+
+using namespace webcodecs;
+
+// =============================================================================
+// CAPACITY
+// =============================================================================
+
+TEST(FrameInfoRingTest, Reset_RoundsUpToPowerOfTwo) {
+  FrameInfoRing ring;
+  EXPECT_EQ(ring.capacity(), FrameInfoRing::kMinCapacity);
+
+  ring.Reset(3);
+  EXPECT_EQ(ring.capacity(), FrameInfoRing::kMinCapacity);
+
+  ring.Reset(FrameInfoRing::kMinCapacity + 1);
+  EXPECT_EQ(ring.capacity(), FrameInfoRing::kMinCapacity * 2);
+}
+
+TEST(FrameInfoRingTest, Reset_DropsEntries) {
+  FrameInfoRing ring;
+  ring.Put(0, 100, 10);
+  ring.Reset(FrameInfoRing::kMinCapacity);
+
+  int64_t timestamp = 0;
+  int64_t duration = 0;
+  EXPECT_FALSE(ring.Take(0, &timestamp, &duration));
+}
+
+// =============================================================================
+// LOOKUP
+// =============================================================================
+
+TEST(FrameInfoRingTest, Take_ReturnsEntriesInAnyOrder) {
+  FrameInfoRing ring;
+  for (int64_t i = 0; i < 4; ++i) {
+    EXPECT_FALSE(ring.Put(i, i * 1000, 33));
+  }
+
+  // B-frame output order: I P B B
+  for (int64_t i : {0, 3, 1, 2}) {
+    int64_t timestamp = -1;
+    int64_t duration = -1;
+    ASSERT_TRUE(ring.Take(i, &timestamp, &duration));
+    EXPECT_EQ(timestamp, i * 1000);
+    EXPECT_EQ(duration, 33);
+  }
+}
+
+TEST(FrameInfoRingTest, Take_RemovesEntry) {
+  FrameInfoRing ring;
+  ring.Put(5, 500, 10);
+
+  int64_t timestamp = 0;
+  int64_t duration = 0;
+  ASSERT_TRUE(ring.Take(5, &timestamp, &duration));
+  EXPECT_FALSE(ring.Take(5, &timestamp, &duration));
+}
+
+TEST(FrameInfoRingTest, Take_MissingLeavesOutputsUntouched) {
+  FrameInfoRing ring;
+  int64_t timestamp = 7;
+  int64_t duration = 8;
+  EXPECT_FALSE(ring.Take(2, &timestamp, &duration));
+  EXPECT_FALSE(ring.Take(-1, &timestamp, &duration));
+  EXPECT_EQ(timestamp, 7);
+  EXPECT_EQ(duration, 8);
+}
+
+// =============================================================================
+// EVICTION
+// =============================================================================
+
+TEST(FrameInfoRingTest, Put_EvictsEntryOneLapOld) {
+  FrameInfoRing ring;
+  const auto lap = static_cast<int64_t>(ring.capacity());
+
+  // Frame 1 never produces a packet (dropped by the encoder).
+  ring.Put(1, 1000, 10);
+  EXPECT_TRUE(ring.Put(1 + lap, 2000, 20));
+
+  int64_t timestamp = 0;
+  int64_t duration = 0;
+  EXPECT_FALSE(ring.Take(1, &timestamp, &duration));
+  ASSERT_TRUE(ring.Take(1 + lap, &timestamp, &duration));
+  EXPECT_EQ(timestamp, 2000);
+  EXPECT_EQ(duration, 20);
+}
+
+TEST(FrameInfoRingTest, LongRun_StaysWithinCapacity) {
+  FrameInfoRing ring;
+  const int64_t depth = 16;  // Frames held by the codec at once
+  int64_t timestamp = 0;
+  int64_t duration = 0;
+
+  for (int64_t i = 0; i < 100000; ++i) {
+    ASSERT_FALSE(ring.Put(i, i * 10, 10));
+    if (i >= depth) {
+      ASSERT_TRUE(ring.Take(i - depth, &timestamp, &duration));
+      ASSERT_EQ(timestamp, (i - depth) * 10);
+    }
+  }
+  EXPECT_EQ(ring.capacity(), FrameInfoRing::kMinCapacity);
+}
@@ -0,0 +1,94 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for KeyframeIndex.
+// Validates lookup around keyframe boundaries and the serialized format.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "src/keyframe_index.h"
+
+using namespace webcodecs;
+
+namespace {
+
+KeyframeIndex MakeIndex() {
+  KeyframeIndex index(0, {1, 90000});
+  // Out of order, with a duplicate, as a packet scan may produce.
+  index.Add(180000, 3000);
+  index.Add(0, 100);
+  index.Add(90000, 2000);
+  index.Add(90000, 2500);
+  index.Finalize();
+  return index;
+}
+
+}  // namespace
+
+// =============================================================================
+// LOOKUP
+// =============================================================================
+
+TEST(KeyframeIndexTest, Finalize_SortsAndDeduplicates) {
+  KeyframeIndex index = MakeIndex();
+  ASSERT_EQ(index.size(), 3u);
+  EXPECT_EQ(index.FindAtOrBefore(90000)->position, 2000);
+}
+
+TEST(KeyframeIndexTest, FindAtOrBefore_PicksPrecedingKeyframe) {
+  KeyframeIndex index = MakeIndex();
+  EXPECT_EQ(index.FindAtOrBefore(89999)->timestamp, 0);
+  EXPECT_EQ(index.FindAtOrBefore(90000)->timestamp, 90000);
+  EXPECT_EQ(index.FindAtOrBefore(1000000)->timestamp, 180000);
+  // Before the first keyframe there is nothing earlier to decode from.
+  EXPECT_EQ(index.FindAtOrBefore(-5)->timestamp, 0);
+}
+
+TEST(KeyframeIndexTest, FindNearest_PicksClosestKeyframe) {
+  KeyframeIndex index = MakeIndex();
+  EXPECT_EQ(index.FindNearest(40000)->timestamp, 0);
+  EXPECT_EQ(index.FindNearest(50000)->timestamp, 90000);
+  EXPECT_EQ(index.FindNearest(170000)->timestamp, 180000);
+}
+
+TEST(KeyframeIndexTest, Empty_ReturnsNull) {
+  KeyframeIndex index;
+  EXPECT_EQ(index.FindAtOrBefore(0), nullptr);
+  EXPECT_EQ(index.FindNearest(0), nullptr);
+}
+
+// =============================================================================
+// SERIALIZATION
+// =============================================================================
+
+TEST(KeyframeIndexTest, Serialize_RoundTrips) {
+  KeyframeIndex index = MakeIndex();
+  std::vector<uint8_t> bytes = index.Serialize();
+
+  KeyframeIndex loaded;
+  ASSERT_TRUE(KeyframeIndex::Deserialize(bytes.data(), bytes.size(), &loaded));
+  EXPECT_EQ(loaded.stream_index(), 0);
+  EXPECT_EQ(loaded.time_base().num, 1);
+  EXPECT_EQ(loaded.time_base().den, 90000);
+  ASSERT_EQ(loaded.size(), index.size());
+  EXPECT_EQ(loaded.FindAtOrBefore(100000)->position, 2000);
+}
+
+TEST(KeyframeIndexTest, Deserialize_RejectsCorruptInput) {
+  std::vector<uint8_t> bytes = MakeIndex().Serialize();
+  KeyframeIndex loaded;
+
+  std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+  EXPECT_FALSE(KeyframeIndex::Deserialize(truncated.data(), truncated.size(),
+                                          &loaded));
+
+  std::vector<uint8_t> bad_magic = bytes;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(KeyframeIndex::Deserialize(bad_magic.data(), bad_magic.size(),
+                                          &loaded));
+
+  EXPECT_FALSE(KeyframeIndex::Deserialize(nullptr, 0, &loaded));
+}
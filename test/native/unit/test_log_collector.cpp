@@ -0,0 +1,144 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for LogCollector.
+// Validates per-thread capture, repeat folding and rate limiting.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/shared/log_collector.h"
+
+using namespace webcodecs;
+
+namespace {
+
+void AddLine(LogCollector& collector, const std::string& text,
+             LogCollector::Clock::time_point now) {
+  collector.Add(
+      [&](char* buf, size_t size) { snprintf(buf, size, "%s", text.c_str()); },
+      now);
+}
+
+TEST(LogCollectorTest, DrainsLinesInOrder) {
+  LogCollector collector;
+  auto now = LogCollector::Clock::now();
+  AddLine(collector, "first", now);
+  AddLine(collector, "second", now);
+
+  EXPECT_EQ(collector.Drain(), (std::vector<std::string>{"first", "second"}));
+  EXPECT_TRUE(collector.Drain().empty());
+}
+
+TEST(LogCollectorTest, IgnoresEmptyLines) {
+  LogCollector collector;
+  AddLine(collector, "", LogCollector::Clock::now());
+  EXPECT_TRUE(collector.Drain().empty());
+}
+
+TEST(LogCollectorTest, FoldsRepeatedLines) {
+  LogCollector collector;
+  auto now = LogCollector::Clock::now();
+  for (int i = 0; i < 5; i++) {
+    AddLine(collector, "corrupt slice", now);
+  }
+  AddLine(collector, "next", now);
+  AddLine(collector, "next", now);
+
+  EXPECT_EQ(collector.Drain(),
+            (std::vector<std::string>{"corrupt slice",
+                                      "Last message repeated 4 times", "next",
+                                      "Last message repeated 1 times"}));
+}
+
+TEST(LogCollectorTest, SuppressesLinesOverTheRateWithoutFormatting) {
+  LogCollector collector;
+  auto now = LogCollector::Clock::now();
+  int formatted = 0;
+  for (uint32_t i = 0; i < LogCollector::kMaxLinesPerSecond + 10; i++) {
+    collector.Add(
+        [&](char* buf, size_t size) {
+          formatted++;
+          snprintf(buf, size, "line %u", i);
+        },
+        now);
+    if (i % LogCollector::kRingCapacity == 0) {
+      collector.Drain();  // Keep the ring from filling first
+    }
+  }
+  EXPECT_EQ(formatted, static_cast<int>(LogCollector::kMaxLinesPerSecond));
+  std::vector<std::string> lines = collector.Drain();
+  ASSERT_FALSE(lines.empty());
+  EXPECT_EQ(lines.back(), "10 log messages suppressed");
+
+  // A new second accepts lines again.
+  AddLine(collector, "later", now + std::chrono::seconds(1));
+  EXPECT_EQ(collector.Drain(), (std::vector<std::string>{"later"}));
+}
+
+TEST(LogCollectorTest, CountsLinesDroppedByAFullRing) {
+  LogCollector collector;
+  auto now = LogCollector::Clock::now();
+  for (uint32_t i = 0; i < LogCollector::kRingCapacity + 3; i++) {
+    AddLine(collector, "line " + std::to_string(i), now);
+  }
+  std::vector<std::string> lines = collector.Drain();
+  ASSERT_EQ(lines.size(), LogCollector::kRingCapacity + 1);
+  EXPECT_EQ(lines.front(), "line 0");
+  EXPECT_EQ(lines.back(), "3 log messages suppressed");
+}
+
+TEST(LogCollectorTest, TruncatesLongLines) {
+  LogCollector collector;
+  AddLine(collector, std::string(1000, 'x'), LogCollector::Clock::now());
+  std::vector<std::string> lines = collector.Drain();
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_EQ(lines[0].size(), LogCollector::kMaxLineLength - 1);
+}
+
+TEST(LogCollectorTest, KeepsLinesOfExitedThreads) {
+  LogCollector collector;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&collector, t]() {
+      auto now = LogCollector::Clock::now();
+      for (int i = 0; i < 10; i++) {
+        AddLine(collector, "t" + std::to_string(t) + " " + std::to_string(i),
+                now);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(collector.Drain().size(), 40u);
+  EXPECT_TRUE(collector.Drain().empty());
+}
+
+TEST(LogCollectorTest, DrainsWhileThreadsLog) {
+  LogCollector collector;
+  std::atomic<bool> done{false};
+  std::thread producer([&]() {
+    auto now = LogCollector::Clock::now();
+    for (int i = 0; i < 50; i++) {
+      AddLine(collector, "line " + std::to_string(i), now);
+      std::this_thread::yield();
+    }
+    done.store(true);
+  });
+  size_t drained = 0;
+  while (!done.load()) {
+    drained += collector.Drain().size();
+  }
+  producer.join();
+  drained += collector.Drain().size();
+  EXPECT_EQ(drained, 50u);
+}
+
+}  // namespace
@@ -0,0 +1,141 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for LoudnessMeter.
+// Checks against the EBU Tech 3341/3342 reference signals.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "src/loudness_meter.h"
+
+using namespace webcodecs;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+double Db(double amplitude) { return 20.0 * std::log10(amplitude); }
+
+// Interleaved stereo float sine, both channels equal.
+std::vector<float> Sine(int sample_rate, double frequency, double dbfs,
+                        double seconds, double phase = 0) {
+  double amplitude = std::pow(10.0, dbfs / 20.0);
+  int frames = static_cast<int>(sample_rate * seconds);
+  std::vector<float> samples(static_cast<size_t>(frames) * 2);
+  for (int i = 0; i < frames; ++i) {
+    float value = static_cast<float>(
+        amplitude * std::sin(2 * kPi * frequency * i / sample_rate + phase));
+    samples[2 * i] = value;
+    samples[2 * i + 1] = value;
+  }
+  return samples;
+}
+
+// Feed |samples| in decoder-sized pieces that straddle the 100 ms blocks.
+void Feed(LoudnessMeter* meter, const std::vector<float>& samples) {
+  constexpr int kFrameSize = 1024;
+  int frames = static_cast<int>(samples.size() / 2);
+  for (int offset = 0; offset < frames; offset += kFrameSize) {
+    const uint8_t* data[1] = {
+        reinterpret_cast<const uint8_t*>(samples.data() + 2 * offset)};
+    meter->AddSamples(data, LoudnessMeter::SampleFormat::kF32, false,
+                      std::min(kFrameSize, frames - offset));
+  }
+}
+
+}  // namespace
+
+TEST(LoudnessMeterTest, StereoSineAtMinus23IsMinus23Lufs) {
+  for (int rate : {44100, 48000}) {
+    LoudnessMeter meter;
+    meter.Configure(rate, {1.0, 1.0}, true);
+    Feed(&meter, Sine(rate, 1000, -23, 20));
+
+    LoudnessMeter::Summary summary = meter.GetSummary();
+    EXPECT_NEAR(summary.integrated, -23.0, 0.1) << rate;
+    EXPECT_NEAR(summary.momentary, -23.0, 0.1) << rate;
+    EXPECT_NEAR(summary.short_term, -23.0, 0.1) << rate;
+    EXPECT_NEAR(summary.loudness_range, 0.0, 0.1) << rate;
+    EXPECT_NEAR(Db(summary.sample_peak), -23.0, 0.01) << rate;
+    EXPECT_NEAR(Db(summary.rms), -26.01, 0.01) << rate;
+    EXPECT_EQ(summary.frames, rate * 20);
+  }
+}
+
+TEST(LoudnessMeterTest, LoudnessRangeOfTwoLevels) {
+  // EBU Tech 3342 case 1: 20 s at -20 dBFS, then 20 s at -30 dBFS.
+  LoudnessMeter meter;
+  meter.Configure(48000, {1.0, 1.0}, false);
+  Feed(&meter, Sine(48000, 1000, -20, 20));
+  Feed(&meter, Sine(48000, 1000, -30, 20));
+
+  LoudnessMeter::Summary summary = meter.GetSummary();
+  EXPECT_NEAR(summary.loudness_range, 10.0, 1.0);
+  EXPECT_NEAR(summary.max_momentary, -20.0, 0.1);
+}
+
+TEST(LoudnessMeterTest, GatesOutSilence) {
+  // The relative gate drops the quiet half from the integrated value.
+  LoudnessMeter meter;
+  meter.Configure(48000, {1.0, 1.0}, false);
+  Feed(&meter, Sine(48000, 1000, -23, 10));
+  Feed(&meter, std::vector<float>(48000 * 2 * 10, 0.0f));
+  EXPECT_NEAR(meter.GetSummary().integrated, -23.0, 0.1);
+
+  LoudnessMeter silent;
+  silent.Configure(48000, {1.0, 1.0}, false);
+  Feed(&silent, std::vector<float>(48000 * 2 * 5, 0.0f));
+  LoudnessMeter::Summary summary = silent.GetSummary();
+  EXPECT_TRUE(std::isinf(summary.integrated) && summary.integrated < 0);
+  EXPECT_EQ(summary.sample_peak, 0.0);
+}
+
+TEST(LoudnessMeterTest, TruePeakFindsInterSamplePeaks) {
+  // A quarter-rate sine sampled 45 degrees off its crests: every sample is
+  // 3 dB under the true peak.
+  LoudnessMeter meter;
+  meter.Configure(48000, {1.0, 1.0}, true);
+  Feed(&meter, Sine(48000, 12000, -6, 1, kPi / 4));
+
+  LoudnessMeter::Summary summary = meter.GetSummary();
+  EXPECT_NEAR(Db(summary.sample_peak), -9.01, 0.05);
+  EXPECT_NEAR(Db(summary.true_peak), -6.0, 0.5);
+}
+
+TEST(LoudnessMeterTest, ChannelWeightsAndIntegerFormats) {
+  // Planar s16 with the second channel as LFE: it does not count.
+  constexpr int kRate = 48000;
+  std::vector<float> sine = Sine(kRate, 1000, -20, 5);
+  std::vector<int16_t> left(kRate * 5);
+  std::vector<int16_t> lfe(kRate * 5);
+  for (size_t i = 0; i < left.size(); ++i) {
+    left[i] = static_cast<int16_t>(std::lround(sine[2 * i] * 32767));
+    lfe[i] = static_cast<int16_t>(std::lround(sine[2 * i] * 32767 * 3));
+  }
+
+  LoudnessMeter meter;
+  meter.Configure(kRate, {1.0, 0.0}, false);
+  const uint8_t* data[2] = {reinterpret_cast<const uint8_t*>(left.data()),
+                            reinterpret_cast<const uint8_t*>(lfe.data())};
+  meter.AddSamples(data, LoudnessMeter::SampleFormat::kS16, true,
+                   static_cast<int>(left.size()));
+
+  // One channel at -20 dBFS reads 3 dB under the same signal in stereo.
+  EXPECT_NEAR(meter.GetSummary().integrated, -23.0, 0.1);
+}
+
+TEST(LoudnessMeterTest, ResetClearsMeasurements) {
+  LoudnessMeter meter;
+  meter.Configure(48000, {1.0, 1.0}, true);
+  Feed(&meter, Sine(48000, 1000, -10, 2));
+  meter.Reset();
+  EXPECT_FALSE(meter.configured());
+  LoudnessMeter::Summary summary = meter.GetSummary();
+  EXPECT_EQ(summary.frames, 0);
+  EXPECT_EQ(summary.true_peak, 0.0);
+  EXPECT_TRUE(std::isinf(summary.momentary));
+}
@@ -0,0 +1,133 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for MappedFile.
+// Validates mapping by path and descriptor, the zeroed padding after the
+// file, and the errors for inputs that cannot be mapped.
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/mapped_file.h"
+
+using namespace webcodecs;
+
+namespace {
+
+constexpr size_t kPadding = 64;
+
+// Temporary file holding |bytes|, removed when it goes out of scope.
+class TempFile {
+ public:
+  explicit TempFile(const std::vector<uint8_t>& bytes) {
+    char name[] = "/tmp/webcodecs-mapped-XXXXXX";
+    int fd = mkstemp(name);
+    path_ = name;
+    if (!bytes.empty()) {
+      EXPECT_EQ(write(fd, bytes.data(), bytes.size()),
+                static_cast<ssize_t>(bytes.size()));
+    }
+    close(fd);
+  }
+  ~TempFile() { std::remove(path_.c_str()); }
+
+  const std::string& path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
+std::vector<uint8_t> MakeBytes(size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (size_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>((i * 7 + 1) & 0xFF);
+  }
+  return bytes;
+}
+
+void ExpectMapped(const MappedFile& file, const std::vector<uint8_t>& bytes) {
+  ASSERT_EQ(file.size(), bytes.size());
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    ASSERT_EQ(file.data()[i], bytes[i]) << i;
+  }
+  for (size_t i = 0; i < kPadding; ++i) {
+    ASSERT_EQ(file.data()[bytes.size() + i], 0) << i;
+  }
+}
+
+}  // namespace
+
+TEST(MappedFileTest, MapsFileByPath) {
+  std::vector<uint8_t> bytes = MakeBytes(10000);
+  TempFile temp(bytes);
+
+  std::string error;
+  std::unique_ptr<MappedFile> file =
+      MappedFile::Open(temp.path(), kPadding, &error);
+  ASSERT_NE(file, nullptr) << error;
+  ExpectMapped(*file, bytes);
+}
+
+TEST(MappedFileTest, PadsPageAlignedFiles) {
+  // The padding falls entirely past the last file page.
+  std::vector<uint8_t> bytes =
+      MakeBytes(static_cast<size_t>(sysconf(_SC_PAGESIZE)) * 2);
+  TempFile temp(bytes);
+
+  std::string error;
+  std::unique_ptr<MappedFile> file =
+      MappedFile::Open(temp.path(), kPadding, &error);
+  ASSERT_NE(file, nullptr) << error;
+  ExpectMapped(*file, bytes);
+}
+
+TEST(MappedFileTest, MapsDescriptorAndOutlivesIt) {
+  std::vector<uint8_t> bytes = MakeBytes(5000);
+  TempFile temp(bytes);
+
+  int fd = open(temp.path().c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+  std::string error;
+  std::unique_ptr<MappedFile> file =
+      MappedFile::FromDescriptor(fd, kPadding, &error);
+  // The caller's descriptor is left open.
+  EXPECT_EQ(close(fd), 0);
+  ASSERT_NE(file, nullptr) << error;
+  ExpectMapped(*file, bytes);
+}
+
+TEST(MappedFileTest, RejectsMissingFile) {
+  std::string error;
+  EXPECT_EQ(MappedFile::Open("/nonexistent/webcodecs", kPadding, &error),
+            nullptr);
+  EXPECT_NE(error.find("open"), std::string::npos);
+}
+
+TEST(MappedFileTest, RejectsEmptyFile) {
+  TempFile temp({});
+  std::string error;
+  EXPECT_EQ(MappedFile::Open(temp.path(), kPadding, &error), nullptr);
+  EXPECT_EQ(error, "file is empty");
+}
+
+TEST(MappedFileTest, RejectsNonRegularFiles) {
+  std::string error;
+  EXPECT_EQ(MappedFile::Open("/tmp", kPadding, &error), nullptr);
+  EXPECT_EQ(error, "not a regular file");
+
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  EXPECT_EQ(MappedFile::FromDescriptor(fds[0], kPadding, &error), nullptr);
+  EXPECT_EQ(error, "not a regular file");
+  close(fds[0]);
+  close(fds[1]);
+}
@@ -0,0 +1,158 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for MemoryAccountant.
+// Validates per-category counters, the soft limit, per-thread V8 debt and
+// codec queue accounting.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "src/shared/control_message_queue.h"
+#include "src/shared/memory_accountant.h"
+
+using namespace webcodecs;
+
+namespace {
+
+// The accountant is process-wide, so tests compare against a baseline and
+// restore the soft limit.
+class MemoryAccountantTest : public ::testing::Test {
+ protected:
+  void TearDown() override { accountant_.SetSoftLimit(0); }
+
+  MemoryAccountant& accountant_ = MemoryAccountant::Instance();
+};
+
+VideoControlQueue::DecodeMessage DecodeOf(size_t size) {
+  std::vector<uint8_t> payload(size, 0);
+  VideoControlQueue::DecodeMessage decode;
+  decode.packet = ffmpeg::make_packet_copy(payload.data(), payload.size());
+  return decode;
+}
+
+}  // namespace
+
+// =============================================================================
+// COUNTERS
+// =============================================================================
+
+TEST_F(MemoryAccountantTest, Add_TracksCategoryAndTotal) {
+  int64_t frames = accountant_.Bytes(MemoryCategory::kVideoFrames);
+  int64_t total = accountant_.Total();
+
+  accountant_.Add(MemoryCategory::kVideoFrames, 4096);
+  EXPECT_EQ(accountant_.Bytes(MemoryCategory::kVideoFrames), frames + 4096);
+  EXPECT_EQ(accountant_.Total(), total + 4096);
+
+  accountant_.Add(MemoryCategory::kVideoFrames, -4096);
+  EXPECT_EQ(accountant_.Bytes(MemoryCategory::kVideoFrames), frames);
+}
+
+TEST_F(MemoryAccountantTest, Add_FromManyThreads) {
+  int64_t before = accountant_.Bytes(MemoryCategory::kAudioData);
+  constexpr int kThreads = 4;
+  constexpr int kIterations = 10000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([this]() {
+      for (int i = 0; i < kIterations; ++i) {
+        accountant_.Add(MemoryCategory::kAudioData, 3);
+        accountant_.Add(MemoryCategory::kAudioData, -1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(accountant_.Bytes(MemoryCategory::kAudioData),
+            before + kThreads * kIterations * 2);
+  accountant_.Add(MemoryCategory::kAudioData, -kThreads * kIterations * 2);
+}
+
+TEST_F(MemoryAccountantTest, CategoryName_MatchesJsKeys) {
+  EXPECT_STREQ(MemoryAccountant::CategoryName(MemoryCategory::kEncodedChunks),
+               "encodedChunks");
+  EXPECT_STREQ(MemoryAccountant::CategoryName(MemoryCategory::kCodecQueues),
+               "codecQueues");
+}
+
+// =============================================================================
+// SOFT LIMIT
+// =============================================================================
+
+TEST_F(MemoryAccountantTest, SoftLimit_DisabledByDefault) {
+  accountant_.Add(MemoryCategory::kEncodedChunks, 1 << 20);
+  EXPECT_FALSE(accountant_.OverSoftLimit());
+  accountant_.Add(MemoryCategory::kEncodedChunks, -(1 << 20));
+}
+
+TEST_F(MemoryAccountantTest, SoftLimit_TripsAboveLimit) {
+  accountant_.SetSoftLimit(accountant_.Total() + 1000);
+  EXPECT_FALSE(accountant_.OverSoftLimit());
+
+  accountant_.Add(MemoryCategory::kFramePool, 1000);
+  EXPECT_FALSE(accountant_.OverSoftLimit());  // At the limit, not above
+  accountant_.Add(MemoryCategory::kFramePool, 1);
+  EXPECT_TRUE(accountant_.OverSoftLimit());
+
+  accountant_.Add(MemoryCategory::kFramePool, -1001);
+  EXPECT_FALSE(accountant_.OverSoftLimit());
+}
+
+TEST_F(MemoryAccountantTest, SetSoftLimit_NegativeDisables) {
+  accountant_.SetSoftLimit(-5);
+  EXPECT_EQ(accountant_.soft_limit(), 0);
+}
+
+// =============================================================================
+// V8 DEBT
+// =============================================================================
+
+TEST_F(MemoryAccountantTest, DeferredV8Release_IsPerThread) {
+  MemoryAccountant::TakeDeferredV8Release();
+  MemoryAccountant::DeferV8Release(100);
+  MemoryAccountant::DeferV8Release(28);
+
+  int64_t other_thread = -1;
+  std::thread([&other_thread]() {
+    other_thread = MemoryAccountant::TakeDeferredV8Release();
+  }).join();
+
+  EXPECT_EQ(other_thread, 0);
+  EXPECT_EQ(MemoryAccountant::TakeDeferredV8Release(), 128);
+  EXPECT_EQ(MemoryAccountant::TakeDeferredV8Release(), 0);
+}
+
+// =============================================================================
+// CODEC QUEUES
+// =============================================================================
+
+TEST_F(MemoryAccountantTest, Queue_MirrorsBytesIntoCodecQueues) {
+  int64_t before = accountant_.Bytes(MemoryCategory::kCodecQueues);
+  VideoControlQueue queue;
+  ASSERT_TRUE(queue.Enqueue(DecodeOf(1000)));
+  ASSERT_TRUE(queue.Enqueue(DecodeOf(500)));
+  EXPECT_EQ(accountant_.Bytes(MemoryCategory::kCodecQueues), before + 1500);
+
+  auto msg = queue.TryDequeue();
+  ASSERT_TRUE(msg.has_value());
+  EXPECT_EQ(accountant_.Bytes(MemoryCategory::kCodecQueues), before + 500);
+
+  queue.Clear();
+  EXPECT_EQ(accountant_.Bytes(MemoryCategory::kCodecQueues), before);
+}
+
+TEST_F(MemoryAccountantTest, Queue_DestructionReleasesQueuedBytes) {
+  int64_t before = accountant_.Bytes(MemoryCategory::kCodecQueues);
+  {
+    VideoControlQueue queue;
+    ASSERT_TRUE(queue.Enqueue(DecodeOf(2048)));
+    EXPECT_EQ(accountant_.Bytes(MemoryCategory::kCodecQueues), before + 2048);
+  }
+  EXPECT_EQ(accountant_.Bytes(MemoryCategory::kCodecQueues), before);
+}
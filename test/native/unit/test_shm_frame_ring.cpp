@@ -0,0 +1,166 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for ShmFrameRing.
+// Validates slot hand-off order, timeouts and close semantics, within one
+// process and between a forked producer and its parent.
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "src/shm_frame_ring.h"
+
+using namespace webcodecs;
+
+namespace {
+
+std::string UniqueName(const char* test) {
+  return "/wc-ring-test-" + std::to_string(getpid()) + "-" + test;
+}
+
+}  // namespace
+
+TEST(ShmFrameRingTest, CreateRejectsExistingNameAndOpenValidates) {
+  std::string name = UniqueName("create");
+  std::string error;
+  auto ring = ShmFrameRing::Create(name, 3, 1000, &error);
+  ASSERT_TRUE(ring) << error;
+  EXPECT_EQ(ring->slot_count(), 3u);
+  EXPECT_EQ(ring->slot_size(), 1000u);
+
+  EXPECT_FALSE(ShmFrameRing::Create(name, 3, 1000, &error));
+  EXPECT_FALSE(ShmFrameRing::Create(UniqueName("empty"), 0, 1000, &error));
+
+  auto peer = ShmFrameRing::Open(name, &error);
+  ASSERT_TRUE(peer) << error;
+  EXPECT_FALSE(peer->is_owner());
+  EXPECT_EQ(peer->slot_count(), 3u);
+  EXPECT_EQ(peer->slot_size(), 1000u);
+
+  ring->Close();
+  EXPECT_FALSE(ShmFrameRing::Open(name, &error));
+}
+
+TEST(ShmFrameRingTest, SlotsAreDeliveredInOrderAcrossMappings) {
+  std::string error;
+  auto producer = ShmFrameRing::Create(UniqueName("order"), 2, 64, &error);
+  ASSERT_TRUE(producer) << error;
+  auto consumer = ShmFrameRing::Open(producer->name(), &error);
+  ASSERT_TRUE(consumer) << error;
+
+  for (int64_t ts = 0; ts < 6; ++ts) {
+    int slot = producer->AcquireWrite(0);
+    ASSERT_GE(slot, 0);
+    producer->SlotInfo(slot)->timestamp = ts;
+    producer->SlotData(slot)[0] = static_cast<uint8_t>(ts);
+    producer->Publish(slot);
+
+    int read = consumer->AcquireRead(0);
+    ASSERT_EQ(read, slot);
+    EXPECT_EQ(consumer->SlotInfo(read)->timestamp, ts);
+    EXPECT_EQ(consumer->SlotData(read)[0], ts);
+    consumer->Release(read);
+  }
+  producer->Close();
+}
+
+TEST(ShmFrameRingTest, ProducerWaitsForOldestSlot) {
+  std::string error;
+  auto ring = ShmFrameRing::Create(UniqueName("full"), 2, 64, &error);
+  ASSERT_TRUE(ring) << error;
+  EXPECT_EQ(ring->AcquireRead(0), ShmFrameRing::kTimedOut);
+
+  ring->Publish(ring->AcquireWrite(0));
+  ring->Publish(ring->AcquireWrite(0));
+  EXPECT_EQ(ring->AcquireWrite(10), ShmFrameRing::kTimedOut);
+
+  int first = ring->AcquireRead(0);
+  int second = ring->AcquireRead(0);
+  // Releasing the newer slot does not help: slots are reused in order.
+  ring->Release(second);
+  EXPECT_EQ(ring->AcquireWrite(0), ShmFrameRing::kTimedOut);
+
+  std::thread releaser([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ring->Release(first);
+  });
+  EXPECT_EQ(ring->AcquireWrite(2000), first);
+  releaser.join();
+  ring->Close();
+}
+
+TEST(ShmFrameRingTest, CloseWakesWaitersAndDrainsPublishedSlots) {
+  std::string error;
+  auto ring = ShmFrameRing::Create(UniqueName("close"), 2, 64, &error);
+  ASSERT_TRUE(ring) << error;
+  ring->Publish(ring->AcquireWrite(0));
+
+  EXPECT_GE(ring->AcquireRead(0), 0);
+  std::thread closer([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ring->Close();
+  });
+  EXPECT_EQ(ring->AcquireRead(-1), ShmFrameRing::kClosed);
+  closer.join();
+  EXPECT_TRUE(ring->closed());
+  EXPECT_EQ(ring->AcquireWrite(0), ShmFrameRing::kClosed);
+}
+
+TEST(ShmFrameRingTest, ForkedProducerHandsFramesToParent) {
+  constexpr int kFrames = 50;
+  constexpr size_t kSlotSize = 4096;
+  std::string error;
+  auto ring = ShmFrameRing::Create(UniqueName("fork"), 3, kSlotSize, &error);
+  ASSERT_TRUE(ring) << error;
+
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    auto producer = ShmFrameRing::Open(ring->name(), &error);
+    if (!producer) {
+      _exit(1);
+    }
+    for (int i = 0; i < kFrames; ++i) {
+      int slot = producer->AcquireWrite(5000);
+      if (slot < 0) {
+        _exit(2);
+      }
+      ShmFrameInfo* info = producer->SlotInfo(slot);
+      info->timestamp = i * 1000;
+      info->data_size = kSlotSize;
+      std::memset(producer->SlotData(slot), i, kSlotSize);
+      producer->Publish(slot);
+    }
+    producer->Close();
+    _exit(0);
+  }
+
+  int received = 0;
+  for (;;) {
+    int slot = ring->AcquireRead(5000);
+    if (slot == ShmFrameRing::kClosed) {
+      break;
+    }
+    ASSERT_GE(slot, 0);
+    ShmFrameInfo* info = ring->SlotInfo(slot);
+    EXPECT_EQ(info->timestamp, received * 1000);
+    const uint8_t* data = ring->SlotData(slot);
+    EXPECT_EQ(data[0], received);
+    EXPECT_EQ(data[kSlotSize - 1], received);
+    ring->Release(slot);
+    ++received;
+  }
+  EXPECT_EQ(received, kFrames);
+
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+}
@@ -0,0 +1,275 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for SpscControlMessageQueue, the lock-free ring variant
+// of ControlMessageQueue. Shared spec semantics are covered for both queues
+// in spec/test_queue_semantics.cpp; these tests cover what is specific to
+// the ring (capacity, deferred Clear(), futex wakeups).
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "src/shared/spsc_control_queue.h"
+#include "test_utils.h"
+
+using namespace webcodecs;
+using namespace webcodecs::testing;
+
+namespace {
+
+VideoSpscControlQueue::Message Flush(uint32_t id) {
+  VideoSpscControlQueue::FlushMessage msg;
+  msg.promise_id = id;
+  return msg;
+}
+
+uint32_t FlushId(const VideoSpscControlQueue::Message& msg) {
+  return std::get<VideoSpscControlQueue::FlushMessage>(msg).promise_id;
+}
+
+}  // namespace
+
+class SpscControlQueueTest : public ::testing::Test {
+ protected:
+  VideoSpscControlQueue queue_{8};
+};
+
+// =============================================================================
+// CAPACITY
+// =============================================================================
+
+TEST_F(SpscControlQueueTest, Capacity_RoundsUpToPowerOfTwo) {
+  VideoSpscControlQueue queue(5);
+  EXPECT_EQ(queue.capacity(), 8u);
+  EXPECT_EQ(queue_.capacity(), 8u);
+}
+
+TEST_F(SpscControlQueueTest, Enqueue_WhenFull_ReturnsFalse) {
+  for (uint32_t i = 0; i < 8; ++i) {
+    EXPECT_TRUE(queue_.Enqueue(Flush(i)));
+  }
+  EXPECT_FALSE(queue_.Enqueue(Flush(8)));
+  EXPECT_EQ(queue_.size(), 8u);
+
+  // One slot frees up once the consumer takes a message.
+  auto msg = queue_.TryDequeue();
+  ASSERT_TRUE(msg.has_value());
+  EXPECT_EQ(FlushId(*msg), 0u);
+  EXPECT_TRUE(queue_.Enqueue(Flush(8)));
+  EXPECT_FALSE(queue_.Enqueue(Flush(9)));
+}
+
+TEST_F(SpscControlQueueTest, Wraparound_PreservesFIFOOrder) {
+  uint32_t next_in = 0;
+  uint32_t next_out = 0;
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_TRUE(queue_.Enqueue(Flush(next_in++)));
+    }
+    for (int i = 0; i < 5; ++i) {
+      auto msg = queue_.TryDequeue();
+      ASSERT_TRUE(msg.has_value());
+      EXPECT_EQ(FlushId(*msg), next_out++);
+    }
+  }
+  EXPECT_TRUE(queue_.empty());
+}
+
+// =============================================================================
+// CLEAR
+// =============================================================================
+
+TEST_F(SpscControlQueueTest, Clear_DropsPendingMessagesAtOnce) {
+  for (uint32_t i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue_.Enqueue(Flush(i)));
+  }
+
+  EXPECT_EQ(queue_.Clear(), 4u);
+  EXPECT_EQ(queue_.size(), 0u);
+  EXPECT_TRUE(queue_.empty());
+  EXPECT_EQ(queue_.Peek(), nullptr);
+
+  // Messages after the clear are delivered normally.
+  ASSERT_TRUE(queue_.Enqueue(Flush(42)));
+  auto msg = queue_.TryDequeue();
+  ASSERT_TRUE(msg.has_value());
+  EXPECT_EQ(FlushId(*msg), 42u);
+}
+
+TEST_F(SpscControlQueueTest, Clear_ReleasesPacketsOnNextConsumerCall) {
+  const uint8_t payload[4] = {1, 2, 3, 4};
+  auto packet = CreateTestPacket(payload, sizeof(payload));
+  ASSERT_NE(packet, nullptr);
+  AVBufferRef* buf = av_buffer_ref(packet->buf);
+  ASSERT_NE(buf, nullptr);
+
+  VideoSpscControlQueue::DecodeMessage msg;
+  msg.packet = std::move(packet);
+  ASSERT_TRUE(queue_.Enqueue(std::move(msg)));
+  EXPECT_EQ(av_buffer_get_ref_count(buf), 2);
+
+  EXPECT_EQ(queue_.ClearFrames(), 1u);
+  EXPECT_FALSE(queue_.TryDequeue().has_value());
+  EXPECT_EQ(av_buffer_get_ref_count(buf), 1);
+  av_buffer_unref(&buf);
+}
+
+TEST_F(SpscControlQueueTest, PopFront_AfterClear_DoesNotDropNewMessages) {
+  ASSERT_TRUE(queue_.Enqueue(Flush(1)));
+  ASSERT_NE(queue_.Peek(), nullptr);
+
+  queue_.Clear();
+  ASSERT_TRUE(queue_.Enqueue(Flush(2)));
+  queue_.PopFront();  // The peeked message went with the clear
+
+  auto msg = queue_.TryDequeue();
+  ASSERT_TRUE(msg.has_value());
+  EXPECT_EQ(FlushId(*msg), 2u);
+}
+
+TEST_F(SpscControlQueueTest, Clear_FromProducer_WhileConsumerRuns) {
+  VideoSpscControlQueue queue(64);
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> last_seen{0};
+  std::atomic<bool> out_of_order{false};
+
+  std::thread consumer([&]() {
+    while (!done.load()) {
+      auto msg = queue.DequeueFor(std::chrono::milliseconds(10));
+      if (!msg.has_value()) {
+        continue;
+      }
+      uint32_t id = FlushId(*msg);
+      if (id <= last_seen.load()) {
+        out_of_order.store(true);
+      }
+      last_seen.store(id);
+    }
+  });
+
+  uint32_t id = 1;
+  for (int round = 0; round < 200; ++round) {
+    for (int i = 0; i < 16; ++i) {
+      while (!queue.Enqueue(Flush(id))) {
+        std::this_thread::yield();
+      }
+      ++id;
+    }
+    if (round % 3 == 0) {
+      queue.Clear();
+    }
+  }
+  ASSERT_TRUE(queue.Enqueue(Flush(id)));
+
+  // The final message always arrives.
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (last_seen.load() != id && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  done.store(true);
+  consumer.join();
+
+  EXPECT_EQ(last_seen.load(), id);
+  EXPECT_FALSE(out_of_order.load());
+  EXPECT_TRUE(queue.empty());
+}
+
+// =============================================================================
+// WAKEUPS
+// =============================================================================
+
+TEST_F(SpscControlQueueTest, DequeueFor_TimesOutWhenEmpty) {
+  auto start = std::chrono::steady_clock::now();
+  auto result = queue_.DequeueFor(std::chrono::milliseconds(50));
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_FALSE(result.has_value());
+  EXPECT_GE(elapsed, std::chrono::milliseconds(40));  // Allow some jitter
+}
+
+TEST_F(SpscControlQueueTest, Dequeue_WakesOnEnqueue) {
+  std::thread producer([this]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    (void)queue_.Enqueue(Flush(7));
+  });
+
+  auto result = queue_.Dequeue();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(FlushId(*result), 7u);
+
+  producer.join();
+}
+
+TEST_F(SpscControlQueueTest, Shutdown_WakesBlockedDequeue) {
+  SimpleLatch returned;
+  std::thread consumer([&]() {
+    auto result = queue_.Dequeue();
+    EXPECT_FALSE(result.has_value());
+    returned.Signal();
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  queue_.Shutdown();
+
+  ASSERT_TRUE(returned.Wait(std::chrono::seconds(5)));
+  consumer.join();
+  EXPECT_FALSE(queue_.Enqueue(Flush(1)));
+}
+
+TEST_F(SpscControlQueueTest, Shutdown_DrainsRemainingMessages) {
+  ASSERT_TRUE(queue_.Enqueue(Flush(1)));
+  queue_.Shutdown();
+
+  auto msg = queue_.Dequeue();
+  ASSERT_TRUE(msg.has_value());
+  EXPECT_EQ(FlushId(*msg), 1u);
+  EXPECT_FALSE(queue_.Dequeue().has_value());
+}
+
+TEST_F(SpscControlQueueTest, ReadyCallback_RunsAfterEnqueue) {
+  int calls = 0;
+  queue_.SetReadyCallback([&]() { ++calls; });
+  ASSERT_TRUE(queue_.Enqueue(Flush(1)));
+  ASSERT_TRUE(queue_.Enqueue(Flush(2)));
+  queue_.SetReadyCallback(nullptr);
+  ASSERT_TRUE(queue_.Enqueue(Flush(3)));
+
+  EXPECT_EQ(calls, 2);
+}
+
+// =============================================================================
+// STRESS
+// =============================================================================
+
+TEST_F(SpscControlQueueTest, ProducerConsumer_DeliversEverythingInOrder) {
+  VideoSpscControlQueue queue(16);
+  constexpr uint32_t kMessageCount = 200000;
+  std::vector<uint32_t> mismatches;
+
+  std::thread consumer([&]() {
+    for (uint32_t expected = 0; expected < kMessageCount; ++expected) {
+      auto msg = queue.Dequeue();
+      if (!msg.has_value()) {
+        mismatches.push_back(expected);
+        return;
+      }
+      if (FlushId(*msg) != expected) {
+        mismatches.push_back(expected);
+      }
+    }
+  });
+
+  for (uint32_t i = 0; i < kMessageCount; ++i) {
+    while (!queue.Enqueue(Flush(i))) {
+      std::this_thread::yield();  // Full: let the consumer catch up
+    }
+  }
+  consumer.join();
+
+  EXPECT_TRUE(mismatches.empty());
+  EXPECT_TRUE(queue.empty());
+}
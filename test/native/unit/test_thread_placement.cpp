@@ -0,0 +1,152 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for ThreadPlacement.
+// Validates CPU list parsing, placement validation and that a placement
+// applied to a thread carries over to the threads it starts (Linux).
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "src/thread_placement.h"
+
+using namespace webcodecs;
+
+TEST(ThreadPlacementTest, ParsesCpuLists) {
+  std::vector<int> cpus;
+  ASSERT_TRUE(ParseCpuList("0-3,8,10-11\n", &cpus));
+  EXPECT_EQ(cpus, (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+
+  ASSERT_TRUE(ParseCpuList("5", &cpus));
+  EXPECT_EQ(cpus, (std::vector<int>{5}));
+
+  // Memory-only NUMA nodes list no CPUs.
+  ASSERT_TRUE(ParseCpuList("\n", &cpus));
+  EXPECT_TRUE(cpus.empty());
+}
+
+TEST(ThreadPlacementTest, RejectsMalformedCpuLists) {
+  std::vector<int> cpus;
+  EXPECT_FALSE(ParseCpuList("3-1", &cpus));
+  EXPECT_FALSE(ParseCpuList("0,,2", &cpus));
+  EXPECT_FALSE(ParseCpuList("a-b", &cpus));
+  EXPECT_FALSE(ParseCpuList("1-", &cpus));
+}
+
+TEST(ThreadPlacementTest, DefaultPlacementDoesNothing) {
+  ThreadPlacement placement;
+  EXPECT_TRUE(placement.IsDefault());
+
+  std::string error;
+  EXPECT_TRUE(ValidateThreadPlacement(placement, &error));
+  EXPECT_TRUE(ApplyThreadPlacement(placement, &error));
+  EXPECT_EQ(CurrentNumaNode(), -1);
+}
+
+TEST(ThreadPlacementTest, RejectsMissingCpu) {
+  ThreadPlacement placement;
+  placement.cpus = {1 << 20};
+
+  std::string error;
+  EXPECT_FALSE(ValidateThreadPlacement(placement, &error));
+  EXPECT_NE(error.find("no CPU"), std::string::npos);
+}
+
+#ifdef __linux__
+
+TEST(ThreadPlacementTest, RejectsMissingNumaNode) {
+  ThreadPlacement placement;
+  placement.numa_node = kMaxNumaNodes - 1;
+
+  std::string error;
+  EXPECT_FALSE(ValidateThreadPlacement(placement, &error));
+  EXPECT_NE(error.find("no NUMA node"), std::string::npos);
+}
+
+TEST(ThreadPlacementTest, PinnedThreadsStartPinned) {
+  cpu_set_t allowed;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+  int cpu = 0;
+  while (!CPU_ISSET(cpu, &allowed)) {
+    ++cpu;
+  }
+
+  ThreadPlacement placement;
+  placement.cpus = {cpu};
+  placement.priority = ThreadPriority::kBackground;
+
+  bool applied = false;
+  int child_cpus = 0;
+  bool child_on_cpu = false;
+  int child_nice = 0;
+  std::thread worker([&] {
+    std::string error;
+    applied = ApplyThreadPlacement(placement, &error);
+    // Stands in for the FFmpeg threads a worker starts.
+    std::thread child([&] {
+      cpu_set_t set;
+      pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+      child_cpus = CPU_COUNT(&set);
+      child_on_cpu = CPU_ISSET(cpu, &set);
+      child_nice = getpriority(PRIO_PROCESS,
+                               static_cast<id_t>(syscall(SYS_gettid)));
+    });
+    child.join();
+  });
+  worker.join();
+
+  EXPECT_TRUE(applied);
+  EXPECT_EQ(child_cpus, 1);
+  EXPECT_TRUE(child_on_cpu);
+  EXPECT_EQ(child_nice, 19);
+
+  // The calling thread is untouched.
+  cpu_set_t self;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(self), &self), 0);
+  EXPECT_EQ(CPU_COUNT(&self), CPU_COUNT(&allowed));
+}
+
+TEST(ThreadPlacementTest, NumaNodeSetsCpusAndNode) {
+  std::vector<int> node_cpus = NumaNodeCpus(0);
+  if (node_cpus.empty()) {
+    GTEST_SKIP() << "No NUMA node 0 with CPUs";
+  }
+
+  ThreadPlacement placement;
+  placement.numa_node = 0;
+  std::string error;
+  ASSERT_TRUE(ValidateThreadPlacement(placement, &error)) << error;
+
+  bool applied = false;
+  int node = -1;
+  int cpus = 0;
+  std::thread worker([&] {
+    applied = ApplyThreadPlacement(placement, &error);
+    node = CurrentNumaNode();
+    cpu_set_t set;
+    pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+    cpus = CPU_COUNT(&set);
+  });
+  worker.join();
+
+  if (!applied && error.find("set_mempolicy") != std::string::npos) {
+    GTEST_SKIP() << "Kernel without NUMA support: " << error;
+  }
+  ASSERT_TRUE(applied) << error;
+  EXPECT_EQ(node, 0);
+  EXPECT_LE(cpus, static_cast<int>(node_cpus.size()));
+  EXPECT_EQ(CurrentNumaNode(), -1);  // Per thread
+}
+
+#endif  // __linux__
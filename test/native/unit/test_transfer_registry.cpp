@@ -0,0 +1,104 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for TransferRegistry.
+// Validates that payloads move through without copying and that every
+// handle can be claimed exactly once, including from several threads.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/transfer_registry.h"
+
+using namespace webcodecs;
+
+namespace {
+
+ffmpeg::AVPacketPtr MakePacket(uint8_t fill) {
+  uint8_t data[16];
+  std::fill(data, data + sizeof(data), fill);
+  return ffmpeg::make_packet_copy(data, sizeof(data));
+}
+
+}  // namespace
+
+TEST(TransferRegistryTest, TakeMovesPayloadWithoutCopy) {
+  TransferRegistry& registry = TransferRegistry::Instance();
+  ffmpeg::AVPacketPtr packet = MakePacket(7);
+  const uint8_t* payload_data = packet->data;
+
+  TransferPayload payload;
+  payload.packet = std::move(packet);
+  uint64_t handle = registry.Put(std::move(payload));
+  EXPECT_GT(handle, 0u);
+
+  TransferPayload taken;
+  ASSERT_TRUE(registry.Take(handle, &taken));
+  ASSERT_TRUE(taken.packet);
+  EXPECT_EQ(taken.packet->data, payload_data);
+  EXPECT_EQ(taken.packet->data[0], 7);
+}
+
+TEST(TransferRegistryTest, HandleIsClaimedOnce) {
+  TransferRegistry& registry = TransferRegistry::Instance();
+  TransferPayload payload;
+  payload.data.assign(1024, 3);
+  const uint8_t* bytes = payload.data.data();
+  uint64_t handle = registry.Put(std::move(payload));
+
+  TransferPayload first, second;
+  ASSERT_TRUE(registry.Take(handle, &first));
+  EXPECT_EQ(first.data.data(), bytes);
+  EXPECT_FALSE(registry.Take(handle, &second));
+  EXPECT_FALSE(registry.Release(handle));
+  EXPECT_FALSE(registry.Take(0, &second));
+}
+
+TEST(TransferRegistryTest, ReleaseFreesUnclaimedPayload) {
+  TransferRegistry& registry = TransferRegistry::Instance();
+  size_t before = registry.size();
+  TransferPayload payload;
+  payload.frame = ffmpeg::make_frame();
+  uint64_t handle = registry.Put(std::move(payload));
+  EXPECT_EQ(registry.size(), before + 1);
+
+  EXPECT_TRUE(registry.Release(handle));
+  EXPECT_EQ(registry.size(), before);
+  TransferPayload taken;
+  EXPECT_FALSE(registry.Take(handle, &taken));
+}
+
+TEST(TransferRegistryTest, ConcurrentClaimsSucceedExactlyOnce) {
+  TransferRegistry& registry = TransferRegistry::Instance();
+  constexpr int kHandles = 1000;
+  constexpr int kThreads = 4;
+  std::vector<uint64_t> handles;
+  for (int i = 0; i < kHandles; ++i) {
+    TransferPayload payload;
+    payload.packet = MakePacket(static_cast<uint8_t>(i));
+    handles.push_back(registry.Put(std::move(payload)));
+  }
+
+  std::atomic<int> claimed{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      for (uint64_t handle : handles) {
+        TransferPayload payload;
+        if (registry.Take(handle, &payload)) {
+          claimed.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(claimed.load(), kHandles);
+}
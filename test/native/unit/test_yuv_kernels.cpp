@@ -0,0 +1,269 @@
+// Copyright 2024 The node-webcodecs Authors
+// SPDX-License-Identifier: MIT
+//
+// Native unit tests for the YUV kernels.
+// Validates both directions against a floating-point reference, including
+// odd sizes that end in the scalar tail.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "src/yuv_kernels.h"
+
+using namespace webcodecs;
+
+namespace {
+
+struct YuvImage {
+  int width;
+  int height;
+  int chroma_width;
+  std::vector<uint8_t> y, u, v, uv;  // u/v for I420, uv for NV12 and P010
+  int y_linesize, c_linesize;
+};
+
+uint8_t Pattern(int x, int y, int salt) {
+  return static_cast<uint8_t>((x * 37 + y * 11 + salt * 101) & 0xff);
+}
+
+YuvImage MakeYuv(YuvLayout layout, int width, int height) {
+  YuvImage img;
+  img.width = width;
+  img.height = height;
+  img.chroma_width = (width + 1) / 2;
+  int chroma_height = (height + 1) / 2;
+  int sample = layout == YuvLayout::kP010 ? 2 : 1;
+  img.y_linesize = width * sample + 7;  // Unaligned rows
+  img.y.resize(static_cast<size_t>(img.y_linesize) * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      uint8_t v = Pattern(x, y, 0);
+      if (sample == 2) {
+        uint16_t s = static_cast<uint16_t>((v * 4 + (x & 3)) << 6);
+        std::memcpy(&img.y[y * img.y_linesize + x * 2], &s, 2);
+      } else {
+        img.y[y * img.y_linesize + x] = v;
+      }
+    }
+  }
+  if (layout == YuvLayout::kI420) {
+    img.c_linesize = img.chroma_width + 3;
+    img.u.resize(static_cast<size_t>(img.c_linesize) * chroma_height);
+    img.v.resize(img.u.size());
+    for (int y = 0; y < chroma_height; ++y) {
+      for (int x = 0; x < img.chroma_width; ++x) {
+        img.u[y * img.c_linesize + x] = Pattern(x, y, 1);
+        img.v[y * img.c_linesize + x] = Pattern(x, y, 2);
+      }
+    }
+  } else {
+    img.c_linesize = img.chroma_width * 2 * sample + 5;
+    img.uv.resize(static_cast<size_t>(img.c_linesize) * chroma_height);
+    for (int y = 0; y < chroma_height; ++y) {
+      for (int x = 0; x < img.chroma_width; ++x) {
+        for (int c = 0; c < 2; ++c) {
+          uint8_t v = Pattern(x, y, 1 + c);
+          if (sample == 2) {
+            uint16_t s = static_cast<uint16_t>((v * 4 + 3) << 6);
+            std::memcpy(&img.uv[y * img.c_linesize + (x * 2 + c) * 2], &s, 2);
+          } else {
+            img.uv[y * img.c_linesize + x * 2 + c] = v;
+          }
+        }
+      }
+    }
+  }
+  return img;
+}
+
+// Samples of pixel (x, y) normalised to 8-bit units.
+void SampleAt(const YuvImage& img, YuvLayout layout, int x, int y, double* yv,
+              double* u, double* v) {
+  int cx = x / 2;
+  int cy = y / 2;
+  if (layout == YuvLayout::kI420) {
+    *yv = img.y[y * img.y_linesize + x];
+    *u = img.u[cy * img.c_linesize + cx];
+    *v = img.v[cy * img.c_linesize + cx];
+  } else if (layout == YuvLayout::kNV12) {
+    *yv = img.y[y * img.y_linesize + x];
+    *u = img.uv[cy * img.c_linesize + cx * 2];
+    *v = img.uv[cy * img.c_linesize + cx * 2 + 1];
+  } else {
+    uint16_t s[3];
+    std::memcpy(&s[0], &img.y[y * img.y_linesize + x * 2], 2);
+    std::memcpy(&s[1], &img.uv[cy * img.c_linesize + cx * 4], 2);
+    std::memcpy(&s[2], &img.uv[cy * img.c_linesize + cx * 4 + 2], 2);
+    *yv = (s[0] >> 6) / 4.0;
+    *u = (s[1] >> 6) / 4.0;
+    *v = (s[2] >> 6) / 4.0;
+  }
+}
+
+double Clamp(double v) { return std::min(255.0, std::max(0.0, v)); }
+
+// Largest difference from the reference over the image.
+int YuvToRgbError(YuvLayout layout, int width, int height, bool bgr,
+                  double kr, double kb, YuvMatrix matrix, bool full_range) {
+  YuvImage img = MakeYuv(layout, width, height);
+  const uint8_t* planes[3] = {
+      img.y.data(), layout == YuvLayout::kI420 ? img.u.data() : img.uv.data(),
+      layout == YuvLayout::kI420 ? img.v.data() : nullptr};
+  const int linesizes[3] = {img.y_linesize, img.c_linesize, img.c_linesize};
+  int rgb_linesize = width * 4 + 12;
+  std::vector<uint8_t> rgb(static_cast<size_t>(rgb_linesize) * height, 0);
+  ConvertYuvToRgb(layout, planes, linesizes, rgb.data(), rgb_linesize, bgr,
+                  width, height, matrix, full_range);
+
+  double kg = 1 - kr - kb;
+  double ys = full_range ? 1 : 255.0 / 219;
+  double cs = full_range ? 1 : 255.0 / 224;
+  double y0 = full_range ? 0 : 16;
+  int worst = 0;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      double yv, u, v;
+      SampleAt(img, layout, x, y, &yv, &u, &v);
+      double l = ys * (yv - y0);
+      u = cs * (u - 128);
+      v = cs * (v - 128);
+      double ref[3] = {Clamp(l + 2 * (1 - kr) * v),
+                       Clamp(l - 2 * (1 - kb) * kb / kg * u -
+                             2 * (1 - kr) * kr / kg * v),
+                       Clamp(l + 2 * (1 - kb) * u)};
+      const uint8_t* px = &rgb[y * rgb_linesize + x * 4];
+      for (int c = 0; c < 3; ++c) {
+        int got = px[bgr ? 2 - c : c];
+        worst = std::max(worst,
+                         static_cast<int>(std::lround(std::abs(got - ref[c]))));
+      }
+      EXPECT_EQ(px[3], 255);
+    }
+  }
+  return worst;
+}
+
+TEST(YuvKernelsTest, YuvToRgbMatchesReference) {
+  for (YuvLayout layout :
+       {YuvLayout::kI420, YuvLayout::kNV12, YuvLayout::kP010}) {
+    for (int width : {1, 2, 7, 8, 9, 16, 33, 64}) {
+      for (bool bgr : {false, true}) {
+        EXPECT_LE(YuvToRgbError(layout, width, 5, bgr, 0.299, 0.114,
+                                YuvMatrix::kBT601, false),
+                  1)
+            << "layout " << static_cast<int>(layout) << " width " << width;
+      }
+    }
+  }
+}
+
+TEST(YuvKernelsTest, YuvToRgbHonoursMatrixAndRange) {
+  EXPECT_LE(YuvToRgbError(YuvLayout::kNV12, 40, 4, false, 0.2126, 0.0722,
+                          YuvMatrix::kBT709, false),
+            1);
+  EXPECT_LE(YuvToRgbError(YuvLayout::kI420, 40, 4, false, 0.2627, 0.0593,
+                          YuvMatrix::kBT2020, true),
+            1);
+  EXPECT_LE(YuvToRgbError(YuvLayout::kP010, 40, 4, true, 0.212, 0.087,
+                          YuvMatrix::kSMPTE240M, false),
+            1);
+}
+
+TEST(YuvKernelsTest, LimitedRangeExtremesMapToBlackAndWhite) {
+  uint8_t y[16], u[8], v[8];
+  uint8_t rgb[64];
+  const uint8_t* planes[3] = {y, u, v};
+  const int linesizes[3] = {16, 8, 8};
+  std::memset(u, 128, sizeof(u));
+  std::memset(v, 128, sizeof(v));
+  for (uint8_t level : {16, 235}) {
+    std::memset(y, level, sizeof(y));
+    ConvertYuvToRgb(YuvLayout::kI420, planes, linesizes, rgb, 64, false, 16,
+                    1, YuvMatrix::kBT601, false);
+    for (int i = 0; i < 64; ++i) {
+      EXPECT_EQ(rgb[i], (i % 4 == 3 || level == 235) ? 255 : 0);
+    }
+  }
+}
+
+TEST(YuvKernelsTest, RgbToYuvMatchesReference) {
+  const double kr = 0.299, kb = 0.114, kg = 1 - kr - kb;
+  for (YuvLayout layout : {YuvLayout::kI420, YuvLayout::kNV12}) {
+    for (int width : {1, 3, 8, 9, 17, 64}) {
+      for (int height : {1, 2, 5}) {
+        for (bool bgr : {false, true}) {
+          int rgb_linesize = width * 4 + 4;
+          std::vector<uint8_t> rgb(static_cast<size_t>(rgb_linesize) * height);
+          for (size_t i = 0; i < rgb.size(); ++i) {
+            rgb[i] = static_cast<uint8_t>((i * 53 + 7) & 0xff);
+          }
+          int chroma_width = (width + 1) / 2;
+          int chroma_height = (height + 1) / 2;
+          int y_linesize = width + 3;
+          int c_linesize = layout == YuvLayout::kNV12 ? chroma_width * 2 + 1
+                                                      : chroma_width + 1;
+          std::vector<uint8_t> y_plane(y_linesize * height);
+          std::vector<uint8_t> u_plane(c_linesize * chroma_height);
+          std::vector<uint8_t> v_plane(c_linesize * chroma_height);
+          uint8_t* planes[3] = {y_plane.data(), u_plane.data(),
+                                v_plane.data()};
+          const int linesizes[3] = {y_linesize, c_linesize, c_linesize};
+          ConvertRgbToYuv(rgb.data(), rgb_linesize, bgr, layout, planes,
+                          linesizes, width, height);
+
+          auto channel = [&](int x, int y, int c) -> double {
+            int index = bgr ? 2 - c : c;
+            return rgb[y * rgb_linesize + x * 4 + index];
+          };
+          for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+              double ref = 16 + 219.0 / 255 *
+                                    (kr * channel(x, y, 0) +
+                                     kg * channel(x, y, 1) +
+                                     kb * channel(x, y, 2));
+              EXPECT_LE(std::abs(y_plane[y * y_linesize + x] - ref), 1.0)
+                  << "Y at " << x << "," << y << " width " << width;
+            }
+          }
+          for (int cy = 0; cy < chroma_height; ++cy) {
+            for (int cx = 0; cx < chroma_width; ++cx) {
+              double avg[3] = {0, 0, 0};
+              for (int dy = 0; dy < 2; ++dy) {
+                for (int dx = 0; dx < 2; ++dx) {
+                  int x = std::min(cx * 2 + dx, width - 1);
+                  int y = std::min(cy * 2 + dy, height - 1);
+                  for (int c = 0; c < 3; ++c) {
+                    avg[c] += channel(x, y, c) / 4;
+                  }
+                }
+              }
+              double luma = kr * avg[0] + kg * avg[1] + kb * avg[2];
+              double u_ref = 128 + 224.0 / 255 * (avg[2] - luma) /
+                                       (2 * (1 - kb));
+              double v_ref = 128 + 224.0 / 255 * (avg[0] - luma) /
+                                       (2 * (1 - kr));
+              uint8_t u, v;
+              if (layout == YuvLayout::kNV12) {
+                u = u_plane[cy * c_linesize + cx * 2];
+                v = u_plane[cy * c_linesize + cx * 2 + 1];
+              } else {
+                u = u_plane[cy * c_linesize + cx];
+                v = v_plane[cy * c_linesize + cx];
+              }
+              EXPECT_LE(std::abs(u - u_ref), 1.0) << "U at " << cx;
+              EXPECT_LE(std::abs(v - v_ref), 1.0) << "V at " << cx;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
@@ -293,6 +293,35 @@ describe('AudioSampleFormat: 9.3', () => {
 
       audio.close();
     });
+
+    // Spec 9.2.5: planeIndex is validated against the destination format
+    it('should extract one channel of interleaved data into a planar format', () => {
+      // 6 channels, channel c of frame i holds (c + 1) / 10
+      const data = new Float32Array(4 * 6);
+      for (let i = 0; i < 4; i++) {
+        for (let c = 0; c < 6; c++) data[i * 6 + c] = (c + 1) / 10;
+      }
+      const audio = new AudioData({
+        format: 'f32',
+        sampleRate: 48000,
+        numberOfFrames: 4,
+        numberOfChannels: 6,
+        timestamp: 0,
+        data,
+      });
+
+      const center = new Float32Array(4);
+      audio.copyTo(center, { planeIndex: 2, format: 'f32-planar' });
+      assert.deepStrictEqual(Array.from(center), Array(4).fill(Math.fround(0.3)));
+
+      const right = new Int16Array(4);
+      assert.strictEqual(audio.allocationSize({ planeIndex: 1, format: 's16-planar' }), 8);
+      audio.copyTo(right, { planeIndex: 1, format: 's16-planar' });
+      for (const sample of right) assert.ok(Math.abs(sample - 0.2 * 32767) <= 1, `${sample}`);
+
+      assert.throws(() => audio.allocationSize({ planeIndex: 6, format: 'f32-planar' }), RangeError);
+      audio.close();
+    });
   });
 
   describe('9.3.2 Magnitude of Audio Samples', () => {
@@ -0,0 +1,189 @@
+// test/unit/codec-stats.test.ts
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+
+import {
+  type CodecStats,
+  type EncodedVideoChunk,
+  startTracing,
+  stopTracing,
+  VideoDecoder,
+  VideoEncoder,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+const WIDTH = 128;
+const HEIGHT = 96;
+const FRAMES = 10;
+
+async function encodeFrames(encoder: VideoEncoder, chunks: EncodedVideoChunk[]): Promise<void> {
+  encoder.configure({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT, latencyMode: 'realtime' });
+  for (let i = 0; i < FRAMES; i++) {
+    // RGBA input goes through the colour converter, so 'convert' is timed.
+    const frame = new VideoFrame(new Uint8Array(WIDTH * HEIGHT * 4).fill(i * 10), {
+      format: 'RGBA',
+      codedWidth: WIDTH,
+      codedHeight: HEIGHT,
+      timestamp: i * 33333,
+    });
+    encoder.encode(frame, { keyFrame: i === 0 });
+    frame.close();
+  }
+  await encoder.flush();
+  assert.strictEqual(chunks.length, FRAMES);
+}
+
+function newEncoder(chunks: EncodedVideoChunk[]): VideoEncoder {
+  return new VideoEncoder({
+    output: (chunk) => chunks.push(chunk),
+    error: (e) => {
+      throw e;
+    },
+  });
+}
+
+function assertStage(stats: CodecStats, stage: keyof Omit<CodecStats, 'bytesCopied'>, count: number) {
+  const s = stats[stage];
+  assert.strictEqual(s.count, count, `${stage}.count`);
+  assert.ok(s.meanUs >= 0 && s.maxUs >= s.meanUs, `${stage} mean/max`);
+  assert.ok(s.p50Us <= s.p90Us && s.p90Us <= s.p99Us && s.p99Us <= s.maxUs, `${stage} percentiles`);
+}
+
+describe('Codec stats (node-webcodecs extension)', () => {
+  it('should time every encoder stage per frame', async () => {
+    const chunks: EncodedVideoChunk[] = [];
+    const encoder = newEncoder(chunks);
+    await encodeFrames(encoder, chunks);
+
+    const stats = encoder.getStats();
+    assertStage(stats, 'queueWait', FRAMES);
+    assertStage(stats, 'codec', FRAMES);
+    assertStage(stats, 'convert', FRAMES);
+    assertStage(stats, 'delivery', FRAMES);
+    const payload = chunks.reduce((sum, chunk) => sum + chunk.byteLength, 0);
+    assert.ok(stats.bytesCopied >= payload);
+    encoder.close();
+  });
+
+  it('should keep counts across reset() until resetStats()', async () => {
+    const chunks: EncodedVideoChunk[] = [];
+    const encoder = newEncoder(chunks);
+    await encodeFrames(encoder, chunks);
+    encoder.reset();
+    assert.strictEqual(encoder.getStats().codec.count, FRAMES);
+
+    encoder.resetStats();
+    const stats = encoder.getStats();
+    assert.strictEqual(stats.codec.count, 0);
+    assert.strictEqual(stats.bytesCopied, 0);
+    encoder.close();
+  });
+
+  it('should time decoder stages per chunk', async () => {
+    const chunks: EncodedVideoChunk[] = [];
+    const encoder = newEncoder(chunks);
+    await encodeFrames(encoder, chunks);
+    encoder.close();
+
+    const decoder = new VideoDecoder({
+      output: (frame) => frame.close(),
+      error: (e) => {
+        throw e;
+      },
+    });
+    decoder.configure({ codec: 'avc1.42001e', codedWidth: WIDTH, codedHeight: HEIGHT });
+    for (const chunk of chunks) {
+      decoder.decode(chunk);
+    }
+    await decoder.flush();
+
+    const stats = decoder.getStats();
+    assertStage(stats, 'queueWait', FRAMES);
+    assertStage(stats, 'codec', FRAMES);
+    assertStage(stats, 'delivery', FRAMES);
+    assertStage(stats, 'frameLatency', FRAMES);
+    decoder.close();
+  });
+
+  it('should output each frame before the next decode() with optimizeForLatency', async () => {
+    const chunks: EncodedVideoChunk[] = [];
+    const encoder = newEncoder(chunks);
+    await encodeFrames(encoder, chunks);
+    encoder.close();
+
+    let pending: (() => void) | null = null;
+    const decoder = new VideoDecoder({
+      output: (frame) => {
+        frame.close();
+        pending?.();
+      },
+      error: (e) => {
+        throw e;
+      },
+    });
+    decoder.configure({
+      codec: 'avc1.42001e',
+      codedWidth: WIDTH,
+      codedHeight: HEIGHT,
+      optimizeForLatency: true,
+    });
+    for (const chunk of chunks) {
+      const output = new Promise<void>((resolve, reject) => {
+        const timer = setTimeout(() => reject(new Error('frame held by the decoder')), 2000);
+        pending = () => {
+          clearTimeout(timer);
+          resolve();
+        };
+      });
+      decoder.decode(chunk);
+      await output;
+    }
+
+    const stats = decoder.getStats();
+    assertStage(stats, 'frameLatency', FRAMES);
+    decoder.close();
+  });
+});
+
+describe('Codec tracing (node-webcodecs extension)', () => {
+  it('should return Chrome trace-event JSON', async () => {
+    startTracing();
+    const chunks: EncodedVideoChunk[] = [];
+    const encoder = newEncoder(chunks);
+    await encodeFrames(encoder, chunks);
+    encoder.close();
+
+    const trace = JSON.parse(stopTracing());
+    assert.ok(Array.isArray(trace.traceEvents));
+    const encodes = trace.traceEvents.filter(
+      (e: { cat: string; name: string; ph: string }) =>
+        e.cat === 'VideoEncoder' && e.name === 'encode' && e.ph === 'X',
+    );
+    assert.strictEqual(encodes.length, FRAMES);
+    const begins = trace.traceEvents.filter((e: { ph: string }) => e.ph === 'b').length;
+    const ends = trace.traceEvents.filter((e: { ph: string }) => e.ph === 'e').length;
+    assert.strictEqual(begins, ends);
+    assert.strictEqual(trace.otherData.droppedEvents, 0);
+  });
+
+  it('should record nothing once stopped', async () => {
+    startTracing();
+    stopTracing();
+    const chunks: EncodedVideoChunk[] = [];
+    const encoder = newEncoder(chunks);
+    await encodeFrames(encoder, chunks);
+    encoder.close();
+
+    startTracing();
+    const trace = JSON.parse(stopTracing());
+    assert.deepStrictEqual(trace.traceEvents, []);
+  });
+
+  it('should reject an invalid maxEvents', () => {
+    assert.throws(() => startTracing(0), TypeError);
+    assert.throws(() => startTracing(1.5), TypeError);
+    assert.throws(() => startTracing(Infinity), TypeError);
+    assert.throws(() => startTracing(NaN), TypeError);
+  });
+});
@@ -0,0 +1,94 @@
+// test/unit/frame-pool.test.ts
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+
+import {
+  type EncodedVideoChunk,
+  getFramePoolStats,
+  trimFramePool,
+  VideoDecoder,
+  VideoEncoder,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+const WIDTH = 128;
+const HEIGHT = 96;
+
+async function encodeFrames(count: number): Promise<EncodedVideoChunk[]> {
+  const chunks: EncodedVideoChunk[] = [];
+  const encoder = new VideoEncoder({
+    output: (chunk) => chunks.push(chunk),
+    error: (e) => {
+      throw e;
+    },
+  });
+  encoder.configure({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT, latencyMode: 'realtime' });
+  for (let i = 0; i < count; i++) {
+    const frame = new VideoFrame(new Uint8Array(WIDTH * HEIGHT * 4).fill(i * 10), {
+      format: 'RGBA',
+      codedWidth: WIDTH,
+      codedHeight: HEIGHT,
+      timestamp: i * 33333,
+    });
+    encoder.encode(frame, { keyFrame: i === 0 });
+    frame.close();
+  }
+  await encoder.flush();
+  encoder.close();
+  return chunks;
+}
+
+async function decodeAndClose(chunks: EncodedVideoChunk[]): Promise<number> {
+  let frames = 0;
+  const decoder = new VideoDecoder({
+    output: (frame) => {
+      frames++;
+      frame.close();
+    },
+    error: (e) => {
+      throw e;
+    },
+  });
+  decoder.configure({ codec: 'avc1.42001e', codedWidth: WIDTH, codedHeight: HEIGHT });
+  for (const chunk of chunks) {
+    decoder.decode(chunk);
+  }
+  await decoder.flush();
+  decoder.close();
+  return frames;
+}
+
+describe('FramePool', () => {
+  it('should expose hit/miss statistics', () => {
+    const stats = getFramePoolStats();
+    for (const key of ['hits', 'misses', 'allocatedBytes', 'sizeClasses'] as const) {
+      assert.strictEqual(typeof stats[key], 'number');
+      assert.ok(stats[key] >= 0);
+    }
+  });
+
+  it('should recycle buffers returned by VideoFrame.close()', async () => {
+    const chunks = await encodeFrames(5);
+
+    assert.strictEqual(await decodeAndClose(chunks), 5);
+    const before = getFramePoolStats();
+    assert.ok(before.allocatedBytes > 0);
+
+    assert.strictEqual(await decodeAndClose(chunks), 5);
+    const after = getFramePoolStats();
+
+    // Same resolution: the second pass reuses the buffers the first pass
+    // released instead of allocating new ones.
+    assert.ok(after.hits >= before.hits + 5, `hits ${before.hits} -> ${after.hits}`);
+    assert.strictEqual(after.sizeClasses, before.sizeClasses);
+  });
+
+  it('should release idle buffers on trim', async () => {
+    await decodeAndClose(await encodeFrames(2));
+    trimFramePool();
+    const stats = getFramePoolStats();
+    assert.strictEqual(stats.sizeClasses, 0);
+    assert.strictEqual(stats.allocatedBytes, 0);
+  });
+});
@@ -0,0 +1,86 @@
+// test/unit/memory-usage.test.ts
+
+import * as assert from 'node:assert/strict';
+import { afterEach, describe, it } from 'node:test';
+
+import {
+  EncodedVideoChunk,
+  getMemoryUsage,
+  setMemoryLimit,
+  VideoEncoder,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+const WIDTH = 64;
+const HEIGHT = 48;
+const FRAME_BYTES = WIDTH * HEIGHT * 4;
+
+function newFrame(timestamp = 0): VideoFrame {
+  return new VideoFrame(new Uint8Array(FRAME_BYTES), {
+    format: 'RGBA',
+    codedWidth: WIDTH,
+    codedHeight: HEIGHT,
+    timestamp,
+  });
+}
+
+describe('Native memory accounting (node-webcodecs extension)', () => {
+  afterEach(() => {
+    setMemoryLimit(0);
+  });
+
+  it('should report every category with a consistent total', () => {
+    const usage = getMemoryUsage();
+    const sum =
+      usage.videoFrames + usage.audioData + usage.encodedChunks + usage.framePool + usage.codecQueues;
+    assert.strictEqual(usage.total, sum);
+    assert.strictEqual(usage.softLimit, 0);
+  });
+
+  it('should count VideoFrame bytes until close()', () => {
+    const before = getMemoryUsage().videoFrames;
+    const frame = newFrame();
+    assert.strictEqual(getMemoryUsage().videoFrames, before + FRAME_BYTES);
+    frame.close();
+    assert.strictEqual(getMemoryUsage().videoFrames, before);
+  });
+
+  it('should count EncodedVideoChunk bytes until close()', () => {
+    const before = getMemoryUsage().encodedChunks;
+    const chunk = new EncodedVideoChunk({ type: 'key', timestamp: 0, data: new Uint8Array(1000) });
+    assert.strictEqual(getMemoryUsage().encodedChunks, before + 1000);
+    chunk.close();
+    assert.strictEqual(getMemoryUsage().encodedChunks, before);
+  });
+
+  it('should reject encode() above the soft limit', async () => {
+    const encoder = new VideoEncoder({
+      output: (chunk) => chunk.close(),
+      error: (e) => {
+        throw e;
+      },
+    });
+    encoder.configure({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT });
+
+    const held = newFrame();
+    setMemoryLimit(Math.max(1, getMemoryUsage().total - 1));
+    assert.strictEqual(getMemoryUsage().softLimit > 0, true);
+    const frame = newFrame(33333);
+    assert.throws(() => encoder.encode(frame), /QuotaExceededError/);
+    frame.close();
+    held.close();
+
+    setMemoryLimit(0);
+    const next = newFrame(66666);
+    encoder.encode(next, { keyFrame: true });
+    next.close();
+    await encoder.flush();
+    encoder.close();
+  });
+
+  it('should reject an invalid limit', () => {
+    assert.throws(() => setMemoryLimit(-1), TypeError);
+    assert.throws(() => setMemoryLimit(1.5), TypeError);
+    assert.throws(() => setMemoryLimit(NaN), TypeError);
+  });
+});
@@ -0,0 +1,113 @@
+// test/unit/parallel-video-encoder.test.ts
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+
+import {
+  type EncodedVideoChunk,
+  type EncodedVideoChunkMetadata,
+  ParallelVideoEncoder,
+  type ParallelVideoEncoderConfig,
+  VideoDecoder,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+const WIDTH = 160;
+const HEIGHT = 120;
+const FRAMES = 45;
+const SEGMENT = 10;
+
+async function encode(
+  config: Partial<ParallelVideoEncoderConfig>,
+): Promise<Array<[EncodedVideoChunk, EncodedVideoChunkMetadata | undefined]>> {
+  const output: Array<[EncodedVideoChunk, EncodedVideoChunkMetadata | undefined]> = [];
+  const encoder = new ParallelVideoEncoder({
+    output: (chunk, metadata) => output.push([chunk, metadata]),
+    error: (e) => {
+      throw e;
+    },
+  });
+  encoder.configure({
+    codec: 'avc1.64001f',
+    width: WIDTH,
+    height: HEIGHT,
+    segmentLength: SEGMENT,
+    concurrency: 3,
+    ...config,
+  });
+  for (let i = 0; i < FRAMES; i++) {
+    const data = new Uint8Array(WIDTH * HEIGHT * 4);
+    for (let p = 0; p < data.length; p += 4) {
+      data[p] = (p / 4 + i * 4) & 0xff;
+      data[p + 3] = 255;
+    }
+    const frame = new VideoFrame(data, {
+      format: 'RGBA',
+      codedWidth: WIDTH,
+      codedHeight: HEIGHT,
+      timestamp: i * 33333,
+    });
+    encoder.encode(frame);
+    frame.close();
+  }
+  await encoder.flush();
+  encoder.close();
+  return output;
+}
+
+describe('ParallelVideoEncoder (node-webcodecs extension)', () => {
+  it('should emit every segment in order, each opening on a key frame', async () => {
+    const output = await encode({ latencyMode: 'realtime' });
+    assert.strictEqual(output.length, FRAMES);
+    output.forEach(([chunk], i) => {
+      assert.strictEqual(chunk.timestamp, i * 33333);
+      assert.strictEqual(chunk.type === 'key', i % SEGMENT === 0, `chunk ${i}`);
+    });
+  });
+
+  it('should keep decodeTimestamp strictly increasing with B-frames', async () => {
+    const output = await encode({ latencyMode: 'quality' });
+    assert.strictEqual(output.length, FRAMES);
+    for (let i = 1; i < output.length; i++) {
+      assert.ok(output[i][0].decodeTimestamp > output[i - 1][0].decodeTimestamp, `chunk ${i}`);
+    }
+    for (const [chunk] of output) {
+      assert.ok(chunk.decodeTimestamp <= chunk.timestamp);
+    }
+  });
+
+  it('should report decoderConfig once and decode as one stream', async () => {
+    const output = await encode({ latencyMode: 'realtime' });
+    const configs = output.filter(([, metadata]) => metadata?.decoderConfig !== undefined);
+    assert.strictEqual(configs.length, 1);
+
+    let decoded = 0;
+    const decoder = new VideoDecoder({
+      output: (frame) => {
+        decoded++;
+        frame.close();
+      },
+      error: (e) => {
+        throw e;
+      },
+    });
+    const decoderConfig = configs[0][1]?.decoderConfig;
+    assert.ok(decoderConfig);
+    decoder.configure(decoderConfig);
+    for (const [chunk] of output) {
+      decoder.decode(chunk);
+    }
+    await decoder.flush();
+    decoder.close();
+    assert.strictEqual(decoded, FRAMES);
+  });
+
+  it('should reject invalid segmentLength and concurrency', () => {
+    const encoder = new ParallelVideoEncoder({ output: () => {}, error: () => {} });
+    const base = { codec: 'avc1.42001e', width: WIDTH, height: HEIGHT };
+    assert.throws(() => encoder.configure({ ...base, segmentLength: 0 }), TypeError);
+    assert.throws(() => encoder.configure({ ...base, concurrency: 1.5 }), TypeError);
+    encoder.close();
+    assert.strictEqual(encoder.state, 'closed');
+  });
+});
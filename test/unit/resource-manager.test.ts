@@ -386,4 +386,49 @@ describe('ResourceManager', () => {
       // Cleanup - codec was already unregistered by reclamation
     });
   });
+
+  describe('memory pressure (node-webcodecs extension)', () => {
+    it('should do nothing without a memory limit', () => {
+      const codec = new MockCodec();
+      manager.setInactivityTimeout(0);
+      manager.register(codec);
+
+      assert.strictEqual(manager.relieveMemoryPressure(), 0);
+      assert.strictEqual(codec.closeCallCount, 0);
+    });
+
+    it('should trim before reclaiming and stop once under the limit', () => {
+      let usage = 2000;
+      let trims = 0;
+      const codec = new MockCodec();
+      manager.setInactivityTimeout(0);
+      manager.register(codec);
+      manager.setMemoryLimit(1000, {
+        usage: () => usage,
+        trim: () => {
+          trims++;
+          usage = 500;
+        },
+      });
+
+      assert.strictEqual(manager.relieveMemoryPressure(), 0);
+      assert.strictEqual(trims, 1);
+      assert.strictEqual(codec.closeCallCount, 0);
+    });
+
+    it('should reclaim inactive codecs while still over the limit', async () => {
+      const codec = new MockCodec();
+      let received: DOMException | null = null;
+      manager.setInactivityTimeout(5);
+      manager.register(codec, 'decoder', (e) => {
+        received = e;
+      });
+      manager.setMemoryLimit(1000, { usage: () => 2000, trim: () => {} });
+      await new Promise((r) => setTimeout(r, 10));
+
+      assert.strictEqual(manager.relieveMemoryPressure(), 1);
+      assert.strictEqual(codec.closeCallCount, 1);
+      assert.strictEqual((received as DOMException | null)?.name, 'QuotaExceededError');
+    });
+  });
 });
@@ -0,0 +1,146 @@
+// test/unit/shared-frame-ring.test.ts
+
+import * as assert from 'node:assert/strict';
+import { spawn } from 'node:child_process';
+import { describe, it } from 'node:test';
+
+import { SharedFrameRing, VideoFrame } from '@pproenca/node-webcodecs';
+
+const WIDTH = 32;
+const HEIGHT = 16;
+const I420_SIZE = (WIDTH * HEIGHT * 3) / 2;
+
+let counter = 0;
+// Short: macOS limits shm names to 31 characters.
+function ringName(): string {
+  return `/wcfr-${process.pid}-${counter++}`;
+}
+
+function makeFrame(timestamp: number, fill: number): VideoFrame {
+  return new VideoFrame(new Uint8Array(I420_SIZE).fill(fill), {
+    format: 'I420',
+    codedWidth: WIDTH,
+    codedHeight: HEIGHT,
+    timestamp,
+    duration: 40000,
+    colorSpace: { primaries: 'bt709', transfer: 'bt709', matrix: 'bt709', fullRange: false },
+  });
+}
+
+function createRing(slots: number, slotSize = I420_SIZE): SharedFrameRing {
+  return new SharedFrameRing({ name: ringName(), create: true, slots, slotSize });
+}
+
+async function pixels(frame: VideoFrame): Promise<Uint8Array> {
+  const out = new Uint8Array(frame.allocationSize());
+  await frame.copyTo(out);
+  return out;
+}
+
+describe('SharedFrameRing', () => {
+  it('should hand frames to another mapping with their properties', async () => {
+    const producer = createRing(2);
+    const consumer = new SharedFrameRing({ name: producer.name });
+    assert.strictEqual(consumer.slotCount, 2);
+    assert.strictEqual(consumer.slotSize, I420_SIZE);
+
+    const source = makeFrame(1000, 7);
+    assert.strictEqual(producer.tryWrite(source), true);
+    source.close();
+
+    const frame = consumer.tryRead();
+    assert.ok(frame);
+    assert.strictEqual(frame.format, 'I420');
+    assert.strictEqual(frame.codedWidth, WIDTH);
+    assert.strictEqual(frame.codedHeight, HEIGHT);
+    assert.strictEqual(frame.timestamp, 1000);
+    assert.strictEqual(frame.duration, 40000);
+    assert.strictEqual(frame.colorSpace.matrix, 'bt709');
+    assert.strictEqual(frame.colorSpace.fullRange, false);
+    assert.deepStrictEqual(await pixels(frame), new Uint8Array(I420_SIZE).fill(7));
+    frame.close();
+    producer.close();
+  });
+
+  it('should return a slot to the producer when the frame is closed', () => {
+    const ring = createRing(1);
+    const first = makeFrame(0, 1);
+    const second = makeFrame(1, 2);
+    assert.strictEqual(ring.tryWrite(first), true);
+    assert.strictEqual(ring.tryWrite(second), false);
+
+    const held = ring.tryRead();
+    assert.ok(held);
+    assert.strictEqual(ring.tryWrite(second), false, 'slot is still held');
+    held.close();
+    assert.strictEqual(ring.tryWrite(second), true);
+
+    first.close();
+    second.close();
+    ring.close();
+  });
+
+  it('should reject frames larger than a slot', () => {
+    const ring = createRing(1, 64);
+    const frame = makeFrame(0, 0);
+    assert.throws(() => ring.tryWrite(frame), RangeError);
+    frame.close();
+    ring.close();
+  });
+
+  it('should time out, then end reads with null after close()', async () => {
+    const ring = createRing(2);
+    await assert.rejects(ring.read({ timeout: 10 }), { name: 'TimeoutError' });
+
+    const frame = makeFrame(5, 5);
+    assert.strictEqual(await ring.write(frame), true);
+    frame.close();
+    ring.close();
+    assert.strictEqual(ring.closed, true);
+
+    const last = await ring.read();
+    assert.strictEqual(last?.timestamp, 5, 'frames written before close() are delivered');
+    last?.close();
+    assert.strictEqual(await ring.read(), null);
+  });
+
+  it('should move frames between processes', async () => {
+    const ring = createRing(2);
+    // The child produces more frames than there are slots, so it has to wait
+    // for this process to release them.
+    const child = spawn(
+      process.execPath,
+      [
+        '-e',
+        `
+        const { SharedFrameRing, VideoFrame } = require('@pproenca/node-webcodecs');
+        (async () => {
+          const ring = new SharedFrameRing({ name: ${JSON.stringify(ring.name)} });
+          for (let i = 0; i < 8; i++) {
+            const frame = new VideoFrame(new Uint8Array(${I420_SIZE}).fill(i), {
+              format: 'I420', codedWidth: ${WIDTH}, codedHeight: ${HEIGHT}, timestamp: i,
+            });
+            await ring.write(frame, { timeout: 5000 });
+            frame.close();
+          }
+          ring.close();
+        })();
+        `,
+      ],
+      { stdio: 'inherit' },
+    );
+    const exited = new Promise<number | null>((resolve) => child.once('exit', resolve));
+
+    const received: number[] = [];
+    let frame = await ring.read({ timeout: 5000 });
+    while (frame) {
+      const data = await pixels(frame);
+      assert.strictEqual(data[0], frame.timestamp);
+      received.push(frame.timestamp);
+      frame.close();
+      frame = await ring.read({ timeout: 5000 });
+    }
+    assert.deepStrictEqual(received, [0, 1, 2, 3, 4, 5, 6, 7]);
+    assert.strictEqual(await exited, 0);
+  });
+});
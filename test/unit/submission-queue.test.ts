@@ -0,0 +1,103 @@
+// test/unit/submission-queue.test.ts
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+import { SubmissionQueue } from '../../lib/submission-queue';
+
+describe('SubmissionQueue', () => {
+  it('should submit parked calls in order once space frees up', async () => {
+    const queue = new SubmissionQueue(() => {});
+    const submitted: number[] = [];
+    let space = 0;
+    const submitter = (id: number) => () => {
+      if (space === 0) {
+        return false;
+      }
+      space--;
+      submitted.push(id);
+      return true;
+    };
+
+    const first = queue.park(submitter(1), () => {});
+    const second = queue.park(submitter(2), () => {});
+    assert.strictEqual(queue.size, 2);
+
+    queue.drain();
+    assert.deepStrictEqual(submitted, []);
+
+    space = 1;
+    queue.drain();
+    await first;
+    assert.deepStrictEqual(submitted, [1]);
+    assert.strictEqual(queue.size, 1);
+
+    // Nothing retries on a timer; the codec's next event drains.
+    space = 1;
+    await new Promise((resolve) => setTimeout(resolve, 5));
+    assert.deepStrictEqual(submitted, [1]);
+    queue.drain();
+    await second;
+    assert.deepStrictEqual(submitted, [1, 2]);
+    assert.strictEqual(queue.size, 0);
+  });
+
+  it('should release each input once it is submitted', async () => {
+    const queue = new SubmissionQueue(() => {});
+    let released = 0;
+    const parked = queue.park(() => true, () => released++);
+    queue.drain();
+    await parked;
+    assert.strictEqual(released, 1);
+  });
+
+  it('should reject a call whose submission throws and move on', async () => {
+    let abandoned = 0;
+    const queue = new SubmissionQueue(() => abandoned++);
+    const failing = queue.park(
+      () => {
+        throw new TypeError('bad input');
+      },
+      () => {},
+    );
+    const next = queue.park(() => true, () => {});
+
+    queue.drain();
+    await assert.rejects(failing, TypeError);
+    await next;
+    assert.strictEqual(abandoned, 1);
+  });
+
+  it('should reject and release everything on rejectAll()', async () => {
+    const queue = new SubmissionQueue(() => {});
+    let released = 0;
+    const parked = [1, 2].map(() => queue.park(() => false, () => released++));
+
+    queue.rejectAll(new DOMException('reset', 'AbortError'));
+    for (const promise of parked) {
+      await assert.rejects(promise, { name: 'AbortError' });
+    }
+    assert.strictEqual(released, 2);
+    assert.strictEqual(queue.size, 0);
+  });
+
+  it('should resolve whenIdle() once nothing is parked', async () => {
+    const queue = new SubmissionQueue(() => {});
+    await queue.whenIdle(); // Nothing parked
+
+    let accept = false;
+    const parked = queue.park(() => accept, () => {});
+    let idle = false;
+    const waiting = queue.whenIdle().then(() => {
+      idle = true;
+    });
+
+    await new Promise((resolve) => setTimeout(resolve, 5));
+    assert.strictEqual(idle, false);
+
+    accept = true;
+    queue.drain();
+    await parked;
+    await waiting;
+    assert.strictEqual(idle, true);
+  });
+});
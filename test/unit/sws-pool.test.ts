@@ -0,0 +1,59 @@
+// test/unit/sws-pool.test.ts
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+
+import { getSwsPoolStats, trimSwsPool, VideoFrame } from '@pproenca/node-webcodecs';
+
+const WIDTH = 100;
+const HEIGHT = 60;
+
+function createI420Frame(): VideoFrame {
+  return new VideoFrame(new Uint8Array(WIDTH * HEIGHT * 1.5).fill(128), {
+    format: 'I420',
+    codedWidth: WIDTH,
+    codedHeight: HEIGHT,
+    timestamp: 0,
+  });
+}
+
+async function copyToRGBA(frame: VideoFrame): Promise<void> {
+  const dest = new Uint8Array(WIDTH * HEIGHT * 4);
+  await frame.copyTo(dest, { format: 'RGBA' });
+}
+
+describe('SwsPool', () => {
+  it('should expose hit/miss statistics', () => {
+    const stats = getSwsPoolStats();
+    for (const key of ['hits', 'misses', 'idleContexts', 'hitRate'] as const) {
+      assert.strictEqual(typeof stats[key], 'number');
+      assert.ok(stats[key] >= 0);
+    }
+    assert.ok(stats.hitRate <= 1);
+  });
+
+  it('should reuse a context for repeated identical conversions', async () => {
+    const frame = createI420Frame();
+    await copyToRGBA(frame);
+    const before = getSwsPoolStats();
+
+    for (let i = 0; i < 5; i++) {
+      await copyToRGBA(frame);
+    }
+    const after = getSwsPoolStats();
+    frame.close();
+
+    assert.ok(after.hits >= before.hits + 5, `hits ${before.hits} -> ${after.hits}`);
+    assert.strictEqual(after.misses, before.misses);
+  });
+
+  it('should free idle contexts on trim', async () => {
+    const frame = createI420Frame();
+    await copyToRGBA(frame);
+    frame.close();
+    assert.ok(getSwsPoolStats().idleContexts > 0);
+
+    trimSwsPool();
+    assert.strictEqual(getSwsPoolStats().idleContexts, 0);
+  });
+});
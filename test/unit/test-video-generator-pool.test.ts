@@ -0,0 +1,109 @@
+// test/unit/test-video-generator-pool.test.ts
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+
+import {
+  type EncodedVideoChunk,
+  TestVideoGenerator,
+  VideoDecoder,
+  type VideoDecoderConfig,
+  type VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+const WIDTH = 160;
+const HEIGHT = 120;
+
+async function generateFrames(config: Partial<Parameters<TestVideoGenerator['configure']>[0]>): Promise<VideoFrame[]> {
+  const generator = new TestVideoGenerator();
+  generator.configure({ width: WIDTH, height: HEIGHT, frameRate: 30, duration: 1, ...config });
+  const frames: VideoFrame[] = [];
+  await generator.generate((frame) => {
+    frames.push(frame);
+  });
+  generator.close();
+  return frames;
+}
+
+describe('TestVideoGenerator load-testing options (node-webcodecs extension)', () => {
+  for (const format of ['I420', 'NV12'] as const) {
+    it(`should generate ${format} frames`, async () => {
+      const frames = await generateFrames({ format });
+      assert.strictEqual(frames.length, 30);
+      for (const frame of frames) {
+        assert.strictEqual(frame.format, format);
+        assert.strictEqual(frame.codedWidth, WIDTH);
+        frame.close();
+      }
+    });
+  }
+
+  it('should cycle a pool over the full duration', async () => {
+    const frames = await generateFrames({ format: 'I420', poolSize: 4, duration: 2 });
+    assert.strictEqual(frames.length, 60);
+    assert.strictEqual(frames[59].timestamp, Math.floor((59 * 1e6) / 30));
+    for (const frame of frames) {
+      frame.close();
+    }
+  });
+
+  it('should reject invalid formats and pool sizes', () => {
+    const generator = new TestVideoGenerator();
+    const base = { width: WIDTH, height: HEIGHT };
+    assert.throws(() => generator.configure({ ...base, format: 'BGRA' as 'RGBA' }), TypeError);
+    assert.throws(() => generator.configure({ ...base, poolSize: -1 }), RangeError);
+    generator.close();
+  });
+
+  it('should emit pre-encoded chunks that decode', async () => {
+    const generator = new TestVideoGenerator();
+    generator.configure({
+      width: WIDTH,
+      height: HEIGHT,
+      frameRate: 30,
+      duration: 2,
+      poolSize: 10,
+      codec: 'avc1.42001e',
+      bitrate: 200_000,
+    });
+    const chunks: EncodedVideoChunk[] = [];
+    let decoderConfig: VideoDecoderConfig | undefined;
+    await generator.generateChunks((chunk, metadata) => {
+      chunks.push(chunk);
+      decoderConfig ??= metadata?.decoderConfig;
+    });
+    generator.close();
+
+    assert.strictEqual(chunks.length, 60);
+    assert.ok(decoderConfig);
+    assert.deepStrictEqual(
+      chunks.filter((chunk) => chunk.type === 'key').map((chunk) => chunk.timestamp),
+      [0, 10, 20, 30, 40, 50].map((i) => Math.floor((i * 1e6) / 30)),
+    );
+
+    let decoded = 0;
+    const decoder = new VideoDecoder({
+      output: (frame) => {
+        decoded++;
+        frame.close();
+      },
+      error: (e) => {
+        throw e;
+      },
+    });
+    decoder.configure(decoderConfig);
+    for (const chunk of chunks) {
+      decoder.decode(chunk);
+    }
+    await decoder.flush();
+    decoder.close();
+    assert.strictEqual(decoded, 60);
+  });
+
+  it('should require a codec for generateChunks()', async () => {
+    const generator = new TestVideoGenerator();
+    generator.configure({ width: WIDTH, height: HEIGHT });
+    await assert.rejects(generator.generateChunks(() => {}), TypeError);
+    generator.close();
+  });
+});
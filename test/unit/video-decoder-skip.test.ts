@@ -0,0 +1,137 @@
+// test/unit/video-decoder-skip.test.ts
+
+import * as assert from 'node:assert/strict';
+import { before, describe, it } from 'node:test';
+
+import {
+  type EncodedVideoChunk,
+  VideoDecoder,
+  type VideoDecoderConfig,
+  VideoEncoder,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+const WIDTH = 160;
+const HEIGHT = 120;
+const FRAMES = 30;
+const GOP = 10;
+
+const chunks: EncodedVideoChunk[] = [];
+let decoderConfig: VideoDecoderConfig;
+
+async function decodeAll(
+  config: Partial<VideoDecoderConfig>,
+  run: (decoder: VideoDecoder) => Promise<void>,
+): Promise<number[]> {
+  const timestamps: number[] = [];
+  const decoder = new VideoDecoder({
+    output: (frame) => {
+      timestamps.push(frame.timestamp);
+      frame.close();
+    },
+    error: (e) => {
+      throw e;
+    },
+  });
+  decoder.configure({ ...decoderConfig, ...config });
+  await run(decoder);
+  decoder.close();
+  return timestamps;
+}
+
+describe('VideoDecoder decode-skip (node-webcodecs extension)', () => {
+  before(async () => {
+    const encoder = new VideoEncoder({
+      output: (chunk, metadata) => {
+        chunks.push(chunk);
+        if (metadata?.decoderConfig) {
+          decoderConfig = metadata.decoderConfig;
+        }
+      },
+      error: (e) => {
+        throw e;
+      },
+    });
+    // 'quality' uses B-frames, so decode order differs from output order.
+    encoder.configure({ codec: 'avc1.64001f', width: WIDTH, height: HEIGHT, latencyMode: 'quality' });
+    for (let i = 0; i < FRAMES; i++) {
+      const data = new Uint8Array(WIDTH * HEIGHT * 4);
+      for (let p = 0; p < data.length; p += 4) {
+        data[p] = (p / 4 + i * 4) & 0xff;
+        data[p + 3] = 255;
+      }
+      const frame = new VideoFrame(data, {
+        format: 'RGBA',
+        codedWidth: WIDTH,
+        codedHeight: HEIGHT,
+        timestamp: i * 33333,
+      });
+      encoder.encode(frame, { keyFrame: i % GOP === 0 });
+      frame.close();
+    }
+    await encoder.flush();
+    encoder.close();
+    assert.strictEqual(chunks.length, FRAMES);
+  });
+
+  it("should output only key frames with skipFrames: 'nonkey'", async () => {
+    const timestamps = await decodeAll({ skipFrames: 'nonkey' }, async (decoder) => {
+      for (const chunk of chunks) {
+        decoder.decode(chunk);
+      }
+      await decoder.flush();
+    });
+    assert.deepStrictEqual(timestamps, [0, GOP * 33333, 2 * GOP * 33333]);
+  });
+
+  it('should decode every frame with skipLoopFilter', async () => {
+    const timestamps = await decodeAll({ skipLoopFilter: true }, async (decoder) => {
+      for (const chunk of chunks) {
+        decoder.decode(chunk);
+      }
+      await decoder.flush();
+    });
+    assert.strictEqual(timestamps.length, FRAMES);
+  });
+
+  it('should output only the target frame with decodeTo()', async () => {
+    const target = 17 * 33333;
+    const start = chunks.findIndex((chunk) => chunk.timestamp === GOP * 33333);
+    let found = false;
+    const timestamps = await decodeAll({}, async (decoder) => {
+      found = await decoder.decodeTo(chunks.slice(start), target);
+    });
+    assert.ok(found);
+    assert.deepStrictEqual(timestamps, [target]);
+  });
+
+  it('should settle decodeQueueSize after chunks that output no frame', async () => {
+    const target = (FRAMES - 1) * 33333;
+    await decodeAll({}, async (decoder) => {
+      // More skipped chunks than the default queue depth.
+      assert.ok(await decoder.decodeTo(chunks, target));
+      assert.strictEqual(decoder.decodeQueueSize, 0);
+      await decoder.ready;
+    });
+    await decodeAll({ skipFrames: 'nonkey' }, async (decoder) => {
+      for (const chunk of chunks) {
+        decoder.decode(chunk);
+      }
+      await decoder.flush();
+      assert.strictEqual(decoder.decodeQueueSize, 0);
+      await decoder.ready;
+    });
+  });
+
+  it('should reject malformed skip options', async () => {
+    const decoder = new VideoDecoder({ output: () => {}, error: () => {} });
+    const base = { codec: 'avc1.64001f' };
+    assert.throws(() => decoder.configure({ ...base, skipFrames: 'all' as 'none' }), TypeError);
+    assert.throws(() => decoder.configure({ ...base, skipLoopFilter: 1 as unknown as boolean }), TypeError);
+    decoder.close();
+
+    const support = await VideoDecoder.isConfigSupported({ ...base, skipFrames: 'nonkey' });
+    assert.strictEqual(support.supported, true);
+    assert.strictEqual(support.config.skipFrames, 'nonkey');
+  });
+});
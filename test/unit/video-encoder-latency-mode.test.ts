@@ -0,0 +1,107 @@
+// test/unit/video-encoder-latency-mode.test.ts
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+
+import {
+  type EncodedVideoChunk,
+  type LatencyMode,
+  VideoEncoder,
+  type VideoEncoderConfig,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+const WIDTH = 160;
+const HEIGHT = 120;
+const FRAMES = 30;
+
+async function encode(
+  config: Partial<VideoEncoderConfig> & { latencyMode: LatencyMode },
+  keyFrameAt = -1,
+): Promise<EncodedVideoChunk[]> {
+  const chunks: EncodedVideoChunk[] = [];
+  const encoder = new VideoEncoder({
+    output: (chunk) => chunks.push(chunk),
+    error: (e) => {
+      throw e;
+    },
+  });
+  encoder.configure({ codec: 'avc1.64001f', width: WIDTH, height: HEIGHT, ...config });
+  for (let i = 0; i < FRAMES; i++) {
+    // Moving gradient so the encoder has motion to predict.
+    const data = new Uint8Array(WIDTH * HEIGHT * 4);
+    for (let p = 0; p < data.length; p += 4) {
+      data[p] = (p / 4 + i * 4) & 0xff;
+      data[p + 3] = 255;
+    }
+    const frame = new VideoFrame(data, {
+      format: 'RGBA',
+      codedWidth: WIDTH,
+      codedHeight: HEIGHT,
+      timestamp: i * 33333,
+    });
+    encoder.encode(frame, { keyFrame: i === 0 || i === keyFrameAt });
+    frame.close();
+  }
+  await encoder.flush();
+  encoder.close();
+  return chunks;
+}
+
+describe('VideoEncoder latencyMode profiles', () => {
+  it("should reorder frames (B-frames) in 'quality' mode", async () => {
+    const chunks = await encode({ latencyMode: 'quality' });
+    assert.strictEqual(chunks.length, FRAMES);
+    assert.ok(
+      chunks.some((chunk) => chunk.decodeTimestamp !== chunk.timestamp),
+      'expected reordered output',
+    );
+  });
+
+  it("should not reorder frames in 'realtime' mode", async () => {
+    const chunks = await encode({ latencyMode: 'realtime' });
+    assert.strictEqual(chunks.length, FRAMES);
+    for (const chunk of chunks) {
+      assert.strictEqual(chunk.decodeTimestamp, chunk.timestamp);
+    }
+  });
+
+  it("should honour keyFrame: true in 'quality' mode", async () => {
+    const chunks = await encode({ latencyMode: 'quality' }, 17);
+    const forced = chunks.find((chunk) => chunk.timestamp === 17 * 33333);
+    assert.strictEqual(forced?.type, 'key');
+  });
+
+  it('should accept every encoderPreset', async () => {
+    for (const encoderPreset of ['speed', 'balanced', 'quality'] as const) {
+      const chunks = await encode({ latencyMode: 'quality', encoderPreset });
+      assert.strictEqual(chunks.length, FRAMES, encoderPreset);
+    }
+  });
+
+  it('should reject an unknown encoderPreset', () => {
+    const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+    assert.throws(
+      () =>
+        encoder.configure({
+          codec: 'avc1.42001e',
+          width: WIDTH,
+          height: HEIGHT,
+          encoderPreset: 'slowest' as never,
+        }),
+      TypeError,
+    );
+    encoder.close();
+  });
+
+  it('should echo encoderPreset from isConfigSupported()', async () => {
+    const support = await VideoEncoder.isConfigSupported({
+      codec: 'avc1.42001e',
+      width: WIDTH,
+      height: HEIGHT,
+      encoderPreset: 'speed',
+    });
+    assert.strictEqual(support.supported, true);
+    assert.strictEqual(support.config.encoderPreset, 'speed');
+  });
+});
@@ -282,6 +282,7 @@ describe('EncodedVideoChunkMetadata: 6.7', () => {
       // L1T2 = 1 spatial layer, 2 temporal layers
       encoder.configure({
         ...h264Config,
+        codec: 'vp8',
         scalabilityMode: 'L1T2',
       });
 
@@ -0,0 +1,111 @@
+// test/unit/video-encoder-reconfigure.test.ts
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+
+import {
+  type EncodedVideoChunk,
+  type EncodedVideoChunkMetadata,
+  VideoEncoder,
+  type VideoEncoderConfig,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+const BASE: VideoEncoderConfig = {
+  codec: 'avc1.42001f',
+  width: 160,
+  height: 120,
+  bitrate: 500_000,
+  latencyMode: 'realtime',
+};
+
+function newFrame(width: number, height: number, i: number): VideoFrame {
+  const data = new Uint8Array(width * height * 4);
+  for (let p = 0; p < data.length; p += 4) {
+    data[p] = (p / 4 + i * 4) & 0xff;
+    data[p + 3] = 255;
+  }
+  return new VideoFrame(data, {
+    format: 'RGBA',
+    codedWidth: width,
+    codedHeight: height,
+    timestamp: i * 33333,
+  });
+}
+
+interface Output {
+  chunk: EncodedVideoChunk;
+  metadata?: EncodedVideoChunkMetadata;
+}
+
+function newEncoder(outputs: Output[]): VideoEncoder {
+  return new VideoEncoder({
+    output: (chunk, metadata) => outputs.push({ chunk, metadata }),
+    error: (e) => {
+      throw e;
+    },
+  });
+}
+
+function encodeRange(encoder: VideoEncoder, config: VideoEncoderConfig, from: number, to: number) {
+  for (let i = from; i < to; i++) {
+    const frame = newFrame(config.width, config.height, i);
+    encoder.encode(frame, { keyFrame: i === 0 });
+    frame.close();
+  }
+}
+
+describe('VideoEncoder in-place reconfigure', () => {
+  it('should change bitrate without a new key frame', async () => {
+    const outputs: Output[] = [];
+    const encoder = newEncoder(outputs);
+    encoder.configure(BASE);
+    encodeRange(encoder, BASE, 0, 15);
+    const next = { ...BASE, bitrate: 200_000 };
+    encoder.configure(next);
+    encodeRange(encoder, next, 15, 30);
+    await encoder.flush();
+    encoder.close();
+
+    assert.strictEqual(outputs.length, 30);
+    const keys = outputs.filter(({ chunk }) => chunk.type === 'key');
+    assert.deepStrictEqual(
+      keys.map(({ chunk }) => chunk.timestamp),
+      [0],
+    );
+  });
+
+  it('should encode frames queued before configure() with the old settings', async () => {
+    const outputs: Output[] = [];
+    const encoder = newEncoder(outputs);
+    encoder.configure(BASE);
+    encodeRange(encoder, BASE, 0, 10);
+    const larger = { ...BASE, width: 320, height: 240 };
+    encoder.configure(larger);
+    encodeRange(encoder, larger, 10, 20);
+    await encoder.flush();
+    encoder.close();
+
+    assert.strictEqual(outputs.length, 20);
+    outputs.forEach(({ chunk }, i) => assert.strictEqual(chunk.timestamp, i * 33333));
+    const resized = outputs[10];
+    assert.strictEqual(resized.chunk.type, 'key');
+    assert.strictEqual(resized.metadata?.decoderConfig?.codedWidth, 320);
+    assert.strictEqual(resized.metadata?.decoderConfig?.codedHeight, 240);
+  });
+
+  it('should keep accepting frames after a codec change', async () => {
+    const outputs: Output[] = [];
+    const encoder = newEncoder(outputs);
+    encoder.configure(BASE);
+    encodeRange(encoder, BASE, 0, 5);
+    const vp8 = { ...BASE, codec: 'vp8' };
+    encoder.configure(vp8);
+    encodeRange(encoder, vp8, 5, 10);
+    await encoder.flush();
+    encoder.close();
+
+    assert.strictEqual(outputs.length, 10);
+    assert.strictEqual(outputs[5].metadata?.decoderConfig?.codec, 'vp8');
+  });
+});
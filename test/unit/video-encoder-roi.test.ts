@@ -0,0 +1,84 @@
+// test/unit/video-encoder-roi.test.ts
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+
+import { VideoEncoder, type VideoEncoderRegionOfInterest, VideoFrame } from '@pproenca/node-webcodecs';
+
+const WIDTH = 160;
+const HEIGHT = 120;
+
+function newFrame(i: number): VideoFrame {
+  const data = new Uint8Array(WIDTH * HEIGHT * 4);
+  for (let p = 0; p < data.length; p += 4) {
+    data[p] = (p / 4 + i * 8) & 0xff;
+    data[p + 1] = (p / 16) & 0xff;
+    data[p + 3] = 255;
+  }
+  return new VideoFrame(data, {
+    format: 'RGBA',
+    codedWidth: WIDTH,
+    codedHeight: HEIGHT,
+    timestamp: i * 33333,
+  });
+}
+
+async function encodeWithRegions(codec: string, regionsOfInterest: VideoEncoderRegionOfInterest[]): Promise<number> {
+  let chunks = 0;
+  const encoder = new VideoEncoder({
+    output: () => {
+      chunks++;
+    },
+    error: (e) => {
+      throw e;
+    },
+  });
+  // Encoding at half size checks that regions follow the frame through
+  // scaling.
+  encoder.configure({ codec, width: WIDTH / 2, height: HEIGHT / 2, bitrate: 200_000 });
+  for (let i = 0; i < 10; i++) {
+    const frame = newFrame(i);
+    encoder.encode(frame, { keyFrame: i === 0, regionsOfInterest });
+    frame.close();
+  }
+  await encoder.flush();
+  encoder.close();
+  return chunks;
+}
+
+describe('VideoEncoder regionsOfInterest (node-webcodecs extension)', () => {
+  const regions: VideoEncoderRegionOfInterest[] = [
+    { x: 40, y: 30, width: 80, height: 60, qpOffset: -0.5 },
+    { x: 0, y: 0, width: WIDTH, height: HEIGHT, qpOffset: 0.5 },
+    // Clipped to nothing and dropped.
+    { x: WIDTH, y: 0, width: 10, height: 10, qpOffset: 1 },
+  ];
+
+  for (const codec of ['avc1.42001e', 'vp8', 'vp09.00.10.08']) {
+    it(`should encode every frame with regions for ${codec}`, async () => {
+      assert.strictEqual(await encodeWithRegions(codec, regions), 10);
+    });
+  }
+
+  it('should reject malformed regions', () => {
+    const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+    encoder.configure({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT });
+    const frame = newFrame(0);
+    const bad: unknown[] = [
+      {},
+      [{ x: 0, y: 0, width: 10, height: 10 }],
+      [{ x: 0, y: 0, width: 10, height: 10, qpOffset: 2 }],
+      [{ x: 0, y: 0, width: -1, height: 10, qpOffset: 0 }],
+      [{ x: 'a', y: 0, width: 10, height: 10, qpOffset: 0 }],
+      Array.from({ length: 65 }, () => ({ x: 0, y: 0, width: 1, height: 1, qpOffset: 0 })),
+    ];
+    for (const regionsOfInterest of bad) {
+      assert.throws(
+        () => encoder.encode(frame, { regionsOfInterest: regionsOfInterest as VideoEncoderRegionOfInterest[] }),
+        TypeError,
+      );
+    }
+    frame.close();
+    encoder.close();
+  });
+});
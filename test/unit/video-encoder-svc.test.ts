@@ -0,0 +1,96 @@
+// test/unit/video-encoder-svc.test.ts
+
+import * as assert from 'node:assert/strict';
+import { describe, it } from 'node:test';
+
+import {
+  type EncodedVideoChunk,
+  type EncodedVideoChunkMetadata,
+  VideoDecoder,
+  VideoEncoder,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+const WIDTH = 160;
+const HEIGHT = 120;
+const FRAMES = 16;
+
+async function encodeLayered(codec: string, scalabilityMode: string) {
+  const outputs: Array<{ chunk: EncodedVideoChunk; metadata?: EncodedVideoChunkMetadata }> = [];
+  const encoder = new VideoEncoder({
+    output: (chunk, metadata) => outputs.push({ chunk, metadata }),
+    error: (e) => {
+      throw e;
+    },
+  });
+  encoder.configure({ codec, width: WIDTH, height: HEIGHT, bitrate: 300_000, scalabilityMode });
+  for (let i = 0; i < FRAMES; i++) {
+    const data = new Uint8Array(WIDTH * HEIGHT * 4);
+    for (let p = 0; p < data.length; p += 4) {
+      data[p] = (p / 4 + i * 8) & 0xff;
+      data[p + 3] = 255;
+    }
+    const frame = new VideoFrame(data, {
+      format: 'RGBA',
+      codedWidth: WIDTH,
+      codedHeight: HEIGHT,
+      timestamp: i * 33333,
+    });
+    encoder.encode(frame, { keyFrame: i === 0 });
+    frame.close();
+  }
+  await encoder.flush();
+  encoder.close();
+  return outputs;
+}
+
+async function decodeCount(codec: string, chunks: EncodedVideoChunk[]): Promise<number> {
+  let decoded = 0;
+  let error: unknown = null;
+  const decoder = new VideoDecoder({
+    output: (frame) => {
+      decoded++;
+      frame.close();
+    },
+    error: (e) => {
+      error = e;
+    },
+  });
+  decoder.configure({ codec, codedWidth: WIDTH, codedHeight: HEIGHT });
+  for (const chunk of chunks) {
+    decoder.decode(chunk);
+  }
+  await decoder.flush();
+  decoder.close();
+  assert.strictEqual(error, null);
+  return decoded;
+}
+
+describe('VideoEncoder temporal scalability', () => {
+  for (const codec of ['vp8', 'vp09.00.10.08']) {
+    it(`should produce a droppable L1T3 pyramid for ${codec}`, async () => {
+      const outputs = await encodeLayered(codec, 'L1T3');
+      assert.strictEqual(outputs.length, FRAMES);
+      assert.deepStrictEqual(
+        outputs.slice(0, 8).map(({ metadata }) => metadata?.svc?.temporalLayerId),
+        [0, 2, 1, 2, 0, 2, 1, 2],
+      );
+
+      // An SFU forwarding only the lower layers must still hand out a
+      // decodable stream.
+      const base = outputs.filter(({ metadata }) => metadata?.svc?.temporalLayerId === 0);
+      assert.strictEqual(await decodeCount(codec, base.map(({ chunk }) => chunk)), FRAMES / 4);
+      const twoLayers = outputs.filter(({ metadata }) => (metadata?.svc?.temporalLayerId ?? 0) <= 1);
+      assert.strictEqual(await decodeCount(codec, twoLayers.map(({ chunk }) => chunk)), FRAMES / 2);
+    });
+  }
+
+  it('should reject temporal layers on encoders without them', () => {
+    const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+    assert.throws(
+      () => encoder.configure({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT, scalabilityMode: 'L1T2' }),
+      /NotSupportedError/,
+    );
+    encoder.close();
+  });
+});
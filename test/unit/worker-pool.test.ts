@@ -0,0 +1,80 @@
+// test/unit/worker-pool.test.ts
+
+import * as assert from 'node:assert/strict';
+import { after, describe, it } from 'node:test';
+
+import {
+  configureWorkerPool,
+  type EncodedVideoChunk,
+  VideoEncoder,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+describe('Shared worker pool', () => {
+  after(() => {
+    configureWorkerPool(0);
+  });
+
+  it('should reject invalid sizes', () => {
+    assert.throws(() => configureWorkerPool(-1), TypeError);
+    assert.throws(() => configureWorkerPool(1.5), TypeError);
+    assert.throws(() => configureWorkerPool(Infinity), TypeError);
+    assert.throws(() => configureWorkerPool(NaN), TypeError);
+    assert.throws(() => configureWorkerPool(2 ** 64), TypeError);
+  });
+
+  it('should report the effective pool size', () => {
+    assert.strictEqual(configureWorkerPool(2), 2);
+    assert.strictEqual(configureWorkerPool(0), 0);
+  });
+
+  it('should keep per-codec output order with more codecs than threads', async () => {
+    configureWorkerPool(2);
+
+    const kEncoders = 6;
+    const kFrames = 10;
+    const outputs: number[][] = Array.from({ length: kEncoders }, () => []);
+
+    const encoders = outputs.map((timestamps) => {
+      const encoder = new VideoEncoder({
+        output: (chunk: EncodedVideoChunk) => timestamps.push(chunk.timestamp),
+        error: (e) => {
+          throw e;
+        },
+      });
+      encoder.configure({
+        codec: 'avc1.42001E',
+        width: 64,
+        height: 64,
+        latencyMode: 'realtime',
+      });
+      return encoder;
+    });
+
+    for (let i = 0; i < kFrames; i++) {
+      for (const encoder of encoders) {
+        const frame = new VideoFrame(new Uint8Array(64 * 64 * 4), {
+          format: 'RGBA',
+          codedWidth: 64,
+          codedHeight: 64,
+          timestamp: i * 33333,
+        });
+        encoder.encode(frame);
+        frame.close();
+      }
+    }
+
+    await Promise.all(encoders.map((encoder) => encoder.flush()));
+    for (const encoder of encoders) {
+      encoder.close();
+    }
+
+    for (const timestamps of outputs) {
+      assert.strictEqual(timestamps.length, kFrames);
+      assert.deepStrictEqual(
+        timestamps,
+        [...timestamps].sort((a, b) => a - b),
+      );
+    }
+  });
+});
@@ -0,0 +1,201 @@
+// test/unit/worker-transfer.test.ts
+
+import * as assert from 'node:assert/strict';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import { describe, it } from 'node:test';
+import { Worker } from 'node:worker_threads';
+
+import {
+  AudioData,
+  attachTransferred,
+  detachForTransfer,
+  EncodedAudioChunk,
+  EncodedVideoChunk,
+  Muxer,
+  pendingTransfers,
+  releaseTransferred,
+  type TransferredVideoFrame,
+  VideoEncoder,
+  VideoFrame,
+} from '@pproenca/node-webcodecs';
+
+const WIDTH = 64;
+const HEIGHT = 48;
+
+function makeFrame(): VideoFrame {
+  const data = new Uint8Array(WIDTH * HEIGHT * 4);
+  for (let i = 0; i < data.length; i++) {
+    data[i] = i & 0xff;
+  }
+  return new VideoFrame(data, {
+    format: 'RGBA',
+    codedWidth: WIDTH,
+    codedHeight: HEIGHT,
+    timestamp: 1234,
+    duration: 33333,
+    metadata: { rtpTimestamp: 42 },
+  });
+}
+
+async function pixels(frame: VideoFrame): Promise<Uint8Array> {
+  const out = new Uint8Array(frame.allocationSize());
+  await frame.copyTo(out);
+  return out;
+}
+
+describe('Worker transfer', () => {
+  it('should move a VideoFrame without losing properties or pixels', async () => {
+    const frame = makeFrame();
+    const expected = await pixels(frame);
+    const message = detachForTransfer(frame);
+
+    assert.strictEqual(frame.format, null, 'source frame is closed');
+    const restored = attachTransferred(structuredClone(message));
+    assert.strictEqual(restored.codedWidth, WIDTH);
+    assert.strictEqual(restored.codedHeight, HEIGHT);
+    assert.strictEqual(restored.timestamp, 1234);
+    assert.strictEqual(restored.duration, 33333);
+    assert.strictEqual(restored.format, 'RGBA');
+    assert.deepStrictEqual(restored.metadata(), { rtpTimestamp: 42 });
+    assert.deepStrictEqual(await pixels(restored), expected);
+    restored.close();
+  });
+
+  it('should keep timestamp overrides from VideoFrame-from-VideoFrame construction', () => {
+    const source = makeFrame();
+    const frame = new VideoFrame(source, { timestamp: 5000 });
+    source.close();
+    const restored = attachTransferred(detachForTransfer(frame));
+    assert.strictEqual(restored.timestamp, 5000);
+    restored.close();
+  });
+
+  it('should allow each message to be attached once', () => {
+    const message = detachForTransfer(makeFrame());
+    attachTransferred(message).close();
+    assert.throws(
+      () => attachTransferred(message),
+      (error: unknown) => error instanceof DOMException && error.name === 'DataCloneError',
+    );
+  });
+
+  it('should reject closed objects', () => {
+    const frame = makeFrame();
+    frame.close();
+    assert.throws(() => detachForTransfer(frame), { name: 'InvalidStateError' });
+  });
+
+  it('should free undelivered messages with releaseTransferred()', () => {
+    const before = pendingTransfers();
+    const message = detachForTransfer(makeFrame());
+    assert.strictEqual(pendingTransfers(), before + 1);
+    assert.strictEqual(releaseTransferred(message), true);
+    assert.strictEqual(releaseTransferred(message), false);
+    assert.strictEqual(pendingTransfers(), before);
+  });
+
+  it('should move encoded chunks and AudioData', () => {
+    const payload = new Uint8Array([1, 2, 3, 4, 5]);
+    const video = attachTransferred(
+      detachForTransfer(
+        new EncodedVideoChunk({ type: 'key', timestamp: 10, duration: 20, data: payload }),
+      ),
+    );
+    assert.strictEqual(video.type, 'key');
+    assert.strictEqual(video.timestamp, 10);
+    assert.strictEqual(video.duration, 20);
+    const videoBytes = new Uint8Array(video.byteLength);
+    video.copyTo(videoBytes);
+    assert.deepStrictEqual(videoBytes, payload);
+    video.close();
+
+    const audio = attachTransferred(
+      detachForTransfer(new EncodedAudioChunk({ type: 'delta', timestamp: 7, data: payload })),
+    );
+    assert.strictEqual(audio.type, 'delta');
+    assert.strictEqual(audio.byteLength, payload.length);
+    audio.close();
+
+    const samples = new Float32Array([0.25, -0.5, 0.75, 1]);
+    const data = attachTransferred(
+      detachForTransfer(
+        new AudioData({
+          format: 'f32',
+          sampleRate: 48000,
+          numberOfFrames: 2,
+          numberOfChannels: 2,
+          timestamp: 99,
+          data: samples,
+        }),
+      ),
+    );
+    assert.strictEqual(data.sampleRate, 48000);
+    assert.strictEqual(data.numberOfFrames, 2);
+    assert.strictEqual(data.timestamp, 99);
+    const copy = new Float32Array(4);
+    data.copyTo(copy, { planeIndex: 0 });
+    assert.deepStrictEqual(copy, samples);
+    data.close();
+  });
+
+  it('should move a VideoFrame to a worker_thread and back', async () => {
+    const frame = makeFrame();
+    const expected = await pixels(frame);
+    // The worker rewraps the frame, checks it, and sends it straight back.
+    const worker = new Worker(
+      `
+      const { parentPort } = require('node:worker_threads');
+      const { attachTransferred, detachForTransfer } = require('@pproenca/node-webcodecs');
+      parentPort.once('message', (message) => {
+        const frame = attachTransferred(message);
+        parentPort.postMessage({ width: frame.codedWidth, back: detachForTransfer(frame) });
+      });
+      `,
+      { eval: true },
+    );
+    const reply = await new Promise<{ width: number; back: TransferredVideoFrame }>(
+      (resolve, reject) => {
+        worker.once('message', resolve);
+        worker.once('error', reject);
+        worker.postMessage(detachForTransfer(frame));
+      },
+    );
+    await worker.terminate();
+
+    assert.strictEqual(reply.width, WIDTH);
+    const restored = attachTransferred(reply.back);
+    assert.deepStrictEqual(await pixels(restored), expected);
+    restored.close();
+  });
+
+  it('should keep native class checks working after a worker_thread loads the addon', async () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'webcodecs-worker-'));
+    // The worker defines its own Muxer class; the main thread's must survive.
+    const worker = new Worker(
+      `
+      const { parentPort, workerData } = require('node:worker_threads');
+      const { Muxer } = require('@pproenca/node-webcodecs');
+      const muxer = new Muxer({ filename: workerData });
+      muxer.close();
+      parentPort.postMessage('ready');
+      `,
+      { eval: true, workerData: path.join(dir, 'worker.mp4') },
+    );
+    await new Promise((resolve, reject) => {
+      worker.once('message', resolve);
+      worker.once('error', reject);
+    });
+    await worker.terminate();
+
+    const muxer = new Muxer({ filename: path.join(dir, 'main.mp4') });
+    const track = muxer.addVideoTrack({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT });
+    const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+    encoder.configure({ codec: 'avc1.42001e', width: WIDTH, height: HEIGHT });
+    assert.doesNotThrow(() => encoder.attachMuxer(muxer, track));
+    encoder.close();
+    muxer.close();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+});